@@ -0,0 +1,89 @@
+#ifndef QUARTER_FRAMESINK_H
+#define QUARTER_FRAMESINK_H
+
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+#include <QtCore/QSize>
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+#include <QImage>
+#include <Quarter/Basic.h>
+
+class QProcess;
+
+namespace SIM { namespace Coin3D { namespace Quarter {
+
+class QUARTER_DLL_API FrameSink {
+public:
+  FrameSink(void);
+  virtual ~FrameSink();
+
+  virtual bool open(const QSize & size) = 0;
+  virtual bool writeFrame(const QImage & image, double timestamp) = 0;
+  virtual void close(void) = 0;
+};
+
+class QUARTER_DLL_API ImageSequenceSink : public FrameSink {
+public:
+  ImageSequenceSink(const QString & pattern, const char * format = NULL);
+  virtual ~ImageSequenceSink();
+
+  virtual bool open(const QSize & size);
+  virtual bool writeFrame(const QImage & image, double timestamp);
+  virtual void close(void);
+
+private:
+  QString pattern;
+  QByteArray format;
+  int framenumber;
+};
+
+class QUARTER_DLL_API ProcessSink : public FrameSink {
+public:
+  ProcessSink(const QString & program, const QStringList & arguments);
+  virtual ~ProcessSink();
+
+  virtual bool open(const QSize & size);
+  virtual bool writeFrame(const QImage & image, double timestamp);
+  virtual void close(void);
+
+private:
+  QString program;
+  QStringList arguments;
+  QProcess * process;
+  QByteArray buffer;
+};
+
+}}} // namespace
+
+#endif // QUARTER_FRAMESINK_H
@@ -0,0 +1,72 @@
+#ifndef QUARTER_FRAMESTATISTICS_H
+#define QUARTER_FRAMESTATISTICS_H
+
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+#include <Quarter/Basic.h>
+
+namespace SIM { namespace Coin3D { namespace Quarter {
+
+class QUARTER_DLL_API FrameStatistics {
+public:
+  enum Timing {
+    DELAY_QUEUE,
+    RENDER,
+    GPU,
+    SWAP,
+    FRAME,
+    INPUT_LATENCY
+  };
+
+  FrameStatistics(void);
+
+  int numFrames(Timing timing) const;
+  double last(Timing timing) const;
+  double minimum(Timing timing) const;
+  double average(Timing timing) const;
+  double percentile99(Timing timing) const;
+
+private:
+  friend class FrameTimer;
+  enum { NUM_TIMINGS = INPUT_LATENCY + 1 };
+
+  int numframes[NUM_TIMINGS];
+  double lastvalue[NUM_TIMINGS];
+  double minvalue[NUM_TIMINGS];
+  double avgvalue[NUM_TIMINGS];
+  double p99value[NUM_TIMINGS];
+};
+
+}}} // namespace
+
+#endif // QUARTER_FRAMESTATISTICS_H
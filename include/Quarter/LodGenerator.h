@@ -0,0 +1,90 @@
+#ifndef QUARTER_LODGENERATOR_H
+#define QUARTER_LODGENERATOR_H
+
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+#include <QtCore/QObject>
+#include <Quarter/Basic.h>
+
+class SoNode;
+class SoLOD;
+
+namespace SIM { namespace Coin3D { namespace Quarter {
+
+class QuarterWidget;
+
+class QUARTER_DLL_API LodGenerator : public QObject {
+  Q_OBJECT
+public:
+  LodGenerator(QObject * parent = 0);
+  virtual ~LodGenerator();
+
+  void setTarget(QuarterWidget * target);
+  QuarterWidget * target(void) const;
+
+  void setMinimumTriangles(int count);
+  int minimumTriangles(void) const;
+  void setNumLevels(int levels);
+  int numLevels(void) const;
+  void setReduction(double fraction);
+  double reduction(void) const;
+  void setPixelsPerTriangle(double pixels);
+  double pixelsPerTriangle(void) const;
+  void setInteractiveRangeScale(double scale);
+  double interactiveRangeScale(void) const;
+
+  bool start(SoNode * root);
+  bool isRunning(void) const;
+
+public slots:
+  void cancel(void);
+
+signals:
+  void levelReady(SoLOD * lod, int level);
+  void progress(double fraction);
+  void finished(void);
+
+private slots:
+  void collectNext(void);
+  void levelsFinished(void);
+  void workerFinished(void);
+  void interactiveQualityChanged(bool reduced);
+
+private:
+  class LodGeneratorP * pimpl;
+  friend class LodGeneratorP;
+};
+
+}}} // namespace
+
+#endif // QUARTER_LODGENERATOR_H
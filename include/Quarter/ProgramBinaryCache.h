@@ -1,3 +1,6 @@
+#ifndef QUARTER_PROGRAMBINARYCACHE_H
+#define QUARTER_PROGRAMBINARYCACHE_H
+
 /**************************************************************************\
  * Copyright (c) Kongsberg Oil & Gas Technologies AS
  * All rights reserved.
@@ -30,48 +33,26 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 \**************************************************************************/
 
-#include "SignalThread.h"
-
-using namespace SIM::Coin3D::Quarter;
+#include <QtCore/QByteArray>
+#include <QtCore/QString>
+#include <Quarter/Basic.h>
 
-SignalThread::SignalThread(void)
-  : isstopped(false)
-{
-}
+namespace SIM { namespace Coin3D { namespace Quarter {
 
-SignalThread::~SignalThread()
-{
-}
+class QUARTER_DLL_API ProgramBinaryCache {
+public:
+  static void setCacheDirectory(const QString & path);
+  static QString cacheDirectory(void);
 
-void
-SignalThread::trigger(void)
-{
-  // lock first to make sure the QThread is actually waiting for a signal
-  this->mutex.lock();
-  this->waitcond.wakeOne();
-  this->mutex.unlock();
-}
+  static bool isSupported(void);
+  static unsigned int createProgram(const QByteArray & vertexsource,
+                                    const QByteArray & fragmentsource);
+  static void clear(void);
 
-void
-SignalThread::stopThread(void)
-{
-  this->mutex.lock();
-  this->isstopped = true;
-  this->waitcond.wakeOne();
-  this->mutex.unlock();
-}
+private:
+  ProgramBinaryCache(void);
+};
 
+}}} // namespace
 
-void
-SignalThread::run(void)
-{
-  this->mutex.lock();
-  while (!this->isstopped) {
-    // just wait, and trigger every time we receive a signal
-    this->waitcond.wait(&this->mutex);
-    if (!this->isstopped) {
-      emit triggerSignal();
-    }
-  }
-  this->mutex.unlock();
-}
+#endif // QUARTER_PROGRAMBINARYCACHE_H
@@ -42,6 +42,7 @@ namespace SIM { namespace Coin3D { namespace Quarter {
 
 namespace QtCoinCompatibility {
   void QUARTER_DLL_API QImageToSbImage(const QImage &, SbImage & );
+  void QUARTER_DLL_API QImageToSbImage(const QImage &, unsigned char * buffer, int numcomponents);
   void QUARTER_DLL_API SbImageToQImage(const SbImage &, QImage & );
 }
 
@@ -34,13 +34,34 @@
 \**************************************************************************/
 
 #include <Quarter/Basic.h>
+#include <Quarter/SensorProfile.h>
+#include <QtCore/QStringList>
+#include <stddef.h>
+
+class SoSensor;
 
 namespace SIM { namespace Coin3D { namespace Quarter {
 
 namespace Quarter {
   void QUARTER_DLL_API init(bool initCoin = true);
   void QUARTER_DLL_API clean(void);
+  void QUARTER_DLL_API setDeferredInit(bool enable);
+  void QUARTER_DLL_API completeInit(void);
   void QUARTER_DLL_API setTimerEpsilon(double sec);
+  void QUARTER_DLL_API setDelayQueueBatchTime(double sec);
+  void QUARTER_DLL_API setRefreshDrivenRealTime(bool enable);
+  void QUARTER_DLL_API prefetchImages(const QStringList & filenames);
+  void QUARTER_DLL_API setImageCacheSize(size_t bytes);
+  size_t QUARTER_DLL_API imageCacheSize(void);
+  void QUARTER_DLL_API setImageMaxDimension(int pixels);
+  void QUARTER_DLL_API setImageMaxMemory(size_t bytes);
+  void QUARTER_DLL_API setProgressiveImages(bool enable, int previewdimension = 128);
+  void QUARTER_DLL_API setSensorProfilingEnabled(bool enable);
+  bool QUARTER_DLL_API sensorProfilingEnabled(void);
+  SensorProfile QUARTER_DLL_API sensorProfile(void);
+  void QUARTER_DLL_API resetSensorProfile(void);
+  void QUARTER_DLL_API addProfiledSensor(SoSensor * sensor, const QString & label);
+  void QUARTER_DLL_API removeProfiledSensor(SoSensor * sensor);
 };
 
 }}} // namespace
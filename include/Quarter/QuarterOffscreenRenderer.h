@@ -0,0 +1,102 @@
+#ifndef QUARTER_QUARTEROFFSCREENRENDERER_H
+#define QUARTER_QUARTEROFFSCREENRENDERER_H
+
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+#include <QtCore/QObject>
+#include <QtCore/QSize>
+#include <QColor>
+#include <QImage>
+#include <Quarter/Basic.h>
+
+#if QT_VERSION >= 0x050000
+
+class QOpenGLContext;
+class QOpenGLFramebufferObject;
+class SoNode;
+class SoCamera;
+class SoRenderManager;
+
+namespace SIM { namespace Coin3D { namespace Quarter {
+
+class QuarterWidget;
+
+class QUARTER_DLL_API QuarterOffscreenRenderer : public QObject {
+  Q_OBJECT
+  typedef QObject inherited;
+
+public:
+  explicit QuarterOffscreenRenderer(const QSize & size = QSize(512, 512),
+                                    const QuarterWidget * sharewidget = 0,
+                                    QObject * parent = 0);
+  virtual ~QuarterOffscreenRenderer();
+
+  bool isValid(void) const;
+
+  void setSize(const QSize & size);
+  QSize size(void) const;
+
+  void setBackgroundColor(const QColor & color);
+  QColor backgroundColor(void) const;
+
+  virtual void setSceneGraph(SoNode * root);
+  virtual SoNode * getSceneGraph(void) const;
+  SoCamera * getCamera(void) const;
+
+  SoRenderManager * getSoRenderManager(void) const;
+  uint32_t getCacheContextId(void) const;
+
+  QOpenGLContext * context(void) const;
+  QOpenGLFramebufferObject * framebufferObject(void) const;
+
+  bool makeCurrent(void);
+  void doneCurrent(void);
+
+  void viewAll(void);
+  bool render(void);
+  QImage grabImage(void);
+  bool renderTiled(const QSize & size, const QString & filename,
+                   const QSize & tilesize = QSize(2048, 2048));
+
+  static bool setupHeadlessPlatform(void);
+
+private:
+  friend class QuarterOffscreenRendererP;
+  class QuarterOffscreenRendererP * pimpl;
+};
+
+}}} // namespace
+
+#endif // QT_VERSION >= 0x050000
+
+#endif // QUARTER_QUARTEROFFSCREENRENDERER_H
@@ -0,0 +1,122 @@
+#ifndef QUARTER_QUARTERQUICKITEM_H
+#define QUARTER_QUARTERQUICKITEM_H
+
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+#include <QtCore/QtGlobal>
+#include <QColor>
+#include <QUrl>
+
+#if QT_VERSION >= 0x050200
+
+#include <QQuickFramebufferObject>
+#include <Quarter/Basic.h>
+#include <Quarter/QuarterWidget.h>
+
+class QHoverEvent;
+class QKeyEvent;
+class QMouseEvent;
+class QWheelEvent;
+class SoNode;
+class SoEvent;
+class SoEventManager;
+class SoDirectionalLight;
+class SoScXMLStateMachine;
+
+namespace SIM { namespace Coin3D { namespace Quarter {
+
+class QUARTER_DLL_API QuarterQuickItem : public QQuickFramebufferObject {
+  typedef QQuickFramebufferObject inherited;
+  Q_OBJECT
+
+  Q_PROPERTY(QUrl navigationModeFile READ navigationModeFile WRITE setNavigationModeFile RESET resetNavigationModeFile)
+  Q_PROPERTY(QColor backgroundColor READ backgroundColor WRITE setBackgroundColor)
+  Q_PROPERTY(bool headlightEnabled READ headlightEnabled WRITE setHeadlightEnabled)
+
+public:
+  explicit QuarterQuickItem(QQuickItem * parent = 0);
+  virtual ~QuarterQuickItem();
+
+  void setBackgroundColor(const QColor & color);
+  QColor backgroundColor(void) const;
+
+  void resetNavigationModeFile(void);
+  void setNavigationModeFile(const QUrl & url = QUrl(DEFAULT_NAVIGATIONFILE));
+  const QUrl & navigationModeFile(void) const;
+
+  bool headlightEnabled(void) const;
+  void setHeadlightEnabled(bool onoff);
+  SoDirectionalLight * getHeadlight(void);
+
+  virtual void setSceneGraph(SoNode * root);
+  virtual SoNode * getSceneGraph(void) const;
+
+  SoEventManager * getSoEventManager(void) const;
+
+  void addStateMachine(SoScXMLStateMachine * statemachine);
+  void removeStateMachine(SoScXMLStateMachine * statemachine);
+
+  virtual bool processSoEvent(const SoEvent * event);
+
+  virtual Renderer * createRenderer(void) const;
+
+public slots:
+  virtual void viewAll(void);
+  virtual void seek(void);
+
+protected:
+#if QT_VERSION >= 0x060000
+  virtual void geometryChange(const QRectF & newgeometry, const QRectF & oldgeometry);
+#else
+  virtual void geometryChanged(const QRectF & newgeometry, const QRectF & oldgeometry);
+#endif
+  virtual void mousePressEvent(QMouseEvent * event);
+  virtual void mouseMoveEvent(QMouseEvent * event);
+  virtual void mouseReleaseEvent(QMouseEvent * event);
+  virtual void mouseDoubleClickEvent(QMouseEvent * event);
+  virtual void hoverMoveEvent(QHoverEvent * event);
+  virtual void wheelEvent(QWheelEvent * event);
+  virtual void keyPressEvent(QKeyEvent * event);
+  virtual void keyReleaseEvent(QKeyEvent * event);
+
+private:
+  friend class QuarterQuickItemP;
+  friend class QuarterQuickRenderer;
+  class QuarterQuickItemP * pimpl;
+};
+
+}}} // namespace
+
+#endif // QT_VERSION >= 0x050200
+
+#endif // QUARTER_QUARTERQUICKITEM_H
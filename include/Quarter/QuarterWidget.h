@@ -38,17 +38,24 @@
 #include <Inventor/actions/SoGLRenderAction.h>
 
 #include <QColor>
+#include <QPoint>
+#include <QRectF>
 #include <QUrl>
+#include <QVector>
 #if QT_VERSION >= 0x060000
 #include <QOpenGLWidget>
 #else
 #include <QGLWidget>
 #endif
 #include <Quarter/Basic.h>
+#include <Quarter/FrameStatistics.h>
 
 class QAction;
+class QImage;
 class QMenu;
 class SoNode;
+class SoPath;
+class SoPickedPoint;
 class SoEvent;
 class SoCamera;
 class SoEventManager;
@@ -59,6 +66,7 @@ class SoScXMLStateMachine;
 namespace SIM { namespace Coin3D { namespace Quarter {
 
 class EventFilter;
+class FrameSink;
 const char DEFAULT_NAVIGATIONFILE []  = "coin:///scxml/navigation/examiner.xml";
 
 #if QT_VERSION >= 0x060000
@@ -71,6 +79,7 @@ class QUARTER_DLL_API QuarterWidget : public QGLWidget {
   Q_OBJECT
 
   Q_PROPERTY(QUrl navigationModeFile READ navigationModeFile WRITE setNavigationModeFile RESET resetNavigationModeFile)
+  Q_PROPERTY(NavigationMode navigationMode READ navigationMode WRITE setNavigationMode)
   Q_PROPERTY(QColor backgroundColor READ backgroundColor WRITE setBackgroundColor)
   Q_PROPERTY(bool contextMenuEnabled READ contextMenuEnabled WRITE setContextMenuEnabled)
   Q_PROPERTY(bool headlightEnabled READ headlightEnabled WRITE setHeadlightEnabled)
@@ -78,15 +87,41 @@ class QUARTER_DLL_API QuarterWidget : public QGLWidget {
   Q_PROPERTY(bool clearWindow READ clearWindow WRITE setClearWindow)
   Q_PROPERTY(bool interactionModeEnabled READ interactionModeEnabled WRITE setInteractionModeEnabled)
   Q_PROPERTY(bool interactionModeOn READ interactionModeOn WRITE setInteractionModeOn)
+  Q_PROPERTY(bool framePacingEnabled READ framePacingEnabled WRITE setFramePacingEnabled)
+  Q_PROPERTY(double maxFrameRate READ maxFrameRate WRITE setMaxFrameRate)
+  Q_PROPERTY(double unfocusedFrameRate READ unfocusedFrameRate WRITE setUnfocusedFrameRate)
+  Q_PROPERTY(bool sharedFrameSchedulingEnabled READ sharedFrameSchedulingEnabled WRITE setSharedFrameSchedulingEnabled)
+  Q_PROPERTY(bool boundingBoxCacheEnabled READ boundingBoxCacheEnabled WRITE setBoundingBoxCacheEnabled)
+  Q_PROPERTY(double cacheEvictionDelay READ cacheEvictionDelay WRITE setCacheEvictionDelay)
+  Q_PROPERTY(bool autoSuspendEnabled READ autoSuspendEnabled WRITE setAutoSuspendEnabled)
+  Q_PROPERTY(bool autoSuspendAnimations READ autoSuspendAnimations WRITE setAutoSuspendAnimations)
+  Q_PROPERTY(bool deferredResizeEnabled READ deferredResizeEnabled WRITE setDeferredResizeEnabled)
+  Q_PROPERTY(double resizeCommitDelay READ resizeCommitDelay WRITE setResizeCommitDelay)
+  Q_PROPERTY(bool renderThreadEnabled READ renderThreadEnabled WRITE setRenderThreadEnabled)
+  Q_PROPERTY(bool frameReuseEnabled READ frameReuseEnabled WRITE setFrameReuseEnabled)
+  Q_PROPERTY(bool damageTrackingEnabled READ damageTrackingEnabled WRITE setDamageTrackingEnabled)
+  Q_PROPERTY(bool frameStatisticsEnabled READ frameStatisticsEnabled WRITE setFrameStatisticsEnabled)
+  Q_PROPERTY(double frameBudget READ frameBudget WRITE setFrameBudget)
+  Q_PROPERTY(bool performanceHudEnabled READ performanceHudEnabled WRITE setPerformanceHudEnabled)
+  Q_PROPERTY(bool resolutionScalingEnabled READ resolutionScalingEnabled WRITE setResolutionScalingEnabled)
+  Q_PROPERTY(double targetFrameTime READ targetFrameTime WRITE setTargetFrameTime)
+  Q_PROPERTY(double minimumResolutionScale READ minimumResolutionScale WRITE setMinimumResolutionScale)
+  Q_PROPERTY(bool accumulationAntialiasingEnabled READ accumulationAntialiasingEnabled WRITE setAccumulationAntialiasingEnabled)
+  Q_PROPERTY(int accumulationSamples READ accumulationSamples WRITE setAccumulationSamples)
+  Q_PROPERTY(bool interactiveQualityEnabled READ interactiveQualityEnabled WRITE setInteractiveQualityEnabled)
+  Q_PROPERTY(RenderMode interactiveRenderMode READ interactiveRenderMode WRITE setInteractiveRenderMode)
+  Q_PROPERTY(TransparencyType interactiveTransparencyType READ interactiveTransparencyType WRITE setInteractiveTransparencyType)
 
   Q_PROPERTY(TransparencyType transparencyType READ transparencyType WRITE setTransparencyType)
   Q_PROPERTY(RenderMode renderMode READ renderMode WRITE setRenderMode)
   Q_PROPERTY(StereoMode stereoMode READ stereoMode WRITE setStereoMode)
+  Q_PROPERTY(bool stereoSceneCachingEnabled READ stereoSceneCachingEnabled WRITE setStereoSceneCachingEnabled)
   Q_PROPERTY(qreal devicePixelRatio READ devicePixelRatio NOTIFY devicePixelRatioChanged)
 
   Q_ENUMS(TransparencyType)
   Q_ENUMS(RenderMode)
   Q_ENUMS(StereoMode)
+  Q_ENUMS(NavigationMode)
 
 
 public:
@@ -116,7 +151,8 @@ public:
     SORTED_OBJECT_SORTED_TRIANGLE_ADD = SoGLRenderAction::SORTED_OBJECT_SORTED_TRIANGLE_ADD,
     SORTED_OBJECT_SORTED_TRIANGLE_BLEND = SoGLRenderAction::SORTED_OBJECT_SORTED_TRIANGLE_BLEND,
     NONE = SoGLRenderAction::NONE,
-    SORTED_LAYERS_BLEND = SoGLRenderAction::SORTED_LAYERS_BLEND
+    SORTED_LAYERS_BLEND = SoGLRenderAction::SORTED_LAYERS_BLEND,
+    WEIGHTED_BLENDED = 0x100
   };
 
   enum RenderMode {
@@ -125,7 +161,8 @@ public:
     WIREFRAME_OVERLAY = SoRenderManager::WIREFRAME_OVERLAY,
     POINTS = SoRenderManager::POINTS,
     HIDDEN_LINE = SoRenderManager::HIDDEN_LINE,
-    BOUNDING_BOX = SoRenderManager::BOUNDING_BOX
+    BOUNDING_BOX = SoRenderManager::BOUNDING_BOX,
+    OCCLUSION_CULLING = 0x100
   };
 
   enum StereoMode {
@@ -136,10 +173,25 @@ public:
     INTERLEAVED_COLUMNS = SoRenderManager::INTERLEAVED_COLUMNS
   };
 
+  enum NavigationMode {
+    SCXML,
+    EXAMINER_NATIVE,
+    PLANE_NATIVE,
+    FLY_NATIVE
+  };
+
+  enum LayerPosition {
+    BACKGROUND,
+    FOREGROUND
+  };
+
   TransparencyType transparencyType(void) const;
   RenderMode renderMode(void) const;
   StereoMode stereoMode(void) const;
 
+  void setStereoSceneCachingEnabled(bool onoff);
+  bool stereoSceneCachingEnabled(void) const;
+
   void setBackgroundColor(const QColor & color);
   QColor backgroundColor(void) const;
 
@@ -149,6 +201,9 @@ public:
   void setNavigationModeFile(const QUrl & url = QUrl(DEFAULT_NAVIGATIONFILE));
   const QUrl & navigationModeFile(void) const;
 
+  void setNavigationMode(NavigationMode mode);
+  NavigationMode navigationMode(void) const;
+
   void setContextMenuEnabled(bool yes);
   bool contextMenuEnabled(void) const;
   QMenu * getContextMenu(void) const;
@@ -169,12 +224,104 @@ public:
   bool interactionModeOn(void) const;
   void setInteractionModeOn(bool onoff);
 
+  bool framePacingEnabled(void) const;
+  void setFramePacingEnabled(bool onoff);
+
+  double maxFrameRate(void) const;
+  void setMaxFrameRate(double rate);
+  double unfocusedFrameRate(void) const;
+  void setUnfocusedFrameRate(double rate);
+
+  bool sharedFrameSchedulingEnabled(void) const;
+  void setSharedFrameSchedulingEnabled(bool onoff);
+
+  bool boundingBoxCacheEnabled(void) const;
+  void setBoundingBoxCacheEnabled(bool onoff);
+
+  double cacheEvictionDelay(void) const;
+  void setCacheEvictionDelay(double sec);
+  size_t textureMemoryUsage(void) const;
+  size_t cacheMemoryUsage(void) const;
+  bool prewarm(void);
+  bool isPrewarming(void) const;
+
+  bool autoSuspendEnabled(void) const;
+  void setAutoSuspendEnabled(bool onoff);
+  bool autoSuspendAnimations(void) const;
+  void setAutoSuspendAnimations(bool onoff);
+  bool isSuspended(void) const;
+
+  bool deferredResizeEnabled(void) const;
+  void setDeferredResizeEnabled(bool onoff);
+  double resizeCommitDelay(void) const;
+  void setResizeCommitDelay(double sec);
+
+  bool renderThreadEnabled(void) const;
+  void setRenderThreadEnabled(bool onoff);
+
+  bool frameReuseEnabled(void) const;
+  void setFrameReuseEnabled(bool onoff);
+
+  bool damageTrackingEnabled(void) const;
+  void setDamageTrackingEnabled(bool onoff);
+
+  bool frameStatisticsEnabled(void) const;
+  void setFrameStatisticsEnabled(bool onoff);
+  FrameStatistics frameStatistics(void) const;
+  QVector<int> frameTimingHistogram(FrameStatistics::Timing timing,
+                                    double binwidth = 0.002, int numbins = 25) const;
+
+  double frameBudget(void) const;
+  bool performanceHudEnabled(void) const;
+  void setPerformanceHudEnabled(bool onoff);
+  void setFrameBudget(double sec);
+
+  typedef void FrameCaptureCB(void * userdata, const QImage & image);
+  void requestFrameCapture(FrameCaptureCB * callback, void * userdata = NULL);
+
+  enum RecordingPolicy {
+    DROP_FRAMES,
+    BLOCK_RENDERING
+  };
+
+  bool startRecording(FrameSink * sink, RecordingPolicy policy = DROP_FRAMES, int queuelength = 8);
+  void stopRecording(void);
+  bool isRecording(void) const;
+  int recordedFrames(void) const;
+  int droppedFrames(void) const;
+
+  bool resolutionScalingEnabled(void) const;
+  void setResolutionScalingEnabled(bool onoff);
+  double targetFrameTime(void) const;
+  void setTargetFrameTime(double sec);
+  double minimumResolutionScale(void) const;
+  void setMinimumResolutionScale(double scale);
+  double resolutionScale(void) const;
+
+  bool accumulationAntialiasingEnabled(void) const;
+  void setAccumulationAntialiasingEnabled(bool onoff);
+  int accumulationSamples(void) const;
+  void setAccumulationSamples(int num);
+
+  bool interactiveQualityEnabled(void) const;
+  void setInteractiveQualityEnabled(bool onoff);
+  RenderMode interactiveRenderMode(void) const;
+  void setInteractiveRenderMode(RenderMode mode);
+  TransparencyType interactiveTransparencyType(void) const;
+  void setInteractiveTransparencyType(TransparencyType type);
+  void setInteractiveState(const SbName & state, bool onoff);
+  bool isInteractiveState(const SbName & state) const;
+
+  void addCachedLayer(SoNode * layer, LayerPosition position = FOREGROUND);
+  void removeCachedLayer(SoNode * layer);
+
   void setStateCursor(const SbName & state, const QCursor & cursor);
   QCursor stateCursor(const SbName & state);
 
   uint32_t getCacheContextId(void) const;
 
   virtual void setSceneGraph(SoNode * root);
+  void setSceneGraphWithCamera(SoNode * root, SoCamera * camera);
   virtual SoNode * getSceneGraph(void) const;
 
   void setSoEventManager(SoEventManager * manager);
@@ -189,6 +336,18 @@ public:
   void removeStateMachine(SoScXMLStateMachine * statemachine);
 
   virtual bool processSoEvent(const SoEvent * event);
+
+  SoPath * pickAt(const QPoint & pos);
+  QVector<SoPickedPoint *> pickMany(const QVector<QPoint> & points);
+
+  int addViewport(const QRectF & rect, SoCamera * camera = NULL);
+  void removeViewport(int index);
+  void removeAllViewports(void);
+  int viewportCount(void) const;
+  SoCamera * getViewportCamera(int index) const;
+  void setViewportRect(int index, const QRectF & rect);
+  QRectF viewportRect(int index) const;
+  int viewportAt(const QPoint & pos) const;
   virtual QSize minimumSizeHint(void) const;
 
   QList<QAction *> transparencyTypeActions(void) const;
@@ -207,6 +366,9 @@ public slots:
 
 signals:
   void devicePixelRatioChanged(qreal dev_pixel_ratio);
+  void frameBudgetExceeded(double frametime);
+  void prewarmFinished(void);
+  void interactiveQualityChanged(bool reduced);
 
 protected:
   virtual void resizeGL(int width, int height);
@@ -214,6 +376,9 @@ protected:
   virtual void paintGL(void);
   virtual void actualRedraw(void);
   virtual bool updateDevicePixelRatio(void);
+#if QT_VERSION < 0x060000
+  virtual void glDraw(void);
+#endif
 
 private:
 #if QT_VERSION >= 0x060000
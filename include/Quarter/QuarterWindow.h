@@ -0,0 +1,138 @@
+#ifndef QUARTER_QUARTERWINDOW_H
+#define QUARTER_QUARTERWINDOW_H
+
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+#include <QtCore/QtGlobal>
+#include <QColor>
+#include <QUrl>
+
+#if QT_VERSION >= 0x050000
+
+#include <QWindow>
+#include <QSurfaceFormat>
+#include <Quarter/Basic.h>
+#include <Quarter/QuarterWidget.h>
+
+class QOpenGLContext;
+class QScreen;
+class QExposeEvent;
+class QResizeEvent;
+class SoNode;
+class SoEvent;
+class SoEventManager;
+class SoRenderManager;
+class SoDirectionalLight;
+class SoScXMLStateMachine;
+
+namespace SIM { namespace Coin3D { namespace Quarter {
+
+class EventFilter;
+
+class QUARTER_DLL_API QuarterWindow : public QWindow {
+  typedef QWindow inherited;
+  Q_OBJECT
+
+  Q_PROPERTY(QUrl navigationModeFile READ navigationModeFile WRITE setNavigationModeFile RESET resetNavigationModeFile)
+  Q_PROPERTY(QColor backgroundColor READ backgroundColor WRITE setBackgroundColor)
+  Q_PROPERTY(bool headlightEnabled READ headlightEnabled WRITE setHeadlightEnabled)
+  Q_PROPERTY(bool interactionModeEnabled READ interactionModeEnabled WRITE setInteractionModeEnabled)
+  Q_PROPERTY(bool gpuAffinityEnabled READ gpuAffinityEnabled WRITE setGpuAffinityEnabled)
+
+public:
+  explicit QuarterWindow(QWindow * parent = 0);
+  explicit QuarterWindow(const QSurfaceFormat & format, QWindow * parent = 0);
+  virtual ~QuarterWindow();
+
+  void setBackgroundColor(const QColor & color);
+  QColor backgroundColor(void) const;
+
+  void resetNavigationModeFile(void);
+  void setNavigationModeFile(const QUrl & url = QUrl(DEFAULT_NAVIGATIONFILE));
+  const QUrl & navigationModeFile(void) const;
+
+  bool headlightEnabled(void) const;
+  void setHeadlightEnabled(bool onoff);
+  SoDirectionalLight * getHeadlight(void);
+
+  bool interactionModeEnabled(void) const;
+  void setInteractionModeEnabled(bool onoff);
+
+  bool gpuAffinityEnabled(void) const;
+  void setGpuAffinityEnabled(bool onoff);
+
+  QOpenGLContext * context(void) const;
+  uint32_t getCacheContextId(void) const;
+
+  virtual void setSceneGraph(SoNode * root);
+  virtual SoNode * getSceneGraph(void) const;
+
+  SoEventManager * getSoEventManager(void) const;
+  SoRenderManager * getSoRenderManager(void) const;
+
+  EventFilter * getEventFilter(void) const;
+
+  void addStateMachine(SoScXMLStateMachine * statemachine);
+  void removeStateMachine(SoScXMLStateMachine * statemachine);
+
+  virtual bool processSoEvent(const SoEvent * event);
+
+public slots:
+  virtual void viewAll(void);
+  virtual void seek(void);
+
+  void redraw(void);
+
+protected:
+  virtual bool event(QEvent * event);
+  virtual void exposeEvent(QExposeEvent * event);
+  virtual void resizeEvent(QResizeEvent * event);
+
+  virtual void initializeGL(void);
+  virtual void paintGL(void);
+  virtual void actualRedraw(void);
+
+private slots:
+  void changeScreen(QScreen * screen);
+
+private:
+  void constructor(const QSurfaceFormat & format);
+  friend class QuarterWindowP;
+  class QuarterWindowP * pimpl;
+};
+
+}}} // namespace
+
+#endif // QT_VERSION >= 0x050000
+
+#endif // QUARTER_QUARTERWINDOW_H
@@ -0,0 +1,94 @@
+#ifndef QUARTER_SCENEANALYZER_H
+#define QUARTER_SCENEANALYZER_H
+
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+#include <QtCore/QString>
+#include <Inventor/SbViewportRegion.h>
+#include <Quarter/Basic.h>
+
+class SoNode;
+class SoCamera;
+
+namespace SIM { namespace Coin3D { namespace Quarter {
+
+class QUARTER_DLL_API SceneAnalyzer {
+public:
+  enum CacheState {
+    NOT_A_SEPARATOR,
+    CACHING_AUTO,
+    CACHING_ON,
+    CACHING_OFF,
+    CACHING_BROKEN
+  };
+
+  enum SortKey {
+    RENDER_TIME,
+    PRIMITIVES,
+    NODES,
+    TEXTURE_MEMORY
+  };
+
+  SceneAnalyzer(const SbViewportRegion & region = SbViewportRegion(512, 512));
+  ~SceneAnalyzer();
+
+  void setTimingEnabled(bool yes);
+  bool timingEnabled(void) const;
+
+  bool analyze(SoNode * scene, SoCamera * camera = NULL);
+  void sort(SortKey key);
+
+  int numSubgraphs(void) const;
+  SoNode * getNode(int index) const;
+  QString getName(int index) const;
+  int getDepth(int index) const;
+  bool isTopLevel(int index) const;
+  int getNodeCount(int index) const;
+  int getPrimitiveCount(int index) const;
+  size_t getTextureMemory(int index) const;
+  CacheState getCacheState(int index) const;
+  QString getCacheBreakers(int index) const;
+  double getFirstRenderTime(int index) const;
+  double getRenderTime(int index) const;
+
+  QString report(int maxentries = 50) const;
+
+private:
+  SceneAnalyzer(const SceneAnalyzer &);
+  SceneAnalyzer & operator=(const SceneAnalyzer &);
+  class SceneAnalyzerP * pimpl;
+};
+
+}}} // namespace
+
+#endif // QUARTER_SCENEANALYZER_H
@@ -0,0 +1,93 @@
+#ifndef QUARTER_SCENELOADER_H
+#define QUARTER_SCENELOADER_H
+
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+#include <QtCore/QObject>
+#include <QtCore/QByteArray>
+#include <QtCore/QString>
+#include <Quarter/Basic.h>
+
+class SoNode;
+
+namespace SIM { namespace Coin3D { namespace Quarter {
+
+class QuarterWidget;
+
+class QUARTER_DLL_API SceneLoader : public QObject {
+  Q_OBJECT
+public:
+  SceneLoader(QObject * parent = 0);
+  virtual ~SceneLoader();
+
+  void setTarget(QuarterWidget * target);
+  QuarterWidget * target(void) const;
+
+  bool load(const QString & filename);
+  void loadBuffer(const QByteArray & buffer);
+  bool isLoading(void) const;
+
+  void setStreaming(bool enable);
+  bool isStreaming(void) const;
+
+  void setOptimizing(bool enable);
+  bool isOptimizing(void) const;
+
+  static void setMaxConcurrentLoads(int count);
+  static int maxConcurrentLoads(void);
+
+  static void setCacheDirectory(const QString & path);
+  static QString cacheDirectory(void);
+  static void setCacheSize(qint64 bytes);
+  static qint64 cacheSize(void);
+
+public slots:
+  void cancel(void);
+
+signals:
+  void progress(double fraction);
+  void loaded(SoNode * root);
+  void failed(void);
+
+private slots:
+  void loaderFinished(void);
+  void updateProgress(void);
+
+private:
+  class SceneLoaderP * pimpl;
+  friend class SceneLoaderP;
+};
+
+}}} // namespace
+
+#endif // QUARTER_SCENELOADER_H
@@ -0,0 +1,71 @@
+#ifndef QUARTER_SCENEOPTIMIZER_H
+#define QUARTER_SCENEOPTIMIZER_H
+
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+#include <Quarter/Basic.h>
+
+class SoNode;
+
+namespace SIM { namespace Coin3D { namespace Quarter {
+
+class QUARTER_DLL_API SceneOptimizer {
+public:
+  enum Pass {
+    STRIP_STATE = 0x01,
+    CONVERT_VERTEX_PROPERTY = 0x02,
+    MERGE_SHAPES = 0x04,
+    REORDER_INDICES = 0x08,
+    ALL_PASSES = 0x0f
+  };
+
+  SceneOptimizer(void);
+  ~SceneOptimizer();
+
+  void setPasses(int passes);
+  int passes(void) const;
+
+  bool optimize(SoNode * root);
+
+  int getShapeCountBefore(void) const;
+  int getShapeCountAfter(void) const;
+
+private:
+  SceneOptimizer(const SceneOptimizer &);
+  SceneOptimizer & operator=(const SceneOptimizer &);
+  class SceneOptimizerP * pimpl;
+};
+
+}}} // namespace
+
+#endif // QUARTER_SCENEOPTIMIZER_H
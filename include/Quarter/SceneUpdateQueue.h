@@ -0,0 +1,110 @@
+#ifndef QUARTER_SCENEUPDATEQUEUE_H
+#define QUARTER_SCENEUPDATEQUEUE_H
+
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+#include <QtCore/QVector>
+#include <Quarter/Basic.h>
+
+class SoField;
+
+namespace SIM { namespace Coin3D { namespace Quarter {
+
+class QUARTER_DLL_API SceneEdit {
+public:
+  SceneEdit(SoField * field);
+  virtual ~SceneEdit();
+
+  SoField * getField(void) const { return this->field; }
+  virtual void apply(void) = 0;
+
+private:
+  SoField * field;
+  SceneEdit * next;
+  friend class SceneUpdateQueue;
+};
+
+template <class FieldType, class ValueType>
+class SFieldEdit : public SceneEdit {
+public:
+  SFieldEdit(FieldType * field, const ValueType & value)
+    : SceneEdit(field), value(value) { }
+
+  virtual void apply(void) {
+    static_cast<FieldType *>(this->getField())->setValue(this->value);
+  }
+
+private:
+  ValueType value;
+};
+
+template <class FieldType, class ValueType>
+class MFieldEdit : public SceneEdit {
+public:
+  MFieldEdit(FieldType * field, int start, const QVector<ValueType> & values, bool truncate)
+    : SceneEdit(field), start(start), values(values), truncate(truncate) { }
+
+  virtual void apply(void) {
+    FieldType * field = static_cast<FieldType *>(this->getField());
+    field->setValues(this->start, this->values.size(), this->values.constData());
+    if (this->truncate) field->setNum(this->start + this->values.size());
+  }
+
+private:
+  int start;
+  QVector<ValueType> values;
+  bool truncate;
+};
+
+class QUARTER_DLL_API SceneUpdateQueue {
+public:
+  static void post(SceneEdit * edit);
+  static void flush(void);
+  static void clear(void);
+  static bool isEmpty(void);
+
+  template <class FieldType, class ValueType>
+  static void setValue(FieldType * field, const ValueType & value) {
+    post(new SFieldEdit<FieldType, ValueType>(field, value));
+  }
+
+  template <class FieldType, class ValueType>
+  static void setValues(FieldType * field, int start, const QVector<ValueType> & values,
+                        bool truncate = false) {
+    post(new MFieldEdit<FieldType, ValueType>(field, start, values, truncate));
+  }
+};
+
+}}} // namespace
+
+#endif // QUARTER_SCENEUPDATEQUEUE_H
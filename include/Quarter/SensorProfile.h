@@ -0,0 +1,81 @@
+#ifndef QUARTER_SENSORPROFILE_H
+#define QUARTER_SENSORPROFILE_H
+
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+#include <QtCore/QList>
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+#include <Quarter/Basic.h>
+
+namespace SIM { namespace Coin3D { namespace Quarter {
+
+class QUARTER_DLL_API SensorProfile {
+public:
+  enum Queue {
+    DELAY_QUEUE,
+    TIMER_QUEUE
+  };
+
+  struct QUARTER_DLL_API Entry {
+    Entry(void);
+    double average(void) const;
+
+    QString sensor;
+    QString attachment;
+    int calls;
+    double total;
+    double maximum;
+  };
+
+  SensorProfile(void);
+
+  double duration(void) const;
+  int numPasses(Queue queue) const;
+  double queueTime(Queue queue) const;
+  QList<Entry> entries(void) const;
+  QStringList summary(int maxentries = 5) const;
+
+private:
+  friend class SensorProfiler;
+  enum { NUM_QUEUES = TIMER_QUEUE + 1 };
+
+  double durationvalue;
+  int numpasses[NUM_QUEUES];
+  double queuetime[NUM_QUEUES];
+  QList<Entry> entrylist;
+};
+
+}}} // namespace
+
+#endif // QUARTER_SENSORPROFILE_H
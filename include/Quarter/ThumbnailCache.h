@@ -0,0 +1,88 @@
+#ifndef QUARTER_THUMBNAILCACHE_H
+#define QUARTER_THUMBNAILCACHE_H
+
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+#include <QtCore/QObject>
+#include <QtCore/QSize>
+#include <QtCore/QString>
+#include <QImage>
+#include <Quarter/Basic.h>
+
+#if QT_VERSION >= 0x050000
+
+namespace SIM { namespace Coin3D { namespace Quarter {
+
+class QUARTER_DLL_API ThumbnailCache : public QObject {
+  Q_OBJECT
+  typedef QObject inherited;
+
+public:
+  explicit ThumbnailCache(const QString & cachedirectory = QString(),
+                          QObject * parent = 0);
+  virtual ~ThumbnailCache();
+
+  QString cacheDirectory(void) const;
+
+  void setThumbnailSize(const QSize & size);
+  QSize thumbnailSize(void) const;
+
+  void setMaximumConcurrency(int threads);
+  int maximumConcurrency(void) const;
+
+  void requestThumbnail(const QString & path);
+  QImage cachedThumbnail(const QString & path) const;
+
+public slots:
+  void cancelPending(void);
+
+signals:
+  void thumbnailReady(const QString & path, const QImage & image);
+  void thumbnailFailed(const QString & path);
+
+private slots:
+  void deliver(const QString & path, const QImage & image);
+  void renderMiss(const QString & path, const QString & cachefile,
+                  const QSize & size);
+  void renderNext(void);
+
+private:
+  friend class ThumbnailCacheP;
+  class ThumbnailCacheP * pimpl;
+};
+
+}}} // namespace
+
+#endif // QT_VERSION >= 0x050000
+
+#endif // QUARTER_THUMBNAILCACHE_H
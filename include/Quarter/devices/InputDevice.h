@@ -35,8 +35,10 @@
 
 #include <Quarter/Basic.h>
 #include <Inventor/SbVec2s.h>
+#include <QtCore/QtGlobal>
+#include <QtCore/QEvent>
+#include <QtCore/QList>
 
-class QEvent;
 class SoEvent;
 class QInputEvent;
 
@@ -55,13 +57,17 @@ public:
   */
   virtual const SoEvent * translateEvent(QEvent * event) = 0;
 
+  virtual QList<QEvent::Type> eventTypes(void) const;
+
   void setMousePosition(const SbVec2s & pos);
   void setWindowSize(const SbVec2s & size);
+  void setDevicePixelRatio(qreal ratio);
   void setModifiers(SoEvent * soevent, const QInputEvent * qevent);
 
 protected:
   SbVec2s mousepos;
   SbVec2s windowsize;
+  qreal devicepixelratio;
   QuarterWidget* quarter;
 };
 
@@ -47,6 +47,7 @@ public:
   virtual ~Keyboard();
 
   virtual const SoEvent * translateEvent(QEvent * event);
+  virtual QList<QEvent::Type> eventTypes(void) const;
 
 private:
   friend class KeyboardP;
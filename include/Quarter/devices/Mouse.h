@@ -49,6 +49,7 @@ public:
   virtual ~Mouse();
 
   virtual const SoEvent * translateEvent(QEvent * event);
+  virtual QList<QEvent::Type> eventTypes(void) const;
 
 private:
   friend class MouseP;
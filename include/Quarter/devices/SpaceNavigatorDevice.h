@@ -45,6 +45,7 @@ class QUARTER_DLL_API SpaceNavigatorDevice : public InputDevice {
   SpaceNavigatorDevice(QuarterWidget* quarter);
   virtual ~SpaceNavigatorDevice();
   virtual const SoEvent * translateEvent(QEvent * event);
+  virtual QList<QEvent::Type> eventTypes(void) const;
 
  private:
   class SpaceNavigatorDeviceP * pimpl;
@@ -42,6 +42,7 @@ class SoEvent;
 namespace SIM { namespace Coin3D { namespace Quarter {
 
 class QuarterWidget;
+class SceneLoader;
 
 class QUARTER_DLL_API DragDropHandler : public QObject {
   Q_OBJECT
@@ -49,6 +50,8 @@ public:
   DragDropHandler(QuarterWidget * parent);
   virtual ~DragDropHandler();
 
+  SceneLoader * sceneLoader(void) const;
+
 protected:
   virtual bool eventFilter(QObject *, QEvent * event);
 
@@ -55,9 +55,19 @@ public:
 
   const QPoint & globalMousePosition(void) const;
 
+  void setCoalescingEnabled(bool yes);
+  bool coalescingEnabled(void) const;
+
+  void setLateLatchingEnabled(bool yes);
+  bool lateLatchingEnabled(void) const;
+  bool latchPendingEvent(void);
+
 protected:
   bool eventFilter(QObject * obj, QEvent * event);
 
+private slots:
+  void flushPendingEvent(void);
+
 private:
   class EventFilterP * pimpl;
 };
@@ -0,0 +1,359 @@
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+/*
+  Renders still frames of a QuarterWidget with accumulation
+  antialiasing. Frames rendered while the scene or the camera
+  changes are shown as they are. Once nothing has changed for a
+  moment, the scene is rendered again a number of times from the
+  same camera, with its projection offset by a different fraction of
+  a pixel each time, and the frames are averaged into a framebuffer
+  object that is shown in their place. The image converges towards
+  one rendered with as many samples per pixel, without paying for
+  multisampling on every interactive frame.
+
+  Anything that schedules a redraw through the render manager resets
+  the accumulation. The extra frames are driven by a zero-interval
+  timer, like the sensor manager's idle queue, so they are only
+  rendered while the event loop has nothing else to do.
+ */
+
+#include "AccumulationAntialiasing.h"
+
+#include <QtCore/QTimer>
+#if (QT_VERSION >= 0x050000)
+#  include <QOpenGLContext>
+#  include <QOpenGLFramebufferObject>
+#  include <QOpenGLFramebufferObjectFormat>
+#  include <QOpenGLFunctions>
+#endif
+
+#include <Inventor/SbBasic.h>
+#include <Inventor/SbViewportRegion.h>
+#include <Inventor/SoRenderManager.h>
+#include <Inventor/system/gl.h>
+
+#include <Quarter/QuarterWidget.h>
+
+#include "QuarterRenderAction.h"
+
+#ifndef GL_RGBA16F
+#define GL_RGBA16F 0x881A
+#endif
+#ifndef GL_CONSTANT_ALPHA
+#define GL_CONSTANT_ALPHA 0x8003
+#endif
+#ifndef GL_ONE_MINUS_CONSTANT_ALPHA
+#define GL_ONE_MINUS_CONSTANT_ALPHA 0x8004
+#endif
+
+using namespace SIM::Coin3D::Quarter;
+
+// seconds the scene must be still before accumulating. Longer than
+// the ResolutionScaler waits before its full resolution frame, which
+// then becomes the first sample
+static const double IDLE_TIME = 0.3;
+
+static double
+halton(int index, int base)
+{
+  double result = 0.0;
+  double fraction = 1.0 / base;
+  while (index > 0) {
+    result += fraction * (index % base);
+    index /= base;
+    fraction /= base;
+  }
+  return result;
+}
+
+AccumulationAntialiasing::AccumulationAntialiasing(QuarterWidget * quarterwidget,
+                                                   CustomRenderAction * customaction)
+  : QObject(quarterwidget)
+{
+  this->quarterwidget = quarterwidget;
+  this->customaction = customaction;
+  this->isenabled = false;
+  this->numsamples = 16;
+  this->samples = 0;
+  this->tick = false;
+  this->sampling = false;
+  this->support = -1;
+  this->floatbuffer = false;
+  this->samplefbo = NULL;
+  this->accumfbo = NULL;
+
+  this->idletimer = new QTimer(this);
+  this->idletimer->setSingleShot(true);
+  this->connect(this->idletimer, SIGNAL(timeout(void)), this, SLOT(idle()));
+}
+
+AccumulationAntialiasing::~AccumulationAntialiasing()
+{
+}
+
+void
+AccumulationAntialiasing::setEnabled(bool yes)
+{
+  if (yes == this->isenabled) return;
+  this->isenabled = yes;
+  this->invalidate();
+  // schedules a redraw
+  this->customaction->setProjectionJittering(yes);
+}
+
+bool
+AccumulationAntialiasing::enabled(void) const
+{
+  return this->isenabled;
+}
+
+void
+AccumulationAntialiasing::setNumSamples(int num)
+{
+  this->numsamples = SbClamp(num, 1, 256);
+}
+
+int
+AccumulationAntialiasing::numSamples(void) const
+{
+  return this->numsamples;
+}
+
+/*
+  Called from QuarterWidgetP::rendercb() whenever the render manager
+  schedules a redraw. Stops accumulating into a frame that is out of
+  date.
+ */
+void
+AccumulationAntialiasing::invalidate(void)
+{
+  this->idletimer->stop();
+  this->tick = false;
+  this->samples = 0;
+}
+
+/*
+  Called from QuarterWidget::paintGL() before the scene is rendered.
+  Sets the projection jitter for the frame, and returns true if the
+  frame is an extra sample of an unchanged scene.
+ */
+bool
+AccumulationAntialiasing::beginFrame(void)
+{
+  this->sampling = this->isenabled && this->tick && this->samples > 0;
+  this->tick = false;
+
+  QuarterRenderAction * action = this->customaction->installedAction();
+  if (!this->isenabled || !action) {
+    this->sampling = false;
+    return false;
+  }
+  action->setProjectionJitter(this->sampling ?
+                              AccumulationAntialiasing::jitter(this->samples) :
+                              SbVec2f(0.0f, 0.0f));
+  return this->sampling;
+}
+
+/*
+  Called from QuarterWidget::paintGL() after the scene and all layers
+  have been rendered into the widget. An ordinary frame is copied as
+  the first sample, and an extra sample is averaged into the
+  accumulated ones, which are then copied back into the widget.
+ */
+void
+AccumulationAntialiasing::endFrame(void)
+{
+  if (!this->isenabled) return;
+  QuarterRenderAction * action = this->customaction->installedAction();
+  if (action) action->setProjectionJitter(SbVec2f(0.0f, 0.0f));
+  if (!action || !this->supported()) return;
+
+#if (QT_VERSION >= 0x050000)
+  const SbVec2s windowsize =
+    this->quarterwidget->getSoRenderManager()->getViewportRegion().getWindowSize();
+  const QRect rect(0, 0, windowsize[0], windowsize[1]);
+  if (!this->accumfbo || this->accumfbo->size() != rect.size()) {
+    delete this->accumfbo;
+    delete this->samplefbo;
+    QOpenGLFramebufferObjectFormat format;
+    this->samplefbo = new QOpenGLFramebufferObject(rect.size(), format);
+    if (this->floatbuffer) format.setInternalTextureFormat(GL_RGBA16F);
+    this->accumfbo = new QOpenGLFramebufferObject(rect.size(), format);
+    // the frame the samples belonged to had another size
+    this->sampling = false;
+  }
+
+  if (!this->sampling) {
+    QOpenGLFramebufferObject::blitFramebuffer(this->accumfbo, rect, NULL, rect,
+                                              GL_COLOR_BUFFER_BIT, GL_NEAREST);
+    this->samples = 1;
+    // postpone accumulating while frames keep coming
+    this->idletimer->start(int(IDLE_TIME * 1000.0));
+    return;
+  }
+
+  QOpenGLFramebufferObject::blitFramebuffer(this->samplefbo, rect, NULL, rect,
+                                            GL_COLOR_BUFFER_BIT, GL_NEAREST);
+  this->samples++;
+  this->blend(1.0f / float(this->samples));
+  QOpenGLFramebufferObject::blitFramebuffer(NULL, rect, this->accumfbo, rect,
+                                            GL_COLOR_BUFFER_BIT, GL_NEAREST);
+  if (this->samples < this->numsamples) {
+    this->idletimer->start(0);
+  }
+#endif
+}
+
+bool
+AccumulationAntialiasing::hasFramebuffer(void) const
+{
+  return this->accumfbo != NULL;
+}
+
+/*
+  Releases the framebuffer objects. Must be called with the widget's
+  GL context current.
+ */
+void
+AccumulationAntialiasing::cleanup(void)
+{
+  this->invalidate();
+#if (QT_VERSION >= 0x050000)
+  delete this->samplefbo;
+  delete this->accumfbo;
+#endif
+  this->samplefbo = NULL;
+  this->accumfbo = NULL;
+  this->support = -1;
+}
+
+void
+AccumulationAntialiasing::idle(void)
+{
+  if (!this->isenabled || this->samples == 0) return;
+  this->tick = true;
+  this->quarterwidget->redraw();
+}
+
+/*
+  Checks, once per GL context, for framebuffer objects and blits, and
+  whether the accumulation buffer can be a float buffer. An 8 bit
+  accumulation buffer loses some precision in the running average.
+ */
+bool
+AccumulationAntialiasing::supported(void)
+{
+#if (QT_VERSION >= 0x050000)
+  if (this->support >= 0) return this->support == 1;
+  this->support = 0;
+
+  QOpenGLContext * context = QOpenGLContext::currentContext();
+  if (!context) return false;
+  if (!QOpenGLFramebufferObject::hasOpenGLFramebufferObjects() ||
+      !QOpenGLFramebufferObject::hasOpenGLFramebufferBlit()) {
+    return false;
+  }
+  this->floatbuffer = context->format().majorVersion() >= 3 ||
+    context->hasExtension("GL_ARB_texture_float");
+  this->support = 1;
+  return true;
+#else
+  return false;
+#endif
+}
+
+/*
+  Blends the sample into the accumulation buffer with the given
+  weight, which keeps it the average of all samples so far. A
+  constant blend factor is used since the frame's own alpha is not a
+  coverage value.
+ */
+void
+AccumulationAntialiasing::blend(float weight)
+{
+#if (QT_VERSION >= 0x050000)
+  QOpenGLFunctions * gl = QOpenGLContext::currentContext()->functions();
+
+  this->accumfbo->bind();
+  glPushAttrib(GL_ENABLE_BIT | GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT |
+               GL_TEXTURE_BIT | GL_VIEWPORT_BIT);
+  glViewport(0, 0, this->accumfbo->width(), this->accumfbo->height());
+  glDisable(GL_DEPTH_TEST);
+  glDisable(GL_LIGHTING);
+  glDisable(GL_CULL_FACE);
+  glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+  glEnable(GL_BLEND);
+  gl->glBlendColor(0.0f, 0.0f, 0.0f, weight);
+  glBlendFunc(GL_CONSTANT_ALPHA, GL_ONE_MINUS_CONSTANT_ALPHA);
+
+  glEnable(GL_TEXTURE_2D);
+  glBindTexture(GL_TEXTURE_2D, this->samplefbo->texture());
+  glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_REPLACE);
+
+  glMatrixMode(GL_PROJECTION);
+  glPushMatrix();
+  glLoadIdentity();
+  glMatrixMode(GL_MODELVIEW);
+  glPushMatrix();
+  glLoadIdentity();
+
+  glBegin(GL_QUADS);
+  glTexCoord2f(0.0f, 0.0f); glVertex2f(-1.0f, -1.0f);
+  glTexCoord2f(1.0f, 0.0f); glVertex2f(1.0f, -1.0f);
+  glTexCoord2f(1.0f, 1.0f); glVertex2f(1.0f, 1.0f);
+  glTexCoord2f(0.0f, 1.0f); glVertex2f(-1.0f, 1.0f);
+  glEnd();
+
+  glMatrixMode(GL_PROJECTION);
+  glPopMatrix();
+  glMatrixMode(GL_MODELVIEW);
+  glPopMatrix();
+
+  glBindTexture(GL_TEXTURE_2D, 0);
+  glPopAttrib();
+  this->accumfbo->release();
+#else
+  Q_UNUSED(weight);
+#endif
+}
+
+/*
+  Returns the projection offset, in pixels, for the given sample. The
+  first sample is centered, the others follow a Halton sequence that
+  covers the pixel evenly for any number of samples.
+ */
+SbVec2f
+AccumulationAntialiasing::jitter(int sample)
+{
+  return SbVec2f(float(halton(sample, 2) - 0.5), float(halton(sample, 3) - 0.5));
+}
@@ -0,0 +1,92 @@
+#ifndef QUARTER_ACCUMULATIONANTIALIASING_H
+#define QUARTER_ACCUMULATIONANTIALIASING_H
+
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+#include <QtCore/QObject>
+#include <Inventor/SbVec2f.h>
+
+class QTimer;
+class QOpenGLFramebufferObject;
+
+namespace SIM { namespace Coin3D { namespace Quarter {
+
+class QuarterWidget;
+class CustomRenderAction;
+
+class AccumulationAntialiasing : public QObject {
+  Q_OBJECT
+public:
+  AccumulationAntialiasing(QuarterWidget * quarterwidget, CustomRenderAction * customaction);
+  ~AccumulationAntialiasing();
+
+  void setEnabled(bool yes);
+  bool enabled(void) const;
+
+  void setNumSamples(int num);
+  int numSamples(void) const;
+
+  void invalidate(void);
+
+  bool beginFrame(void);
+  void endFrame(void);
+
+  bool hasFramebuffer(void) const;
+  void cleanup(void);
+
+public slots:
+  void idle(void);
+
+private:
+  bool supported(void);
+  void blend(float weight);
+  static SbVec2f jitter(int sample);
+
+  QuarterWidget * quarterwidget;
+  CustomRenderAction * customaction;
+  bool isenabled;
+  int numsamples;
+  int samples;
+  bool tick;
+  bool sampling;
+  int support;
+  bool floatbuffer;
+
+  QOpenGLFramebufferObject * samplefbo;
+  QOpenGLFramebufferObject * accumfbo;
+  QTimer * idletimer;
+};
+
+}}} // namespace
+
+#endif // QUARTER_ACCUMULATIONANTIALIASING_H
@@ -0,0 +1,432 @@
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+/*
+  Keeps the bounding box of a QuarterWidget's scene graph, so that
+  auto-clipping and viewAll() do not traverse the whole scene graph
+  every frame.
+
+  Node sensors invalidate the cache as the scene changes. When the
+  scene graph is a plain group of separators, which is what most
+  large models look like, each top level child gets a box and a
+  sensor of its own. A change then only recomputes the boxes of the
+  children that did change, spread over a thread pool in thread safe
+  Coin builds. Any other scene graph is recomputed as a whole.
+*/
+
+#include "BoundingBoxCache.h"
+
+#include <QtCore/QHash>
+#include <QtCore/QRunnable>
+#include <QtCore/QThreadPool>
+
+#include <math.h>
+
+#include <Inventor/C/basic.h>
+#include <Inventor/SbViewportRegion.h>
+#include <Inventor/actions/SoGetBoundingBoxAction.h>
+#include <Inventor/nodes/SoCamera.h>
+#include <Inventor/nodes/SoGroup.h>
+#include <Inventor/nodes/SoPerspectiveCamera.h>
+#include <Inventor/nodes/SoSeparator.h>
+#include <Inventor/sensors/SoNodeSensor.h>
+#include <Inventor/system/gl.h>
+
+#include <Quarter/QuarterWidget.h>
+
+using namespace SIM::Coin3D::Quarter;
+
+namespace SIM { namespace Coin3D { namespace Quarter {
+
+class BoundingBoxTask : public QRunnable {
+public:
+  BoundingBoxTask(const SbViewportRegion & vp) : vp(vp) { }
+
+  virtual void run(void)
+  {
+    SoGetBoundingBoxAction action(this->vp);
+    for (int i = 0; i < this->nodes.size(); i++) {
+      action.apply(this->nodes[i]);
+      *this->boxes[i] = action.getXfBoundingBox();
+    }
+  }
+
+  SbViewportRegion vp;
+  QVector<SoNode *> nodes;
+  QVector<SbXfBox3f *> boxes;
+};
+
+}}} // namespace
+
+BoundingBoxCache::BoundingBoxCache(QuarterWidget * quarterwidget)
+  : quarterwidget(quarterwidget),
+    enabled(false),
+    clipping(SoRenderManager::VARIABLE_NEAR_PLANE),
+    scene(NULL),
+    group(NULL),
+    scenesensor(NULL),
+    scenevalid(false),
+    pool(NULL)
+{
+}
+
+BoundingBoxCache::~BoundingBoxCache()
+{
+  this->detach();
+  delete this->pool;
+}
+
+/*
+  Enables the cache. While enabled, the render manager's own
+  auto-clipping is turned off, and setClippingPlanes() does the same
+  work from the cached box instead.
+ */
+void
+BoundingBoxCache::setEnabled(bool onoff)
+{
+  if (onoff == this->enabled) return;
+  this->enabled = onoff;
+
+  SoRenderManager * manager = this->quarterwidget->getSoRenderManager();
+  if (onoff) {
+    this->clipping = manager->getAutoClipping();
+    manager->setAutoClipping(SoRenderManager::NO_AUTO_CLIPPING);
+    this->attach();
+  }
+  else {
+    this->detach();
+    manager->setAutoClipping(this->clipping);
+  }
+}
+
+bool
+BoundingBoxCache::isEnabled(void) const
+{
+  return this->enabled;
+}
+
+void
+BoundingBoxCache::setScene(SoNode * scene)
+{
+  if (scene == this->scene) return;
+  this->detach();
+  this->scene = scene;
+  if (this->enabled) this->attach();
+}
+
+void
+BoundingBoxCache::invalidate(void)
+{
+  this->scenevalid = false;
+  for (int i = 0; i < this->children.size(); i++) {
+    this->children[i]->valid = false;
+  }
+}
+
+void
+BoundingBoxCache::attach(void)
+{
+  if (!this->scene) return;
+  this->scenesensor = new SoNodeSensor(BoundingBoxCache::sceneChangedCB, this);
+  // immediate, so that nothing renders with a stale box
+  this->scenesensor->setPriority(0);
+  this->scenesensor->attach(this->scene);
+  this->scenevalid = false;
+
+  const SoType type = this->scene->getTypeId();
+  if (type == SoGroup::getClassTypeId() || type == SoSeparator::getClassTypeId()) {
+    this->group = static_cast<SoGroup *>(this->scene);
+    this->syncChildren();
+  }
+}
+
+void
+BoundingBoxCache::detach(void)
+{
+  this->clearChildren();
+  this->group = NULL;
+  delete this->scenesensor;
+  this->scenesensor = NULL;
+  this->scenevalid = false;
+}
+
+void
+BoundingBoxCache::clearChildren(void)
+{
+  for (int i = 0; i < this->children.size(); i++) {
+    destroyChild(this->children[i]);
+  }
+  this->children.clear();
+}
+
+BoundingBoxCache::Child *
+BoundingBoxCache::createChild(SoNode * node)
+{
+  Child * child = new Child;
+  child->node = node;
+  child->node->ref();
+  child->valid = false;
+  child->sensor = new SoNodeSensor(BoundingBoxCache::childChangedCB, child);
+  child->sensor->setPriority(0);
+  child->sensor->attach(node);
+  return child;
+}
+
+void
+BoundingBoxCache::destroyChild(Child * child)
+{
+  delete child->sensor;
+  child->node->unref();
+  delete child;
+}
+
+/*
+  Brings the per child entries in line with the children of the
+  group, keeping the boxes of children that are still there. Returns
+  false, and falls back to handling the scene as a whole, if a child
+  is not a separator.
+ */
+bool
+BoundingBoxCache::syncChildren(void)
+{
+  const int num = this->group->getNumChildren();
+  bool same = (num == this->children.size());
+  for (int i = 0; same && i < num; i++) {
+    same = (this->children[i]->node == this->group->getChild(i));
+  }
+  if (same) return true;
+
+  QHash<SoNode *, Child *> old;
+  for (int i = 0; i < this->children.size(); i++) {
+    Child * child = this->children[i];
+    if (old.contains(child->node)) destroyChild(child);
+    else old.insert(child->node, child);
+  }
+  this->children.clear();
+
+  bool separators = true;
+  for (int i = 0; i < num; i++) {
+    SoNode * node = this->group->getChild(i);
+    if (!node->isOfType(SoSeparator::getClassTypeId())) {
+      separators = false;
+      break;
+    }
+    Child * child = old.take(node);
+    this->children.append(child ? child : this->createChild(node));
+  }
+  foreach (Child * child, old) destroyChild(child);
+
+  if (!separators) {
+    this->clearChildren();
+    this->group = NULL;
+  }
+  return separators;
+}
+
+void
+BoundingBoxCache::compute(const SbViewportRegion & vp)
+{
+  if (!this->group || !this->syncChildren()) {
+    SoGetBoundingBoxAction action(vp);
+    action.apply(this->scene);
+    this->scenebox = action.getXfBoundingBox();
+    this->scenevalid = true;
+    return;
+  }
+
+  QVector<Child *> dirty;
+  for (int i = 0; i < this->children.size(); i++) {
+    if (!this->children[i]->valid) dirty.append(this->children[i]);
+  }
+
+  int numtasks = 1;
+#ifdef COIN_THREADSAFE
+  if (dirty.size() > 1) {
+    if (!this->pool) this->pool = new QThreadPool;
+    numtasks = qMin(dirty.size(), this->pool->maxThreadCount());
+  }
+#endif // COIN_THREADSAFE
+
+  QVector<BoundingBoxTask *> tasks;
+  for (int i = 0; i < numtasks; i++) {
+    tasks.append(new BoundingBoxTask(vp));
+  }
+  for (int i = 0; i < dirty.size(); i++) {
+    BoundingBoxTask * task = tasks[i % numtasks];
+    task->nodes.append(dirty[i]->node);
+    task->boxes.append(&dirty[i]->box);
+  }
+  if (numtasks > 1) {
+    for (int i = 0; i < numtasks; i++) {
+      this->pool->start(tasks[i]);
+    }
+    this->pool->waitForDone();
+  }
+  else if (!dirty.isEmpty()) {
+    tasks[0]->run();
+    delete tasks[0];
+  }
+  else {
+    delete tasks[0];
+  }
+
+  this->scenebox.makeEmpty();
+  for (int i = 0; i < this->children.size(); i++) {
+    Child * child = this->children[i];
+    child->valid = true;
+    if (!child->box.isEmpty()) this->scenebox.extendBy(child->box);
+  }
+  this->scenevalid = true;
+}
+
+/*
+  Returns the bounding box of the scene, computing what has changed
+  since the last call.
+ */
+SbXfBox3f
+BoundingBoxCache::getBoundingBox(const SbViewportRegion & vp)
+{
+  if (!this->scene) return SbXfBox3f();
+  if (!this->enabled) {
+    SoGetBoundingBoxAction action(vp);
+    action.apply(this->scene);
+    return action.getXfBoundingBox();
+  }
+  if (!this->scenevalid) this->compute(vp);
+  return this->scenebox;
+}
+
+/*
+  Computes the near and far planes of \a camera that enclose \a xbox,
+  the way SoRenderManager does it for \a strategy. \a nearplanevalue
+  is the render manager's near plane value and \a depthbits the
+  resolution of the depth buffer rendered into. Returns false if the
+  box is empty or behind the camera.
+ */
+bool
+BoundingBoxCache::clippingPlanes(SoCamera * camera, const SbXfBox3f & xbox,
+                                 SoRenderManager::AutoClippingStrategy strategy,
+                                 float nearplanevalue, int depthbits,
+                                 float & nearval, float & farval)
+{
+  if (xbox.isEmpty()) return false;
+
+  // into camera space
+  SbXfBox3f camerabox = xbox;
+  SbMatrix mat;
+  mat.setTranslate(- camera->position.getValue());
+  camerabox.transform(mat);
+  mat = camera->orientation.getValue().inverse();
+  camerabox.transform(mat);
+  SbBox3f box = camerabox.project();
+
+  nearval = -box.getMax()[2];
+  farval = -box.getMin()[2];
+  if (farval <= 0.0f) return false;
+
+  if (camera->isOfType(SoPerspectiveCamera::getClassTypeId())) {
+    float nearlimit;
+    if (strategy == SoRenderManager::FIXED_NEAR_PLANE) {
+      nearlimit = nearplanevalue * farval;
+    }
+    else {
+      // use the given fraction of the depth buffer resolution in
+      // front of the far plane
+      const int usebits = int(float(depthbits) * (1.0f - nearplanevalue));
+      nearlimit = farval / float(pow(2.0, double(usebits)));
+    }
+    if (nearlimit >= farval) nearlimit = farval / 5000.0f;
+    if (nearval < nearlimit) nearval = nearlimit;
+  }
+
+  // some slack to avoid clipping the box itself
+  const float SLACK = 0.001f;
+  nearval *= (1.0f - SLACK);
+  farval *= (1.0f + SLACK);
+  return true;
+}
+
+/*
+  Sets the near and far planes of \a camera to enclose the scene, the
+  way the render manager does it for its auto-clipping strategy, but
+  from the cached bounding box. Must be called with the GL context
+  current.
+ */
+void
+BoundingBoxCache::setClippingPlanes(SoCamera * camera, SoRenderManager * manager)
+{
+  if (!this->enabled || !camera || !this->scene ||
+      this->clipping == SoRenderManager::NO_AUTO_CLIPPING) return;
+
+  GLint depthbits = 0;
+  glGetIntegerv(GL_DEPTH_BITS, &depthbits);
+
+  float nearval, farval;
+  if (!BoundingBoxCache::clippingPlanes(camera, this->getBoundingBox(manager->getViewportRegion()),
+                                        this->clipping, manager->getNearPlaneValue(),
+                                        depthbits, nearval, farval)) return;
+
+  // no notification, this must not trigger another redraw
+  const SbBool notify = camera->enableNotify(FALSE);
+  camera->nearDistance = nearval;
+  camera->farDistance = farval;
+  camera->enableNotify(notify);
+}
+
+/*
+  Fits \a camera to the cached bounding box. Returns false if that is
+  not possible, and the view must be fitted the usual way.
+ */
+bool
+BoundingBoxCache::viewAll(SoCamera * camera, SoRenderManager * manager)
+{
+  if (!this->enabled || !camera || !this->scene) return false;
+  const SbViewportRegion & vp = manager->getViewportRegion();
+  const SbBox3f box = this->getBoundingBox(vp).project();
+  if (box.isEmpty()) return false;
+  camera->viewBoundingBox(box, vp.getViewportAspectRatio(), 1.0f);
+  return true;
+}
+
+void
+BoundingBoxCache::childChangedCB(void * data, SoSensor *)
+{
+  static_cast<Child *>(data)->valid = false;
+}
+
+void
+BoundingBoxCache::sceneChangedCB(void * data, SoSensor *)
+{
+  // also triggered by changes below the top level children, whose own
+  // sensors tell which ones
+  static_cast<BoundingBoxCache *>(data)->scenevalid = false;
+}
@@ -0,0 +1,105 @@
+#ifndef QUARTER_BOUNDINGBOXCACHE_H
+#define QUARTER_BOUNDINGBOXCACHE_H
+
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+#include <QtCore/QVector>
+#include <Inventor/SbXfBox3f.h>
+#include <Inventor/SoRenderManager.h>
+
+class SoNode;
+class SoGroup;
+class SoCamera;
+class SoSensor;
+class SoNodeSensor;
+class SbViewportRegion;
+class QThreadPool;
+
+namespace SIM { namespace Coin3D { namespace Quarter {
+
+class QuarterWidget;
+
+class BoundingBoxCache {
+public:
+  BoundingBoxCache(QuarterWidget * quarterwidget);
+  ~BoundingBoxCache();
+
+  void setEnabled(bool onoff);
+  bool isEnabled(void) const;
+
+  void setScene(SoNode * scene);
+  SbXfBox3f getBoundingBox(const SbViewportRegion & vp);
+  void invalidate(void);
+
+  void setClippingPlanes(SoCamera * camera, SoRenderManager * manager);
+  static bool clippingPlanes(SoCamera * camera, const SbXfBox3f & box,
+                             SoRenderManager::AutoClippingStrategy strategy,
+                             float nearplanevalue, int depthbits,
+                             float & nearval, float & farval);
+  bool viewAll(SoCamera * camera, SoRenderManager * manager);
+
+private:
+  struct Child {
+    SoNode * node;
+    SoNodeSensor * sensor;
+    SbXfBox3f box;
+    bool valid;
+  };
+
+  void attach(void);
+  void detach(void);
+  void clearChildren(void);
+  Child * createChild(SoNode * node);
+  static void destroyChild(Child * child);
+  bool syncChildren(void);
+  void compute(const SbViewportRegion & vp);
+  static void childChangedCB(void * data, SoSensor * sensor);
+  static void sceneChangedCB(void * data, SoSensor * sensor);
+
+  QuarterWidget * quarterwidget;
+  bool enabled;
+  SoRenderManager::AutoClippingStrategy clipping;
+  SoNode * scene;
+  // the scene is split per top level child when it is a plain group
+  // of separators, which do not leak state to their siblings
+  SoGroup * group;
+  QVector<Child *> children;
+  SoNodeSensor * scenesensor;
+  SbXfBox3f scenebox;
+  bool scenevalid;
+  QThreadPool * pool;
+};
+
+}}} // namespace
+
+#endif // QUARTER_BOUNDINGBOXCACHE_H
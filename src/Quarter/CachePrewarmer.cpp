@@ -0,0 +1,298 @@
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+/*
+  Builds the render caches of the scene of a QuarterWidget before the
+  widget first renders it. Coin creates display lists, vertex buffer
+  objects and textures during the first traversal of a scene, which
+  for a large model can keep the first frame from appearing for
+  seconds.
+
+  The scene is rendered into a hidden framebuffer object in a context
+  that shares objects with the widget, with the cache context of the
+  widget, so the widget finds the caches when it renders. To keep the
+  application responsive, the scene is split into chunks of about
+  CHUNK_NODES nodes. Each chunk is a list of paths from the root of
+  the render manager's scene graph, so the camera, the lights and the
+  other properties to the left of a chunk still apply when it is
+  rendered. Chunks are rendered from a zero-interval timer until a
+  time slice is used up, which runs them only while the event loop is
+  idle.
+
+  Only plain groups and separators are split. Switches, levels of
+  detail, shadow groups and nodekits are always rendered whole,
+  because rendering some of their children through paths goes
+  against how they choose or combine their children.
+ */
+
+#include "CachePrewarmer.h"
+
+#include <QtCore/QHash>
+#include <QtCore/QTimer>
+#if (QT_VERSION >= 0x050400)
+#  include <QOffscreenSurface>
+#  include <QOpenGLContext>
+#  include <QOpenGLFramebufferObject>
+#  include <QOpenGLFramebufferObjectFormat>
+#endif
+
+#include <Inventor/SbTime.h>
+#include <Inventor/SbViewportRegion.h>
+#include <Inventor/SoPath.h>
+#include <Inventor/SoRenderManager.h>
+#include <Inventor/actions/SoGLRenderAction.h>
+#include <Inventor/lists/SoPathList.h>
+#include <Inventor/misc/SoChildList.h>
+#include <Inventor/nodes/SoGroup.h>
+#include <Inventor/nodes/SoSeparator.h>
+
+#include <Quarter/QuarterWidget.h>
+
+using namespace SIM::Coin3D::Quarter;
+
+// nodes rendered together as one chunk
+static const int CHUNK_NODES = 2000;
+// seconds spent rendering chunks per idle tick
+static const double PREWARM_SLICE = 0.008;
+// size of the framebuffer object if the widget has no size yet
+static const int DEFAULT_SIZE = 512;
+
+static int
+count_nodes(SoNode * node, QHash<SoNode *, int> & counts)
+{
+  QHash<SoNode *, int>::const_iterator it = counts.constFind(node);
+  if (it != counts.constEnd()) return it.value();
+
+  int count = 1;
+  SoChildList * children = node->getChildren();
+  if (children) {
+    for (int i = 0; i < children->getLength(); i++) {
+      count += count_nodes((*children)[i], counts);
+    }
+  }
+  counts.insert(node, count);
+  return count;
+}
+
+static bool
+splittable(SoNode * node)
+{
+  const SoType type = node->getTypeId();
+  return
+    (type == SoGroup::getClassTypeId() || type == SoSeparator::getClassTypeId()) &&
+    static_cast<SoGroup *>(node)->getNumChildren() > 0;
+}
+
+/*
+  Appends the chunks below the tail of \a path to \a chunks. Small
+  siblings are gathered into one chunk until it holds CHUNK_NODES
+  nodes.
+ */
+static void
+collect_chunks(SoPath * path, QHash<SoNode *, int> & counts,
+               QList<SoPathList *> & chunks, int & chunksize)
+{
+  SoNode * tail = path->getTail();
+  const int count = count_nodes(tail, counts);
+
+  if (count > CHUNK_NODES && splittable(tail)) {
+    SoGroup * group = static_cast<SoGroup *>(tail);
+    for (int i = 0; i < group->getNumChildren(); i++) {
+      path->append(i);
+      collect_chunks(path, counts, chunks, chunksize);
+      path->pop();
+    }
+    return;
+  }
+
+  if (chunks.isEmpty() || chunksize + count > CHUNK_NODES) {
+    chunks.append(new SoPathList);
+    chunksize = 0;
+  }
+  chunks.last()->append(path->copy());
+  chunksize += count;
+}
+
+CachePrewarmer::CachePrewarmer(QuarterWidget * quarterwidget)
+  : QObject(quarterwidget)
+{
+  this->quarterwidget = quarterwidget;
+  this->context = NULL;
+  this->surface = NULL;
+  this->fbo = NULL;
+  this->action = NULL;
+
+  this->idletimer = new QTimer(this);
+  this->idletimer->setSingleShot(true);
+  this->connect(this->idletimer, SIGNAL(timeout(void)), this, SLOT(idle()));
+}
+
+CachePrewarmer::~CachePrewarmer()
+{
+  this->release();
+}
+
+/*
+  Sets up the hidden context and splits the scene into chunks.
+  Returns false if there is nothing to render or no context the
+  widget shares objects with.
+ */
+bool
+CachePrewarmer::start(void)
+{
+#if (QT_VERSION >= 0x050400)
+  this->release();
+
+  SoRenderManager * manager = this->quarterwidget->getSoRenderManager();
+  SoNode * root = manager ? manager->getSceneGraph() : NULL;
+  if (!root) return false;
+
+  // the widget's own context if it has been created, otherwise the
+  // global share context the widget's context will share objects with
+#if QT_VERSION >= 0x060000
+  QOpenGLContext * sharecontext = this->quarterwidget->context();
+#else
+  QOpenGLContext * sharecontext = this->quarterwidget->context() ?
+    this->quarterwidget->context()->contextHandle() : NULL;
+#endif
+  if (!sharecontext) sharecontext = QOpenGLContext::globalShareContext();
+  if (!sharecontext) return false;
+
+  this->context = new QOpenGLContext;
+  this->context->setFormat(sharecontext->format());
+  this->context->setShareContext(sharecontext);
+  this->surface = new QOffscreenSurface;
+  this->surface->setFormat(sharecontext->format());
+  this->surface->create();
+  if (!this->context->create() ||
+      !QOpenGLContext::areSharing(this->context, sharecontext) ||
+      !this->context->makeCurrent(this->surface)) {
+    this->release();
+    return false;
+  }
+
+  SbViewportRegion vp = manager->getViewportRegion();
+  const SbVec2s size = vp.getViewportSizePixels();
+  if (size[0] <= 1 || size[1] <= 1) {
+    vp = SbViewportRegion(DEFAULT_SIZE, DEFAULT_SIZE);
+  }
+  const SbVec2s window = vp.getWindowSize();
+  this->fbo = new QOpenGLFramebufferObject(window[0], window[1],
+                                           QOpenGLFramebufferObject::CombinedDepthStencil);
+  this->context->doneCurrent();
+
+  this->action = new SoGLRenderAction(vp);
+  this->action->setCacheContext(this->quarterwidget->getCacheContextId());
+  this->action->setTransparencyType(manager->getGLRenderAction()->getTransparencyType());
+
+  QHash<SoNode *, int> counts;
+  int chunksize = 0;
+  SoPath * path = new SoPath(root);
+  path->ref();
+  collect_chunks(path, counts, this->chunks, chunksize);
+  path->unref();
+
+  this->idletimer->start(0);
+  return true;
+#else
+  return false;
+#endif
+}
+
+void
+CachePrewarmer::cancel(void)
+{
+  this->release();
+}
+
+bool
+CachePrewarmer::active(void) const
+{
+  return !this->chunks.isEmpty();
+}
+
+/*
+  Renders chunks until the time slice is used up, and comes back on
+  the next idle tick until all chunks are done.
+ */
+void
+CachePrewarmer::idle(void)
+{
+#if (QT_VERSION >= 0x050400)
+  if (this->chunks.isEmpty()) return;
+  if (!this->context->makeCurrent(this->surface)) {
+    this->release();
+    return;
+  }
+  this->fbo->bind();
+
+  const SbTime start = SbTime::getTimeOfDay();
+  do {
+    SoPathList * chunk = this->chunks.takeFirst();
+    this->action->apply(*chunk, TRUE);
+    delete chunk;
+  } while (!this->chunks.isEmpty() &&
+           (SbTime::getTimeOfDay() - start).getValue() < PREWARM_SLICE);
+
+  this->fbo->release();
+  this->context->doneCurrent();
+
+  if (this->chunks.isEmpty()) {
+    this->release();
+    emit this->finished();
+  } else {
+    this->idletimer->start(0);
+  }
+#endif
+}
+
+void
+CachePrewarmer::release(void)
+{
+  this->idletimer->stop();
+  while (!this->chunks.isEmpty()) {
+    delete this->chunks.takeFirst();
+  }
+  delete this->action;
+  this->action = NULL;
+#if (QT_VERSION >= 0x050400)
+  if (this->fbo && this->context->makeCurrent(this->surface)) {
+    delete this->fbo;
+    this->context->doneCurrent();
+  }
+  this->fbo = NULL;
+  delete this->context;
+  this->context = NULL;
+  delete this->surface;
+  this->surface = NULL;
+#endif
+}
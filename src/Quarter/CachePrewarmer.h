@@ -0,0 +1,80 @@
+#ifndef QUARTER_CACHEPREWARMER_H
+#define QUARTER_CACHEPREWARMER_H
+
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+#include <QtCore/QObject>
+#include <QtCore/QList>
+
+class QTimer;
+class QOpenGLContext;
+class QOffscreenSurface;
+class QOpenGLFramebufferObject;
+class SoGLRenderAction;
+class SoPathList;
+
+namespace SIM { namespace Coin3D { namespace Quarter {
+
+class QuarterWidget;
+
+class CachePrewarmer : public QObject {
+  Q_OBJECT
+public:
+  CachePrewarmer(QuarterWidget * quarterwidget);
+  ~CachePrewarmer();
+
+  bool start(void);
+  void cancel(void);
+  bool active(void) const;
+
+public slots:
+  void idle(void);
+
+signals:
+  void finished(void);
+
+private:
+  void release(void);
+
+  QuarterWidget * quarterwidget;
+  QTimer * idletimer;
+  QOpenGLContext * context;
+  QOffscreenSurface * surface;
+  QOpenGLFramebufferObject * fbo;
+  SoGLRenderAction * action;
+  QList<SoPathList *> chunks;
+};
+
+}}} // namespace
+
+#endif // QUARTER_CACHEPREWARMER_H
@@ -0,0 +1,311 @@
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+/*
+  Renders background and foreground layers of a QuarterWidget into
+  textures, and composites the textures for every frame. A layer is
+  only rendered again when something changes in its subgraph, or when
+  the viewport changes size.
+
+  Without framebuffer object support the layers are rendered directly
+  for every frame, like ordinary superimpositions.
+ */
+
+#include "CachedLayers.h"
+
+#if (QT_VERSION >= 0x050000)
+#  include <QOpenGLFramebufferObject>
+#endif
+
+#include <Inventor/SbColor4f.h>
+#include <Inventor/SbVec2s.h>
+#include <Inventor/SoRenderManager.h>
+#include <Inventor/actions/SoGLRenderAction.h>
+#include <Inventor/nodes/SoNode.h>
+#include <Inventor/sensors/SoNodeSensor.h>
+
+using namespace SIM::Coin3D::Quarter;
+
+CachedLayers::CachedLayers(QuarterWidget * quarterwidget)
+{
+  this->quarterwidget = quarterwidget;
+  this->action = NULL;
+}
+
+CachedLayers::~CachedLayers()
+{
+  while (!this->layers.isEmpty()) {
+    this->removeLayer(this->layers.first()->node);
+  }
+  delete this->action;
+}
+
+void
+CachedLayers::addLayer(SoNode * node, QuarterWidget::LayerPosition position)
+{
+  Layer * layer = new Layer;
+  layer->owner = this;
+  layer->node = node;
+  layer->node->ref();
+  layer->position = position;
+  layer->dirty = true;
+  layer->fbo = NULL;
+  layer->sensor = new SoNodeSensor(CachedLayers::sensorcb, layer);
+  layer->sensor->attach(node);
+  this->layers.append(layer);
+
+  this->quarterwidget->getSoRenderManager()->scheduleRedraw();
+}
+
+void
+CachedLayers::removeLayer(SoNode * node)
+{
+  for (int i = 0; i < this->layers.size(); i++) {
+    Layer * layer = this->layers[i];
+    if (layer->node != node) continue;
+
+    this->layers.removeAt(i);
+    delete layer->sensor;
+#if (QT_VERSION >= 0x050000)
+    delete layer->fbo;
+#endif
+    layer->node->unref();
+    delete layer;
+
+    if (this->quarterwidget->getSoRenderManager()) {
+      this->quarterwidget->getSoRenderManager()->scheduleRedraw();
+    }
+    return;
+  }
+}
+
+/*
+  Renders the layers which have changed into their textures. Must be
+  called with the GL context current, before anything is rendered
+  into the frame.
+ */
+void
+CachedLayers::update(void)
+{
+  if (this->layers.isEmpty() || !this->useTextures()) return;
+
+  SbViewportRegion vp = this->quarterwidget->getSoRenderManager()->getViewportRegion();
+#if (QT_VERSION >= 0x050000)
+  SbVec2s size = vp.getWindowSize();
+  for (int i = 0; i < this->layers.size(); i++) {
+    Layer * layer = this->layers[i];
+    if (!layer->dirty && layer->fbo && layer->fbo->size() == QSize(size[0], size[1])) continue;
+    this->renderLayer(layer, vp);
+  }
+#endif
+}
+
+/*
+  Clears the window if \a clearwindow is set and composites the
+  background layers. Returns false if there are no background
+  layers, in which case nothing is done.
+ */
+bool
+CachedLayers::compositeBackground(bool clearwindow)
+{
+  bool found = false;
+  for (int i = 0; i < this->layers.size() && !found; i++) {
+    found = this->layers[i]->position == QuarterWidget::BACKGROUND;
+  }
+  if (!found) return false;
+
+  if (clearwindow) {
+    SbColor4f bg = this->quarterwidget->getSoRenderManager()->getBackgroundColor();
+    glClearColor(bg[0], bg[1], bg[2], bg[3]);
+    glClear(GL_COLOR_BUFFER_BIT);
+  }
+  this->composite(QuarterWidget::BACKGROUND);
+  return true;
+}
+
+void
+CachedLayers::compositeForeground(void)
+{
+  this->composite(QuarterWidget::FOREGROUND);
+}
+
+bool
+CachedLayers::hasFramebuffers(void) const
+{
+  for (int i = 0; i < this->layers.size(); i++) {
+    if (this->layers[i]->fbo) return true;
+  }
+  return false;
+}
+
+/*
+  Releases the textures of all layers. Must be called with the
+  widget's GL context current.
+ */
+void
+CachedLayers::cleanup(void)
+{
+  for (int i = 0; i < this->layers.size(); i++) {
+#if (QT_VERSION >= 0x050000)
+    delete this->layers[i]->fbo;
+#endif
+    this->layers[i]->fbo = NULL;
+    this->layers[i]->dirty = true;
+  }
+}
+
+void
+CachedLayers::sensorcb(void * userdata, SoSensor *)
+{
+  Layer * layer = static_cast<Layer *>(userdata);
+  layer->dirty = true;
+  layer->owner->quarterwidget->getSoRenderManager()->scheduleRedraw();
+}
+
+bool
+CachedLayers::useTextures(void) const
+{
+#if (QT_VERSION >= 0x050000)
+  return QOpenGLFramebufferObject::hasOpenGLFramebufferObjects();
+#else
+  return false;
+#endif
+}
+
+void
+CachedLayers::renderLayer(Layer * layer, const SbViewportRegion & vp)
+{
+  if (!this->action) {
+    this->action = new SoGLRenderAction(vp);
+    this->action->setCacheContext(this->quarterwidget->getCacheContextId());
+  }
+
+#if (QT_VERSION >= 0x050000)
+  SbVec2s size = vp.getWindowSize();
+  QSize fbosize(size[0], size[1]);
+  if (!layer->fbo || layer->fbo->size() != fbosize) {
+    delete layer->fbo;
+    layer->fbo = new QOpenGLFramebufferObject(fbosize, QOpenGLFramebufferObject::Depth);
+  }
+
+  layer->fbo->bind();
+  glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+  glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+  this->action->setViewportRegion(vp);
+  this->action->apply(layer->node);
+  layer->fbo->release();
+#endif
+
+  layer->dirty = false;
+}
+
+/*
+  Draws the layers at \a position into the current viewport of the
+  render manager's GL render action.
+ */
+void
+CachedLayers::composite(QuarterWidget::LayerPosition position)
+{
+  const SbViewportRegion & vp =
+    this->quarterwidget->getSoRenderManager()->getGLRenderAction()->getViewportRegion();
+  bool usetextures = this->useTextures();
+
+  for (int i = 0; i < this->layers.size(); i++) {
+    Layer * layer = this->layers[i];
+    if (layer->position != position) continue;
+
+#if (QT_VERSION >= 0x050000)
+    if (usetextures && layer->fbo) {
+      SbVec2s size = vp.getWindowSize();
+      glViewport(0, 0, size[0], size[1]);
+      this->drawTexture(layer->fbo->texture());
+      continue;
+    }
+#endif
+
+    // no texture; render the layer directly
+    if (!this->action) {
+      this->action = new SoGLRenderAction(vp);
+      this->action->setCacheContext(this->quarterwidget->getCacheContextId());
+    }
+    if (layer->position == QuarterWidget::FOREGROUND) {
+      glClear(GL_DEPTH_BUFFER_BIT);
+    }
+    this->action->setViewportRegion(vp);
+    this->action->apply(layer->node);
+    layer->dirty = false;
+  }
+}
+
+/*
+  Draws \a texture over the whole viewport, blended with what has
+  already been rendered.
+ */
+void
+CachedLayers::drawTexture(GLuint texture)
+{
+  glPushAttrib(GL_ENABLE_BIT | GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT |
+               GL_TEXTURE_BIT | GL_TRANSFORM_BIT | GL_CURRENT_BIT);
+
+  glMatrixMode(GL_PROJECTION);
+  glPushMatrix();
+  glLoadIdentity();
+  glMatrixMode(GL_MODELVIEW);
+  glPushMatrix();
+  glLoadIdentity();
+
+  glDisable(GL_DEPTH_TEST);
+  glDisable(GL_LIGHTING);
+  glDisable(GL_CULL_FACE);
+  glEnable(GL_BLEND);
+  // the layer was rendered over transparent black, so its colors are
+  // already multiplied by alpha
+  glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+  glEnable(GL_TEXTURE_2D);
+  glBindTexture(GL_TEXTURE_2D, texture);
+  glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_REPLACE);
+  glColor4f(1.0f, 1.0f, 1.0f, 1.0f);
+
+  glBegin(GL_QUADS);
+  glTexCoord2f(0.0f, 0.0f); glVertex2f(-1.0f, -1.0f);
+  glTexCoord2f(1.0f, 0.0f); glVertex2f(1.0f, -1.0f);
+  glTexCoord2f(1.0f, 1.0f); glVertex2f(1.0f, 1.0f);
+  glTexCoord2f(0.0f, 1.0f); glVertex2f(-1.0f, 1.0f);
+  glEnd();
+
+  glMatrixMode(GL_PROJECTION);
+  glPopMatrix();
+  glMatrixMode(GL_MODELVIEW);
+  glPopMatrix();
+
+  glPopAttrib();
+}
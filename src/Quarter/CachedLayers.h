@@ -0,0 +1,85 @@
+#ifndef QUARTER_CACHEDLAYERS_H
+#define QUARTER_CACHEDLAYERS_H
+
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+#include <QtCore/QList>
+#include <Inventor/SbViewportRegion.h>
+#include <Inventor/system/gl.h>
+#include <Quarter/QuarterWidget.h>
+
+class SoNode;
+class SoSensor;
+class SoNodeSensor;
+class SoGLRenderAction;
+class QOpenGLFramebufferObject;
+
+namespace SIM { namespace Coin3D { namespace Quarter {
+
+class CachedLayers {
+public:
+  CachedLayers(QuarterWidget * quarterwidget);
+  ~CachedLayers();
+
+  void addLayer(SoNode * node, QuarterWidget::LayerPosition position);
+  void removeLayer(SoNode * node);
+
+  void update(void);
+  bool compositeBackground(bool clearwindow);
+  void compositeForeground(void);
+
+  bool hasFramebuffers(void) const;
+  void cleanup(void);
+
+private:
+  struct Layer {
+    CachedLayers * owner;
+    SoNode * node;
+    SoNodeSensor * sensor;
+    QuarterWidget::LayerPosition position;
+    bool dirty;
+    QOpenGLFramebufferObject * fbo;
+  };
+
+  static void sensorcb(void * userdata, SoSensor * sensor);
+  bool useTextures(void) const;
+  void renderLayer(Layer * layer, const SbViewportRegion & vp);
+  void composite(QuarterWidget::LayerPosition position);
+  void drawTexture(GLuint texture);
+
+  QuarterWidget * quarterwidget;
+  QList<Layer *> layers;
+  SoGLRenderAction * action;
+};
+
+}}} // namespace
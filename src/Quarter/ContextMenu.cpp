@@ -34,12 +34,15 @@
 #include "ContextMenu.h"
 
 #include <QActionGroup>
+#include <QApplication>
 #include <QMenu>
+#include <QMessageBox>
 
 #include <Inventor/SoEventManager.h>
 #include <Inventor/scxml/SoScXMLStateMachine.h>
 
 #include <Quarter/QuarterWidget.h>
+#include <Quarter/SceneAnalyzer.h>
 
 using namespace SIM::Coin3D::Quarter;
 
@@ -70,7 +73,7 @@ ContextMenu::ContextMenu(QuarterWidget * quarterwidget)
       assert(rendermodegroup && rendermodegroup == action->actionGroup());
     }
 
-    int rendermode = static_cast<QuarterWidget::RenderMode>(sorendermanager->getRenderMode());
+    int rendermode = quarterwidget->renderMode();
     int data = static_cast<QuarterWidget::RenderMode>(action->data().toInt());
     action->setChecked(rendermode == data);
     rendermenu->addAction(action);
@@ -96,8 +99,7 @@ ContextMenu::ContextMenu(QuarterWidget * quarterwidget)
       assert(transparencytypegroup && transparencytypegroup == action->actionGroup());
     }
 
-    SoGLRenderAction * renderaction = sorendermanager->getGLRenderAction();
-    int transparencytype = static_cast<SoGLRenderAction::TransparencyType>(renderaction->getTransparencyType());
+    int transparencytype = quarterwidget->transparencyType();
     int data = static_cast<SoGLRenderAction::TransparencyType>(action->data().toInt());
     action->setChecked(transparencytype == data);
     transparencymenu->addAction(action);
@@ -105,8 +107,21 @@ ContextMenu::ContextMenu(QuarterWidget * quarterwidget)
 
   QAction * viewall = new QAction("View All", quarterwidget);
   QAction * seek = new QAction("Seek", quarterwidget);
+  QAction * analyze = new QAction("Analyze Scene...", quarterwidget);
+  this->performancehud = new QAction("Performance HUD", quarterwidget);
+  this->performancehud->setCheckable(true);
   functionsmenu->addAction(viewall);
   functionsmenu->addAction(seek);
+  functionsmenu->addSeparator();
+  functionsmenu->addAction(this->performancehud);
+  functionsmenu->addAction(analyze);
+
+  QObject::connect(this->performancehud, SIGNAL(toggled(bool)),
+                   this, SLOT(togglePerformanceHud(bool)));
+  QObject::connect(analyze, SIGNAL(triggered()),
+                   this, SLOT(analyzeScene()));
+  QObject::connect(this->contextmenu, SIGNAL(aboutToShow()),
+                   this, SLOT(updateActions()));
 
   QObject::connect(seek, SIGNAL(triggered()),
                    this->quarterwidget, SLOT(seek()));
@@ -164,6 +179,42 @@ ContextMenu::changeStereoMode(QAction * action)
   this->quarterwidget->getSoRenderManager()->scheduleRedraw();
 }
 
+void
+ContextMenu::togglePerformanceHud(bool onoff)
+{
+  this->quarterwidget->setPerformanceHudEnabled(onoff);
+}
+
+void
+ContextMenu::analyzeScene(void)
+{
+  SoRenderManager * sorendermanager = this->quarterwidget->getSoRenderManager();
+  SceneAnalyzer analyzer(sorendermanager->getViewportRegion());
+
+  QApplication::setOverrideCursor(Qt::WaitCursor);
+  const bool ok = analyzer.analyze(this->quarterwidget->getSceneGraph(),
+                                   sorendermanager->getCamera());
+  QApplication::restoreOverrideCursor();
+  if (!ok) return;
+
+  QMessageBox box(QMessageBox::Information, "Scene Analysis",
+                  analyzer.numSubgraphs() > 0 ?
+                  QString("Most expensive subgraph: %1").arg(analyzer.getName(0)) :
+                  QString("The scene is empty."),
+                  QMessageBox::Ok, this->quarterwidget);
+  box.setDetailedText(analyzer.report());
+  box.exec();
+}
+
+void
+ContextMenu::updateActions(void)
+{
+  // the overlay may have been toggled through the API as well
+  const bool blocked = this->performancehud->blockSignals(true);
+  this->performancehud->setChecked(this->quarterwidget->performanceHudEnabled());
+  this->performancehud->blockSignals(blocked);
+}
+
 void
 ContextMenu::changeTransparencyType(QAction * action)
 {
@@ -54,6 +54,9 @@ public slots:
   void changeRenderMode(QAction * action);
   void changeStereoMode(QAction * action);
   void changeTransparencyType(QAction * action);
+  void togglePerformanceHud(bool onoff);
+  void analyzeScene(void);
+  void updateActions(void);
 
 private:
   QuarterWidget * quarterwidget;
@@ -63,6 +66,7 @@ private:
   QMenu * stereomenu;
   QMenu * functionsmenu;
   QMenu * transparencymenu;
+  QAction * performancehud;
 };
 
 }}} // namespace
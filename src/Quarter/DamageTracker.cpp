@@ -0,0 +1,406 @@
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+/*
+  Tracks which parts of the view change between frames, so that
+  QuarterWidget can redraw only that part on top of the previous
+  frame.
+
+  A node sensor on the scene graph of the render manager records the
+  path to every changed node. A change is taken to be contained in
+  the innermost separator above the changed node, and the bounding
+  box of that separator is projected to the screen. The damaged
+  region is the union of where each changed separator was in the
+  last frame and where it is now. When a separator changes, the
+  remembered areas of the separators above and below it are dropped,
+  as they move with it. The first change to a separator,
+  changes outside of any separator, changes to nodes that are used in
+  more than one place in the scene, camera moves and resizes make a
+  full redraw, as does a damaged region covering more than half of
+  the view.
+ */
+
+#include "DamageTracker.h"
+
+#include <Inventor/SbBox3f.h>
+#include <Inventor/SbMatrix.h>
+#include <Inventor/SbRotation.h>
+#include <Inventor/SbViewVolume.h>
+#include <Inventor/SbViewportRegion.h>
+#include <Inventor/SoPath.h>
+#include <Inventor/SoRenderManager.h>
+#include <Inventor/actions/SoGetBoundingBoxAction.h>
+#include <Inventor/actions/SoSearchAction.h>
+#include <Inventor/lists/SoAuditorList.h>
+#include <Inventor/misc/SoNotification.h>
+#include <Inventor/nodes/SoCamera.h>
+#include <Inventor/nodes/SoSeparator.h>
+#include <Inventor/sensors/SoNodeSensor.h>
+#include <Inventor/system/gl.h>
+
+#include <QtCore/QList>
+
+#include <Quarter/QuarterWidget.h>
+
+using namespace SIM::Coin3D::Quarter;
+
+// more changed separators than this in one frame make a full redraw
+static const int MAX_CHANGED = 64;
+// screen areas remembered, until the camera moves
+static const int MAX_RECTS = 256;
+
+DamageTracker::DamageTracker(QuarterWidget * quarterwidget)
+{
+  this->quarterwidget = quarterwidget;
+  this->isenabled = false;
+  this->fullredraw = true;
+  this->partial = false;
+  this->rendering = false;
+  this->lastcamera = NULL;
+  this->lastzoom = 0.0f;
+  this->lastsize = SbVec2s(0, 0);
+  // immediate, as the trigger path is only known while notifying
+  this->sensor = new SoNodeSensor(DamageTracker::changedCB, this);
+  this->sensor->setPriority(0);
+  this->sensor->setTriggerPathFlag(TRUE);
+}
+
+DamageTracker::~DamageTracker()
+{
+  delete this->sensor;
+  this->clearRects();
+}
+
+void
+DamageTracker::setEnabled(bool yes)
+{
+  this->isenabled = yes;
+  if (!yes) {
+    this->sensor->detach();
+    this->changed.truncate(0);
+    this->clearRects();
+  }
+  this->fullredraw = true;
+}
+
+bool
+DamageTracker::enabled(void) const
+{
+  return this->isenabled;
+}
+
+/*
+  Makes the next frame a full redraw, for changes that are not in the
+  scene graph.
+ */
+void
+DamageTracker::invalidate(void)
+{
+  this->fullredraw = true;
+}
+
+/*
+  Returns the number of group nodes \a node is a child of.
+ */
+static int
+num_parents(SoNode * node)
+{
+  const SoAuditorList & auditors = node->getAuditors();
+  int parents = 0;
+  for (int i = 0; i < auditors.getLength(); i++) {
+    if (auditors.getType(i) == SoNotRec::PARENT) parents++;
+  }
+  return parents;
+}
+
+void
+DamageTracker::changedCB(void * closure, SoSensor * s)
+{
+  DamageTracker * thisp = static_cast<DamageTracker *>(closure);
+  // the render manager sets the clipping planes while rendering
+  if (thisp->rendering || thisp->fullredraw) return;
+
+  SoNodeSensor * sensor = static_cast<SoNodeSensor *>(s);
+  SoNode * node = sensor->getTriggerNode();
+  SoPath * path = sensor->getTriggerPath();
+  if (!node || !path) {
+    thisp->fullredraw = true;
+    return;
+  }
+  // camera moves are found by comparing the camera with the last frame
+  if (node->isOfType(SoCamera::getClassTypeId())) return;
+
+  // a node used in more than one place, with DEF/USE, changes all of
+  // its instances, and only the one on the trigger path is known
+  for (int i = 1; i < path->getLength(); i++) {
+    if (num_parents(path->getNode(i)) > 1) {
+      thisp->fullredraw = true;
+      return;
+    }
+  }
+
+  // the root is the top separator of the widget, which holds the
+  // headlight and the camera
+  for (int i = path->getLength() - 1; i > 0; i--) {
+    if (path->getNode(i)->isOfType(SoSeparator::getClassTypeId())) {
+      if (thisp->changed.getLength() >= MAX_CHANGED) break;
+      thisp->changed.append(path->copy(0, i + 1));
+      return;
+    }
+  }
+  thisp->fullredraw = true;
+}
+
+/*
+  Finds the screen area covered by the tail of \a path. Returns false
+  if it cannot be told, because the bounding box crosses the near
+  plane.
+ */
+bool
+DamageTracker::screenRect(SoPath * path, SoCamera * camera, const SbViewportRegion & vp,
+                          SbBox2s & rect) const
+{
+  rect.makeEmpty();
+  SoGetBoundingBoxAction bboxaction(vp);
+  bboxaction.apply(path);
+  const SbBox3f box = bboxaction.getXfBoundingBox().project();
+  if (box.isEmpty()) return true;
+
+  const SbViewVolume vv = camera->getViewVolume(vp.getViewportAspectRatio());
+  SbMatrix affine, proj;
+  vv.getMatrices(affine, proj);
+  const SbVec2s origin = vp.getViewportOriginPixels();
+  const SbVec2s size = vp.getViewportSizePixels();
+  const SbVec3f & bmin = box.getMin();
+  const SbVec3f & bmax = box.getMax();
+  for (int i = 0; i < 8; i++) {
+    const SbVec3f corner((i & 1) ? bmax[0] : bmin[0],
+                         (i & 2) ? bmax[1] : bmin[1],
+                         (i & 4) ? bmax[2] : bmin[2]);
+    SbVec3f eye;
+    affine.multVecMatrix(corner, eye);
+    if (eye[2] > -vv.getNearDist()) return false;
+    SbVec3f screen;
+    vv.projectToScreen(corner, screen);
+    const float x = SbClamp(origin[0] + screen[0] * size[0], -1.0f, 32766.0f);
+    const float y = SbClamp(origin[1] + screen[1] * size[1], -1.0f, 32766.0f);
+    rect.extendBy(SbVec2s(short(x), short(y)));
+  }
+  return true;
+}
+
+void
+DamageTracker::clearRects(void)
+{
+  QHash<SoNode *, SbBox2s>::iterator it = this->lastrects.begin();
+  for (; it != this->lastrects.end(); ++it) {
+    it.key()->unref();
+  }
+  this->lastrects.clear();
+}
+
+/*
+  Forgets the screen areas of the separators above and below the tail
+  of \a path. Those move along with it, so where they were in the
+  last frame is no longer known when they change next.
+ */
+void
+DamageTracker::dropRelatedRects(SoPath * path)
+{
+  SoNode * separator = path->getTail();
+  if (this->lastrects.isEmpty() ||
+      (this->lastrects.size() == 1 && this->lastrects.contains(separator))) {
+    return;
+  }
+
+  QList<SoNode *> related;
+  for (int i = 0; i < path->getLength() - 1; i++) {
+    related.append(path->getNode(i));
+  }
+  SoSearchAction search;
+  search.setType(SoSeparator::getClassTypeId());
+  search.setInterest(SoSearchAction::ALL);
+  search.setSearchingAll(TRUE);
+  search.apply(separator);
+  const SoPathList & paths = search.getPaths();
+  for (int i = 0; i < paths.getLength(); i++) {
+    if (paths[i]->getTail() != separator) related.append(paths[i]->getTail());
+  }
+
+  for (int i = 0; i < related.size(); i++) {
+    QHash<SoNode *, SbBox2s>::iterator it = this->lastrects.find(related[i]);
+    if (it == this->lastrects.end()) continue;
+    this->lastrects.erase(it);
+    related[i]->unref();
+  }
+}
+
+/*
+  Called before the scene is rendered. Returns true if only the
+  damaged region needs to be redrawn over the previous frame, which
+  must then be in the framebuffer, see scissor().
+ */
+bool
+DamageTracker::beginFrame(void)
+{
+  this->partial = false;
+  if (!this->isenabled) return false;
+  this->rendering = true;
+
+  SoRenderManager * manager = this->quarterwidget->getSoRenderManager();
+  SoNode * root = manager->getSceneGraph();
+  if (this->sensor->getAttachedNode() != root) {
+    this->sensor->detach();
+    if (root) this->sensor->attach(root);
+    this->changed.truncate(0);
+    this->clearRects();
+    this->fullredraw = true;
+  }
+
+  // anything about the camera but the clipping planes, which are set
+  // for every frame
+  SoCamera * camera = manager->getCamera();
+  const SbViewportRegion & vp = manager->getViewportRegion();
+  SbVec3f position(0.0f, 0.0f, 0.0f);
+  SbRotation orientation;
+  float zoom = 0.0f;
+  if (camera) {
+    position = camera->position.getValue();
+    orientation = camera->orientation.getValue();
+    const SoSFFloat * field = static_cast<const SoSFFloat *>(camera->getField("heightAngle"));
+    if (!field) field = static_cast<const SoSFFloat *>(camera->getField("height"));
+    if (field) zoom = field->getValue();
+  }
+  if (!camera || camera != this->lastcamera || position != this->lastposition ||
+      !(orientation == this->lastorientation) || zoom != this->lastzoom ||
+      vp.getWindowSize() != this->lastsize) {
+    this->lastcamera = camera;
+    this->lastposition = position;
+    this->lastorientation = orientation;
+    this->lastzoom = zoom;
+    this->lastsize = vp.getWindowSize();
+    this->changed.truncate(0);
+    this->clearRects();
+    this->fullredraw = true;
+  }
+
+  // a redraw without changes is for an expose or a change outside of
+  // the scene graph
+  bool full = this->fullredraw || this->changed.getLength() == 0;
+  this->fullredraw = false;
+  if (this->lastrects.size() > MAX_RECTS) this->clearRects();
+
+  SbBox2s damage;
+  for (int i = 0; i < this->changed.getLength(); i++) {
+    SoPath * path = this->changed[i];
+    SoNode * separator = path->getTail();
+    this->dropRelatedRects(path);
+    SbBox2s rect;
+    QHash<SoNode *, SbBox2s>::iterator it = this->lastrects.find(separator);
+    if (!screenRect(path, camera, vp, rect)) {
+      full = true;
+      if (it != this->lastrects.end()) {
+        this->lastrects.erase(it);
+        separator->unref();
+      }
+      continue;
+    }
+    if (it == this->lastrects.end()) {
+      // where it was before is not known
+      full = true;
+      separator->ref();
+      this->lastrects.insert(separator, rect);
+    }
+    else {
+      if (!it.value().isEmpty()) damage.extendBy(it.value());
+      it.value() = rect;
+    }
+    if (!rect.isEmpty()) damage.extendBy(rect);
+  }
+  this->changed.truncate(0);
+  if (full) return false;
+
+  if (!damage.isEmpty()) {
+    // antialiased edges and line widths reach past the bounding box
+    const SbVec2s size = vp.getWindowSize();
+    const SbVec2s dmin = damage.getMin();
+    const SbVec2s dmax = damage.getMax();
+    damage.setBounds(SbMax(short(dmin[0] - 2), short(0)), SbMax(short(dmin[1] - 2), short(0)),
+                     SbMin(short(dmax[0] + 2), short(size[0] - 1)),
+                     SbMin(short(dmax[1] + 2), short(size[1] - 1)));
+    if (damage.isEmpty()) return false;
+    short width, height;
+    damage.getSize(width, height);
+    if (2.0 * double(width) * double(height) > double(size[0]) * double(size[1])) {
+      return false;
+    }
+  }
+  this->damage = damage;
+  this->partial = true;
+  return true;
+}
+
+/*
+  Restricts rendering to the damaged region, if the frame is a
+  partial one. An empty region leaves the previous frame as it is.
+ */
+void
+DamageTracker::scissor(void)
+{
+  if (!this->partial) return;
+  glEnable(GL_SCISSOR_TEST);
+  if (this->damage.isEmpty()) {
+    glScissor(0, 0, 0, 0);
+    return;
+  }
+  const SbVec2s dmin = this->damage.getMin();
+  const SbVec2s dmax = this->damage.getMax();
+  glScissor(dmin[0], dmin[1], dmax[0] - dmin[0] + 1, dmax[1] - dmin[1] + 1);
+}
+
+/*
+  Renders the frame in full after all, for when the previous frame
+  is not available.
+ */
+void
+DamageTracker::fullFrame(void)
+{
+  this->partial = false;
+}
+
+void
+DamageTracker::endFrame(void)
+{
+  if (this->partial) glDisable(GL_SCISSOR_TEST);
+  this->partial = false;
+  this->rendering = false;
+}
@@ -0,0 +1,98 @@
+#ifndef QUARTER_DAMAGETRACKER_H
+#define QUARTER_DAMAGETRACKER_H
+
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+#include <Inventor/SbBox2s.h>
+#include <Inventor/SbRotation.h>
+#include <Inventor/SbVec2s.h>
+#include <Inventor/SbVec3f.h>
+#include <Inventor/lists/SoPathList.h>
+#include <QtCore/QHash>
+
+class SoCamera;
+class SoNode;
+class SoNodeSensor;
+class SoPath;
+class SoSensor;
+class SbViewportRegion;
+
+namespace SIM { namespace Coin3D { namespace Quarter {
+
+class QuarterWidget;
+
+class DamageTracker {
+public:
+  DamageTracker(QuarterWidget * quarterwidget);
+  ~DamageTracker();
+
+  void setEnabled(bool yes);
+  bool enabled(void) const;
+
+  void invalidate(void);
+  bool beginFrame(void);
+  void scissor(void);
+  void fullFrame(void);
+  void endFrame(void);
+
+private:
+  static void changedCB(void * closure, SoSensor * sensor);
+  bool screenRect(SoPath * path, SoCamera * camera, const SbViewportRegion & vp,
+                  SbBox2s & rect) const;
+  void dropRelatedRects(SoPath * path);
+  void clearRects(void);
+
+  QuarterWidget * quarterwidget;
+  SoNodeSensor * sensor;
+  bool isenabled;
+  bool fullredraw;
+  bool partial;
+  bool rendering;
+  // paths to the separators changed since the last frame, below
+  // which the changes are contained
+  SoPathList changed;
+  // the screen area of each changed separator in the last frame, the
+  // separators are ref'ed
+  QHash<SoNode *, SbBox2s> lastrects;
+  SbBox2s damage;
+  // the camera and window size of the last frame
+  SoCamera * lastcamera;
+  SbVec3f lastposition;
+  SbRotation lastorientation;
+  float lastzoom;
+  SbVec2s lastsize;
+};
+
+}}} // namespace
+
+#endif // QUARTER_DAMAGETRACKER_H
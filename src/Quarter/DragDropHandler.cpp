@@ -46,10 +46,8 @@
 #include <QDropEvent>
 #include <QMimeData>
 
-#include <Inventor/SoInput.h>
-#include <Inventor/nodes/SoSeparator.h>
-
 #include <Quarter/QuarterWidget.h>
+#include <Quarter/SceneLoader.h>
 #include <stdlib.h>
 
 namespace SIM { namespace Coin3D { namespace Quarter {
@@ -65,6 +63,7 @@ public:
   QStringList suffixes;
   DragDropHandler * master;
   QuarterWidget * quarterwidget;
+  SceneLoader * sceneloader;
 };
 
 }}} // namespace
@@ -86,6 +85,8 @@ DragDropHandler::DragDropHandler(QuarterWidget * parent)
   PRIVATE(this)->quarterwidget = parent;
   assert(PRIVATE(this)->quarterwidget);
   PRIVATE(this)->suffixes << "iv" << "wrl";
+  PRIVATE(this)->sceneloader = new SceneLoader(this);
+  PRIVATE(this)->sceneloader->setTarget(parent);
 }
 
 DragDropHandler::~DragDropHandler()
@@ -93,10 +94,21 @@ DragDropHandler::~DragDropHandler()
   delete PRIVATE(this);
 }
 
+/*!
+  Returns the loader used to read dropped scene graphs. Connect to
+  its signals to show progress, or to cancel a load.
+ */
+SceneLoader *
+DragDropHandler::sceneLoader(void) const
+{
+  return PRIVATE(this)->sceneloader;
+}
+
 /*!
   Detects a QDragEnterEvent and if the event is the dropping of a
   valid Inventor or VRML file it opens the file, reads in the scene graph
-  and calls setSceneGraph on the QuarterWidget
+  in the background and calls setSceneGraph on the QuarterWidget once
+  it has been read
  */
 bool
 DragDropHandler::eventFilter(QObject *, QEvent * event)
@@ -133,34 +145,17 @@ DragDropHandlerP::dropEvent(QDropEvent * event)
 {
   const QMimeData * mimedata = event->mimeData();
 
-  SoSeparator * root;
-  SoInput in;
-  QByteArray bytes;
-
+  // the scene loader sets the new scene graph once it has been read
   if (mimedata->hasUrls()) {
     QUrl url = mimedata->urls().takeFirst();
     if (url.scheme().isEmpty() || url.scheme().toLower() == QString("file") ) {
       // attempt to open file
-      if (!in.openFile(url.toLocalFile().toLatin1().constData())) return;
+      this->sceneloader->load(url.toLocalFile());
     }
   } else if (mimedata->hasText()) {
     /* FIXME 2007-11-09 preng: dropping text buffer does not work on Windows Vista. */
-    bytes = mimedata->text().toUtf8();
-    in.setBuffer((void *) bytes.constData(), bytes.size());
-    if (!in.isValidBuffer()) return;
+    this->sceneloader->loadBuffer(mimedata->text().toUtf8());
   }
-
-  // attempt to import it
-  root = SoDB::readAll(&in);
-  if (root == NULL) return;
-
-  // set new scene graph
-  this->quarterwidget->setSceneGraph(root);
-#if (QT_VERSION >= 0x060000)
-  this->quarterwidget->update();
-#else
-  this->quarterwidget->updateGL();
-#endif
 }
 
 #undef PRIVATE
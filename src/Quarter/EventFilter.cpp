@@ -37,26 +37,276 @@
 #include <Quarter/eventhandlers/EventFilter.h>
 
 #include <QEvent>
+#include <QHash>
 #include <QMouseEvent>
+#include <QTimer>
+#include <QWheelEvent>
+#if QT_VERSION >= 0x050000
+#  include <QGuiApplication>
+#  include <QScreen>
+#  include <QWindow>
+#endif
+
+#include <Inventor/SbBasic.h>
+#include <Inventor/SbTime.h>
 
 #include <Inventor/SoEventManager.h>
+#include <Inventor/events/SoEvent.h>
 #include <Inventor/events/SoLocation2Event.h>
 #include <Inventor/events/SoMouseButtonEvent.h>
 
 #include <Quarter/QuarterWidget.h>
+#include <Quarter/QuarterWindow.h>
 #include <Quarter/devices/Mouse.h>
 #include <Quarter/devices/Keyboard.h>
 #include <Quarter/devices/SpaceNavigatorDevice.h>
+#include <Quarter/devices/TouchDevice.h>
+
+#include "Trace.h"
 
 namespace SIM { namespace Coin3D { namespace Quarter {
 
 class EventFilterP {
 public:
   QList<InputDevice *> devices;
+  // the devices to pass each event type to, in registration order
+  QHash<int, QList<InputDevice *> > dispatchtable;
+  // the devices which did not declare their event types
+  QList<InputDevice *> wildcarddevices;
+  // the devices which deliver their input right before a frame
+  QList<TouchDevice *> touchdevices;
   QuarterWidget * quarterwidget;
+#if QT_VERSION >= 0x050000
+  QuarterWindow * quarterwindow;
+#endif
   QPoint globalmousepos;
   SbVec2s windowsize;
 
+  // coalescing of mouse move and wheel events
+  bool coalescing;
+  // pointer drags held back until the next frame is rendered
+  bool latelatching;
+  bool pendinglatched;
+  QEvent * pendingevent;
+  int pendingcount;
+  // when the oldest event merged into pendingevent was received
+  SbTime pendingtime;
+  QTimer * flushtimer;
+  SbTime lastflush;
+
+  static QEvent * copyEvent(QEvent * event)
+  {
+#if QT_VERSION >= 0x060000
+    return event->clone();
+#else
+    if (event->type() == QEvent::Wheel) {
+      return new QWheelEvent(*static_cast<QWheelEvent *>(event));
+    }
+    return new QMouseEvent(*static_cast<QMouseEvent *>(event));
+#endif
+  }
+
+  static int wheelDirection(QEvent * event)
+  {
+#if QT_VERSION >= 0x050000
+    int delta = static_cast<QWheelEvent *>(event)->angleDelta().y();
+#else
+    int delta = static_cast<QWheelEvent *>(event)->delta();
+#endif
+    return (delta > 0) ? 1 : ((delta < 0) ? -1 : 0);
+  }
+
+  // Returns true if the pending event can absorb \a event
+  bool canMerge(QEvent * event) const
+  {
+    if (!this->pendingevent || this->pendingevent->type() != event->type()) return false;
+    if (event->type() == QEvent::MouseMove) {
+      return
+        static_cast<QMouseEvent *>(event)->buttons() ==
+        static_cast<QMouseEvent *>(this->pendingevent)->buttons();
+    }
+    // Coin's wheel events only carry the direction, so each wheel event
+    // is delivered, but only consecutive ones with the same direction
+    // are merged
+    return wheelDirection(event) == wheelDirection(this->pendingevent);
+  }
+
+  double refreshInterval(void) const
+  {
+    qreal rate = 60.0;
+#if QT_VERSION >= 0x050000
+    QScreen * screen = NULL;
+    if (this->quarterwindow) {
+      screen = this->quarterwindow->screen();
+    }
+    else {
+      QWidget * winwidg = this->quarterwidget->window();
+      if (winwidg && winwidg->windowHandle()) {
+        screen = winwidg->windowHandle()->screen();
+      }
+    }
+    if (!screen) {
+      screen = QGuiApplication::primaryScreen();
+    }
+    if (screen && screen->refreshRate() > 0.0) {
+      rate = screen->refreshRate();
+    }
+#endif
+    return 1.0 / rate;
+  }
+
+  void scheduleFlush(void)
+  {
+    if (this->flushtimer->isActive()) return;
+    SbTime next = this->lastflush + SbTime(this->refreshInterval());
+    double delay = (next - SbTime::getTimeOfDay()).getValue();
+    this->flushtimer->start(int(SbMax(delay, 0.0) * 1000.0));
+  }
+
+  bool dispatch(QEvent * qevent, const SbTime & received)
+  {
+    // make sure every device has updated screen size and mouse position
+    // before translating events
+    switch (qevent->type()) {
+    case QEvent::MouseMove:
+    case QEvent::MouseButtonPress:
+    case QEvent::MouseButtonRelease:
+    case QEvent::MouseButtonDblClick:
+      this->trackPointerPosition(static_cast<QMouseEvent *>(qevent));
+      break;
+    case QEvent::Resize:
+      this->trackWindowSize(static_cast<QResizeEvent *>(qevent));
+      break;
+    default:
+      break;
+    }
+
+    const QList<InputDevice *> & devices = this->devicesFor(qevent->type());
+    if (devices.isEmpty()) return false;
+
+    // translate QEvent into SoEvent and see if it is handled by scene
+    // graph
+    const qreal devicepixelratio = this->devicePixelRatio();
+    foreach(InputDevice * device, devices) {
+      device->setDevicePixelRatio(devicepixelratio);
+      const SoEvent * soevent = NULL;
+      {
+        QUARTER_TRACE_SCOPE("EventFilter::translateEvent");
+        soevent = device->translateEvent(qevent);
+      }
+      // the devices stamp the event when it is translated, which may
+      // be a while later for a coalesced event. The receive time is
+      // used for measuring the input latency
+      if (soevent) const_cast<SoEvent *>(soevent)->setTime(received);
+      if (soevent && this->processSoEvent(soevent)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // Returns true if \a event is a pointer drag to hold back until the
+  // next frame
+  bool latchable(QEvent * event) const
+  {
+    return this->latelatching && event->type() == QEvent::MouseMove &&
+      static_cast<QMouseEvent *>(event)->buttons() != Qt::NoButton;
+  }
+
+  // the held back drag is delivered by latchPendingEvent() when the
+  // frame is rendered
+  void requestFrame(void)
+  {
+    SoRenderManager * manager = NULL;
+#if QT_VERSION >= 0x050000
+    if (this->quarterwindow) {
+      manager = this->quarterwindow->getSoRenderManager();
+    }
+    else
+#endif
+    {
+      manager = this->quarterwidget->getSoRenderManager();
+    }
+    if (manager) manager->scheduleRedraw();
+  }
+
+  void flush(void)
+  {
+    this->flushtimer->stop();
+    this->lastflush = SbTime::getTimeOfDay();
+    this->pendinglatched = false;
+    if (!this->pendingevent) return;
+
+    QEvent * event = this->pendingevent;
+    int count = this->pendingcount;
+    this->pendingevent = NULL;
+    this->pendingcount = 0;
+    for (int i = 0; i < count; i++) {
+      this->dispatch(event, this->pendingtime);
+    }
+    delete event;
+  }
+
+  qreal devicePixelRatio(void) const
+  {
+#if QT_VERSION >= 0x050000
+    if (this->quarterwindow) {
+      return this->quarterwindow->devicePixelRatio();
+    }
+#endif
+    return this->quarterwidget->devicePixelRatio();
+  }
+
+  bool processSoEvent(const SoEvent * soevent)
+  {
+    QUARTER_TRACE_SCOPE("EventFilter::processSoEvent");
+#if QT_VERSION >= 0x050000
+    if (this->quarterwindow) {
+      return this->quarterwindow->processSoEvent(soevent);
+    }
+#endif
+    return this->quarterwidget->processSoEvent(soevent);
+  }
+
+  void updateDispatchTable(void)
+  {
+    this->dispatchtable.clear();
+    this->wildcarddevices.clear();
+    this->touchdevices.clear();
+
+    QList<QList<QEvent::Type> > devicetypes;
+    foreach(InputDevice * device, this->devices) {
+      QList<QEvent::Type> types = device->eventTypes();
+      devicetypes.append(types);
+      if (types.isEmpty()) {
+        this->wildcarddevices.append(device);
+      }
+      TouchDevice * touchdevice = dynamic_cast<TouchDevice *>(device);
+      if (touchdevice) {
+        this->touchdevices.append(touchdevice);
+      }
+      foreach(QEvent::Type type, types) {
+        this->dispatchtable.insert(int(type), QList<InputDevice *>());
+      }
+    }
+
+    QHash<int, QList<InputDevice *> >::iterator it = this->dispatchtable.begin();
+    for (; it != this->dispatchtable.end(); ++it) {
+      for (int i = 0; i < this->devices.size(); i++) {
+        if (devicetypes[i].isEmpty() || devicetypes[i].contains(QEvent::Type(it.key()))) {
+          it.value().append(this->devices[i]);
+        }
+      }
+    }
+  }
+
+  const QList<InputDevice *> & devicesFor(QEvent::Type type) const
+  {
+    QHash<int, QList<InputDevice *> >::const_iterator it =
+      this->dispatchtable.constFind(int(type));
+    return (it != this->dispatchtable.constEnd()) ? it.value() : this->wildcarddevices;
+  }
+
   void trackWindowSize(QResizeEvent * event)
   {
     this->windowsize = SbVec2s(event->size().width(),
@@ -78,7 +328,7 @@ public:
 
     SbVec2s mousepos(event->pos().x(), this->windowsize[1] - event->pos().y() - 1);
     // the following corrects for high-dpi displays (e.g., mac retina)
-    mousepos *= quarterwidget->devicePixelRatio();
+    mousepos *= this->devicePixelRatio();
     foreach(InputDevice * device, this->devices) {
       device->setMousePosition(mousepos);
     }
@@ -100,10 +350,31 @@ EventFilter::EventFilter(QObject * parent)
   QuarterWidget* quarter = dynamic_cast<QuarterWidget *>(parent);
 
   PRIVATE(this)->quarterwidget = quarter;
-  assert(PRIVATE(this)->quarterwidget);
-
-  PRIVATE(this)->windowsize = SbVec2s(PRIVATE(this)->quarterwidget->width(),
-                                      PRIVATE(this)->quarterwidget->height());
+  PRIVATE(this)->coalescing = false;
+  PRIVATE(this)->latelatching = false;
+  PRIVATE(this)->pendinglatched = false;
+  PRIVATE(this)->pendingevent = NULL;
+  PRIVATE(this)->pendingcount = 0;
+  PRIVATE(this)->flushtimer = new QTimer(this);
+  PRIVATE(this)->flushtimer->setSingleShot(true);
+#if QT_VERSION >= 0x050000
+  PRIVATE(this)->flushtimer->setTimerType(Qt::PreciseTimer);
+#endif
+  this->connect(PRIVATE(this)->flushtimer, SIGNAL(timeout(void)), this, SLOT(flushPendingEvent()));
+#if QT_VERSION >= 0x050000
+  // the filter is owned either by a QuarterWidget or a QuarterWindow
+  PRIVATE(this)->quarterwindow = dynamic_cast<QuarterWindow *>(parent);
+  if (PRIVATE(this)->quarterwindow) {
+    PRIVATE(this)->windowsize = SbVec2s(PRIVATE(this)->quarterwindow->width(),
+                                        PRIVATE(this)->quarterwindow->height());
+  }
+  else
+#endif
+  {
+    assert(PRIVATE(this)->quarterwidget);
+    PRIVATE(this)->windowsize = SbVec2s(PRIVATE(this)->quarterwidget->width(),
+                                        PRIVATE(this)->quarterwidget->height());
+  }
 
   PRIVATE(this)->devices += new Mouse(quarter);
   PRIVATE(this)->devices += new Keyboard(quarter);
@@ -112,21 +383,28 @@ EventFilter::EventFilter(QObject * parent)
   PRIVATE(this)->devices += new SpaceNavigatorDevice(quarter);
 #endif // HAVE_SPACENAV_LIB
 
+  PRIVATE(this)->updateDispatchTable();
+
 }
 
 EventFilter::~EventFilter()
 {
   qDeleteAll(PRIVATE(this)->devices);
+  delete PRIVATE(this)->pendingevent;
   delete PRIVATE(this);
 }
 
 /*!
-  Adds a device for event translation
+  Adds a device for event translation. The device is only given the
+  events of the types returned by InputDevice::eventTypes(), which
+  are looked up once, here.
  */
 void 
 EventFilter::registerInputDevice(InputDevice * device)
 {
   PRIVATE(this)->devices += device;
+  device->setWindowSize(PRIVATE(this)->windowsize);
+  PRIVATE(this)->updateDispatchTable();
 }
 
 /*!
@@ -138,6 +416,7 @@ EventFilter::unregisterInputDevice(InputDevice * device)
   int i = PRIVATE(this)->devices.indexOf(device);
   if (i != -1) {
     PRIVATE(this)->devices.removeAt(i);
+    PRIVATE(this)->updateDispatchTable();
   }
 }
 
@@ -149,31 +428,163 @@ EventFilter::unregisterInputDevice(InputDevice * device)
 bool
 EventFilter::eventFilter(QObject * obj, QEvent * qevent)
 {
-  // make sure every device has updated screen size and mouse position
-  // before translating events
+  const SbTime received = SbTime::getTimeOfDay();
   switch (qevent->type()) {
   case QEvent::MouseMove:
+  case QEvent::Wheel:
+    if (PRIVATE(this)->coalescing || PRIVATE(this)->latchable(qevent)) {
+      const bool latch = PRIVATE(this)->latchable(qevent);
+      if (PRIVATE(this)->canMerge(qevent)) {
+        // the latest event replaces the pending one
+        delete PRIVATE(this)->pendingevent;
+        PRIVATE(this)->pendingevent = EventFilterP::copyEvent(qevent);
+        // consecutive moves collapse into one, wheel steps add up
+        if (qevent->type() == QEvent::Wheel) PRIVATE(this)->pendingcount++;
+      }
+      else {
+        PRIVATE(this)->flush();
+        PRIVATE(this)->pendingevent = EventFilterP::copyEvent(qevent);
+        PRIVATE(this)->pendingcount = 1;
+        PRIVATE(this)->pendingtime = received;
+      }
+      if (latch) {
+        PRIVATE(this)->pendinglatched = true;
+        PRIVATE(this)->requestFrame();
+      }
+      else {
+        PRIVATE(this)->scheduleFlush();
+      }
+      // we can't know yet whether the scene graph will handle it
+      return true;
+    }
+    break;
+  case QEvent::Paint:
+  case QEvent::UpdateRequest:
+    // a held back drag is delivered inside paintGL()
+    if (PRIVATE(this)->pendinglatched) break;
+    PRIVATE(this)->flush();
+    break;
+  case QEvent::TouchBegin:
+  case QEvent::TouchUpdate:
+  case QEvent::TouchEnd:
+  case QEvent::TouchCancel:
+    // Qt only delivers the rest of a touch sequence if its TouchBegin
+    // is accepted, and touch devices deliver their input later
+    if (PRIVATE(this)->dispatchtable.contains(int(qevent->type()))) {
+      PRIVATE(this)->dispatch(qevent, received);
+      qevent->accept();
+      return true;
+    }
+    break;
   case QEvent::MouseButtonPress:
   case QEvent::MouseButtonRelease:
   case QEvent::MouseButtonDblClick:
-    PRIVATE(this)->trackPointerPosition(dynamic_cast<QMouseEvent *>(qevent));
-    break;
+  case QEvent::KeyPress:
+  case QEvent::KeyRelease:
   case QEvent::Resize:
-    PRIVATE(this)->trackWindowSize(dynamic_cast<QResizeEvent *>(qevent));
+  case QEvent::Leave:
+  case QEvent::FocusOut:
+    // deliver the pending event before anything which depends on
+    // it, and before the next frame is rendered
+    PRIVATE(this)->flush();
     break;
   default:
     break;
   }
 
-  // translate QEvent into SoEvent and see if it is handled by scene
-  // graph
-  foreach(InputDevice * device, PRIVATE(this)->devices) {
-    const SoEvent * soevent = device->translateEvent(qevent);
-    if (soevent && PRIVATE(this)->quarterwidget->processSoEvent(soevent)) {
-      return true;
-    }
+  return PRIVATE(this)->dispatch(qevent, received);
+}
+
+/*!
+  Enable/disable coalescing of input events.
+
+  When enabled, consecutive mouse move events are collapsed into the
+  most recent one and delivered at most once per display refresh
+  interval, or right before the next frame is painted. Consecutive
+  wheel events rotating in the same direction are held back the same
+  way and then delivered back-to-back. Button, key and other events
+  are never delayed; any pending event is delivered before them, so
+  the order of the events is preserved.
+
+  Coalesced events are always accepted, i.e. they are not propagated
+  to the parent widget even if the scene graph does not handle
+  them. This is off by default.
+ */
+void
+EventFilter::setCoalescingEnabled(bool yes)
+{
+  if (!yes) {
+    PRIVATE(this)->flush();
+  }
+  PRIVATE(this)->coalescing = yes;
+}
+
+/*!
+  Returns true if input events are coalesced.
+ */
+bool
+EventFilter::coalescingEnabled(void) const
+{
+  return PRIVATE(this)->coalescing;
+}
+
+/*!
+  Enable/disable late latching of pointer drags.
+
+  When enabled, mouse move events with a button pressed, i.e. the
+  ones which rotate and pan the camera, are held back and collapsed
+  into the most recent one, and a redraw is scheduled instead. The
+  QuarterWidget or QuarterWindow delivers the held back event right
+  before it renders the next frame, by calling latchPendingEvent(),
+  so the camera reflects the latest pointer position at render time
+  rather than whichever one was processed first. Other events are
+  delivered as usual, after the held back one.
+
+  Like coalesced events, held back events are always accepted. This
+  is off by default.
+ */
+void
+EventFilter::setLateLatchingEnabled(bool yes)
+{
+  if (!yes && PRIVATE(this)->pendinglatched) {
+    PRIVATE(this)->flush();
   }
-  return false;
+  PRIVATE(this)->latelatching = yes;
+}
+
+/*!
+  Returns true if pointer drags are latched right before rendering.
+ */
+bool
+EventFilter::lateLatchingEnabled(void) const
+{
+  return PRIVATE(this)->latelatching;
+}
+
+/*!
+  Delivers the pointer drag held back for late latching, if any, and
+  the input the registered TouchDevices gathered since the last
+  frame. Returns true if there was any. Called by QuarterWidget and
+  QuarterWindow before they render a frame.
+ */
+bool
+EventFilter::latchPendingEvent(void)
+{
+  bool latched = false;
+  foreach (TouchDevice * device, PRIVATE(this)->touchdevices) {
+    device->setDevicePixelRatio(PRIVATE(this)->devicePixelRatio());
+    if (device->latchPendingMotion()) latched = true;
+  }
+  if (!PRIVATE(this)->pendinglatched) return latched;
+  QUARTER_TRACE_SCOPE("EventFilter::latchPendingEvent");
+  PRIVATE(this)->flush();
+  return true;
+}
+
+void
+EventFilter::flushPendingEvent(void)
+{
+  PRIVATE(this)->flush();
 }
 
 /*!
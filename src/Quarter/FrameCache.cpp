@@ -0,0 +1,266 @@
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+/*
+  Keeps a copy of the last frame rendered by QuarterWidget, so that
+  paintGL() calls which are not caused by a change in the scene (expose
+  events, window moves, recomposition) can blit the copy instead of
+  traversing the scene graph again.
+
+  Also tracks when the device pixel ratio may have changed, so that
+  QuarterWidget does not need to look it up for every frame.
+ */
+
+#include "FrameCache.h"
+
+#include <QtCore/QEvent>
+#if (QT_VERSION >= 0x050000)
+#  include <QWindow>
+#  include <QOpenGLFramebufferObject>
+#endif
+
+#include <Inventor/SbVec2s.h>
+#include <Inventor/SbViewportRegion.h>
+#include <Inventor/SoRenderManager.h>
+#include <Inventor/system/gl.h>
+
+#include <Quarter/QuarterWidget.h>
+
+using namespace SIM::Coin3D::Quarter;
+
+FrameCache::FrameCache(QuarterWidget * quarterwidget)
+  : QObject(quarterwidget)
+{
+  this->quarterwidget = quarterwidget;
+  this->isenabled = false;
+  this->keepframe = false;
+  this->scenedirty = true;
+  this->dprdirty = true;
+  this->fbo = NULL;
+
+  quarterwidget->installEventFilter(this);
+}
+
+FrameCache::~FrameCache()
+{
+}
+
+void
+FrameCache::setEnabled(bool yes)
+{
+  this->isenabled = yes;
+  // the copy may be stale if frames were rendered while disabled
+  this->scenedirty = true;
+}
+
+bool
+FrameCache::enabled(void) const
+{
+  return this->isenabled;
+}
+
+/*
+  Marks the scene as changed, so the next frame is rendered.
+ */
+void
+FrameCache::invalidate(void)
+{
+  this->scenedirty = true;
+}
+
+/*
+  Called from QuarterWidget::paintGL() instead of rendering the
+  scene. Blits the copy of the last frame into the widget and returns
+  true if the scene has not changed since it was rendered.
+ */
+bool
+FrameCache::reuseFrame(void)
+{
+  if (!this->isenabled || this->scenedirty || !this->fbo) return false;
+
+#if (QT_VERSION >= 0x050000)
+  SbVec2s size = this->quarterwidget->getSoRenderManager()->getViewportRegion().getWindowSize();
+  QRect rect(0, 0, size[0], size[1]);
+  if (this->fbo->size() != rect.size()) return false;
+
+  QOpenGLFramebufferObject::blitFramebuffer(NULL, rect, this->fbo, rect,
+                                            GL_COLOR_BUFFER_BIT, GL_NEAREST);
+  return true;
+#else
+  return false;
+#endif
+}
+
+/*
+  Called from QuarterWidget::paintGL() after the scene has been
+  rendered. Copies the color buffer for later reuse.
+ */
+void
+FrameCache::frameRendered(void)
+{
+  this->scenedirty = false;
+  if (!this->isenabled && !this->keepframe) return;
+
+#if (QT_VERSION >= 0x050000)
+  if (!QOpenGLFramebufferObject::hasOpenGLFramebufferBlit()) {
+    this->scenedirty = true;
+    return;
+  }
+
+  SbVec2s size = this->quarterwidget->getSoRenderManager()->getViewportRegion().getWindowSize();
+  QRect rect(0, 0, size[0], size[1]);
+  if (!this->fbo || this->fbo->size() != rect.size()) {
+    delete this->fbo;
+    this->fbo = new QOpenGLFramebufferObject(rect.size(), QOpenGLFramebufferObject::NoAttachment);
+  }
+
+  QOpenGLFramebufferObject::blitFramebuffer(this->fbo, rect, NULL, rect,
+                                            GL_COLOR_BUFFER_BIT, GL_NEAREST);
+#endif
+}
+
+/*
+  Keeps the copy of the last frame even with frame reuse disabled, for
+  restoreFrame().
+ */
+void
+FrameCache::setKeepFrame(bool yes)
+{
+  this->keepframe = yes;
+}
+
+/*
+  Blits the copy of the last frame into the widget, whether the scene
+  has changed or not, so that only part of it needs to be rendered
+  again. Returns false if there is no copy of the current size.
+ */
+bool
+FrameCache::restoreFrame(void)
+{
+#if (QT_VERSION >= 0x050000)
+  if (!this->fbo) return false;
+  SbVec2s size = this->quarterwidget->getSoRenderManager()->getViewportRegion().getWindowSize();
+  QRect rect(0, 0, size[0], size[1]);
+  if (this->fbo->size() != rect.size()) return false;
+
+  QOpenGLFramebufferObject::blitFramebuffer(NULL, rect, this->fbo, rect,
+                                            GL_COLOR_BUFFER_BIT, GL_NEAREST);
+  return true;
+#else
+  return false;
+#endif
+}
+
+/*
+  Returns true if the device pixel ratio may have changed since it
+  was last looked up.
+ */
+bool
+FrameCache::devicePixelRatioDirty(void) const
+{
+  return this->dprdirty;
+}
+
+void
+FrameCache::devicePixelRatioUpdated(void)
+{
+  this->dprdirty = false;
+}
+
+bool
+FrameCache::hasFramebuffer(void) const
+{
+  return this->fbo != NULL;
+}
+
+/*
+  Releases the framebuffer object. Must be called with the widget's
+  GL context current.
+ */
+void
+FrameCache::cleanup(void)
+{
+#if (QT_VERSION >= 0x050000)
+  delete this->fbo;
+#endif
+  this->fbo = NULL;
+  this->scenedirty = true;
+}
+
+void
+FrameCache::screenChanged(void)
+{
+  this->dprdirty = true;
+  this->scenedirty = true;
+}
+
+bool
+FrameCache::eventFilter(QObject * obj, QEvent * event)
+{
+  switch (event->type()) {
+  case QEvent::Show:
+  case QEvent::ParentChange:
+    // the widget may have moved to another window
+    this->trackWindow();
+    break;
+#if (QT_VERSION >= 0x060600)
+  case QEvent::DevicePixelRatioChange:
+    this->screenChanged();
+    break;
+#endif
+  default:
+    break;
+  }
+  return false;
+}
+
+void
+FrameCache::trackWindow(void)
+{
+#if (QT_VERSION >= 0x050000)
+  QWindow * window = NULL;
+  QWidget * winwidg = this->quarterwidget->window();
+  if (winwidg) {
+    window = winwidg->windowHandle();
+  }
+  if (window != this->window) {
+    if (this->window) {
+      this->disconnect(this->window, SIGNAL(screenChanged(QScreen *)), this, SLOT(screenChanged()));
+    }
+    this->window = window;
+    if (window) {
+      this->connect(window, SIGNAL(screenChanged(QScreen *)), this, SLOT(screenChanged()));
+    }
+  }
+#endif
+  this->screenChanged();
+}
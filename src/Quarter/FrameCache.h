@@ -0,0 +1,89 @@
+#ifndef QUARTER_FRAMECACHE_H
+#define QUARTER_FRAMECACHE_H
+
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+#include <QtCore/QObject>
+#include <QtCore/QPointer>
+
+class QEvent;
+class QWindow;
+class QOpenGLFramebufferObject;
+
+namespace SIM { namespace Coin3D { namespace Quarter {
+
+class QuarterWidget;
+
+class FrameCache : public QObject {
+  Q_OBJECT
+public:
+  FrameCache(QuarterWidget * quarterwidget);
+  ~FrameCache();
+
+  void setEnabled(bool yes);
+  bool enabled(void) const;
+
+  void invalidate(void);
+  bool reuseFrame(void);
+  void frameRendered(void);
+
+  void setKeepFrame(bool yes);
+  bool restoreFrame(void);
+
+  bool devicePixelRatioDirty(void) const;
+  void devicePixelRatioUpdated(void);
+
+  bool hasFramebuffer(void) const;
+  void cleanup(void);
+
+public slots:
+  void screenChanged(void);
+
+protected:
+  virtual bool eventFilter(QObject * obj, QEvent * event);
+
+private:
+  void trackWindow(void);
+
+  QuarterWidget * quarterwidget;
+  bool isenabled;
+  bool keepframe;
+  bool scenedirty;
+  bool dprdirty;
+#if (QT_VERSION >= 0x050000)
+  QPointer<QWindow> window;
+#endif
+  QOpenGLFramebufferObject * fbo;
+};
+
+}}} // namespace
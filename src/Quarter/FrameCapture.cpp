@@ -0,0 +1,311 @@
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+/*
+  Reads back rendered frames for QuarterWidget without stalling the
+  pipeline. The pixels are read into a ring of pixel buffer objects
+  right after the scene has been rendered, and the buffers are mapped
+  and handed to the callers a couple of frames later, when the GPU
+  has finished the transfer.
+ */
+
+#include "FrameCapture.h"
+
+#include <string.h>
+
+#include <QtCore/QTimer>
+
+#include <Inventor/SbVec2s.h>
+#include <Inventor/SbViewportRegion.h>
+#include <Inventor/SoRenderManager.h>
+#include <Inventor/system/gl.h>
+
+#include <Quarter/QuarterWidget.h>
+
+#ifndef GL_PIXEL_PACK_BUFFER
+#define GL_PIXEL_PACK_BUFFER 0x88EB
+#endif
+#ifndef GL_STREAM_READ
+#define GL_STREAM_READ 0x88E1
+#endif
+#ifndef GL_READ_ONLY
+#define GL_READ_ONLY 0x88B8
+#endif
+#ifndef GL_BGRA
+#define GL_BGRA 0x80E1
+#endif
+#ifndef GL_UNSIGNED_INT_8_8_8_8_REV
+#define GL_UNSIGNED_INT_8_8_8_8_REV 0x8367
+#endif
+
+using namespace SIM::Coin3D::Quarter;
+
+FrameCapture::FrameCapture(QuarterWidget * quarterwidget)
+  : QObject(quarterwidget)
+{
+  this->quarterwidget = quarterwidget;
+  this->glue = NULL;
+  this->buffersinitialized = false;
+  this->current = 0;
+  this->continuous.callback = NULL;
+  this->continuous.userdata = NULL;
+
+  for (int i = 0; i < NUM_BUFFERS; i++) {
+    this->readbacks[i].buffer = 0;
+    this->readbacks[i].width = 0;
+    this->readbacks[i].height = 0;
+    this->readbacks[i].age = 0;
+    this->readbacks[i].pending = false;
+  }
+
+  // deliver outstanding readbacks even if no more frames are rendered
+  this->timer = new QTimer(this);
+  this->timer->setSingleShot(true);
+  this->timer->setInterval(16);
+  this->connect(this->timer, SIGNAL(timeout(void)), this, SLOT(flush()));
+}
+
+FrameCapture::~FrameCapture()
+{
+}
+
+void
+FrameCapture::request(CaptureCB * callback, void * userdata)
+{
+  Request request;
+  request.callback = callback;
+  request.userdata = userdata;
+  this->requests.append(request);
+}
+
+/*
+  Makes every rendered frame be captured for \a callback, until it is
+  set to NULL.
+ */
+void
+FrameCapture::setContinuous(CaptureCB * callback, void * userdata)
+{
+  this->continuous.callback = callback;
+  this->continuous.userdata = userdata;
+}
+
+bool
+FrameCapture::hasRequests(void) const
+{
+  return !this->requests.isEmpty() || this->continuous.callback;
+}
+
+/*
+  Called from QuarterWidget::paintGL() right after the scene has been
+  rendered, with the GL context current.
+ */
+void
+FrameCapture::frameRendered(void)
+{
+  bool outstanding = false;
+  for (int i = 0; i < NUM_BUFFERS; i++) {
+    Readback & readback = this->readbacks[i];
+    if (!readback.pending) continue;
+    if (++readback.age >= LATENCY) {
+      this->deliver(readback);
+    }
+    else {
+      outstanding = true;
+    }
+  }
+
+  if (this->continuous.callback) {
+    this->requests.append(this->continuous);
+  }
+
+  if (!this->requests.isEmpty()) {
+    if (!this->buffersinitialized) {
+      this->initBuffers();
+    }
+
+    SbVec2s size = this->quarterwidget->getSoRenderManager()->getViewportRegion().getWindowSize();
+    const int width = size[0];
+    const int height = size[1];
+
+    QList<Request> requests = this->requests;
+    this->requests.clear();
+
+    if (!this->glue) {
+      // no pixel buffer objects; fall back to a synchronous readback
+      QImage image(width, height, QImage::Format_ARGB32);
+      this->readPixels(width, height, image.bits());
+      FrameCapture::deliver(requests, image.mirrored());
+    }
+    else {
+      this->current = (this->current + 1) % NUM_BUFFERS;
+      Readback & readback = this->readbacks[this->current];
+      // the ring is full, so this one has to block
+      if (readback.pending) {
+        this->deliver(readback);
+      }
+
+      cc_glglue_glBindBuffer(this->glue, GL_PIXEL_PACK_BUFFER, readback.buffer);
+      cc_glglue_glBufferData(this->glue, GL_PIXEL_PACK_BUFFER,
+                             intptr_t(width) * height * 4, NULL, GL_STREAM_READ);
+      this->readPixels(width, height, NULL);
+      cc_glglue_glBindBuffer(this->glue, GL_PIXEL_PACK_BUFFER, 0);
+
+      readback.width = width;
+      readback.height = height;
+      readback.age = 0;
+      readback.pending = true;
+      readback.requests = requests;
+      outstanding = true;
+    }
+  }
+
+  if (outstanding && !this->timer->isActive()) {
+    this->timer->start();
+  }
+}
+
+/*
+  Delivers all outstanding readbacks. Invoked from the timer when no
+  new frame has been rendered since the readbacks were issued.
+ */
+void
+FrameCapture::flush(void)
+{
+  bool outstanding = false;
+  for (int i = 0; i < NUM_BUFFERS; i++) {
+    outstanding = outstanding || this->readbacks[i].pending;
+  }
+  if (!outstanding) return;
+
+  this->quarterwidget->makeCurrent();
+  for (int i = 0; i < NUM_BUFFERS; i++) {
+    if (this->readbacks[i].pending) {
+      this->deliver(this->readbacks[i]);
+    }
+  }
+  this->quarterwidget->doneCurrent();
+}
+
+bool
+FrameCapture::hasBuffers(void) const
+{
+  return this->glue != NULL;
+}
+
+/*
+  Releases the pixel buffer objects, dropping outstanding
+  readbacks. Must be called with the widget's GL context current.
+ */
+void
+FrameCapture::cleanup(void)
+{
+  this->timer->stop();
+  if (this->glue) {
+    for (int i = 0; i < NUM_BUFFERS; i++) {
+      cc_glglue_glDeleteBuffers(this->glue, 1, &this->readbacks[i].buffer);
+      this->readbacks[i].buffer = 0;
+      this->readbacks[i].pending = false;
+      this->readbacks[i].requests.clear();
+    }
+    this->glue = NULL;
+  }
+  this->buffersinitialized = false;
+}
+
+void
+FrameCapture::initBuffers(void)
+{
+  this->buffersinitialized = true;
+
+  const cc_glglue * glue = cc_glglue_instance(this->quarterwidget->getCacheContextId());
+  if (!cc_glglue_has_vertex_buffer_object(glue) ||
+      !(cc_glglue_glversion_matches_at_least(glue, 2, 1, 0) ||
+        cc_glglue_glext_supported(glue, "GL_ARB_pixel_buffer_object"))) {
+    return;
+  }
+
+  this->glue = glue;
+  for (int i = 0; i < NUM_BUFFERS; i++) {
+    cc_glglue_glGenBuffers(this->glue, 1, &this->readbacks[i].buffer);
+  }
+}
+
+/*
+  Reads the color buffer as 32-bit ARGB words, matching
+  QImage::Format_ARGB32 independent of the byte order.
+ */
+void
+FrameCapture::readPixels(int width, int height, void * pixels)
+{
+  glPixelStorei(GL_PACK_ALIGNMENT, 4);
+  glReadPixels(0, 0, width, height, GL_BGRA, GL_UNSIGNED_INT_8_8_8_8_REV, pixels);
+}
+
+/*
+  Maps the buffer of \a readback and hands the image to its
+  callers. OpenGL images are stored bottom-up, so the rows are
+  flipped while copying.
+ */
+void
+FrameCapture::deliver(Readback & readback)
+{
+  QList<Request> requests = readback.requests;
+  readback.requests.clear();
+  readback.pending = false;
+
+  QImage image(readback.width, readback.height, QImage::Format_ARGB32);
+
+  cc_glglue_glBindBuffer(this->glue, GL_PIXEL_PACK_BUFFER, readback.buffer);
+  const uchar * pixels = static_cast<const uchar *>
+    (cc_glglue_glMapBuffer(this->glue, GL_PIXEL_PACK_BUFFER, GL_READ_ONLY));
+  if (pixels) {
+    const int rowsize = readback.width * 4;
+    for (int y = 0; y < readback.height; y++) {
+      memcpy(image.scanLine(readback.height - 1 - y), pixels + y * rowsize, rowsize);
+    }
+    cc_glglue_glUnmapBuffer(this->glue, GL_PIXEL_PACK_BUFFER);
+  }
+  else {
+    image = QImage();
+  }
+  cc_glglue_glBindBuffer(this->glue, GL_PIXEL_PACK_BUFFER, 0);
+
+  FrameCapture::deliver(requests, image);
+}
+
+void
+FrameCapture::deliver(const QList<Request> & requests, const QImage & image)
+{
+  for (int i = 0; i < requests.size(); i++) {
+    requests[i].callback(requests[i].userdata, image);
+  }
+}
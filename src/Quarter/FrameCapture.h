@@ -0,0 +1,101 @@
+#ifndef QUARTER_FRAMECAPTURE_H
+#define QUARTER_FRAMECAPTURE_H
+
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+#include <QtCore/QObject>
+#include <QtCore/QList>
+#include <QImage>
+#include <Inventor/C/glue/gl.h>
+
+class QTimer;
+
+namespace SIM { namespace Coin3D { namespace Quarter {
+
+class QuarterWidget;
+
+class FrameCapture : public QObject {
+  Q_OBJECT
+public:
+  typedef void CaptureCB(void * userdata, const QImage & image);
+
+  FrameCapture(QuarterWidget * quarterwidget);
+  ~FrameCapture();
+
+  void request(CaptureCB * callback, void * userdata);
+  void setContinuous(CaptureCB * callback, void * userdata);
+  bool hasRequests(void) const;
+
+  void frameRendered(void);
+
+  bool hasBuffers(void) const;
+  void cleanup(void);
+
+public slots:
+  void flush(void);
+
+private:
+  enum { NUM_BUFFERS = 3, LATENCY = 2 };
+
+  struct Request {
+    CaptureCB * callback;
+    void * userdata;
+  };
+
+  struct Readback {
+    GLuint buffer;
+    int width;
+    int height;
+    int age;
+    bool pending;
+    QList<Request> requests;
+  };
+
+  void initBuffers(void);
+  void readPixels(int width, int height, void * pixels);
+  void deliver(Readback & readback);
+  static void deliver(const QList<Request> & requests, const QImage & image);
+
+  QuarterWidget * quarterwidget;
+  QList<Request> requests;
+  Request continuous;
+
+  const cc_glglue * glue;
+  bool buffersinitialized;
+  Readback readbacks[NUM_BUFFERS];
+  int current;
+
+  QTimer * timer;
+};
+
+}}} // namespace
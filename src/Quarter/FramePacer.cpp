@@ -0,0 +1,235 @@
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+/*
+  Merges redraw requests from the render manager so that at most one
+  frame is rendered per display refresh interval, and/or caps the
+  frame rate of the widget. Requests above the cap are deferred to
+  the next allowed frame, not dropped.
+ */
+
+#include "FramePacer.h"
+
+#include <QtCore/QEvent>
+#include <QtCore/QTimer>
+#if (QT_VERSION >= 0x050000)
+#  include <QGuiApplication>
+#  include <QScreen>
+#  include <QWindow>
+#endif
+
+#include <Inventor/SbBasic.h>
+
+#include <Quarter/QuarterWidget.h>
+
+using namespace SIM::Coin3D::Quarter;
+
+FramePacer::FramePacer(QuarterWidget * quarterwidget)
+  : QObject(quarterwidget)
+{
+  this->quarterwidget = quarterwidget;
+  this->isenabled = false;
+  this->maxrate = 0.0;
+  this->unfocusedrate = 0.0;
+  this->lastframe = SbTime::zero();
+
+  this->timer = new QTimer(this);
+  this->timer->setSingleShot(true);
+#if (QT_VERSION >= 0x050000)
+  this->timer->setTimerType(Qt::PreciseTimer);
+#endif
+  this->connect(this->timer, SIGNAL(timeout(void)), this, SLOT(timeout()));
+
+  quarterwidget->installEventFilter(this);
+}
+
+FramePacer::~FramePacer()
+{
+}
+
+void
+FramePacer::setEnabled(bool yes)
+{
+  this->isenabled = yes;
+  this->settingsChanged();
+}
+
+bool
+FramePacer::enabled(void) const
+{
+  return this->isenabled;
+}
+
+/*
+  Caps the frame rate while the widget has keyboard focus, or always
+  if no unfocused frame rate is set. 0 means no cap.
+ */
+void
+FramePacer::setMaxFrameRate(double rate)
+{
+  this->maxrate = rate;
+  this->settingsChanged();
+}
+
+double
+FramePacer::maxFrameRate(void) const
+{
+  return this->maxrate;
+}
+
+/*
+  Caps the frame rate while the widget does not have keyboard focus.
+  0 means that the maximum frame rate applies.
+ */
+void
+FramePacer::setUnfocusedFrameRate(double rate)
+{
+  this->unfocusedrate = rate;
+  this->settingsChanged();
+}
+
+double
+FramePacer::unfocusedFrameRate(void) const
+{
+  return this->unfocusedrate;
+}
+
+/*
+  Returns true if redraws should go through scheduleRedraw().
+ */
+bool
+FramePacer::active(void) const
+{
+  return this->isenabled || this->maxrate > 0.0 || this->unfocusedrate > 0.0;
+}
+
+/*
+  Requests a frame. Every request arriving before the pending frame
+  is rendered is merged into that frame.
+ */
+void
+FramePacer::scheduleRedraw(void)
+{
+  if (this->timer->isActive()) {
+    return;
+  }
+
+  SbTime next = this->lastframe + SbTime(this->frameInterval());
+  double delay = (next - SbTime::getTimeOfDay()).getValue();
+  if (delay < 0.0) {
+    delay = 0.0;
+  }
+  this->timer->start(int(delay * 1000.0));
+}
+
+void
+FramePacer::frameRendered(void)
+{
+  this->lastframe = SbTime::getTimeOfDay();
+}
+
+bool
+FramePacer::eventFilter(QObject * obj, QEvent * event)
+{
+  switch (event->type()) {
+  case QEvent::FocusIn:
+  case QEvent::FocusOut:
+    // the pending frame may be due earlier or later now
+    if (this->timer->isActive()) {
+      this->timer->stop();
+      this->scheduleRedraw();
+    }
+    break;
+  default:
+    break;
+  }
+  return false;
+}
+
+void
+FramePacer::timeout(void)
+{
+  this->quarterwidget->redraw();
+}
+
+void
+FramePacer::settingsChanged(void)
+{
+  if (!this->timer->isActive()) return;
+
+  this->timer->stop();
+  if (this->active()) {
+    this->scheduleRedraw();
+  } else {
+    // don't leave a pending frame behind when switching back to
+    // immediate redraws
+    this->quarterwidget->redraw();
+  }
+}
+
+double
+FramePacer::frameInterval(void) const
+{
+  double interval = 0.0;
+  if (this->isenabled) {
+    interval = this->refreshInterval();
+  }
+
+  double rate = this->maxrate;
+  if (this->unfocusedrate > 0.0 && !this->quarterwidget->hasFocus()) {
+    rate = this->unfocusedrate;
+  }
+  if (rate > 0.0) {
+    interval = SbMax(interval, 1.0 / rate);
+  }
+  return interval;
+}
+
+double
+FramePacer::refreshInterval(void) const
+{
+  qreal rate = 60.0;
+#if (QT_VERSION >= 0x050000)
+  QScreen * screen = NULL;
+  QWidget * winwidg = this->quarterwidget->window();
+  if (winwidg && winwidg->windowHandle()) {
+    screen = winwidg->windowHandle()->screen();
+  }
+  if (!screen) {
+    screen = QGuiApplication::primaryScreen();
+  }
+  if (screen && screen->refreshRate() > 0.0) {
+    rate = screen->refreshRate();
+  }
+#endif
+  return 1.0 / rate;
+}
@@ -0,0 +1,84 @@
+#ifndef QUARTER_FRAMEPACER_H
+#define QUARTER_FRAMEPACER_H
+
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+#include <QtCore/QObject>
+#include <Inventor/SbTime.h>
+
+class QTimer;
+
+namespace SIM { namespace Coin3D { namespace Quarter {
+
+class QuarterWidget;
+
+class FramePacer : public QObject {
+  Q_OBJECT
+public:
+  FramePacer(QuarterWidget * quarterwidget);
+  ~FramePacer();
+
+  void setEnabled(bool yes);
+  bool enabled(void) const;
+
+  void setMaxFrameRate(double rate);
+  double maxFrameRate(void) const;
+  void setUnfocusedFrameRate(double rate);
+  double unfocusedFrameRate(void) const;
+
+  bool active(void) const;
+
+  void scheduleRedraw(void);
+  void frameRendered(void);
+
+  virtual bool eventFilter(QObject * obj, QEvent * event);
+
+public slots:
+  void timeout(void);
+
+private:
+  double frameInterval(void) const;
+  double refreshInterval(void) const;
+  void settingsChanged(void);
+
+  QuarterWidget * quarterwidget;
+  QTimer * timer;
+  SbTime lastframe;
+  bool isenabled;
+  double maxrate;
+  double unfocusedrate;
+};
+
+}}} // namespace
+
+#endif // QUARTER_FRAMEPACER_H
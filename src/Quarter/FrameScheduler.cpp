@@ -0,0 +1,118 @@
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+/*
+  Renders all QuarterWidgets that use shared frame scheduling in one
+  go. Redraw requests are collected until control returns to the event
+  loop. The Coin delay queue is then processed once for all of them,
+  and the widgets are redrawn back-to-back, ordered by cache context
+  so that widgets sharing GL objects are rendered after each other.
+ */
+
+#include "FrameScheduler.h"
+#include "SensorProfiler.h"
+
+#include <algorithm>
+
+#include <QtCore/QTimer>
+
+#include <Inventor/SoDB.h>
+#include <Inventor/sensors/SoSensorManager.h>
+
+#include <Quarter/QuarterWidget.h>
+
+using namespace SIM::Coin3D::Quarter;
+
+static bool
+cachecontext_less(const QuarterWidget * a, const QuarterWidget * b)
+{
+  return a->getCacheContextId() < b->getCacheContextId();
+}
+
+FrameScheduler::FrameScheduler(void)
+{
+  this->intick = false;
+  this->timer = new QTimer(this);
+  this->timer->setSingleShot(true);
+  this->connect(this->timer, SIGNAL(timeout(void)), this, SLOT(tick()));
+}
+
+FrameScheduler::~FrameScheduler()
+{
+}
+
+void
+FrameScheduler::scheduleRedraw(QuarterWidget * quarterwidget)
+{
+  if (!this->dirty.contains(quarterwidget)) {
+    this->dirty.append(quarterwidget);
+  }
+  if (!this->timer->isActive()) {
+    this->timer->start(0);
+  }
+}
+
+/*
+  Called when a widget is destroyed or stops using the scheduler.
+ */
+void
+FrameScheduler::unschedule(QuarterWidget * quarterwidget)
+{
+  this->dirty.removeAll(quarterwidget);
+}
+
+void
+FrameScheduler::tick(void)
+{
+  if (this->intick) return;
+  this->intick = true;
+
+  // sensors triggered while processing the queue may schedule more
+  // widgets, which are then rendered in this tick as well
+  if (SoDB::getSensorManager()->isDelaySensorPending()) {
+    SensorProfiler::processDelayQueue(FALSE);
+  }
+
+  QList<QuarterWidget *> widgets = this->dirty;
+  this->dirty.clear();
+  this->timer->stop();
+
+  std::stable_sort(widgets.begin(), widgets.end(), cachecontext_less);
+
+  // redraw() prevents paintGL() from processing the delay queue
+  // again for each widget
+  foreach(QuarterWidget * widget, widgets) {
+    widget->redraw();
+  }
+
+  this->intick = false;
+}
@@ -1,5 +1,5 @@
-#ifndef QUARTER_SIGNALTHREAD_H
-#define QUARTER_SIGNALTHREAD_H
+#ifndef QUARTER_FRAMESCHEDULER_H
+#define QUARTER_FRAMESCHEDULER_H
 
 /**************************************************************************\
  * Copyright (c) Kongsberg Oil & Gas Technologies AS
@@ -33,34 +33,33 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 \**************************************************************************/
 
-#include <QtCore/QThread>
-#include <QtCore/QWaitCondition>
-#include <QtCore/QMutex>
+#include <QtCore/QObject>
+#include <QtCore/QList>
 
-class SoQtP;
+class QTimer;
 
 namespace SIM { namespace Coin3D { namespace Quarter {
 
-class SignalThread : public QThread {
+class QuarterWidget;
+
+class FrameScheduler : public QObject {
   Q_OBJECT
 public:
-  SignalThread(void);
-  virtual ~SignalThread();
-
-  virtual void run(void);
-  void trigger(void);
-  void stopThread(void);
+  FrameScheduler(void);
+  ~FrameScheduler();
 
-signals:
+  void scheduleRedraw(QuarterWidget * quarterwidget);
+  void unschedule(QuarterWidget * quarterwidget);
 
-  void triggerSignal(void);
+public slots:
+  void tick(void);
 
 private:
-  QWaitCondition waitcond;
-  QMutex mutex;
-  bool isstopped;
+  QList<QuarterWidget *> dirty;
+  QTimer * timer;
+  bool intick;
 };
 
 }}} // namespace
 
-#endif // QUARTER_SIGNALTHREAD_H
+#endif // QUARTER_FRAMESCHEDULER_H
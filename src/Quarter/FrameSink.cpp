@@ -0,0 +1,255 @@
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+/*!
+  \class SIM::Coin3D::Quarter::FrameSink FrameSink.h Quarter/FrameSink.h
+
+  \brief The FrameSink class is the interface for consumers of frames
+  recorded with QuarterWidget::startRecording().
+
+  All functions are called from the recorder's encoder thread, never
+  from the GUI thread. open() is called with the frame size when the
+  first frame arrives, writeFrame() for every recorded frame, and
+  close() when the recording stops. Frames have the format
+  QImage::Format_ARGB32, and \a timestamp is the time in seconds since
+  recording started.
+
+  \sa ImageSequenceSink, ProcessSink
+*/
+
+/*!
+  \class SIM::Coin3D::Quarter::ImageSequenceSink FrameSink.h Quarter/FrameSink.h
+
+  \brief The ImageSequenceSink class writes recorded frames as
+  numbered image files.
+
+  \code
+  ImageSequenceSink sink("/tmp/session/frame%1.png");
+  viewer->startRecording(&sink);
+  \endcode
+*/
+
+/*!
+  \class SIM::Coin3D::Quarter::ProcessSink FrameSink.h Quarter/FrameSink.h
+
+  \brief The ProcessSink class pipes recorded frames to an external
+  encoder.
+
+  The frames are written to the standard input of the process as raw
+  8-bit RGBA pixels, top row first. Occurrences of \c %w and \c %h in
+  the arguments are replaced by the frame width and height when the
+  process is started. For instance, to encode with ffmpeg:
+
+  \code
+  QStringList args;
+  args << "-f" << "rawvideo" << "-pix_fmt" << "rgba" << "-s" << "%wx%h"
+       << "-r" << "30" << "-i" << "-" << "-y" << "session.mp4";
+  ProcessSink sink("ffmpeg", args);
+  viewer->startRecording(&sink);
+  \endcode
+*/
+
+#include <Quarter/FrameSink.h>
+
+#include <QtCore/QProcess>
+
+using namespace SIM::Coin3D::Quarter;
+
+/*!
+  Constructor.
+*/
+FrameSink::FrameSink(void)
+{
+}
+
+/*!
+  Destructor.
+*/
+FrameSink::~FrameSink()
+{
+}
+
+/*!
+  \fn bool FrameSink::open(const QSize & size)
+
+  Prepares the sink for frames of \a size. Returning false stops the
+  recording.
+*/
+
+/*!
+  \fn bool FrameSink::writeFrame(const QImage & image, double timestamp)
+
+  Consumes one frame. Returning false stops the recording.
+*/
+
+/*!
+  \fn void FrameSink::close(void)
+
+  Called once after the last frame.
+*/
+
+/*!
+  Constructor. \a pattern is the file name with a \c %1, which is
+  replaced by the zero padded frame number. The image format is
+  deduced from the suffix if \a format is NULL.
+*/
+ImageSequenceSink::ImageSequenceSink(const QString & pattern, const char * format)
+  : pattern(pattern), format(format), framenumber(0)
+{
+}
+
+/*!
+  Destructor.
+*/
+ImageSequenceSink::~ImageSequenceSink()
+{
+}
+
+/*!
+  Restarts the frame numbering.
+*/
+bool
+ImageSequenceSink::open(const QSize & size)
+{
+  Q_UNUSED(size);
+  this->framenumber = 0;
+  return true;
+}
+
+/*!
+  Saves \a image to the next file of the sequence.
+*/
+bool
+ImageSequenceSink::writeFrame(const QImage & image, double timestamp)
+{
+  Q_UNUSED(timestamp);
+  const QString filename = this->pattern.arg(this->framenumber++, 6, 10, QChar('0'));
+  return image.save(filename, this->format.isEmpty() ? NULL : this->format.constData());
+}
+
+/*!
+  Does nothing.
+*/
+void
+ImageSequenceSink::close(void)
+{
+}
+
+/*!
+  Constructor. The process is started with \a program and
+  \a arguments when the first frame arrives.
+*/
+ProcessSink::ProcessSink(const QString & program, const QStringList & arguments)
+  : program(program), arguments(arguments), process(NULL)
+{
+}
+
+/*!
+  Destructor.
+*/
+ProcessSink::~ProcessSink()
+{
+  this->close();
+}
+
+/*!
+  Starts the encoder process.
+*/
+bool
+ProcessSink::open(const QSize & size)
+{
+  this->close();
+
+  QStringList args;
+  for (int i = 0; i < this->arguments.size(); i++) {
+    QString arg = this->arguments[i];
+    arg.replace("%w", QString::number(size.width()));
+    arg.replace("%h", QString::number(size.height()));
+    args << arg;
+  }
+
+  // created in the encoder thread, which is the only one using it
+  this->process = new QProcess;
+  this->process->setProcessChannelMode(QProcess::ForwardedChannels);
+  this->process->start(this->program, args);
+  if (!this->process->waitForStarted()) {
+    delete this->process;
+    this->process = NULL;
+    return false;
+  }
+  return true;
+}
+
+/*!
+  Writes the pixels of \a image to the standard input of the process.
+*/
+bool
+ProcessSink::writeFrame(const QImage & image, double timestamp)
+{
+  Q_UNUSED(timestamp);
+  if (!this->process) return false;
+
+  const int width = image.width();
+  const int height = image.height();
+  this->buffer.resize(width * height * 4);
+  uchar * dst = reinterpret_cast<uchar *>(this->buffer.data());
+  for (int y = 0; y < height; y++) {
+    const QRgb * src = reinterpret_cast<const QRgb *>(image.constScanLine(y));
+    for (int x = 0; x < width; x++) {
+      *dst++ = qRed(src[x]);
+      *dst++ = qGreen(src[x]);
+      *dst++ = qBlue(src[x]);
+      *dst++ = qAlpha(src[x]);
+    }
+  }
+
+  if (this->process->write(this->buffer) != this->buffer.size()) return false;
+  // keeps the amount of buffered data bounded
+  while (this->process->bytesToWrite() > 0) {
+    if (!this->process->waitForBytesWritten(-1)) return false;
+  }
+  return true;
+}
+
+/*!
+  Closes the standard input of the process and waits for it to
+  finish.
+*/
+void
+ProcessSink::close(void)
+{
+  if (!this->process) return;
+  this->process->closeWriteChannel();
+  this->process->waitForFinished(-1);
+  delete this->process;
+  this->process = NULL;
+}
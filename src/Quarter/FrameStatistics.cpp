@@ -0,0 +1,117 @@
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+#include <Quarter/FrameStatistics.h>
+
+using namespace SIM::Coin3D::Quarter;
+
+/*!
+  \class SIM::Coin3D::Quarter::FrameStatistics FrameStatistics.h Quarter/FrameStatistics.h
+
+  \brief The FrameStatistics class holds a summary of the frame timings
+  collected by a QuarterWidget over its most recent frames.
+
+  All times are given in seconds.
+
+  \sa QuarterWidget::frameStatistics()
+*/
+
+/*!
+  \enum SIM::Coin3D::Quarter::FrameStatistics::Timing
+
+  The parts of a frame that are measured.
+
+  \li \b DELAY_QUEUE time spent processing the delay queue in paintGL()
+  \li \b RENDER CPU time spent in SoRenderManager::render()
+  \li \b GPU GPU time spent executing the render traversal
+  \li \b SWAP time from the end of paintGL() until the frame is swapped
+  \li \b FRAME total time from the start of paintGL() until the swap
+  \li \b INPUT_LATENCY time from when an input event reached the
+  widget's EventFilter until the first frame rendered after the scene
+  changed in response had been swapped and completed on the GPU
+*/
+
+FrameStatistics::FrameStatistics(void)
+{
+  for (int i = 0; i < NUM_TIMINGS; i++) {
+    this->numframes[i] = 0;
+    this->lastvalue[i] = 0.0;
+    this->minvalue[i] = 0.0;
+    this->avgvalue[i] = 0.0;
+    this->p99value[i] = 0.0;
+  }
+}
+
+/*!
+  Returns the number of frames the summary for \a timing is based on.
+*/
+int
+FrameStatistics::numFrames(Timing timing) const
+{
+  return this->numframes[timing];
+}
+
+/*!
+  Returns the value measured for the most recent frame.
+*/
+double
+FrameStatistics::last(Timing timing) const
+{
+  return this->lastvalue[timing];
+}
+
+/*!
+  Returns the smallest value within the window.
+*/
+double
+FrameStatistics::minimum(Timing timing) const
+{
+  return this->minvalue[timing];
+}
+
+/*!
+  Returns the mean value within the window.
+*/
+double
+FrameStatistics::average(Timing timing) const
+{
+  return this->avgvalue[timing];
+}
+
+/*!
+  Returns the 99th percentile of the values within the window.
+*/
+double
+FrameStatistics::percentile99(Timing timing) const
+{
+  return this->p99value[timing];
+}
@@ -0,0 +1,612 @@
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+/*
+  Collects per-frame timings for QuarterWidget. CPU timings are taken
+  with SbTime, GPU timings with GL_TIME_ELAPSED queries which are read
+  back a couple of frames later to avoid stalling the pipeline.
+
+  Input latency is measured from the time EventFilter received the
+  oldest input event that changed the scene, to when the frame
+  rendered after the change has been swapped and a fence inserted
+  after it has been signaled. The fence is polled without blocking,
+  at the swap and then every millisecond until it has been signaled,
+  and the latency ends when it is first seen signaled.
+ */
+
+#include "FrameTimer.h"
+
+#include <algorithm>
+#include <math.h>
+
+#if (QT_VERSION >= 0x050600)
+#  include <QOpenGLContext>
+#  include <QOpenGLExtraFunctions>
+#endif
+
+#include <QtCore/QTimer>
+
+#include <Inventor/SbBasic.h>
+
+#include <Quarter/QuarterWidget.h>
+
+#ifndef GL_TIME_ELAPSED
+#define GL_TIME_ELAPSED 0x88BF
+#endif
+#ifndef GL_QUERY_RESULT
+#define GL_QUERY_RESULT 0x8866
+#endif
+#ifndef GL_QUERY_RESULT_AVAILABLE
+#define GL_QUERY_RESULT_AVAILABLE 0x8867
+#endif
+#ifndef GL_SYNC_GPU_COMMANDS_COMPLETE
+#define GL_SYNC_GPU_COMMANDS_COMPLETE 0x9117
+#endif
+#ifndef GL_ALREADY_SIGNALED
+#define GL_ALREADY_SIGNALED 0x911A
+#endif
+#ifndef GL_CONDITION_SATISFIED
+#define GL_CONDITION_SATISFIED 0x911C
+#endif
+
+using namespace SIM::Coin3D::Quarter;
+
+FrameTimer::FrameTimer(QuarterWidget * quarterwidget)
+  : QObject(quarterwidget)
+{
+  this->quarterwidget = quarterwidget;
+  this->isenabled = false;
+  this->framebudget = 0.0;
+  this->inframe = false;
+  this->framecount = 0;
+  this->glue = NULL;
+  this->queriesinitialized = false;
+  this->currentquery = 0;
+  this->queryselected = false;
+  this->queryactive = false;
+  this->pendinginput = SbTime::zero();
+  this->scheduledinput = SbTime::zero();
+  this->frameinput = SbTime::zero();
+  this->syncsupport = -1;
+
+  this->polltimer = new QTimer(this);
+  this->polltimer->setInterval(1);
+#if (QT_VERSION >= 0x050000)
+  this->polltimer->setTimerType(Qt::PreciseTimer);
+#endif
+  this->connect(this->polltimer, SIGNAL(timeout()), this, SLOT(pollLatencies()));
+
+  for (int i = 0; i < NUM_TIMINGS; i++) {
+    this->next[i] = 0;
+  }
+  for (int i = 0; i < NUM_QUERY_FRAMES; i++) {
+    this->queryframes[i].numpasses = 0;
+    this->queryframes[i].pending = false;
+  }
+
+#if (QT_VERSION >= 0x060000)
+  this->connect(quarterwidget, SIGNAL(frameSwapped()), this, SLOT(frameSwapped()));
+#endif
+}
+
+FrameTimer::~FrameTimer()
+{
+}
+
+void
+FrameTimer::setEnabled(bool yes)
+{
+  this->isenabled = yes;
+  if (!yes) {
+    for (int i = 0; i < NUM_TIMINGS; i++) {
+      this->samples[i].clear();
+      this->next[i] = 0;
+    }
+    this->inframe = false;
+    this->pendinginput = SbTime::zero();
+    this->scheduledinput = SbTime::zero();
+    this->frameinput = SbTime::zero();
+    this->clearLatencies();
+  }
+}
+
+bool
+FrameTimer::enabled(void) const
+{
+  return this->isenabled;
+}
+
+void
+FrameTimer::setBudget(double sec)
+{
+  this->framebudget = sec;
+}
+
+double
+FrameTimer::budget(void) const
+{
+  return this->framebudget;
+}
+
+void
+FrameTimer::beginFrame(void)
+{
+  if (!this->isenabled) return;
+  this->framestart = SbTime::getTimeOfDay();
+  this->inframe = true;
+  this->queryselected = false;
+}
+
+void
+FrameTimer::beginDelayQueue(void)
+{
+  if (!this->isenabled) return;
+  this->stagestart = SbTime::getTimeOfDay();
+}
+
+void
+FrameTimer::endDelayQueue(void)
+{
+  if (!this->isenabled) return;
+  this->addSample(FrameStatistics::DELAY_QUEUE,
+                  (SbTime::getTimeOfDay() - this->stagestart).getValue());
+}
+
+/*
+  Called after the delay queue has been processed, so that the frame
+  is attributed the inputs whose changes were only noticed there.
+ */
+void
+FrameTimer::beginRender(void)
+{
+  if (!this->isenabled) return;
+  this->stagestart = SbTime::getTimeOfDay();
+  this->frameinput = this->scheduledinput;
+  this->scheduledinput = SbTime::zero();
+  this->collectLatencies(this->stagestart);
+}
+
+void
+FrameTimer::endRender(void)
+{
+  if (!this->isenabled) return;
+  this->addSample(FrameStatistics::RENDER,
+                  (SbTime::getTimeOfDay() - this->stagestart).getValue());
+}
+
+/*
+  Called from the pre render callback, i.e. with the GL context
+  current. A stereo frame renders the scene once per eye, so there
+  may be more than one pass per frame.
+ */
+void
+FrameTimer::beginGPU(void)
+{
+  if (!this->isenabled || !this->inframe || this->queryactive) return;
+
+  if (!this->queriesinitialized) {
+    this->initQueries();
+  }
+  if (!this->glue) return;
+
+  if (!this->queryselected) {
+    this->collectQueries();
+    this->currentquery = (this->currentquery + 1) % NUM_QUERY_FRAMES;
+    // still not available after NUM_QUERY_FRAMES frames; drop it
+    // rather than block on the result
+    this->queryframes[this->currentquery].pending = false;
+    this->queryframes[this->currentquery].numpasses = 0;
+    this->queryselected = true;
+  }
+
+  QueryFrame & frame = this->queryframes[this->currentquery];
+  if (frame.numpasses < MAX_PASSES) {
+    cc_glglue_glBeginQuery(this->glue, GL_TIME_ELAPSED, frame.ids[frame.numpasses]);
+    this->queryactive = true;
+  }
+}
+
+void
+FrameTimer::endGPU(void)
+{
+  if (!this->queryactive) return;
+
+  QueryFrame & frame = this->queryframes[this->currentquery];
+  cc_glglue_glEndQuery(this->glue, GL_TIME_ELAPSED);
+  frame.numpasses++;
+  frame.pending = true;
+  this->queryactive = false;
+}
+
+void
+FrameTimer::endPaint(void)
+{
+  if (!this->isenabled || !this->inframe) return;
+  this->paintend = SbTime::getTimeOfDay();
+  if (this->frameinput == SbTime::zero()) return;
+
+  LatencyFrame frame;
+  frame.input = this->frameinput;
+  frame.swapped = SbTime::zero();
+  frame.fence = NULL;
+  frame.signaled = SbTime::zero();
+  this->frameinput = SbTime::zero();
+
+#if (QT_VERSION >= 0x050600)
+  QOpenGLContext * context = QOpenGLContext::currentContext();
+  if (this->syncsupport < 0 && context) {
+    const QSurfaceFormat format = context->format();
+    this->syncsupport =
+      (format.version() >= qMakePair(3, 2) || context->hasExtension("GL_ARB_sync")) ? 1 : 0;
+  }
+  if (this->syncsupport == 1 && context) {
+    frame.fence = context->extraFunctions()->glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+  }
+#endif
+
+  // frames which are never swapped, e.g. while the widget is hidden
+  if (this->latencyframes.size() >= MAX_LATENCY_FRAMES) {
+    this->clearLatencies();
+  }
+  this->latencyframes.append(frame);
+}
+
+/*
+  Called from QuarterWidget::processSoEvent() for events the scene
+  graph or the navigation handled, with the time the event was
+  received.
+ */
+void
+FrameTimer::inputProcessed(const SbTime & received)
+{
+  if (!this->isenabled) return;
+  if (this->pendinginput == SbTime::zero() || received < this->pendinginput) {
+    this->pendinginput = received;
+  }
+}
+
+/*
+  Called from QuarterWidgetP::rendercb(). The next frame reflects the
+  inputs processed so far.
+ */
+void
+FrameTimer::redrawScheduled(void)
+{
+  if (this->pendinginput == SbTime::zero()) return;
+  if (this->scheduledinput == SbTime::zero() || this->pendinginput < this->scheduledinput) {
+    this->scheduledinput = this->pendinginput;
+  }
+  this->pendinginput = SbTime::zero();
+}
+
+/*
+  Called once the frame has been handed over to the window system.
+ */
+void
+FrameTimer::frameSwapped(void)
+{
+  if (!this->isenabled || !this->inframe) return;
+  this->inframe = false;
+
+  SbTime now = SbTime::getTimeOfDay();
+  this->addSample(FrameStatistics::SWAP, (now - this->paintend).getValue());
+
+  double frametime = (now - this->framestart).getValue();
+  this->addSample(FrameStatistics::FRAME, frametime);
+  this->framecount++;
+
+  for (int i = 0; i < this->latencyframes.size(); i++) {
+    if (this->latencyframes[i].swapped == SbTime::zero()) {
+      this->latencyframes[i].swapped = now;
+    }
+  }
+  this->collectLatencies(now);
+
+  if (this->framebudget > 0.0 && frametime > this->framebudget) {
+    emit frameBudgetExceeded(frametime);
+  }
+}
+
+FrameStatistics
+FrameTimer::statistics(void) const
+{
+  FrameStatistics stats;
+  for (int i = 0; i < NUM_TIMINGS; i++) {
+    const QVector<double> & values = this->samples[i];
+    const int n = values.size();
+    if (n == 0) continue;
+
+    QVector<double> sorted = values;
+    std::sort(sorted.begin(), sorted.end());
+
+    double sum = 0.0;
+    for (int j = 0; j < n; j++) {
+      sum += sorted[j];
+    }
+
+    int p99 = int(ceil(0.99 * n)) - 1;
+    stats.numframes[i] = n;
+    stats.lastvalue[i] = values[(this->next[i] + n - 1) % n];
+    stats.minvalue[i] = sorted[0];
+    stats.avgvalue[i] = sum / n;
+    stats.p99value[i] = sorted[SbClamp(p99, 0, n - 1)];
+  }
+  return stats;
+}
+
+/*
+  Returns the recorded samples for \a timing, oldest first.
+ */
+QVector<double>
+FrameTimer::history(FrameStatistics::Timing timing) const
+{
+  const QVector<double> & values = this->samples[timing];
+  const int n = values.size();
+  QVector<double> ret(n);
+  for (int i = 0; i < n; i++) {
+    ret[i] = values[(this->next[timing] + i) % n];
+  }
+  return ret;
+}
+
+/*
+  Sorts the recorded samples for \a timing into \a numbins bins of
+  \a binwidth seconds each. The last bin also counts all longer
+  samples.
+ */
+QVector<int>
+FrameTimer::histogram(FrameStatistics::Timing timing, double binwidth, int numbins) const
+{
+  QVector<int> bins(SbMax(numbins, 0), 0);
+  if (numbins <= 0 || binwidth <= 0.0) return bins;
+
+  const QVector<double> & values = this->samples[timing];
+  for (int i = 0; i < values.size(); i++) {
+    bins[SbClamp(int(values[i] / binwidth), 0, numbins - 1)]++;
+  }
+  return bins;
+}
+
+/*
+  Returns the number of frames timed since timing was enabled.
+ */
+unsigned long
+FrameTimer::frameCount(void) const
+{
+  return this->framecount;
+}
+
+bool
+FrameTimer::hasQueries(void) const
+{
+  return this->glue != NULL || !this->latencyframes.isEmpty();
+}
+
+/*
+  Releases the GL query objects. Must be called with the widget's GL
+  context current.
+ */
+void
+FrameTimer::cleanup(void)
+{
+  if (this->glue) {
+    for (int i = 0; i < NUM_QUERY_FRAMES; i++) {
+      cc_glglue_glDeleteQueries(this->glue, MAX_PASSES, this->queryframes[i].ids);
+    }
+    this->glue = NULL;
+  }
+  this->queriesinitialized = false;
+  this->clearLatencies();
+  this->syncsupport = -1;
+}
+
+void
+FrameTimer::addSample(FrameStatistics::Timing timing, double value)
+{
+  QVector<double> & values = this->samples[timing];
+  if (values.size() < WINDOW_SIZE) {
+    values.append(value);
+    this->next[timing] = values.size() % WINDOW_SIZE;
+  }
+  else {
+    values[this->next[timing]] = value;
+    this->next[timing] = (this->next[timing] + 1) % WINDOW_SIZE;
+  }
+}
+
+void
+FrameTimer::initQueries(void)
+{
+  this->queriesinitialized = true;
+
+  const cc_glglue * glue = cc_glglue_instance(this->quarterwidget->getCacheContextId());
+  if (!cc_glglue_has_occlusion_query(glue) ||
+      !(cc_glglue_glext_supported(glue, "GL_ARB_timer_query") ||
+        cc_glglue_glext_supported(glue, "GL_EXT_timer_query"))) {
+    return;
+  }
+
+  this->glue = glue;
+  for (int i = 0; i < NUM_QUERY_FRAMES; i++) {
+    cc_glglue_glGenQueries(this->glue, MAX_PASSES, this->queryframes[i].ids);
+  }
+}
+
+void
+FrameTimer::collectQueries(void)
+{
+  for (int i = 0; i < NUM_QUERY_FRAMES; i++) {
+    QueryFrame & frame = this->queryframes[i];
+    if (!frame.pending) continue;
+
+    GLuint available = 0;
+    cc_glglue_glGetQueryObjectuiv(this->glue, frame.ids[frame.numpasses - 1],
+                                  GL_QUERY_RESULT_AVAILABLE, &available);
+    if (!available) continue;
+
+    double gputime = 0.0;
+    for (int j = 0; j < frame.numpasses; j++) {
+      GLuint nsec = 0;
+      cc_glglue_glGetQueryObjectuiv(this->glue, frame.ids[j], GL_QUERY_RESULT, &nsec);
+      gputime += double(nsec) * 1.0e-9;
+    }
+    frame.pending = false;
+    this->addSample(FrameStatistics::GPU, gputime);
+  }
+}
+
+/*
+  Returns true if the fences of the widget's GL context can be
+  polled, i.e. if it or a context sharing with it is current. With
+  QOpenGLWidget, the frame is swapped by the top-level window's
+  context.
+ */
+bool
+FrameTimer::contextCurrent(void) const
+{
+#if (QT_VERSION >= 0x050600)
+  QOpenGLContext * current = QOpenGLContext::currentContext();
+#if (QT_VERSION >= 0x060000)
+  QOpenGLContext * context = this->quarterwidget->context();
+#else
+  const QGLContext * glcontext = this->quarterwidget->context();
+  QOpenGLContext * context = glcontext ? glcontext->contextHandle() : NULL;
+#endif
+  return current && context &&
+    (current == context || QOpenGLContext::areSharing(current, context));
+#else
+  return false;
+#endif
+}
+
+/*
+  Notes the time at which the fences of the swapped frames are first
+  seen signaled. Must be called with the context current.
+ */
+void
+FrameTimer::pollFences(const SbTime & now)
+{
+#if (QT_VERSION >= 0x050600)
+  QOpenGLExtraFunctions * gl = QOpenGLContext::currentContext()->extraFunctions();
+  for (int i = 0; i < this->latencyframes.size(); i++) {
+    LatencyFrame & frame = this->latencyframes[i];
+    if (frame.swapped == SbTime::zero() || !frame.fence) continue;
+    GLsync sync = static_cast<GLsync>(frame.fence);
+    const GLenum status = gl->glClientWaitSync(sync, 0, 0);
+    if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) continue;
+    gl->glDeleteSync(sync);
+    frame.fence = NULL;
+    frame.signaled = now;
+  }
+#else
+  Q_UNUSED(now);
+#endif
+}
+
+/*
+  Records the latency of the swapped frames whose fences have been
+  signaled, oldest first, and keeps polling the remaining fences
+  between frames.
+ */
+void
+FrameTimer::collectLatencies(const SbTime & now)
+{
+  if (this->contextCurrent()) {
+    this->pollFences(now);
+  }
+  while (!this->latencyframes.isEmpty()) {
+    const LatencyFrame & frame = this->latencyframes.first();
+    if (frame.swapped == SbTime::zero() || frame.fence) break;
+
+    const SbTime done = (frame.signaled != SbTime::zero()) ? frame.signaled : frame.swapped;
+    this->addSample(FrameStatistics::INPUT_LATENCY, (done - frame.input).getValue());
+    this->latencyframes.removeFirst();
+  }
+
+  bool waiting = false;
+  for (int i = 0; i < this->latencyframes.size() && !waiting; i++) {
+    waiting = this->latencyframes[i].swapped != SbTime::zero() && this->latencyframes[i].fence;
+  }
+  if (waiting) {
+    if (!this->polltimer->isActive()) this->polltimer->start();
+  }
+  else {
+    this->polltimer->stop();
+  }
+}
+
+/*
+  Polls the fences of swapped frames between frames, so that an idle
+  widget does not add the time until its next frame to the latency.
+  With QOpenGLWidget the context is not current outside of painting,
+  so it is made current for the poll.
+ */
+void
+FrameTimer::pollLatencies(void)
+{
+  bool madecurrent = false;
+  if (this->isenabled && !this->contextCurrent()) {
+    this->quarterwidget->makeCurrent();
+    madecurrent = true;
+  }
+  if (!this->isenabled || !this->contextCurrent()) {
+    this->polltimer->stop();
+  }
+  else {
+    this->collectLatencies(SbTime::getTimeOfDay());
+  }
+  if (madecurrent) {
+    this->quarterwidget->doneCurrent();
+  }
+}
+
+/*
+  Forgets the frames waiting for their latency. The fences can only
+  be deleted with the context current; otherwise they go away with
+  the context.
+ */
+void
+FrameTimer::clearLatencies(void)
+{
+#if (QT_VERSION >= 0x050600)
+  if (this->contextCurrent()) {
+    QOpenGLExtraFunctions * gl = QOpenGLContext::currentContext()->extraFunctions();
+    for (int i = 0; i < this->latencyframes.size(); i++) {
+      if (this->latencyframes[i].fence) {
+        gl->glDeleteSync(static_cast<GLsync>(this->latencyframes[i].fence));
+      }
+    }
+  }
+#endif
+  this->latencyframes.clear();
+  this->polltimer->stop();
+}
@@ -0,0 +1,150 @@
+#ifndef QUARTER_FRAMETIMER_H
+#define QUARTER_FRAMETIMER_H
+
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+#include <QtCore/QList>
+#include <QtCore/QObject>
+#include <QtCore/QVector>
+#include <Inventor/SbTime.h>
+#include <Inventor/C/glue/gl.h>
+#include <Quarter/FrameStatistics.h>
+
+class QTimer;
+
+namespace SIM { namespace Coin3D { namespace Quarter {
+
+class QuarterWidget;
+
+class FrameTimer : public QObject {
+  Q_OBJECT
+public:
+  FrameTimer(QuarterWidget * quarterwidget);
+  ~FrameTimer();
+
+  void setEnabled(bool yes);
+  bool enabled(void) const;
+
+  void setBudget(double sec);
+  double budget(void) const;
+
+  void beginFrame(void);
+  void beginDelayQueue(void);
+  void endDelayQueue(void);
+  void beginRender(void);
+  void endRender(void);
+  void beginGPU(void);
+  void endGPU(void);
+  void endPaint(void);
+
+  void inputProcessed(const SbTime & received);
+  void redrawScheduled(void);
+
+  FrameStatistics statistics(void) const;
+  QVector<double> history(FrameStatistics::Timing timing) const;
+  QVector<int> histogram(FrameStatistics::Timing timing, double binwidth, int numbins) const;
+  unsigned long frameCount(void) const;
+  bool hasQueries(void) const;
+  void cleanup(void);
+
+public slots:
+  void frameSwapped(void);
+
+private slots:
+  void pollLatencies(void);
+
+signals:
+  void frameBudgetExceeded(double frametime);
+
+private:
+  enum {
+    WINDOW_SIZE = 120, NUM_QUERY_FRAMES = 3, MAX_PASSES = 2,
+    MAX_LATENCY_FRAMES = 8,
+    NUM_TIMINGS = FrameStatistics::INPUT_LATENCY + 1
+  };
+
+  struct QueryFrame {
+    GLuint ids[MAX_PASSES];
+    int numpasses;
+    bool pending;
+  };
+
+  struct LatencyFrame {
+    SbTime input;
+    SbTime swapped;
+    // a GLsync until it has been signaled, or NULL without sync
+    // object support
+    void * fence;
+    // when the fence was first seen signaled
+    SbTime signaled;
+  };
+
+  void addSample(FrameStatistics::Timing timing, double value);
+  void initQueries(void);
+  void collectQueries(void);
+  bool contextCurrent(void) const;
+  void pollFences(const SbTime & now);
+  void collectLatencies(const SbTime & now);
+  void clearLatencies(void);
+
+  QuarterWidget * quarterwidget;
+  bool isenabled;
+  double framebudget;
+
+  QVector<double> samples[NUM_TIMINGS];
+  int next[NUM_TIMINGS];
+
+  SbTime framestart;
+  SbTime stagestart;
+  SbTime paintend;
+  bool inframe;
+  unsigned long framecount;
+
+  const cc_glglue * glue;
+  bool queriesinitialized;
+  QueryFrame queryframes[NUM_QUERY_FRAMES];
+  int currentquery;
+  bool queryselected;
+  bool queryactive;
+
+  SbTime pendinginput;
+  SbTime scheduledinput;
+  SbTime frameinput;
+  QList<LatencyFrame> latencyframes;
+  int syncsupport;
+  QTimer * polltimer;
+};
+
+}}} // namespace
+
+#endif // QUARTER_FRAMETIMER_H
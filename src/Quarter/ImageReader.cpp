@@ -30,47 +30,480 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 \**************************************************************************/
 
+/*
+  Decodes images for Coin through Qt's image plugins. Decoded images
+  are kept in an LRU cache keyed on path, modification time and file
+  size, so a texture file referenced from many nodes is only decoded
+  once. Images can also be decoded ahead of time on a thread pool with
+  prefetch(). A reader asking for an image that is still being decoded
+  waits for that decode instead of starting another one.
+
+  Images larger than the configured maximum dimension or memory
+  budget are decoded at reduced size through QImageReader's scaled
+  size option, which lets decoders like the JPEG one subsample while
+  decoding instead of producing the full resolution image first.
+
+  In progressive mode, a reader asking for a large image that is not
+  cached gets a preview decoded at a small scaled size right away,
+  and the full image is decoded on the thread pool. When it is ready,
+  the SoTexture2 nodes in the scenes of the QuarterWidgets and
+  QuarterWindows referring to the file have their filename field
+  touched, which makes them read the image again, this time from the
+  cache, and redraws the views.
+ */
+
 #include "ImageReader.h"
+#include "Trace.h"
 #include <Inventor/SbImage.h>
+#include <Inventor/SoPath.h>
+#include <Inventor/actions/SoSearchAction.h>
 #include <Inventor/errors/SoDebugError.h>
+#include <Inventor/lists/SoPathList.h>
+#include <Inventor/nodes/SoNode.h>
+#include <Inventor/nodes/SoTexture2.h>
+#include <Inventor/SoRenderManager.h>
+#include <QApplication>
 #include <QImage>
+#include <QImageReader>
+#include <QWidget>
+#if QT_VERSION >= 0x050000
+#include <QWindow>
+#endif
+#include <QtCore/QCoreApplication>
+#include <QtCore/QDateTime>
+#include <QtCore/QDir>
+#include <QtCore/QEvent>
+#include <QtCore/QFileInfo>
+#include <QtCore/QObject>
+#include <QtCore/QRunnable>
+#include <QtCore/QThreadPool>
+
+#include <math.h>
 
 #include <Quarter/QtCoinCompatibility.h>
+#include <Quarter/QuarterWidget.h>
+#if QT_VERSION >= 0x050000
+#include <Quarter/QuarterWindow.h>
+#endif
 
 using namespace SIM::Coin3D::Quarter;
 
+// default memory cap of the decoded image cache
+static const size_t DEFAULT_CACHE_SIZE = 256 * 1024 * 1024;
+// suffix of the cache keys of preview images
+static const char PREVIEW_SUFFIX[] = "|preview";
+
+namespace {
+
+class PrefetchTask : public QRunnable {
+public:
+  PrefetchTask(ImageReader * reader, const QString & filename, const QString & key,
+               bool upgrade = false)
+    : reader(reader), filename(filename), key(key), upgrade(upgrade)
+  {
+    this->maxdimension = reader->maxDimension();
+    this->maxmemory = reader->maxImageMemory();
+  }
+
+  virtual void run(void)
+  {
+    ImageReader::Entry * entry =
+      ImageReader::decode(this->filename, this->maxdimension, this->maxmemory);
+    if (entry) {
+      this->reader->insert(this->key, entry);
+    }
+    this->reader->finished(this->key);
+    if (entry && this->upgrade) {
+      this->reader->upgradeReady(this->filename, this->key);
+    }
+  }
+
+private:
+  ImageReader * reader;
+  QString filename;
+  QString key;
+  bool upgrade;
+  int maxdimension;
+  size_t maxmemory;
+};
+
+// receives the posted events telling that full images are ready, in
+// the GUI thread
+class UpgradeNotifier : public QObject {
+public:
+  UpgradeNotifier(ImageReader * reader) : reader(reader) { }
+
+  virtual bool event(QEvent * event)
+  {
+    if (event->type() == QEvent::User) {
+      this->reader->upgradeTextures();
+      return true;
+    }
+    return QObject::event(event);
+  }
+
+private:
+  ImageReader * reader;
+};
+
+/*
+  Returns true if the texture filename \a texturefile refers to the
+  resolved path \a resolved. Relative texture filenames are resolved
+  by Coin against its search directories, so they match any path
+  ending with them.
+ */
+bool
+same_file(const QString & texturefile, const QString & resolved)
+{
+  if (texturefile.isEmpty()) return false;
+  const QString path = QFileInfo(resolved).absoluteFilePath();
+  QFileInfo info(texturefile);
+  if (info.isAbsolute()) {
+    return info.absoluteFilePath() == path;
+  }
+  return path.endsWith(QLatin1Char('/') + QDir::cleanPath(QDir::fromNativeSeparators(texturefile)));
+}
+
+} // namespace
+
 ImageReader::ImageReader(void)
 {
+  this->pool = new QThreadPool;
+  this->maxdimension = 0;
+  this->maxmemory = 0;
+  this->isprogressive = false;
+  this->previewdimension = 0;
+  this->notifier = new UpgradeNotifier(this);
+  if (QCoreApplication::instance()) {
+    this->notifier->moveToThread(QCoreApplication::instance()->thread());
+  }
+  this->setCacheSize(DEFAULT_CACHE_SIZE);
   SbImage::addReadImageCB(ImageReader::readImageCB, this);
 }
 
 ImageReader::~ImageReader(void)
 {
   SbImage::removeReadImageCB(ImageReader::readImageCB, this);
+  this->pool->waitForDone();
+  delete this->pool;
+  delete this->notifier;
 }
 
-SbBool
-ImageReader::readImage(const SbString & filename, SbImage & sbimage) const
+/*
+  Sets the memory cap of the decoded image cache. Zero disables
+  caching.
+ */
+void
+ImageReader::setCacheSize(size_t bytes)
+{
+  QMutexLocker locker(&this->mutex);
+  this->cache.setMaxCost(int(bytes / 1024));
+}
+
+size_t
+ImageReader::cacheSize(void) const
+{
+  QMutexLocker locker(&this->mutex);
+  return size_t(this->cache.maxCost()) * 1024;
+}
+
+/*
+  Limits the width and height of decoded images. Larger images are
+  scaled down, keeping their aspect ratio. Zero means no limit.
+ */
+void
+ImageReader::setMaxDimension(int pixels)
+{
+  QMutexLocker locker(&this->mutex);
+  pixels = SbMax(pixels, 0);
+  if (pixels == this->maxdimension) return;
+  this->maxdimension = pixels;
+  // the cached images were decoded with the old limits
+  this->cache.clear();
+}
+
+int
+ImageReader::maxDimension(void) const
+{
+  QMutexLocker locker(&this->mutex);
+  return this->maxdimension;
+}
+
+/*
+  Limits the memory of a single decoded image. Larger images are
+  scaled down to fit, keeping their aspect ratio. Zero means no limit.
+ */
+void
+ImageReader::setMaxImageMemory(size_t bytes)
+{
+  QMutexLocker locker(&this->mutex);
+  if (bytes == this->maxmemory) return;
+  this->maxmemory = bytes;
+  this->cache.clear();
+}
+
+size_t
+ImageReader::maxImageMemory(void) const
+{
+  QMutexLocker locker(&this->mutex);
+  return this->maxmemory;
+}
+
+/*
+  Enables progressive mode, where images larger than twice \a
+  previewdimension are first returned as a preview no larger than
+  \a previewdimension, and replaced by the full image when it has
+  been decoded on the thread pool. Needs the image cache, as that is
+  where the full images are handed over.
+ */
+void
+ImageReader::setProgressive(bool enable, int previewdimension)
+{
+  QMutexLocker locker(&this->mutex);
+  this->isprogressive = enable;
+  this->previewdimension = SbMax(previewdimension, 1);
+}
+
+bool
+ImageReader::progressive(void) const
+{
+  QMutexLocker locker(&this->mutex);
+  return this->isprogressive;
+}
+
+QString
+ImageReader::cacheKey(const QString & filename)
 {
+  // a changed file gets a new key, the old entry is evicted in time
+  QFileInfo info(filename);
+  return info.absoluteFilePath() + QLatin1Char('|') +
+    QString::number(info.lastModified().toMSecsSinceEpoch()) + QLatin1Char('|') +
+    QString::number(info.size());
+}
+
+ImageReader::Entry *
+ImageReader::decode(const QString & filename, int maxdimension, size_t maxmemory)
+{
+  QImageReader reader(filename);
+  const QSize fullsize = reader.size();
+  if (fullsize.isValid() && !fullsize.isEmpty()) {
+    double scale = 1.0;
+    const int largest = SbMax(fullsize.width(), fullsize.height());
+    if (maxdimension > 0 && largest > maxdimension) {
+      scale = double(maxdimension) / double(largest);
+    }
+    // assume four components, the real number is only known after
+    // decoding
+    const double bytes = double(fullsize.width()) * double(fullsize.height()) * 4.0;
+    if (maxmemory > 0 && bytes * scale * scale > double(maxmemory)) {
+      scale = sqrt(double(maxmemory) / bytes);
+    }
+    if (scale < 1.0) {
+      reader.setScaledSize(QSize(SbMax(int(fullsize.width() * scale), 1),
+                                 SbMax(int(fullsize.height() * scale), 1)));
+    }
+  }
+
   QImage image;
-  if (image.load(filename.getString())) {
-    int w = image.width();
-    int h = image.height();
-
-    // Keep in 8-bits mode if that was what we read
-    if (image.depth() != 8 || !image.isGrayscale()) {
-      // FIXME: consider if we should detect allGrayscale() and alpha (c = 2)
-      image = image.convertToFormat(image.hasAlphaChannel() ?
-                                    QImage::Format_ARGB32 : QImage::Format_RGB32);
+  if (!reader.read(&image)) return NULL;
+
+  Entry * entry = new Entry;
+  entry->size = SbVec2s((short) image.width(), (short) image.height());
+  // Keep in 8-bits mode if that was what we read
+  if (image.depth() == 8 && image.isGrayscale()) {
+    entry->numcomponents = 1;
+  }
+  else {
+    // FIXME: consider if we should detect allGrayscale() and alpha (c = 2)
+    entry->numcomponents = image.hasAlphaChannel() ? 4 : 3;
+  }
+  entry->data.resize(image.width() * image.height() * entry->numcomponents);
+  QtCoinCompatibility::QImageToSbImage(image,
+                                       reinterpret_cast<unsigned char *>(entry->data.data()),
+                                       entry->numcomponents);
+  return entry;
+}
+
+void
+ImageReader::insert(const QString & key, Entry * entry)
+{
+  QMutexLocker locker(&this->mutex);
+  const int cost = SbMax(entry->data.size() / 1024, 1);
+  // QCache takes ownership, and deletes the entry right away if it
+  // is larger than the whole cache
+  this->cache.insert(key, entry, cost);
+}
+
+void
+ImageReader::finished(const QString & key)
+{
+  QMutexLocker locker(&this->mutex);
+  this->pending.remove(key);
+  this->decoded.wakeAll();
+}
+
+/*
+  Called from the thread pool when the full image of \a filename has
+  been decoded. The textures are updated in the GUI thread, once for
+  all the images finished since the last update.
+ */
+void
+ImageReader::upgradeReady(const QString & filename, const QString & key)
+{
+  QMutexLocker locker(&this->mutex);
+  // an image larger than the whole cache is dropped right away, the
+  // textures keep the preview then
+  if (!this->cache.contains(key)) return;
+  if (this->upgrades.isEmpty()) {
+    QCoreApplication::postEvent(this->notifier, new QEvent(QEvent::User));
+  }
+  this->upgrades.append(filename);
+}
+
+/*
+  Makes the SoTexture2 nodes showing a preview of the finished images
+  read them again.
+ */
+void
+ImageReader::upgradeTextures(void)
+{
+  QStringList filenames;
+  {
+    QMutexLocker locker(&this->mutex);
+    filenames.swap(this->upgrades);
+  }
+  if (filenames.isEmpty()) return;
+
+  // views often share a scene, search each one once
+  QList<SoNode *> roots;
+  const QList<QWidget *> widgets = QApplication::allWidgets();
+  for (int i = 0; i < widgets.size(); i++) {
+    QuarterWidget * quarterwidget = qobject_cast<QuarterWidget *>(widgets[i]);
+    if (!quarterwidget) continue;
+    SoNode * root = quarterwidget->getSoRenderManager()->getSceneGraph();
+    if (root && !roots.contains(root)) roots.append(root);
+  }
+#if QT_VERSION >= 0x050000
+  const QList<QWindow *> windows = QGuiApplication::allWindows();
+  for (int i = 0; i < windows.size(); i++) {
+    QuarterWindow * quarterwindow = qobject_cast<QuarterWindow *>(windows[i]);
+    if (!quarterwindow) continue;
+    SoNode * root = quarterwindow->getSoRenderManager()->getSceneGraph();
+    if (root && !roots.contains(root)) roots.append(root);
+  }
+#endif
+
+  QSet<SoTexture2 *> textures;
+  SoSearchAction search;
+  search.setType(SoTexture2::getClassTypeId());
+  search.setInterest(SoSearchAction::ALL);
+  search.setSearchingAll(TRUE);
+  for (int i = 0; i < roots.size(); i++) {
+    search.apply(roots[i]);
+    const SoPathList & paths = search.getPaths();
+    for (int j = 0; j < paths.getLength(); j++) {
+      textures.insert(static_cast<SoTexture2 *>(paths[j]->getTail()));
+    }
+    search.reset();
+  }
+
+  foreach (SoTexture2 * texture, textures) {
+    const QString texturefile = QString::fromUtf8(texture->filename.getValue().getString());
+    for (int i = 0; i < filenames.size(); i++) {
+      if (same_file(texturefile, filenames[i])) {
+        // makes the node read the file again, and redraws the views
+        texture->filename.touch();
+        break;
+      }
     }
+  }
+}
 
-    QtCoinCompatibility::QImageToSbImage(image,sbimage);
-    return TRUE;
+/*
+  Starts decoding \a filenames on a thread pool, so that they can be
+  served from the cache when Coin asks for them.
+ */
+void
+ImageReader::prefetch(const QStringList & filenames)
+{
+  for (int i = 0; i < filenames.size(); i++) {
+    const QString key = ImageReader::cacheKey(filenames[i]);
+    {
+      QMutexLocker locker(&this->mutex);
+      if (this->cache.maxCost() == 0 || this->cache.contains(key) ||
+          this->pending.contains(key)) {
+        continue;
+      }
+      this->pending.insert(key);
+    }
+    this->pool->start(new PrefetchTask(this, filenames[i], key));
   }
-  return FALSE;
 }
 
+SbBool
+ImageReader::readImage(const SbString & filename, SbImage & sbimage) const
+{
+  QUARTER_TRACE_SCOPE("ImageReader::readImage");
+  const QString name = QString::fromUtf8(filename.getString());
+  const QString key = ImageReader::cacheKey(name);
+
+  ImageReader * self = const_cast<ImageReader *>(this);
+  int maxdimension;
+  size_t maxmemory;
+  int previewdimension = 0;
+  {
+    QMutexLocker locker(&this->mutex);
+    const Entry * entry = this->cache.object(key);
+    if (!entry && this->isprogressive && this->cache.maxCost() > 0) {
+      // a preview also stands in while a prefetch is still decoding
+      entry = this->cache.object(key + QLatin1String(PREVIEW_SUFFIX));
+      if (entry) {
+        sbimage.setValue(entry->size, entry->numcomponents,
+                         reinterpret_cast<const unsigned char *>(entry->data.constData()));
+        return TRUE;
+      }
+      if (!this->pending.contains(key)) previewdimension = this->previewdimension;
+    }
+    while (!entry && previewdimension == 0 && this->pending.contains(key)) {
+      this->decoded.wait(&this->mutex);
+      entry = this->cache.object(key);
+    }
+    if (entry) {
+      sbimage.setValue(entry->size, entry->numcomponents,
+                       reinterpret_cast<const unsigned char *>(entry->data.constData()));
+      return TRUE;
+    }
+    this->pending.insert(key);
+    maxdimension = this->maxdimension;
+    maxmemory = this->maxmemory;
+  }
+
+  if (previewdimension > 0) {
+    const QSize size = QImageReader(name).size();
+    const int largest = size.isValid() ? SbMax(size.width(), size.height()) : 0;
+    const int limit = maxdimension > 0 ? SbMin(maxdimension, largest) : largest;
+    if (limit > 2 * previewdimension) {
+      Entry * preview = ImageReader::decode(name, previewdimension, maxmemory);
+      if (preview) {
+        sbimage.setValue(preview->size, preview->numcomponents,
+                         reinterpret_cast<const unsigned char *>(preview->data.constData()));
+        self->insert(key + QLatin1String(PREVIEW_SUFFIX), preview);
+        // the key stays pending until the full image is decoded
+        self->pool->start(new PrefetchTask(self, name, key, true));
+        return TRUE;
+      }
+    }
+  }
 
+  Entry * entry = ImageReader::decode(name, maxdimension, maxmemory);
+  if (entry) {
+    sbimage.setValue(entry->size, entry->numcomponents,
+                     reinterpret_cast<const unsigned char *>(entry->data.constData()));
+    self->insert(key, entry);
+  }
+  self->finished(key);
+  return entry != NULL;
+}
 
 SbBool
 ImageReader::readImageCB(const SbString & filename, SbImage * image, void * closure)
@@ -34,10 +34,21 @@
 \**************************************************************************/
 
 #include <Inventor/SbBasic.h>
+#include <Inventor/SbVec2s.h>
+#include <QtCore/QByteArray>
+#include <QtCore/QCache>
+#include <QtCore/QMutex>
+#include <QtCore/QSet>
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+#include <QtCore/QWaitCondition>
+#include <stddef.h>
 
 class SbImage;
 class SbString;
 class QImage;
+class QObject;
+class QThreadPool;
 
 namespace SIM { namespace Coin3D { namespace Quarter {
 
@@ -48,8 +59,48 @@ public:
 
   SbBool readImage(const SbString & filename, SbImage & image) const;
 
+  void prefetch(const QStringList & filenames);
+  void setCacheSize(size_t bytes);
+  size_t cacheSize(void) const;
+  void setMaxDimension(int pixels);
+  int maxDimension(void) const;
+  void setMaxImageMemory(size_t bytes);
+  size_t maxImageMemory(void) const;
+  void setProgressive(bool enable, int previewdimension);
+  bool progressive(void) const;
+
+  // a decoded image, in the layout SbImage expects
+  struct Entry {
+    QByteArray data;
+    SbVec2s size;
+    int numcomponents;
+  };
+
+  static QString cacheKey(const QString & filename);
+  static Entry * decode(const QString & filename, int maxdimension, size_t maxmemory);
+  void insert(const QString & key, Entry * entry);
+  void finished(const QString & key);
+  void upgradeReady(const QString & filename, const QString & key);
+  void upgradeTextures(void);
+
 private:
   static SbBool readImageCB(const SbString & filename, SbImage * image, void * closure);
+
+  mutable QMutex mutex;
+  mutable QWaitCondition decoded;
+  // LRU of decoded images, the cost is measured in kilobytes
+  mutable QCache<QString, Entry> cache;
+  // images currently being decoded, by a prefetch or a reader
+  mutable QSet<QString> pending;
+  QThreadPool * pool;
+  int maxdimension;
+  size_t maxmemory;
+  // previews are returned first, and the full images decoded on the pool
+  bool isprogressive;
+  int previewdimension;
+  // full images decoded since the textures were last updated
+  QStringList upgrades;
+  QObject * notifier;
 };
 
 }}} // namespace
@@ -48,6 +48,21 @@ InputDevice::InputDevice(QuarterWidget* quart) :
     quarter(quart)
 {
   this->mousepos = SbVec2s(0, 0);
+  this->devicepixelratio = 1.0;
+}
+
+/*!
+  Returns the types of the QEvents this device translates. The
+  EventFilter only passes events of these types to translateEvent().
+
+  The default implementation returns an empty list, which means that
+  the device is given every event. Override this in subclasses to
+  avoid being called for events the device does not handle.
+*/
+QList<QEvent::Type>
+InputDevice::eventTypes(void) const
+{
+  return QList<QEvent::Type>();
 }
 
 /*!
@@ -72,6 +87,18 @@ InputDevice::setWindowSize(const SbVec2s & size)
   this->windowsize = size;
 }
 
+/*!
+  Sets the ratio between physical and logical pixels of the owning
+  window
+
+  \param[in] ratio the device pixel ratio
+*/
+void
+InputDevice::setDevicePixelRatio(qreal ratio)
+{
+  this->devicepixelratio = ratio;
+}
+
 /*!
   Transforms a QEvent into an SoEvent
 
@@ -105,4 +132,17 @@ InputDevice::setModifiers(SoEvent * soevent, const QInputEvent * qevent)
   Holds the size of the owning window
 */
 
+/*!
+  \var InputDevice::devicepixelratio
+
+  Holds the device pixel ratio of the owning window
+*/
+
+/*!
+  \var InputDevice::quarter
+
+  The QuarterWidget the device translates events for. This is NULL
+  for devices owned by a QuarterWindow.
+*/
+
 #undef PRIVATE
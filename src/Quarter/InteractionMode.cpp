@@ -3,9 +3,12 @@
 #include <QKeyEvent>
 #include <QFocusEvent>
 #include <Quarter/QuarterWidget.h>
+#include <Quarter/QuarterWindow.h>
+#include <QMap>
+#include "QuarterP.h"
 
 /*
-  Adjust how QuarterWidget reacts to alt key events
+  Adjust how QuarterWidget and QuarterWindow react to alt key events
  */
 
 using namespace SIM::Coin3D::Quarter;
@@ -14,6 +17,7 @@ InteractionMode::InteractionMode(QuarterWidget * quarterwidget)
   : QObject(quarterwidget)
 {
   this->quarterwidget = quarterwidget;
+  this->quarterwindow = NULL;
   this->altkeydown = false;
   this->prevcursor = QCursor();
   this->prevnavstate =
@@ -22,6 +26,21 @@ InteractionMode::InteractionMode(QuarterWidget * quarterwidget)
   this->isenabled = true;
 }
 
+#if QT_VERSION >= 0x050000
+InteractionMode::InteractionMode(QuarterWindow * quarterwindow)
+  : QObject(quarterwindow)
+{
+  this->quarterwidget = NULL;
+  this->quarterwindow = quarterwindow;
+  this->altkeydown = false;
+  this->prevcursor = QCursor();
+  this->prevnavstate =
+    this->quarterwindow->getSoEventManager()->getNavigationState();
+
+  this->isenabled = true;
+}
+#endif
+
 InteractionMode::~InteractionMode()
 {
 
@@ -46,17 +65,17 @@ InteractionMode::setOn(bool on)
     return;
   }
 
-  SoEventManager * eventmanager = this->quarterwidget->getSoEventManager();
+  SoEventManager * eventmanager = this->eventManager();
 
   if (on) {
     this->altkeydown = true;
     this->prevnavstate = eventmanager->getNavigationState();
-    this->prevcursor = this->quarterwidget->cursor();
-    this->quarterwidget->setCursor(this->quarterwidget->stateCursor("interact"));
+    this->prevcursor = this->cursor();
+    this->setCursor(QuarterP::statecursormap->value("interact"));
     eventmanager->setNavigationState(SoEventManager::NO_NAVIGATION);
   } else {
     this->altkeydown = false;
-    this->quarterwidget->setCursor(this->prevcursor);
+    this->setCursor(this->prevcursor);
     eventmanager->setNavigationState(this->prevnavstate);
   }
 }
@@ -74,7 +93,7 @@ InteractionMode::eventFilter(QObject * obj, QEvent * event)
     return false;
   }
 
-  assert(obj == this->quarterwidget);
+  assert(obj == this->target());
 
   switch (event->type()) {
   case QEvent::KeyPress:
@@ -124,7 +143,46 @@ InteractionMode::focusOutEvent(QFocusEvent * event)
 {
   if (this->altkeydown) {
     QKeyEvent keyevent(QEvent::KeyRelease, Qt::Key_Alt, Qt::NoModifier);
-    return QCoreApplication::sendEvent(this->quarterwidget, &keyevent);
+    return QCoreApplication::sendEvent(this->target(), &keyevent);
   }
   return false;
 }
+
+QObject *
+InteractionMode::target(void) const
+{
+#if QT_VERSION >= 0x050000
+  if (this->quarterwindow) return this->quarterwindow;
+#endif
+  return this->quarterwidget;
+}
+
+SoEventManager *
+InteractionMode::eventManager(void) const
+{
+#if QT_VERSION >= 0x050000
+  if (this->quarterwindow) return this->quarterwindow->getSoEventManager();
+#endif
+  return this->quarterwidget->getSoEventManager();
+}
+
+QCursor
+InteractionMode::cursor(void) const
+{
+#if QT_VERSION >= 0x050000
+  if (this->quarterwindow) return this->quarterwindow->cursor();
+#endif
+  return this->quarterwidget->cursor();
+}
+
+void
+InteractionMode::setCursor(const QCursor & cursor)
+{
+#if QT_VERSION >= 0x050000
+  if (this->quarterwindow) {
+    this->quarterwindow->setCursor(cursor);
+    return;
+  }
+#endif
+  this->quarterwidget->setCursor(cursor);
+}
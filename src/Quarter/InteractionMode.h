@@ -46,11 +46,15 @@ class QFocusEvent;
 namespace SIM { namespace Coin3D { namespace Quarter {
 
 class QuarterWidget;
+class QuarterWindow;
 
 class QUARTER_DLL_API InteractionMode : public QObject {
   Q_OBJECT
 public:
   InteractionMode(QuarterWidget * quarterwidget);
+#if QT_VERSION >= 0x050000
+  InteractionMode(QuarterWindow * quarterwindow);
+#endif
   virtual ~InteractionMode();
 
   void setEnabled(bool yes);
@@ -67,8 +71,14 @@ private:
   bool keyReleaseEvent(QKeyEvent * event);
   bool focusOutEvent(QFocusEvent * event);
 
+  QObject * target(void) const;
+  SoEventManager * eventManager(void) const;
+  QCursor cursor(void) const;
+  void setCursor(const QCursor & cursor);
+
   QCursor prevcursor;
   QuarterWidget * quarterwidget;
+  QuarterWindow * quarterwindow;
   bool altkeydown;
   SoEventManager::NavigationState prevnavstate;
   bool isenabled;
@@ -62,6 +62,16 @@ Keyboard::~Keyboard()
   delete PRIVATE(this);
 }
 
+/*! Returns the key press and release event types
+ */
+QList<QEvent::Type>
+Keyboard::eventTypes(void) const
+{
+  QList<QEvent::Type> types;
+  types << QEvent::KeyPress << QEvent::KeyRelease;
+  return types;
+}
+
 /*! Translates from QKeyEvents to SoKeyboardEvents
  */
 const SoEvent *
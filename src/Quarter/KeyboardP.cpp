@@ -32,8 +32,10 @@
 
 #include "KeyboardP.h"
 #include <Quarter/devices/Keyboard.h>
-#include <QtCore/QMap>
+#include <Inventor/C/tidbits.h>
 #include <Inventor/errors/SoDebugError.h>
+#include <assert.h>
+#include <stdlib.h>
 
 using namespace SIM::Coin3D::Quarter;
 
@@ -44,10 +46,8 @@ KeyboardP::KeyboardP(Keyboard * publ)
   PUBLIC(this) = publ;
   this->keyboard = new SoKeyboardEvent;
 
-  if (keyboardmap == NULL) {
-    keyboardmap = new KeyMap;
-    keypadmap = new KeyMap;
-    this->initKeyMap();
+  if (!tablesinitialized) {
+    KeyboardP::initKeyMap();
   }
 }
 
@@ -59,8 +59,38 @@ KeyboardP::~KeyboardP()
 bool
 KeyboardP::debugKeyEvents(void)
 {
-  const char * env = coin_getenv("QUARTER_DEBUG_KEYEVENTS");
-  return env && (atoi(env) > 0);
+  // the environment is only consulted once, not for every key event
+  static int debug = -1;
+  if (debug < 0) {
+    const char * env = coin_getenv("QUARTER_DEBUG_KEYEVENTS");
+    debug = (env && (atoi(env) > 0)) ? 1 : 0;
+  }
+  return debug == 1;
+}
+
+/*
+  Maps a Qt key code to its slot in the flat tables, or returns -1
+  for codes outside the Latin-1 and function key ranges.
+*/
+static inline int
+keytable_index(int qkey)
+{
+  if (qkey >= 0 && qkey < KeyboardP::TABLE_RANGE) {
+    return qkey;
+  }
+  const int offset = qkey - int(Qt::Key_Escape);
+  if (offset >= 0 && offset < KeyboardP::TABLE_RANGE) {
+    return KeyboardP::TABLE_RANGE + offset;
+  }
+  return -1;
+}
+
+SoKeyboardEvent::Key
+KeyboardP::lookup(int qkey, bool keypad)
+{
+  const int idx = keytable_index(qkey);
+  if (idx < 0) return SoKeyboardEvent::ANY;
+  return keypad ? keypadtable[idx] : keyboardtable[idx];
 }
 
 const SoEvent *
@@ -75,17 +105,14 @@ KeyboardP::keyEvent(QKeyEvent * qevent)
     this->keyboard->setState(SoButtonEvent::DOWN):
     this->keyboard->setState(SoButtonEvent::UP);
 
-  Qt::Key qkey = (Qt::Key) qevent->key();
+  SoKeyboardEvent::Key sokey =
+    KeyboardP::lookup(qevent->key(), (modifiers & Qt::KeypadModifier) != 0);
 
-  SoKeyboardEvent::Key sokey = (modifiers & Qt::KeypadModifier) ?
-    keypadmap->value(qkey, SoKeyboardEvent::ANY) :
-    keyboardmap->value(qkey, SoKeyboardEvent::ANY);
-
-  //Need to use a temporary to avoid reference becoming deleted before
-  //we get a hold of it.
-  QByteArray tmp = qevent->text().toLatin1();
-  const char * printable = tmp.constData();
-  this->keyboard->setPrintableCharacter(*printable);
+  // only the first character is of interest, so there is no need to
+  // convert the whole text to a temporary QByteArray
+  const QString text = qevent->text();
+  const char printable = text.isEmpty() ? '\0' : text.at(0).toLatin1();
+  this->keyboard->setPrintableCharacter(printable);
   this->keyboard->setKey(sokey);
 
 #if QUARTER_DEBUG
@@ -93,7 +120,7 @@ KeyboardP::keyEvent(QKeyEvent * qevent)
     SbString s;
     this->keyboard->enumToString(this->keyboard->getKey(), s);
     SoDebugError::postInfo("KeyboardP::keyEvent",
-                           "enum: '%s', pos: <%i %i>, printable: '%s'",
+                           "enum: '%s', pos: <%i %i>, printable: '%c'",
                            s.getString(),
                            PUBLIC(this)->mousepos[0],
                            PUBLIC(this)->mousepos[1],
@@ -103,146 +130,169 @@ KeyboardP::keyEvent(QKeyEvent * qevent)
   return this->keyboard;
 }
 
-KeyboardP::KeyMap * KeyboardP::keyboardmap = NULL;
-KeyboardP::KeyMap * KeyboardP::keypadmap = NULL;
+const KeyboardP::KeyMapping KeyboardP::keyboardmappings[] = {
+  { Qt::Key_Shift,   SoKeyboardEvent::LEFT_SHIFT },
+  { Qt::Key_Alt,     SoKeyboardEvent::LEFT_ALT },
+  { Qt::Key_Control, SoKeyboardEvent::LEFT_CONTROL },
+  { Qt::Key_0,       SoKeyboardEvent::NUMBER_0 },
+  { Qt::Key_1,       SoKeyboardEvent::NUMBER_1 },
+  { Qt::Key_2,       SoKeyboardEvent::NUMBER_2 },
+  { Qt::Key_3,       SoKeyboardEvent::NUMBER_3 },
+  { Qt::Key_4,       SoKeyboardEvent::NUMBER_4 },
+  { Qt::Key_5,       SoKeyboardEvent::NUMBER_5 },
+  { Qt::Key_6,       SoKeyboardEvent::NUMBER_6 },
+  { Qt::Key_7,       SoKeyboardEvent::NUMBER_7 },
+  { Qt::Key_8,       SoKeyboardEvent::NUMBER_8 },
+  { Qt::Key_9,       SoKeyboardEvent::NUMBER_9 },
 
-void
-KeyboardP::initKeyMap(void)
-{
-  // keyboard
-  keyboardmap->insert(Qt::Key_Shift,   SoKeyboardEvent::LEFT_SHIFT);
-  keyboardmap->insert(Qt::Key_Alt,     SoKeyboardEvent::LEFT_ALT);
-  keyboardmap->insert(Qt::Key_Control, SoKeyboardEvent::LEFT_CONTROL);
-  keyboardmap->insert(Qt::Key_0, SoKeyboardEvent::NUMBER_0);
-  keyboardmap->insert(Qt::Key_1, SoKeyboardEvent::NUMBER_1);
-  keyboardmap->insert(Qt::Key_2, SoKeyboardEvent::NUMBER_2);
-  keyboardmap->insert(Qt::Key_3, SoKeyboardEvent::NUMBER_3);
-  keyboardmap->insert(Qt::Key_4, SoKeyboardEvent::NUMBER_4);
-  keyboardmap->insert(Qt::Key_5, SoKeyboardEvent::NUMBER_5);
-  keyboardmap->insert(Qt::Key_6, SoKeyboardEvent::NUMBER_6);
-  keyboardmap->insert(Qt::Key_7, SoKeyboardEvent::NUMBER_7);
-  keyboardmap->insert(Qt::Key_8, SoKeyboardEvent::NUMBER_8);
-  keyboardmap->insert(Qt::Key_9, SoKeyboardEvent::NUMBER_9);
-
-  keyboardmap->insert(Qt::Key_A, SoKeyboardEvent::A);
-  keyboardmap->insert(Qt::Key_B, SoKeyboardEvent::B);
-  keyboardmap->insert(Qt::Key_C, SoKeyboardEvent::C);
-  keyboardmap->insert(Qt::Key_D, SoKeyboardEvent::D);
-  keyboardmap->insert(Qt::Key_E, SoKeyboardEvent::E);
-  keyboardmap->insert(Qt::Key_F, SoKeyboardEvent::F);
-  keyboardmap->insert(Qt::Key_G, SoKeyboardEvent::G);
-  keyboardmap->insert(Qt::Key_H, SoKeyboardEvent::H);
-  keyboardmap->insert(Qt::Key_I, SoKeyboardEvent::I);
-  keyboardmap->insert(Qt::Key_J, SoKeyboardEvent::J);
-  keyboardmap->insert(Qt::Key_K, SoKeyboardEvent::K);
-  keyboardmap->insert(Qt::Key_L, SoKeyboardEvent::L);
-  keyboardmap->insert(Qt::Key_M, SoKeyboardEvent::M);
-  keyboardmap->insert(Qt::Key_N, SoKeyboardEvent::N);
-  keyboardmap->insert(Qt::Key_O, SoKeyboardEvent::O);
-  keyboardmap->insert(Qt::Key_P, SoKeyboardEvent::P);
-  keyboardmap->insert(Qt::Key_Q, SoKeyboardEvent::Q);
-  keyboardmap->insert(Qt::Key_R, SoKeyboardEvent::R);
-  keyboardmap->insert(Qt::Key_S, SoKeyboardEvent::S);
-  keyboardmap->insert(Qt::Key_T, SoKeyboardEvent::T);
-  keyboardmap->insert(Qt::Key_U, SoKeyboardEvent::U);
-  keyboardmap->insert(Qt::Key_V, SoKeyboardEvent::V);
-  keyboardmap->insert(Qt::Key_W, SoKeyboardEvent::W);
-  keyboardmap->insert(Qt::Key_X, SoKeyboardEvent::X);
-  keyboardmap->insert(Qt::Key_Y, SoKeyboardEvent::Y);
-  keyboardmap->insert(Qt::Key_Z, SoKeyboardEvent::Z);
-
-  keyboardmap->insert(Qt::Key_Home,     SoKeyboardEvent::HOME);
-  keyboardmap->insert(Qt::Key_Left,     SoKeyboardEvent::LEFT_ARROW);
-  keyboardmap->insert(Qt::Key_Up,       SoKeyboardEvent::UP_ARROW);
-  keyboardmap->insert(Qt::Key_Right,    SoKeyboardEvent::RIGHT_ARROW);
-  keyboardmap->insert(Qt::Key_Down,     SoKeyboardEvent::DOWN_ARROW);
-  keyboardmap->insert(Qt::Key_PageUp,   SoKeyboardEvent::PAGE_UP);
-  keyboardmap->insert(Qt::Key_PageDown, SoKeyboardEvent::PAGE_DOWN);
-  keyboardmap->insert(Qt::Key_End,      SoKeyboardEvent::END);
-
-  keyboardmap->insert(Qt::Key_F1,  SoKeyboardEvent::F1);
-  keyboardmap->insert(Qt::Key_F2,  SoKeyboardEvent::F2);
-  keyboardmap->insert(Qt::Key_F3,  SoKeyboardEvent::F3);
-  keyboardmap->insert(Qt::Key_F4,  SoKeyboardEvent::F4);
-  keyboardmap->insert(Qt::Key_F5,  SoKeyboardEvent::F5);
-  keyboardmap->insert(Qt::Key_F6,  SoKeyboardEvent::F6);
-  keyboardmap->insert(Qt::Key_F7,  SoKeyboardEvent::F7);
-  keyboardmap->insert(Qt::Key_F8,  SoKeyboardEvent::F8);
-  keyboardmap->insert(Qt::Key_F9,  SoKeyboardEvent::F9);
-  keyboardmap->insert(Qt::Key_F10, SoKeyboardEvent::F10);
-  keyboardmap->insert(Qt::Key_F11, SoKeyboardEvent::F11);
-  keyboardmap->insert(Qt::Key_F12, SoKeyboardEvent::F12);
-
-  keyboardmap->insert(Qt::Key_Backspace,  SoKeyboardEvent::BACKSPACE);
-  keyboardmap->insert(Qt::Key_Tab,        SoKeyboardEvent::TAB);
-  keyboardmap->insert(Qt::Key_Return,     SoKeyboardEvent::RETURN);
-  keyboardmap->insert(Qt::Key_Enter,      SoKeyboardEvent::ENTER);
-  keyboardmap->insert(Qt::Key_Pause,      SoKeyboardEvent::PAUSE);
-  keyboardmap->insert(Qt::Key_ScrollLock, SoKeyboardEvent::SCROLL_LOCK);
-  keyboardmap->insert(Qt::Key_Escape,     SoKeyboardEvent::ESCAPE);
-  keyboardmap->insert(Qt::Key_Delete,     SoKeyboardEvent::DELETE);
-  keyboardmap->insert(Qt::Key_Print,      SoKeyboardEvent::PRINT);
-  keyboardmap->insert(Qt::Key_Insert,     SoKeyboardEvent::INSERT);
-  keyboardmap->insert(Qt::Key_NumLock,    SoKeyboardEvent::NUM_LOCK);
-  keyboardmap->insert(Qt::Key_CapsLock,   SoKeyboardEvent::CAPS_LOCK);
-
-  keyboardmap->insert(Qt::Key_Space,        SoKeyboardEvent::SPACE);
-  keyboardmap->insert(Qt::Key_Apostrophe,   SoKeyboardEvent::APOSTROPHE);
-  keyboardmap->insert(Qt::Key_Comma,        SoKeyboardEvent::COMMA);
-  keyboardmap->insert(Qt::Key_Minus,        SoKeyboardEvent::MINUS);
-  keyboardmap->insert(Qt::Key_Period,       SoKeyboardEvent::PERIOD);
-  keyboardmap->insert(Qt::Key_Slash,        SoKeyboardEvent::SLASH);
-  keyboardmap->insert(Qt::Key_Semicolon,    SoKeyboardEvent::SEMICOLON);
-  keyboardmap->insert(Qt::Key_Equal,        SoKeyboardEvent::EQUAL);
-  keyboardmap->insert(Qt::Key_BracketLeft,  SoKeyboardEvent::BRACKETLEFT);
-  keyboardmap->insert(Qt::Key_BracketRight, SoKeyboardEvent::BRACKETRIGHT);
-  keyboardmap->insert(Qt::Key_Backslash,    SoKeyboardEvent::BACKSLASH);
-  keyboardmap->insert(Qt::Key_Agrave,       SoKeyboardEvent::GRAVE);
-
-  // keypad
-
-  // on Mac OS X, the keypad modifier will also be set when an arrow
-  // key is pressed as the arrow keys are considered part of the
-  // keypad
-  keypadmap->insert(Qt::Key_Left,     SoKeyboardEvent::LEFT_ARROW);
-  keypadmap->insert(Qt::Key_Up,       SoKeyboardEvent::UP_ARROW);
-  keypadmap->insert(Qt::Key_Right,    SoKeyboardEvent::RIGHT_ARROW);
-  keypadmap->insert(Qt::Key_Down,     SoKeyboardEvent::DOWN_ARROW);
-
-  keypadmap->insert(Qt::Key_Enter,    SoKeyboardEvent::PAD_ENTER);
-  keypadmap->insert(Qt::Key_F1,       SoKeyboardEvent::PAD_F1);
-  keypadmap->insert(Qt::Key_F2,       SoKeyboardEvent::PAD_F2);
-  keypadmap->insert(Qt::Key_F3,       SoKeyboardEvent::PAD_F3);
-  keypadmap->insert(Qt::Key_F4,       SoKeyboardEvent::PAD_F4);
-  keypadmap->insert(Qt::Key_0,        SoKeyboardEvent::PAD_0);
-  keypadmap->insert(Qt::Key_1,        SoKeyboardEvent::PAD_1);
-  keypadmap->insert(Qt::Key_2,        SoKeyboardEvent::PAD_2);
-  keypadmap->insert(Qt::Key_3,        SoKeyboardEvent::PAD_3);
-  keypadmap->insert(Qt::Key_4,        SoKeyboardEvent::PAD_4);
-  keypadmap->insert(Qt::Key_5,        SoKeyboardEvent::PAD_5);
-  keypadmap->insert(Qt::Key_6,        SoKeyboardEvent::PAD_6);
-  keypadmap->insert(Qt::Key_7,        SoKeyboardEvent::PAD_7);
-  keypadmap->insert(Qt::Key_8,        SoKeyboardEvent::PAD_8);
-  keypadmap->insert(Qt::Key_9,        SoKeyboardEvent::PAD_9);
-  keypadmap->insert(Qt::Key_Plus,     SoKeyboardEvent::PAD_ADD);
-  keypadmap->insert(Qt::Key_Minus,    SoKeyboardEvent::PAD_SUBTRACT);
-  keypadmap->insert(Qt::Key_multiply, SoKeyboardEvent::PAD_MULTIPLY);
-  keypadmap->insert(Qt::Key_division, SoKeyboardEvent::PAD_DIVIDE);
-  keypadmap->insert(Qt::Key_Tab,      SoKeyboardEvent::PAD_TAB);
-  keypadmap->insert(Qt::Key_Space,    SoKeyboardEvent::PAD_SPACE);
-  keypadmap->insert(Qt::Key_Insert,   SoKeyboardEvent::PAD_INSERT);
-  keypadmap->insert(Qt::Key_Delete,   SoKeyboardEvent::PAD_DELETE);
-  keypadmap->insert(Qt::Key_Period,   SoKeyboardEvent::PAD_PERIOD);
+  { Qt::Key_A, SoKeyboardEvent::A },
+  { Qt::Key_B, SoKeyboardEvent::B },
+  { Qt::Key_C, SoKeyboardEvent::C },
+  { Qt::Key_D, SoKeyboardEvent::D },
+  { Qt::Key_E, SoKeyboardEvent::E },
+  { Qt::Key_F, SoKeyboardEvent::F },
+  { Qt::Key_G, SoKeyboardEvent::G },
+  { Qt::Key_H, SoKeyboardEvent::H },
+  { Qt::Key_I, SoKeyboardEvent::I },
+  { Qt::Key_J, SoKeyboardEvent::J },
+  { Qt::Key_K, SoKeyboardEvent::K },
+  { Qt::Key_L, SoKeyboardEvent::L },
+  { Qt::Key_M, SoKeyboardEvent::M },
+  { Qt::Key_N, SoKeyboardEvent::N },
+  { Qt::Key_O, SoKeyboardEvent::O },
+  { Qt::Key_P, SoKeyboardEvent::P },
+  { Qt::Key_Q, SoKeyboardEvent::Q },
+  { Qt::Key_R, SoKeyboardEvent::R },
+  { Qt::Key_S, SoKeyboardEvent::S },
+  { Qt::Key_T, SoKeyboardEvent::T },
+  { Qt::Key_U, SoKeyboardEvent::U },
+  { Qt::Key_V, SoKeyboardEvent::V },
+  { Qt::Key_W, SoKeyboardEvent::W },
+  { Qt::Key_X, SoKeyboardEvent::X },
+  { Qt::Key_Y, SoKeyboardEvent::Y },
+  { Qt::Key_Z, SoKeyboardEvent::Z },
+
+  { Qt::Key_Home,     SoKeyboardEvent::HOME },
+  { Qt::Key_Left,     SoKeyboardEvent::LEFT_ARROW },
+  { Qt::Key_Up,       SoKeyboardEvent::UP_ARROW },
+  { Qt::Key_Right,    SoKeyboardEvent::RIGHT_ARROW },
+  { Qt::Key_Down,     SoKeyboardEvent::DOWN_ARROW },
+  { Qt::Key_PageUp,   SoKeyboardEvent::PAGE_UP },
+  { Qt::Key_PageDown, SoKeyboardEvent::PAGE_DOWN },
+  { Qt::Key_End,      SoKeyboardEvent::END },
 
+  { Qt::Key_F1,  SoKeyboardEvent::F1 },
+  { Qt::Key_F2,  SoKeyboardEvent::F2 },
+  { Qt::Key_F3,  SoKeyboardEvent::F3 },
+  { Qt::Key_F4,  SoKeyboardEvent::F4 },
+  { Qt::Key_F5,  SoKeyboardEvent::F5 },
+  { Qt::Key_F6,  SoKeyboardEvent::F6 },
+  { Qt::Key_F7,  SoKeyboardEvent::F7 },
+  { Qt::Key_F8,  SoKeyboardEvent::F8 },
+  { Qt::Key_F9,  SoKeyboardEvent::F9 },
+  { Qt::Key_F10, SoKeyboardEvent::F10 },
+  { Qt::Key_F11, SoKeyboardEvent::F11 },
+  { Qt::Key_F12, SoKeyboardEvent::F12 },
 
+  { Qt::Key_Backspace,  SoKeyboardEvent::BACKSPACE },
+  { Qt::Key_Tab,        SoKeyboardEvent::TAB },
+  { Qt::Key_Return,     SoKeyboardEvent::RETURN },
+  { Qt::Key_Enter,      SoKeyboardEvent::ENTER },
+  { Qt::Key_Pause,      SoKeyboardEvent::PAUSE },
+  { Qt::Key_ScrollLock, SoKeyboardEvent::SCROLL_LOCK },
+  { Qt::Key_Escape,     SoKeyboardEvent::ESCAPE },
+  { Qt::Key_Delete,     SoKeyboardEvent::DELETE },
+  { Qt::Key_Print,      SoKeyboardEvent::PRINT },
+  { Qt::Key_Insert,     SoKeyboardEvent::INSERT },
+  { Qt::Key_NumLock,    SoKeyboardEvent::NUM_LOCK },
+  { Qt::Key_CapsLock,   SoKeyboardEvent::CAPS_LOCK },
+
+  { Qt::Key_Space,        SoKeyboardEvent::SPACE },
+  { Qt::Key_Apostrophe,   SoKeyboardEvent::APOSTROPHE },
+  { Qt::Key_Comma,        SoKeyboardEvent::COMMA },
+  { Qt::Key_Minus,        SoKeyboardEvent::MINUS },
+  { Qt::Key_Period,       SoKeyboardEvent::PERIOD },
+  { Qt::Key_Slash,        SoKeyboardEvent::SLASH },
+  { Qt::Key_Semicolon,    SoKeyboardEvent::SEMICOLON },
+  { Qt::Key_Equal,        SoKeyboardEvent::EQUAL },
+  { Qt::Key_BracketLeft,  SoKeyboardEvent::BRACKETLEFT },
+  { Qt::Key_BracketRight, SoKeyboardEvent::BRACKETRIGHT },
+  { Qt::Key_Backslash,    SoKeyboardEvent::BACKSLASH },
+  { Qt::Key_Agrave,       SoKeyboardEvent::GRAVE },
 #if 0 // FIXME: don't know what to do with these (20070306 frodo)
-  keyboardmap->insert(Qt::, SoKeyboardEvent::RIGHT_SHIFT);
-  keyboardmap->insert(Qt::, SoKeyboardEvent::RIGHT_CONTROL);
-  keyboardmap->insert(Qt::, SoKeyboardEvent::RIGHT_ALT);
-  keyboardmap->insert(Qt::, SoKeyboardEvent::PRIOR);
-  keyboardmap->insert(Qt::, SoKeyboardEvent::NEXT);
-  keyboardmap->insert(Qt::, SoKeyboardEvent::SHIFT_LOCK);
+  { Qt::, SoKeyboardEvent::RIGHT_SHIFT },
+  { Qt::, SoKeyboardEvent::RIGHT_CONTROL },
+  { Qt::, SoKeyboardEvent::RIGHT_ALT },
+  { Qt::, SoKeyboardEvent::PRIOR },
+  { Qt::, SoKeyboardEvent::NEXT },
+  { Qt::, SoKeyboardEvent::SHIFT_LOCK },
 #endif
+};
+
+const int KeyboardP::numkeyboardmappings =
+  sizeof(KeyboardP::keyboardmappings) / sizeof(KeyboardP::keyboardmappings[0]);
+
+// on Mac OS X, the keypad modifier will also be set when an arrow
+// key is pressed as the arrow keys are considered part of the
+// keypad
+const KeyboardP::KeyMapping KeyboardP::keypadmappings[] = {
+  { Qt::Key_Left,  SoKeyboardEvent::LEFT_ARROW },
+  { Qt::Key_Up,    SoKeyboardEvent::UP_ARROW },
+  { Qt::Key_Right, SoKeyboardEvent::RIGHT_ARROW },
+  { Qt::Key_Down,  SoKeyboardEvent::DOWN_ARROW },
+
+  { Qt::Key_Enter,    SoKeyboardEvent::PAD_ENTER },
+  { Qt::Key_F1,       SoKeyboardEvent::PAD_F1 },
+  { Qt::Key_F2,       SoKeyboardEvent::PAD_F2 },
+  { Qt::Key_F3,       SoKeyboardEvent::PAD_F3 },
+  { Qt::Key_F4,       SoKeyboardEvent::PAD_F4 },
+  { Qt::Key_0,        SoKeyboardEvent::PAD_0 },
+  { Qt::Key_1,        SoKeyboardEvent::PAD_1 },
+  { Qt::Key_2,        SoKeyboardEvent::PAD_2 },
+  { Qt::Key_3,        SoKeyboardEvent::PAD_3 },
+  { Qt::Key_4,        SoKeyboardEvent::PAD_4 },
+  { Qt::Key_5,        SoKeyboardEvent::PAD_5 },
+  { Qt::Key_6,        SoKeyboardEvent::PAD_6 },
+  { Qt::Key_7,        SoKeyboardEvent::PAD_7 },
+  { Qt::Key_8,        SoKeyboardEvent::PAD_8 },
+  { Qt::Key_9,        SoKeyboardEvent::PAD_9 },
+  { Qt::Key_Plus,     SoKeyboardEvent::PAD_ADD },
+  { Qt::Key_Minus,    SoKeyboardEvent::PAD_SUBTRACT },
+  { Qt::Key_multiply, SoKeyboardEvent::PAD_MULTIPLY },
+  { Qt::Key_division, SoKeyboardEvent::PAD_DIVIDE },
+  { Qt::Key_Tab,      SoKeyboardEvent::PAD_TAB },
+  { Qt::Key_Space,    SoKeyboardEvent::PAD_SPACE },
+  { Qt::Key_Insert,   SoKeyboardEvent::PAD_INSERT },
+  { Qt::Key_Delete,   SoKeyboardEvent::PAD_DELETE },
+  { Qt::Key_Period,   SoKeyboardEvent::PAD_PERIOD },
+};
+
+const int KeyboardP::numkeypadmappings =
+  sizeof(KeyboardP::keypadmappings) / sizeof(KeyboardP::keypadmappings[0]);
+
+SoKeyboardEvent::Key KeyboardP::keyboardtable[KeyboardP::TABLE_SIZE];
+SoKeyboardEvent::Key KeyboardP::keypadtable[KeyboardP::TABLE_SIZE];
+bool KeyboardP::tablesinitialized = false;
+
+void
+KeyboardP::initKeyMap(void)
+{
+  int i;
+  for (i = 0; i < TABLE_SIZE; i++) {
+    keyboardtable[i] = SoKeyboardEvent::ANY;
+    keypadtable[i] = SoKeyboardEvent::ANY;
+  }
+  for (i = 0; i < numkeyboardmappings; i++) {
+    const int idx = keytable_index(keyboardmappings[i].qkey);
+    assert(idx >= 0 && "key code outside the flat table ranges");
+    keyboardtable[idx] = keyboardmappings[i].sokey;
+  }
+  for (i = 0; i < numkeypadmappings; i++) {
+    const int idx = keytable_index(keypadmappings[i].qkey);
+    assert(idx >= 0 && "key code outside the flat table ranges");
+    keypadtable[idx] = keypadmappings[i].sokey;
+  }
+  tablesinitialized = true;
 }
 
 #undef PUBLIC
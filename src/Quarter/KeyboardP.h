@@ -37,7 +37,6 @@
 #include <Inventor/events/SoKeyboardEvent.h>
 
 class SoEvent;
-template <class Key, class T> class QMap;
 
 namespace SIM { namespace Coin3D { namespace Quarter {
 
@@ -49,12 +48,26 @@ public:
   ~KeyboardP();
 
   const SoEvent * keyEvent(QKeyEvent * event);
-  void initKeyMap(void);
+  static void initKeyMap(void);
   static bool debugKeyEvents(void);
+  static SoKeyboardEvent::Key lookup(int qkey, bool keypad);
 
-  typedef QMap<Qt::Key, SoKeyboardEvent::Key> KeyMap;
-  static KeyMap * keyboardmap;
-  static KeyMap * keypadmap;
+  struct KeyMapping {
+    Qt::Key qkey;
+    SoKeyboardEvent::Key sokey;
+  };
+
+  static const KeyMapping keyboardmappings[];
+  static const int numkeyboardmappings;
+  static const KeyMapping keypadmappings[];
+  static const int numkeypadmappings;
+
+  // One slot for every Latin-1 key code, followed by one slot for
+  // every code in the Qt::Key_Escape (0x01000000) function key range
+  enum { TABLE_RANGE = 0x100, TABLE_SIZE = 2 * TABLE_RANGE };
+  static SoKeyboardEvent::Key keyboardtable[TABLE_SIZE];
+  static SoKeyboardEvent::Key keypadtable[TABLE_SIZE];
+  static bool tablesinitialized;
 
   SoKeyboardEvent * keyboard;
   Keyboard * publ;
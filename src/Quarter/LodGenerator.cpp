@@ -0,0 +1,1312 @@
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+/*!
+  \class SIM::Coin3D::Quarter::LodGenerator LodGenerator.h Quarter/LodGenerator.h
+
+  \brief The LodGenerator class builds levels of detail for heavy
+  shapes in the background.
+
+  start() looks for shapes in a scene graph with at least
+  minimumTriangles() triangles. For each of them, numLevels()
+  decimated versions are built by quadric error edge collapse, each
+  with reduction() times the triangles of the one before. The shape
+  is replaced in its parent by an SoLOD holding the original as its
+  first child as soon as the first level is done. The other levels
+  are added to the SoLOD as they complete, and levelReady() is emitted
+  for each of them.
+
+  The switch distances are chosen so that a level is shown once its
+  triangles would cover about pixelsPerTriangle() pixels each at the
+  current size of the view, estimated from the bounding sphere of the
+  shape and the camera and viewport of the target QuarterWidget. With
+  a target whose interactive quality is enabled, the distances are
+  scaled by interactiveRangeScale() while the quality is reduced, so
+  that coarser levels are used during navigation.
+
+  The triangles of each shape are collected on the GUI thread, one
+  shape at a time while the application is idle. Decimation runs on a
+  worker thread of its own and does not touch the scene graph, which
+  is only changed on the GUI thread. Shapes with per part or per face
+  materials from the traversal state, textured shapes, shapes below
+  nodekits and shapes not held by an SoGroup are skipped. The levels
+  are SoIndexedFaceSet nodes with an SoVertexProperty. They take
+  their normals from the traversal state as the original did, or
+  generate their own if the original took normals from the state.
+*/
+
+#include <Quarter/LodGenerator.h>
+
+#include <math.h>
+#include <algorithm>
+
+#include <QtCore/QAtomicInt>
+#include <QtCore/QHash>
+#include <QtCore/QList>
+#include <QtCore/QMutex>
+#include <QtCore/QSet>
+#include <QtCore/QThread>
+#include <QtCore/QTimer>
+#include <QtCore/QVector>
+#include <QtCore/QWaitCondition>
+
+#include <Inventor/SbBox3f.h>
+#include <Inventor/SbMatrix.h>
+#include <Inventor/SbVec3d.h>
+#include <Inventor/SbVec2s.h>
+#include <Inventor/SbViewportRegion.h>
+#include <Inventor/SbXfBox3f.h>
+#include <Inventor/SoPath.h>
+#include <Inventor/SoPrimitiveVertex.h>
+#include <Inventor/SoRenderManager.h>
+#include <Inventor/actions/SoCallbackAction.h>
+#include <Inventor/actions/SoGetPrimitiveCountAction.h>
+#include <Inventor/actions/SoSearchAction.h>
+#include <Inventor/lists/SoPathList.h>
+#include <Inventor/nodekits/SoBaseKit.h>
+#include <Inventor/nodes/SoGroup.h>
+#include <Inventor/nodes/SoIndexedFaceSet.h>
+#include <Inventor/nodes/SoLOD.h>
+#include <Inventor/nodes/SoMaterialBinding.h>
+#include <Inventor/nodes/SoPerspectiveCamera.h>
+#include <Inventor/nodes/SoShape.h>
+#include <Inventor/nodes/SoVertexProperty.h>
+
+#include <Quarter/QuarterWidget.h>
+
+#include "RenderThread.h"
+#include "Trace.h"
+
+// the view size assumed without a target
+static const float DEFAULT_HEIGHT_ANGLE = 0.785398163f;
+static const float DEFAULT_VIEWPORT_HEIGHT = 1080.0f;
+// of the quadric simplification, see LodSimplifier::simplify()
+static const int MAX_ITERATIONS = 100;
+static const double AGGRESSIVENESS = 7.0;
+
+namespace SIM { namespace Coin3D { namespace Quarter {
+
+/*
+  A triangle mesh, with three indices per triangle.
+ */
+struct LodMesh {
+  QVector<SbVec3f> vertices;
+  QVector<int32_t> triangles;
+};
+
+/*
+  A shape to build levels for. The triangle corners are collected on
+  the GUI thread and handed to the worker, the rest stays on the GUI
+  thread.
+ */
+struct LodJob {
+  int id;
+  SoPath * path;
+  SoLOD * lod;
+  SbVec3f center;
+  float radius;
+  int triangles;
+  bool normals;
+  QVector<SbVec3f> corners;
+  QVector<float> ranges;
+};
+
+/*
+  A finished level, on its way from the worker to the GUI thread.
+ */
+struct LodLevel {
+  int job;
+  int level;
+  LodMesh mesh;
+  QVector<SbVec3f> normals;
+};
+
+/*
+  Quadric error edge collapse, after Garland and Heckbert, "Surface
+  Simplification Using Quadric Error Metrics". Instead of a priority
+  queue, the edges whose error is below a threshold growing with each
+  iteration are collapsed, which is much faster for large meshes and
+  gives about the same result.
+ */
+class LodSimplifier {
+public:
+  LodSimplifier(QAtomicInt & canceled) : canceled(canceled) { }
+
+  bool simplify(const LodMesh & in, int target, LodMesh & out);
+
+private:
+  // the symmetric 4x4 matrix a2 ab ac ad b2 bc bd c2 cd d2
+  struct Quadric {
+    double m[10];
+    void clear(void) { for (int i = 0; i < 10; i++) m[i] = 0.0; }
+    void addPlane(double a, double b, double c, double d) {
+      m[0] += a * a; m[1] += a * b; m[2] += a * c; m[3] += a * d;
+      m[4] += b * b; m[5] += b * c; m[6] += b * d;
+      m[7] += c * c; m[8] += c * d; m[9] += d * d;
+    }
+    void add(const Quadric & q) { for (int i = 0; i < 10; i++) m[i] += q.m[i]; }
+    double det(int a11, int a12, int a13, int a21, int a22, int a23,
+               int a31, int a32, int a33) const {
+      return m[a11] * m[a22] * m[a33] + m[a13] * m[a21] * m[a32] +
+        m[a12] * m[a23] * m[a31] - m[a13] * m[a22] * m[a31] -
+        m[a11] * m[a23] * m[a32] - m[a12] * m[a21] * m[a33];
+    }
+    double error(const SbVec3d & p) const {
+      const double x = p[0], y = p[1], z = p[2];
+      return m[0] * x * x + 2.0 * m[1] * x * y + 2.0 * m[2] * x * z + 2.0 * m[3] * x +
+        m[4] * y * y + 2.0 * m[5] * y * z + 2.0 * m[6] * y +
+        m[7] * z * z + 2.0 * m[8] * z + m[9];
+    }
+  };
+
+  struct Vertex {
+    SbVec3d p;
+    Quadric q;
+    int tstart;
+    int tcount;
+    bool border;
+  };
+
+  struct Triangle {
+    int v[3];
+    double error[4];
+    SbVec3d normal;
+    bool deleted;
+    bool dirty;
+  };
+
+  struct Ref {
+    int triangle;
+    int corner;
+  };
+
+  void updateMesh(int iteration);
+  void compact(LodMesh & out) const;
+  double edgeError(int v0, int v1, SbVec3d & result) const;
+  bool flipped(const SbVec3d & p, int i1, const Vertex & v0, QVector<bool> & deleted) const;
+  void updateTriangles(int i0, const Vertex & v, const QVector<bool> & deleted, int & numdeleted);
+
+  QAtomicInt & canceled;
+  QVector<Vertex> vertices;
+  QVector<Triangle> triangles;
+  QVector<Ref> refs;
+};
+
+/*
+  Decimates the meshes of the jobs it is given, one after the other,
+  and posts each level to the generator as it is done.
+ */
+class LodThread : public QThread {
+public:
+  LodThread(QObject * receiver, int levels, double reduction)
+    : receiver(receiver), levels(levels), reduction(reduction), done(false)
+  {
+  }
+
+  ~LodThread()
+  {
+    foreach (LodLevel * level, this->finished) delete level;
+  }
+
+  void addJob(int id, QVector<SbVec3f> & corners, bool normals);
+  void noMoreJobs(void);
+  void detach(void);
+  QList<LodLevel *> takeLevels(void);
+
+  QAtomicInt canceled;
+
+protected:
+  virtual void run(void);
+
+private:
+  struct Work {
+    int id;
+    bool normals;
+    QVector<SbVec3f> corners;
+  };
+
+  void decimate(Work & work);
+
+  QObject * receiver;
+  int levels;
+  double reduction;
+  QMutex mutex;
+  QWaitCondition wakeup;
+  QList<Work *> work;
+  bool done;
+  QList<LodLevel *> finished;
+};
+
+class LodGeneratorP {
+public:
+  LodGeneratorP(LodGenerator * master) {
+    this->master = master;
+    this->target = NULL;
+    this->minimumtriangles = 100000;
+    this->levels = 3;
+    this->reduction = 0.25;
+    this->pixelspertriangle = 2.0;
+    this->interactivescale = 0.5;
+    this->reduced = false;
+    this->thread = NULL;
+    this->numlevels = 0;
+    this->numlevelsdone = 0;
+  }
+
+  void abandon(void);
+  void releaseJobs(void);
+  bool collect(LodJob * job);
+  void insertLevel(LodLevel * level);
+  void applyRanges(LodJob * job);
+  void viewParameters(float & heightangle, float & height) const;
+
+  LodGenerator * master;
+  QuarterWidget * target;
+  int minimumtriangles;
+  int levels;
+  double reduction;
+  double pixelspertriangle;
+  double interactivescale;
+  bool reduced;
+  QTimer * collecttimer;
+  LodThread * thread;
+  QList<LodJob *> pending;
+  QHash<int, LodJob *> jobs;
+  int numlevels;
+  int numlevelsdone;
+};
+
+}}} // namespace
+
+#define PRIVATE(obj) obj->pimpl
+#define PUBLIC(obj) obj->master
+
+using namespace SIM::Coin3D::Quarter;
+
+/*
+  Sets up the vertices, triangles and references of the mesh. The
+  quadrics, errors and borders are only computed the first time, later
+  calls drop the deleted triangles.
+ */
+void
+LodSimplifier::updateMesh(int iteration)
+{
+  if (iteration > 0) {
+    int dst = 0;
+    for (int i = 0; i < this->triangles.size(); i++) {
+      if (!this->triangles[i].deleted) this->triangles[dst++] = this->triangles[i];
+    }
+    this->triangles.resize(dst);
+  }
+
+  if (iteration == 0) {
+    for (int i = 0; i < this->vertices.size(); i++) this->vertices[i].q.clear();
+    for (int i = 0; i < this->triangles.size(); i++) {
+      Triangle & t = this->triangles[i];
+      const SbVec3d & p0 = this->vertices[t.v[0]].p;
+      SbVec3d n = (this->vertices[t.v[1]].p - p0).cross(this->vertices[t.v[2]].p - p0);
+      n.normalize();
+      t.normal = n;
+      for (int j = 0; j < 3; j++) {
+        this->vertices[t.v[j]].q.addPlane(n[0], n[1], n[2], -n.dot(p0));
+      }
+    }
+    for (int i = 0; i < this->triangles.size(); i++) {
+      Triangle & t = this->triangles[i];
+      SbVec3d p;
+      for (int j = 0; j < 3; j++) t.error[j] = this->edgeError(t.v[j], t.v[(j + 1) % 3], p);
+      t.error[3] = SbMin(t.error[0], SbMin(t.error[1], t.error[2]));
+    }
+  }
+
+  for (int i = 0; i < this->vertices.size(); i++) {
+    this->vertices[i].tstart = 0;
+    this->vertices[i].tcount = 0;
+  }
+  for (int i = 0; i < this->triangles.size(); i++) {
+    for (int j = 0; j < 3; j++) this->vertices[this->triangles[i].v[j]].tcount++;
+  }
+  int start = 0;
+  for (int i = 0; i < this->vertices.size(); i++) {
+    this->vertices[i].tstart = start;
+    start += this->vertices[i].tcount;
+    this->vertices[i].tcount = 0;
+  }
+  this->refs.resize(this->triangles.size() * 3);
+  for (int i = 0; i < this->triangles.size(); i++) {
+    for (int j = 0; j < 3; j++) {
+      Vertex & v = this->vertices[this->triangles[i].v[j]];
+      Ref & r = this->refs[v.tstart + v.tcount++];
+      r.triangle = i;
+      r.corner = j;
+    }
+  }
+
+  if (iteration == 0) {
+    // a border edge belongs to one triangle only, so its vertices
+    // have a neighbour they share one triangle with
+    QVector<int> counts, ids;
+    for (int i = 0; i < this->vertices.size(); i++) this->vertices[i].border = false;
+    for (int i = 0; i < this->vertices.size(); i++) {
+      const Vertex & v = this->vertices[i];
+      counts.clear();
+      ids.clear();
+      for (int j = 0; j < v.tcount; j++) {
+        const Triangle & t = this->triangles[this->refs[v.tstart + j].triangle];
+        for (int k = 0; k < 3; k++) {
+          const int id = t.v[k];
+          const int pos = ids.indexOf(id);
+          if (pos < 0) {
+            ids.append(id);
+            counts.append(1);
+          }
+          else {
+            counts[pos]++;
+          }
+        }
+      }
+      for (int j = 0; j < ids.size(); j++) {
+        if (counts[j] == 1) {
+          this->vertices[i].border = true;
+          this->vertices[ids[j]].border = true;
+        }
+      }
+    }
+  }
+}
+
+/*
+  Returns the error of collapsing the edge from \a v0 to \a v1, and
+  the position of the collapsed vertex in \a result.
+ */
+double
+LodSimplifier::edgeError(int v0, int v1, SbVec3d & result) const
+{
+  Quadric q = this->vertices[v0].q;
+  q.add(this->vertices[v1].q);
+  const bool border = this->vertices[v0].border && this->vertices[v1].border;
+  const double det = q.det(0, 1, 2, 1, 4, 5, 2, 5, 7);
+  if (det != 0.0 && !border) {
+    // the position minimizing the error
+    result.setValue(-1.0 / det * q.det(1, 2, 3, 4, 5, 6, 5, 7, 8),
+                    1.0 / det * q.det(0, 2, 3, 1, 5, 6, 2, 7, 8),
+                    -1.0 / det * q.det(0, 1, 3, 1, 4, 6, 2, 5, 8));
+    return q.error(result);
+  }
+  const SbVec3d & p0 = this->vertices[v0].p;
+  const SbVec3d & p1 = this->vertices[v1].p;
+  const SbVec3d p2 = (p0 + p1) * 0.5;
+  const double e0 = q.error(p0);
+  const double e1 = q.error(p1);
+  const double e2 = q.error(p2);
+  const double error = SbMin(e0, SbMin(e1, e2));
+  if (error == e0) result = p0;
+  else if (error == e1) result = p1;
+  else result = p2;
+  return error;
+}
+
+/*
+  Returns true if moving \a v0 to \a p flips or degenerates one of its
+  triangles. The triangles shared with \a i1, which the collapse
+  removes, are marked in \a deleted.
+ */
+bool
+LodSimplifier::flipped(const SbVec3d & p, int i1, const Vertex & v0, QVector<bool> & deleted) const
+{
+  for (int k = 0; k < v0.tcount; k++) {
+    const Ref & r = this->refs[v0.tstart + k];
+    const Triangle & t = this->triangles[r.triangle];
+    if (t.deleted) continue;
+    const int id1 = t.v[(r.corner + 1) % 3];
+    const int id2 = t.v[(r.corner + 2) % 3];
+    if (id1 == i1 || id2 == i1) {
+      deleted[k] = true;
+      continue;
+    }
+    SbVec3d d1 = this->vertices[id1].p - p;
+    SbVec3d d2 = this->vertices[id2].p - p;
+    d1.normalize();
+    d2.normalize();
+    if (fabs(d1.dot(d2)) > 0.999) return true;
+    SbVec3d n = d1.cross(d2);
+    n.normalize();
+    deleted[k] = false;
+    if (n.dot(t.normal) < 0.2) return true;
+  }
+  return false;
+}
+
+/*
+  Points the triangles of \a v to \a i0 after a collapse, deletes the
+  ones marked in \a deleted, and appends references for the others.
+ */
+void
+LodSimplifier::updateTriangles(int i0, const Vertex & v, const QVector<bool> & deleted,
+                               int & numdeleted)
+{
+  SbVec3d p;
+  for (int k = 0; k < v.tcount; k++) {
+    const Ref r = this->refs[v.tstart + k];
+    Triangle & t = this->triangles[r.triangle];
+    if (t.deleted) continue;
+    if (deleted[k]) {
+      t.deleted = true;
+      numdeleted++;
+      continue;
+    }
+    t.v[r.corner] = i0;
+    t.dirty = true;
+    for (int j = 0; j < 3; j++) t.error[j] = this->edgeError(t.v[j], t.v[(j + 1) % 3], p);
+    t.error[3] = SbMin(t.error[0], SbMin(t.error[1], t.error[2]));
+    this->refs.append(r);
+  }
+}
+
+/*
+  Copies the remaining triangles, and the vertices they use, to \a out.
+ */
+void
+LodSimplifier::compact(LodMesh & out) const
+{
+  QVector<int> remap(this->vertices.size(), -1);
+  out.vertices.clear();
+  out.triangles.clear();
+  for (int i = 0; i < this->triangles.size(); i++) {
+    const Triangle & t = this->triangles[i];
+    if (t.deleted) continue;
+    for (int j = 0; j < 3; j++) {
+      int & index = remap[t.v[j]];
+      if (index < 0) {
+        index = out.vertices.size();
+        const SbVec3d & p = this->vertices[t.v[j]].p;
+        out.vertices.append(SbVec3f(float(p[0]), float(p[1]), float(p[2])));
+      }
+      out.triangles.append(index);
+    }
+  }
+}
+
+/*
+  Simplifies \a in until it has at most \a target triangles, or no
+  more edges can be collapsed. Returns false if cancelled.
+ */
+bool
+LodSimplifier::simplify(const LodMesh & in, int target, LodMesh & out)
+{
+  this->vertices.resize(in.vertices.size());
+  for (int i = 0; i < in.vertices.size(); i++) {
+    const SbVec3f & p = in.vertices[i];
+    this->vertices[i].p.setValue(p[0], p[1], p[2]);
+  }
+  const int numtriangles = in.triangles.size() / 3;
+  this->triangles.resize(numtriangles);
+  for (int i = 0; i < numtriangles; i++) {
+    Triangle & t = this->triangles[i];
+    for (int j = 0; j < 3; j++) t.v[j] = in.triangles[i * 3 + j];
+    t.deleted = false;
+    t.dirty = false;
+  }
+
+  int numdeleted = 0;
+  QVector<bool> deleted0, deleted1;
+  for (int iteration = 0; iteration < MAX_ITERATIONS; iteration++) {
+    if (numtriangles - numdeleted <= target) break;
+    if (this->canceled.fetchAndAddRelaxed(0)) return false;
+    if (iteration % 5 == 0) this->updateMesh(iteration);
+    for (int i = 0; i < this->triangles.size(); i++) this->triangles[i].dirty = false;
+
+    // the error allowed grows with each iteration
+    const double threshold = 0.000000001 * pow(double(iteration + 3), AGGRESSIVENESS);
+    for (int i = 0; i < this->triangles.size(); i++) {
+      Triangle & t = this->triangles[i];
+      if (t.error[3] > threshold || t.deleted || t.dirty) continue;
+      for (int j = 0; j < 3; j++) {
+        if (t.error[j] > threshold) continue;
+        const int i0 = t.v[j];
+        const int i1 = t.v[(j + 1) % 3];
+        Vertex & v0 = this->vertices[i0];
+        Vertex & v1 = this->vertices[i1];
+        if (v0.border != v1.border) continue;
+
+        SbVec3d p;
+        this->edgeError(i0, i1, p);
+        deleted0.resize(v0.tcount);
+        deleted1.resize(v1.tcount);
+        if (this->flipped(p, i1, v0, deleted0)) continue;
+        if (this->flipped(p, i0, v1, deleted1)) continue;
+
+        v0.p = p;
+        v0.q.add(v1.q);
+        const int tstart = this->refs.size();
+        this->updateTriangles(i0, v0, deleted0, numdeleted);
+        this->updateTriangles(i0, v1, deleted1, numdeleted);
+        const int tcount = this->refs.size() - tstart;
+        if (tcount <= v0.tcount) {
+          // reuse the references of v0
+          for (int k = 0; k < tcount; k++) {
+            this->refs[v0.tstart + k] = this->refs[tstart + k];
+          }
+          this->refs.resize(tstart);
+        }
+        else {
+          v0.tstart = tstart;
+        }
+        v0.tcount = tcount;
+        break;
+      }
+      if (numtriangles - numdeleted <= target) break;
+    }
+  }
+  this->compact(out);
+  this->vertices.clear();
+  this->triangles.clear();
+  this->refs.clear();
+  return true;
+}
+
+// orders corner indices by the position of the corners
+struct CornerLess {
+  const QVector<SbVec3f> & corners;
+  CornerLess(const QVector<SbVec3f> & corners) : corners(corners) { }
+  bool operator()(int a, int b) const {
+    const SbVec3f & pa = this->corners[a];
+    const SbVec3f & pb = this->corners[b];
+    if (pa[0] != pb[0]) return pa[0] < pb[0];
+    if (pa[1] != pb[1]) return pa[1] < pb[1];
+    return pa[2] < pb[2];
+  }
+};
+
+/*
+  Builds an indexed mesh from triangle corners, sharing the corners
+  at the same position and dropping degenerate triangles.
+ */
+static void
+weld_corners(const QVector<SbVec3f> & corners, LodMesh & mesh)
+{
+  QVector<int> order(corners.size());
+  for (int i = 0; i < order.size(); i++) order[i] = i;
+  std::sort(order.begin(), order.end(), CornerLess(corners));
+
+  QVector<int32_t> index(corners.size());
+  mesh.vertices.clear();
+  for (int i = 0; i < order.size(); i++) {
+    if (i == 0 || corners[order[i]] != corners[order[i - 1]]) {
+      mesh.vertices.append(corners[order[i]]);
+    }
+    index[order[i]] = mesh.vertices.size() - 1;
+  }
+  mesh.triangles.clear();
+  mesh.triangles.reserve(corners.size());
+  for (int i = 0; i + 2 < index.size(); i += 3) {
+    if (index[i] == index[i + 1] || index[i] == index[i + 2] || index[i + 1] == index[i + 2]) {
+      continue;
+    }
+    mesh.triangles.append(index[i]);
+    mesh.triangles.append(index[i + 1]);
+    mesh.triangles.append(index[i + 2]);
+  }
+}
+
+/*
+  Computes area weighted vertex normals for \a mesh.
+ */
+static void
+vertex_normals(const LodMesh & mesh, QVector<SbVec3f> & normals)
+{
+  normals.fill(SbVec3f(0.0f, 0.0f, 0.0f), mesh.vertices.size());
+  for (int i = 0; i + 2 < mesh.triangles.size(); i += 3) {
+    const SbVec3f & p0 = mesh.vertices[mesh.triangles[i]];
+    const SbVec3f n = (mesh.vertices[mesh.triangles[i + 1]] - p0).cross(
+      mesh.vertices[mesh.triangles[i + 2]] - p0);
+    for (int j = 0; j < 3; j++) normals[mesh.triangles[i + j]] += n;
+  }
+  for (int i = 0; i < normals.size(); i++) {
+    if (normals[i].normalize() == 0.0f) normals[i].setValue(0.0f, 0.0f, 1.0f);
+  }
+}
+
+void
+LodThread::addJob(int id, QVector<SbVec3f> & corners, bool normals)
+{
+  Work * w = new Work;
+  w->id = id;
+  w->normals = normals;
+  w->corners.swap(corners);
+  QMutexLocker locker(&this->mutex);
+  this->work.append(w);
+  this->wakeup.wakeOne();
+}
+
+/*
+  Lets the thread end once it has done the jobs it has.
+ */
+void
+LodThread::noMoreJobs(void)
+{
+  QMutexLocker locker(&this->mutex);
+  this->done = true;
+  this->wakeup.wakeOne();
+}
+
+/*
+  Stops posting levels, for when the generator is about to go away.
+ */
+void
+LodThread::detach(void)
+{
+  QMutexLocker locker(&this->mutex);
+  this->receiver = NULL;
+}
+
+QList<LodLevel *>
+LodThread::takeLevels(void)
+{
+  QMutexLocker locker(&this->mutex);
+  QList<LodLevel *> ret;
+  ret.swap(this->finished);
+  return ret;
+}
+
+void
+LodThread::run(void)
+{
+  while (!this->canceled.fetchAndAddRelaxed(0)) {
+    Work * w = NULL;
+    {
+      QMutexLocker locker(&this->mutex);
+      while (this->work.isEmpty() && !this->done && !this->canceled.fetchAndAddRelaxed(0)) {
+        this->wakeup.wait(&this->mutex, 100);
+      }
+      if (this->work.isEmpty()) break;
+      w = this->work.takeFirst();
+    }
+    this->decimate(*w);
+    delete w;
+  }
+  QMutexLocker locker(&this->mutex);
+  foreach (Work * w, this->work) delete w;
+  this->work.clear();
+}
+
+void
+LodThread::decimate(Work & work)
+{
+  QUARTER_TRACE_SCOPE("LodGenerator::decimate");
+  LodMesh mesh;
+  weld_corners(work.corners, mesh);
+  work.corners = QVector<SbVec3f>();
+  const int numtriangles = mesh.triangles.size() / 3;
+
+  LodSimplifier simplifier(this->canceled);
+  for (int level = 1; level <= this->levels; level++) {
+    const int target = int(double(numtriangles) * pow(this->reduction, level));
+    LodLevel * result = new LodLevel;
+    result->job = work.id;
+    result->level = level;
+    // each level is simplified from the one before
+    if (target < 4 || !simplifier.simplify(mesh, target, result->mesh) ||
+        result->mesh.triangles.isEmpty()) {
+      delete result;
+      return;
+    }
+    mesh = result->mesh;
+    if (work.normals) vertex_normals(result->mesh, result->normals);
+    QMutexLocker locker(&this->mutex);
+    this->finished.append(result);
+    if (this->receiver) {
+      QMetaObject::invokeMethod(this->receiver, "levelsFinished", Qt::QueuedConnection);
+    }
+  }
+}
+
+namespace {
+
+// what the callback action finds out about the shape being collected
+struct LodGather {
+  SoNode * shape;
+  bool active;
+  bool ok;
+  int numnormals;
+  SbMatrix matrix;
+  QVector<SbVec3f> * corners;
+};
+
+}
+
+static bool
+uniform_material(SoCallbackAction * action)
+{
+  SbVec2s size(0, 0);
+  int numcomponents = 0;
+  const bool textured = action->getTextureImage(size, numcomponents) != NULL &&
+    size[0] > 0 && size[1] > 0;
+  return !textured && action->getMaterialBinding() == SoMaterialBinding::OVERALL;
+}
+
+static SoCallbackAction::Response
+gather_pre_cb(void * closure, SoCallbackAction * action, const SoNode * node)
+{
+  LodGather * gather = static_cast<LodGather *>(closure);
+  if (node != gather->shape) return SoCallbackAction::CONTINUE;
+  gather->active = true;
+  gather->ok = uniform_material(action);
+  gather->numnormals = action->getNumNormals();
+  gather->matrix = action->getModelMatrix();
+  return SoCallbackAction::CONTINUE;
+}
+
+static SoCallbackAction::Response
+gather_post_cb(void * closure, SoCallbackAction *, const SoNode * node)
+{
+  LodGather * gather = static_cast<LodGather *>(closure);
+  if (node == gather->shape) gather->active = false;
+  return SoCallbackAction::CONTINUE;
+}
+
+static void
+gather_triangle_cb(void * closure, SoCallbackAction * action, const SoPrimitiveVertex * v1,
+                   const SoPrimitiveVertex * v2, const SoPrimitiveVertex * v3)
+{
+  LodGather * gather = static_cast<LodGather *>(closure);
+  if (!gather->active || !gather->ok) return;
+  if (gather->corners->isEmpty() && !uniform_material(action)) {
+    // colors or texture coordinates from the shape's own vertex
+    // property, which the levels would not have
+    gather->ok = false;
+    return;
+  }
+  gather->corners->append(v1->getPoint());
+  gather->corners->append(v2->getPoint());
+  gather->corners->append(v3->getPoint());
+}
+
+/*
+  Collects the triangles of the job's shape, in object space, and the
+  bounding sphere. Returns false if levels cannot be made for it.
+ */
+bool
+LodGeneratorP::collect(LodJob * job)
+{
+  QUARTER_TRACE_SCOPE("LodGenerator::collect");
+  LodGather gather;
+  gather.shape = job->path->getTail();
+  gather.active = false;
+  gather.ok = false;
+  gather.numnormals = 0;
+  gather.corners = &job->corners;
+
+  SoCallbackAction action;
+  action.addPreCallback(SoShape::getClassTypeId(), gather_pre_cb, &gather);
+  action.addPostCallback(SoShape::getClassTypeId(), gather_post_cb, &gather);
+  action.addTriangleCallback(SoShape::getClassTypeId(), gather_triangle_cb, &gather);
+  action.apply(job->path);
+  if (!gather.ok || job->corners.isEmpty()) {
+    job->corners = QVector<SbVec3f>();
+    return false;
+  }
+
+  // the levels must not pick up normals meant for the original
+  job->normals = gather.numnormals > 0;
+  SbBox3f box;
+  for (int i = 0; i < job->corners.size(); i++) box.extendBy(job->corners[i]);
+  job->center = box.getCenter();
+  SbXfBox3f xfbox(box);
+  xfbox.transform(gather.matrix);
+  const SbBox3f worldbox = xfbox.project();
+  float dx, dy, dz;
+  worldbox.getSize(dx, dy, dz);
+  job->radius = 0.5f * sqrtf(dx * dx + dy * dy + dz * dz);
+  return true;
+}
+
+/*
+  The vertical field of view and the viewport height in pixels of the
+  target, which the switch distances are computed for.
+ */
+void
+LodGeneratorP::viewParameters(float & heightangle, float & height) const
+{
+  heightangle = DEFAULT_HEIGHT_ANGLE;
+  height = DEFAULT_VIEWPORT_HEIGHT;
+  SoRenderManager * manager = this->target ? this->target->getSoRenderManager() : NULL;
+  if (!manager) return;
+  SoCamera * camera = manager->getCamera();
+  if (camera && camera->isOfType(SoPerspectiveCamera::getClassTypeId())) {
+    heightangle = static_cast<SoPerspectiveCamera *>(camera)->heightAngle.getValue();
+  }
+  const short pixels = manager->getViewportRegion().getViewportSizePixels()[1];
+  if (pixels > 0) height = float(pixels);
+}
+
+void
+LodGeneratorP::applyRanges(LodJob * job)
+{
+  if (!job->lod) return;
+  const float scale = this->reduced ? float(this->interactivescale) : 1.0f;
+  QVector<float> ranges(job->ranges.size());
+  for (int i = 0; i < ranges.size(); i++) ranges[i] = job->ranges[i] * scale;
+  job->lod->range.setValues(0, ranges.size(), ranges.constData());
+  job->lod->range.setNum(ranges.size());
+}
+
+/*
+  Adds a finished level to the SoLOD of its shape, replacing the shape
+  with an SoLOD first if this is the first level.
+ */
+void
+LodGeneratorP::insertLevel(LodLevel * level)
+{
+  LodJob * job = this->jobs.value(level->job);
+  if (!job) return;
+
+  const int numvertices = level->mesh.vertices.size();
+  const int numtriangles = level->mesh.triangles.size() / 3;
+  SoVertexProperty * vp = new SoVertexProperty;
+  vp->vertex.setValues(0, numvertices, level->mesh.vertices.constData());
+  if (!level->normals.isEmpty()) {
+    vp->normal.setValues(0, numvertices, level->normals.constData());
+    vp->normalBinding = SoVertexProperty::PER_VERTEX_INDEXED;
+  }
+  SoIndexedFaceSet * faceset = new SoIndexedFaceSet;
+  faceset->ref();
+  faceset->vertexProperty = vp;
+  faceset->coordIndex.setNum(numtriangles * 4);
+  int32_t * indices = faceset->coordIndex.startEditing();
+  for (int i = 0; i < numtriangles; i++) {
+    indices[i * 4] = level->mesh.triangles[i * 3];
+    indices[i * 4 + 1] = level->mesh.triangles[i * 3 + 1];
+    indices[i * 4 + 2] = level->mesh.triangles[i * 3 + 2];
+    indices[i * 4 + 3] = -1;
+  }
+  faceset->coordIndex.finishEditing();
+
+  // the previous level is detailed enough while the bounding sphere
+  // covers at most pixelspertriangle pixels per triangle of this one
+  float heightangle, height;
+  this->viewParameters(heightangle, height);
+  const double pixels = sqrt(this->pixelspertriangle * double(numtriangles));
+  const float distance =
+    float(double(job->radius) * double(height) / (tan(heightangle * 0.5) * pixels));
+
+  RenderThread::lockScene();
+  bool inserted = false;
+  if (!job->lod) {
+    SoNode * shape = job->path->getTail();
+    SoGroup * parent = static_cast<SoGroup *>(job->path->getNodeFromTail(1));
+    const int index = parent->findChild(shape);
+    // the shape may have been removed or moved meanwhile
+    if (index >= 0) {
+      job->lod = new SoLOD;
+      job->lod->ref();
+      job->lod->center = job->center;
+      job->lod->addChild(shape);
+      parent->replaceChild(index, job->lod);
+    }
+  }
+  if (job->lod && job->lod->getNumChildren() == level->level) {
+    job->lod->addChild(faceset);
+    // the distances must grow with the level
+    const float last = job->ranges.isEmpty() ? 0.0f : job->ranges.last();
+    job->ranges.append(SbMax(distance, last));
+    this->applyRanges(job);
+    inserted = true;
+  }
+  RenderThread::unlockScene();
+  faceset->unref();
+
+  if (inserted) emit PUBLIC(this)->levelReady(job->lod, level->level);
+}
+
+/*
+  Detaches from the worker thread, which cleans up after itself once
+  it is done. What has been inserted so far stays in the scene.
+ */
+void
+LodGeneratorP::abandon(void)
+{
+  this->collecttimer->stop();
+  if (!this->thread) return;
+
+  this->thread->canceled.fetchAndStoreRelaxed(1);
+  this->thread->detach();
+  this->thread->disconnect(PUBLIC(this));
+  PUBLIC(this)->connect(this->thread, SIGNAL(finished()), this->thread, SLOT(deleteLater()));
+  if (!this->thread->isRunning()) {
+    this->thread->deleteLater();
+  }
+  this->thread = NULL;
+}
+
+void
+LodGeneratorP::releaseJobs(void)
+{
+  foreach (LodJob * job, this->pending) {
+    job->path->unref();
+    delete job;
+  }
+  this->pending.clear();
+  foreach (LodJob * job, this->jobs) {
+    job->path->unref();
+    if (job->lod) job->lod->unref();
+    delete job;
+  }
+  this->jobs.clear();
+}
+
+/*!
+  Constructor.
+*/
+LodGenerator::LodGenerator(QObject * parent)
+  : QObject(parent)
+{
+  PRIVATE(this) = new LodGeneratorP(this);
+  // one shape is collected at a time while the application is idle
+  PRIVATE(this)->collecttimer = new QTimer(this);
+  PRIVATE(this)->collecttimer->setInterval(0);
+  this->connect(PRIVATE(this)->collecttimer, SIGNAL(timeout()), this, SLOT(collectNext()));
+}
+
+/*!
+  Destructor. Levels still being built are dropped, those already in
+  the scene stay there.
+*/
+LodGenerator::~LodGenerator()
+{
+  PRIVATE(this)->abandon();
+  PRIVATE(this)->releaseJobs();
+  delete PRIVATE(this);
+}
+
+/*!
+  Sets the QuarterWidget whose camera and viewport the switch
+  distances are computed for, and whose interactive quality is
+  followed. The default is none, in which case a 45 degree field of
+  view and a 1080 pixel high viewport are assumed.
+*/
+void
+LodGenerator::setTarget(QuarterWidget * target)
+{
+  if (PRIVATE(this)->target) {
+    PRIVATE(this)->target->disconnect(this);
+  }
+  PRIVATE(this)->target = target;
+  PRIVATE(this)->reduced = false;
+  if (target) {
+    this->connect(target, SIGNAL(interactiveQualityChanged(bool)),
+                  this, SLOT(interactiveQualityChanged(bool)));
+  }
+}
+
+/*!
+  Returns the target QuarterWidget.
+*/
+QuarterWidget *
+LodGenerator::target(void) const
+{
+  return PRIVATE(this)->target;
+}
+
+/*!
+  Sets the number of triangles a shape must have to get levels of
+  detail. The default is 100000.
+*/
+void
+LodGenerator::setMinimumTriangles(int count)
+{
+  PRIVATE(this)->minimumtriangles = SbMax(count, 1);
+}
+
+/*!
+  Returns the number of triangles a shape must have to get levels of
+  detail.
+*/
+int
+LodGenerator::minimumTriangles(void) const
+{
+  return PRIVATE(this)->minimumtriangles;
+}
+
+/*!
+  Sets the number of decimated levels built for each shape, used by
+  the next start(). The default is 3.
+*/
+void
+LodGenerator::setNumLevels(int levels)
+{
+  PRIVATE(this)->levels = SbMax(levels, 1);
+}
+
+/*!
+  Returns the number of decimated levels built for each shape.
+*/
+int
+LodGenerator::numLevels(void) const
+{
+  return PRIVATE(this)->levels;
+}
+
+/*!
+  Sets the fraction of the triangles of the previous level each level
+  keeps, used by the next start(). The default is 0.25.
+*/
+void
+LodGenerator::setReduction(double fraction)
+{
+  PRIVATE(this)->reduction = SbClamp(fraction, 0.01, 0.99);
+}
+
+/*!
+  Returns the fraction of the triangles of the previous level each
+  level keeps.
+*/
+double
+LodGenerator::reduction(void) const
+{
+  return PRIVATE(this)->reduction;
+}
+
+/*!
+  Sets the screen area, in pixels, a triangle of a level should cover
+  before the level is used. Lower values keep the detailed levels
+  longer. The default is 2.
+*/
+void
+LodGenerator::setPixelsPerTriangle(double pixels)
+{
+  PRIVATE(this)->pixelspertriangle = SbMax(pixels, 0.01);
+}
+
+/*!
+  Returns the screen area, in pixels, a triangle of a level should
+  cover before the level is used.
+*/
+double
+LodGenerator::pixelsPerTriangle(void) const
+{
+  return PRIVATE(this)->pixelspertriangle;
+}
+
+/*!
+  Sets the factor the switch distances are scaled by while the
+  target's interactive quality is reduced. The default is 0.5, which
+  switches to the coarser levels at half the distance.
+
+  \sa QuarterWidget::setInteractiveQualityEnabled()
+*/
+void
+LodGenerator::setInteractiveRangeScale(double scale)
+{
+  PRIVATE(this)->interactivescale = SbMax(scale, 0.0);
+  if (PRIVATE(this)->reduced) this->interactiveQualityChanged(true);
+}
+
+/*!
+  Returns the factor the switch distances are scaled by during
+  navigation.
+*/
+double
+LodGenerator::interactiveRangeScale(void) const
+{
+  return PRIVATE(this)->interactivescale;
+}
+
+/*!
+  Starts building levels of detail for the heavy shapes below \a
+  root, cancelling a run already in progress. Returns false if there
+  are no shapes with at least minimumTriangles() triangles.
+*/
+bool
+LodGenerator::start(SoNode * root)
+{
+  PRIVATE(this)->abandon();
+  PRIVATE(this)->releaseJobs();
+  if (!root) return false;
+
+  root->ref();
+  SoSearchAction sa;
+  sa.setType(SoShape::getClassTypeId());
+  sa.setInterest(SoSearchAction::ALL);
+  sa.setSearchingAll(TRUE);
+  sa.apply(root);
+  const SoPathList & paths = sa.getPaths();
+
+  QSet<SoNode *> seen;
+  SoGetPrimitiveCountAction countaction;
+  for (int i = 0; i < paths.getLength(); i++) {
+    SoPath * path = paths[i];
+    SoNode * shape = path->getTail();
+    if (seen.contains(shape) || path->getLength() < 2) continue;
+    seen.insert(shape);
+    SoNode * parent = path->getNodeFromTail(1);
+    if (!parent->isOfType(SoGroup::getClassTypeId()) ||
+        parent->isOfType(SoLOD::getClassTypeId())) {
+      continue;
+    }
+    bool inkit = false;
+    for (int j = 0; j < path->getLength() && !inkit; j++) {
+      inkit = path->getNode(j)->isOfType(SoBaseKit::getClassTypeId());
+    }
+    if (inkit) continue;
+    countaction.apply(path);
+    if (countaction.getTriangleCount() < PRIVATE(this)->minimumtriangles) continue;
+
+    LodJob * job = new LodJob;
+    job->id = PRIVATE(this)->pending.size();
+    job->path = path->copy();
+    job->path->ref();
+    job->lod = NULL;
+    job->radius = 0.0f;
+    job->triangles = countaction.getTriangleCount();
+    job->normals = false;
+    PRIVATE(this)->pending.append(job);
+  }
+  sa.reset();
+  root->unrefNoDelete();
+  if (PRIVATE(this)->pending.isEmpty()) return false;
+
+  PRIVATE(this)->numlevels = PRIVATE(this)->pending.size() * PRIVATE(this)->levels;
+  PRIVATE(this)->numlevelsdone = 0;
+  PRIVATE(this)->thread =
+    new LodThread(this, PRIVATE(this)->levels, PRIVATE(this)->reduction);
+  this->connect(PRIVATE(this)->thread, SIGNAL(finished()), this, SLOT(workerFinished()));
+  PRIVATE(this)->thread->start(QThread::LowPriority);
+  PRIVATE(this)->collecttimer->start();
+  return true;
+}
+
+/*!
+  Returns true while levels of detail are being built.
+*/
+bool
+LodGenerator::isRunning(void) const
+{
+  return PRIVATE(this)->thread != NULL;
+}
+
+/*!
+  Stops building levels of detail. The levels already inserted stay
+  in the scene, and neither levelReady() nor finished() is emitted
+  for the rest.
+*/
+void
+LodGenerator::cancel(void)
+{
+  PRIVATE(this)->abandon();
+}
+
+void
+LodGenerator::collectNext(void)
+{
+  if (!PRIVATE(this)->thread || PRIVATE(this)->pending.isEmpty()) {
+    PRIVATE(this)->collecttimer->stop();
+    if (PRIVATE(this)->thread) PRIVATE(this)->thread->noMoreJobs();
+    return;
+  }
+  LodJob * job = PRIVATE(this)->pending.takeFirst();
+  if (PRIVATE(this)->collect(job)) {
+    PRIVATE(this)->jobs.insert(job->id, job);
+    PRIVATE(this)->thread->addJob(job->id, job->corners, job->normals);
+  }
+  else {
+    job->path->unref();
+    delete job;
+    PRIVATE(this)->numlevels -= PRIVATE(this)->levels;
+  }
+  if (PRIVATE(this)->pending.isEmpty()) {
+    PRIVATE(this)->collecttimer->stop();
+    PRIVATE(this)->thread->noMoreJobs();
+  }
+}
+
+void
+LodGenerator::levelsFinished(void)
+{
+  if (!PRIVATE(this)->thread) return;
+  QList<LodLevel *> levels = PRIVATE(this)->thread->takeLevels();
+  foreach (LodLevel * level, levels) {
+    PRIVATE(this)->insertLevel(level);
+    PRIVATE(this)->numlevelsdone++;
+    delete level;
+  }
+  if (!levels.isEmpty() && PRIVATE(this)->numlevels > 0) {
+    emit this->progress(SbMin(double(PRIVATE(this)->numlevelsdone) /
+                              double(PRIVATE(this)->numlevels), 1.0));
+  }
+}
+
+void
+LodGenerator::workerFinished(void)
+{
+  LodThread * thread = PRIVATE(this)->thread;
+  if (!thread) return;
+  // finished() is emitted just before the thread actually ends
+  thread->wait();
+  this->levelsFinished();
+  PRIVATE(this)->thread = NULL;
+  delete thread;
+  emit this->progress(1.0);
+  emit this->finished();
+}
+
+void
+LodGenerator::interactiveQualityChanged(bool reduced)
+{
+  PRIVATE(this)->reduced = reduced;
+  RenderThread::lockScene();
+  foreach (LodJob * job, PRIVATE(this)->jobs) PRIVATE(this)->applyRanges(job);
+  RenderThread::unlockScene();
+}
+
+/*!
+  \fn void LodGenerator::levelReady(SoLOD * lod, int level)
+
+  Emitted on the GUI thread when \a level, counting from 1 for the
+  first decimated one, has been added to \a lod. The original shape
+  is the first child of \a lod.
+*/
+
+/*!
+  \fn void LodGenerator::progress(double fraction)
+
+  Emitted as levels are added, with the fraction of all levels done.
+*/
+
+/*!
+  \fn void LodGenerator::finished(void)
+
+  Emitted when all levels have been built.
+*/
+
+#undef PRIVATE
+#undef PUBLIC
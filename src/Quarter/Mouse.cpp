@@ -93,6 +93,18 @@ Mouse::~Mouse()
   delete PRIVATE(this);
 }
 
+/*! Returns the mouse, wheel and resize event types
+ */
+QList<QEvent::Type>
+Mouse::eventTypes(void) const
+{
+  QList<QEvent::Type> types;
+  types << QEvent::MouseMove << QEvent::MouseButtonPress
+        << QEvent::MouseButtonRelease << QEvent::MouseButtonDblClick
+        << QEvent::Wheel << QEvent::Resize;
+  return types;
+}
+
 /*! Translates from QMouseEvents to SoLocation2Events and
   SoMouseButtonEvents
  */
@@ -134,7 +146,7 @@ MouseP::mouseMoveEvent(QMouseEvent * event)
   assert(this->windowsize[1] != -1);
   SbVec2s pos(event->pos().x(), this->windowsize[1] - event->pos().y() - 1);
   // the following corrects for high-dpi displays (e.g., mac retina)
-  pos *= publ->quarter->devicePixelRatio();
+  pos *= PUBLIC(this)->devicepixelratio;
   this->location2->setPosition(pos);
   this->mousebutton->setPosition(pos);
   return this->location2;
@@ -150,7 +162,7 @@ MouseP::mouseWheelEvent(QWheelEvent * event)
   SbVec2s pos(event->pos().x(), PUBLIC(this)->windowsize[1] - event->pos().y() - 1);
 #endif
   // the following corrects for high-dpi displays (e.g., mac retina)
-  pos *= publ->quarter->devicePixelRatio();
+  pos *= PUBLIC(this)->devicepixelratio;
   this->location2->setPosition(pos);
   this->mousebutton->setPosition(pos);
 
@@ -186,7 +198,7 @@ MouseP::mouseButtonEvent(QMouseEvent * event)
   PUBLIC(this)->setModifiers(this->mousebutton, event);
   SbVec2s pos(event->pos().x(), PUBLIC(this)->windowsize[1] - event->pos().y() - 1);
   // the following corrects for high-dpi displays (e.g., mac retina)
-  pos *= publ->quarter->devicePixelRatio();
+  pos *= PUBLIC(this)->devicepixelratio;
   this->location2->setPosition(pos);
   this->mousebutton->setPosition(pos);
 
@@ -0,0 +1,393 @@
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+/*
+  Several views of the scene graph of a QuarterWidget, each with a
+  camera of its own, rendered into rectangles of the widget in one
+  paintGL(). Every viewport has a root of its own, with the headlight,
+  its camera and the scene graph, and an SoRenderManager and
+  SoEventManager for it. The render managers share the cache context
+  of the widget, so display lists and textures are built once for all
+  views, and they all schedule redraws of the widget, which processes
+  the delay queue once per frame. The render mode, transparency type
+  and clipping of the widget's render manager are applied to every
+  viewport.
+
+  Mouse events go to the viewport under the cursor, or to the one a
+  drag started in, and keyboard events to the viewport which got the
+  last mouse event. Each viewport runs its own instance of the
+  navigation file of the widget.
+ */
+
+#include "MultiViewport.h"
+
+#include <Inventor/SbColor4f.h>
+#include <Inventor/SoEventManager.h>
+#include <Inventor/SoRenderManager.h>
+#include <Inventor/actions/SoGLRenderAction.h>
+#include <Inventor/events/SoKeyboardEvent.h>
+#include <Inventor/events/SoLocation2Event.h>
+#include <Inventor/events/SoMouseButtonEvent.h>
+#include <Inventor/nodes/SoCamera.h>
+#include <Inventor/nodes/SoDirectionalLight.h>
+#include <Inventor/nodes/SoPerspectiveCamera.h>
+#include <Inventor/nodes/SoSeparator.h>
+#include <Inventor/scxml/SoScXMLStateMachine.h>
+#include <Inventor/system/gl.h>
+
+#include <Quarter/QuarterWidget.h>
+
+#include "BoundingBoxCache.h"
+#include "QuarterWidgetP.h"
+
+using namespace SIM::Coin3D::Quarter;
+
+MultiViewport::MultiViewport(QuarterWidgetP * quarterwidget)
+{
+  this->quarterwidget = quarterwidget;
+  this->scene = NULL;
+  this->grab = NULL;
+  this->focus = NULL;
+  this->buttonsdown = 0;
+}
+
+MultiViewport::~MultiViewport()
+{
+  this->clear();
+}
+
+/*
+  Adds a viewport covering \a rect, in coordinates normalized to the
+  widget size with the origin in the upper left corner. A perspective
+  camera showing the whole scene is created if \a camera is NULL.
+ */
+int
+MultiViewport::add(const QRectF & rect, SoCamera * camera)
+{
+  QuarterWidget * master = this->quarterwidget->master;
+  SoRenderManager * mainmanager = this->quarterwidget->sorendermanager;
+
+  Viewport * viewport = new Viewport;
+  viewport->rect = rect.normalized() & QRectF(0.0, 0.0, 1.0, 1.0);
+  viewport->camera = camera ? camera : new SoPerspectiveCamera;
+  viewport->camera->ref();
+
+  viewport->root = new SoSeparator;
+  viewport->root->ref();
+  viewport->root->addChild(this->quarterwidget->headlight);
+  viewport->root->addChild(viewport->camera);
+  if (this->scene) viewport->root->addChild(this->scene);
+
+  viewport->rendermanager = new SoRenderManager;
+  viewport->rendermanager->setRenderCallback(QuarterWidgetP::rendercb, master);
+  viewport->rendermanager->getGLRenderAction()->setCacheContext(master->getCacheContextId());
+  viewport->rendermanager->setSceneGraph(viewport->root);
+  viewport->rendermanager->setCamera(viewport->camera);
+  viewport->rendermanager->addPreRenderCallback(MultiViewport::prerendercb, viewport);
+  viewport->rendermanager->addPostRenderCallback(MultiViewport::postrendercb, viewport);
+  viewport->rendermanager->activate();
+
+  viewport->eventmanager = new SoEventManager;
+  viewport->eventmanager->setSceneGraph(viewport->root);
+  viewport->eventmanager->setCamera(viewport->camera);
+  viewport->eventmanager->setNavigationState(this->quarterwidget->soeventmanager->getNavigationState());
+
+  viewport->statemachine = NULL;
+  if (!master->navigationModeFile().isEmpty()) {
+    viewport->statemachine = QuarterWidgetP::loadNavigationFile(master->navigationModeFile());
+  }
+  if (viewport->statemachine) {
+    viewport->eventmanager->addSoScXMLStateMachine(viewport->statemachine);
+    viewport->statemachine->setSceneGraphRoot(viewport->root);
+    viewport->statemachine->setActiveCamera(viewport->camera);
+    viewport->statemachine->addStateChangeCallback(QuarterWidgetP::statechangecb, this->quarterwidget);
+    viewport->statemachine->initialize();
+  }
+
+  this->viewports.append(viewport);
+  this->updateRegions();
+  if (!camera) {
+    viewport->camera->viewAll(viewport->root, viewport->region);
+  }
+  mainmanager->scheduleRedraw();
+  return this->viewports.size() - 1;
+}
+
+void
+MultiViewport::remove(int index)
+{
+  if (index < 0 || index >= this->viewports.size()) return;
+  Viewport * viewport = this->viewports.takeAt(index);
+  if (this->grab == viewport) {
+    this->grab = NULL;
+    this->buttonsdown = 0;
+  }
+  if (this->focus == viewport) this->focus = NULL;
+
+  if (viewport->statemachine) {
+    viewport->statemachine->setSceneGraphRoot(NULL);
+    viewport->statemachine->setActiveCamera(NULL);
+    viewport->eventmanager->removeSoScXMLStateMachine(viewport->statemachine);
+    QuarterWidgetP::releaseNavigationFile(viewport->statemachine);
+  }
+  delete viewport->eventmanager;
+  viewport->rendermanager->setSceneGraph(NULL);
+  delete viewport->rendermanager;
+  viewport->root->unref();
+  viewport->camera->unref();
+  delete viewport;
+
+  if (this->quarterwidget->sorendermanager) {
+    this->quarterwidget->sorendermanager->scheduleRedraw();
+  }
+}
+
+void
+MultiViewport::clear(void)
+{
+  while (!this->viewports.isEmpty()) {
+    this->remove(this->viewports.size() - 1);
+  }
+}
+
+int
+MultiViewport::count(void) const
+{
+  return this->viewports.size();
+}
+
+SoCamera *
+MultiViewport::camera(int index) const
+{
+  if (index < 0 || index >= this->viewports.size()) return NULL;
+  return this->viewports[index]->camera;
+}
+
+void
+MultiViewport::setRect(int index, const QRectF & rect)
+{
+  if (index < 0 || index >= this->viewports.size()) return;
+  this->viewports[index]->rect = rect.normalized() & QRectF(0.0, 0.0, 1.0, 1.0);
+  this->quarterwidget->sorendermanager->scheduleRedraw();
+}
+
+QRectF
+MultiViewport::rect(int index) const
+{
+  if (index < 0 || index >= this->viewports.size()) return QRectF();
+  return this->viewports[index]->rect;
+}
+
+/*
+  Returns the index of the topmost viewport containing \a pos, in
+  pixels from the lower left corner, or -1. Later viewports are
+  rendered on top of earlier ones.
+ */
+int
+MultiViewport::viewportAt(const SbVec2s & pos) const
+{
+  for (int i = this->viewports.size() - 1; i >= 0; i--) {
+    const SbViewportRegion & region = this->viewports[i]->region;
+    const SbVec2s origin = region.getViewportOriginPixels();
+    const SbVec2s size = region.getViewportSizePixels();
+    if (pos[0] >= origin[0] && pos[0] < origin[0] + size[0] &&
+        pos[1] >= origin[1] && pos[1] < origin[1] + size[1]) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+/*
+  Called when the scene graph of the widget changes.
+ */
+void
+MultiViewport::setScene(SoNode * scene)
+{
+  this->scene = scene;
+  foreach (Viewport * viewport, this->viewports) {
+    SoSeparator * root = viewport->root;
+    while (root->getNumChildren() > 2) {
+      root->removeChild(2);
+    }
+    if (scene) root->addChild(scene);
+  }
+}
+
+void
+MultiViewport::reinitialize(void)
+{
+  foreach (Viewport * viewport, this->viewports) {
+    // the widget may have moved to the cache context of its share group
+    viewport->rendermanager->getGLRenderAction()->setCacheContext(this->quarterwidget->getCacheContextId());
+    viewport->rendermanager->reinitialize();
+  }
+}
+
+/*
+  Computes the pixel regions from the size of the widget's viewport,
+  which includes the device pixel ratio.
+ */
+void
+MultiViewport::updateRegions(void)
+{
+  const SbViewportRegion & window = this->quarterwidget->sorendermanager->getViewportRegion();
+  const SbVec2s size = window.getWindowSize();
+
+  foreach (Viewport * viewport, this->viewports) {
+    const QRectF & rect = viewport->rect;
+    const int left = qRound(rect.left() * size[0]);
+    const int right = qRound(rect.right() * size[0]);
+    const int bottom = qRound((1.0 - rect.bottom()) * size[1]);
+    const int top = qRound((1.0 - rect.top()) * size[1]);
+
+    SbViewportRegion region(size);
+    region.setViewportPixels(left, bottom, qMax(right - left, 1), qMax(top - bottom, 1));
+    if (region == viewport->region) continue;
+
+    viewport->region = region;
+    viewport->rendermanager->setViewportRegion(region);
+    viewport->eventmanager->setViewportRegion(region);
+  }
+}
+
+/*
+  Only changed settings are set, as setting them schedules a redraw.
+ */
+void
+MultiViewport::syncSettings(Viewport * viewport)
+{
+  SoRenderManager * mainmanager = this->quarterwidget->sorendermanager;
+  SoRenderManager * manager = viewport->rendermanager;
+
+  if (manager->getRenderMode() != mainmanager->getRenderMode()) {
+    manager->setRenderMode(mainmanager->getRenderMode());
+  }
+  if (manager->getAutoClipping() != mainmanager->getAutoClipping()) {
+    manager->setAutoClipping(mainmanager->getAutoClipping());
+  }
+  SoGLRenderAction * action = manager->getGLRenderAction();
+  SoGLRenderAction * mainaction = mainmanager->getGLRenderAction();
+  if (action->getTransparencyType() != mainaction->getTransparencyType()) {
+    action->setTransparencyType(mainaction->getTransparencyType());
+  }
+  const SoEventManager::NavigationState state =
+    this->quarterwidget->soeventmanager->getNavigationState();
+  if (viewport->eventmanager->getNavigationState() != state) {
+    viewport->eventmanager->setNavigationState(state);
+  }
+}
+
+/*
+  Renders all viewports. The window is cleared once, and the depth
+  buffer within each viewport, so that a viewport overlapping earlier
+  ones is drawn on top of them.
+ */
+void
+MultiViewport::render(bool clearwindow, bool clearzbuffer)
+{
+  this->updateRegions();
+
+  if (clearwindow) {
+    const SbColor4f bg = this->quarterwidget->sorendermanager->getBackgroundColor();
+    glClearColor(bg[0], bg[1], bg[2], bg[3]);
+    glClear(GL_COLOR_BUFFER_BIT);
+  }
+
+  foreach (Viewport * viewport, this->viewports) {
+    this->syncSettings(viewport);
+    if (clearzbuffer) {
+      const SbVec2s origin = viewport->region.getViewportOriginPixels();
+      const SbVec2s size = viewport->region.getViewportSizePixels();
+      glEnable(GL_SCISSOR_TEST);
+      glScissor(origin[0], origin[1], size[0], size[1]);
+      glClear(GL_DEPTH_BUFFER_BIT);
+      glDisable(GL_SCISSOR_TEST);
+    }
+    this->quarterwidget->boundingboxcache->setClippingPlanes(viewport->camera,
+                                                             viewport->rendermanager);
+    viewport->rendermanager->render(FALSE, FALSE);
+  }
+}
+
+/*
+  Routes \a event to the viewport it belongs to.
+ */
+bool
+MultiViewport::processEvent(const SoEvent * event)
+{
+  this->updateRegions();
+
+  Viewport * target = this->focus;
+  const bool keyboard = event->isOfType(SoKeyboardEvent::getClassTypeId());
+  if (!keyboard) {
+    if (this->grab) {
+      target = this->grab;
+    }
+    else {
+      const int index = this->viewportAt(event->getPosition());
+      target = (index >= 0) ? this->viewports[index] : NULL;
+    }
+  }
+
+  if (event->isOfType(SoMouseButtonEvent::getClassTypeId())) {
+    const SoMouseButtonEvent * button = static_cast<const SoMouseButtonEvent *>(event);
+    // the wheel only sends presses
+    if (button->getButton() >= SoMouseButtonEvent::BUTTON1 &&
+        button->getButton() <= SoMouseButtonEvent::BUTTON3) {
+      if (button->getState() == SoButtonEvent::DOWN) {
+        if (this->buttonsdown++ == 0) this->grab = target;
+      }
+      else if (this->buttonsdown > 0 && --this->buttonsdown == 0) {
+        this->grab = NULL;
+      }
+    }
+  }
+
+  if (!target) return false;
+  if (!keyboard) this->focus = target;
+  return target->eventmanager->processEvent(event);
+}
+
+void
+MultiViewport::prerendercb(void * userdata, SoRenderManager *)
+{
+  Viewport * viewport = static_cast<Viewport *>(userdata);
+  if (viewport->statemachine) viewport->statemachine->preGLRender();
+}
+
+void
+MultiViewport::postrendercb(void * userdata, SoRenderManager *)
+{
+  Viewport * viewport = static_cast<Viewport *>(userdata);
+  if (viewport->statemachine) viewport->statemachine->postGLRender();
+}
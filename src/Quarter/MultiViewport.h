@@ -0,0 +1,99 @@
+#ifndef QUARTER_MULTIVIEWPORT_H
+#define QUARTER_MULTIVIEWPORT_H
+
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+#include <QtCore/QList>
+#include <QtCore/QPoint>
+#include <QtCore/QRectF>
+#include <Inventor/SbViewportRegion.h>
+
+class SoCamera;
+class SoEvent;
+class SoEventManager;
+class SoNode;
+class SoRenderManager;
+class SoScXMLStateMachine;
+class SoSeparator;
+
+namespace SIM { namespace Coin3D { namespace Quarter {
+
+class QuarterWidgetP;
+
+class MultiViewport {
+public:
+  MultiViewport(QuarterWidgetP * quarterwidget);
+  ~MultiViewport();
+
+  int add(const QRectF & rect, SoCamera * camera);
+  void remove(int index);
+  void clear(void);
+  int count(void) const;
+
+  SoCamera * camera(int index) const;
+  void setRect(int index, const QRectF & rect);
+  QRectF rect(int index) const;
+  int viewportAt(const SbVec2s & pos) const;
+
+  void setScene(SoNode * scene);
+  void reinitialize(void);
+  void render(bool clearwindow, bool clearzbuffer);
+  bool processEvent(const SoEvent * event);
+
+private:
+  struct Viewport {
+    QRectF rect;
+    SbViewportRegion region;
+    SoCamera * camera;
+    SoSeparator * root;
+    SoRenderManager * rendermanager;
+    SoEventManager * eventmanager;
+    SoScXMLStateMachine * statemachine;
+  };
+
+  void updateRegions(void);
+  void syncSettings(Viewport * viewport);
+  static void prerendercb(void * userdata, SoRenderManager * manager);
+  static void postrendercb(void * userdata, SoRenderManager * manager);
+
+  QuarterWidgetP * quarterwidget;
+  QList<Viewport *> viewports;
+  SoNode * scene;
+  Viewport * grab;
+  Viewport * focus;
+  int buttonsdown;
+};
+
+}}} // namespace
+
+#endif // QUARTER_MULTIVIEWPORT_H
@@ -0,0 +1,445 @@
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+/*
+  Compiled examiner, plane and fly navigation for QuarterWidget. It
+  handles the mouse events directly instead of going through the
+  ScXML interpreter, and reports the same state names (idle, rotate,
+  pan, zoom, contextmenurequest) as the navigation files shipped with
+  Coin so that cursors and navigation quality keep working.
+ */
+
+#include "NativeNavigation.h"
+
+#include <math.h>
+
+#include <Inventor/SbPlane.h>
+#include <Inventor/SbViewVolume.h>
+#include <Inventor/SbViewportRegion.h>
+#include <Inventor/SoPickedPoint.h>
+#include <Inventor/SoRenderManager.h>
+#include <Inventor/actions/SoRayPickAction.h>
+#include <Inventor/events/SoLocation2Event.h>
+#include <Inventor/events/SoMouseButtonEvent.h>
+#include <Inventor/nodes/SoCamera.h>
+#include <Inventor/nodes/SoOrthographicCamera.h>
+
+#include <Quarter/QuarterWidget.h>
+
+using namespace SIM::Coin3D::Quarter;
+
+NativeNavigation::NativeNavigation(QuarterWidget * quarterwidget)
+{
+  this->quarterwidget = quarterwidget;
+  this->isenabled = false;
+  this->navmode = EXAMINER;
+  this->state = IDLE;
+  this->button1down = false;
+  this->button3down = false;
+  this->lastposition = SbVec2f(0.0f, 0.0f);
+  this->lastpixel = SbVec2s(0, 0);
+  this->statechangecb = NULL;
+  this->statechangeclosure = NULL;
+
+  this->statenames[IDLE] = SbName("idle");
+  this->statenames[ROTATE] = SbName("rotate");
+  this->statenames[PAN] = SbName("pan");
+  this->statenames[ZOOM] = SbName("zoom");
+}
+
+NativeNavigation::~NativeNavigation()
+{
+}
+
+void
+NativeNavigation::setEnabled(bool yes)
+{
+  if (!yes) this->reset();
+  this->isenabled = yes;
+}
+
+bool
+NativeNavigation::enabled(void) const
+{
+  return this->isenabled;
+}
+
+void
+NativeNavigation::setMode(Mode mode)
+{
+  this->reset();
+  this->navmode = mode;
+}
+
+NativeNavigation::Mode
+NativeNavigation::mode(void) const
+{
+  return this->navmode;
+}
+
+void
+NativeNavigation::setStateChangeCallback(StateChangeCB * cb, void * closure)
+{
+  this->statechangecb = cb;
+  this->statechangeclosure = closure;
+}
+
+/*
+  Returns true while a drag is in progress.
+ */
+bool
+NativeNavigation::active(void) const
+{
+  return this->state != IDLE;
+}
+
+/*
+  Returns true if the event was used for navigation.
+ */
+bool
+NativeNavigation::processEvent(const SoEvent * event)
+{
+  if (!this->isenabled || !event) return false;
+
+  if (event->isOfType(SoLocation2Event::getClassTypeId())) {
+    return this->locationEvent(static_cast<const SoLocation2Event *>(event));
+  }
+  if (event->isOfType(SoMouseButtonEvent::getClassTypeId())) {
+    return this->buttonEvent(static_cast<const SoMouseButtonEvent *>(event));
+  }
+  return false;
+}
+
+/*
+  Ends any drag in progress, e.g. when the widget loses focus.
+ */
+void
+NativeNavigation::reset(void)
+{
+  this->button1down = false;
+  this->button3down = false;
+  this->setState(IDLE);
+}
+
+bool
+NativeNavigation::locationEvent(const SoLocation2Event * event)
+{
+  const SbVec2f position = event->getNormalizedPosition(this->viewport());
+  const SbVec2f prev = this->lastposition;
+  this->lastposition = position;
+  this->lastpixel = event->getPosition();
+
+  SoCamera * camera = this->camera();
+  if (this->state == IDLE || !camera) return false;
+
+  switch (this->state) {
+  case ROTATE:
+    if (this->navmode == FLY) this->look(camera, prev, position);
+    else this->rotate(camera, prev, position);
+    break;
+  case PAN:
+    this->pan(camera, prev, position);
+    break;
+  case ZOOM:
+    // dragging downwards moves away from the scene, like examiner.xml
+    if (this->navmode == FLY) this->dolly(camera, (position[1] - prev[1]) * 4.0f);
+    else this->zoom(camera, (prev[1] - position[1]) * 4.0f);
+    break;
+  default:
+    break;
+  }
+  return true;
+}
+
+bool
+NativeNavigation::buttonEvent(const SoMouseButtonEvent * event)
+{
+  static const SbName contextmenurequest("contextmenurequest");
+
+  const bool down = event->getState() == SoButtonEvent::DOWN;
+  this->lastposition = event->getNormalizedPosition(this->viewport());
+  this->lastpixel = event->getPosition();
+
+  switch (event->getButton()) {
+  case SoMouseButtonEvent::BUTTON1:
+    this->button1down = down;
+    break;
+  case SoMouseButtonEvent::BUTTON3:
+    this->button3down = down;
+    break;
+  case SoMouseButtonEvent::BUTTON2:
+    if (!down || this->state != IDLE) return false;
+    if (this->statechangecb) {
+      this->statechangecb(this->statechangeclosure, contextmenurequest);
+    }
+    return true;
+  case SoMouseButtonEvent::BUTTON4:
+  case SoMouseButtonEvent::BUTTON5:
+    {
+      SoCamera * camera = this->camera();
+      if (!down || !camera) return false;
+      const float diff = (event->getButton() == SoMouseButtonEvent::BUTTON4) ? -0.1f : 0.1f;
+      if (this->navmode == FLY) this->dolly(camera, -diff);
+      else this->zoom(camera, diff);
+    }
+    return true;
+  default:
+    return false;
+  }
+
+  const State prevstate = this->state;
+  this->setState(this->dragState(event->wasShiftDown(), event->wasCtrlDown()));
+  return (this->state != IDLE) || (prevstate != IDLE);
+}
+
+/*
+  Maps the buttons currently held down to a navigation state. The
+  examiner bindings follow Coin's examiner.xml.
+ */
+NativeNavigation::State
+NativeNavigation::dragState(bool shift, bool ctrl) const
+{
+  if (this->button1down && this->button3down) return ZOOM;
+
+  switch (this->navmode) {
+  case EXAMINER:
+    if (this->button1down) return ctrl ? ZOOM : (shift ? PAN : ROTATE);
+    if (this->button3down) return ctrl ? ZOOM : PAN;
+    break;
+  case PLANE:
+    if (this->button1down) return ctrl ? ZOOM : PAN;
+    if (this->button3down) return ZOOM;
+    break;
+  case FLY:
+    if (this->button1down) return ctrl ? ZOOM : (shift ? PAN : ROTATE);
+    if (this->button3down) return PAN;
+    break;
+  }
+  return IDLE;
+}
+
+void
+NativeNavigation::setState(State state)
+{
+  if (state == this->state) return;
+  this->state = state;
+  if (this->statechangecb) {
+    this->statechangecb(this->statechangeclosure, this->statenames[state]);
+  }
+}
+
+SoCamera *
+NativeNavigation::camera(void) const
+{
+  return this->quarterwidget->getSoRenderManager()->getCamera();
+}
+
+const SbViewportRegion &
+NativeNavigation::viewport(void) const
+{
+  return this->quarterwidget->getSoRenderManager()->getViewportRegion();
+}
+
+/*
+  Orbits the camera around its focal point. Horizontal movement
+  rotates around the camera's up vector, vertical movement around its
+  right vector.
+ */
+void
+NativeNavigation::rotate(SoCamera * camera, const SbVec2f & prev, const SbVec2f & now)
+{
+  const SbVec2f diff = now - prev;
+  if (diff[0] == 0.0f && diff[1] == 0.0f) return;
+
+  const SbRotation orientation = camera->orientation.getValue();
+  SbVec3f direction, up, right;
+  orientation.multVec(SbVec3f(0.0f, 0.0f, -1.0f), direction);
+  orientation.multVec(SbVec3f(0.0f, 1.0f, 0.0f), up);
+  orientation.multVec(SbVec3f(1.0f, 0.0f, 0.0f), right);
+
+  const float focaldistance = camera->focalDistance.getValue();
+  const SbVec3f focalpoint = camera->position.getValue() + direction * focaldistance;
+
+  const SbRotation delta =
+    SbRotation(up, -diff[0] * float(M_PI)) * SbRotation(right, diff[1] * float(M_PI));
+  const SbRotation neworientation = orientation * delta;
+  neworientation.multVec(SbVec3f(0.0f, 0.0f, -1.0f), direction);
+
+  camera->orientation = neworientation;
+  camera->position = focalpoint - direction * focaldistance;
+}
+
+/*
+  Turns the camera in place, keeping the horizon level.
+ */
+void
+NativeNavigation::look(SoCamera * camera, const SbVec2f & prev, const SbVec2f & now)
+{
+  const SbVec2f diff = now - prev;
+  if (diff[0] == 0.0f && diff[1] == 0.0f) return;
+
+  const SbRotation orientation = camera->orientation.getValue();
+  SbVec3f right;
+  orientation.multVec(SbVec3f(1.0f, 0.0f, 0.0f), right);
+
+  const SbRotation delta =
+    SbRotation(right, diff[1] * float(M_PI) * 0.5f) *
+    SbRotation(SbVec3f(0.0f, 1.0f, 0.0f), -diff[0] * float(M_PI) * 0.5f);
+  camera->orientation = orientation * delta;
+}
+
+/*
+  Moves the camera in the plane through the focal point, so that the
+  point under the cursor follows the cursor.
+ */
+void
+NativeNavigation::pan(SoCamera * camera, const SbVec2f & prev, const SbVec2f & now)
+{
+  NativeNavigation::panCamera(camera, this->viewport().getViewportAspectRatio(), prev, now);
+}
+
+/*
+  Moves \a camera so that the point of the focal plane under the
+  normalized viewport position \a prev moves to \a now.
+ */
+void
+NativeNavigation::panCamera(SoCamera * camera, float aspectratio,
+                            const SbVec2f & prev, const SbVec2f & now)
+{
+  if (prev == now) return;
+
+  SbViewVolume volume = camera->getViewVolume(aspectratio);
+  SbPlane panplane = volume.getPlane(camera->focalDistance.getValue());
+
+  SbLine line;
+  SbVec3f current, previous;
+  volume.projectPointToLine(now, line);
+  panplane.intersect(line, current);
+  volume.projectPointToLine(prev, line);
+  panplane.intersect(line, previous);
+
+  camera->position = camera->position.getValue() - (current - previous);
+}
+
+/*
+  Zooms by moving a perspective camera towards or away from its focal
+  point, or by changing the height of an orthographic camera. A
+  positive \a diff zooms out.
+ */
+void
+NativeNavigation::zoom(SoCamera * camera, float diff)
+{
+  NativeNavigation::zoomCamera(camera, diff);
+}
+
+void
+NativeNavigation::zoomCamera(SoCamera * camera, float diff)
+{
+  const float multiplicator = float(exp(diff));
+
+  if (camera->isOfType(SoOrthographicCamera::getClassTypeId())) {
+    SoOrthographicCamera * ortho = static_cast<SoOrthographicCamera *>(camera);
+    ortho->height = ortho->height.getValue() * multiplicator;
+    return;
+  }
+
+  SbVec3f direction;
+  camera->orientation.getValue().multVec(SbVec3f(0.0f, 0.0f, -1.0f), direction);
+  const float focaldistance = camera->focalDistance.getValue();
+  const float newfocaldistance = focaldistance * multiplicator;
+  camera->position = camera->position.getValue() + direction * (focaldistance - newfocaldistance);
+  camera->focalDistance = newfocaldistance;
+}
+
+/*
+  Rotates the camera around its viewing direction, turning the view
+  counterclockwise on the screen by \a angle radians.
+ */
+void
+NativeNavigation::rollCamera(SoCamera * camera, float angle)
+{
+  if (angle == 0.0f) return;
+  const SbRotation orientation = camera->orientation.getValue();
+  SbVec3f direction;
+  orientation.multVec(SbVec3f(0.0f, 0.0f, -1.0f), direction);
+  camera->orientation = orientation * SbRotation(direction, angle);
+}
+
+/*
+  Moves the camera along its viewing direction by a fraction of the
+  focal distance, keeping the focal distance itself.
+ */
+void
+NativeNavigation::dolly(SoCamera * camera, float diff)
+{
+  SbVec3f direction;
+  camera->orientation.getValue().multVec(SbVec3f(0.0f, 0.0f, -1.0f), direction);
+  camera->position = camera->position.getValue() +
+    direction * (diff * camera->focalDistance.getValue());
+}
+
+bool
+NativeNavigation::viewAll(void)
+{
+  SoCamera * camera = this->camera();
+  SoNode * root = this->quarterwidget->getSoRenderManager()->getSceneGraph();
+  if (!this->isenabled || !camera || !root) return false;
+  camera->viewAll(root, this->viewport());
+  return true;
+}
+
+/*
+  Moves the camera halfway towards the point under the cursor and
+  makes it the new focal point.
+ */
+bool
+NativeNavigation::seek(void)
+{
+  SoCamera * camera = this->camera();
+  SoNode * root = this->quarterwidget->getSoRenderManager()->getSceneGraph();
+  if (!this->isenabled || !camera || !root) return false;
+
+  SoRayPickAction rpaction(this->viewport());
+  rpaction.setPoint(this->lastpixel);
+  rpaction.setRadius(2);
+  rpaction.apply(root);
+  const SoPickedPoint * picked = rpaction.getPickedPoint();
+  if (!picked) return true;
+
+  const SbVec3f point = picked->getPoint();
+  SbVec3f direction;
+  camera->orientation.getValue().multVec(SbVec3f(0.0f, 0.0f, -1.0f), direction);
+  const float distance = (point - camera->position.getValue()).length() * 0.5f;
+  camera->position = point - direction * distance;
+  camera->focalDistance = distance;
+  return true;
+}
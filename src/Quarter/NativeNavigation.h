@@ -0,0 +1,120 @@
+#ifndef QUARTER_NATIVENAVIGATION_H
+#define QUARTER_NATIVENAVIGATION_H
+
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+#include <Inventor/SbLinear.h>
+#include <Inventor/SbName.h>
+
+class SoCamera;
+class SoEvent;
+class SoLocation2Event;
+class SoMouseButtonEvent;
+class SbViewportRegion;
+
+namespace SIM { namespace Coin3D { namespace Quarter {
+
+class QuarterWidget;
+
+class NativeNavigation {
+public:
+  enum Mode {
+    EXAMINER,
+    PLANE,
+    FLY
+  };
+
+  typedef void StateChangeCB(void * closure, const SbName & state);
+
+  NativeNavigation(QuarterWidget * quarterwidget);
+  ~NativeNavigation();
+
+  void setEnabled(bool yes);
+  bool enabled(void) const;
+
+  void setMode(Mode mode);
+  Mode mode(void) const;
+
+  void setStateChangeCallback(StateChangeCB * cb, void * closure);
+
+  bool active(void) const;
+  bool processEvent(const SoEvent * event);
+  void reset(void);
+
+  bool viewAll(void);
+  bool seek(void);
+
+  static void panCamera(SoCamera * camera, float aspectratio,
+                        const SbVec2f & prev, const SbVec2f & now);
+  static void zoomCamera(SoCamera * camera, float diff);
+  static void rollCamera(SoCamera * camera, float angle);
+
+private:
+  enum State {
+    IDLE,
+    ROTATE,
+    PAN,
+    ZOOM,
+    NUM_STATES
+  };
+
+  bool locationEvent(const SoLocation2Event * event);
+  bool buttonEvent(const SoMouseButtonEvent * event);
+  State dragState(bool shift, bool ctrl) const;
+  void setState(State state);
+
+  SoCamera * camera(void) const;
+  const SbViewportRegion & viewport(void) const;
+
+  void rotate(SoCamera * camera, const SbVec2f & prev, const SbVec2f & now);
+  void look(SoCamera * camera, const SbVec2f & prev, const SbVec2f & now);
+  void pan(SoCamera * camera, const SbVec2f & prev, const SbVec2f & now);
+  void zoom(SoCamera * camera, float diff);
+  void dolly(SoCamera * camera, float diff);
+
+  QuarterWidget * quarterwidget;
+  bool isenabled;
+  Mode navmode;
+  State state;
+  bool button1down;
+  bool button3down;
+  SbVec2f lastposition;
+  SbVec2s lastpixel;
+  SbName statenames[NUM_STATES];
+  StateChangeCB * statechangecb;
+  void * statechangeclosure;
+};
+
+}}} // namespace
+
+#endif // QUARTER_NATIVENAVIGATION_H
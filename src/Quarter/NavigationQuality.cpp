@@ -0,0 +1,210 @@
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+/*
+  Lowers the rendering quality of a QuarterWidget while a navigation
+  state machine is in one of the interactive states (rotate, pan,
+  zoom, ...), and restores it when the machine returns to idle.
+ */
+
+#include "NavigationQuality.h"
+
+#include <Quarter/QuarterWidget.h>
+
+using namespace SIM::Coin3D::Quarter;
+
+NavigationQuality::NavigationQuality(QuarterWidget * quarterwidget)
+{
+  this->quarterwidget = quarterwidget;
+  this->isenabled = false;
+  this->isactive = false;
+  this->rendermode = SoRenderManager::BOUNDING_BOX;
+  this->transparencytype = SoGLRenderAction::SCREEN_DOOR;
+  this->fullrendermode = SoRenderManager::AS_IS;
+  this->fulltransparencytype = SoGLRenderAction::DELAYED_BLEND;
+
+  this->states.append(SbName("rotate"));
+  this->states.append(SbName("pan"));
+  this->states.append(SbName("zoom"));
+  this->states.append(SbName("dolly"));
+  this->states.append(SbName("spin"));
+}
+
+NavigationQuality::~NavigationQuality()
+{
+}
+
+void
+NavigationQuality::setEnabled(bool yes)
+{
+  this->isenabled = yes;
+  if (!yes && this->isactive) {
+    this->restore();
+  }
+}
+
+bool
+NavigationQuality::enabled(void) const
+{
+  return this->isenabled;
+}
+
+void
+NavigationQuality::setRenderMode(SoRenderManager::RenderMode mode)
+{
+  this->rendermode = mode;
+  if (this->isactive) {
+    this->reduce();
+  }
+}
+
+SoRenderManager::RenderMode
+NavigationQuality::renderMode(void) const
+{
+  return this->rendermode;
+}
+
+void
+NavigationQuality::setTransparencyType(SoGLRenderAction::TransparencyType type)
+{
+  this->transparencytype = type;
+  if (this->isactive) {
+    this->reduce();
+  }
+}
+
+SoGLRenderAction::TransparencyType
+NavigationQuality::transparencyType(void) const
+{
+  return this->transparencytype;
+}
+
+void
+NavigationQuality::setStateInteractive(const SbName & state, bool onoff)
+{
+  if (onoff && !this->states.contains(state)) {
+    this->states.append(state);
+  }
+  else if (!onoff) {
+    this->states.removeAll(state);
+  }
+}
+
+bool
+NavigationQuality::isStateInteractive(const SbName & state) const
+{
+  return this->states.contains(state);
+}
+
+/*
+  Called from QuarterWidgetP::statechangecb() for every state the
+  navigation state machine enters.
+ */
+void
+NavigationQuality::stateEntered(const SbName & state)
+{
+  static const SbName idle("idle");
+
+  if (!this->isenabled) return;
+
+  if (!this->isactive && this->states.contains(state)) {
+    SoRenderManager * manager = this->quarterwidget->getSoRenderManager();
+    this->fullrendermode = manager->getRenderMode();
+    this->fulltransparencytype = manager->getGLRenderAction()->getTransparencyType();
+    this->isactive = true;
+    this->reduce();
+  }
+  else if (this->isactive && state == idle) {
+    this->restore();
+  }
+}
+
+/*
+  Returns true while the reduced quality settings are in effect.
+ */
+bool
+NavigationQuality::active(void) const
+{
+  return this->isactive;
+}
+
+/*
+  The full quality settings are the ones restored when the
+  interaction ends. QuarterWidget updates these instead of the render
+  manager while the policy is active.
+ */
+void
+NavigationQuality::setFullRenderMode(SoRenderManager::RenderMode mode)
+{
+  this->fullrendermode = mode;
+}
+
+SoRenderManager::RenderMode
+NavigationQuality::fullRenderMode(void) const
+{
+  return this->fullrendermode;
+}
+
+void
+NavigationQuality::setFullTransparencyType(SoGLRenderAction::TransparencyType type)
+{
+  this->fulltransparencytype = type;
+}
+
+SoGLRenderAction::TransparencyType
+NavigationQuality::fullTransparencyType(void) const
+{
+  return this->fulltransparencytype;
+}
+
+/*
+  Restores full quality and schedules a refinement frame.
+ */
+void
+NavigationQuality::restore(void)
+{
+  this->isactive = false;
+
+  SoRenderManager * manager = this->quarterwidget->getSoRenderManager();
+  if (!manager) return;
+  manager->setRenderMode(this->fullrendermode);
+  manager->getGLRenderAction()->setTransparencyType(this->fulltransparencytype);
+  manager->scheduleRedraw();
+}
+
+void
+NavigationQuality::reduce(void)
+{
+  SoRenderManager * manager = this->quarterwidget->getSoRenderManager();
+  manager->setRenderMode(this->rendermode);
+  manager->getGLRenderAction()->setTransparencyType(this->transparencytype);
+}
@@ -0,0 +1,84 @@
+#ifndef QUARTER_NAVIGATIONQUALITY_H
+#define QUARTER_NAVIGATIONQUALITY_H
+
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+#include <QtCore/QList>
+#include <Inventor/SbName.h>
+#include <Inventor/SoRenderManager.h>
+#include <Inventor/actions/SoGLRenderAction.h>
+
+namespace SIM { namespace Coin3D { namespace Quarter {
+
+class QuarterWidget;
+
+class NavigationQuality {
+public:
+  NavigationQuality(QuarterWidget * quarterwidget);
+  ~NavigationQuality();
+
+  void setEnabled(bool yes);
+  bool enabled(void) const;
+
+  void setRenderMode(SoRenderManager::RenderMode mode);
+  SoRenderManager::RenderMode renderMode(void) const;
+  void setTransparencyType(SoGLRenderAction::TransparencyType type);
+  SoGLRenderAction::TransparencyType transparencyType(void) const;
+
+  void setStateInteractive(const SbName & state, bool onoff);
+  bool isStateInteractive(const SbName & state) const;
+
+  void stateEntered(const SbName & state);
+
+  bool active(void) const;
+  void setFullRenderMode(SoRenderManager::RenderMode mode);
+  SoRenderManager::RenderMode fullRenderMode(void) const;
+  void setFullTransparencyType(SoGLRenderAction::TransparencyType type);
+  SoGLRenderAction::TransparencyType fullTransparencyType(void) const;
+  void restore(void);
+
+private:
+  void reduce(void);
+
+  QuarterWidget * quarterwidget;
+  bool isenabled;
+  bool isactive;
+  QList<SbName> states;
+
+  SoRenderManager::RenderMode rendermode;
+  SoGLRenderAction::TransparencyType transparencytype;
+  SoRenderManager::RenderMode fullrendermode;
+  SoGLRenderAction::TransparencyType fulltransparencytype;
+};
+
+}}} // namespace
@@ -0,0 +1,135 @@
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+/*
+  Picks many screen points in one go by splitting them across a
+  thread pool. Each worker applies its own SoRayPickAction to the
+  scene graph. Concurrent traversals are only safe if Coin was built
+  thread safe, otherwise the points are picked one after the other.
+ */
+
+#include "ParallelPick.h"
+
+#include <QtCore/QRunnable>
+#include <QtCore/QThreadPool>
+
+#include <Inventor/C/basic.h>
+#include <Inventor/SbBasic.h>
+#include <Inventor/SbViewportRegion.h>
+#include <Inventor/SoPickedPoint.h>
+#include <Inventor/actions/SoRayPickAction.h>
+#include <Inventor/nodes/SoNode.h>
+
+using namespace SIM::Coin3D::Quarter;
+
+namespace SIM { namespace Coin3D { namespace Quarter {
+
+class PickTask : public QRunnable {
+public:
+  PickTask(SoNode * root, const SbViewportRegion & vp,
+           const SbVec2s * points, SoPickedPoint ** result,
+           int first, int last)
+    : root(root), vp(vp), points(points), result(result), first(first), last(last)
+  {
+  }
+
+  virtual void run(void)
+  {
+    SoRayPickAction rpa(this->vp);
+    for (int i = this->first; i < this->last; i++) {
+      rpa.setPoint(this->points[i]);
+      rpa.apply(this->root);
+      SoPickedPoint * point = rpa.getPickedPoint();
+      // each task writes to its own range of the result
+      this->result[i] = point ? point->copy() : NULL;
+    }
+  }
+
+private:
+  SoNode * root;
+  SbViewportRegion vp;
+  const SbVec2s * points;
+  SoPickedPoint ** result;
+  int first;
+  int last;
+};
+
+}}} // namespace
+
+// FIXME: static memory leak
+static QThreadPool * pickpool = NULL;
+
+// don't bother to spread less than this many points over a thread
+static const int MIN_POINTS_PER_TASK = 64;
+
+QVector<SoPickedPoint *>
+ParallelPick::pick(SoNode * root, const SbViewportRegion & vp,
+                   const QVector<QPoint> & points, qreal devicepixelratio)
+{
+  QVector<SoPickedPoint *> result(points.size(), NULL);
+  if (!root || points.isEmpty()) return result;
+
+  const SbVec2s vpsize = vp.getViewportSizePixels();
+  QVector<SbVec2s> pixels(points.size());
+  for (int i = 0; i < points.size(); i++) {
+    pixels[i] = SbVec2s(short(points[i].x() * devicepixelratio),
+                        short(vpsize[1] - 1 - points[i].y() * devicepixelratio));
+  }
+
+  // pick the first point on this thread. This builds the bounding box
+  // caches the workers would otherwise race to create.
+  SoPickedPoint ** resultdata = result.data();
+  PickTask(root, vp, pixels.constData(), resultdata, 0, 1).run();
+  if (points.size() == 1) return result;
+
+#ifdef COIN_THREADSAFE
+  if (!pickpool) {
+    pickpool = new QThreadPool;
+  }
+  const int remaining = points.size() - 1;
+  int numtasks = SbMin(pickpool->maxThreadCount(),
+                       (remaining + MIN_POINTS_PER_TASK - 1) / MIN_POINTS_PER_TASK);
+  numtasks = SbMax(numtasks, 1);
+
+  int first = 1;
+  for (int i = 0; i < numtasks; i++) {
+    int last = 1 + int((qint64(remaining) * (i + 1)) / numtasks);
+    pickpool->start(new PickTask(root, vp, pixels.constData(), resultdata, first, last));
+    first = last;
+  }
+  pickpool->waitForDone();
+#else
+  PickTask(root, vp, pixels.constData(), resultdata, 1, points.size()).run();
+#endif
+
+  return result;
+}
@@ -0,0 +1,347 @@
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+/*
+  An overlay with performance figures for diagnosing slow views: the
+  frame rate with a graph of recent frame times, the time spent in
+  the delay queue and in rendering on the CPU and the GPU, a histogram
+  of the input latency, primitive counts of the scene, pending sensors and the navigation state. It
+  is rendered as a superimposition of the widget's render manager,
+  and refreshed a few times a second.
+*/
+
+#include "PerformanceHud.h"
+#include "FrameTimer.h"
+#include "QuarterP.h"
+#include "SensorProfiler.h"
+
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+#include <QtCore/QTimer>
+
+#include <Inventor/SoDB.h>
+#include <Inventor/actions/SoGetPrimitiveCountAction.h>
+#include <Inventor/nodes/SoBaseColor.h>
+#include <Inventor/nodes/SoCoordinate3.h>
+#include <Inventor/nodes/SoFont.h>
+#include <Inventor/nodes/SoLightModel.h>
+#include <Inventor/nodes/SoLineSet.h>
+#include <Inventor/nodes/SoOrthographicCamera.h>
+#include <Inventor/nodes/SoSeparator.h>
+#include <Inventor/nodes/SoText2.h>
+#include <Inventor/nodes/SoTranslation.h>
+
+#include <Quarter/QuarterWidget.h>
+#include <Quarter/FrameStatistics.h>
+
+using namespace SIM::Coin3D::Quarter;
+
+namespace {
+  // the graph covers frame times from 0 to this many seconds
+  const double GRAPH_RANGE = 0.05;
+  const float GRAPH_LEFT = -0.95f;
+  const float GRAPH_WIDTH = 0.6f;
+  const float GRAPH_BOTTOM = -0.95f;
+  const float GRAPH_HEIGHT = 0.3f;
+  // the latency histogram has bins of LATENCY_BIN seconds, and sits
+  // to the right of the graph
+  const double LATENCY_BIN = 0.002;
+  const int LATENCY_BINS = 25;
+  const float HISTOGRAM_LEFT = -0.25f;
+  // primitive counts take a full traversal, so they are sampled less
+  // often than the rest
+  const double COUNT_INTERVAL = 2.0;
+}
+
+PerformanceHud::PerformanceHud(QuarterWidget * quarterwidget, FrameTimer * frametimer)
+  : QObject(quarterwidget),
+    quarterwidget(quarterwidget),
+    frametimer(frametimer),
+    enabled(false),
+    statisticswereenabled(false),
+    manager(NULL),
+    superimposition(NULL),
+    navigationstate(""),
+    lastframecount(0),
+    fps(0.0),
+    triangles(0),
+    lines(0),
+    points(0)
+{
+  this->timer = new QTimer(this);
+  this->timer->setInterval(250);
+  this->connect(this->timer, SIGNAL(timeout()), this, SLOT(update()));
+
+  // normalized coordinates, -1 to 1 in both directions
+  SoOrthographicCamera * camera = new SoOrthographicCamera;
+  camera->position = SbVec3f(0.0f, 0.0f, 1.0f);
+  camera->height = 2.0f;
+  camera->nearDistance = 0.5f;
+  camera->farDistance = 1.5f;
+  camera->viewportMapping = SoCamera::LEAVE_ALONE;
+
+  SoLightModel * lightmodel = new SoLightModel;
+  lightmodel->model = SoLightModel::BASE_COLOR;
+  SoBaseColor * color = new SoBaseColor;
+  color->rgb = SbColor(1.0f, 1.0f, 0.0f);
+
+  SoSeparator * textsep = new SoSeparator;
+  SoTranslation * textpos = new SoTranslation;
+  textpos->translation = SbVec3f(-0.95f, 0.9f, 0.0f);
+  SoFont * font = new SoFont;
+  font->size = 12.0f;
+  this->text = new SoText2;
+  textsep->addChild(textpos);
+  textsep->addChild(font);
+  textsep->addChild(this->text);
+
+  this->graphcoords = new SoCoordinate3;
+  this->graph = new SoLineSet;
+
+  SoSeparator * latencysep = new SoSeparator;
+  this->latencycoords = new SoCoordinate3;
+  this->latencybars = new SoLineSet;
+  latencysep->addChild(this->latencycoords);
+  latencysep->addChild(this->latencybars);
+
+  this->root = new SoSeparator;
+  this->root->ref();
+  this->root->addChild(camera);
+  this->root->addChild(lightmodel);
+  this->root->addChild(color);
+  this->root->addChild(textsep);
+  this->root->addChild(latencysep);
+  this->root->addChild(this->graphcoords);
+  this->root->addChild(this->graph);
+}
+
+PerformanceHud::~PerformanceHud()
+{
+  this->setEnabled(false);
+  this->root->unref();
+}
+
+void
+PerformanceHud::setEnabled(bool onoff)
+{
+  if (onoff == this->enabled) return;
+  this->enabled = onoff;
+
+  if (onoff) {
+    this->statisticswereenabled = this->frametimer->enabled();
+    this->frametimer->setEnabled(true);
+    this->manager = this->quarterwidget->getSoRenderManager();
+    this->superimposition = this->manager->addSuperimposition(this->root);
+    this->lastframecount = this->frametimer->frameCount();
+    this->lastupdate = SbTime::getTimeOfDay();
+    this->lastcount = SbTime::zero();
+    this->fps = 0.0;
+    this->update();
+    this->timer->start();
+  }
+  else {
+    this->timer->stop();
+    if (this->manager && this->superimposition) {
+      this->manager->removeSuperimposition(this->superimposition);
+      this->manager->scheduleRedraw();
+    }
+    this->manager = NULL;
+    this->superimposition = NULL;
+    this->frametimer->setEnabled(this->statisticswereenabled);
+  }
+}
+
+bool
+PerformanceHud::isEnabled(void) const
+{
+  return this->enabled;
+}
+
+/*
+  Called by the widget whenever the navigation state machine enters
+  a state.
+ */
+void
+PerformanceHud::stateEntered(const SbName & state)
+{
+  this->navigationstate = state;
+}
+
+void
+PerformanceHud::countPrimitives(void)
+{
+  SoNode * scene = this->quarterwidget->getSceneGraph();
+  if (!scene) {
+    this->triangles = this->lines = this->points = 0;
+    return;
+  }
+  SoGetPrimitiveCountAction action(this->quarterwidget->getSoRenderManager()->getViewportRegion());
+  action.apply(scene);
+  this->triangles = action.getTriangleCount();
+  this->lines = action.getLineCount();
+  this->points = action.getPointCount();
+}
+
+void
+PerformanceHud::updateGraph(void)
+{
+  const QVector<double> frametimes = this->frametimer->history(FrameStatistics::FRAME);
+  const int n = frametimes.size();
+
+  // the frame time graph, and a line at 60 Hz to compare with
+  const float y60 = GRAPH_BOTTOM + GRAPH_HEIGHT * float((1.0 / 60.0) / GRAPH_RANGE);
+  this->graphcoords->point.setNum(n + 2);
+  SbVec3f * coords = this->graphcoords->point.startEditing();
+  for (int i = 0; i < n; i++) {
+    const double t = SbMin(frametimes[i] / GRAPH_RANGE, 1.0);
+    coords[i].setValue(GRAPH_LEFT + GRAPH_WIDTH * float(i) / float(SbMax(n - 1, 1)),
+                       GRAPH_BOTTOM + GRAPH_HEIGHT * float(t), 0.0f);
+  }
+  coords[n].setValue(GRAPH_LEFT, y60, 0.0f);
+  coords[n + 1].setValue(GRAPH_LEFT + GRAPH_WIDTH, y60, 0.0f);
+  this->graphcoords->point.finishEditing();
+
+  if (n > 1) {
+    this->graph->numVertices.setNum(2);
+    this->graph->numVertices.set1Value(0, n);
+    this->graph->numVertices.set1Value(1, 2);
+    this->graph->startIndex = 0;
+  }
+  else {
+    this->graph->numVertices.setNum(1);
+    this->graph->numVertices.set1Value(0, 2);
+    this->graph->startIndex = n;
+  }
+}
+
+/*
+  One vertical bar per bin, scaled to the fullest bin, on a base line.
+ */
+void
+PerformanceHud::updateLatencyHistogram(void)
+{
+  const QVector<int> bins =
+    this->frametimer->histogram(FrameStatistics::INPUT_LATENCY, LATENCY_BIN, LATENCY_BINS);
+  int highest = 1;
+  for (int i = 0; i < bins.size(); i++) {
+    highest = SbMax(highest, bins[i]);
+  }
+
+  const float step = GRAPH_WIDTH / float(LATENCY_BINS);
+  this->latencycoords->point.setNum(2 * LATENCY_BINS + 2);
+  SbVec3f * coords = this->latencycoords->point.startEditing();
+  for (int i = 0; i < LATENCY_BINS; i++) {
+    const float x = HISTOGRAM_LEFT + step * (float(i) + 0.5f);
+    coords[2 * i].setValue(x, GRAPH_BOTTOM, 0.0f);
+    coords[2 * i + 1].setValue(x, GRAPH_BOTTOM + GRAPH_HEIGHT * float(bins[i]) / float(highest), 0.0f);
+  }
+  coords[2 * LATENCY_BINS].setValue(HISTOGRAM_LEFT, GRAPH_BOTTOM, 0.0f);
+  coords[2 * LATENCY_BINS + 1].setValue(HISTOGRAM_LEFT + GRAPH_WIDTH, GRAPH_BOTTOM, 0.0f);
+  this->latencycoords->point.finishEditing();
+
+  this->latencybars->numVertices.setNum(LATENCY_BINS + 1);
+  int32_t * numvertices = this->latencybars->numVertices.startEditing();
+  for (int i = 0; i <= LATENCY_BINS; i++) {
+    numvertices[i] = 2;
+  }
+  this->latencybars->numVertices.finishEditing();
+}
+
+void
+PerformanceHud::update(void)
+{
+  if (!this->enabled) return;
+
+  const SbTime now = SbTime::getTimeOfDay();
+  const unsigned long framecount = this->frametimer->frameCount();
+  const double elapsed = (now - this->lastupdate).getValue();
+  if (elapsed > 0.0) {
+    this->fps = double(framecount - this->lastframecount) / elapsed;
+  }
+  this->lastframecount = framecount;
+  this->lastupdate = now;
+
+  if ((now - this->lastcount).getValue() >= COUNT_INTERVAL) {
+    this->countPrimitives();
+    this->lastcount = now;
+  }
+
+  const FrameStatistics stats = this->frametimer->statistics();
+  QStringList text;
+  text << QString("FPS: %1  Frame: %2 ms (99%: %3 ms)")
+    .arg(this->fps, 0, 'f', 1)
+    .arg(stats.average(FrameStatistics::FRAME) * 1000.0, 0, 'f', 1)
+    .arg(stats.percentile99(FrameStatistics::FRAME) * 1000.0, 0, 'f', 1);
+  QString gpu("n/a");
+  if (stats.numFrames(FrameStatistics::GPU) > 0) {
+    gpu = QString("%1 ms").arg(stats.average(FrameStatistics::GPU) * 1000.0, 0, 'f', 2);
+  }
+  text << QString("Delay queue: %1 ms  Traversal: %2 ms  GPU: %3")
+    .arg(stats.average(FrameStatistics::DELAY_QUEUE) * 1000.0, 0, 'f', 2)
+    .arg(stats.average(FrameStatistics::RENDER) * 1000.0, 0, 'f', 2)
+    .arg(gpu);
+  QString latency("n/a");
+  if (stats.numFrames(FrameStatistics::INPUT_LATENCY) > 0) {
+    latency = QString("%1 ms (99%: %2 ms)")
+      .arg(stats.average(FrameStatistics::INPUT_LATENCY) * 1000.0, 0, 'f', 1)
+      .arg(stats.percentile99(FrameStatistics::INPUT_LATENCY) * 1000.0, 0, 'f', 1);
+  }
+  text << QString("Input latency: %1").arg(latency);
+  text << QString("Triangles: %1  Lines: %2  Points: %3")
+    .arg(this->triangles).arg(this->lines).arg(this->points);
+
+  // Coin only tells whether sensors are pending, not how many
+  SoSensorManager * sensormanager = SoDB::getSensorManager();
+  SbTime timeout;
+  QString timers("none");
+  if (sensormanager->isTimerSensorPending(timeout)) {
+    timers = QString("next in %1 ms").arg(SbMax((timeout - now).getValue() * 1000.0, 0.0), 0, 'f', 1);
+  }
+  text << QString("Delay sensors: %1  Timer sensors: %2")
+    .arg(sensormanager->isDelaySensorPending() ? "pending" : "none")
+    .arg(timers);
+  text << QString("Navigation: %1").arg(this->navigationstate.getString());
+  if (QuarterP::sensorprofiler && QuarterP::sensorprofiler->enabled()) {
+    text << QuarterP::sensorprofiler->profile().summary(3);
+  }
+
+  // one notification for the whole overlay
+  const SbBool notify = this->root->enableNotify(FALSE);
+  this->text->string.setNum(text.size());
+  for (int i = 0; i < text.size(); i++) {
+    this->text->string.set1Value(i, SbString(text[i].toLatin1().constData()));
+  }
+  this->updateGraph();
+  this->updateLatencyHistogram();
+  this->root->enableNotify(notify);
+  this->root->touch();
+}
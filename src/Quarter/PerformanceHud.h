@@ -0,0 +1,99 @@
+#ifndef QUARTER_PERFORMANCEHUD_H
+#define QUARTER_PERFORMANCEHUD_H
+
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+#include <QtCore/QObject>
+#include <Inventor/SbName.h>
+#include <Inventor/SbTime.h>
+#include <Inventor/SoRenderManager.h>
+
+class QTimer;
+class SoSeparator;
+class SoText2;
+class SoCoordinate3;
+class SoLineSet;
+
+namespace SIM { namespace Coin3D { namespace Quarter {
+
+class QuarterWidget;
+class FrameTimer;
+
+class PerformanceHud : public QObject {
+  Q_OBJECT
+public:
+  PerformanceHud(QuarterWidget * quarterwidget, FrameTimer * frametimer);
+  ~PerformanceHud();
+
+  void setEnabled(bool onoff);
+  bool isEnabled(void) const;
+
+  void stateEntered(const SbName & state);
+
+public slots:
+  void update(void);
+
+private:
+  void countPrimitives(void);
+  void updateGraph(void);
+  void updateLatencyHistogram(void);
+
+  QuarterWidget * quarterwidget;
+  FrameTimer * frametimer;
+  bool enabled;
+  bool statisticswereenabled;
+  QTimer * timer;
+
+  SoSeparator * root;
+  SoText2 * text;
+  SoCoordinate3 * graphcoords;
+  SoLineSet * graph;
+  SoCoordinate3 * latencycoords;
+  SoLineSet * latencybars;
+  SoRenderManager * manager;
+  SoRenderManager::Superimposition * superimposition;
+
+  SbName navigationstate;
+  unsigned long lastframecount;
+  SbTime lastupdate;
+  double fps;
+
+  SbTime lastcount;
+  int triangles;
+  int lines;
+  int points;
+};
+
+}}} // namespace
+
+#endif // QUARTER_PERFORMANCEHUD_H
@@ -0,0 +1,314 @@
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+/*
+  Renders the scene of a QuarterWidget into an offscreen buffer with
+  every shape drawn in a unique color, and reads the buffer back, so
+  that the shape under a given pixel can be looked up without
+  traversing the scene graph. The buffer is built on the first pick
+  after a change to the scene, the camera or the viewport, and reused
+  until the next change.
+
+  Falls back to SoRayPickAction if framebuffer objects are not
+  available.
+ */
+
+#include "PickBuffer.h"
+
+#if (QT_VERSION >= 0x050000)
+#  include <QOpenGLFramebufferObject>
+#endif
+
+#include <Inventor/SbViewportRegion.h>
+#include <Inventor/SoPath.h>
+#include <Inventor/SoPickedPoint.h>
+#include <Inventor/SoRenderManager.h>
+#include <Inventor/actions/SoGLRenderAction.h>
+#include <Inventor/actions/SoRayPickAction.h>
+#include <Inventor/actions/SoSubAction.h>
+#include <Inventor/elements/SoLazyElement.h>
+#include <Inventor/elements/SoLightModelElement.h>
+#include <Inventor/elements/SoMaterialBindingElement.h>
+#include <Inventor/elements/SoOverrideElement.h>
+#include <Inventor/elements/SoTextureEnabledElement.h>
+#include <Inventor/elements/SoTexture3EnabledElement.h>
+#include <Inventor/misc/SoState.h>
+#include <Inventor/nodes/SoSeparator.h>
+#include <Inventor/nodes/SoShape.h>
+#include <Inventor/system/gl.h>
+
+#include <Quarter/QuarterWidget.h>
+
+namespace SIM { namespace Coin3D { namespace Quarter {
+
+/*
+  Renders each shape with its index in the path list as a flat,
+  opaque color.
+ */
+class PickBufferAction : public SoGLRenderAction {
+  typedef SoGLRenderAction inherited;
+  SO_ACTION_HEADER(PickBufferAction);
+
+public:
+  static void initClass(void);
+
+  PickBufferAction(const SbViewportRegion & vp, SoPathList * paths);
+  virtual ~PickBufferAction();
+
+private:
+  static void shapeMethod(SoAction * action, SoNode * node);
+  static void separatorMethod(SoAction * action, SoNode * node);
+
+  SoPathList * paths;
+  uint32_t color;
+};
+
+SO_ACTION_SOURCE(PickBufferAction);
+
+}}} // namespace
+
+using namespace SIM::Coin3D::Quarter;
+
+void
+PickBufferAction::initClass(void)
+{
+  SO_ACTION_INIT_CLASS(PickBufferAction, SoGLRenderAction);
+
+  SO_ACTION_ADD_METHOD(SoShape, shapeMethod);
+  SO_ACTION_ADD_METHOD(SoSeparator, separatorMethod);
+}
+
+PickBufferAction::PickBufferAction(const SbViewportRegion & vp, SoPathList * paths)
+  : inherited(vp)
+{
+  SO_ACTION_CONSTRUCTOR(PickBufferAction);
+
+  this->paths = paths;
+  this->color = 0;
+  this->setTransparencyType(SoGLRenderAction::NONE);
+  this->setSmoothing(FALSE);
+  this->setNumPasses(1);
+}
+
+PickBufferAction::~PickBufferAction()
+{
+}
+
+void
+PickBufferAction::shapeMethod(SoAction * action, SoNode * node)
+{
+  PickBufferAction * thisp = static_cast<PickBufferAction *>(action);
+  SoState * state = action->getState();
+
+  thisp->paths->append(action->getCurPath()->copy());
+  // index 0 is the background
+  const uint32_t id = uint32_t(thisp->paths->getLength());
+  thisp->color = (id << 8) | 0xff;
+
+  state->push();
+  SoLazyElement::setPacked(state, node, 1, &thisp->color, TRUE);
+  SoOverrideElement::setDiffuseColorOverride(state, node, TRUE);
+  SoOverrideElement::setTransparencyOverride(state, node, TRUE);
+  SoMaterialBindingElement::set(state, node, SoMaterialBindingElement::OVERALL);
+  SoOverrideElement::setMaterialBindingOverride(state, node, TRUE);
+  SoLightModelElement::set(state, node, SoLightModelElement::BASE_COLOR);
+  SoOverrideElement::setLightModelOverride(state, node, TRUE);
+  SoTextureEnabledElement::set(state, node, FALSE);
+  SoTexture3EnabledElement::set(state, node, FALSE);
+  SoNode::GLRenderS(action, node);
+  state->pop();
+}
+
+/*
+  Traverses separators without using their render caches, which
+  would skip the shapes below them.
+ */
+void
+PickBufferAction::separatorMethod(SoAction * action, SoNode * node)
+{
+  static_cast<SoSeparator *>(node)->doAction(action);
+}
+
+PickBuffer::PickBuffer(QuarterWidget * quarterwidget)
+{
+  this->quarterwidget = quarterwidget;
+  this->action = NULL;
+  this->fbo = NULL;
+  this->valid = false;
+  this->raypath = NULL;
+}
+
+PickBuffer::~PickBuffer()
+{
+  if (this->raypath) this->raypath->unref();
+  delete this->action;
+}
+
+/*
+  Returns the path to the shape visible at \a pos, in widget
+  coordinates, or NULL if there is none.
+ */
+SoPath *
+PickBuffer::pick(const QPoint & pos)
+{
+  const qreal ratio = this->quarterwidget->devicePixelRatio();
+  const SbVec2s vpsize =
+    this->quarterwidget->getSoRenderManager()->getViewportRegion().getViewportSizePixels();
+  const int x = int(pos.x() * ratio);
+  const int y = vpsize[1] - 1 - int(pos.y() * ratio);
+  if (x < 0 || y < 0 || x >= vpsize[0] || y >= vpsize[1]) return NULL;
+
+  if (!this->useFramebuffer()) {
+    return this->rayPick(SbVec2s(short(x), short(y)));
+  }
+
+  if (!this->valid || this->size != vpsize) {
+    this->build();
+  }
+  if (!this->valid) return NULL;
+
+  const uint32_t id = this->ids[y * this->size[0] + x];
+  if (id == 0 || int(id) > this->paths.getLength()) return NULL;
+  return this->paths[int(id) - 1];
+}
+
+void
+PickBuffer::invalidate(void)
+{
+  this->valid = false;
+}
+
+bool
+PickBuffer::hasFramebuffer(void) const
+{
+  return this->fbo != NULL;
+}
+
+/*
+  Releases the framebuffer. Must be called with the widget's GL
+  context current.
+ */
+void
+PickBuffer::cleanup(void)
+{
+#if (QT_VERSION >= 0x050000)
+  delete this->fbo;
+#endif
+  this->fbo = NULL;
+  this->valid = false;
+}
+
+bool
+PickBuffer::useFramebuffer(void) const
+{
+#if (QT_VERSION >= 0x050000)
+  return QOpenGLFramebufferObject::hasOpenGLFramebufferObjects();
+#else
+  return false;
+#endif
+}
+
+void
+PickBuffer::build(void)
+{
+#if (QT_VERSION >= 0x050000)
+  SoRenderManager * manager = this->quarterwidget->getSoRenderManager();
+  SoNode * root = manager->getSceneGraph();
+  this->paths.truncate(0);
+  this->ids.clear();
+  if (!root) return;
+
+  if (PickBufferAction::getClassTypeId() == SoType::badType()) {
+    PickBufferAction::initClass();
+  }
+
+  const SbViewportRegion & vp = manager->getViewportRegion();
+  this->size = vp.getViewportSizePixels();
+  if (!this->action) {
+    this->action = new PickBufferAction(vp, &this->paths);
+    this->action->setCacheContext(this->quarterwidget->getCacheContextId());
+  }
+
+  this->quarterwidget->makeCurrent();
+
+  QSize fbosize(this->size[0], this->size[1]);
+  if (!this->fbo || this->fbo->size() != fbosize) {
+    delete this->fbo;
+    this->fbo = new QOpenGLFramebufferObject(fbosize, QOpenGLFramebufferObject::Depth);
+  }
+
+  this->fbo->bind();
+  // the colors must come out exactly as given
+  glDisable(GL_DITHER);
+  glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+  glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+  this->action->setViewportRegion(SbViewportRegion(this->size));
+  this->action->apply(root);
+
+  this->ids.resize(this->size[0] * this->size[1]);
+  glReadPixels(0, 0, this->size[0], this->size[1],
+               GL_RGBA, GL_UNSIGNED_BYTE, this->ids.data());
+  glEnable(GL_DITHER);
+  this->fbo->release();
+
+  this->quarterwidget->doneCurrent();
+
+  // the pixels are read as R, G, B, A bytes, convert them to ids
+  for (int i = 0; i < this->ids.size(); i++) {
+    const unsigned char * rgba = reinterpret_cast<const unsigned char *>(&this->ids[i]);
+    this->ids[i] = (uint32_t(rgba[0]) << 16) | (uint32_t(rgba[1]) << 8) | uint32_t(rgba[2]);
+  }
+  this->valid = true;
+#endif
+}
+
+SoPath *
+PickBuffer::rayPick(const SbVec2s & pos)
+{
+  SoRenderManager * manager = this->quarterwidget->getSoRenderManager();
+  SoNode * root = manager->getSceneGraph();
+  if (this->raypath) {
+    this->raypath->unref();
+    this->raypath = NULL;
+  }
+  if (!root) return NULL;
+
+  SoRayPickAction rpa(manager->getViewportRegion());
+  rpa.setPoint(pos);
+  rpa.apply(root);
+  SoPickedPoint * point = rpa.getPickedPoint();
+  if (point) {
+    this->raypath = point->getPath();
+    this->raypath->ref();
+  }
+  return this->raypath;
+}
@@ -0,0 +1,425 @@
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+/*!
+  \class SIM::Coin3D::Quarter::ProgramBinaryCache ProgramBinaryCache.h Quarter/ProgramBinaryCache.h
+
+  \brief The ProgramBinaryCache class keeps linked GLSL programs on
+  disk between runs.
+
+  createProgram() compiles and links a program the first time it sees
+  its sources, and stores the driver's binary of the linked program
+  with glGetProgramBinary(). Later calls, in this or a later run,
+  restore the program from the binary and skip compiling and linking.
+
+  Binaries are keyed by a hash of the sources, and stored in a
+  subdirectory named by a hash of the GL vendor, renderer and version
+  strings, so the cache is invalidated when the driver or the GPU
+  changes. Machines with several GPUs, or processes using different
+  drivers, keep a subdirectory each. The binaries of a driver that has
+  not been used for 30 days are removed. A binary the driver refuses
+  to load is replaced by a fresh one.
+
+  Only the files and subdirectories the cache creates itself are ever
+  removed, so the cache directory may be shared with other data.
+
+  Coin compiles and links the programs of SoShaderProgram nodes
+  itself, so those do not go through this cache. Use it for programs
+  set up by SoCallback nodes and other application GL code.
+
+  The cache needs Qt 5.6 or later, and OpenGL 4.1, OpenGL ES 3.0 or
+  the GL_ARB_get_program_binary extension.
+*/
+
+#include <Quarter/ProgramBinaryCache.h>
+
+#include <QtCore/QCryptographicHash>
+#include <QtCore/QDataStream>
+#include <QtCore/QDateTime>
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QSet>
+
+#if (QT_VERSION >= 0x050600)
+#  include <QtCore/QStandardPaths>
+#  include <QOpenGLContext>
+#  include <QOpenGLExtraFunctions>
+#endif
+
+#include <Inventor/C/tidbits.h>
+
+#ifndef GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#endif
+#ifndef GL_PROGRAM_BINARY_LENGTH
+#define GL_PROGRAM_BINARY_LENGTH 0x8741
+#endif
+#ifndef GL_NUM_PROGRAM_BINARY_FORMATS
+#define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+#endif
+
+using namespace SIM::Coin3D::Quarter;
+
+// tags the binary files, bump when the file layout changes
+static const quint32 PROGRAM_BINARY_MAGIC = 0x51504231; // "QPB1"
+
+static QString * cachedirectory = NULL;
+// the driver directories already checked for stale siblings
+static QSet<QByteArray> * checkeddrivers = NULL;
+
+// written to a driver directory when it is first used in a run
+static const char LAST_USED_FILE[] = "last-used";
+// driver directories unused for longer than this are removed
+static const int STALE_DRIVER_DAYS = 30;
+
+static const QString &
+cache_directory(void)
+{
+  if (!cachedirectory) {
+    // FIXME: static memory leak
+    cachedirectory = new QString;
+    const char * env = coin_getenv("QUARTER_PROGRAM_CACHE_DIR");
+    if (env) {
+      *cachedirectory = QString::fromLocal8Bit(env);
+    } else {
+#if (QT_VERSION >= 0x050600)
+      *cachedirectory =
+        QStandardPaths::writableLocation(QStandardPaths::CacheLocation) +
+        QLatin1String("/quarter-programs");
+#endif
+    }
+  }
+  return *cachedirectory;
+}
+
+#if (QT_VERSION >= 0x050600)
+
+/*
+  Returns the hex encoded hash identifying the driver and GPU of the
+  current context.
+ */
+static QByteArray
+driver_id(QOpenGLFunctions * gl)
+{
+  QCryptographicHash hash(QCryptographicHash::Sha1);
+  hash.addData(reinterpret_cast<const char *>(gl->glGetString(GL_VENDOR)));
+  hash.addData(reinterpret_cast<const char *>(gl->glGetString(GL_RENDERER)));
+  hash.addData(reinterpret_cast<const char *>(gl->glGetString(GL_VERSION)));
+  return hash.result().toHex();
+}
+
+/*
+  Returns true if \a name is \a length lowercase hex digits, as the
+  names of the files and directories created by the cache are.
+ */
+static bool
+is_hash_name(const QString & name, int length)
+{
+  if (name.size() != length) return false;
+  for (int i = 0; i < length; ++i) {
+    const QChar c = name.at(i);
+    if (!((c >= QLatin1Char('0') && c <= QLatin1Char('9')) ||
+          (c >= QLatin1Char('a') && c <= QLatin1Char('f')))) return false;
+  }
+  return true;
+}
+
+/*
+  Removes the binaries in the driver directory \a name below \a root,
+  and the directory itself once nothing else is left in it.
+ */
+static void
+remove_driver_directory(const QDir & root, const QString & name)
+{
+  QDir dir(root.filePath(name));
+  const QStringList files = dir.entryList(QDir::Files | QDir::Hidden);
+  for (int i = 0; i < files.size(); ++i) {
+    const QString & file = files[i];
+    if (file == QLatin1String(LAST_USED_FILE) ||
+        (file.endsWith(QLatin1String(".bin")) && is_hash_name(file.left(file.size() - 4), 40)) ||
+        (file.endsWith(QLatin1String(".bin.tmp")) && is_hash_name(file.left(file.size() - 8), 40))) {
+      dir.remove(file);
+    }
+  }
+  // fails, and leaves the directory, if anything else is in it
+  root.rmdir(name);
+}
+
+/*
+  Returns the directory holding the binaries of the current driver.
+  The first time a driver is asked for in a run, its directory is
+  marked as used, and the directories of drivers unused for
+  STALE_DRIVER_DAYS are removed.
+ */
+static QString
+driver_directory(QOpenGLFunctions * gl)
+{
+  const QByteArray id = driver_id(gl);
+  QDir root(cache_directory());
+  const QString path = root.filePath(QString::fromLatin1(id));
+
+  if (!checkeddrivers) {
+    // FIXME: static memory leak
+    checkeddrivers = new QSet<QByteArray>;
+  }
+  if (!checkeddrivers->contains(id)) {
+    checkeddrivers->insert(id);
+    if (QDir().mkpath(path)) {
+      QFile stamp(QDir(path).filePath(QLatin1String(LAST_USED_FILE)));
+      if (stamp.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        stamp.write(QDateTime::currentDateTimeUtc().toString(Qt::ISODate).toLatin1());
+      }
+    }
+
+    const QDateTime stale = QDateTime::currentDateTimeUtc().addDays(-STALE_DRIVER_DAYS);
+    const QStringList entries = root.entryList(QDir::Dirs | QDir::NoDotAndDotDot);
+    for (int i = 0; i < entries.size(); ++i) {
+      if (entries[i].toLatin1() == id || !is_hash_name(entries[i], 40)) continue;
+      QFileInfo used(QDir(root.filePath(entries[i])).filePath(QLatin1String(LAST_USED_FILE)));
+      if (!used.exists()) used = QFileInfo(root.filePath(entries[i]));
+      if (used.lastModified().toUTC() < stale) {
+        remove_driver_directory(root, entries[i]);
+      }
+    }
+  }
+  return path;
+}
+
+static GLuint
+compile_shader(QOpenGLFunctions * gl, GLenum type, const QByteArray & source)
+{
+  GLuint shader = gl->glCreateShader(type);
+  const char * data = source.constData();
+  const GLint length = source.size();
+  gl->glShaderSource(shader, 1, &data, &length);
+  gl->glCompileShader(shader);
+  GLint status = GL_FALSE;
+  gl->glGetShaderiv(shader, GL_COMPILE_STATUS, &status);
+  if (status != GL_TRUE) {
+    gl->glDeleteShader(shader);
+    return 0;
+  }
+  return shader;
+}
+
+/*
+  Loads the binary in \a filename into \a program. Returns false if
+  there is no binary or the driver refuses it.
+ */
+static bool
+load_binary(QOpenGLExtraFunctions * gl, GLuint program, const QString & filename)
+{
+  QFile file(filename);
+  if (!file.open(QIODevice::ReadOnly)) return false;
+
+  QDataStream stream(&file);
+  quint32 magic = 0, format = 0;
+  QByteArray binary;
+  stream >> magic >> format >> binary;
+  if (stream.status() != QDataStream::Ok ||
+      magic != PROGRAM_BINARY_MAGIC || binary.isEmpty()) {
+    return false;
+  }
+
+  gl->glProgramBinary(program, format, binary.constData(), binary.size());
+  GLint status = GL_FALSE;
+  gl->glGetProgramiv(program, GL_LINK_STATUS, &status);
+  return status == GL_TRUE;
+}
+
+static void
+store_binary(QOpenGLExtraFunctions * gl, GLuint program, const QString & filename)
+{
+  GLint length = 0;
+  gl->glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+  if (length <= 0) return;
+
+  QByteArray binary(length, '\0');
+  GLenum format = 0;
+  gl->glGetProgramBinary(program, length, &length, &format, binary.data());
+  binary.resize(length);
+
+  QDir().mkpath(QFileInfo(filename).path());
+  // write to a temporary file first so that a concurrent run never
+  // sees a partial binary
+  const QString temporary = filename + QLatin1String(".tmp");
+  QFile file(temporary);
+  if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) return;
+  QDataStream stream(&file);
+  stream << PROGRAM_BINARY_MAGIC << quint32(format) << binary;
+  file.close();
+  QFile::remove(filename);
+  QFile::rename(temporary, filename);
+}
+
+#endif // QT_VERSION >= 0x050600
+
+/*!
+  Sets the directory the binaries are stored in. An empty \a path
+  turns the cache off, so that createProgram() always compiles.
+
+  The default is the "quarter-programs" directory in the
+  application's cache location, or the directory named by the
+  environment variable QUARTER_PROGRAM_CACHE_DIR.
+*/
+void
+ProgramBinaryCache::setCacheDirectory(const QString & path)
+{
+  cache_directory();
+  *cachedirectory = path;
+}
+
+/*!
+  Returns the directory the binaries are stored in.
+*/
+QString
+ProgramBinaryCache::cacheDirectory(void)
+{
+  return cache_directory();
+}
+
+/*!
+  Returns true if the current GL context can save and restore
+  program binaries.
+*/
+bool
+ProgramBinaryCache::isSupported(void)
+{
+#if (QT_VERSION >= 0x050600)
+  QOpenGLContext * context = QOpenGLContext::currentContext();
+  if (!context) return false;
+
+  const QSurfaceFormat format = context->format();
+  const int version = format.majorVersion() * 10 + format.minorVersion();
+  if (!(context->isOpenGLES() ? version >= 30 :
+        (version >= 41 || context->hasExtension("GL_ARB_get_program_binary")))) {
+    return false;
+  }
+  GLint numformats = 0;
+  context->functions()->glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &numformats);
+  return numformats > 0;
+#else
+  return false;
+#endif
+}
+
+/*!
+  Returns a linked program built from \a vertexsource and
+  \a fragmentsource for the current GL context, or 0 if the sources
+  fail to compile or link, or if there is no current context. The
+  caller owns the program and deletes it with glDeleteProgram().
+
+  The program is restored from the cache if possible. Otherwise it is
+  compiled and linked, and its binary stored for the next time.
+  Without a cache directory or support for program binaries the
+  program is always compiled.
+
+  Requires Qt 5.6 or later, and always returns 0 with older versions.
+*/
+unsigned int
+ProgramBinaryCache::createProgram(const QByteArray & vertexsource,
+                                  const QByteArray & fragmentsource)
+{
+#if (QT_VERSION >= 0x050600)
+  QOpenGLContext * context = QOpenGLContext::currentContext();
+  if (!context) return 0;
+  QOpenGLExtraFunctions * gl = context->extraFunctions();
+
+  QString filename;
+  if (!cache_directory().isEmpty() && ProgramBinaryCache::isSupported()) {
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(vertexsource);
+    hash.addData("\0", 1);
+    hash.addData(fragmentsource);
+    filename = driver_directory(gl) + QLatin1Char('/') +
+      QString::fromLatin1(hash.result().toHex()) + QLatin1String(".bin");
+  }
+
+  GLuint program = gl->glCreateProgram();
+  if (!filename.isEmpty() && load_binary(gl, program, filename)) {
+    return program;
+  }
+
+  // the program object may be left in an invalid state by a rejected
+  // binary, so start over with a new one
+  gl->glDeleteProgram(program);
+  program = gl->glCreateProgram();
+
+  GLuint vertex = compile_shader(gl, GL_VERTEX_SHADER, vertexsource);
+  GLuint fragment = compile_shader(gl, GL_FRAGMENT_SHADER, fragmentsource);
+  GLint status = GL_FALSE;
+  if (vertex && fragment) {
+    gl->glAttachShader(program, vertex);
+    gl->glAttachShader(program, fragment);
+    if (!filename.isEmpty()) {
+      gl->glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
+    gl->glLinkProgram(program);
+    gl->glGetProgramiv(program, GL_LINK_STATUS, &status);
+  }
+  // the shaders are freed along with the program
+  if (vertex) gl->glDeleteShader(vertex);
+  if (fragment) gl->glDeleteShader(fragment);
+
+  if (status != GL_TRUE) {
+    gl->glDeleteProgram(program);
+    return 0;
+  }
+  if (!filename.isEmpty()) {
+    store_binary(gl, program, filename);
+  }
+  return program;
+#else
+  Q_UNUSED(vertexsource);
+  Q_UNUSED(fragmentsource);
+  return 0;
+#endif
+}
+
+/*!
+  Removes all stored binaries. Other files in the cache directory are
+  left alone.
+*/
+void
+ProgramBinaryCache::clear(void)
+{
+#if (QT_VERSION >= 0x050600)
+  if (cache_directory().isEmpty()) return;
+  QDir root(cache_directory());
+  const QStringList entries = root.entryList(QDir::Dirs | QDir::NoDotAndDotDot);
+  for (int i = 0; i < entries.size(); ++i) {
+    if (is_hash_name(entries[i], 40)) remove_driver_directory(root, entries[i]);
+  }
+  if (checkeddrivers) checkeddrivers->clear();
+#endif
+}
@@ -1,48 +1,132 @@
 #include <Quarter/QtCoinCompatibility.h>
 #include <Inventor/SbImage.h>
 #include <QImage>
+#include <QVector>
 #include <Inventor/errors/SoDebugError.h>
+#include <assert.h>
+#include <string.h>
 
 using namespace SIM::Coin3D::Quarter;
 
+/*
+  Coin images are stored bottom to top, QImages top to bottom, and
+  QImage scanlines may be padded. Copies tightly packed rows of
+  rowbytes bytes while flipping.
+*/
+static void
+copy_rows_flipped(const QImage & image, int rowbytes, unsigned char * dst)
+{
+  const int h = image.height();
+  for (int y = 0; y < h; y++) {
+    memcpy(dst + y*rowbytes, image.constScanLine(h-(y+1)), rowbytes);
+  }
+}
+
+static int
+sbimage_components(const QImage & image)
+{
+  // Keep in 8-bits mode if that was what we read
+  if (image.depth() == 8 && image.isGrayscale()) {
+    return 1;
+  }
+  // FIXME: consider if we should detect allGrayscale() and alpha (c = 2)
+  return image.hasAlphaChannel() ? 4 : 3;
+}
+
 void
 QtCoinCompatibility::QImageToSbImage(const QImage & image, SbImage & sbimage)
 {
     int w = image.width();
     int h = image.height();
-    int c;
+    int c = sbimage_components(image);
 
-    // Keep in 8-bits mode if that was what we read
-    if (image.depth() == 8 && image.isGrayscale()) {
-      c = 1;
-    }
-    else {
-      // FIXME: consider if we should detect allGrayscale() and alpha (c = 2)
-      c = image.hasAlphaChannel() ? 4 : 3;
+    SbVec2s size((short) w, (short) h);
+    // only reallocate if the image layout actually changes
+    SbVec2s oldsize;
+    int oldc;
+    unsigned char * buffer = sbimage.getValue(oldsize, oldc);
+    if (buffer == NULL || oldsize != size || oldc != c) {
+      sbimage.setValue(size, c, NULL);
+      buffer = sbimage.getValue(size, c);
     }
+    QtCoinCompatibility::QImageToSbImage(image, buffer, c);
+}
 
-    SbVec2s size((short) w, (short) h);
-    sbimage.setValue(size, c, NULL);
-    unsigned char * buffer = sbimage.getValue(size, c);
+/*!
+  Converts \a image into the caller-owned \a buffer, which must hold
+  width * height * \a numcomponents bytes. The pixels are written the
+  way Coin expects them, bottom row first. \a numcomponents can be
+  from 1 (grayscale) to 4 (RGBA).
+*/
+void
+QtCoinCompatibility::QImageToSbImage(const QImage & image, unsigned char * buffer,
+                                     int numcomponents)
+{
+    const int w = image.width();
+    const int h = image.height();
+    const int c = numcomponents;
+    assert(buffer && c >= 1 && c <= 4);
+
+    if (c == 1 && image.depth() == 8 && image.isGrayscale()) {
+      copy_rows_flipped(image, w, buffer);
+      return;
+    }
 
-    if (c == 1) {
-      for (int i = 0; i < h; i++) {
-        memcpy(buffer + i*w, image.scanLine(h-(i+1)), w);
+#if QT_VERSION >= 0x050200
+    // Qt has byte ordered formats matching what Coin wants, so let its
+    // (vectorized) converters do the swizzling, and skip conversion
+    // altogether if the image is already in the right format
+    QImage::Format format = QImage::Format_Invalid;
+    if (c == 3) format = QImage::Format_RGB888;
+    else if (c == 4) format = QImage::Format_RGBA8888;
+#if QT_VERSION >= 0x050500
+    else if (c == 1) format = QImage::Format_Grayscale8;
+#endif
+    if (format != QImage::Format_Invalid) {
+      if (image.format() == format) {
+        copy_rows_flipped(image, c*w, buffer);
+      }
+      else {
+        copy_rows_flipped(image.convertToFormat(format), c*w, buffer);
       }
+      return;
     }
-    else { // (c == 3 || c == 4)
-      QRgb * bits = (QRgb*) image.bits();
-      for (int y = 0; y < h; y++) {
-        unsigned char * line = &buffer[c*w*(h-(y+1))];
+#endif
+
+    const QImage argb =
+      (image.format() == QImage::Format_ARGB32 || image.format() == QImage::Format_RGB32) ?
+      image : image.convertToFormat(QImage::Format_ARGB32);
+
+    for (int y = 0; y < h; y++) {
+      const QRgb * bits = reinterpret_cast<const QRgb *>(argb.constScanLine(y));
+      unsigned char * line = &buffer[c*w*(h-(y+1))];
+      switch (c) {
+      case 1:
+        for (int x = 0; x < w; x++) {
+          *line++ = qGray(bits[x]);
+        }
+        break;
+      case 2:
         for (int x = 0; x < w; x++) {
-          *line++ = qRed(*bits);
-          *line++ = qGreen(*bits);
-          *line++ = qBlue(*bits);
-          if (c == 4) {
-            *line++ = qAlpha(*bits);
-          }
-          bits++;
+          *line++ = qGray(bits[x]);
+          *line++ = qAlpha(bits[x]);
         }
+        break;
+      case 3:
+        for (int x = 0; x < w; x++) {
+          *line++ = qRed(bits[x]);
+          *line++ = qGreen(bits[x]);
+          *line++ = qBlue(bits[x]);
+        }
+        break;
+      default:
+        for (int x = 0; x < w; x++) {
+          *line++ = qRed(bits[x]);
+          *line++ = qGreen(bits[x]);
+          *line++ = qBlue(bits[x]);
+          *line++ = qAlpha(bits[x]);
+        }
+        break;
       }
     }
 }
@@ -60,37 +144,43 @@ QtCoinCompatibility::SbImageToQImage(const SbImage & sbimage, QImage & img)
                         "Implementation not tested for 3 colors or more"
                            );
   }
-  QImage::Format format;
+
+  if (nc==1) {
+    // reuse the target image if it already has the right layout
+    if (img.size()!=size || img.format()!=QImage::Format_Indexed8) {
+      img = QImage(size,QImage::Format_Indexed8);
+      QVector<QRgb> clut;
+      for (int i=0;i<256;++i) {
+        clut.append(qRgb(i,i,i));
+      }
+      img.setColorTable(clut);
+    }
+    assert(img.size()==size);
+    for (int y = 0; y < size.height(); ++y) {
+      memcpy(img.scanLine(size.height() - (y+1)), src + y*size.width(), size.width());
+    }
+    return;
+  }
+
+#if QT_VERSION >= 0x050200
   if (nc==3||nc==4) {
-    format=QImage::Format_RGB32;
+    // wrap the Coin buffer without copying, and let Qt convert it
+    const QImage wrapped(src, size.width(), size.height(), nc*size.width(),
+                         nc==3 ? QImage::Format_RGB888 : QImage::Format_RGBA8888);
+    img = wrapped.mirrored(false, true).convertToFormat(QImage::Format_RGB32);
+    return;
   }
-  else if (nc==1) {
-    QVector<QRgb> clut;
-    for (int i=0;i<256;++i) {
-      clut.append(qRgb(i,i,i));
-    }
-    format=QImage::Format_Indexed8;
+#endif
+
+  if (img.size()!=size || img.format()!=QImage::Format_RGB32) {
+    img = QImage(size,QImage::Format_RGB32);
   }
-  img = QImage(size,format);
   assert(img.size()==size);
-  if (nc==1) {
-    QVector<QRgb> clut;
-    for (int i=0;i<256;++i) {
-      clut.append(qRgb(i,i,i));
-    }
-    img.setColorTable(clut);
-  }
 
   for (int y = 0; y < size.height(); ++y) {
     QRgb * bits = reinterpret_cast<QRgb *>(img.scanLine(size.height() - (y+1)));
     for (int x = 0; x < size.width(); ++x) {
       switch (nc) {
-      default:
-      case 1:
-       {
-         img.setPixel(x,size.height()-(y+1),*src++);
-       }
-       break;
       case 2:
        {
          unsigned char red=*src++;
@@ -98,6 +188,7 @@ QtCoinCompatibility::SbImageToQImage(const SbImage & sbimage, QImage & img)
          *bits=qRgba(red,red,red,alpha);
        }
        break;
+      default:
       case 3:
        {
          unsigned char red=*src++;
@@ -140,17 +140,20 @@
 
 #include <cstdio>
 #include <Inventor/SoDB.h>
-#include <Inventor/nodekits/SoNodeKit.h>
-#include <Inventor/SoInteraction.h>
+#include <Inventor/SbTime.h>
 
 #include <Quarter/Quarter.h>
 #include "SensorManager.h"
+#include "ImageReader.h"
+#include "SensorProfiler.h"
 
 #include "QuarterP.h"
+#include "Trace.h"
 
 using namespace SIM::Coin3D::Quarter;
 
 static QuarterP * self = NULL;
+static bool deferinit = false;
 
 /*!
   initialize Quarter, and implicitly Coin
@@ -165,15 +168,57 @@ Quarter::init(bool initCoin)
     return;
   }
 
+  SbTime start = SbTime::getTimeOfDay();
   if (initCoin) {
     SoDB::init();
-    SoNodeKit::init();
-    SoInteraction::init();
+    QuarterP::reportPhase("SoDB::init", start);
   }
 
-  self = new QuarterP;
-  self->initCoin = initCoin;
+  self = new QuarterP(initCoin);
+  if (!deferinit) {
+    self->completeInit();
+  }
+  QuarterP::reportPhase("Quarter::init", start);
+}
+
+/*!
+  Makes init() only initialize the Coin database and Quarter's
+  sensor handling. The nodekit and interaction classes are
+  initialized, and Quarter's image reader registered with SbImage,
+  when the first QuarterWidget or QuarterWindow is shown, when a
+  SceneLoader starts loading, or when completeInit() is called. This
+  shortens startup of applications that only occasionally show a
+  view. Must be called before init(). The default is off.
+
+  Set the environment variable QUARTER_DEBUG_STARTUP to 1 to have the
+  time spent in each initialization phase printed to stderr.
+ */
+void
+Quarter::setDeferredInit(bool enable)
+{
+  COMPILE_ONLY_BEFORE(2,0,0,"Should not be encapsulated in double Quarter namespace");
+  if (self) {
+    fprintf(stderr, "Quarter is already initialized\n");
+    return;
+  }
+  deferinit = enable;
+}
+
+/*!
+  Completes an initialization deferred by setDeferredInit(). This is
+  done automatically on first use, and does nothing if Quarter is
+  fully initialized already.
+ */
+void
+Quarter::completeInit(void)
+{
+  COMPILE_ONLY_BEFORE(2,0,0,"Should not be encapsulated in double Quarter namespace");
+  if (!self) {
+    fprintf(stderr, "Quarter is not initialized!\n");
+    return;
+  }
 
+  self->completeInit();
 }
 
 /*!
@@ -186,6 +231,8 @@ Quarter::clean(void)
   assert(self);
   bool initCoin = self->initCoin;
 
+  QUARTER_TRACE_FLUSH();
+
   delete self;
   self = NULL;
 
@@ -211,3 +258,279 @@ Quarter::setTimerEpsilon(double sec)
 
   self->sensormanager->setTimerEpsilon(sec);
 }
+
+/*!
+  Sets the time in seconds for which more passes over the delay queue
+  are run in one event loop iteration, while sensors are still
+  pending. Delay sensors scheduled by other delay sensors are then
+  processed right away instead of on a later iteration, which
+  increases throughput when long chains of sensors schedule each
+  other.
+
+  This does not reduce how long the event loop is blocked: a pass is
+  never cut short, and the passes run in addition to the first one.
+  The default of 0 runs a single pass over the queue per iteration.
+ */
+void
+Quarter::setDelayQueueBatchTime(double sec)
+{
+  COMPILE_ONLY_BEFORE(2,0,0,"Should not be encapsulated in double Quarter namespace");
+  if (!self) {
+    fprintf(stderr, "Quarter is not initialized!\n");
+    return;
+  }
+
+  self->sensormanager->setDelayQueueBatchTime(sec);
+}
+
+/*!
+  Ties the realTime global field to the display refresh instead of a
+  fixed 25 Hz timer. realTime is then updated right before each frame
+  is rendered, so SoRotor, SoTimeCounter and other realTime driven
+  animations advance once per frame, at the refresh rate of the
+  screen the QuarterWidget is shown on. As long as nothing in the
+  scene depends on realTime, no timer wakes up for it. Timer sensors
+  are scheduled with precise instead of coarse Qt timers, still
+  bounded by setTimerEpsilon().
+
+  Animations do not advance in widgets that are not rendering, e.g.
+  because they are hidden. This is off by default.
+ */
+void
+Quarter::setRefreshDrivenRealTime(bool enable)
+{
+  COMPILE_ONLY_BEFORE(2,0,0,"Should not be encapsulated in double Quarter namespace");
+  if (!self) {
+    fprintf(stderr, "Quarter is not initialized!\n");
+    return;
+  }
+
+  self->sensormanager->setRefreshDrivenRealTime(enable);
+}
+
+/*!
+  Starts decoding the image files \a filenames in the background,
+  so that textures for a scene are ready before the first traversal
+  needs them. Decoded images are kept in a cache shared by all
+  readers, see setImageCacheSize().
+ */
+void
+Quarter::prefetchImages(const QStringList & filenames)
+{
+  COMPILE_ONLY_BEFORE(2,0,0,"Should not be encapsulated in double Quarter namespace");
+  if (!self) {
+    fprintf(stderr, "Quarter is not initialized!\n");
+    return;
+  }
+
+  self->imageReader()->prefetch(filenames);
+}
+
+/*!
+  Sets the memory cap in bytes of the decoded image cache. The least
+  recently used images are evicted first. Zero disables the cache.
+  The default is 256 MB.
+ */
+void
+Quarter::setImageCacheSize(size_t bytes)
+{
+  COMPILE_ONLY_BEFORE(2,0,0,"Should not be encapsulated in double Quarter namespace");
+  if (!self) {
+    fprintf(stderr, "Quarter is not initialized!\n");
+    return;
+  }
+
+  self->imageReader()->setCacheSize(bytes);
+}
+
+/*!
+  Returns the memory cap in bytes of the decoded image cache.
+ */
+size_t
+Quarter::imageCacheSize(void)
+{
+  COMPILE_ONLY_BEFORE(2,0,0,"Should not be encapsulated in double Quarter namespace");
+  if (!self) {
+    fprintf(stderr, "Quarter is not initialized!\n");
+    return 0;
+  }
+
+  return self->imageReader()->cacheSize();
+}
+
+/*!
+  Makes images read through Quarter decode at reduced size if their
+  width or height exceeds \a pixels, keeping the aspect ratio. Decoders
+  that support it, like the JPEG one, then subsample while decoding,
+  so the full resolution image is never held in memory. Set this to
+  the maximum texture size when images are only used as textures, as
+  Coin would downscale larger textures anyway. Zero, the default,
+  decodes at full resolution.
+ */
+void
+Quarter::setImageMaxDimension(int pixels)
+{
+  COMPILE_ONLY_BEFORE(2,0,0,"Should not be encapsulated in double Quarter namespace");
+  if (!self) {
+    fprintf(stderr, "Quarter is not initialized!\n");
+    return;
+  }
+
+  self->imageReader()->setMaxDimension(pixels);
+}
+
+/*!
+  Makes images read through Quarter decode at reduced size if the
+  decoded image would take more than \a bytes of memory. Zero, the
+  default, means no limit.
+
+  \sa setImageMaxDimension()
+ */
+void
+Quarter::setImageMaxMemory(size_t bytes)
+{
+  COMPILE_ONLY_BEFORE(2,0,0,"Should not be encapsulated in double Quarter namespace");
+  if (!self) {
+    fprintf(stderr, "Quarter is not initialized!\n");
+    return;
+  }
+
+  self->imageReader()->setMaxImageMemory(bytes);
+}
+
+/*!
+  Makes textures appear quickly by having large images read through
+  Quarter first return a preview, decoded at most \a previewdimension
+  pixels wide and high, while the full image is decoded on a worker
+  thread. When the full image is ready, the SoTexture2 nodes in the
+  shown scenes that use the file read it again, and the views
+  redraw. Images not larger than twice \a previewdimension are read
+  in full right away. The full images are handed over through the
+  image cache, so this has no effect with the cache disabled. The
+  default is off.
+
+  \sa setImageCacheSize(), prefetchImages()
+ */
+void
+Quarter::setProgressiveImages(bool enable, int previewdimension)
+{
+  COMPILE_ONLY_BEFORE(2,0,0,"Should not be encapsulated in double Quarter namespace");
+  if (!self) {
+    fprintf(stderr, "Quarter is not initialized!\n");
+    return;
+  }
+
+  self->imageReader()->setProgressive(enable, previewdimension);
+}
+
+/*!
+  Enables/disables measuring the time spent in sensor callbacks while
+  Quarter processes the delay and timer queues, from its idle, delay
+  and timer timeouts and before rendering in QuarterWidget and
+  QuarterWindow. Callbacks of sensors attached to nodes in the scene
+  graphs of QuarterWidgets and QuarterWindows are timed and summed up
+  per sensor type and node, which the rest of the queue processing
+  time is set against. New sensors are picked up within a second.
+
+  While profiling, the callbacks of the timed sensors are replaced by
+  a wrapper, so SoSensor::getFunction() and SoSensor::getData()
+  return other values than they were set to. They are restored when
+  profiling is disabled. Enabling profiling resets the profile, and
+  the performance HUD shows the most expensive entries. Profiling is
+  off by default.
+
+  \sa sensorProfile(), addProfiledSensor()
+ */
+void
+Quarter::setSensorProfilingEnabled(bool enable)
+{
+  COMPILE_ONLY_BEFORE(2,0,0,"Should not be encapsulated in double Quarter namespace");
+  if (!self) {
+    fprintf(stderr, "Quarter is not initialized!\n");
+    return;
+  }
+
+  QuarterP::sensorprofiler->setEnabled(enable);
+}
+
+/*!
+  Returns true if sensor callbacks are profiled.
+ */
+bool
+Quarter::sensorProfilingEnabled(void)
+{
+  COMPILE_ONLY_BEFORE(2,0,0,"Should not be encapsulated in double Quarter namespace");
+  if (!self) {
+    fprintf(stderr, "Quarter is not initialized!\n");
+    return false;
+  }
+
+  return QuarterP::sensorprofiler->enabled();
+}
+
+/*!
+  Returns the time spent in sensor callbacks since profiling was
+  enabled or the profile was last reset.
+
+  \sa setSensorProfilingEnabled(), resetSensorProfile()
+ */
+SensorProfile
+Quarter::sensorProfile(void)
+{
+  COMPILE_ONLY_BEFORE(2,0,0,"Should not be encapsulated in double Quarter namespace");
+  if (!self) {
+    fprintf(stderr, "Quarter is not initialized!\n");
+    return SensorProfile();
+  }
+
+  return QuarterP::sensorprofiler->profile();
+}
+
+/*!
+  Discards the timings collected so far.
+ */
+void
+Quarter::resetSensorProfile(void)
+{
+  COMPILE_ONLY_BEFORE(2,0,0,"Should not be encapsulated in double Quarter namespace");
+  if (!self) {
+    fprintf(stderr, "Quarter is not initialized!\n");
+    return;
+  }
+
+  QuarterP::sensorprofiler->reset();
+}
+
+/*!
+  Makes the profile include the callbacks of \a sensor, listed under
+  \a label. Use this for sensors which are not attached to a node in a
+  shown scene graph, e.g. SoTimerSensor or SoFieldSensor. The sensor
+  must be removed with removeProfiledSensor() before it is deleted.
+ */
+void
+Quarter::addProfiledSensor(SoSensor * sensor, const QString & label)
+{
+  COMPILE_ONLY_BEFORE(2,0,0,"Should not be encapsulated in double Quarter namespace");
+  if (!self) {
+    fprintf(stderr, "Quarter is not initialized!\n");
+    return;
+  }
+
+  QuarterP::sensorprofiler->addSensor(sensor, label);
+}
+
+/*!
+  Stops profiling \a sensor, which was added with
+  addProfiledSensor(), and restores its callback.
+ */
+void
+Quarter::removeProfiledSensor(SoSensor * sensor)
+{
+  COMPILE_ONLY_BEFORE(2,0,0,"Should not be encapsulated in double Quarter namespace");
+  if (!self) {
+    fprintf(stderr, "Quarter is not initialized!\n");
+    return;
+  }
+
+  QuarterP::sensorprofiler->removeSensor(sensor);
+}
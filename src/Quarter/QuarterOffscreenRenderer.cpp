@@ -0,0 +1,749 @@
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+/*!
+  \class SIM::Coin3D::Quarter::QuarterOffscreenRenderer QuarterOffscreenRenderer.h Quarter/QuarterOffscreenRenderer.h
+
+  \brief The QuarterOffscreenRenderer class renders a Coin scene graph
+  into a framebuffer object, without any visible widget.
+
+  The renderer owns its own OpenGL context. If a \a sharewidget is
+  given when constructing the renderer, the context will share OpenGL
+  objects with the context of that widget, and the renderer joins the
+  widget's cache context. Display lists, textures and other caches
+  built for the widget will then be reused by the renderer, and vice
+  versa. The share widget must have been shown at least once for its
+  context to exist, otherwise the renderer gets a cache context of its
+  own.
+
+  The scene graph is set up like in QuarterWidget: a headlight is
+  added, and if the scene does not contain a camera, a perspective
+  camera is added and viewAll() is called.
+
+  \code
+  QuarterOffscreenRenderer renderer(QSize(256, 256), viewer);
+  renderer.setSceneGraph(root);
+  QImage snapshot = renderer.grabImage();
+  \endcode
+
+  QuarterOffscreenRenderer is only available with Qt 5 and later. The
+  renderer must be constructed and destructed in the GUI thread. In
+  between, it can be moved to a worker thread with
+  QObject::moveToThread(), which moves its OpenGL context along, and
+  render from there. This requires a thread safe build of Coin, and
+  each thread should render a scene graph of its own. Pending sensors
+  are only processed by render() in the GUI thread. Move the renderer
+  back to the GUI thread before deleting it.
+
+  The renderer needs a QGuiApplication, but no QApplication, window
+  system or display. On machines without a display server, call
+  setupHeadlessPlatform() before constructing the application to run
+  Qt on EGL, where the context renders without any window into
+  surfaceless or pbuffer surfaces.
+
+  \code
+  int main(int argc, char ** argv)
+  {
+    QuarterOffscreenRenderer::setupHeadlessPlatform();
+    QGuiApplication app(argc, argv);
+    Quarter::init();
+    ...
+  }
+  \endcode
+*/
+
+#include <Quarter/QuarterOffscreenRenderer.h>
+
+#if QT_VERSION >= 0x050000
+
+#include <math.h>
+
+#include <QCoreApplication>
+#include <QGuiApplication>
+#include <QOffscreenSurface>
+#include <QOpenGLContext>
+#include <QOpenGLFramebufferObject>
+#include <QOpenGLFramebufferObjectFormat>
+#include <QThread>
+#include <QtCore/QtGlobal>
+
+#include <Inventor/SbColor4f.h>
+#include <Inventor/SbViewportRegion.h>
+#include <Inventor/SoDB.h>
+#include <Inventor/SoRenderManager.h>
+#include <Inventor/SoPath.h>
+#include <Inventor/actions/SoGLRenderAction.h>
+#include <Inventor/actions/SoGetBoundingBoxAction.h>
+#include <Inventor/actions/SoSearchAction.h>
+#include <Inventor/errors/SoDebugError.h>
+#include <Inventor/nodes/SoCamera.h>
+#include <Inventor/nodes/SoDirectionalLight.h>
+#include <Inventor/nodes/SoFrustumCamera.h>
+#include <Inventor/nodes/SoOrthographicCamera.h>
+#include <Inventor/nodes/SoPerspectiveCamera.h>
+#include <Inventor/nodes/SoSeparator.h>
+#include <Inventor/sensors/SoSensorManager.h>
+#include <Inventor/system/gl.h>
+
+#include <Quarter/QuarterWidget.h>
+
+#include "BoundingBoxCache.h"
+#include "QuarterWidgetP.h"
+#include "TiffTileWriter.h"
+
+namespace SIM { namespace Coin3D { namespace Quarter {
+
+class QuarterOffscreenRendererP {
+public:
+  QuarterOffscreenRendererP(QuarterOffscreenRenderer * master) {
+    this->master = master;
+    this->context = NULL;
+    this->surface = NULL;
+    this->fbo = NULL;
+    this->sorendermanager = NULL;
+    this->headlight = NULL;
+    this->scene = NULL;
+    this->camera = NULL;
+    this->cachecontext = NULL;
+  }
+
+  QuarterOffscreenRenderer * master;
+  QOpenGLContext * context;
+  QOffscreenSurface * surface;
+  QOpenGLFramebufferObject * fbo;
+  QSize size;
+  SoRenderManager * sorendermanager;
+  SoDirectionalLight * headlight;
+  SoNode * scene;
+  SoCamera * camera;
+  QuarterWidgetP_cachecontext * cachecontext;
+
+  static void processDelayQueue(void);
+  bool bindFramebuffer(const QSize & size);
+  void clippingPlanes(SoCamera * camera, SoNode * root, const SbViewportRegion & vp,
+                      float & nearval, float & farval) const;
+};
+
+}}} // namespace
+
+#define PRIVATE(obj) obj->pimpl
+
+using namespace SIM::Coin3D::Quarter;
+
+/*!
+  Constructor. Creates an OpenGL context which shares objects with
+  \a sharewidget, if given.
+*/
+QuarterOffscreenRenderer::QuarterOffscreenRenderer(const QSize & size,
+                                                   const QuarterWidget * sharewidget,
+                                                   QObject * parent)
+  : inherited(parent)
+{
+  PRIVATE(this) = new QuarterOffscreenRendererP(this);
+  PRIVATE(this)->size = size;
+
+  QOpenGLContext * sharecontext = NULL;
+  if (sharewidget) {
+#if QT_VERSION >= 0x060000
+    sharecontext = sharewidget->context();
+#else
+    if (sharewidget->context()) {
+      sharecontext = sharewidget->context()->contextHandle();
+    }
+#endif
+  }
+
+  // a child, so that moveToThread() also moves the context
+  PRIVATE(this)->context = new QOpenGLContext(this);
+  if (sharecontext) {
+    PRIVATE(this)->context->setFormat(sharecontext->format());
+    PRIVATE(this)->context->setShareContext(sharecontext);
+  }
+  PRIVATE(this)->context->create();
+
+  PRIVATE(this)->surface = new QOffscreenSurface;
+  PRIVATE(this)->surface->setFormat(PRIVATE(this)->context->format());
+  PRIVATE(this)->surface->create();
+
+  if (!this->isValid()) {
+    SoDebugError::postWarning("QuarterOffscreenRenderer::QuarterOffscreenRenderer",
+                              "Could not create an OpenGL context and offscreen surface "
+                              "on the '%s' platform. Without a display server, see "
+                              "QuarterOffscreenRenderer::setupHeadlessPlatform().",
+                              QGuiApplication::platformName().toLocal8Bit().constData());
+  }
+
+  // only join the share group of the widget if the GL objects are
+  // actually shared, otherwise Coin would try to reuse display lists
+  // and textures that do not exist in our context
+  const void * sharemember = NULL;
+  if (sharecontext && QOpenGLContext::areSharing(PRIVATE(this)->context, sharecontext)) {
+#if QT_VERSION >= 0x060000
+    const QOpenGLWidget * widget = sharewidget;
+#else
+    const QGLWidget * widget = sharewidget;
+#endif
+    sharemember = widget;
+  }
+  PRIVATE(this)->cachecontext = QuarterWidgetP::findCacheContext(this, sharemember);
+
+  PRIVATE(this)->headlight = new SoDirectionalLight;
+  PRIVATE(this)->headlight->ref();
+
+  PRIVATE(this)->sorendermanager = new SoRenderManager;
+  PRIVATE(this)->sorendermanager->setAutoClipping(SoRenderManager::VARIABLE_NEAR_PLANE);
+  PRIVATE(this)->sorendermanager->setBackgroundColor(SbColor4f(0.0f, 0.0f, 0.0f, 0.0f));
+  PRIVATE(this)->sorendermanager->setViewportRegion(SbViewportRegion(size.width(), size.height()));
+  PRIVATE(this)->sorendermanager->getGLRenderAction()->setCacheContext(this->getCacheContextId());
+}
+
+/*!
+  Destructor.
+*/
+QuarterOffscreenRenderer::~QuarterOffscreenRenderer()
+{
+  this->setSceneGraph(NULL);
+  PRIVATE(this)->headlight->unref();
+
+  bool current = this->makeCurrent();
+  delete PRIVATE(this)->fbo;
+  delete PRIVATE(this)->sorendermanager;
+  if (QuarterWidgetP::removeFromCacheContext(PRIVATE(this)->cachecontext, this) && current) {
+    QuarterWidgetP::destructCacheContext(PRIVATE(this)->cachecontext);
+  }
+  if (current) {
+    this->doneCurrent();
+  }
+
+  delete PRIVATE(this)->surface;
+  delete PRIVATE(this)->context;
+  delete PRIVATE(this);
+}
+
+/*!
+  Returns true if the OpenGL context and surface could be created.
+*/
+bool
+QuarterOffscreenRenderer::isValid(void) const
+{
+  return PRIVATE(this)->context->isValid() && PRIVATE(this)->surface->isValid();
+}
+
+/*!
+  Sets the size of the rendered image, in pixels.
+*/
+void
+QuarterOffscreenRenderer::setSize(const QSize & size)
+{
+  PRIVATE(this)->size = size;
+  PRIVATE(this)->sorendermanager->setViewportRegion(SbViewportRegion(size.width(), size.height()));
+}
+
+/*!
+  Returns the size of the rendered image.
+*/
+QSize
+QuarterOffscreenRenderer::size(void) const
+{
+  return PRIVATE(this)->size;
+}
+
+/*!
+  Sets the color used for clearing the framebuffer before rendering.
+
+  \sa QuarterWidget::setBackgroundColor()
+*/
+void
+QuarterOffscreenRenderer::setBackgroundColor(const QColor & color)
+{
+  SbColor4f bgcolor(SbClamp(color.red()   / 255.0, 0.0, 1.0),
+                    SbClamp(color.green() / 255.0, 0.0, 1.0),
+                    SbClamp(color.blue()  / 255.0, 0.0, 1.0),
+                    SbClamp(color.alpha() / 255.0, 0.0, 1.0));
+
+  PRIVATE(this)->sorendermanager->setBackgroundColor(bgcolor);
+}
+
+/*!
+  Returns the color used for clearing the framebuffer.
+*/
+QColor
+QuarterOffscreenRenderer::backgroundColor(void) const
+{
+  SbColor4f bg = PRIVATE(this)->sorendermanager->getBackgroundColor();
+
+  return QColor(SbClamp(int(bg[0] * 255.0), 0, 255),
+                SbClamp(int(bg[1] * 255.0), 0, 255),
+                SbClamp(int(bg[2] * 255.0), 0, 255),
+                SbClamp(int(bg[3] * 255.0), 0, 255));
+}
+
+/*!
+  Sets the Inventor scene graph to be rendered.
+
+  \sa QuarterWidget::setSceneGraph()
+*/
+void
+QuarterOffscreenRenderer::setSceneGraph(SoNode * node)
+{
+  if (node == PRIVATE(this)->scene) {
+    return;
+  }
+
+  if (PRIVATE(this)->scene) {
+    PRIVATE(this)->scene->unref();
+    PRIVATE(this)->scene = NULL;
+  }
+
+  SoCamera * camera = NULL;
+  SoSeparator * superscene = NULL;
+  bool viewall = false;
+
+  if (node) {
+    PRIVATE(this)->scene = node;
+    PRIVATE(this)->scene->ref();
+
+    superscene = new SoSeparator;
+    superscene->addChild(PRIVATE(this)->headlight);
+
+    // if the scene does not contain a camera, add one
+    if (!(camera = QuarterWidgetP::searchForCamera(node))) {
+      camera = new SoPerspectiveCamera;
+      superscene->addChild(camera);
+      viewall = true;
+    }
+
+    superscene->addChild(node);
+  }
+
+  PRIVATE(this)->camera = camera;
+  PRIVATE(this)->sorendermanager->setCamera(camera);
+  PRIVATE(this)->sorendermanager->setSceneGraph(superscene);
+
+  if (viewall) { this->viewAll(); }
+}
+
+/*!
+  Returns pointer to root of scene graph.
+*/
+SoNode *
+QuarterOffscreenRenderer::getSceneGraph(void) const
+{
+  return PRIVATE(this)->scene;
+}
+
+/*!
+  Returns the camera used for rendering.
+*/
+SoCamera *
+QuarterOffscreenRenderer::getCamera(void) const
+{
+  return PRIVATE(this)->camera;
+}
+
+/*!
+  Returns a pointer to the render manager.
+*/
+SoRenderManager *
+QuarterOffscreenRenderer::getSoRenderManager(void) const
+{
+  return PRIVATE(this)->sorendermanager;
+}
+
+/*!
+  Returns the Coin cache context id for this renderer. It is the same
+  as the id of the share widget, if the OpenGL objects are shared.
+*/
+uint32_t
+QuarterOffscreenRenderer::getCacheContextId(void) const
+{
+  return QuarterWidgetP::getCacheContextId(PRIVATE(this)->cachecontext);
+}
+
+/*!
+  Returns the OpenGL context of the renderer.
+*/
+QOpenGLContext *
+QuarterOffscreenRenderer::context(void) const
+{
+  return PRIVATE(this)->context;
+}
+
+/*!
+  Returns the framebuffer object holding the most recently rendered
+  image, or NULL if nothing has been rendered yet.
+*/
+QOpenGLFramebufferObject *
+QuarterOffscreenRenderer::framebufferObject(void) const
+{
+  return PRIVATE(this)->fbo;
+}
+
+/*!
+  Makes the OpenGL context of the renderer current.
+*/
+bool
+QuarterOffscreenRenderer::makeCurrent(void)
+{
+  if (!this->isValid()) {
+    return false;
+  }
+  return PRIVATE(this)->context->makeCurrent(PRIVATE(this)->surface);
+}
+
+/*!
+  Releases the OpenGL context of the renderer.
+*/
+void
+QuarterOffscreenRenderer::doneCurrent(void)
+{
+  PRIVATE(this)->context->doneCurrent();
+}
+
+/*!
+  Reposition the camera to display the entire scene.
+*/
+void
+QuarterOffscreenRenderer::viewAll(void)
+{
+  SoNode * root = PRIVATE(this)->sorendermanager->getSceneGraph();
+  if (PRIVATE(this)->camera && root) {
+    PRIVATE(this)->camera->viewAll(root, PRIVATE(this)->sorendermanager->getViewportRegion());
+  }
+}
+
+/*
+  Sensors waiting to trigger would have been processed before a
+  redraw in QuarterWidget::paintGL() as well. The sensor queue belongs
+  to the GUI thread, so a renderer moved to a worker thread leaves it
+  alone.
+*/
+void
+QuarterOffscreenRendererP::processDelayQueue(void)
+{
+  if (QThread::currentThread() != QCoreApplication::instance()->thread()) {
+    return;
+  }
+  if (SoDB::getSensorManager()->isDelaySensorPending()) {
+    SoDB::getSensorManager()->processDelayQueue(FALSE);
+  }
+}
+
+/*!
+  Renders the scene graph into the framebuffer object. Returns false
+  if the OpenGL context could not be made current.
+*/
+bool
+QuarterOffscreenRenderer::render(void)
+{
+  QuarterOffscreenRendererP::processDelayQueue();
+
+  if (!this->makeCurrent()) {
+    return false;
+  }
+
+  PRIVATE(this)->bindFramebuffer(PRIVATE(this)->size);
+  glEnable(GL_DEPTH_TEST);
+  PRIVATE(this)->sorendermanager->render(TRUE, TRUE);
+  PRIVATE(this)->fbo->release();
+
+  this->doneCurrent();
+  return true;
+}
+
+/*!
+  Renders the scene graph and returns the result as an image, or a
+  null image if rendering failed.
+*/
+QImage
+QuarterOffscreenRenderer::grabImage(void)
+{
+  if (!this->render() || !this->makeCurrent()) {
+    return QImage();
+  }
+  QImage image = PRIVATE(this)->fbo->toImage();
+  this->doneCurrent();
+  return image;
+}
+
+/*!
+  Renders the current view at \a size, which may be far larger than
+  the maximum framebuffer size, in tiles of \a tilesize and writes it
+  to \a filename as an uncompressed tiled RGBA TIFF file. Each tile is
+  rendered with a sub-frustum of the camera into the same framebuffer
+  object and handed to a writer thread, so that only a few tiles are
+  held in memory at any time. The near and far planes are computed
+  once for the whole image, so the depth range is the same in every
+  tile. The tile size is rounded up to a multiple of 16, as required
+  by TIFF. Returns false if the scene has no perspective or
+  orthographic camera, or if the file could not be written; the file
+  is limited to 4 GB.
+
+  A camera which is part of the scene graph is temporarily replaced by
+  the tile camera while rendering.
+*/
+bool
+QuarterOffscreenRenderer::renderTiled(const QSize & size, const QString & filename,
+                                      const QSize & tilesize)
+{
+  SoRenderManager * manager = PRIVATE(this)->sorendermanager;
+  SoCamera * camera = PRIVATE(this)->camera;
+  SoNode * root = manager->getSceneGraph();
+  if (!camera || !root || size.isEmpty() || tilesize.isEmpty()) {
+    return false;
+  }
+
+  const bool perspective = camera->isOfType(SoPerspectiveCamera::getClassTypeId());
+  if (!perspective && !camera->isOfType(SoOrthographicCamera::getClassTypeId())) {
+    return false;
+  }
+
+  const QSize tile((tilesize.width() + 15) & ~15, (tilesize.height() + 15) & ~15);
+  TiffTileWriter writer(filename, size, tile);
+  if (!writer.open()) {
+    return false;
+  }
+
+  QuarterOffscreenRendererP::processDelayQueue();
+  if (!this->makeCurrent()) {
+    writer.finish();
+    return false;
+  }
+
+  // the frustum of the whole image at the near plane
+  const SbViewportRegion fullvp(size.width(), size.height());
+  const float aspect = fullvp.getViewportAspectRatio();
+  float nearval, farval;
+  PRIVATE(this)->clippingPlanes(camera, root, fullvp, nearval, farval);
+
+  float halfheight;
+  if (perspective) {
+    const float angle = static_cast<SoPerspectiveCamera *>(camera)->heightAngle.getValue();
+    halfheight = nearval * float(tan(angle * 0.5f));
+  }
+  else {
+    halfheight = static_cast<SoOrthographicCamera *>(camera)->height.getValue() * 0.5f;
+  }
+  if (camera->viewportMapping.getValue() == SoCamera::ADJUST_CAMERA && aspect < 1.0f) {
+    halfheight /= aspect;
+  }
+  const float halfwidth = halfheight * aspect;
+
+  const SbRotation orientation = camera->orientation.getValue();
+  SbVec3f right, up;
+  orientation.multVec(SbVec3f(1.0f, 0.0f, 0.0f), right);
+  orientation.multVec(SbVec3f(0.0f, 1.0f, 0.0f), up);
+
+  SoCamera * tilecamera;
+  if (perspective) tilecamera = new SoFrustumCamera;
+  else tilecamera = new SoOrthographicCamera;
+  tilecamera->ref();
+  tilecamera->viewportMapping = SoCamera::LEAVE_ALONE;
+  tilecamera->orientation = orientation;
+  tilecamera->nearDistance = nearval;
+  tilecamera->farDistance = farval;
+  tilecamera->focalDistance = camera->focalDistance.getValue();
+  tilecamera->aspectRatio = float(tile.width()) / float(tile.height());
+
+  // put the tile camera where the camera is in the scene graph
+  SoSearchAction search;
+  search.setNode(camera);
+  search.setInterest(SoSearchAction::FIRST);
+  search.apply(root);
+  SoPath * path = search.getPath();
+  SoGroup * parent = NULL;
+  int index = -1;
+  if (path && path->getLength() > 1) {
+    path->ref();
+    parent = static_cast<SoGroup *>(path->getNodeFromTail(1));
+    index = path->getIndexFromTail(0);
+    path->unref();
+  }
+  if (!parent) {
+    tilecamera->unref();
+    this->doneCurrent();
+    writer.finish();
+    return false;
+  }
+
+  const SoRenderManager::AutoClippingStrategy clipping = manager->getAutoClipping();
+  manager->setAutoClipping(SoRenderManager::NO_AUTO_CLIPPING);
+  parent->replaceChild(index, tilecamera);
+  manager->setCamera(tilecamera);
+  manager->setViewportRegion(SbViewportRegion(tile.width(), tile.height()));
+
+  const int columns = (size.width() + tile.width() - 1) / tile.width();
+  const int rows = (size.height() + tile.height() - 1) / tile.height();
+  bool ok = true;
+  for (int row = 0; row < rows && ok; row++) {
+    for (int column = 0; column < columns && ok; column++) {
+      // tiles are counted from the top left, the frustum from the
+      // bottom left; tiles at the right and bottom edges reach beyond
+      // the image and are cropped by the TIFF reader
+      const float left = -halfwidth + 2.0f * halfwidth * float(column * tile.width()) / size.width();
+      const float rightval = -halfwidth + 2.0f * halfwidth * float((column + 1) * tile.width()) / size.width();
+      const float top = halfheight - 2.0f * halfheight * float(row * tile.height()) / size.height();
+      const float bottom = halfheight - 2.0f * halfheight * float((row + 1) * tile.height()) / size.height();
+
+      if (perspective) {
+        SoFrustumCamera * frustum = static_cast<SoFrustumCamera *>(tilecamera);
+        frustum->position = camera->position.getValue();
+        frustum->left = left;
+        frustum->right = rightval;
+        frustum->top = top;
+        frustum->bottom = bottom;
+      }
+      else {
+        SoOrthographicCamera * ortho = static_cast<SoOrthographicCamera *>(tilecamera);
+        ortho->position = camera->position.getValue() +
+          right * ((left + rightval) * 0.5f) + up * ((top + bottom) * 0.5f);
+        ortho->height = top - bottom;
+      }
+
+      ok = PRIVATE(this)->bindFramebuffer(tile);
+      if (ok) {
+        glEnable(GL_DEPTH_TEST);
+        manager->render(TRUE, TRUE);
+        PRIVATE(this)->fbo->release();
+        const QImage image = PRIVATE(this)->fbo->toImage().convertToFormat(QImage::Format_RGBA8888);
+        writer.post(row * columns + column, image);
+      }
+    }
+  }
+
+  manager->setViewportRegion(SbViewportRegion(PRIVATE(this)->size.width(), PRIVATE(this)->size.height()));
+  manager->setCamera(camera);
+  parent->replaceChild(index, camera);
+  manager->setAutoClipping(clipping);
+  tilecamera->unref();
+  this->doneCurrent();
+
+  return writer.finish() && ok;
+}
+
+/*
+  Makes sure the framebuffer object has \a size and binds it.
+ */
+bool
+QuarterOffscreenRendererP::bindFramebuffer(const QSize & size)
+{
+  if (!this->fbo || this->fbo->size() != size) {
+    delete this->fbo;
+    QOpenGLFramebufferObjectFormat format;
+    format.setAttachment(QOpenGLFramebufferObject::CombinedDepthStencil);
+    this->fbo = new QOpenGLFramebufferObject(size, format);
+  }
+  return this->fbo->bind();
+}
+
+/*
+  Computes near and far planes fitting the bounding box of \a root,
+  like the render manager's auto clipping does, so that they can be
+  used for every tile of an image.
+ */
+void
+QuarterOffscreenRendererP::clippingPlanes(SoCamera * camera, SoNode * root,
+                                          const SbViewportRegion & vp,
+                                          float & nearval, float & farval) const
+{
+  nearval = camera->nearDistance.getValue();
+  farval = camera->farDistance.getValue();
+
+  const SoRenderManager::AutoClippingStrategy clipping = this->sorendermanager->getAutoClipping();
+  if (clipping == SoRenderManager::NO_AUTO_CLIPPING) return;
+
+  SoGetBoundingBoxAction action(vp);
+  action.apply(root);
+
+  // the tiles are rendered into a framebuffer object with a 24 bit
+  // depth buffer, which may not be bound yet
+  float boxnear, boxfar;
+  if (BoundingBoxCache::clippingPlanes(camera, action.getXfBoundingBox(), clipping,
+                                       this->sorendermanager->getNearPlaneValue(), 24,
+                                       boxnear, boxfar)) {
+    nearval = boxnear;
+    farval = boxfar;
+  }
+}
+
+/*!
+  Configures Qt to render without a display server, and must be
+  called before the QGuiApplication is constructed. If no Qt platform
+  has been chosen through QT_QPA_PLATFORM and there is no X11 or
+  Wayland display, the eglfs platform is selected with its device
+  integration, cursor and input handling switched off, and Mesa's EGL
+  is asked for its surfaceless platform. Offscreen surfaces are then
+  EGL pbuffers, or no surface at all where EGL_KHR_surfaceless_context
+  is supported, and the GPU is used without Xvfb. Variables already
+  set in the environment are left alone, so that for instance
+  QT_QPA_EGLFS_INTEGRATION=eglfs_kms_egldevice can select an EGL
+  device on NVIDIA drivers.
+
+  Returns true if the headless platform was selected. Does nothing on
+  Windows and macOS, which render offscreen without a display server
+  anyway.
+*/
+bool
+QuarterOffscreenRenderer::setupHeadlessPlatform(void)
+{
+#if defined(Q_OS_UNIX) && !defined(Q_OS_MACOS) && !defined(Q_OS_MAC)
+  if (QCoreApplication::instance()) {
+    SoDebugError::postWarning("QuarterOffscreenRenderer::setupHeadlessPlatform",
+                              "Must be called before the application is constructed.");
+    return false;
+  }
+  if (!qgetenv("QT_QPA_PLATFORM").isEmpty() ||
+      !qgetenv("DISPLAY").isEmpty() || !qgetenv("WAYLAND_DISPLAY").isEmpty()) {
+    return false;
+  }
+
+  static const char * const defaults[][2] = {
+    { "QT_QPA_PLATFORM", "eglfs" },
+    { "QT_QPA_EGLFS_INTEGRATION", "none" },
+    { "QT_QPA_EGLFS_HIDECURSOR", "1" },
+    { "QT_QPA_EGLFS_DISABLE_INPUT", "1" },
+    { "EGL_PLATFORM", "surfaceless" }
+  };
+  for (size_t i = 0; i < sizeof(defaults) / sizeof(defaults[0]); i++) {
+    if (qgetenv(defaults[i][0]).isEmpty()) {
+      qputenv(defaults[i][0], QByteArray(defaults[i][1]));
+    }
+  }
+  return true;
+#else
+  return false;
+#endif
+}
+
+#undef PRIVATE
+
+#endif // QT_VERSION >= 0x050000
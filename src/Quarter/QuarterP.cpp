@@ -1,18 +1,61 @@
 #include "QuarterP.h"
 #include "SensorManager.h"
 #include "ImageReader.h"
-#include "KeyboardP.h"
+#include "FrameScheduler.h"
+#include "SensorProfiler.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <QHash>
+#include <QString>
+
+#include <Inventor/SoInteraction.h>
+#include <Inventor/C/tidbits.h>
+#include <Inventor/nodekits/SoNodeKit.h>
+#include <Inventor/scxml/ScXMLDocument.h>
+#include <Inventor/sensors/SoOneShotSensor.h>
+#include <Quarter/SceneUpdateQueue.h>
 
 using namespace SIM::Coin3D::Quarter;
 QuarterP::StateCursorMap * QuarterP::statecursormap = NULL;
+FrameScheduler * QuarterP::framescheduler = NULL;
+SensorProfiler * QuarterP::sensorprofiler = NULL;
+SoOneShotSensor * QuarterP::sceneupdatesensor = NULL;
+QuarterP::NavigationFileCache * QuarterP::navigationfilecache = NULL;
 
-QuarterP::QuarterP(void)
+static void
+sceneupdatecb(void *, SoSensor *)
 {
+  SceneUpdateQueue::flush();
+}
+
+QuarterP::QuarterP(bool initCoin)
+{
+  this->initCoin = initCoin;
+  this->initcomplete = false;
+
+  SbTime start = SbTime::getTimeOfDay();
   this->sensormanager = new SensorManager;
-  this->imagereader = new ImageReader;
+  QuarterP::reportPhase("SensorManager", start);
+
+  // created by completeInit() or on first use
+  this->imagereader = NULL;
+
+  start = SbTime::getTimeOfDay();
   assert(QuarterP::statecursormap == NULL);
   QuarterP::statecursormap = new StateCursorMap;
-
+  assert(QuarterP::navigationfilecache == NULL);
+  QuarterP::navigationfilecache = new NavigationFileCache;
+  assert(QuarterP::framescheduler == NULL);
+  QuarterP::framescheduler = new FrameScheduler;
+  assert(QuarterP::sensorprofiler == NULL);
+  QuarterP::sensorprofiler = new SensorProfiler;
+  // ahead of the default priority, and of redraws
+  QuarterP::sceneupdatesensor = new SoOneShotSensor(sceneupdatecb, NULL);
+  QuarterP::sceneupdatesensor->setPriority(1);
+  if (!SceneUpdateQueue::isEmpty()) QuarterP::sceneupdatesensor->schedule();
+  QuarterP::reportPhase("QuarterP", start);
 }
 
 QuarterP::~QuarterP()
@@ -23,15 +66,78 @@ QuarterP::~QuarterP()
   assert(QuarterP::statecursormap != NULL);
   delete QuarterP::statecursormap;
 
-  // FIXME: Why not use an atexit mechanism for this?
-  if (KeyboardP::keyboardmap != NULL) {
-    KeyboardP::keyboardmap->clear();
-    KeyboardP::keypadmap->clear();
-    delete KeyboardP::keyboardmap;
-    delete KeyboardP::keypadmap;
-    KeyboardP::keyboardmap = NULL;
-    KeyboardP::keypadmap = NULL;
+  assert(QuarterP::navigationfilecache != NULL);
+  qDeleteAll(*QuarterP::navigationfilecache);
+  delete QuarterP::navigationfilecache;
+  QuarterP::navigationfilecache = NULL;
+
+  delete QuarterP::framescheduler;
+  QuarterP::framescheduler = NULL;
+
+  delete QuarterP::sensorprofiler;
+  QuarterP::sensorprofiler = NULL;
+
+  SoOneShotSensor * sensor = QuarterP::sceneupdatesensor;
+  QuarterP::sceneupdatesensor = NULL;
+  delete sensor;
+  // the scene graphs the edits are for may be gone by now
+  SceneUpdateQueue::clear();
+
+}
+
+/*
+  Runs the parts of the initialization that Quarter::init() skips in
+  deferred mode: the nodekit and interaction classes and the image
+  reader. Does nothing when called again.
+ */
+void
+QuarterP::completeInit(void)
+{
+  if (this->initcomplete) return;
+  this->initcomplete = true;
+
+  if (this->initCoin) {
+    SbTime start = SbTime::getTimeOfDay();
+    SoNodeKit::init();
+    QuarterP::reportPhase("SoNodeKit::init", start);
+
+    start = SbTime::getTimeOfDay();
+    SoInteraction::init();
+    QuarterP::reportPhase("SoInteraction::init", start);
   }
+  this->imageReader();
+}
 
+/*
+  Returns the image reader, registering it with SbImage first if that
+  has not happened yet.
+ */
+ImageReader *
+QuarterP::imageReader(void)
+{
+  if (!this->imagereader) {
+    SbTime start = SbTime::getTimeOfDay();
+    this->imagereader = new ImageReader;
+    QuarterP::reportPhase("ImageReader", start);
+  }
+  return this->imagereader;
+}
+
+/*
+  Prints the time spent in an initialization phase when the
+  QUARTER_DEBUG_STARTUP environment variable is set.
+ */
+void
+QuarterP::reportPhase(const char * phase, const SbTime & start)
+{
+  // the environment is only consulted once
+  static int report = -1;
+  if (report < 0) {
+    const char * env = coin_getenv("QUARTER_DEBUG_STARTUP");
+    report = (env && (atoi(env) > 0)) ? 1 : 0;
+  }
+  if (report != 1) return;
 
+  const double elapsed = (SbTime::getTimeOfDay() - start).getValue();
+  fprintf(stderr, "Quarter startup: %-20s %8.3f ms\n", phase, elapsed * 1000.0);
 }
@@ -1,25 +1,42 @@
 #ifndef QUARTER_QUARTERP_H
 #define QUARTER_QUARTERP_H
 #include <Inventor/SbName.h>
+#include <Inventor/SbTime.h>
 #include <QCursor>
 #include <config.h>
 
 template <class Key, class T> class QMap;
+template <class Key, class T> class QHash;
+class QString;
+class ScXMLDocument;
+class SoOneShotSensor;
 
 namespace SIM { namespace Coin3D { namespace Quarter {
 
 class QuarterP {
  public:
-  QuarterP();
+  QuarterP(bool initCoin);
   ~QuarterP();
 
+  void completeInit(void);
+  class ImageReader * imageReader(void);
+  static void reportPhase(const char * phase, const SbTime & start);
+
   class SensorManager * sensormanager;
   class ImageReader * imagereader;
 
   typedef QMap<SbName, QCursor> StateCursorMap;
   static StateCursorMap * statecursormap;
 
+  static class FrameScheduler * framescheduler;
+  static class SensorProfiler * sensorprofiler;
+  static SoOneShotSensor * sceneupdatesensor;
+
+  typedef QHash<QString, ScXMLDocument *> NavigationFileCache;
+  static NavigationFileCache * navigationfilecache;
+
   bool initCoin;
+  bool initcomplete;
 };
 
 }}};
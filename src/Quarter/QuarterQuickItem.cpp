@@ -0,0 +1,895 @@
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+/*!
+  \class SIM::Coin3D::Quarter::QuarterQuickItem QuarterQuickItem.h Quarter/QuarterQuickItem.h
+
+  \brief The QuarterQuickItem class provides a Qt Quick item for Coin
+  rendering.
+
+  QuarterQuickItem renders the scene graph into a framebuffer object
+  on the render thread of Qt Quick's threaded render loop, so that the
+  item can be composed with other QML items without stalling the GUI
+  thread.
+
+  The scene graph, the camera, the event manager and the navigation
+  state machine live on the GUI thread, where Quarter's sensor
+  handling processes them as for QuarterWidget. The renderer keeps its
+  own copy of the scene which is brought up to date while the GUI
+  thread is blocked in the synchronization step. Camera and headlight
+  changes are copied field by field, while any other change to the
+  scene graph makes the renderer copy the scene again, so scenes that
+  animate every frame pay for a copy every frame. The copy is cut off
+  from engines and global fields such as realTime, and its
+  self-animating nodes are stopped, so it only changes with the next
+  copy.
+
+  The item translates mouse, wheel and key events with the Mouse and
+  Keyboard devices, but does not provide a context menu or the
+  interaction mode.
+
+  \code
+  qmlRegisterType<QuarterQuickItem>("Quarter", 1, 0, "QuarterItem");
+  \endcode
+
+  With Qt 6 the item requires the OpenGL graphics API, which is
+  selected by calling
+  QQuickWindow::setGraphicsApi(QSGRendererInterface::OpenGL) before
+  the first window is created.
+
+  This class is only available with Qt 5.2 or later, and only if
+  Quarter is built with QUARTER_BUILD_QUICK enabled.
+*/
+
+#include <assert.h>
+
+#include <Quarter/QuarterQuickItem.h>
+#include <Quarter/Quarter.h>
+
+#if QT_VERSION >= 0x050200
+
+#include <QCursor>
+#include <QHoverEvent>
+#include <QKeyEvent>
+#include <QMouseEvent>
+#include <QOpenGLContext>
+#include <QCoreApplication>
+#include <QOpenGLFramebufferObject>
+#include <QPointer>
+#include <QQuickWindow>
+#include <QThread>
+#include <QResizeEvent>
+#include <QWheelEvent>
+#if QT_VERSION >= 0x060000
+#include <QQuickOpenGLUtils>
+#endif
+
+#include <Inventor/SbColor4f.h>
+#include <Inventor/SbTime.h>
+#include <Inventor/SbViewportRegion.h>
+#include <Inventor/SoEventManager.h>
+#include <Inventor/SoRenderManager.h>
+#include <Inventor/actions/SoGLRenderAction.h>
+#include <Inventor/actions/SoSearchAction.h>
+#include <Inventor/events/SoEvent.h>
+#include <Inventor/fields/SoField.h>
+#include <Inventor/lists/SoFieldList.h>
+#include <Inventor/nodes/SoBlinker.h>
+#include <Inventor/nodes/SoCamera.h>
+#include <Inventor/nodes/SoDirectionalLight.h>
+#include <Inventor/nodes/SoPendulum.h>
+#include <Inventor/nodes/SoPerspectiveCamera.h>
+#include <Inventor/nodes/SoRotor.h>
+#include <Inventor/nodes/SoSeparator.h>
+#include <Inventor/nodes/SoShuttle.h>
+#include <Inventor/scxml/SoScXMLStateMachine.h>
+#include <Inventor/sensors/SoNodeSensor.h>
+#include <Inventor/system/gl.h>
+
+#include <Quarter/devices/Keyboard.h>
+#include <Quarter/devices/Mouse.h>
+
+#include "QuarterP.h"
+#include "QuarterWidgetP.h"
+
+namespace SIM { namespace Coin3D { namespace Quarter {
+
+class QuarterQuickItemP {
+public:
+  QuarterQuickItemP(QuarterQuickItem * master) {
+    this->master = master;
+    this->scene = NULL;
+    this->superscene = NULL;
+    this->camera = NULL;
+    this->internalcamera = false;
+    this->soeventmanager = NULL;
+    this->headlight = NULL;
+    this->scenesensor = NULL;
+    this->mouse = NULL;
+    this->keyboard = NULL;
+    this->currentStateMachine = NULL;
+    this->backgroundcolor = SbColor4f(0.0f, 0.0f, 0.0f, 0.0f);
+    this->scenedirty = true;
+  }
+
+  bool translateEvent(InputDevice * device, QEvent * event);
+
+  static void scenesensorcb(void * closure, SoSensor * sensor);
+  static void statechangecb(void * userdata, ScXMLStateMachine * statemachine,
+                            const char * stateid, SbBool enter, SbBool success);
+
+  QuarterQuickItem * master;
+  SoNode * scene;
+  SoSeparator * superscene;
+  SoCamera * camera;
+  bool internalcamera;
+  SoEventManager * soeventmanager;
+  SoDirectionalLight * headlight;
+  SoNodeSensor * scenesensor;
+  Mouse * mouse;
+  Keyboard * keyboard;
+  SoScXMLStateMachine * currentStateMachine;
+  QUrl navigationModeFile;
+  SbColor4f backgroundcolor;
+  bool scenedirty;
+};
+
+/*
+  Renders a copy of the item's scene graph on the render thread. All
+  state is taken from the item in synchronize(), the only point where
+  the renderer may touch the item. The render manager is never
+  activated, so rendering does not schedule any sensors.
+ */
+class QuarterQuickRenderer : public QQuickFramebufferObject::Renderer {
+public:
+  QuarterQuickRenderer(void);
+  virtual ~QuarterQuickRenderer();
+
+  virtual QOpenGLFramebufferObject * createFramebufferObject(const QSize & size);
+  virtual void synchronize(QQuickFramebufferObject * item);
+  virtual void render(void);
+
+private:
+  void rebuild(const QuarterQuickItemP * item);
+
+  QQuickWindow * window;
+  SoRenderManager * sorendermanager;
+  SoSeparator * root;
+  SoDirectionalLight * headlight;
+  SoCamera * camera;
+  SoCamera * owncamera;
+  SoNode * scene;
+  QuarterWidgetP_cachecontext * cachecontext;
+  SbColor4f backgroundcolor;
+};
+
+}}} // namespace
+
+#define PRIVATE(obj) obj->pimpl
+
+using namespace SIM::Coin3D::Quarter;
+
+/*
+  Triggered on every change below the super scene. Changes to the
+  camera and the headlight are copied field by field in the next
+  synchronization, anything else makes the renderer copy the scene.
+ */
+void
+QuarterQuickItemP::scenesensorcb(void * closure, SoSensor * sensor)
+{
+  QuarterQuickItemP * thisp = static_cast<QuarterQuickItemP *>(closure);
+  SoNode * trigger = static_cast<SoNodeSensor *>(sensor)->getTriggerNode();
+  if (trigger != thisp->camera && trigger != thisp->headlight) {
+    thisp->scenedirty = true;
+  }
+  thisp->master->update();
+}
+
+void
+QuarterQuickItemP::statechangecb(void * userdata, ScXMLStateMachine *,
+                                 const char * stateid, SbBool enter, SbBool)
+{
+  QuarterQuickItemP * thisp = static_cast<QuarterQuickItemP *>(userdata);
+  assert(thisp && thisp->master);
+  if (enter) {
+    SbName state(stateid);
+    if (QuarterP::statecursormap->contains(state)) {
+      thisp->master->setCursor(QuarterP::statecursormap->value(state));
+    }
+  }
+}
+
+/*
+  Translates \a event with \a device and passes the result to the
+  event manager. Returns true if the event was handled.
+ */
+bool
+QuarterQuickItemP::translateEvent(InputDevice * device, QEvent * event)
+{
+  QQuickWindow * window = this->master->window();
+  device->setDevicePixelRatio(window ? window->devicePixelRatio() : 1.0);
+
+  const SoEvent * soevent = device->translateEvent(event);
+  if (!soevent) return false;
+  const_cast<SoEvent *>(soevent)->setTime(SbTime::getTimeOfDay());
+  return this->master->processSoEvent(soevent);
+}
+
+/*
+  Cuts the renderer's copy of the scene off from the GUI thread.
+  SoNode::copy() keeps the copied engines and the connections to
+  global fields like realTime, so updates on the GUI thread would
+  otherwise notify and change nodes the render thread is traversing.
+  Every connected field is evaluated and disconnected, which also
+  lets the copied engines go, and the nodes animating themselves from
+  sensors of their own are switched off. Called in the
+  synchronization step, while the GUI thread is blocked.
+ */
+static void
+isolate_copy(SoNode * copy)
+{
+  SoSearchAction search;
+  search.setType(SoNode::getClassTypeId());
+  search.setInterest(SoSearchAction::ALL);
+  search.setSearchingAll(TRUE);
+  search.apply(copy);
+
+  const SoPathList & paths = search.getPaths();
+  for (int i = 0; i < paths.getLength(); i++) {
+    SoNode * node = paths[i]->getTail();
+    SoFieldList fields;
+    const int num = node->getFields(fields);
+    for (int j = 0; j < num; j++) {
+      if (fields[j]->isConnected()) {
+        fields[j]->evaluate();
+        fields[j]->disconnect();
+      }
+    }
+    if (node->isOfType(SoRotor::getClassTypeId())) {
+      static_cast<SoRotor *>(node)->on = FALSE;
+    }
+    else if (node->isOfType(SoShuttle::getClassTypeId())) {
+      static_cast<SoShuttle *>(node)->on = FALSE;
+    }
+    else if (node->isOfType(SoPendulum::getClassTypeId())) {
+      static_cast<SoPendulum *>(node)->on = FALSE;
+    }
+    else if (node->isOfType(SoBlinker::getClassTypeId())) {
+      static_cast<SoBlinker *>(node)->on = FALSE;
+    }
+  }
+}
+
+/*
+  Unreferences a scene copy on the GUI thread. The renderer may be
+  destroyed on the render thread while the GUI thread is running, and
+  Coin's global state touched by destroying nodes is not protected.
+ */
+class SceneReleaseEvent : public QEvent {
+public:
+  SceneReleaseEvent(SoNode * node) : QEvent(QEvent::User), node(node) { }
+  SoNode * node;
+};
+
+class SceneReleaser : public QObject {
+protected:
+  virtual void customEvent(QEvent * event) {
+    static_cast<SceneReleaseEvent *>(event)->node->unref();
+  }
+};
+
+// created on the GUI thread by the first item
+static QPointer<SceneReleaser> scenereleaser;
+
+QuarterQuickRenderer::QuarterQuickRenderer(void)
+{
+  this->window = NULL;
+  this->camera = NULL;
+  this->owncamera = NULL;
+  this->scene = NULL;
+  this->backgroundcolor = SbColor4f(0.0f, 0.0f, 0.0f, 0.0f);
+
+  // the renderer is created on the render thread while the GUI thread
+  // is blocked, so the cache context list can be updated safely
+  this->cachecontext = QuarterWidgetP::findCacheContext(this, NULL);
+
+  this->headlight = new SoDirectionalLight;
+  this->root = new SoSeparator;
+  this->root->ref();
+  this->root->addChild(this->headlight);
+
+  this->sorendermanager = new SoRenderManager;
+  this->sorendermanager->setAutoClipping(SoRenderManager::VARIABLE_NEAR_PLANE);
+  this->sorendermanager->getGLRenderAction()->setCacheContext(QuarterWidgetP::getCacheContextId(this->cachecontext));
+  this->sorendermanager->setSceneGraph(this->root);
+}
+
+QuarterQuickRenderer::~QuarterQuickRenderer()
+{
+  this->sorendermanager->setSceneGraph(NULL);
+  delete this->sorendermanager;
+
+  // the renderer may go away while the GUI thread is running, so the
+  // scene copy, and with it the camera in use, is destroyed over there
+  if (this->owncamera) {
+    if (this->root->findChild(this->owncamera) < 0) this->root->addChild(this->owncamera);
+    this->owncamera->unref();
+  }
+  if (scenereleaser && QThread::currentThread() != scenereleaser->thread()) {
+    QCoreApplication::postEvent(scenereleaser, new SceneReleaseEvent(this->root));
+  }
+  else {
+    this->root->unref();
+  }
+  if (QuarterWidgetP::removeFromCacheContext(this->cachecontext, this) &&
+      QOpenGLContext::currentContext()) {
+    QuarterWidgetP::destructCacheContext(this->cachecontext);
+  }
+}
+
+QOpenGLFramebufferObject *
+QuarterQuickRenderer::createFramebufferObject(const QSize & size)
+{
+  QOpenGLFramebufferObjectFormat format;
+  format.setAttachment(QOpenGLFramebufferObject::CombinedDepthStencil);
+  return new QOpenGLFramebufferObject(size, format);
+}
+
+/*
+  Replaces the scene copy and the camera below the render root.
+ */
+void
+QuarterQuickRenderer::rebuild(const QuarterQuickItemP * item)
+{
+  this->root->removeAllChildren();
+  this->root->addChild(this->headlight);
+  this->scene = NULL;
+  this->camera = NULL;
+
+  if (!item->scene) return;
+
+  if (item->internalcamera) {
+    if (!this->owncamera ||
+        this->owncamera->getTypeId() != item->camera->getTypeId()) {
+      if (this->owncamera) this->owncamera->unref();
+      this->owncamera = static_cast<SoCamera *>(item->camera->getTypeId().createInstance());
+      this->owncamera->ref();
+    }
+    this->root->addChild(this->owncamera);
+  }
+
+  this->scene = item->scene->copy(FALSE);
+  isolate_copy(this->scene);
+  this->root->addChild(this->scene);
+
+  this->camera = item->internalcamera ?
+    this->owncamera : QuarterWidgetP::searchForCamera(this->scene);
+}
+
+void
+QuarterQuickRenderer::synchronize(QQuickFramebufferObject * item)
+{
+  QuarterQuickItemP * pimpl = PRIVATE(static_cast<QuarterQuickItem *>(item));
+  this->window = item->window();
+
+  if (pimpl->scenedirty) {
+    this->rebuild(pimpl);
+    pimpl->scenedirty = false;
+  }
+
+  if (this->camera && pimpl->camera &&
+      this->camera->getTypeId() == pimpl->camera->getTypeId()) {
+    this->camera->copyFieldValues(pimpl->camera);
+  }
+  this->headlight->copyFieldValues(pimpl->headlight);
+  this->backgroundcolor = pimpl->backgroundcolor;
+  this->sorendermanager->setCamera(this->camera);
+}
+
+void
+QuarterQuickRenderer::render(void)
+{
+  const QSize size = this->framebufferObject()->size();
+  SbViewportRegion vp(size.width(), size.height());
+  if (this->sorendermanager->getViewportRegion().getWindowSize() != vp.getWindowSize()) {
+    this->sorendermanager->setViewportRegion(vp);
+  }
+  this->sorendermanager->setBackgroundColor(this->backgroundcolor);
+
+  // auto clipping writes the near and far planes of the camera. Keep
+  // those writes from notifying while the GUI thread is running.
+  SbBool notify = FALSE;
+  if (this->camera) notify = this->camera->enableNotify(FALSE);
+
+  glEnable(GL_DEPTH_TEST);
+  this->sorendermanager->render(TRUE, TRUE);
+
+  if (this->camera) this->camera->enableNotify(notify);
+
+#if QT_VERSION >= 0x060000
+  QQuickOpenGLUtils::resetOpenGLState();
+#else
+  if (this->window) this->window->resetOpenGLState();
+#endif
+}
+
+/*!
+  Constructor.
+*/
+QuarterQuickItem::QuarterQuickItem(QQuickItem * parent)
+  : inherited(parent)
+{
+  PRIVATE(this) = new QuarterQuickItemP(this);
+
+  Quarter::completeInit();
+
+  if (!scenereleaser) {
+    scenereleaser = new SceneReleaser;
+    scenereleaser->setParent(QCoreApplication::instance());
+  }
+
+  PRIVATE(this)->soeventmanager = new SoEventManager;
+  PRIVATE(this)->soeventmanager->setNavigationState(SoEventManager::MIXED_NAVIGATION);
+
+  PRIVATE(this)->headlight = new SoDirectionalLight;
+  PRIVATE(this)->headlight->ref();
+
+  // an immediate sensor, as the trigger node is only available to
+  // those
+  PRIVATE(this)->scenesensor = new SoNodeSensor(QuarterQuickItemP::scenesensorcb, PRIVATE(this));
+  PRIVATE(this)->scenesensor->setPriority(0);
+
+  PRIVATE(this)->mouse = new Mouse(NULL);
+  PRIVATE(this)->keyboard = new Keyboard(NULL);
+
+  this->setAcceptedMouseButtons(Qt::AllButtons);
+  this->setAcceptHoverEvents(true);
+  this->setFlag(QQuickItem::ItemIsFocusScope, true);
+}
+
+/*!
+  Destructor.
+*/
+QuarterQuickItem::~QuarterQuickItem()
+{
+  if (PRIVATE(this)->currentStateMachine) {
+    this->removeStateMachine(PRIVATE(this)->currentStateMachine);
+    QuarterWidgetP::releaseNavigationFile(PRIVATE(this)->currentStateMachine);
+  }
+  this->setSceneGraph(NULL);
+  PRIVATE(this)->headlight->unref();
+
+  delete PRIVATE(this)->scenesensor;
+  delete PRIVATE(this)->soeventmanager;
+  delete PRIVATE(this)->mouse;
+  delete PRIVATE(this)->keyboard;
+  delete PRIVATE(this);
+}
+
+/*!
+  Set the background color of the item.
+*/
+void
+QuarterQuickItem::setBackgroundColor(const QColor & color)
+{
+  PRIVATE(this)->backgroundcolor =
+    SbColor4f(SbClamp(color.red()   / 255.0, 0.0, 1.0),
+              SbClamp(color.green() / 255.0, 0.0, 1.0),
+              SbClamp(color.blue()  / 255.0, 0.0, 1.0),
+              SbClamp(color.alpha() / 255.0, 0.0, 1.0));
+  this->update();
+}
+
+/*!
+  Returns the background color of the item.
+*/
+QColor
+QuarterQuickItem::backgroundColor(void) const
+{
+  const SbColor4f & bg = PRIVATE(this)->backgroundcolor;
+
+  return QColor(SbClamp(int(bg[0] * 255.0), 0, 255),
+                SbClamp(int(bg[1] * 255.0), 0, 255),
+                SbClamp(int(bg[2] * 255.0), 0, 255),
+                SbClamp(int(bg[3] * 255.0), 0, 255));
+}
+
+/*!
+  Removes any navigation mode file set.
+*/
+void
+QuarterQuickItem::resetNavigationModeFile(void)
+{
+  this->setNavigationModeFile(QUrl());
+}
+
+/*!
+  Sets the navigation mode file. See
+  QuarterWidget::setNavigationModeFile() for the supported schemes.
+*/
+void
+QuarterQuickItem::setNavigationModeFile(const QUrl & url)
+{
+  if (url.isEmpty()) {
+    if (PRIVATE(this)->currentStateMachine) {
+      this->removeStateMachine(PRIVATE(this)->currentStateMachine);
+      QuarterWidgetP::releaseNavigationFile(PRIVATE(this)->currentStateMachine);
+      PRIVATE(this)->currentStateMachine = NULL;
+      PRIVATE(this)->navigationModeFile = url;
+    }
+    return;
+  }
+
+  SoScXMLStateMachine * newsm = QuarterWidgetP::loadNavigationFile(url);
+  if (!newsm) {
+    return;
+  }
+
+  if (PRIVATE(this)->currentStateMachine) {
+    this->removeStateMachine(PRIVATE(this)->currentStateMachine);
+    QuarterWidgetP::releaseNavigationFile(PRIVATE(this)->currentStateMachine);
+  }
+  this->addStateMachine(newsm);
+  newsm->initialize();
+  PRIVATE(this)->currentStateMachine = newsm;
+  PRIVATE(this)->navigationModeFile = url;
+
+  if (QUrl(DEFAULT_NAVIGATIONFILE) == PRIVATE(this)->navigationModeFile) {
+    QuarterWidgetP::setDefaultStateCursors();
+  }
+}
+
+/*!
+  Returns the current navigation mode file.
+*/
+const QUrl &
+QuarterQuickItem::navigationModeFile(void) const
+{
+  return PRIVATE(this)->navigationModeFile;
+}
+
+/*!
+  Returns whether the headlight is turned on.
+*/
+bool
+QuarterQuickItem::headlightEnabled(void) const
+{
+  return PRIVATE(this)->headlight->on.getValue();
+}
+
+/*!
+  Enable/disable the headlight.
+*/
+void
+QuarterQuickItem::setHeadlightEnabled(bool onoff)
+{
+  PRIVATE(this)->headlight->on = onoff;
+}
+
+/*!
+  Returns the headlight of the item.
+*/
+SoDirectionalLight *
+QuarterQuickItem::getHeadlight(void)
+{
+  return PRIVATE(this)->headlight;
+}
+
+/*!
+  Sets the scene graph to be rendered. A camera and a headlight are
+  added if the scene does not contain a camera.
+*/
+void
+QuarterQuickItem::setSceneGraph(SoNode * node)
+{
+  if (node == PRIVATE(this)->scene) {
+    return;
+  }
+
+  PRIVATE(this)->scenesensor->detach();
+  if (PRIVATE(this)->scene) {
+    PRIVATE(this)->scene->unref();
+    PRIVATE(this)->scene = NULL;
+  }
+  if (PRIVATE(this)->superscene) {
+    PRIVATE(this)->superscene->unref();
+    PRIVATE(this)->superscene = NULL;
+  }
+
+  SoCamera * camera = NULL;
+  bool viewall = false;
+
+  if (node) {
+    PRIVATE(this)->scene = node;
+    PRIVATE(this)->scene->ref();
+
+    PRIVATE(this)->superscene = new SoSeparator;
+    PRIVATE(this)->superscene->ref();
+    PRIVATE(this)->superscene->addChild(PRIVATE(this)->headlight);
+
+    // if the scene does not contain a camera, add one
+    if (!(camera = QuarterWidgetP::searchForCamera(node))) {
+      camera = new SoPerspectiveCamera;
+      PRIVATE(this)->superscene->addChild(camera);
+      viewall = true;
+    }
+
+    PRIVATE(this)->superscene->addChild(node);
+    PRIVATE(this)->scenesensor->attach(PRIVATE(this)->superscene);
+  }
+
+  PRIVATE(this)->camera = camera;
+  PRIVATE(this)->internalcamera = viewall;
+  PRIVATE(this)->soeventmanager->setCamera(camera);
+  PRIVATE(this)->soeventmanager->setSceneGraph(PRIVATE(this)->superscene);
+
+  for (int c = 0; c < PRIVATE(this)->soeventmanager->getNumSoScXMLStateMachines(); ++c) {
+    SoScXMLStateMachine * sostatemachine =
+      PRIVATE(this)->soeventmanager->getSoScXMLStateMachine(c);
+    sostatemachine->setSceneGraphRoot(PRIVATE(this)->superscene);
+    sostatemachine->setActiveCamera(camera);
+  }
+
+  PRIVATE(this)->scenedirty = true;
+  if (viewall) { this->viewAll(); }
+  this->update();
+}
+
+/*!
+  Returns the scene graph set with setSceneGraph().
+*/
+SoNode *
+QuarterQuickItem::getSceneGraph(void) const
+{
+  return PRIVATE(this)->scene;
+}
+
+/*!
+  Returns the event manager of the item.
+*/
+SoEventManager *
+QuarterQuickItem::getSoEventManager(void) const
+{
+  return PRIVATE(this)->soeventmanager;
+}
+
+/*!
+  Adds a state machine to the item's event manager.
+*/
+void
+QuarterQuickItem::addStateMachine(SoScXMLStateMachine * statemachine)
+{
+  SoEventManager * em = this->getSoEventManager();
+  em->addSoScXMLStateMachine(statemachine);
+  statemachine->setSceneGraphRoot(PRIVATE(this)->superscene);
+  statemachine->setActiveCamera(PRIVATE(this)->camera);
+  statemachine->addStateChangeCallback(QuarterQuickItemP::statechangecb, PRIVATE(this));
+}
+
+/*!
+  Removes a state machine from the item's event manager.
+*/
+void
+QuarterQuickItem::removeStateMachine(SoScXMLStateMachine * statemachine)
+{
+  SoEventManager * em = this->getSoEventManager();
+  statemachine->setSceneGraphRoot(NULL);
+  statemachine->setActiveCamera(NULL);
+  em->removeSoScXMLStateMachine(statemachine);
+}
+
+/*!
+  Passes an SoEvent to the event manager.
+*/
+bool
+QuarterQuickItem::processSoEvent(const SoEvent * event)
+{
+  return
+    event &&
+    PRIVATE(this)->soeventmanager &&
+    PRIVATE(this)->soeventmanager->processEvent(event);
+}
+
+/*!
+  Creates the renderer. Called by Qt Quick on the render thread.
+*/
+QQuickFramebufferObject::Renderer *
+QuarterQuickItem::createRenderer(void) const
+{
+  return new QuarterQuickRenderer;
+}
+
+/*!
+  Views the entire scene.
+*/
+void
+QuarterQuickItem::viewAll(void)
+{
+  const SbName viewallevent("sim.coin3d.coin.navigation.ViewAll");
+  for (int c = 0; c < PRIVATE(this)->soeventmanager->getNumSoScXMLStateMachines(); ++c) {
+    SoScXMLStateMachine * sostatemachine =
+      PRIVATE(this)->soeventmanager->getSoScXMLStateMachine(c);
+    if (sostatemachine->isActive()) {
+      sostatemachine->queueEvent(viewallevent);
+      sostatemachine->processEventQueue();
+    }
+  }
+}
+
+/*!
+  Sets the item in seek mode.
+*/
+void
+QuarterQuickItem::seek(void)
+{
+  const SbName seekevent("sim.coin3d.coin.navigation.Seek");
+  for (int c = 0; c < PRIVATE(this)->soeventmanager->getNumSoScXMLStateMachines(); ++c) {
+    SoScXMLStateMachine * sostatemachine =
+      PRIVATE(this)->soeventmanager->getSoScXMLStateMachine(c);
+    if (sostatemachine->isActive()) {
+      sostatemachine->queueEvent(seekevent);
+      sostatemachine->processEventQueue();
+    }
+  }
+}
+
+/*!
+  \reimp
+*/
+void
+#if QT_VERSION >= 0x060000
+QuarterQuickItem::geometryChange(const QRectF & newgeometry, const QRectF & oldgeometry)
+#else
+QuarterQuickItem::geometryChanged(const QRectF & newgeometry, const QRectF & oldgeometry)
+#endif
+{
+#if QT_VERSION >= 0x060000
+  inherited::geometryChange(newgeometry, oldgeometry);
+#else
+  inherited::geometryChanged(newgeometry, oldgeometry);
+#endif
+
+  const QSize size = newgeometry.size().toSize();
+  const qreal ratio = this->window() ? this->window()->devicePixelRatio() : 1.0;
+  SbViewportRegion vp(int(size.width() * ratio), int(size.height() * ratio));
+  PRIVATE(this)->soeventmanager->setViewportRegion(vp);
+
+  // the devices flip the y coordinate against the item height
+  QResizeEvent resize(size, oldgeometry.size().toSize());
+  PRIVATE(this)->mouse->translateEvent(&resize);
+  const SbVec2s windowsize(short(size.width()), short(size.height()));
+  PRIVATE(this)->mouse->setWindowSize(windowsize);
+  PRIVATE(this)->keyboard->setWindowSize(windowsize);
+}
+
+/*!
+  \reimp
+*/
+void
+QuarterQuickItem::mousePressEvent(QMouseEvent * event)
+{
+  this->forceActiveFocus(Qt::MouseFocusReason);
+  PRIVATE(this)->translateEvent(PRIVATE(this)->mouse, event);
+  // accept the press even if unhandled to keep receiving the drag
+  event->accept();
+}
+
+/*!
+  \reimp
+*/
+void
+QuarterQuickItem::mouseMoveEvent(QMouseEvent * event)
+{
+  PRIVATE(this)->translateEvent(PRIVATE(this)->mouse, event);
+  event->accept();
+}
+
+/*!
+  \reimp
+*/
+void
+QuarterQuickItem::mouseReleaseEvent(QMouseEvent * event)
+{
+  PRIVATE(this)->translateEvent(PRIVATE(this)->mouse, event);
+  event->accept();
+}
+
+/*!
+  \reimp
+*/
+void
+QuarterQuickItem::mouseDoubleClickEvent(QMouseEvent * event)
+{
+  PRIVATE(this)->translateEvent(PRIVATE(this)->mouse, event);
+  event->accept();
+}
+
+/*!
+  \reimp
+
+  Hover events are passed on as mouse moves without buttons pressed.
+*/
+void
+QuarterQuickItem::hoverMoveEvent(QHoverEvent * event)
+{
+#if QT_VERSION >= 0x060000
+  const QPointF pos = event->position();
+#else
+  const QPointF pos = event->posF();
+#endif
+  QMouseEvent move(QEvent::MouseMove, pos, Qt::NoButton, Qt::NoButton, event->modifiers());
+  PRIVATE(this)->translateEvent(PRIVATE(this)->mouse, &move);
+  event->accept();
+}
+
+/*!
+  \reimp
+*/
+void
+QuarterQuickItem::wheelEvent(QWheelEvent * event)
+{
+  if (PRIVATE(this)->translateEvent(PRIVATE(this)->mouse, event)) {
+    event->accept();
+  } else {
+    event->ignore();
+  }
+}
+
+/*!
+  \reimp
+*/
+void
+QuarterQuickItem::keyPressEvent(QKeyEvent * event)
+{
+  if (PRIVATE(this)->translateEvent(PRIVATE(this)->keyboard, event)) {
+    event->accept();
+  } else {
+    event->ignore();
+  }
+}
+
+/*!
+  \reimp
+*/
+void
+QuarterQuickItem::keyReleaseEvent(QKeyEvent * event)
+{
+  if (PRIVATE(this)->translateEvent(PRIVATE(this)->keyboard, event)) {
+    event->accept();
+  } else {
+    event->ignore();
+  }
+}
+
+#endif // QT_VERSION >= 0x050200
+
+#undef PRIVATE
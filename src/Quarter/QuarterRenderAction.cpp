@@ -0,0 +1,683 @@
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+/*
+  QuarterRenderAction is the GL render action QuarterWidget installs
+  in its render manager for the features that need control over the
+  traversal of separators and shapes.
+
+  With occlusion culling, separators that were hidden behind other
+  geometry in the previous frame are skipped. Before a separator is
+  traversed, its bounding box is drawn with color and depth writes
+  disabled inside a GL_SAMPLES_PASSED query. The result is read back
+  in a later frame, so the pipeline is never stalled waiting for it,
+  and decides whether the separator is traversed or skipped the next
+  time it is reached. Occluded separators are tested every frame,
+  visible ones only every few frames.
+
+  With a shape filter, only the opaque or only the transparent shapes
+  are rendered, the latter with blending set up by the caller. This is
+  used for the passes of weighted blended transparency.
+
+  With a projection jitter, the projection set up by the camera is
+  offset by a fraction of a pixel, for accumulation antialiasing.
+
+  Render caches would record the queries and the filtering, so only
+  separators without separators below them are rendered with caching,
+  and only when all shapes are rendered. The others are traversed
+  without it, and tested as well, so that a whole occluded subgraph
+  is skipped at once.
+ */
+
+#include "QuarterRenderAction.h"
+
+#include <Inventor/SbMatrix.h>
+#include <Inventor/SbVec2f.h>
+#include <Inventor/SbViewVolume.h>
+#include <Inventor/SbViewportRegion.h>
+#include <Inventor/SbXfBox3f.h>
+#include <Inventor/SoPath.h>
+#include <Inventor/SoRenderManager.h>
+#include <Inventor/actions/SoGetBoundingBoxAction.h>
+#include <Inventor/actions/SoSearchAction.h>
+#include <Inventor/elements/SoDepthBufferElement.h>
+#include <Inventor/elements/SoLazyElement.h>
+#include <Inventor/elements/SoModelMatrixElement.h>
+#include <Inventor/elements/SoProjectionMatrixElement.h>
+#include <Inventor/elements/SoTextureEnabledElement.h>
+#include <Inventor/elements/SoTextureImageElement.h>
+#include <Inventor/elements/SoViewVolumeElement.h>
+#include <Inventor/elements/SoViewingMatrixElement.h>
+#include <Inventor/elements/SoViewportRegionElement.h>
+#include <Inventor/misc/SoState.h>
+#include <Inventor/nodes/SoCamera.h>
+#include <Inventor/nodes/SoSeparator.h>
+#include <Inventor/nodes/SoShape.h>
+
+#include <Quarter/QuarterWidget.h>
+
+#ifndef GL_SAMPLES_PASSED
+#define GL_SAMPLES_PASSED 0x8914
+#endif
+#ifndef GL_QUERY_RESULT
+#define GL_QUERY_RESULT 0x8866
+#endif
+#ifndef GL_QUERY_RESULT_AVAILABLE
+#define GL_QUERY_RESULT_AVAILABLE 0x8867
+#endif
+
+namespace SIM { namespace Coin3D { namespace Quarter {
+
+SO_ACTION_SOURCE(QuarterRenderAction);
+
+}}} // namespace
+
+using namespace SIM::Coin3D::Quarter;
+
+// visible separators are retested every VISIBLE_QUERY_INTERVAL frames
+static const uint32_t VISIBLE_QUERY_INTERVAL = 4;
+// entries not reached for STALE_FRAMES frames are removed
+static const uint32_t STALE_FRAMES = 64;
+
+/*
+  Identifies a separator by the path down to it, so that every
+  instance of a shared separator gets its own visibility.
+ */
+static quint64
+path_key(const SoPath * path)
+{
+  quint64 key = Q_UINT64_C(14695981039346656037);
+  key ^= quint64(reinterpret_cast<quintptr>(path->getHead()));
+  key *= Q_UINT64_C(1099511628211);
+  for (int i = 1; i < path->getLength(); i++) {
+    key ^= quint64(path->getIndex(i));
+    key *= Q_UINT64_C(1099511628211);
+  }
+  return key;
+}
+
+static void
+draw_box(const SbBox3f & box)
+{
+  const SbVec3f & l = box.getMin();
+  const SbVec3f & h = box.getMax();
+
+  glBegin(GL_QUADS);
+  glVertex3f(l[0], l[1], l[2]); glVertex3f(l[0], h[1], l[2]);
+  glVertex3f(h[0], h[1], l[2]); glVertex3f(h[0], l[1], l[2]);
+
+  glVertex3f(l[0], l[1], h[2]); glVertex3f(h[0], l[1], h[2]);
+  glVertex3f(h[0], h[1], h[2]); glVertex3f(l[0], h[1], h[2]);
+
+  glVertex3f(l[0], l[1], l[2]); glVertex3f(h[0], l[1], l[2]);
+  glVertex3f(h[0], l[1], h[2]); glVertex3f(l[0], l[1], h[2]);
+
+  glVertex3f(l[0], h[1], l[2]); glVertex3f(l[0], h[1], h[2]);
+  glVertex3f(h[0], h[1], h[2]); glVertex3f(h[0], h[1], l[2]);
+
+  glVertex3f(l[0], l[1], l[2]); glVertex3f(l[0], l[1], h[2]);
+  glVertex3f(l[0], h[1], h[2]); glVertex3f(l[0], h[1], l[2]);
+
+  glVertex3f(h[0], l[1], l[2]); glVertex3f(h[0], h[1], l[2]);
+  glVertex3f(h[0], h[1], h[2]); glVertex3f(h[0], l[1], h[2]);
+  glEnd();
+}
+
+/*
+  Returns true if the shape about to be rendered is transparent, from
+  its material or its texture.
+ */
+static bool
+is_transparent(SoState * state)
+{
+  const SoLazyElement * lazy = SoLazyElement::getInstance(state);
+  for (int i = 0; i < lazy->getNumTransparencies(); i++) {
+    if (SoLazyElement::getTransparency(state, i) > 0.0f) return true;
+  }
+  return SoTextureEnabledElement::get(state) &&
+    SoTextureImageElement::containsTransparency(state);
+}
+
+/*
+  Copies the settings the rest of Quarter changes on the render
+  manager's action, so that swapping actions is not noticed.
+ */
+void
+QuarterRenderAction::copySettings(const SoGLRenderAction * from, SoGLRenderAction * to)
+{
+  to->setViewportRegion(from->getViewportRegion());
+  to->setCacheContext(from->getCacheContext());
+  to->setTransparencyType(from->getTransparencyType());
+  to->setSmoothing(from->isSmoothing());
+  to->setNumPasses(from->getNumPasses());
+  to->setPassUpdate(from->isPassUpdate());
+  to->setSortedLayersNumPasses(from->getSortedLayersNumPasses());
+  to->setDelayedObjDepthWrite(from->getDelayedObjDepthWrite());
+}
+
+void
+QuarterRenderAction::initClass(void)
+{
+  SO_ACTION_INIT_CLASS(QuarterRenderAction, SoGLRenderAction);
+
+  SO_ACTION_ADD_METHOD(SoSeparator, separatorMethod);
+  SO_ACTION_ADD_METHOD(SoShape, shapeMethod);
+  SO_ACTION_ADD_METHOD(SoCamera, cameraMethod);
+}
+
+QuarterRenderAction::QuarterRenderAction(const SbViewportRegion & vp)
+  : inherited(vp)
+{
+  SO_ACTION_CONSTRUCTOR(QuarterRenderAction);
+
+  this->bboxaction = new SoGetBoundingBoxAction(vp);
+  this->searchaction = new SoSearchAction;
+  this->culling = false;
+  this->filter = ALL_SHAPES;
+  this->blending[0] = GL_SRC_ALPHA;
+  this->blending[1] = GL_ONE_MINUS_SRC_ALPHA;
+  this->blending[2] = GL_ONE;
+  this->blending[3] = GL_ONE_MINUS_SRC_ALPHA;
+  this->jitter.setValue(0.0f, 0.0f);
+  this->glue = NULL;
+  this->frame = 0;
+  this->numqueries = 0;
+}
+
+QuarterRenderAction::~QuarterRenderAction()
+{
+  delete this->bboxaction;
+  delete this->searchaction;
+}
+
+void
+QuarterRenderAction::setOcclusionCulling(bool yes)
+{
+  this->culling = yes;
+}
+
+bool
+QuarterRenderAction::occlusionCulling(void) const
+{
+  return this->culling;
+}
+
+/*
+  Selects the shapes that are rendered. Transparent shapes rendered
+  with TRANSPARENT_SHAPES do not write depth, and are blended with the
+  factors given to setTransparentBlending().
+ */
+void
+QuarterRenderAction::setShapeFilter(ShapeFilter filter)
+{
+  this->filter = filter;
+}
+
+QuarterRenderAction::ShapeFilter
+QuarterRenderAction::shapeFilter(void) const
+{
+  return this->filter;
+}
+
+void
+QuarterRenderAction::setTransparentBlending(GLenum srcrgb, GLenum dstrgb,
+                                            GLenum srcalpha, GLenum dstalpha)
+{
+  this->blending[0] = srcrgb;
+  this->blending[1] = dstrgb;
+  this->blending[2] = srcalpha;
+  this->blending[3] = dstalpha;
+}
+
+/*
+  Sets the offset, in pixels, that is added to the projection of
+  every camera the action traverses.
+ */
+void
+QuarterRenderAction::setProjectionJitter(const SbVec2f & pixels)
+{
+  this->jitter = pixels;
+}
+
+const SbVec2f &
+QuarterRenderAction::projectionJitter(void) const
+{
+  return this->jitter;
+}
+
+bool
+QuarterRenderAction::hasQueries(void) const
+{
+  return this->numqueries > 0;
+}
+
+/*
+  Deletes the query objects. Must be called with the GL context of
+  the action's cache context current.
+ */
+void
+QuarterRenderAction::releaseQueries(void)
+{
+  if (this->numqueries > 0) {
+    const cc_glglue * glue = cc_glglue_instance(int(this->getCacheContext()));
+    QHash<quint64, Entry>::iterator it = this->entries.begin();
+    for (; it != this->entries.end(); ++it) {
+      if (it.value().query) cc_glglue_glDeleteQueries(glue, 1, &it.value().query);
+    }
+  }
+  this->entries.clear();
+  this->numqueries = 0;
+}
+
+void
+QuarterRenderAction::beginTraversal(SoNode * node)
+{
+  const cc_glglue * glue = cc_glglue_instance(int(this->getCacheContext()));
+  this->glue = (this->culling && cc_glglue_has_occlusion_query(glue)) ? glue : NULL;
+
+  this->frame++;
+  if (this->glue && (this->frame % STALE_FRAMES) == 0) {
+    this->removeStaleEntries();
+  }
+  inherited::beginTraversal(node);
+}
+
+void
+QuarterRenderAction::separatorMethod(SoAction * action, SoNode * node)
+{
+  QuarterRenderAction * thisp = static_cast<QuarterRenderAction *>(action);
+  // delayed transparent paths were tested when they were first reached
+  if (thisp->isRenderingDelayedPaths() ||
+      action->getCurPathCode() != SoAction::NO_PATH) {
+    SoNode::GLRenderS(action, node);
+    return;
+  }
+  if (!thisp->glue && thisp->filter == ALL_SHAPES) {
+    SoNode::GLRenderS(action, node);
+    return;
+  }
+  // nothing to gain from testing the root, but it must not be cached
+  if (!thisp->glue || action->getCurPath()->getLength() < 2) {
+    static_cast<SoSeparator *>(node)->doAction(action);
+    return;
+  }
+  thisp->renderSeparator(static_cast<SoSeparator *>(node));
+}
+
+void
+QuarterRenderAction::shapeMethod(SoAction * action, SoNode * node)
+{
+  QuarterRenderAction * thisp = static_cast<QuarterRenderAction *>(action);
+  if (thisp->filter == ALL_SHAPES) {
+    SoNode::GLRenderS(action, node);
+    return;
+  }
+
+  SoState * state = action->getState();
+  const bool transparent = is_transparent(state);
+  if (thisp->filter == OPAQUE_SHAPES) {
+    if (!transparent) SoNode::GLRenderS(action, node);
+    return;
+  }
+  if (!transparent) return;
+
+  state->push();
+  SoLazyElement::enableSeparateBlending(state,
+                                        thisp->blending[0], thisp->blending[1],
+                                        thisp->blending[2], thisp->blending[3]);
+  SoDepthBufferElement::set(state, TRUE, FALSE, SoDepthBufferElement::LEQUAL,
+                            SbVec2f(0.0f, 1.0f));
+  SoNode::GLRenderS(action, node);
+  state->pop();
+}
+
+/*
+  Coin transforms row vectors, so translating the clip coordinates
+  after the projection offsets the image by the same amount in
+  normalized device coordinates wherever it is in depth.
+ */
+void
+QuarterRenderAction::cameraMethod(SoAction * action, SoNode * node)
+{
+  QuarterRenderAction * thisp = static_cast<QuarterRenderAction *>(action);
+  SoNode::GLRenderS(action, node);
+  if (thisp->jitter == SbVec2f(0.0f, 0.0f)) return;
+
+  SoState * state = action->getState();
+  const SbVec2s size = SoViewportRegionElement::get(state).getViewportSizePixels();
+  if (size[0] <= 0 || size[1] <= 0) return;
+
+  SbMatrix offset;
+  offset.setTranslate(SbVec3f(2.0f * thisp->jitter[0] / float(size[0]),
+                              2.0f * thisp->jitter[1] / float(size[1]), 0.0f));
+  SbMatrix projection = SoProjectionMatrixElement::get(state);
+  projection.multRight(offset);
+  SoProjectionMatrixElement::set(state, node, projection);
+}
+
+void
+QuarterRenderAction::renderSeparator(SoSeparator * separator)
+{
+  SoState * state = this->getState();
+  // nested separators add entries, so the reference is not used
+  // after the traversal below
+  Entry & entry = this->entries[path_key(this->getCurPath())];
+
+  if (entry.nodeid != separator->getNodeId()) {
+    entry.nodeid = separator->getNodeId();
+    this->bboxaction->setViewportRegion(this->getViewportRegion());
+    this->bboxaction->apply(separator);
+    entry.box = this->bboxaction->getBoundingBox();
+    // the separator itself is always found
+    this->searchaction->setType(SoSeparator::getClassTypeId());
+    this->searchaction->setInterest(SoSearchAction::ALL);
+    this->searchaction->apply(separator);
+    entry.leaf = this->searchaction->getPaths().getLength() < 2;
+    this->searchaction->reset();
+    entry.visible = true;
+  }
+  if (entry.box.isEmpty()) {
+    entry.lastframe = this->frame;
+    this->traverse(separator, entry.leaf);
+    return;
+  }
+
+  // the decision is made the first time a separator is reached in a
+  // frame, and reused by the remaining rendering passes
+  if (entry.lastframe != this->frame) {
+    entry.lastframe = this->frame;
+    this->collectQuery(entry);
+
+    const SbViewVolume & vv = SoViewVolumeElement::get(state);
+    SbXfBox3f xfbox(entry.box);
+    xfbox.setTransform(SoModelMatrixElement::get(state));
+    SbBox3f worldbox = xfbox.project();
+    // boxes reaching the near plane would be clipped, so they are
+    // treated as visible instead of being tested
+    const float margin = vv.getNearDist();
+    worldbox.extendBy(worldbox.getMin() - SbVec3f(margin, margin, margin));
+    worldbox.extendBy(worldbox.getMax() + SbVec3f(margin, margin, margin));
+
+    if (worldbox.intersect(vv.getProjectionPoint())) {
+      entry.visible = true;
+      entry.culled = false;
+    }
+    else {
+      entry.culled = !entry.visible;
+      const bool retest = entry.culled ||
+        ((this->frame + entry.nodeid) % VISIBLE_QUERY_INTERVAL) == 0;
+      if (retest && !entry.pending) this->issueQuery(entry);
+    }
+  }
+
+  if (!entry.culled) {
+    this->traverse(separator, entry.leaf);
+  }
+}
+
+void
+QuarterRenderAction::traverse(SoSeparator * separator, bool leaf)
+{
+  if (leaf && this->filter == ALL_SHAPES) {
+    separator->GLRender(this);
+  }
+  else {
+    separator->doAction(this);
+  }
+}
+
+void
+QuarterRenderAction::collectQuery(Entry & entry)
+{
+  if (!entry.pending) return;
+
+  GLuint available = 0;
+  cc_glglue_glGetQueryObjectuiv(this->glue, entry.query, GL_QUERY_RESULT_AVAILABLE, &available);
+  if (!available) return;
+
+  GLuint samples = 0;
+  cc_glglue_glGetQueryObjectuiv(this->glue, entry.query, GL_QUERY_RESULT, &samples);
+  entry.visible = samples > 0;
+  entry.pending = false;
+}
+
+void
+QuarterRenderAction::issueQuery(Entry & entry)
+{
+  SoState * state = this->getState();
+  if (!entry.query) {
+    cc_glglue_glGenQueries(this->glue, 1, &entry.query);
+    this->numqueries++;
+  }
+
+  SbMatrix modelview = SoModelMatrixElement::get(state);
+  modelview.multRight(SoViewingMatrixElement::get(state));
+
+  glPushAttrib(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_ENABLE_BIT | GL_POLYGON_BIT);
+  glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+  glDepthMask(GL_FALSE);
+  glEnable(GL_DEPTH_TEST);
+  glDisable(GL_CULL_FACE);
+  glDisable(GL_LIGHTING);
+  glDisable(GL_TEXTURE_2D);
+  glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+  glMatrixMode(GL_MODELVIEW);
+  glPushMatrix();
+  glLoadMatrixf(modelview[0]);
+
+  cc_glglue_glBeginQuery(this->glue, GL_SAMPLES_PASSED, entry.query);
+  draw_box(entry.box);
+  cc_glglue_glEndQuery(this->glue, GL_SAMPLES_PASSED);
+
+  glPopMatrix();
+  glPopAttrib();
+  entry.pending = true;
+}
+
+void
+QuarterRenderAction::removeStaleEntries(void)
+{
+  QHash<quint64, Entry>::iterator it = this->entries.begin();
+  while (it != this->entries.end()) {
+    if (this->frame - it.value().lastframe > STALE_FRAMES) {
+      if (it.value().query) {
+        cc_glglue_glDeleteQueries(this->glue, 1, &it.value().query);
+        this->numqueries--;
+      }
+      it = this->entries.erase(it);
+    }
+    else {
+      ++it;
+    }
+  }
+}
+
+CustomRenderAction::CustomRenderAction(QuarterWidget * quarterwidget)
+{
+  this->quarterwidget = quarterwidget;
+  this->action = NULL;
+  this->plainaction = NULL;
+  this->culling = false;
+  this->filtering = false;
+  this->jittering = false;
+}
+
+/*
+  Must be deleted after the render manager, which may still refer to
+  the actions.
+ */
+CustomRenderAction::~CustomRenderAction()
+{
+  delete this->action;
+  delete this->plainaction;
+}
+
+void
+CustomRenderAction::setOcclusionCulling(bool yes)
+{
+  this->culling = yes;
+  this->update();
+}
+
+bool
+CustomRenderAction::occlusionCulling(void) const
+{
+  return this->culling;
+}
+
+/*
+  Installs the action for weighted blended transparency, which
+  switches its shape filter for every frame.
+ */
+void
+CustomRenderAction::setShapeFiltering(bool yes)
+{
+  this->filtering = yes;
+  this->update();
+}
+
+bool
+CustomRenderAction::shapeFiltering(void) const
+{
+  return this->filtering;
+}
+
+/*
+  Installs the action for accumulation antialiasing, which sets its
+  projection jitter for every frame.
+ */
+void
+CustomRenderAction::setProjectionJittering(bool yes)
+{
+  this->jittering = yes;
+  this->update();
+}
+
+bool
+CustomRenderAction::projectionJittering(void) const
+{
+  return this->jittering;
+}
+
+/*
+  Returns the action if it is installed in the widget's render
+  manager, and NULL otherwise.
+ */
+QuarterRenderAction *
+CustomRenderAction::installedAction(void) const
+{
+  SoRenderManager * manager = this->quarterwidget->getSoRenderManager();
+  if (!this->action || !manager || manager->getGLRenderAction() != this->action) {
+    return NULL;
+  }
+  return this->action;
+}
+
+/*
+  Moves the action over to the new render manager when it is in use.
+ */
+void
+CustomRenderAction::renderManagerChanged(SoRenderManager * oldmanager,
+                                         SoRenderManager * newmanager)
+{
+  if (!this->action || oldmanager == newmanager) return;
+
+  if (oldmanager && oldmanager->getGLRenderAction() == this->action) {
+    if (!this->plainaction) {
+      this->plainaction = new SoGLRenderAction(oldmanager->getViewportRegion());
+    }
+    this->install(oldmanager, this->plainaction);
+    if (newmanager) this->install(newmanager, this->action);
+  }
+}
+
+bool
+CustomRenderAction::hasQueries(void) const
+{
+  return this->action && this->action->hasQueries();
+}
+
+/*
+  Releases the query objects. Must be called with the widget's GL
+  context current.
+ */
+void
+CustomRenderAction::cleanup(void)
+{
+  if (this->action) this->action->releaseQueries();
+}
+
+/*
+  Installs the action in the widget's render manager while any of
+  the features need it, and puts back an ordinary SoGLRenderAction
+  with the same settings otherwise. Note that SoRenderManager deletes
+  the action it created itself when it is replaced.
+ */
+void
+CustomRenderAction::update(void)
+{
+  SoRenderManager * manager = this->quarterwidget->getSoRenderManager();
+  if (!manager) return;
+
+  if (this->culling || this->filtering || this->jittering) {
+    if (QuarterRenderAction::getClassTypeId() == SoType::badType()) {
+      QuarterRenderAction::initClass();
+    }
+    if (!this->action) {
+      this->action = new QuarterRenderAction(manager->getViewportRegion());
+    }
+    this->install(manager, this->action);
+    this->action->setOcclusionCulling(this->culling);
+    if (!this->filtering) {
+      this->action->setShapeFilter(QuarterRenderAction::ALL_SHAPES);
+    }
+    if (!this->jittering) {
+      this->action->setProjectionJitter(SbVec2f(0.0f, 0.0f));
+    }
+  }
+  else if (this->action && manager->getGLRenderAction() == this->action) {
+    if (!this->plainaction) {
+      this->plainaction = new SoGLRenderAction(manager->getViewportRegion());
+    }
+    this->install(manager, this->plainaction);
+  }
+  manager->scheduleRedraw();
+}
+
+void
+CustomRenderAction::install(SoRenderManager * manager, SoGLRenderAction * action)
+{
+  SoGLRenderAction * current = manager->getGLRenderAction();
+  if (current == action) return;
+  if (current) QuarterRenderAction::copySettings(current, action);
+  manager->setGLRenderAction(action);
+}
@@ -0,0 +1,158 @@
+#ifndef QUARTER_QUARTERRENDERACTION_H
+#define QUARTER_QUARTERRENDERACTION_H
+
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+#include <QtCore/QHash>
+#include <Inventor/SbBox3f.h>
+#include <Inventor/SbVec2f.h>
+#include <Inventor/C/glue/gl.h>
+#include <Inventor/actions/SoGLRenderAction.h>
+#include <Inventor/actions/SoSubAction.h>
+#include <Inventor/system/gl.h>
+
+class SoGetBoundingBoxAction;
+class SoRenderManager;
+class SoSearchAction;
+class SoSeparator;
+
+namespace SIM { namespace Coin3D { namespace Quarter {
+
+class QuarterWidget;
+
+class QuarterRenderAction : public SoGLRenderAction {
+  typedef SoGLRenderAction inherited;
+  SO_ACTION_HEADER(QuarterRenderAction);
+
+public:
+  static void initClass(void);
+
+  enum ShapeFilter {
+    ALL_SHAPES,
+    OPAQUE_SHAPES,
+    TRANSPARENT_SHAPES
+  };
+
+  QuarterRenderAction(const SbViewportRegion & vp);
+  virtual ~QuarterRenderAction();
+
+  void setOcclusionCulling(bool yes);
+  bool occlusionCulling(void) const;
+
+  void setShapeFilter(ShapeFilter filter);
+  ShapeFilter shapeFilter(void) const;
+  void setTransparentBlending(GLenum srcrgb, GLenum dstrgb, GLenum srcalpha, GLenum dstalpha);
+
+  void setProjectionJitter(const SbVec2f & pixels);
+  const SbVec2f & projectionJitter(void) const;
+
+  bool hasQueries(void) const;
+  void releaseQueries(void);
+
+  static void copySettings(const SoGLRenderAction * from, SoGLRenderAction * to);
+
+protected:
+  virtual void beginTraversal(SoNode * node);
+
+private:
+  struct Entry {
+    Entry(void)
+      : nodeid(0), leaf(false), query(0), pending(false), visible(true),
+        culled(false), lastframe(0) { }
+
+    uint32_t nodeid;
+    bool leaf;
+    SbBox3f box;
+    GLuint query;
+    bool pending;
+    bool visible;
+    bool culled;
+    uint32_t lastframe;
+  };
+
+  static void separatorMethod(SoAction * action, SoNode * node);
+  static void shapeMethod(SoAction * action, SoNode * node);
+  static void cameraMethod(SoAction * action, SoNode * node);
+
+  void renderSeparator(SoSeparator * separator);
+  void traverse(SoSeparator * separator, bool leaf);
+  void collectQuery(Entry & entry);
+  void issueQuery(Entry & entry);
+  void removeStaleEntries(void);
+
+  bool culling;
+  ShapeFilter filter;
+  GLenum blending[4];
+  SbVec2f jitter;
+  QHash<quint64, Entry> entries;
+  SoGetBoundingBoxAction * bboxaction;
+  SoSearchAction * searchaction;
+  const cc_glglue * glue;
+  uint32_t frame;
+  int numqueries;
+};
+
+class CustomRenderAction {
+public:
+  CustomRenderAction(QuarterWidget * quarterwidget);
+  ~CustomRenderAction();
+
+  void setOcclusionCulling(bool yes);
+  bool occlusionCulling(void) const;
+  void setShapeFiltering(bool yes);
+  bool shapeFiltering(void) const;
+  void setProjectionJittering(bool yes);
+  bool projectionJittering(void) const;
+
+  QuarterRenderAction * installedAction(void) const;
+
+  void renderManagerChanged(SoRenderManager * oldmanager, SoRenderManager * newmanager);
+
+  bool hasQueries(void) const;
+  void cleanup(void);
+
+private:
+  void update(void);
+  void install(SoRenderManager * manager, SoGLRenderAction * action);
+
+  QuarterWidget * quarterwidget;
+  QuarterRenderAction * action;
+  SoGLRenderAction * plainaction;
+  bool culling;
+  bool filtering;
+  bool jittering;
+};
+
+}}} // namespace
+
+#endif // QUARTER_QUARTERRENDERACTION_H
@@ -52,13 +52,16 @@
 
 #include <QEvent>
 #include <QDebug>
-#include <QFile>
 #include <QAction>
 #if (QT_VERSION >= 0x050600)
 #  include <QWindow>
 #  include <QGuiApplication>
 #endif
+#if QT_VERSION >= 0x060000
+#  include <QOpenGLContext>
+#endif
 #include <Inventor/SbViewportRegion.h>
+#include <Inventor/errors/SoDebugError.h>
 #include <Inventor/system/gl.h>
 #include <Inventor/events/SoEvents.h>
 #include <Inventor/nodes/SoNode.h>
@@ -73,17 +76,43 @@
 #include <Inventor/SbBasic.h>
 #include <Inventor/SoRenderManager.h>
 #include <Inventor/SoEventManager.h>
-#include <Inventor/scxml/ScXML.h>
 #include <Inventor/scxml/SoScXMLStateMachine.h>
-#include <Inventor/SbByteBuffer.h>
 
+#include <Quarter/Quarter.h>
 #include <Quarter/QuarterWidget.h>
+#include <Quarter/FrameSink.h>
 #include <Quarter/eventhandlers/EventFilter.h>
 #include <Quarter/eventhandlers/DragDropHandler.h>
 
+#include "AccumulationAntialiasing.h"
+#include "BoundingBoxCache.h"
+#include "CachedLayers.h"
+#include "CachePrewarmer.h"
+#include "DamageTracker.h"
+#include "FrameCache.h"
+#include "FrameCapture.h"
+#include "FramePacer.h"
+#include "FrameScheduler.h"
+#include "FrameTimer.h"
 #include "InteractionMode.h"
+#include "MultiViewport.h"
+#include "NativeNavigation.h"
+#include "NavigationQuality.h"
+#include "ParallelPick.h"
+#include "PerformanceHud.h"
+#include "PickBuffer.h"
 #include "QuarterWidgetP.h"
 #include "QuarterP.h"
+#include "QuarterRenderAction.h"
+#include "RenderSuspender.h"
+#include "RenderThread.h"
+#include "ResidencyManager.h"
+#include "ResizeDebouncer.h"
+#include "ResolutionScaler.h"
+#include "SensorProfiler.h"
+#include "VideoRecorder.h"
+#include "WeightedBlendedTransparency.h"
+#include "Trace.h"
 
 using namespace SIM::Coin3D::Quarter;
 
@@ -95,6 +124,16 @@ using namespace SIM::Coin3D::Quarter;
   others gives you better quality rendering.
 
   See \ref SoGLRenderAction::TransparencyType for a full description of the modes
+
+  WEIGHTED_BLENDED is order-independent transparency done by
+  Quarter. The opaque shapes are rendered first, then the transparent
+  ones are accumulated in an offscreen buffer in two passes, and
+  their average color is blended over the opaque image. Unlike
+  SORTED_LAYERS_BLEND, the cost does not grow with the number of
+  overlapping layers, but the colors of overlapping transparent
+  surfaces are averaged rather than ordered. Separators are rendered
+  without render caches in this mode. It needs Qt 5.6, float render
+  targets and shaders, and falls back to NONE otherwise.
 */
 
 /*!
@@ -103,6 +142,14 @@ using namespace SIM::Coin3D::Quarter;
   Sets how rendering of primitives is done.
 
   See \ref SoRenderManager::RenderMode for a full description of the modes
+
+  OCCLUSION_CULLING renders the scene as AS_IS, but skips separators
+  whose bounding boxes were hidden behind other geometry the last
+  time they were tested with a hardware occlusion query. Objects that
+  come into view may therefore appear one frame late. The mode
+  replaces the GL render action of the render manager while it is
+  active, and falls back to AS_IS if occlusion queries are not
+  supported.
 */
 
 /*!
@@ -137,7 +184,15 @@ QuarterWidget::QuarterWidget(const QGLFormat & format, QWidget * parent, const Q
   this->constructor(sharewidget);
 }
 
-/*! constructor */
+/*! constructor
+
+  On Qt 6, widgets in different windows only share objects with \a
+  sharewidget if the application sets Qt::AA_ShareOpenGLContexts
+  before creating the QApplication. When the widget's context is
+  created, the widget joins the cache context of the widgets it
+  really shares objects with, so Coin builds display lists, textures
+  and buffers once for all of them.
+*/
 #if QT_VERSION >= 0x060000
 QuarterWidget::QuarterWidget(QWidget * parent, const QOpenGLWidget* sharewidget, Qt::WindowFlags f)
   : inherited(parent, f)
@@ -149,15 +204,33 @@ QuarterWidget::QuarterWidget(QWidget * parent, const QGLWidget * sharewidget, Qt
   this->constructor(sharewidget);
 }
 
-/*! constructor */
+/*! constructor
+
+  On Qt 6, QOpenGLWidget always creates its own context. The widget
+  then takes its format from \a context, and shares objects with it
+  if \a context shares objects with
+  QOpenGLContext::globalShareContext() and the application sets
+  Qt::AA_ShareOpenGLContexts.
+*/
 #if QT_VERSION >= 0x060000
 QuarterWidget::QuarterWidget(QOpenGLContext* context, QWidget * parent, const QOpenGLWidget * sharewidget, Qt::WindowFlags f)
-  : inherited(/*context, */parent, f)
+  : inherited(parent, f)
+{
+  if (context) {
+    this->setFormat(context->format());
+    QOpenGLContext * global = QOpenGLContext::globalShareContext();
+    if (!global || !QOpenGLContext::areSharing(context, global)) {
+      SoDebugError::postWarning("QuarterWidget::QuarterWidget",
+                                "The widget can only share OpenGL objects "
+                                "with a context which shares objects with "
+                                "QOpenGLContext::globalShareContext().");
+    }
+  }
 #else
 QuarterWidget::QuarterWidget(QGLContext * context, QWidget * parent, const QGLWidget * sharewidget, Qt::WindowFlags f)
   : inherited(context, parent, sharewidget, f)
-#endif
 {
+#endif
   this->constructor(sharewidget);
 }
 
@@ -172,14 +245,45 @@ QuarterWidget::constructor(const QGLWidget* sharewidget)
 
   PRIVATE(this)->sorendermanager = new SoRenderManager;
   PRIVATE(this)->initialsorendermanager = true;
+  SensorProfiler::renderManagerChanged(NULL, PRIVATE(this)->sorendermanager);
   PRIVATE(this)->soeventmanager = new SoEventManager;
   PRIVATE(this)->initialsoeventmanager = true;
   PRIVATE(this)->processdelayqueue = true;
+  PRIVATE(this)->sharedscheduling = false;
 
   //Mind the order of initialization as the XML state machine uses
   //callbacks which depends on other state being initialized
   PRIVATE(this)->eventfilter = new EventFilter(this);
   PRIVATE(this)->interactionmode = new InteractionMode(this);
+  PRIVATE(this)->framepacer = new FramePacer(this);
+  PRIVATE(this)->framecache = new FrameCache(this);
+  PRIVATE(this)->damagetracker = new DamageTracker(this);
+  PRIVATE(this)->framecapture = new FrameCapture(this);
+  PRIVATE(this)->videorecorder = new VideoRecorder(PRIVATE(this)->framecapture);
+  PRIVATE(this)->navigationquality = new NavigationQuality(this);
+  PRIVATE(this)->nativenavigation = new NativeNavigation(this);
+  PRIVATE(this)->nativenavigation->setStateChangeCallback(QuarterWidgetP::nativestatecb, PRIVATE(this));
+  PRIVATE(this)->resolutionscaler = new ResolutionScaler(this);
+  PRIVATE(this)->cachedlayers = new CachedLayers(this);
+  PRIVATE(this)->pickbuffer = new PickBuffer(this);
+  PRIVATE(this)->customrenderaction = new CustomRenderAction(this);
+  PRIVATE(this)->weightedblended =
+    new WeightedBlendedTransparency(this, PRIVATE(this)->customrenderaction);
+  PRIVATE(this)->accumulation =
+    new AccumulationAntialiasing(this, PRIVATE(this)->customrenderaction);
+  PRIVATE(this)->prewarmer = new CachePrewarmer(this);
+  QObject::connect(PRIVATE(this)->prewarmer, SIGNAL(finished(void)),
+                   this, SIGNAL(prewarmFinished(void)));
+  PRIVATE(this)->boundingboxcache = new BoundingBoxCache(this);
+  PRIVATE(this)->multiviewport = new MultiViewport(PRIVATE(this));
+  PRIVATE(this)->residencymanager = new ResidencyManager(this);
+  PRIVATE(this)->rendersuspender = new RenderSuspender(this);
+  PRIVATE(this)->resizedebouncer = new ResizeDebouncer(this);
+  PRIVATE(this)->renderthread = new RenderThread(this);
+  PRIVATE(this)->frametimer = new FrameTimer(this);
+  QObject::connect(PRIVATE(this)->frametimer, SIGNAL(frameBudgetExceeded(double)),
+                   this, SIGNAL(frameBudgetExceeded(double)));
+  PRIVATE(this)->performancehud = new PerformanceHud(this, PRIVATE(this)->frametimer);
 
   PRIVATE(this)->currentStateMachine = NULL;
 
@@ -211,19 +315,100 @@ QuarterWidget::constructor(const QGLWidget* sharewidget)
 /*! destructor */
 QuarterWidget::~QuarterWidget()
 {
+  if (QuarterP::framescheduler) {
+    QuarterP::framescheduler->unschedule(this);
+  }
+  // stops traversing the scene before anything is torn down
+  delete PRIVATE(this)->renderthread;
+  PRIVATE(this)->renderthread = NULL;
   if (PRIVATE(this)->currentStateMachine) {
-    this->removeStateMachine(PRIVATE(this)->currentStateMachine);
-    delete PRIVATE(this)->currentStateMachine;
+    if (!PRIVATE(this)->nativenavigation->enabled()) {
+      this->removeStateMachine(PRIVATE(this)->currentStateMachine);
+    }
+    QuarterWidgetP::releaseNavigationFile(PRIVATE(this)->currentStateMachine);
   }
   PRIVATE(this)->headlight->unref();
   PRIVATE(this)->headlight = NULL;
+  // finishes the recording before the readback buffers go away
+  delete PRIVATE(this)->videorecorder;
+  PRIVATE(this)->videorecorder = NULL;
+  if (PRIVATE(this)->frametimer->hasQueries() ||
+      PRIVATE(this)->cachedlayers->hasFramebuffers() ||
+      PRIVATE(this)->framecache->hasFramebuffer() ||
+      PRIVATE(this)->framecapture->hasBuffers() ||
+      PRIVATE(this)->pickbuffer->hasFramebuffer() ||
+      PRIVATE(this)->customrenderaction->hasQueries() ||
+      PRIVATE(this)->weightedblended->hasFramebuffer() ||
+      PRIVATE(this)->accumulation->hasFramebuffer() ||
+      PRIVATE(this)->resolutionscaler->hasFramebuffer()) {
+    this->makeCurrent();
+    PRIVATE(this)->frametimer->cleanup();
+    PRIVATE(this)->cachedlayers->cleanup();
+    PRIVATE(this)->framecache->cleanup();
+    PRIVATE(this)->framecapture->cleanup();
+    PRIVATE(this)->pickbuffer->cleanup();
+    PRIVATE(this)->customrenderaction->cleanup();
+    PRIVATE(this)->weightedblended->cleanup();
+    PRIVATE(this)->accumulation->cleanup();
+    PRIVATE(this)->resolutionscaler->cleanup();
+    this->doneCurrent();
+  }
+  // the overlay is a superimposition of the render manager
+  delete PRIVATE(this)->performancehud;
+  PRIVATE(this)->performancehud = NULL;
+  // holds references to nodes in the scene graph
+  delete PRIVATE(this)->damagetracker;
+  PRIVATE(this)->damagetracker = NULL;
   this->setSceneGraph(NULL);
   this->setSoRenderManager(NULL);
   this->setSoEventManager(NULL);
   delete PRIVATE(this)->eventfilter;
+  delete PRIVATE(this)->navigationquality;
+  delete PRIVATE(this)->nativenavigation;
+  delete PRIVATE(this)->cachedlayers;
+  delete PRIVATE(this)->pickbuffer;
+  delete PRIVATE(this)->weightedblended;
+  delete PRIVATE(this)->customrenderaction;
+  delete PRIVATE(this)->multiviewport;
+  delete PRIVATE(this)->boundingboxcache;
+  delete PRIVATE(this)->residencymanager;
+  delete PRIVATE(this)->rendersuspender;
   delete PRIVATE(this);
 }
 
+/*!
+  Adds \a layer as a background or foreground layer, like a
+  superimposition added with SoRenderManager::addSuperimposition().
+
+  Unlike superimpositions, the layer is rendered into a texture, and
+  the texture is composited into every frame. The layer is only
+  rendered again when something changes in its subgraph or the widget
+  is resized, which makes this suitable for static backgrounds and
+  overlays like gradients and text. Layers with the same position are
+  composited in the order they were added.
+
+  A layer usually contains its own camera. It is rendered on top of
+  a transparent background, so a foreground layer only covers the
+  scene where something is drawn. Foreground layers have no access to
+  the depth buffer of the scene.
+
+  \sa removeCachedLayer()
+*/
+void
+QuarterWidget::addCachedLayer(SoNode * layer, LayerPosition position)
+{
+  PRIVATE(this)->cachedlayers->addLayer(layer, position);
+}
+
+/*!
+  Removes a layer added with addCachedLayer().
+*/
+void
+QuarterWidget::removeCachedLayer(SoNode * layer)
+{
+  PRIVATE(this)->cachedlayers->removeLayer(layer);
+}
+
 /*!
   You can set the cursor you want to use for a given navigation
   state. See the Coin documentation on navigation for information
@@ -263,127 +448,1208 @@ QuarterWidget::stateCursor(const SbName & state)
 void
 QuarterWidget::setHeadlightEnabled(bool onoff)
 {
-  PRIVATE(this)->headlight->on = onoff;
+  PRIVATE(this)->headlight->on = onoff;
+}
+
+/*!
+  Returns true if the headlight is on, false if it is off.
+*/
+bool
+QuarterWidget::headlightEnabled(void) const
+{
+  return PRIVATE(this)->headlight->on.getValue();
+}
+
+/*!
+  Returns the light used for the headlight.
+*/
+SoDirectionalLight *
+QuarterWidget::getHeadlight(void)
+{
+  return PRIVATE(this)->headlight;
+}
+
+/*!
+  \property QuarterWidget::clearZBuffer
+
+  \copydetails QuarterWidget::setClearZBuffer
+*/
+
+/*!
+  Specify if you want the z-buffer to be cleared before
+  redraw. This is on by default.
+*/
+void
+QuarterWidget::setClearZBuffer(bool onoff)
+{
+  PRIVATE(this)->clearzbuffer = onoff;
+}
+
+/*!
+  Returns true if the z-buffer is cleared before rendering.
+*/
+bool
+QuarterWidget::clearZBuffer(void) const
+{
+  return PRIVATE(this)->clearzbuffer;
+}
+
+/*!
+  \property QuarterWidget::clearWindow
+
+  \copydetails QuarterWidget::setClearWindow
+*/
+
+/*!
+  Specify if you want the rendering buffer to be cleared before
+  rendering. This is on by default.
+ */
+void
+QuarterWidget::setClearWindow(bool onoff)
+{
+  PRIVATE(this)->clearwindow = onoff;
+}
+
+/*!
+  Returns true if the rendering buffer is cleared before rendering.
+*/
+bool
+QuarterWidget::clearWindow(void) const
+{
+  return PRIVATE(this)->clearwindow;
+}
+
+/*!
+  \property QuarterWidget::interactionModeEnabled
+
+  \copydetails QuarterWidget::setInteractionModeEnabled
+*/
+
+/*!
+  Enable/disable interaction mode.
+
+  Specifies whether you may use the Alt-key to enter interaction mode.
+*/
+void
+QuarterWidget::setInteractionModeEnabled(bool onoff)
+{
+  PRIVATE(this)->interactionmode->setEnabled(onoff);
+}
+
+/*!
+  Returns true if interaction mode is enabled, false otherwise.
+ */
+bool
+QuarterWidget::interactionModeEnabled(void) const
+{
+  return PRIVATE(this)->interactionmode->enabled();
+}
+
+/*!
+  \property QuarterWidget::interactionModeOn
+
+  \copydetails QuarterWidget::setInteractionModeOn
+*/
+
+/*!
+  Turn interaction mode on or off.
+*/
+void
+QuarterWidget::setInteractionModeOn(bool onoff)
+{
+  PRIVATE(this)->interactionmode->setOn(onoff);
+}
+
+/*!
+  Returns true if interaction mode is on.
+ */
+bool
+QuarterWidget::interactionModeOn(void) const
+{
+  return PRIVATE(this)->interactionmode->on();
+}
+
+/*!
+  \property QuarterWidget::framePacingEnabled
+
+  \copydetails QuarterWidget::setFramePacingEnabled
+*/
+
+/*!
+  Enable/disable frame pacing of automatic redraws.
+
+  When enabled, all redraw requests from the render manager that
+  arrive within one refresh interval of the screen showing the widget
+  are merged into a single frame, instead of each one triggering a
+  repaint of its own. This is off by default.
+*/
+void
+QuarterWidget::setFramePacingEnabled(bool onoff)
+{
+  PRIVATE(this)->framepacer->setEnabled(onoff);
+}
+
+/*!
+  Returns true if automatic redraws are frame paced.
+*/
+bool
+QuarterWidget::framePacingEnabled(void) const
+{
+  return PRIVATE(this)->framepacer->enabled();
+}
+
+/*!
+  \property QuarterWidget::maxFrameRate
+
+  \copydetails QuarterWidget::setMaxFrameRate
+*/
+
+/*!
+  Sets the maximum number of automatic redraws per second. Redraw
+  requests from the render manager arriving sooner than 1/\a rate
+  seconds after the last frame are deferred until then, and merged
+  into a single frame.
+
+  If an unfocused frame rate is set, this cap only applies while the
+  widget has keyboard focus. The default value is 0, which means no
+  cap.
+
+  \sa setUnfocusedFrameRate(), setFramePacingEnabled()
+*/
+void
+QuarterWidget::setMaxFrameRate(double rate)
+{
+  PRIVATE(this)->framepacer->setMaxFrameRate(rate);
+}
+
+/*!
+  Returns the maximum frame rate.
+*/
+double
+QuarterWidget::maxFrameRate(void) const
+{
+  return PRIVATE(this)->framepacer->maxFrameRate();
+}
+
+/*!
+  \property QuarterWidget::unfocusedFrameRate
+
+  \copydetails QuarterWidget::setUnfocusedFrameRate
+*/
+
+/*!
+  Sets the maximum number of automatic redraws per second while the
+  widget does not have keyboard focus, e.g. to keep the view the user
+  works in at 60 Hz while the other views are updated at 10 Hz. The
+  default value is 0, which means that maxFrameRate applies
+  regardless of focus.
+*/
+void
+QuarterWidget::setUnfocusedFrameRate(double rate)
+{
+  PRIVATE(this)->framepacer->setUnfocusedFrameRate(rate);
+}
+
+/*!
+  Returns the frame rate used while the widget does not have focus.
+*/
+double
+QuarterWidget::unfocusedFrameRate(void) const
+{
+  return PRIVATE(this)->framepacer->unfocusedFrameRate();
+}
+
+/*!
+  \property QuarterWidget::sharedFrameSchedulingEnabled
+
+  \copydetails QuarterWidget::setSharedFrameSchedulingEnabled
+*/
+
+/*!
+  Enable/disable shared scheduling of automatic redraws.
+
+  Widgets with shared scheduling enabled do not redraw on their own
+  when their scene changes. Instead, a scheduler common to all of them
+  processes the Coin delay queue once per event loop iteration and
+  then redraws every widget that needs it back-to-back, grouped by
+  share context. This avoids processing the delay queue once per
+  widget when many widgets show the same scene, e.g. in an MDI
+  application. Shared scheduling takes precedence over frame pacing.
+  This is off by default.
+*/
+void
+QuarterWidget::setSharedFrameSchedulingEnabled(bool onoff)
+{
+  PRIVATE(this)->sharedscheduling = onoff;
+  if (!onoff && QuarterP::framescheduler) {
+    QuarterP::framescheduler->unschedule(this);
+  }
+}
+
+/*!
+  Returns true if automatic redraws use the shared scheduler.
+*/
+bool
+QuarterWidget::sharedFrameSchedulingEnabled(void) const
+{
+  return PRIVATE(this)->sharedscheduling;
+}
+
+/*!
+  \property QuarterWidget::boundingBoxCacheEnabled
+
+  \copydetails QuarterWidget::setBoundingBoxCacheEnabled
+*/
+
+/*!
+  Enable/disable caching of the scene's bounding box.
+
+  Auto-clipping of the near and far planes and viewAll() then use a
+  bounding box kept by the widget instead of traversing the scene
+  graph with an SoGetBoundingBoxAction every frame. Node sensors keep
+  the box up to date. When the scene graph is a group of separators,
+  only the top level children that changed are traversed again,
+  spread over several threads if Coin is thread safe. This pays off
+  for large scene graphs with small, local changes. This is off by
+  default.
+*/
+void
+QuarterWidget::setBoundingBoxCacheEnabled(bool onoff)
+{
+  PRIVATE(this)->boundingboxcache->setEnabled(onoff);
+}
+
+/*!
+  Returns true if the scene's bounding box is cached.
+*/
+bool
+QuarterWidget::boundingBoxCacheEnabled(void) const
+{
+  return PRIVATE(this)->boundingboxcache->isEnabled();
+}
+
+/*!
+  \property QuarterWidget::cacheEvictionDelay
+
+  \copydetails QuarterWidget::setCacheEvictionDelay
+*/
+
+/*!
+  Sets the number of seconds the widget must have been hidden, e.g.
+  in an inactive tab, before the GL resources of its scene are
+  released. Textures, display lists and vertex buffers are then
+  recreated the next time the widget is shown.
+
+  Resources which are shared with other widgets are only released
+  when all widgets in the share group have been hidden for longer
+  than their delay. The default value is 0, which means that the
+  resources are kept until the widget is destroyed.
+*/
+void
+QuarterWidget::setCacheEvictionDelay(double sec)
+{
+  PRIVATE(this)->residencymanager->setEvictionDelay(sec);
+}
+
+/*!
+  Returns the cache eviction delay in seconds.
+*/
+double
+QuarterWidget::cacheEvictionDelay(void) const
+{
+  return PRIVATE(this)->residencymanager->evictionDelay();
+}
+
+/*!
+  Returns the approximate number of bytes of texture memory used by
+  the scenes in the share group of this widget, including mipmaps.
+  Returns 0 if the resources have been released after the widget was
+  hidden.
+
+  The estimate is recalculated by traversing the scene graphs when
+  they have changed since the last call.
+*/
+size_t
+QuarterWidget::textureMemoryUsage(void) const
+{
+  return PRIVATE(this)->residencymanager->textureMemory();
+}
+
+/*!
+  Returns the approximate number of bytes of GPU memory used by the
+  render caches of the scenes in the share group of this widget,
+  based on the number of primitives in the scenes.
+
+  \sa textureMemoryUsage()
+*/
+size_t
+QuarterWidget::cacheMemoryUsage(void) const
+{
+  return PRIVATE(this)->residencymanager->cacheMemory();
+}
+
+/*!
+  Builds the display lists, vertex buffers and textures of the scene
+  graph before the widget renders it, so that the first frame after
+  setSceneGraph() appears without delay, e.g. when the widget is
+  shown or its tab is switched to.
+
+  The scene is rendered into a hidden framebuffer object, in a context
+  that shares objects with the widget's context and with the widget's
+  cache context. The work is split into chunks of the scene graph
+  which are rendered while the application is idle, a few
+  milliseconds at a time. prewarmFinished() is emitted when the whole
+  scene has been rendered. Setting another scene graph cancels the
+  prewarming.
+
+  The widget's context is created the first time the widget is
+  shown. Before that, prewarming relies on the widget's context
+  sharing objects with QOpenGLContext::globalShareContext(), so the
+  application must set the Qt::AA_ShareOpenGLContexts attribute.
+  Returns false, and does nothing, without such a context, without a
+  scene graph, or with a Qt version older than 5.4.
+*/
+bool
+QuarterWidget::prewarm(void)
+{
+  return PRIVATE(this)->prewarmer->start();
+}
+
+/*!
+  Returns true while the scene graph is being prewarmed.
+
+  \sa prewarm()
+*/
+bool
+QuarterWidget::isPrewarming(void) const
+{
+  return PRIVATE(this)->prewarmer->active();
+}
+
+/*!
+  \property QuarterWidget::autoSuspendEnabled
+
+  \copydetails QuarterWidget::setAutoSuspendEnabled
+*/
+
+/*!
+  Enable/disable automatic suspension of rendering while the widget
+  is hidden, e.g. in a background tab, a minimized QMdiSubWindow or a
+  collapsed dock widget, or while its window is minimized.
+
+  A suspended widget deactivates its render manager and ignores calls
+  to redraw(). A single frame is rendered when the widget is shown
+  again. This is off by default.
+
+  \sa setAutoSuspendAnimations(), isSuspended()
+*/
+void
+QuarterWidget::setAutoSuspendEnabled(bool onoff)
+{
+  PRIVATE(this)->rendersuspender->setEnabled(onoff);
+}
+
+/*!
+  Returns true if rendering is suspended while the widget is hidden.
+*/
+bool
+QuarterWidget::autoSuspendEnabled(void) const
+{
+  return PRIVATE(this)->rendersuspender->enabled();
+}
+
+/*!
+  \property QuarterWidget::autoSuspendAnimations
+
+  \copydetails QuarterWidget::setAutoSuspendAnimations
+*/
+
+/*!
+  When enabled, the SoRotor, SoPendulum, SoShuttle and SoBlinker nodes
+  in the scene graph are turned off while rendering is suspended, so
+  that they stop triggering sensors. They are turned on again when
+  the widget is shown. This is off by default.
+
+  Nodes shared with scene graphs in other widgets are paused in those
+  widgets as well.
+*/
+void
+QuarterWidget::setAutoSuspendAnimations(bool onoff)
+{
+  PRIVATE(this)->rendersuspender->setPauseAnimations(onoff);
+}
+
+/*!
+  Returns true if animations are paused while rendering is suspended.
+*/
+bool
+QuarterWidget::autoSuspendAnimations(void) const
+{
+  return PRIVATE(this)->rendersuspender->pauseAnimations();
+}
+
+/*!
+  Returns true if rendering is currently suspended.
+*/
+bool
+QuarterWidget::isSuspended(void) const
+{
+  return PRIVATE(this)->rendersuspender->suspended();
+}
+
+/*!
+  \property QuarterWidget::deferredResizeEnabled
+
+  \copydetails QuarterWidget::setDeferredResizeEnabled
+*/
+
+/*!
+  Enable/disable deferred resizing. This is off by default.
+
+  Every resize of the widget normally reallocates the framebuffer
+  object the widget renders into and renders the next frame at the
+  new size, which makes dragging a window edge expensive. When
+  enabled, resizes that follow another one within
+  resizeCommitDelay() are held back. The widget keeps rendering at
+  the last size it was resized to, and its last frame is scaled to
+  the new widget size. The final size is applied once no resize has
+  arrived for the delay. A single resize, e.g. when the window is
+  maximized, is applied right away.
+
+  This only has an effect with Qt 6. With Qt 5 the widget renders
+  straight into its window, where a frame cannot be scaled.
+*/
+void
+QuarterWidget::setDeferredResizeEnabled(bool onoff)
+{
+  PRIVATE(this)->resizedebouncer->setEnabled(onoff);
+}
+
+/*!
+  Returns true if deferred resizing is enabled.
+*/
+bool
+QuarterWidget::deferredResizeEnabled(void) const
+{
+  return PRIVATE(this)->resizedebouncer->enabled();
+}
+
+/*!
+  \property QuarterWidget::resizeCommitDelay
+
+  \copydetails QuarterWidget::setResizeCommitDelay
+*/
+
+/*!
+  Sets the number of seconds without a resize after which a deferred
+  resize is applied. The default is 0.15 seconds.
+
+  \sa setDeferredResizeEnabled()
+*/
+void
+QuarterWidget::setResizeCommitDelay(double sec)
+{
+  PRIVATE(this)->resizedebouncer->setDelay(sec);
+}
+
+/*!
+  Returns the delay after which a deferred resize is applied.
+*/
+double
+QuarterWidget::resizeCommitDelay(void) const
+{
+  return PRIVATE(this)->resizedebouncer->delay();
+}
+
+/*!
+  \property QuarterWidget::renderThreadEnabled
+
+  \copydetails QuarterWidget::setRenderThreadEnabled
+*/
+
+/*!
+  Enable/disable rendering on a thread of its own. This is off by
+  default.
+
+  Normally paintGL() traverses the scene on the GUI thread, and a slow
+  frame blocks menus, typing and layout work for as long as it takes.
+  When enabled, the widget gets a render thread with an OpenGL context
+  sharing objects with the widget's. The thread renders the scene
+  into a framebuffer object under SoDB::readlock(), and when a frame
+  is done, paintGL() only draws it into the widget. Redraws requested
+  while a frame is being rendered are merged into the next one. The
+  GUI thread keeps translating input through the EventFilter and
+  running the sensors, holding SoDB::writelock() while it does, so
+  camera and scene changes are applied between frames.
+
+  Application code changing the scene graph then has to do so under
+  SoDB::writelock(), or post its changes through SceneUpdateQueue.
+  The frame is rendered by the SoRenderManager alone, so background
+  and foreground layers, multiple viewports, resolution scaling,
+  accumulation antialiasing and frame reuse do not apply in this
+  mode. Disable it before replacing the render manager with
+  setSoRenderManager().
+
+  Needs Qt 5 and a thread safe Coin. Otherwise, or if no shared
+  context can be created, a warning is posted and the widget renders
+  on the GUI thread as usual.
+*/
+void
+QuarterWidget::setRenderThreadEnabled(bool onoff)
+{
+  if (PRIVATE(this)->renderthreadenabled == onoff) return;
+  PRIVATE(this)->renderthreadenabled = onoff;
+  if (onoff) {
+    PRIVATE(this)->startRenderThread();
+  }
+  else {
+    PRIVATE(this)->renderthread->end();
+  }
+  this->redraw();
+}
+
+/*!
+  Returns true if the scene is rendered on a thread of its own.
+*/
+bool
+QuarterWidget::renderThreadEnabled(void) const
+{
+  return PRIVATE(this)->renderthreadenabled;
+}
+
+/*!
+  \property QuarterWidget::frameReuseEnabled
+
+  \copydetails QuarterWidget::setFrameReuseEnabled
+*/
+
+/*!
+  Enable/disable reuse of the last rendered frame. This is off by
+  default.
+
+  Qt repaints the widget for expose events, window moves and
+  recomposition even if nothing in the scene has changed. When
+  enabled, a copy of the color buffer is kept after every frame, and
+  such repaints blit the copy instead of traversing the scene graph
+  again. The scene is considered changed whenever the render manager
+  requests a redraw, redraw() is called, or the size or device pixel
+  ratio of the widget changes.
+
+  Subclasses which render anything in actualRedraw() that does not
+  come from the scene graph must call redraw() when it changes. Frame
+  reuse requires Qt 5 and framebuffer blit support in the OpenGL
+  driver.
+*/
+void
+QuarterWidget::setFrameReuseEnabled(bool onoff)
+{
+  PRIVATE(this)->framecache->setEnabled(onoff);
+}
+
+/*!
+  Returns true if unchanged frames are reused.
+*/
+bool
+QuarterWidget::frameReuseEnabled(void) const
+{
+  return PRIVATE(this)->framecache->enabled();
+}
+
+/*!
+  \property QuarterWidget::damageTrackingEnabled
+
+  \copydetails QuarterWidget::setDamageTrackingEnabled
+*/
+
+/*!
+  Enable/disable redrawing of only the part of the view that has
+  changed. This is off by default.
+
+  When enabled, changes to the scene graph are tracked, and a change
+  below a separator only redraws the screen area the separator
+  covered in the last frame and covers now, on top of the previous
+  frame. The scene graph is still traversed in full, but the GPU only
+  fills the damaged region, which helps when a small part of a large
+  view is animated. Camera moves, resizes, the first change below a
+  separator and changes outside of any separator redraw the whole
+  view, as does a damaged region covering more than half of it.
+
+  Partial frames are not used while rendering with multiple
+  viewports, with quad-buffer or anaglyph stereo, with adaptive
+  resolution, or for the extra samples of accumulation
+  antialiasing. Superimpositions and anything else rendered in
+  actualRedraw() that does not come from the scene graph are only
+  updated inside the damaged region; call redraw() after changing
+  them. With Qt 5 the previous frame is restored from a copy, which
+  requires framebuffer blit support in the OpenGL driver.
+*/
+void
+QuarterWidget::setDamageTrackingEnabled(bool onoff)
+{
+  RenderThread::lockScene();
+  PRIVATE(this)->damagetracker->setEnabled(onoff);
+  RenderThread::unlockScene();
+#if (QT_VERSION >= 0x060000)
+  this->setUpdateBehavior(onoff ? QOpenGLWidget::PartialUpdate :
+                          QOpenGLWidget::NoPartialUpdate);
+#else
+  PRIVATE(this)->framecache->setKeepFrame(onoff);
+#endif
+}
+
+/*!
+  Returns true if only the changed part of the view is redrawn.
+*/
+bool
+QuarterWidget::damageTrackingEnabled(void) const
+{
+  return PRIVATE(this)->damagetracker->enabled();
+}
+
+/*!
+  \property QuarterWidget::frameStatisticsEnabled
+
+  \copydetails QuarterWidget::setFrameStatisticsEnabled
+*/
+
+/*!
+  Enable/disable collection of frame timings. This is off by default.
+
+  While enabled, the time spent processing the delay queue, rendering
+  the scene on the CPU and the GPU, and swapping buffers is recorded
+  for the most recent frames. GPU times are only available when the
+  OpenGL driver supports timer queries.
+
+  The input latency is recorded for frames which show the effect of
+  handled input events, from when the EventFilter received the oldest
+  of the events until the frame has been swapped. With Qt 5.6 or
+  later and sync object support in the OpenGL driver, the frame must
+  also have completed on the GPU, which is polled without waiting,
+  so the value may be too large by up to the time until the next
+  frame or swap. An event which is handled without changing anything
+  is counted towards the next frame that is rendered.
+
+  Disabling the collection discards all recorded timings.
+
+  \sa frameStatistics()
+*/
+void
+QuarterWidget::setFrameStatisticsEnabled(bool onoff)
+{
+  PRIVATE(this)->frametimer->setEnabled(onoff);
+}
+
+/*!
+  Returns true if frame timings are collected.
+*/
+bool
+QuarterWidget::frameStatisticsEnabled(void) const
+{
+  return PRIVATE(this)->frametimer->enabled();
+}
+
+/*!
+  Returns a summary of the timings of the most recent frames.
+
+  \sa setFrameStatisticsEnabled()
+*/
+FrameStatistics
+QuarterWidget::frameStatistics(void) const
+{
+  return PRIVATE(this)->frametimer->statistics();
+}
+
+/*!
+  Returns a histogram of \a timing over the most recent frames, e.g.
+  of FrameStatistics::INPUT_LATENCY. Bin \e i counts the frames with
+  values from \e i times \a binwidth seconds up to the next bin, and
+  the last bin also counts all larger values.
+
+  \sa setFrameStatisticsEnabled()
+*/
+QVector<int>
+QuarterWidget::frameTimingHistogram(FrameStatistics::Timing timing,
+                                    double binwidth, int numbins) const
+{
+  return PRIVATE(this)->frametimer->histogram(timing, binwidth, numbins);
+}
+
+/*!
+  \property QuarterWidget::performanceHudEnabled
+
+  \copydetails QuarterWidget::setPerformanceHudEnabled
+*/
+
+/*!
+  Shows/hides an overlay with performance figures: the frame rate and
+  a graph of recent frame times, the time spent in the delay queue,
+  in scene traversal and on the GPU, the scene's triangle, line and
+  point counts, whether delay and timer sensors are pending, and the
+  current navigation state. With sensor profiling enabled, the most
+  expensive sensor callbacks are listed as well. The overlay can also
+  be toggled from the context menu. Frame statistics are collected
+  while it is shown. This is off by default.
+
+  \sa setFrameStatisticsEnabled(), Quarter::setSensorProfilingEnabled()
+*/
+void
+QuarterWidget::setPerformanceHudEnabled(bool onoff)
+{
+  PRIVATE(this)->performancehud->setEnabled(onoff);
+}
+
+/*!
+  Returns true if the performance overlay is shown.
+*/
+bool
+QuarterWidget::performanceHudEnabled(void) const
+{
+  return PRIVATE(this)->performancehud->isEnabled();
+}
+
+/*!
+  \property QuarterWidget::frameBudget
+
+  \copydetails QuarterWidget::setFrameBudget
+*/
+
+/*!
+  Sets the time budget for a single frame, in seconds. When frame
+  statistics are enabled, frameBudgetExceeded() is emitted for every
+  frame that takes longer than this. A budget of 0, which is the
+  default, disables the signal.
+*/
+void
+QuarterWidget::setFrameBudget(double sec)
+{
+  PRIVATE(this)->frametimer->setBudget(sec);
+}
+
+/*!
+  Returns the time budget for a single frame, in seconds.
+*/
+double
+QuarterWidget::frameBudget(void) const
+{
+  return PRIVATE(this)->frametimer->budget();
+}
+
+/*!
+  \typedef void QuarterWidget::FrameCaptureCB(void * userdata, const QImage & image)
+
+  The type of callback functions passed to requestFrameCapture().
+*/
+
+/*!
+  Requests a copy of the next frame rendered by the widget. A redraw
+  is scheduled, and after the scene has been rendered the pixels are
+  read back asynchronously through a ring of pixel buffer objects.
+  \a callback is invoked with \a userdata and the image one or two
+  frames later, once the transfer has completed, so the capture does
+  not stall the rendering.
+
+  The image has the size of the viewport in device pixels. The
+  callback is invoked with the widget's GL context current. If the
+  OpenGL driver lacks pixel buffer objects, the frame is read back
+  synchronously and the callback invoked right away.
+
+  Multisampled framebuffers can not be read directly, so with Qt 6
+  the widget should not use a multisampled surface format when
+  capturing frames.
+*/
+void
+QuarterWidget::requestFrameCapture(FrameCaptureCB * callback, void * userdata)
+{
+  PRIVATE(this)->framecapture->request(callback, userdata);
+  PRIVATE(this)->sorendermanager->scheduleRedraw();
+}
+
+/*!
+  \enum QuarterWidget::RecordingPolicy
+
+  What to do with a recorded frame when the encoder is behind.
+*/
+
+/*!
+  \var QuarterWidget::RecordingPolicy QuarterWidget::DROP_FRAMES
+
+  The frame is dropped, and rendering continues at full speed.
+*/
+
+/*!
+  \var QuarterWidget::RecordingPolicy QuarterWidget::BLOCK_RENDERING
+
+  Rendering waits until the encoder has caught up, so no frame is
+  lost.
+*/
+
+/*!
+  Starts recording every frame the widget renders into \a sink. The
+  frames are read back asynchronously like with requestFrameCapture()
+  and queued for an encoder thread which passes them on to the sink,
+  so recording costs the GUI thread little more than the readback.
+  At most \a queuelength frames are queued; what happens to further
+  frames depends on \a policy. Only frames that are actually rendered
+  are recorded, each with its time since the recording started.
+
+  The sink must stay alive until the recording is stopped. Returns
+  false if \a sink is NULL. A recording already in progress is
+  stopped first.
+
+  \sa FrameSink, ImageSequenceSink, ProcessSink
+*/
+bool
+QuarterWidget::startRecording(FrameSink * sink, RecordingPolicy policy, int queuelength)
+{
+  if (!PRIVATE(this)->videorecorder->startRecording(sink, policy == BLOCK_RENDERING, queuelength)) {
+    return false;
+  }
+  PRIVATE(this)->sorendermanager->scheduleRedraw();
+  return true;
+}
+
+/*!
+  Stops recording. Waits until the queued frames have been written
+  and closes the sink.
+*/
+void
+QuarterWidget::stopRecording(void)
+{
+  PRIVATE(this)->videorecorder->stopRecording();
+}
+
+/*!
+  Returns true while recording.
+*/
+bool
+QuarterWidget::isRecording(void) const
+{
+  return PRIVATE(this)->videorecorder->isRecording();
+}
+
+/*!
+  Returns the number of frames written to the sink by the current or
+  last recording.
+*/
+int
+QuarterWidget::recordedFrames(void) const
+{
+  return PRIVATE(this)->videorecorder->recordedFrames();
+}
+
+/*!
+  Returns the number of frames dropped by the current or last
+  recording, because the queue was full or the widget was resized.
+*/
+int
+QuarterWidget::droppedFrames(void) const
+{
+  return PRIVATE(this)->videorecorder->droppedFrames();
+}
+
+/*!
+  \property QuarterWidget::resolutionScalingEnabled
+
+  \copydetails QuarterWidget::setResolutionScalingEnabled
+*/
+
+/*!
+  Enable/disable dynamic resolution scaling. This is off by default.
+
+  When enabled, frames rendered in quick succession, e.g. while
+  navigating, are rendered into a framebuffer object at a fraction
+  of the viewport size and upscaled into the widget. The fraction is
+  adjusted after every frame to hold targetFrameTime(), but never
+  goes below minimumResolutionScale(). Once no new frame has been
+  rendered for a short moment, the scene is rendered once more at
+  full resolution.
+
+  This trades sharpness for frame rate in fill-rate bound scenes,
+  which is most noticeable on high resolution displays where
+  devicePixelRatio() multiplies the number of pixels. It requires
+  Qt 5 and framebuffer blit support in the OpenGL driver.
+*/
+void
+QuarterWidget::setResolutionScalingEnabled(bool onoff)
+{
+  PRIVATE(this)->resolutionscaler->setEnabled(onoff);
+}
+
+/*!
+  Returns true if dynamic resolution scaling is enabled.
+*/
+bool
+QuarterWidget::resolutionScalingEnabled(void) const
+{
+  return PRIVATE(this)->resolutionscaler->enabled();
+}
+
+/*!
+  \property QuarterWidget::targetFrameTime
+
+  \copydetails QuarterWidget::setTargetFrameTime
+*/
+
+/*!
+  Sets the frame time, in seconds, dynamic resolution scaling tries
+  to hold. The default is 1/30 second.
+*/
+void
+QuarterWidget::setTargetFrameTime(double sec)
+{
+  PRIVATE(this)->resolutionscaler->setTargetFrameTime(sec);
+}
+
+/*!
+  Returns the frame time dynamic resolution scaling tries to hold.
+*/
+double
+QuarterWidget::targetFrameTime(void) const
+{
+  return PRIVATE(this)->resolutionscaler->targetFrameTime();
+}
+
+/*!
+  \property QuarterWidget::minimumResolutionScale
+
+  \copydetails QuarterWidget::setMinimumResolutionScale
+*/
+
+/*!
+  Sets the smallest fraction of the viewport size dynamic resolution
+  scaling will render at, in each direction. The default is 0.5.
+*/
+void
+QuarterWidget::setMinimumResolutionScale(double scale)
+{
+  PRIVATE(this)->resolutionscaler->setMinimumScale(scale);
+}
+
+/*!
+  Returns the smallest fraction of the viewport size dynamic
+  resolution scaling will render at.
+*/
+double
+QuarterWidget::minimumResolutionScale(void) const
+{
+  return PRIVATE(this)->resolutionscaler->minimumScale();
+}
+
+/*!
+  Returns the fraction of the viewport size that interactive frames
+  are currently rendered at.
+
+  \sa setResolutionScalingEnabled()
+*/
+double
+QuarterWidget::resolutionScale(void) const
+{
+  return PRIVATE(this)->resolutionscaler->scale();
+}
+
+/*!
+  \property QuarterWidget::accumulationAntialiasingEnabled
+
+  \copydetails QuarterWidget::setAccumulationAntialiasingEnabled
+*/
+
+/*!
+  Enable/disable accumulation antialiasing. This is off by default.
+
+  When enabled, frames are rendered without antialiasing while the
+  scene or the camera changes. Once nothing has changed for a short
+  moment, the scene is rendered accumulationSamples() more times
+  while the application is idle, each time with the projection
+  offset by a different fraction of a pixel, and the running average
+  of the frames is shown. Any change that schedules a redraw starts
+  over with an ordinary frame.
+
+  This gives still frames smooth edges without paying for
+  multisampling during navigation, so it is best combined with a
+  widget format without multisampling. It requires Qt 5 and
+  framebuffer blit support in the OpenGL driver.
+*/
+void
+QuarterWidget::setAccumulationAntialiasingEnabled(bool onoff)
+{
+  PRIVATE(this)->accumulation->setEnabled(onoff);
+}
+
+/*!
+  Returns true if accumulation antialiasing is enabled.
+*/
+bool
+QuarterWidget::accumulationAntialiasingEnabled(void) const
+{
+  return PRIVATE(this)->accumulation->enabled();
 }
 
 /*!
-  Returns true if the headlight is on, false if it is off.
+  \property QuarterWidget::accumulationSamples
+
+  \copydetails QuarterWidget::setAccumulationSamples
 */
-bool
-QuarterWidget::headlightEnabled(void) const
+
+/*!
+  Sets the number of samples per pixel accumulation antialiasing
+  renders for a still frame, including the ordinary frame. The
+  default is 16.
+*/
+void
+QuarterWidget::setAccumulationSamples(int num)
 {
-  return PRIVATE(this)->headlight->on.getValue();
+  PRIVATE(this)->accumulation->setNumSamples(num);
 }
 
 /*!
-  Returns the light used for the headlight.
+  Returns the number of samples per pixel accumulated for a still
+  frame.
 */
-SoDirectionalLight *
-QuarterWidget::getHeadlight(void)
+int
+QuarterWidget::accumulationSamples(void) const
 {
-  return PRIVATE(this)->headlight;
+  return PRIVATE(this)->accumulation->numSamples();
 }
 
 /*!
-  \property QuarterWidget::clearZBuffer
+  \property QuarterWidget::interactiveQualityEnabled
 
-  \copydetails QuarterWidget::setClearZBuffer
+  \copydetails QuarterWidget::setInteractiveQualityEnabled
 */
 
 /*!
-  Specify if you want the z-buffer to be cleared before
-  redraw. This is on by default.
+  Enable/disable reduced rendering quality during navigation. This is
+  off by default.
+
+  When enabled, the render mode and transparency type are switched to
+  interactiveRenderMode() and interactiveTransparencyType() when the
+  navigation state machine enters one of the interactive states, by
+  default \e rotate, \e pan, \e zoom, \e dolly and \e spin. The
+  previous settings are restored, and a refinement frame rendered,
+  once the state machine returns to \e idle.
+
+  Changes to the render mode or transparency type made while the
+  quality is reduced take effect when the interaction ends.
+  interactiveQualityChanged() is emitted when the quality is reduced
+  and when it is restored.
+
+  \sa setInteractiveState()
 */
 void
-QuarterWidget::setClearZBuffer(bool onoff)
+QuarterWidget::setInteractiveQualityEnabled(bool onoff)
 {
-  PRIVATE(this)->clearzbuffer = onoff;
+  const bool reduced = PRIVATE(this)->navigationquality->active();
+  PRIVATE(this)->navigationquality->setEnabled(onoff);
+  if (reduced && !PRIVATE(this)->navigationquality->active()) {
+    emit this->interactiveQualityChanged(false);
+  }
 }
 
 /*!
-  Returns true if the z-buffer is cleared before rendering.
+  Returns true if the rendering quality is reduced during navigation.
 */
 bool
-QuarterWidget::clearZBuffer(void) const
+QuarterWidget::interactiveQualityEnabled(void) const
 {
-  return PRIVATE(this)->clearzbuffer;
+  return PRIVATE(this)->navigationquality->enabled();
 }
 
 /*!
-  \property QuarterWidget::clearWindow
+  \property QuarterWidget::interactiveRenderMode
 
-  \copydetails QuarterWidget::setClearWindow
+  \copydetails QuarterWidget::setInteractiveRenderMode
 */
 
 /*!
-  Specify if you want the rendering buffer to be cleared before
-  rendering. This is on by default.
- */
+  Sets the render mode used during navigation. The default is
+  BOUNDING_BOX. OCCLUSION_CULLING is not an interactive mode, and is
+  treated as AS_IS.
+*/
 void
-QuarterWidget::setClearWindow(bool onoff)
+QuarterWidget::setInteractiveRenderMode(RenderMode mode)
 {
-  PRIVATE(this)->clearwindow = onoff;
+  if (mode == OCCLUSION_CULLING) mode = AS_IS;
+  PRIVATE(this)->navigationquality->setRenderMode(static_cast<SoRenderManager::RenderMode>(mode));
 }
 
 /*!
-  Returns true if the rendering buffer is cleared before rendering.
+  Returns the render mode used during navigation.
 */
-bool
-QuarterWidget::clearWindow(void) const
+QuarterWidget::RenderMode
+QuarterWidget::interactiveRenderMode(void) const
 {
-  return PRIVATE(this)->clearwindow;
+  return static_cast<RenderMode>(PRIVATE(this)->navigationquality->renderMode());
 }
 
 /*!
-  \property QuarterWidget::interactionModeEnabled
+  \property QuarterWidget::interactiveTransparencyType
 
-  \copydetails QuarterWidget::setInteractionModeEnabled
+  \copydetails QuarterWidget::setInteractiveTransparencyType
 */
 
 /*!
-  Enable/disable interaction mode.
-
-  Specifies whether you may use the Alt-key to enter interaction mode.
+  Sets the transparency type used during navigation. The default is
+  SCREEN_DOOR. WEIGHTED_BLENDED is treated as NONE, which keeps
+  weighted blended transparency on during navigation if it is the
+  transparency type of the widget.
 */
 void
-QuarterWidget::setInteractionModeEnabled(bool onoff)
+QuarterWidget::setInteractiveTransparencyType(TransparencyType type)
 {
-  PRIVATE(this)->interactionmode->setEnabled(onoff);
+  if (type == WEIGHTED_BLENDED) type = NONE;
+  PRIVATE(this)->navigationquality->setTransparencyType(static_cast<SoGLRenderAction::TransparencyType>(type));
 }
 
 /*!
-  Returns true if interaction mode is enabled, false otherwise.
- */
-bool
-QuarterWidget::interactionModeEnabled(void) const
+  Returns the transparency type used during navigation.
+*/
+QuarterWidget::TransparencyType
+QuarterWidget::interactiveTransparencyType(void) const
 {
-  return PRIVATE(this)->interactionmode->enabled();
+  return static_cast<TransparencyType>(PRIVATE(this)->navigationquality->transparencyType());
 }
 
 /*!
-  \property QuarterWidget::interactionModeOn
-
-  \copydetails QuarterWidget::setInteractionModeOn
-*/
+  Sets whether the navigation state \a state reduces the rendering
+  quality. See the Coin documentation on navigation for information
+  about available states.
 
-/*!
-  Turn interaction mode on or off.
+  \sa setInteractiveQualityEnabled()
 */
 void
-QuarterWidget::setInteractionModeOn(bool onoff)
+QuarterWidget::setInteractiveState(const SbName & state, bool onoff)
 {
-  PRIVATE(this)->interactionmode->setOn(onoff);
+  PRIVATE(this)->navigationquality->setStateInteractive(state, onoff);
 }
 
 /*!
-  Returns true if interaction mode is on.
- */
+  Returns true if the navigation state \a state reduces the
+  rendering quality.
+*/
 bool
-QuarterWidget::interactionModeOn(void) const
+QuarterWidget::isInteractiveState(const SbName & state) const
 {
-  return PRIVATE(this)->interactionmode->on();
+  return PRIVATE(this)->navigationquality->isStateInteractive(state);
 }
 
+/*!
+  \fn void QuarterWidget::frameBudgetExceeded(double frametime)
+
+  Emitted when a frame took \a frametime seconds, which is more than
+  the frame budget.
+
+  \sa setFrameBudget()
+*/
+
+/*!
+  \fn void QuarterWidget::interactiveQualityChanged(bool reduced)
+
+  Emitted with \a reduced true when the rendering quality is lowered
+  for navigation, and with \a reduced false when it is restored.
+
+  \sa setInteractiveQualityEnabled()
+*/
+
 /*!
   Returns the Coin cache context id for this widget.
 */
@@ -406,6 +1672,13 @@ void
 QuarterWidget::setTransparencyType(TransparencyType type)
 {
   assert(PRIVATE(this)->sorendermanager);
+  PRIVATE(this)->weightedblended->setEnabled(type == WEIGHTED_BLENDED);
+  if (type == WEIGHTED_BLENDED) type = NONE;
+  if (PRIVATE(this)->navigationquality->active()) {
+    // takes effect when the interaction ends
+    PRIVATE(this)->navigationquality->setFullTransparencyType((SoGLRenderAction::TransparencyType)type);
+    return;
+  }
   PRIVATE(this)->sorendermanager->getGLRenderAction()->setTransparencyType((SoGLRenderAction::TransparencyType)type);
   PRIVATE(this)->sorendermanager->scheduleRedraw();
 }
@@ -418,7 +1691,14 @@ QuarterWidget::transparencyType(void) const
 {
   assert(PRIVATE(this)->sorendermanager);
   SoGLRenderAction * action = PRIVATE(this)->sorendermanager->getGLRenderAction();
-  return static_cast<QuarterWidget::TransparencyType>(action->getTransparencyType());
+  TransparencyType type = static_cast<QuarterWidget::TransparencyType>(action->getTransparencyType());
+  if (PRIVATE(this)->navigationquality->active()) {
+    type = static_cast<QuarterWidget::TransparencyType>(PRIVATE(this)->navigationquality->fullTransparencyType());
+  }
+  if (type == NONE && PRIVATE(this)->weightedblended->enabled()) {
+    return WEIGHTED_BLENDED;
+  }
+  return type;
 }
 
 /*!
@@ -434,6 +1714,13 @@ void
 QuarterWidget::setRenderMode(RenderMode mode)
 {
   assert(PRIVATE(this)->sorendermanager);
+  PRIVATE(this)->customrenderaction->setOcclusionCulling(mode == OCCLUSION_CULLING);
+  if (mode == OCCLUSION_CULLING) mode = AS_IS;
+  if (PRIVATE(this)->navigationquality->active()) {
+    // takes effect when the interaction ends
+    PRIVATE(this)->navigationquality->setFullRenderMode(static_cast<SoRenderManager::RenderMode>(mode));
+    return;
+  }
   PRIVATE(this)->sorendermanager->setRenderMode(static_cast<SoRenderManager::RenderMode>(mode));
   PRIVATE(this)->sorendermanager->scheduleRedraw();
 }
@@ -445,7 +1732,14 @@ QuarterWidget::RenderMode
 QuarterWidget::renderMode(void) const
 {
   assert(PRIVATE(this)->sorendermanager);
-  return static_cast<RenderMode>(PRIVATE(this)->sorendermanager->getRenderMode());
+  RenderMode mode = static_cast<RenderMode>(PRIVATE(this)->sorendermanager->getRenderMode());
+  if (PRIVATE(this)->navigationquality->active()) {
+    mode = static_cast<RenderMode>(PRIVATE(this)->navigationquality->fullRenderMode());
+  }
+  if (mode == AS_IS && PRIVATE(this)->customrenderaction->occlusionCulling()) {
+    return OCCLUSION_CULLING;
+  }
+  return mode;
 }
 
 /*!
@@ -462,6 +1756,7 @@ QuarterWidget::setStereoMode(StereoMode mode)
 {
   assert(PRIVATE(this)->sorendermanager);
   PRIVATE(this)->sorendermanager->setStereoMode(static_cast<SoRenderManager::StereoMode>(mode));
+  PRIVATE(this)->updateStereoCache();
   PRIVATE(this)->sorendermanager->scheduleRedraw();
 }
 
@@ -476,6 +1771,50 @@ QuarterWidget::stereoMode(void) const
   return static_cast<StereoMode>(PRIVATE(this)->sorendermanager->getStereoMode());
 }
 
+/*!
+  \property QuarterWidget::stereoSceneCachingEnabled
+
+  \copydetails QuarterWidget::setStereoSceneCachingEnabled
+*/
+
+/*!
+  Enables or disables rendering the second eye of a stereo frame
+  from a recording of the first. Each stereo mode renders the scene
+  once per eye, and traversing the scene twice doubles the CPU time
+  of a frame. With this enabled, and a stereo mode set, the scene is
+  put below a separator which always builds a render cache.
+  Rendering the first eye records the scene into an OpenGL display
+  list, and the second eye, and later frames for as long as the
+  scene does not change, replay it without traversing the scene.
+
+  Coin's fixed function rendering cannot draw both eyes in one pass
+  through layered or multiview framebuffers, as that needs shaders
+  written for it, so the recording takes its place.
+
+  Only scenes without a camera of their own are cached, as the cache
+  must not contain the camera. Nodes which depend on the view, like
+  levels of detail, screen aligned text and culling separators,
+  keep Coin from reusing the cache for the other eye, and the scene
+  is traversed as usual. Pick paths through the superscene contain
+  the extra separator. The default is off.
+*/
+void
+QuarterWidget::setStereoSceneCachingEnabled(bool onoff)
+{
+  PRIVATE(this)->stereocaching = onoff;
+  PRIVATE(this)->updateStereoCache();
+}
+
+/*!
+  Returns true if stereo frames are rendered from a render cache of
+  the scene.
+*/
+bool
+QuarterWidget::stereoSceneCachingEnabled(void) const
+{
+  return PRIVATE(this)->stereocaching;
+}
+
 /*!
   \property QuarterWidget::devicePixelRatio
 */
@@ -493,7 +1832,9 @@ QuarterWidget::devicePixelRatio(void) const
 }
 
 /*!
-  Sets the Inventor scene graph to be rendered.
+  Sets the Inventor scene graph to be rendered. The scene graph is
+  searched for a camera, and if it has none, one is added in front of
+  it and the view is fitted to the scene.
  */
 void
 QuarterWidget::setSceneGraph(SoNode * node)
@@ -501,40 +1842,33 @@ QuarterWidget::setSceneGraph(SoNode * node)
   if (node == PRIVATE(this)->scene) {
     return;
   }
+  RenderThread::lockScene();
+  PRIVATE(this)->setScene(node, node ? PRIVATE(this)->searchForCamera(node) : NULL);
+  RenderThread::unlockScene();
+}
 
-  if (PRIVATE(this)->scene) {
-    PRIVATE(this)->scene->unref();
-    PRIVATE(this)->scene = NULL;
-  }
-
-  SoCamera * camera = NULL;
-  SoSeparator * superscene = NULL;
-  bool viewall = false;
-
-  if (node) {
-    PRIVATE(this)->scene = node;
-    PRIVATE(this)->scene->ref();
-
-    superscene = new SoSeparator;
-    superscene->addChild(PRIVATE(this)->headlight);
-
-    // if the scene does not contain a camera, add one
-    if (!(camera = PRIVATE(this)->searchForCamera(node))) {
-      camera = new SoPerspectiveCamera;
-      superscene->addChild(camera);
-      viewall = true;
-    }
-
-    superscene->addChild(node);
+/*!
+  Sets the Inventor scene graph to be rendered, with \a camera as the
+  camera, without searching the scene graph for one. This saves a
+  full traversal of large scene graphs. \a camera must be part of \a
+  node. If \a camera is NULL, a camera is added in front of the scene
+  graph and the view is fitted to it, as for a scene graph without a
+  camera.
+
+  The widget keeps its top level separator with the headlight across
+  calls, and only swaps the scene graph below it. Switching between
+  scene graphs that are kept alive elsewhere thus keeps their render
+  caches.
+ */
+void
+QuarterWidget::setSceneGraphWithCamera(SoNode * node, SoCamera * camera)
+{
+  if (node == PRIVATE(this)->scene && camera == PRIVATE(this)->scenecamera) {
+    return;
   }
-
-  PRIVATE(this)->soeventmanager->setCamera(camera);
-  PRIVATE(this)->sorendermanager->setCamera(camera);
-  PRIVATE(this)->soeventmanager->setSceneGraph(superscene);
-  PRIVATE(this)->sorendermanager->setSceneGraph(superscene);
-
-  if (viewall) { this->viewAll(); }
-  if (superscene) { superscene->touch(); }
+  RenderThread::lockScene();
+  PRIVATE(this)->setScene(node, node ? camera : NULL);
+  RenderThread::unlockScene();
 }
 
 /*!
@@ -552,6 +1886,15 @@ QuarterWidget::getSceneGraph(void) const
 void
 QuarterWidget::setSoRenderManager(SoRenderManager * manager)
 {
+  // don't leave the old render manager in reduced quality
+  if (PRIVATE(this)->navigationquality->active()) {
+    PRIVATE(this)->navigationquality->restore();
+    emit this->interactiveQualityChanged(false);
+  }
+  PRIVATE(this)->rendersuspender->renderManagerChanged(PRIVATE(this)->sorendermanager, manager);
+  PRIVATE(this)->customrenderaction->renderManagerChanged(PRIVATE(this)->sorendermanager, manager);
+  SensorProfiler::renderManagerChanged(PRIVATE(this)->sorendermanager, manager);
+
   bool carrydata = false;
   SoNode * scene = NULL;
   SoCamera * camera = NULL;
@@ -580,6 +1923,8 @@ QuarterWidget::setSoRenderManager(SoRenderManager * manager)
 
   if (scene) scene->unref();
   if (camera) camera->unref();
+  PRIVATE(this)->framecache->invalidate();
+  PRIVATE(this)->pickbuffer->invalidate();
 }
 
 /*!
@@ -651,11 +1996,19 @@ QuarterWidget::getEventFilter(void) const
 void
 QuarterWidget::viewAll(void)
 {
+  if (PRIVATE(this)->boundingboxcache->viewAll(PRIVATE(this)->sorendermanager->getCamera(),
+                                               PRIVATE(this)->sorendermanager)) {
+    return;
+  }
+  if (PRIVATE(this)->nativenavigation->viewAll()) {
+    return;
+  }
   const SbName viewallevent("sim.coin3d.coin.navigation.ViewAll");
   for (int c = 0; c < PRIVATE(this)->soeventmanager->getNumSoScXMLStateMachines(); ++c) {
     SoScXMLStateMachine * sostatemachine =
       PRIVATE(this)->soeventmanager->getSoScXMLStateMachine(c);
     if (sostatemachine->isActive()) {
+      QUARTER_TRACE_SCOPE("QuarterWidget::viewAll statemachine");
       sostatemachine->queueEvent(viewallevent);
       sostatemachine->processEventQueue();
     }
@@ -669,11 +2022,15 @@ QuarterWidget::viewAll(void)
 void
 QuarterWidget::seek(void)
 {
+  if (PRIVATE(this)->nativenavigation->seek()) {
+    return;
+  }
   const SbName seekevent("sim.coin3d.coin.navigation.Seek");
   for (int c = 0; c < PRIVATE(this)->soeventmanager->getNumSoScXMLStateMachines(); ++c) {
     SoScXMLStateMachine * sostatemachine =
       PRIVATE(this)->soeventmanager->getSoScXMLStateMachine(c);
     if (sostatemachine->isActive()) {
+      QUARTER_TRACE_SCOPE("QuarterWidget::seek statemachine");
       sostatemachine->queueEvent(seekevent);
       sostatemachine->processEventQueue();
     }
@@ -690,8 +2047,24 @@ QuarterWidget::seek(void)
 void
 QuarterWidget::initializeGL(void)
 {
+  Quarter::completeInit();
   glEnable(GL_DEPTH_TEST);
+#if QT_VERSION >= 0x060000
+  PRIVATE(this)->joinShareGroup();
+#endif
   this->getSoRenderManager()->reinitialize();
+  PRIVATE(this)->multiviewport->reinitialize();
+  PRIVATE(this)->framecache->cleanup();
+  PRIVATE(this)->cachedlayers->cleanup();
+  PRIVATE(this)->pickbuffer->cleanup();
+  PRIVATE(this)->customrenderaction->cleanup();
+  PRIVATE(this)->weightedblended->cleanup();
+  PRIVATE(this)->accumulation->cleanup();
+  if (PRIVATE(this)->renderthreadenabled) {
+    // the render thread shared objects with the old context
+    PRIVATE(this)->renderthread->end();
+    PRIVATE(this)->startRenderThread();
+  }
 }
 
 bool
@@ -726,14 +2099,20 @@ QuarterWidget::resizeGL(int width, int height)
 {
 #if (QT_VERSION >= 0x050600)
   updateDevicePixelRatio();
+  PRIVATE(this)->framecache->devicePixelRatioUpdated();
   qreal dev_pix_ratio = devicePixelRatio();
   width = (int)(dev_pix_ratio * width);
   height = (int)(dev_pix_ratio * height);
 #endif
 
+  PRIVATE(this)->framecache->invalidate();
+  PRIVATE(this)->damagetracker->invalidate();
+  PRIVATE(this)->pickbuffer->invalidate();
   SbViewportRegion vp(width, height);
+  RenderThread::lockScene();
   PRIVATE(this)->sorendermanager->setViewportRegion(vp);
   PRIVATE(this)->soeventmanager->setViewportRegion(vp);
+  RenderThread::unlockScene();
 }
 
 /*!
@@ -743,16 +2122,35 @@ void
 QuarterWidget::paintGL(void)
 {
 #if (QT_VERSION >= 0x050600)
-  if(updateDevicePixelRatio()) {
+  // the device pixel ratio is only looked up again after the widget
+  // has been shown, reparented or moved to another screen
+  if(PRIVATE(this)->framecache->devicePixelRatioDirty() && updateDevicePixelRatio()) {
     qreal dev_pix_ratio = devicePixelRatio();
     int width = (int)(dev_pix_ratio * this->width());
     int height = (int)(dev_pix_ratio * this->height());
     SbViewportRegion vp(width, height);
+    RenderThread::lockScene();
     PRIVATE(this)->sorendermanager->setViewportRegion(vp);
     PRIVATE(this)->soeventmanager->setViewportRegion(vp);
+    RenderThread::unlockScene();
+    PRIVATE(this)->framecache->invalidate();
+    PRIVATE(this)->pickbuffer->invalidate();
   }
+  PRIVATE(this)->framecache->devicePixelRatioUpdated();
 #endif
 
+  if (PRIVATE(this)->renderthread->isRunning()) {
+    // the frame is rendered on the render thread, only a held back
+    // pointer drag is applied here
+    RenderThread::lockScene();
+    PRIVATE(this)->eventfilter->latchPendingEvent();
+    RenderThread::unlockScene();
+    if (!PRIVATE(this)->renderthread->present()) {
+      glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    }
+    return;
+  }
+
   assert(this->isValid() && "No valid GL context found!");
   // We might have to process the delay queue here since we don't know
   // if paintGL() is called from Qt, and we might have some sensors
@@ -766,25 +2164,92 @@ QuarterWidget::paintGL(void)
   // by us, and we don't want to process the delay queue in those
   // cases
 
+  PRIVATE(this)->frametimer->beginFrame();
   PRIVATE(this)->autoredrawenabled = false;
-  if (PRIVATE(this)->processdelayqueue && SoDB::getSensorManager()->isDelaySensorPending()) {
+  // a pointer drag held back for late latching moves the camera now.
+  // The sensors it triggers are processed right away, so that they
+  // don't schedule another frame for the same change
+  const bool latched = PRIVATE(this)->eventfilter->latchPendingEvent();
+  if ((PRIVATE(this)->processdelayqueue || latched) &&
+      SoDB::getSensorManager()->isDelaySensorPending()) {
     // processing the sensors might trigger a redraw in another
     // context. Release this context temporarily
+    QUARTER_TRACE_SCOPE("QuarterWidget::paintGL processDelayQueue");
+    PRIVATE(this)->frametimer->beginDelayQueue();
     this->doneCurrent();
-    SoDB::getSensorManager()->processDelayQueue(FALSE);
+    RenderThread::lockScene();
+    SensorProfiler::processDelayQueue(FALSE);
+    RenderThread::unlockScene();
     this->makeCurrent();
+    PRIVATE(this)->frametimer->endDelayQueue();
   }
   assert(this->isValid() && "No valid GL context found!");
   // we need to render immediately here, and not do scheduleRedraw()
   // since Qt will swap the GL buffers after calling paintGL().
-  this->actualRedraw();
+  PRIVATE(this)->frametimer->beginRender();
+  // nothing has changed since the last frame, e.g. when repainting
+  // after an expose event. Reuse the copy of it if we have one.
+  if (!PRIVATE(this)->framecache->reuseFrame()) {
+    PRIVATE(this)->cachedlayers->update();
+    // the extra samples of a still frame are always rendered at full
+    // resolution
+    const bool sampling = PRIVATE(this)->accumulation->beginFrame();
+    if (!sampling) PRIVATE(this)->resolutionscaler->beginFrame();
+    // only the damaged region is redrawn over the previous frame
+    if (!sampling && !PRIVATE(this)->resolutionscaler->enabled() &&
+        PRIVATE(this)->multiviewport->count() == 0 &&
+        PRIVATE(this)->sorendermanager->getStereoMode() == SoRenderManager::MONO) {
+      if (PRIVATE(this)->damagetracker->beginFrame()) {
+#if (QT_VERSION < 0x060000)
+        // the back buffer is undefined after a swap
+        if (!PRIVATE(this)->framecache->restoreFrame()) {
+          PRIVATE(this)->damagetracker->fullFrame();
+        }
+#endif
+        PRIVATE(this)->damagetracker->scissor();
+      }
+    }
+    else {
+      PRIVATE(this)->damagetracker->invalidate();
+    }
+    bool clearwindow = PRIVATE(this)->clearwindow;
+    if (PRIVATE(this)->cachedlayers->compositeBackground(clearwindow)) {
+      // the window has been cleared before compositing the background
+      // layers, so the render manager must not clear it again
+      PRIVATE(this)->clearwindow = false;
+    }
+    this->actualRedraw();
+    PRIVATE(this)->clearwindow = clearwindow;
+    PRIVATE(this)->cachedlayers->compositeForeground();
+    PRIVATE(this)->damagetracker->endFrame();
+    if (!sampling) PRIVATE(this)->resolutionscaler->endFrame();
+    PRIVATE(this)->accumulation->endFrame();
+    PRIVATE(this)->framecache->frameRendered();
+  }
+  PRIVATE(this)->frametimer->endRender();
+  PRIVATE(this)->framecapture->frameRendered();
   PRIVATE(this)->autoredrawenabled = true;
-  
+  PRIVATE(this)->framepacer->frameRendered();
+  PRIVATE(this)->frametimer->endPaint();
+
   // process the delay queue the next time we enter this function,
   // unless we get here after a call to redraw().
   PRIVATE(this)->processdelayqueue = true;
 }
 
+#if QT_VERSION < 0x060000
+/*!
+  Overridden from QGLWidget to time the buffer swap following
+  paintGL().
+*/
+void
+QuarterWidget::glDraw(void)
+{
+  inherited::glDraw();
+  PRIVATE(this)->frametimer->frameSwapped();
+}
+#endif
+
 /*!
   Used for rendering the scene. Usually Coin/Quarter will automatically redraw
   the scene graph at regular intervals, after the scene is modified.
@@ -798,7 +2263,17 @@ QuarterWidget::redraw(void)
 {
   // we're triggering the next paintGL(). Set a flag to remember this
   // to avoid that we process the delay queue in paintGL()
+  if (PRIVATE(this)->rendersuspender->suspended()) {
+    // a catch-up frame is rendered when the widget is shown again
+    return;
+  }
+  if (PRIVATE(this)->renderthread->isRunning()) {
+    PRIVATE(this)->renderthread->requestFrame(PRIVATE(this)->clearwindow,
+                                              PRIVATE(this)->clearzbuffer);
+    return;
+  }
   PRIVATE(this)->processdelayqueue = false;
+  PRIVATE(this)->framecache->invalidate();
 #if (QT_VERSION >= 0x060000)
   this->update();
 #else
@@ -812,6 +2287,14 @@ QuarterWidget::redraw(void)
 void
 QuarterWidget::actualRedraw(void)
 {
+  QUARTER_TRACE_SCOPE("QuarterWidget::actualRedraw");
+  if (PRIVATE(this)->multiviewport->count() > 0) {
+    PRIVATE(this)->multiviewport->render(PRIVATE(this)->clearwindow,
+                                         PRIVATE(this)->clearzbuffer);
+    return;
+  }
+  PRIVATE(this)->boundingboxcache->setClippingPlanes(PRIVATE(this)->sorendermanager->getCamera(),
+                                                     PRIVATE(this)->sorendermanager);
   PRIVATE(this)->sorendermanager->render(PRIVATE(this)->clearwindow,
                                          PRIVATE(this)->clearzbuffer);
 }
@@ -820,16 +2303,180 @@ QuarterWidget::actualRedraw(void)
 /*!
   Passes an event to the event manager.
 
+  The time of a handled event, SoEvent::getTime(), is taken as the
+  time the input was received when measuring the input latency. The
+  EventFilter sets it to when the QEvent reached the widget.
+
   \param[in] event to pass
   \retval Returns true if the event was successfully processed
 */
 bool
 QuarterWidget::processSoEvent(const SoEvent * event)
 {
-  return
-    event &&
-    PRIVATE(this)->soeventmanager &&
-    PRIVATE(this)->soeventmanager->processEvent(event);
+  QUARTER_TRACE_SCOPE("QuarterWidget::processSoEvent");
+  if (!event || !PRIVATE(this)->soeventmanager) {
+    return false;
+  }
+  RenderThread::lockScene();
+  const bool handled = PRIVATE(this)->processSoEvent(event);
+  RenderThread::unlockScene();
+  if (handled) {
+    PRIVATE(this)->frametimer->inputProcessed(event->getTime());
+  }
+  return handled;
+}
+
+/*!
+  Returns the path to the shape visible at \a pos, given in widget
+  coordinates, or NULL if there is no shape there.
+
+  The first call after the scene graph, the camera or the size of the
+  widget has changed renders the scene into an offscreen buffer with a
+  unique color per shape. Later calls look the shape up in that buffer
+  instead of traversing the scene graph, which makes this suitable for
+  highlighting the shape under the mouse cursor on every mouse move.
+  If framebuffer objects are not available, an SoRayPickAction is used
+  for each call.
+
+  The returned path is owned by the widget and is valid until the
+  next call to pickAt() or until the scene graph changes. ref() it to
+  keep it around for longer.
+
+  Textures, shaders and SoImage nodes are ignored; shapes are picked
+  by their geometry only.
+*/
+SoPath *
+QuarterWidget::pickAt(const QPoint & pos)
+{
+  return PRIVATE(this)->pickbuffer->pick(pos);
+}
+
+/*!
+  Picks all \a points, given in widget coordinates, with the current
+  camera and viewport, and returns the closest picked point for each
+  of them, or NULL where nothing was hit. The caller takes ownership
+  of the returned SoPickedPoint instances.
+
+  The points are distributed over a pool of threads, each applying
+  its own SoRayPickAction, if Coin has been built thread safe.
+  Otherwise they are picked one after the other. The scene graph must
+  not be modified until the call returns.
+*/
+QVector<SoPickedPoint *>
+QuarterWidget::pickMany(const QVector<QPoint> & points)
+{
+  return ParallelPick::pick(PRIVATE(this)->sorendermanager->getSceneGraph(),
+                            PRIVATE(this)->sorendermanager->getViewportRegion(),
+                            points, this->devicePixelRatio());
+}
+
+/*!
+  Adds a viewport to the widget and returns its index. \a rect is
+  given in coordinates normalized to the size of the widget, with the
+  origin in the upper left corner, so that QRectF(0.5, 0, 0.5, 0.5)
+  is the upper right quadrant. The viewport shows the scene graph of
+  the widget through \a camera, or through a new perspective camera
+  showing the whole scene if \a camera is NULL.
+
+  Once a viewport has been added, the widget renders the viewports
+  instead of its own camera, all in the same frame and with the same
+  render caches, and passes mouse events to the viewport under the
+  cursor. A drag stays with the viewport it started in, and keyboard
+  events go to the viewport which got the last mouse event. Each
+  viewport runs its own instance of the navigation file of the
+  widget; the compiled navigation modes, pickAt() and pickMany() only
+  work with the camera of the widget.
+
+  Viewports added later are drawn on top of earlier ones. The scene
+  graph should not contain a camera of its own, as it would override
+  the viewport cameras.
+
+  \code
+  // top, front, side and perspective views
+  viewer->addViewport(QRectF(0.0, 0.0, 0.5, 0.5), top);
+  viewer->addViewport(QRectF(0.5, 0.0, 0.5, 0.5), front);
+  viewer->addViewport(QRectF(0.0, 0.5, 0.5, 0.5), side);
+  viewer->addViewport(QRectF(0.5, 0.5, 0.5, 0.5));
+  \endcode
+
+  \sa removeViewport(), getViewportCamera()
+*/
+int
+QuarterWidget::addViewport(const QRectF & rect, SoCamera * camera)
+{
+  return PRIVATE(this)->multiviewport->add(rect, camera);
+}
+
+/*!
+  Removes the viewport at \a index. The indices of later viewports
+  decrease by one. When the last viewport is removed, the widget
+  renders its own camera again.
+*/
+void
+QuarterWidget::removeViewport(int index)
+{
+  PRIVATE(this)->multiviewport->remove(index);
+}
+
+/*!
+  Removes all viewports.
+*/
+void
+QuarterWidget::removeAllViewports(void)
+{
+  PRIVATE(this)->multiviewport->clear();
+}
+
+/*!
+  Returns the number of viewports added with addViewport().
+*/
+int
+QuarterWidget::viewportCount(void) const
+{
+  return PRIVATE(this)->multiviewport->count();
+}
+
+/*!
+  Returns the camera of the viewport at \a index, or NULL if there is
+  no such viewport.
+*/
+SoCamera *
+QuarterWidget::getViewportCamera(int index) const
+{
+  return PRIVATE(this)->multiviewport->camera(index);
+}
+
+/*!
+  Moves the viewport at \a index to \a rect, in normalized widget
+  coordinates.
+*/
+void
+QuarterWidget::setViewportRect(int index, const QRectF & rect)
+{
+  PRIVATE(this)->multiviewport->setRect(index, rect);
+}
+
+/*!
+  Returns the rectangle of the viewport at \a index, in normalized
+  widget coordinates.
+*/
+QRectF
+QuarterWidget::viewportRect(int index) const
+{
+  return PRIVATE(this)->multiviewport->rect(index);
+}
+
+/*!
+  Returns the index of the topmost viewport at \a pos, given in
+  widget coordinates, or -1 if there is none.
+*/
+int
+QuarterWidget::viewportAt(const QPoint & pos) const
+{
+  const qreal dpr = this->devicePixelRatio();
+  const SbVec2s size = this->getSoRenderManager()->getViewportRegion().getWindowSize();
+  const SbVec2s position(short(pos.x() * dpr), short(size[1] - pos.y() * dpr - 1));
+  return PRIVATE(this)->multiviewport->viewportAt(position);
 }
 
 /*!
@@ -854,6 +2501,7 @@ QuarterWidget::setBackgroundColor(const QColor & color)
                     SbClamp(color.alpha() / 255.0, 0.0, 1.0));
 
   PRIVATE(this)->sorendermanager->setBackgroundColor(bgcolor);
+  PRIVATE(this)->damagetracker->invalidate();
   PRIVATE(this)->sorendermanager->scheduleRedraw();
 }
 
@@ -1011,96 +2659,38 @@ QuarterWidget::resetNavigationModeFile(void) {
 void
 QuarterWidget::setNavigationModeFile(const QUrl & url)
 {
-  QString filename;
-
-  if (url.scheme()=="coin") {
-    filename = url.path();
-    //FIXME: This conditional needs to be implemented when the
-    //CoinResources systems if working
-#if 0
-    //#if (COIN_MAJOR_VERSION==3) && (COIN_MINOR_VERSION==0)
-#endif
-    //Workaround for differences between url scheme, and Coin internal
-    //scheme in Coin 3.0.
-    if (filename[0]=='/') {
-      filename.remove(0,1);
-    }
-#if 0
-    //#endif
-#endif
-    filename = url.scheme()+':'+filename;
-  }
-  else if (url.scheme()=="file")
-    filename = url.toLocalFile();
-  else if (url.isEmpty()) {
+  const bool attached = !PRIVATE(this)->nativenavigation->enabled();
+  if (url.isEmpty()) {
     if (PRIVATE(this)->currentStateMachine) {
-      this->removeStateMachine(PRIVATE(this)->currentStateMachine);
-      delete PRIVATE(this)->currentStateMachine;
+      if (attached) this->removeStateMachine(PRIVATE(this)->currentStateMachine);
+      QuarterWidgetP::releaseNavigationFile(PRIVATE(this)->currentStateMachine);
       PRIVATE(this)->currentStateMachine = NULL;
       PRIVATE(this)->navigationModeFile = url;
     }
     return;
   }
-  else {
-    qDebug()<<url.scheme()<<"is not recognized";
-    return;
-  }
 
-  QByteArray filenametmp = filename.toLocal8Bit();
-  ScXMLStateMachine * stateMachine = NULL;
-
-  if (filenametmp.startsWith("coin:")){
-    stateMachine = ScXML::readFile(filenametmp.data());
-  }
-  else {
-    //Use Qt to read the file in case it is a Qt resource
-    QFile file(filenametmp);
-    if (file.open(QIODevice::ReadOnly)){
-      QByteArray fileContents = file.readAll();
-      stateMachine = ScXML::readBuffer(SbByteBuffer(fileContents.size(), fileContents.constData()));
-      file.close();
-    }
+  SoScXMLStateMachine * newsm = QuarterWidgetP::loadNavigationFile(url);
+  if (!newsm) {
+    return;
   }
 
-  if (stateMachine &&
-      stateMachine->isOfType(SoScXMLStateMachine::getClassTypeId())) {
-    SoScXMLStateMachine * newsm = 
-      static_cast<SoScXMLStateMachine *>(stateMachine);
-    if (PRIVATE(this)->currentStateMachine) {
-      this->removeStateMachine(PRIVATE(this)->currentStateMachine);
-      delete PRIVATE(this)->currentStateMachine;
-    }
-    this->addStateMachine(newsm);
-    newsm->initialize();
-    PRIVATE(this)->currentStateMachine = newsm;
-  }
-  else {
-    delete stateMachine;
-	stateMachine = NULL;
-    qDebug()<<filename;
-    qDebug()<<"Unable to load"<<url;
-    return;
+  if (PRIVATE(this)->currentStateMachine) {
+    if (attached) this->removeStateMachine(PRIVATE(this)->currentStateMachine);
+    QuarterWidgetP::releaseNavigationFile(PRIVATE(this)->currentStateMachine);
   }
+  // with native navigation the state machine is only attached once
+  // the widget is switched back to SCXML
+  if (attached) this->addStateMachine(newsm);
+  newsm->initialize();
+  PRIVATE(this)->currentStateMachine = newsm;
 
   //If we have gotten this far, we have successfully loaded the
   //navigation file, so we set the property
   PRIVATE(this)->navigationModeFile = url;
 
   if (QUrl(DEFAULT_NAVIGATIONFILE) == PRIVATE(this)->navigationModeFile ) {
-
-    // set up default cursors for the examiner navigation states
-    //FIXME: It may be overly restrictive to not do this for arbitrary
-    //navigation systems? - BFG 20090117
-    this->setStateCursor("interact", Qt::ArrowCursor);
-    this->setStateCursor("idle", Qt::OpenHandCursor);
-#if QT_VERSION >= 0x040200
-    this->setStateCursor("rotate", Qt::ClosedHandCursor);
-#endif
-    this->setStateCursor("pan", Qt::SizeAllCursor);
-    this->setStateCursor("zoom", Qt::SizeVerCursor);
-    this->setStateCursor("dolly", Qt::SizeVerCursor);
-    this->setStateCursor("seek", Qt::CrossCursor);
-    this->setStateCursor("spin", Qt::OpenHandCursor);
+    QuarterWidgetP::setDefaultStateCursors();
   }
 }
 
@@ -1113,4 +2703,75 @@ QuarterWidget::navigationModeFile(void) const
   return PRIVATE(this)->navigationModeFile;
 }
 
+/*!
+  \property QuarterWidget::navigationMode
+
+  \copydetails QuarterWidget::setNavigationMode
+*/
+
+/*!
+  Selects how mouse input navigates the camera. SCXML, the default,
+  runs the state machine from navigationModeFile(). EXAMINER_NATIVE,
+  PLANE_NATIVE and FLY_NATIVE use Quarter's compiled navigation
+  instead, which handles events without going through the ScXML
+  interpreter but goes through the same idle, rotate, pan and zoom
+  states, so state cursors and interactive quality keep working.
+
+  The navigation mode file stays loaded while a native mode is in
+  use, and is used again when switching back to SCXML.
+
+  \sa setNavigationModeFile()
+*/
+void
+QuarterWidget::setNavigationMode(NavigationMode mode)
+{
+  NativeNavigation * nativenavigation = PRIVATE(this)->nativenavigation;
+  const bool wasnative = nativenavigation->enabled();
+  const bool native = (mode != SCXML);
+
+  switch (mode) {
+  case EXAMINER_NATIVE:
+    nativenavigation->setMode(NativeNavigation::EXAMINER);
+    break;
+  case PLANE_NATIVE:
+    nativenavigation->setMode(NativeNavigation::PLANE);
+    break;
+  case FLY_NATIVE:
+    nativenavigation->setMode(NativeNavigation::FLY);
+    break;
+  default:
+    break;
+  }
+  if (native == wasnative) return;
+
+  nativenavigation->setEnabled(native);
+  SoScXMLStateMachine * statemachine = PRIVATE(this)->currentStateMachine;
+  if (statemachine) {
+    if (native) this->removeStateMachine(statemachine);
+    else this->addStateMachine(statemachine);
+  }
+  if (native) {
+    QuarterWidgetP::setDefaultStateCursors();
+    this->setCursor(QuarterP::statecursormap->value("idle"));
+  }
+}
+
+/*!
+  Returns the current navigation mode.
+*/
+QuarterWidget::NavigationMode
+QuarterWidget::navigationMode(void) const
+{
+  const NativeNavigation * nativenavigation = PRIVATE(this)->nativenavigation;
+  if (!nativenavigation->enabled()) return SCXML;
+  switch (nativenavigation->mode()) {
+  case NativeNavigation::PLANE:
+    return PLANE_NATIVE;
+  case NativeNavigation::FLY:
+    return FLY_NATIVE;
+  default:
+    return EXAMINER_NATIVE;
+  }
+}
+
 #undef PRIVATE
@@ -35,24 +35,51 @@
 #include <Quarter/eventhandlers/EventFilter.h>
 
 #include <QApplication>
+#include <QByteArray>
+#include <QDebug>
+#include <QFile>
+#include <QHash>
 #include <QActionGroup>
 #include <QCursor>
 #include <QMenu>
 #include <QMap>
+#if QT_VERSION >= 0x060000
+#  include <QOpenGLContext>
+#endif
 
 #include <Inventor/nodes/SoCamera.h>
 #include <Inventor/nodes/SoNode.h>
+#include <Inventor/nodes/SoPerspectiveCamera.h>
+#include <Inventor/nodes/SoSeparator.h>
+#include <Inventor/nodes/SoDirectionalLight.h>
+#include <Inventor/SoRenderManager.h>
 #include <Inventor/actions/SoSearchAction.h>
 #include <Inventor/elements/SoGLCacheContextElement.h>
+#include <Inventor/errors/SoDebugError.h>
 #include <Inventor/lists/SbList.h>
 #include <Inventor/SoEventManager.h>
+#include <Inventor/scxml/ScXML.h>
+#include <Inventor/scxml/ScXMLDocument.h>
 #include <Inventor/scxml/SoScXMLStateMachine.h>
+#include <Inventor/SbByteBuffer.h>
 #include <Inventor/misc/SoContextHandler.h>
 #include <Inventor/C/glue/gl.h>
 
 #include "NativeEvent.h"
+#include "AccumulationAntialiasing.h"
 #include "ContextMenu.h"
+#include "FrameCache.h"
+#include "FramePacer.h"
+#include "FrameScheduler.h"
+#include "FrameTimer.h"
+#include "MultiViewport.h"
+#include "NativeNavigation.h"
+#include "NavigationQuality.h"
+#include "PerformanceHud.h"
+#include "PickBuffer.h"
 #include "QuarterP.h"
+#include "RenderThread.h"
+#include "WeightedBlendedTransparency.h"
 
 #include <stdlib.h>
 
@@ -61,14 +88,17 @@ using namespace SIM::Coin3D::Quarter;
 class QuarterWidgetP_cachecontext {
 public:
   uint32_t id;
-#if QT_VERSION >= 0x060000
-  SbList <const QOpenGLWidget *> widgetlist;
-#else
-  SbList <const QGLWidget *> widgetlist;
-#endif
+  // the members of the share group, i.e. the GL widgets of
+  // QuarterWidgets and QuarterOffscreenRenderers
+  SbList <const void *> memberlist;
+  // the GL share group the caches are built in, set when a member
+  // widget first initializes its context
+  const void * sharegroup;
 };
 
 static SbList <QuarterWidgetP_cachecontext *> * cachecontext_list = NULL;
+// maps each share group member to its cache context
+static QHash <const void *, QuarterWidgetP_cachecontext *> * cachecontext_members = NULL;
 
 #if QT_VERSION >= 0x060000
 QuarterWidgetP::QuarterWidgetP(QuarterWidget * masterptr, const QOpenGLWidget * sharewidget)
@@ -77,8 +107,33 @@ QuarterWidgetP::QuarterWidgetP(QuarterWidget * masterptr, const QGLWidget * shar
 #endif
 : master(masterptr),
   scene(NULL),
+  superscene(NULL),
+  stereocache(NULL),
+  stereocaching(false),
+  scenecamera(NULL),
   eventfilter(NULL),
   interactionmode(NULL),
+  framepacer(NULL),
+  framecache(NULL),
+  damagetracker(NULL),
+  framecapture(NULL),
+  videorecorder(NULL),
+  frametimer(NULL),
+  navigationquality(NULL),
+  nativenavigation(NULL),
+  resolutionscaler(NULL),
+  residencymanager(NULL),
+  rendersuspender(NULL),
+  resizedebouncer(NULL),
+  renderthread(NULL),
+  renderthreadenabled(false),
+  cachedlayers(NULL),
+  pickbuffer(NULL),
+  customrenderaction(NULL),
+  weightedblended(NULL),
+  accumulation(NULL),
+  prewarmer(NULL),
+  multiviewport(NULL),
   sorendermanager(NULL),
   soeventmanager(NULL),
   initialsorendermanager(false),
@@ -94,7 +149,12 @@ QuarterWidgetP::QuarterWidgetP(QuarterWidget * masterptr, const QGLWidget * shar
   device_pixel_ratio(1.0),
   addactions(true)
 {
-  this->cachecontext = findCacheContext(masterptr, sharewidget);
+#if QT_VERSION >= 0x060000
+  const QOpenGLWidget * widget = masterptr;
+#else
+  const QGLWidget * widget = masterptr;
+#endif
+  this->cachecontext = findCacheContext(widget, sharewidget);
 
 #if (QT_VERSION < 0x050000)
   // FIXME: Centralize this as only one custom event filter can be
@@ -105,7 +165,18 @@ QuarterWidgetP::QuarterWidgetP(QuarterWidget * masterptr, const QGLWidget * shar
 
 QuarterWidgetP::~QuarterWidgetP()
 {
-  removeFromCacheContext(this->cachecontext, this->master);
+#if QT_VERSION >= 0x060000
+  QOpenGLWidget * widget = this->master;
+#else
+  QGLWidget * widget = this->master;
+#endif
+  if (removeFromCacheContext(this->cachecontext, widget)) {
+    // set the context while calling destructingContext() (might trigger OpenGL calls)
+    widget->makeCurrent();
+    destructCacheContext(this->cachecontext);
+    widget->doneCurrent();
+  }
+  if (this->stereocache) this->stereocache->unref();
   delete this->contextmenu;
 }
 
@@ -126,85 +197,301 @@ QuarterWidgetP::searchForCamera(SoNode * root)
   return NULL;
 }
 
+/*
+  Puts \a root below the superscene, after the headlight and, if \a
+  camera is NULL, a camera of our own. The superscene is only rebuilt
+  when the managers no longer have it, so that the managers are not
+  reset on every scene swap.
+ */
+void
+QuarterWidgetP::setScene(SoNode * root, SoCamera * camera)
+{
+  if (root) root->ref();
+  if (this->scene) this->scene->unref();
+  this->scene = root;
+  this->scenecamera = camera;
+  this->prewarmer->cancel();
+  this->boundingboxcache->setScene(root);
+  this->multiviewport->setScene(root);
+
+  if (!root) {
+    this->soeventmanager->setCamera(NULL);
+    this->sorendermanager->setCamera(NULL);
+    this->soeventmanager->setSceneGraph(NULL);
+    this->sorendermanager->setSceneGraph(NULL);
+    if (this->superscene) {
+      this->superscene->unref();
+      this->superscene = NULL;
+    }
+    if (this->stereocache) this->stereocache->removeAllChildren();
+    return;
+  }
+
+  const bool reuse = this->superscene &&
+    this->sorendermanager->getSceneGraph() == this->superscene &&
+    this->soeventmanager->getSceneGraph() == this->superscene;
+  if (!reuse) {
+    if (this->superscene) this->superscene->unref();
+    this->superscene = new SoSeparator;
+    this->superscene->ref();
+    this->superscene->addChild(this->headlight);
+  }
+
+  // one notification for the whole swap, from the touch() below
+  const SbBool notify = this->superscene->enableNotify(FALSE);
+  while (this->superscene->getNumChildren() > 1) {
+    this->superscene->removeChild(1);
+  }
+  bool viewall = false;
+  // if the scene does not contain a camera, add one
+  if (!camera) {
+    camera = new SoPerspectiveCamera;
+    this->superscene->addChild(camera);
+    viewall = true;
+  }
+  this->superscene->addChild(root);
+  this->superscene->enableNotify(notify);
+
+  this->soeventmanager->setCamera(camera);
+  this->sorendermanager->setCamera(camera);
+  if (!reuse) {
+    this->soeventmanager->setSceneGraph(this->superscene);
+    this->sorendermanager->setSceneGraph(this->superscene);
+  }
+
+  this->updateStereoCache();
+
+  if (viewall) { this->master->viewAll(); }
+  this->superscene->touch();
+}
+
+/*
+  Puts the scene below a separator which always caches, or takes it
+  out again, when stereo scene caching is enabled and a stereo mode
+  is set. The camera of the superscene is to the left of the
+  separator, so the display list recorded while rendering the first
+  eye is valid for the second. A camera inside the scene would make
+  the cache depend on the eye, so scenes with their own camera are
+  left alone.
+ */
+void
+QuarterWidgetP::updateStereoCache(void)
+{
+  if (!this->superscene) return;
+  const bool wanted = this->stereocaching && this->scene && !this->scenecamera &&
+    this->sorendermanager->getStereoMode() != SoRenderManager::MONO;
+
+  const int last = this->superscene->getNumChildren() - 1;
+  const bool wrapped = this->stereocache && last >= 0 &&
+    this->superscene->getChild(last) == this->stereocache;
+  // setScene() takes the cache out of the superscene, release the old
+  // scene it still holds
+  if (!wrapped && this->stereocache) this->stereocache->removeAllChildren();
+  if (wanted == wrapped) return;
+
+  const SbBool notify = this->superscene->enableNotify(FALSE);
+  if (wanted) {
+    if (!this->stereocache) {
+      this->stereocache = new SoSeparator;
+      this->stereocache->ref();
+      this->stereocache->renderCaching = SoSeparator::ON;
+      // culling would make the cache depend on the view volume of the eye
+      this->stereocache->renderCulling = SoSeparator::OFF;
+    }
+    this->stereocache->removeAllChildren();
+    this->stereocache->addChild(this->scene);
+    this->superscene->replaceChild(last, this->stereocache);
+  } else {
+    this->superscene->replaceChild(last, this->stereocache->getChild(0));
+    this->stereocache->removeAllChildren();
+  }
+  this->superscene->enableNotify(notify);
+  this->superscene->touch();
+}
+
 uint32_t
 QuarterWidgetP::getCacheContextId(void) const
 {
-  return this->cachecontext->id;
+  return getCacheContextId(this->cachecontext);
 }
 
+/*
+  Returns the cache context of the share group \a sharemember belongs
+  to, or a new cache context if \a sharemember is NULL or not a member
+  of any group, and adds \a member to it.
+ */
 QuarterWidgetP_cachecontext *
-#if QT_VERSION >= 0x060000
-QuarterWidgetP::findCacheContext(QuarterWidget * widget, const QOpenGLWidget * sharewidget)
-#else
-QuarterWidgetP::findCacheContext(QuarterWidget * widget, const QGLWidget * sharewidget)
-#endif
+QuarterWidgetP::findCacheContext(const void * member, const void * sharemember)
 {
   if (cachecontext_list == NULL) {
     // FIXME: static memory leak
     cachecontext_list = new SbList <QuarterWidgetP_cachecontext*>;
+    cachecontext_members = new QHash <const void *, QuarterWidgetP_cachecontext *>;
   }
-  for (int i = 0; i < cachecontext_list->getLength(); i++) {
-    QuarterWidgetP_cachecontext * cachecontext = (*cachecontext_list)[i];
-
-    for (int j = 0; j < cachecontext->widgetlist.getLength(); j++) {
-      if (cachecontext->widgetlist[j] == sharewidget) {
-#if QT_VERSION >= 0x060000
-        cachecontext->widgetlist.append((const QOpenGLWidget*) widget);
-#else
-        cachecontext->widgetlist.append((const QGLWidget*) widget);
-#endif
-        return cachecontext;
-      }
+  if (sharemember) {
+    QuarterWidgetP_cachecontext * cachecontext = cachecontext_members->value(sharemember, NULL);
+    if (cachecontext) {
+      cachecontext->memberlist.append(member);
+      cachecontext_members->insert(member, cachecontext);
+      return cachecontext;
     }
   }
   QuarterWidgetP_cachecontext * cachecontext = new QuarterWidgetP_cachecontext;
   cachecontext->id = SoGLCacheContextElement::getUniqueCacheContext();
-#if QT_VERSION >= 0x060000
-  cachecontext->widgetlist.append((const QOpenGLWidget*) widget);
-#else
-  cachecontext->widgetlist.append((const QGLWidget*) widget);
-#endif
+  cachecontext->sharegroup = NULL;
+  cachecontext->memberlist.append(member);
   cachecontext_list->append(cachecontext);
+  cachecontext_members->insert(member, cachecontext);
 
   return cachecontext;
 }
 
-void
-#if QT_VERSION >= 0x060000
-QuarterWidgetP::removeFromCacheContext(QuarterWidgetP_cachecontext * context, const QOpenGLWidget * widget)
+/*
+  Removes \a member from its share group. Returns true if it was the
+  last member, in which case the caller must make a GL context of the
+  group current and call destructCacheContext().
+ */
+bool
+QuarterWidgetP::removeFromCacheContext(QuarterWidgetP_cachecontext * context, const void * member)
 {
-  context->widgetlist.removeItem((const QOpenGLWidget*) widget);
-#else
-QuarterWidgetP::removeFromCacheContext(QuarterWidgetP_cachecontext * context, const QGLWidget * widget)
+  context->memberlist.removeItem(member);
+  cachecontext_members->remove(member);
+  return context->memberlist.getLength() == 0;
+}
+
+void
+QuarterWidgetP::destructCacheContext(QuarterWidgetP_cachecontext * context)
 {
-  context->widgetlist.removeItem((const QGLWidget*) widget);
-#endif
+  assert(cachecontext_list);
+  assert(context->memberlist.getLength() == 0);
 
-  if (context->widgetlist.getLength() == 0) { // last context in this share group?
-    assert(cachecontext_list);
+  for (int i = 0; i < cachecontext_list->getLength(); i++) {
+    if ((*cachecontext_list)[i] == context) {
+      // fetch the cc_glglue context instance as a workaround for a bug fixed in Coin r12818
+      (void) cc_glglue_instance(context->id);
+      cachecontext_list->removeFast(i);
+      SoContextHandler::destructingContext(context->id);
+      delete context;
+      return;
+    }
+  }
+}
 
-    for (int i = 0; i < cachecontext_list->getLength(); i++) {
-      if ((*cachecontext_list)[i] == context) {
-        // set the context while calling destructingContext() (might trigger OpenGL calls)
 #if QT_VERSION >= 0x060000
-        const_cast<QOpenGLWidget*> (widget)->makeCurrent();
-#else
-        const_cast<QGLWidget*> (widget)->makeCurrent();
+/*
+  Moves the widget to the cache context of the GL share group its
+  context belongs to. On Qt 6, QOpenGLWidget creates its context
+  itself, sharing objects with the other widgets of its window, or
+  with QOpenGLContext::globalShareContext() if the application sets
+  Qt::AA_ShareOpenGLContexts, so the share widget given to the
+  constructor is only a request. Coin must not reuse display lists
+  and textures in a context which does not have them, and widgets
+  which do share objects should build their caches only once. Must
+  be called with the widget's context current.
+ */
+void
+QuarterWidgetP::joinShareGroup(void)
+{
+  QOpenGLContext * context = this->master->context();
+  if (!context) return;
+  const void * sharegroup = context->shareGroup();
+  QuarterWidgetP_cachecontext * current = this->cachecontext;
+  if (current->sharegroup == sharegroup) return;
+
+  QuarterWidgetP_cachecontext * target = NULL;
+  for (int i = 0; i < cachecontext_list->getLength(); i++) {
+    if ((*cachecontext_list)[i]->sharegroup == sharegroup) {
+      target = (*cachecontext_list)[i];
+      break;
+    }
+  }
+  if (!target && !current->sharegroup) {
+    // the first member to initialize decides where the caches live
+    current->sharegroup = sharegroup;
+    return;
+  }
+
+  static bool warned = false;
+  if (current->sharegroup && current->memberlist.getLength() > 1 && !warned) {
+    warned = true;
+    SoDebugError::postWarning("QuarterWidget::initializeGL",
+                              "The widget does not share OpenGL objects with "
+                              "its share widget, so their caches are built "
+                              "twice. Set Qt::AA_ShareOpenGLContexts before "
+                              "creating the application to share them.");
+  }
+
+  const QOpenGLWidget * widget = this->master;
+  if (removeFromCacheContext(current, widget)) {
+    if (!current->sharegroup) {
+      destructCacheContext(current);
+    } else {
+      // the caches were built in a context that is not current, and
+      // cannot be released from this one
+      cachecontext_list->removeItem(current);
+      delete current;
+    }
+  }
+
+  if (target) {
+    target->memberlist.append(widget);
+    cachecontext_members->insert(widget, target);
+  } else {
+    target = findCacheContext(widget, NULL);
+    target->sharegroup = sharegroup;
+  }
+  this->cachecontext = target;
+  this->sorendermanager->getGLRenderAction()->setCacheContext(target->id);
+}
 #endif
-        // fetch the cc_glglue context instance as a workaround for a bug fixed in Coin r12818
-        (void) cc_glglue_instance(context->id);
-        cachecontext_list->removeFast(i);
-        SoContextHandler::destructingContext(context->id);
+
+/*
+  Starts rendering on the render thread, with a context sharing
+  objects with the widget's. Does nothing before the widget's context
+  has been created, initializeGL() calls this again.
+ */
+void
+QuarterWidgetP::startRenderThread(void)
+{
 #if QT_VERSION >= 0x060000
-        const_cast<QOpenGLWidget*> (widget)->doneCurrent();
+  QOpenGLContext * context = this->master->context();
+#elif QT_VERSION >= 0x050000
+  QOpenGLContext * context =
+    this->master->context() ? this->master->context()->contextHandle() : NULL;
 #else
-        const_cast<QGLWidget*> (widget)->doneCurrent();
+  // there is no QOpenGLContext to share objects with
+  SoDebugError::postWarning("QuarterWidget::setRenderThreadEnabled",
+                            "Rendering on a thread of its own needs Qt 5, "
+                            "rendering on the GUI thread.");
+  this->renderthreadenabled = false;
+  return;
 #endif
-        delete context;
-        return;
-      }
+  if (!context || this->renderthread->isRunning()) return;
+  if (!this->renderthread->begin(context)) {
+    this->renderthreadenabled = false;
+  }
+}
+
+uint32_t
+QuarterWidgetP::getCacheContextId(QuarterWidgetP_cachecontext * context)
+{
+  return context->id;
+}
+
+/*
+  Returns the number of share group members using the cache context
+  \a id, or 0 if there is no such context.
+ */
+int
+QuarterWidgetP::getCacheContextMemberCount(uint32_t id)
+{
+  if (cachecontext_list == NULL) return 0;
+  for (int i = 0; i < cachecontext_list->getLength(); i++) {
+    if ((*cachecontext_list)[i]->id == id) {
+      return (*cachecontext_list)[i]->memberlist.getLength();
     }
   }
+  return 0;
 }
 
 /*!
@@ -215,8 +502,18 @@ QuarterWidgetP::rendercb(void * userdata, SoRenderManager *)
 {
   QuarterWidget * thisp = static_cast<QuarterWidget *>(userdata);
 
+  thisp->pimpl->framecache->invalidate();
+  thisp->pimpl->pickbuffer->invalidate();
+  thisp->pimpl->accumulation->invalidate();
+  thisp->pimpl->frametimer->redrawScheduled();
   if (thisp->pimpl->autoredrawenabled) {
-    thisp->redraw();
+    if (thisp->pimpl->sharedscheduling && QuarterP::framescheduler) {
+      QuarterP::framescheduler->scheduleRedraw(thisp);
+    } else if (thisp->pimpl->framepacer->active()) {
+      thisp->pimpl->framepacer->scheduleRedraw();
+    } else {
+      thisp->redraw();
+    }
   }
 }
 
@@ -230,12 +527,16 @@ QuarterWidgetP::prerendercb(void * userdata, SoRenderManager * manager)
     SoScXMLStateMachine * statemachine = evman->getSoScXMLStateMachine(c);
     statemachine->preGLRender();
   }
+  thisp->weightedblended->beginFrame(manager);
+  thisp->frametimer->beginGPU();
 }
 
 void
 QuarterWidgetP::postrendercb(void * userdata, SoRenderManager * manager)
 {
   QuarterWidgetP * thisp = static_cast<QuarterWidgetP *>(userdata);
+  thisp->weightedblended->endFrame(manager);
+  thisp->frametimer->endGPU();
   SoEventManager * evman = thisp->soeventmanager;
   assert(evman);
   for (int c = 0; c < evman->getNumSoScXMLStateMachines(); ++c) {
@@ -247,19 +548,157 @@ QuarterWidgetP::postrendercb(void * userdata, SoRenderManager * manager)
 void
 QuarterWidgetP::statechangecb(void * userdata, ScXMLStateMachine * statemachine, const char * stateid, SbBool enter, SbBool)
 {
-  static const SbName contextmenurequest("contextmenurequest");
   QuarterWidgetP * thisp = static_cast<QuarterWidgetP *>(userdata);
   assert(thisp && thisp->master);
   if (enter) {
-    SbName state(stateid);
-    if (thisp->contextmenuenabled && state == contextmenurequest) {
-      thisp->contextMenu()->exec(thisp->eventfilter->globalMousePosition());
+    thisp->navigationStateEntered(SbName(stateid));
+  }
+}
+
+/*
+  State change notification from the native navigation engine.
+ */
+void
+QuarterWidgetP::nativestatecb(void * userdata, const SbName & state)
+{
+  QuarterWidgetP * thisp = static_cast<QuarterWidgetP *>(userdata);
+  assert(thisp && thisp->master);
+  thisp->navigationStateEntered(state);
+}
+
+/*
+  Updates the cursor and everything else that follows the navigation
+  state, for both ScXML and native navigation.
+ */
+void
+QuarterWidgetP::navigationStateEntered(const SbName & state)
+{
+  static const SbName contextmenurequest("contextmenurequest");
+  if (this->contextmenuenabled && state == contextmenurequest) {
+    this->contextMenu()->exec(this->eventfilter->globalMousePosition());
+  }
+  if (QuarterP::statecursormap->contains(state)) {
+    QCursor cursor = QuarterP::statecursormap->value(state);
+    this->master->setCursor(cursor);
+  }
+  const bool reduced = this->navigationquality->active();
+  this->navigationquality->stateEntered(state);
+  this->performancehud->stateEntered(state);
+  if (this->navigationquality->active() != reduced) {
+    emit this->master->interactiveQualityChanged(!reduced);
+  }
+}
+
+/*
+  Reads the navigation state machine from \a url, which uses either
+  the "coin" or the "file" scheme. Returns NULL if the file could not
+  be read.
+
+  The parsed description is kept in a process-wide cache, so each
+  further widget using the same file only gets a fresh runtime state
+  machine around it. Release the returned state machine with
+  releaseNavigationFile(), never delete it directly.
+ */
+SoScXMLStateMachine *
+QuarterWidgetP::loadNavigationFile(const QUrl & url)
+{
+  QString filename;
+
+  if (url.scheme()=="coin") {
+    filename = url.path();
+    //FIXME: This conditional needs to be implemented when the
+    //CoinResources systems if working
+#if 0
+    //#if (COIN_MAJOR_VERSION==3) && (COIN_MINOR_VERSION==0)
+#endif
+    //Workaround for differences between url scheme, and Coin internal
+    //scheme in Coin 3.0.
+    if (filename[0]=='/') {
+      filename.remove(0,1);
     }
-    if (QuarterP::statecursormap->contains(state)) {
-      QCursor cursor = QuarterP::statecursormap->value(state);
-      thisp->master->setCursor(cursor);
+#if 0
+    //#endif
+#endif
+    filename = url.scheme()+':'+filename;
+  }
+  else if (url.scheme()=="file")
+    filename = url.toLocalFile();
+  else {
+    qDebug()<<url.scheme()<<"is not recognized";
+    return NULL;
+  }
+
+  assert(QuarterP::navigationfilecache);
+  ScXMLDocument * description = QuarterP::navigationfilecache->value(filename);
+  if (description) {
+    SoScXMLStateMachine * statemachine = new SoScXMLStateMachine;
+    statemachine->setDescription(description);
+    return statemachine;
+  }
+
+  QByteArray filenametmp = filename.toLocal8Bit();
+  ScXMLStateMachine * stateMachine = NULL;
+
+  if (filenametmp.startsWith("coin:")){
+    stateMachine = ScXML::readFile(filenametmp.data());
+  }
+  else {
+    //Use Qt to read the file in case it is a Qt resource
+    QFile file(filenametmp);
+    if (file.open(QIODevice::ReadOnly)){
+      QByteArray fileContents = file.readAll();
+      stateMachine = ScXML::readBuffer(SbByteBuffer(fileContents.size(), fileContents.constData()));
+      file.close();
     }
   }
+
+  if (stateMachine &&
+      stateMachine->isOfType(SoScXMLStateMachine::getClassTypeId())) {
+    description = stateMachine->getDescription();
+    if (description) {
+      QuarterP::navigationfilecache->insert(filename, description);
+    }
+    return static_cast<SoScXMLStateMachine *>(stateMachine);
+  }
+
+  delete stateMachine;
+  qDebug()<<filename;
+  qDebug()<<"Unable to load"<<url;
+  return NULL;
+}
+
+/*
+  Deletes a state machine returned by loadNavigationFile(). The
+  description is detached first since it is shared through the cache
+  and owned by it.
+ */
+void
+QuarterWidgetP::releaseNavigationFile(SoScXMLStateMachine * statemachine)
+{
+  if (!statemachine) return;
+  statemachine->setDescription(NULL);
+  delete statemachine;
+}
+
+/*
+  Sets up default cursors for the examiner navigation states
+ */
+void
+QuarterWidgetP::setDefaultStateCursors(void)
+{
+  //FIXME: It may be overly restrictive to not do this for arbitrary
+  //navigation systems? - BFG 20090117
+  assert(QuarterP::statecursormap);
+  QuarterP::statecursormap->insert("interact", Qt::ArrowCursor);
+  QuarterP::statecursormap->insert("idle", Qt::OpenHandCursor);
+#if QT_VERSION >= 0x040200
+  QuarterP::statecursormap->insert("rotate", Qt::ClosedHandCursor);
+#endif
+  QuarterP::statecursormap->insert("pan", Qt::SizeAllCursor);
+  QuarterP::statecursormap->insert("zoom", Qt::SizeVerCursor);
+  QuarterP::statecursormap->insert("dolly", Qt::SizeVerCursor);
+  QuarterP::statecursormap->insert("seek", Qt::CrossCursor);
+  QuarterP::statecursormap->insert("spin", Qt::OpenHandCursor);
 }
 
 #define ADD_ACTION(enum, text, group, parent, list)     \
@@ -289,6 +728,7 @@ QuarterWidgetP::transparencyTypeActions(void) const
     ADD_ACTION(QuarterWidget::SORTED_OBJECT_SORTED_TRIANGLE_ADD, "sorted object sorted triangle add", transparencytypegroup, this->master, this->transparencytypeactions);
     ADD_ACTION(QuarterWidget::SORTED_OBJECT_SORTED_TRIANGLE_BLEND, "sorted object sorted triangle blend", transparencytypegroup, this->master, this->transparencytypeactions);
     ADD_ACTION(QuarterWidget::SORTED_LAYERS_BLEND, "sorted layers blend", transparencytypegroup, this->master, this->transparencytypeactions);
+    ADD_ACTION(QuarterWidget::WEIGHTED_BLENDED, "weighted blended", transparencytypegroup, this->master, this->transparencytypeactions);
   }
   return this->transparencytypeactions;
 }
@@ -318,6 +758,7 @@ QuarterWidgetP::renderModeActions(void) const
     ADD_ACTION(QuarterWidget::POINTS, "points", rendermodegroup, this->master, rendermodeactions);
     ADD_ACTION(QuarterWidget::HIDDEN_LINE, "hidden line", rendermodegroup, this->master, rendermodeactions);
     ADD_ACTION(QuarterWidget::BOUNDING_BOX, "bounding box", rendermodegroup, this->master, rendermodeactions);
+    ADD_ACTION(QuarterWidget::OCCLUSION_CULLING, "occlusion culling", rendermodegroup, this->master, rendermodeactions);
   }
   return this->rendermodeactions;
 }
@@ -334,6 +775,38 @@ QuarterWidgetP::contextMenu(void)
   return this->contextmenu->getMenu();
 }
 
+/*
+  Hands the event to the viewports, the native navigation or the
+  event manager, for QuarterWidget::processSoEvent().
+ */
+bool
+QuarterWidgetP::processSoEvent(const SoEvent * event)
+{
+  if (this->multiviewport->count() > 0) {
+    return this->multiviewport->processEvent(event);
+  }
+  if (this->nativenavigation->enabled()) {
+    // no state machines are attached, so the event manager only
+    // hands the event to the scene graph
+    switch (this->soeventmanager->getNavigationState()) {
+    case SoEventManager::NO_NAVIGATION:
+      return this->soeventmanager->processEvent(event);
+    case SoEventManager::MIXED_NAVIGATION:
+      // draggers and manipulators get the event first, unless a
+      // navigation drag is in progress
+      if (!this->nativenavigation->active() &&
+          this->soeventmanager->processEvent(event)) {
+        return true;
+      }
+      break;
+    default:
+      break;
+    }
+    return this->nativenavigation->processEvent(event);
+  }
+  return this->soeventmanager->processEvent(event);
+}
+
 
 bool 
 QuarterWidgetP::nativeEventFilter(void * message, long * result)
@@ -44,6 +44,8 @@ class SoCamera;
 class SoRenderManager;
 class SoEventManager;
 class SoDirectionalLight;
+class SoSeparator;
+class SoEvent;
 class QuarterWidgetP_cachecontext;
 #if QT_VERSION >= 0x060000
   class QOpenGLWidget;
@@ -59,9 +61,31 @@ template <class Key, class T> class QMap;
 
 namespace SIM { namespace Coin3D { namespace Quarter {
 
+class AccumulationAntialiasing;
+class BoundingBoxCache;
+class CachedLayers;
+class CachePrewarmer;
+class CustomRenderAction;
 class EventFilter;
 class InteractionMode;
+class MultiViewport;
 class ContextMenu;
+class DamageTracker;
+class FrameCache;
+class FrameCapture;
+class FramePacer;
+class FrameTimer;
+class NativeNavigation;
+class NavigationQuality;
+class PerformanceHud;
+class PickBuffer;
+class RenderSuspender;
+class RenderThread;
+class ResizeDebouncer;
+class ResidencyManager;
+class ResolutionScaler;
+class VideoRecorder;
+class WeightedBlendedTransparency;
 
 class QuarterWidgetP {
 public:
@@ -73,9 +97,16 @@ public:
 #endif
   ~QuarterWidgetP();
 
-  SoCamera * searchForCamera(SoNode * root);
+  static SoCamera * searchForCamera(SoNode * root);
+  void setScene(SoNode * root, SoCamera * camera);
+  void updateStereoCache(void);
   uint32_t getCacheContextId(void) const;
+#if QT_VERSION >= 0x060000
+  void joinShareGroup(void);
+  void startRenderThread(void);
+#endif
   QMenu * contextMenu(void);
+  bool processSoEvent(const SoEvent * event);
 
   QList<QAction *> transparencyTypeActions(void) const;
   QList<QAction *> renderModeActions(void) const;
@@ -83,8 +114,35 @@ public:
 
   QuarterWidget * const master;
   SoNode * scene;
+  SoSeparator * superscene;
+  SoSeparator * stereocache;
+  bool stereocaching;
+  SoCamera * scenecamera;
   EventFilter * eventfilter;
   InteractionMode * interactionmode;
+  FramePacer * framepacer;
+  FrameCache * framecache;
+  DamageTracker * damagetracker;
+  FrameCapture * framecapture;
+  VideoRecorder * videorecorder;
+  FrameTimer * frametimer;
+  NavigationQuality * navigationquality;
+  NativeNavigation * nativenavigation;
+  ResolutionScaler * resolutionscaler;
+  ResidencyManager * residencymanager;
+  RenderSuspender * rendersuspender;
+  ResizeDebouncer * resizedebouncer;
+  RenderThread * renderthread;
+  bool renderthreadenabled;
+  CachedLayers * cachedlayers;
+  PickBuffer * pickbuffer;
+  CustomRenderAction * customrenderaction;
+  WeightedBlendedTransparency * weightedblended;
+  AccumulationAntialiasing * accumulation;
+  CachePrewarmer * prewarmer;
+  PerformanceHud * performancehud;
+  BoundingBoxCache * boundingboxcache;
+  MultiViewport * multiviewport;
   SoRenderManager * sorendermanager;
   SoEventManager * soeventmanager;
   bool initialsorendermanager;
@@ -98,6 +156,7 @@ public:
   bool clearwindow;
   bool addactions;
   bool processdelayqueue;
+  bool sharedscheduling;
   QUrl navigationModeFile;
   SoScXMLStateMachine * currentStateMachine;
   qreal device_pixel_ratio;
@@ -105,6 +164,8 @@ public:
   static void rendercb(void * userdata, SoRenderManager *);
   static void prerendercb(void * userdata, SoRenderManager * manager);
   static void postrendercb(void * userdata, SoRenderManager * manager);
+  void navigationStateEntered(const SbName & state);
+  static void nativestatecb(void * userdata, const SbName & state);
   static void statechangecb(void * userdata, ScXMLStateMachine * statemachine, const char * stateid, SbBool enter, SbBool success);
 
   mutable QList<QAction *> transparencytypeactions;
@@ -119,14 +180,15 @@ public:
 
   static bool nativeEventFilter(void * message, long * result);
 
- private:
-#if QT_VERSION >= 0x060000
-  QuarterWidgetP_cachecontext * findCacheContext(QuarterWidget * widget, const QOpenGLWidget * sharewidget);
-  static void removeFromCacheContext(QuarterWidgetP_cachecontext * context, const QOpenGLWidget* widget);
-#else
-  QuarterWidgetP_cachecontext * findCacheContext(QuarterWidget * widget, const QGLWidget * sharewidget);
-  static void removeFromCacheContext(QuarterWidgetP_cachecontext * context, const QGLWidget * widget);
-#endif
+  static SoScXMLStateMachine * loadNavigationFile(const QUrl & url);
+  static void releaseNavigationFile(SoScXMLStateMachine * statemachine);
+  static void setDefaultStateCursors(void);
+
+  static QuarterWidgetP_cachecontext * findCacheContext(const void * member, const void * sharemember);
+  static bool removeFromCacheContext(QuarterWidgetP_cachecontext * context, const void * member);
+  static void destructCacheContext(QuarterWidgetP_cachecontext * context);
+  static uint32_t getCacheContextId(QuarterWidgetP_cachecontext * context);
+  static int getCacheContextMemberCount(uint32_t id);
 };
 
 #endif // QUARTER_QUARTERWIDGETP_H
@@ -0,0 +1,825 @@
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+/*!
+  \class SIM::Coin3D::Quarter::QuarterWindow QuarterWindow.h Quarter/QuarterWindow.h
+
+  \brief The QuarterWindow class provides a QWindow for Coin
+  rendering.
+
+  Unlike QuarterWidget, which on Qt 6 renders into a framebuffer
+  object that is composited by the widget stack, QuarterWindow renders
+  straight into the back buffer of the native window and swaps it
+  itself. Use QWidget::createWindowContainer() to embed it in a widget
+  layout.
+
+  QuarterWindow shares the event filter, the interaction mode and the
+  navigation state machine setup with QuarterWidget. It does not
+  provide a context menu.
+
+  \code
+  QuarterWindow * window = new QuarterWindow;
+  window->setSceneGraph(root);
+  QWidget * container = QWidget::createWindowContainer(window, parent);
+  \endcode
+
+  This class is only available with Qt 5 or later.
+*/
+
+#include <assert.h>
+
+#include <Quarter/QuarterWindow.h>
+#include <Quarter/Quarter.h>
+
+#if QT_VERSION >= 0x050000
+
+#include <QCoreApplication>
+#include <QCursor>
+#include <QEvent>
+#include <QExposeEvent>
+#include <QGuiApplication>
+#include <QOpenGLContext>
+#include <QResizeEvent>
+#include <QScreen>
+
+#include <Inventor/SbColor4f.h>
+#include <Inventor/SbViewportRegion.h>
+#include <Inventor/SoDB.h>
+#include <Inventor/SoEventManager.h>
+#include <Inventor/SoRenderManager.h>
+#include <Inventor/actions/SoGLRenderAction.h>
+#include <Inventor/nodes/SoCamera.h>
+#include <Inventor/nodes/SoDirectionalLight.h>
+#include <Inventor/nodes/SoPerspectiveCamera.h>
+#include <Inventor/nodes/SoSeparator.h>
+#include <Inventor/scxml/SoScXMLStateMachine.h>
+#include <Inventor/sensors/SoSensorManager.h>
+#include <Inventor/system/gl.h>
+
+#include <Quarter/eventhandlers/EventFilter.h>
+
+#include "InteractionMode.h"
+#include "QuarterP.h"
+#include "QuarterWidgetP.h"
+#include "SensorProfiler.h"
+
+namespace SIM { namespace Coin3D { namespace Quarter {
+
+class QuarterWindowP {
+public:
+  QuarterWindowP(QuarterWindow * master) {
+    this->master = master;
+    this->context = NULL;
+    this->scene = NULL;
+    this->eventfilter = NULL;
+    this->interactionmode = NULL;
+    this->sorendermanager = NULL;
+    this->soeventmanager = NULL;
+    this->headlight = NULL;
+    this->cachecontext = NULL;
+    this->currentStateMachine = NULL;
+    this->autoredrawenabled = true;
+    this->processdelayqueue = true;
+    this->updatepending = false;
+    this->gpuaffinity = false;
+  }
+
+  bool createContext(void);
+  void releaseContext(void);
+
+  static void rendercb(void * userdata, SoRenderManager *);
+  static void prerendercb(void * userdata, SoRenderManager * manager);
+  static void postrendercb(void * userdata, SoRenderManager * manager);
+  static void statechangecb(void * userdata, ScXMLStateMachine * statemachine,
+                            const char * stateid, SbBool enter, SbBool success);
+
+  QuarterWindow * master;
+  QOpenGLContext * context;
+  SoNode * scene;
+  EventFilter * eventfilter;
+  InteractionMode * interactionmode;
+  SoRenderManager * sorendermanager;
+  SoEventManager * soeventmanager;
+  SoDirectionalLight * headlight;
+  QuarterWidgetP_cachecontext * cachecontext;
+  SoScXMLStateMachine * currentStateMachine;
+  QUrl navigationModeFile;
+  bool autoredrawenabled;
+  bool processdelayqueue;
+  bool updatepending;
+  bool gpuaffinity;
+};
+
+}}} // namespace
+
+#define PRIVATE(obj) obj->pimpl
+
+using namespace SIM::Coin3D::Quarter;
+
+/*
+  Creates the OpenGL context and makes it current. With GPU affinity,
+  the context is created for the screen the window is on, sharing
+  objects and the cache context with another window on that screen.
+ */
+bool
+QuarterWindowP::createContext(void)
+{
+  QOpenGLContext * context = new QOpenGLContext(this->master);
+  context->setFormat(this->master->requestedFormat());
+  QuarterWindow * sharewindow = NULL;
+  if (this->gpuaffinity) {
+    QScreen * screen = this->master->screen();
+    context->setScreen(screen);
+    const QList<QWindow *> windows = QGuiApplication::allWindows();
+    for (int i = 0; i < windows.size() && !sharewindow; i++) {
+      QuarterWindow * window = qobject_cast<QuarterWindow *>(windows[i]);
+      if (window && window != this->master && window->gpuAffinityEnabled() &&
+          window->context() && window->context()->screen() == screen) {
+        sharewindow = window;
+      }
+    }
+    if (sharewindow) {
+      context->setShareContext(sharewindow->context());
+    }
+  }
+  if (!context->create() || !context->makeCurrent(this->master)) {
+    delete context;
+    return false;
+  }
+  this->context = context;
+
+  if (sharewindow && QOpenGLContext::areSharing(context, sharewindow->context())) {
+    // nothing has been rendered with the window's own cache context
+    // yet, so there are no caches to release
+    if (QuarterWidgetP::removeFromCacheContext(this->cachecontext, this->master)) {
+      QuarterWidgetP::destructCacheContext(this->cachecontext);
+    }
+    this->cachecontext = QuarterWidgetP::findCacheContext(this->master, sharewindow);
+    this->sorendermanager->getGLRenderAction()->setCacheContext(
+      QuarterWidgetP::getCacheContextId(this->cachecontext));
+  }
+  return true;
+}
+
+/*
+  Destroys the OpenGL context, and the caches built in it if no other
+  window shares them. The window gets a cache context of its own, for
+  the next context to be created.
+ */
+void
+QuarterWindowP::releaseContext(void)
+{
+  if (!this->context) return;
+  const bool current = this->context->makeCurrent(this->master);
+  if (QuarterWidgetP::removeFromCacheContext(this->cachecontext, this->master)) {
+    QuarterWidgetP::destructCacheContext(this->cachecontext);
+  }
+  if (current) this->context->doneCurrent();
+  delete this->context;
+  this->context = NULL;
+
+  this->cachecontext = QuarterWidgetP::findCacheContext(this->master, NULL);
+  this->sorendermanager->getGLRenderAction()->setCacheContext(
+    QuarterWidgetP::getCacheContextId(this->cachecontext));
+}
+
+/*
+  Schedules a redraw when the scene graph changes, unless we are
+  rendering already.
+ */
+void
+QuarterWindowP::rendercb(void * userdata, SoRenderManager *)
+{
+  QuarterWindow * thisp = static_cast<QuarterWindow *>(userdata);
+  if (thisp->pimpl->autoredrawenabled) {
+    thisp->redraw();
+  }
+}
+
+void
+QuarterWindowP::prerendercb(void * userdata, SoRenderManager *)
+{
+  QuarterWindowP * thisp = static_cast<QuarterWindowP *>(userdata);
+  SoEventManager * evman = thisp->soeventmanager;
+  assert(evman);
+  for (int c = 0; c < evman->getNumSoScXMLStateMachines(); ++c) {
+    evman->getSoScXMLStateMachine(c)->preGLRender();
+  }
+}
+
+void
+QuarterWindowP::postrendercb(void * userdata, SoRenderManager *)
+{
+  QuarterWindowP * thisp = static_cast<QuarterWindowP *>(userdata);
+  SoEventManager * evman = thisp->soeventmanager;
+  assert(evman);
+  for (int c = 0; c < evman->getNumSoScXMLStateMachines(); ++c) {
+    evman->getSoScXMLStateMachine(c)->postGLRender();
+  }
+}
+
+void
+QuarterWindowP::statechangecb(void * userdata, ScXMLStateMachine *,
+                              const char * stateid, SbBool enter, SbBool)
+{
+  QuarterWindowP * thisp = static_cast<QuarterWindowP *>(userdata);
+  assert(thisp && thisp->master);
+  if (enter) {
+    SbName state(stateid);
+    if (QuarterP::statecursormap->contains(state)) {
+      thisp->master->setCursor(QuarterP::statecursormap->value(state));
+    }
+  }
+}
+
+/*!
+  Constructor. The window uses a default surface format with a 24 bit
+  depth buffer and an 8 bit stencil buffer.
+*/
+QuarterWindow::QuarterWindow(QWindow * parent)
+  : inherited(parent)
+{
+  QSurfaceFormat format;
+  format.setDepthBufferSize(24);
+  format.setStencilBufferSize(8);
+  this->constructor(format);
+}
+
+/*!
+  Constructor. The window is created with the surface \a format.
+*/
+QuarterWindow::QuarterWindow(const QSurfaceFormat & format, QWindow * parent)
+  : inherited(parent)
+{
+  this->constructor(format);
+}
+
+void
+QuarterWindow::constructor(const QSurfaceFormat & format)
+{
+  PRIVATE(this) = new QuarterWindowP(this);
+
+  this->setSurfaceType(QWindow::OpenGLSurface);
+  this->setFormat(format);
+
+  PRIVATE(this)->cachecontext = QuarterWidgetP::findCacheContext(this, NULL);
+
+  PRIVATE(this)->sorendermanager = new SoRenderManager;
+  PRIVATE(this)->soeventmanager = new SoEventManager;
+  SensorProfiler::renderManagerChanged(NULL, PRIVATE(this)->sorendermanager);
+
+  //Mind the order of initialization as the XML state machine uses
+  //callbacks which depends on other state being initialized
+  PRIVATE(this)->eventfilter = new EventFilter(this);
+  PRIVATE(this)->interactionmode = new InteractionMode(this);
+
+  PRIVATE(this)->headlight = new SoDirectionalLight;
+  PRIVATE(this)->headlight->ref();
+
+  PRIVATE(this)->sorendermanager->setAutoClipping(SoRenderManager::VARIABLE_NEAR_PLANE);
+  PRIVATE(this)->sorendermanager->setRenderCallback(QuarterWindowP::rendercb, this);
+  PRIVATE(this)->sorendermanager->setBackgroundColor(SbColor4f(0.0f, 0.0f, 0.0f, 0.0f));
+  PRIVATE(this)->sorendermanager->activate();
+  PRIVATE(this)->sorendermanager->addPreRenderCallback(QuarterWindowP::prerendercb, PRIVATE(this));
+  PRIVATE(this)->sorendermanager->addPostRenderCallback(QuarterWindowP::postrendercb, PRIVATE(this));
+  PRIVATE(this)->sorendermanager->getGLRenderAction()->setCacheContext(this->getCacheContextId());
+
+  PRIVATE(this)->soeventmanager->setNavigationState(SoEventManager::MIXED_NAVIGATION);
+
+  this->installEventFilter(PRIVATE(this)->eventfilter);
+  this->installEventFilter(PRIVATE(this)->interactionmode);
+
+  this->connect(this, SIGNAL(screenChanged(QScreen *)), this, SLOT(changeScreen(QScreen *)));
+}
+
+/*!
+  Destructor.
+*/
+QuarterWindow::~QuarterWindow()
+{
+  if (PRIVATE(this)->currentStateMachine) {
+    this->removeStateMachine(PRIVATE(this)->currentStateMachine);
+    QuarterWidgetP::releaseNavigationFile(PRIVATE(this)->currentStateMachine);
+  }
+  this->setSceneGraph(NULL);
+  PRIVATE(this)->headlight->unref();
+
+  bool current = PRIVATE(this)->context && PRIVATE(this)->context->makeCurrent(this);
+  SensorProfiler::renderManagerChanged(PRIVATE(this)->sorendermanager, NULL);
+  delete PRIVATE(this)->sorendermanager;
+  delete PRIVATE(this)->soeventmanager;
+  if (QuarterWidgetP::removeFromCacheContext(PRIVATE(this)->cachecontext, this) && current) {
+    QuarterWidgetP::destructCacheContext(PRIVATE(this)->cachecontext);
+  }
+  if (current) {
+    PRIVATE(this)->context->doneCurrent();
+  }
+
+  delete PRIVATE(this)->eventfilter;
+  delete PRIVATE(this)->context;
+  delete PRIVATE(this);
+}
+
+/*!
+  Set the background color of the window.
+*/
+void
+QuarterWindow::setBackgroundColor(const QColor & color)
+{
+  SbColor4f bgcolor(SbClamp(color.red()   / 255.0, 0.0, 1.0),
+                    SbClamp(color.green() / 255.0, 0.0, 1.0),
+                    SbClamp(color.blue()  / 255.0, 0.0, 1.0),
+                    SbClamp(color.alpha() / 255.0, 0.0, 1.0));
+
+  PRIVATE(this)->sorendermanager->setBackgroundColor(bgcolor);
+  PRIVATE(this)->sorendermanager->scheduleRedraw();
+}
+
+/*!
+  Returns the background color of the window.
+*/
+QColor
+QuarterWindow::backgroundColor(void) const
+{
+  SbColor4f bg = PRIVATE(this)->sorendermanager->getBackgroundColor();
+
+  return QColor(SbClamp(int(bg[0] * 255.0), 0, 255),
+                SbClamp(int(bg[1] * 255.0), 0, 255),
+                SbClamp(int(bg[2] * 255.0), 0, 255),
+                SbClamp(int(bg[3] * 255.0), 0, 255));
+}
+
+/*!
+  Removes any navigation mode file set.
+*/
+void
+QuarterWindow::resetNavigationModeFile(void)
+{
+  this->setNavigationModeFile(QUrl());
+}
+
+/*!
+  Sets the navigation mode file. See
+  QuarterWidget::setNavigationModeFile() for the supported schemes.
+*/
+void
+QuarterWindow::setNavigationModeFile(const QUrl & url)
+{
+  if (url.isEmpty()) {
+    if (PRIVATE(this)->currentStateMachine) {
+      this->removeStateMachine(PRIVATE(this)->currentStateMachine);
+      QuarterWidgetP::releaseNavigationFile(PRIVATE(this)->currentStateMachine);
+      PRIVATE(this)->currentStateMachine = NULL;
+      PRIVATE(this)->navigationModeFile = url;
+    }
+    return;
+  }
+
+  SoScXMLStateMachine * newsm = QuarterWidgetP::loadNavigationFile(url);
+  if (!newsm) {
+    return;
+  }
+
+  if (PRIVATE(this)->currentStateMachine) {
+    this->removeStateMachine(PRIVATE(this)->currentStateMachine);
+    QuarterWidgetP::releaseNavigationFile(PRIVATE(this)->currentStateMachine);
+  }
+  this->addStateMachine(newsm);
+  newsm->initialize();
+  PRIVATE(this)->currentStateMachine = newsm;
+  PRIVATE(this)->navigationModeFile = url;
+
+  if (QUrl(DEFAULT_NAVIGATIONFILE) == PRIVATE(this)->navigationModeFile) {
+    QuarterWidgetP::setDefaultStateCursors();
+  }
+}
+
+/*!
+  Returns the current navigation mode file.
+*/
+const QUrl &
+QuarterWindow::navigationModeFile(void) const
+{
+  return PRIVATE(this)->navigationModeFile;
+}
+
+/*!
+  Returns whether the headlight is turned on.
+*/
+bool
+QuarterWindow::headlightEnabled(void) const
+{
+  return PRIVATE(this)->headlight->on.getValue();
+}
+
+/*!
+  Enable/disable the headlight.
+*/
+void
+QuarterWindow::setHeadlightEnabled(bool onoff)
+{
+  PRIVATE(this)->headlight->on = onoff;
+}
+
+/*!
+  Returns the headlight of the window.
+*/
+SoDirectionalLight *
+QuarterWindow::getHeadlight(void)
+{
+  return PRIVATE(this)->headlight;
+}
+
+/*!
+  Returns whether the interaction mode is enabled.
+*/
+bool
+QuarterWindow::interactionModeEnabled(void) const
+{
+  return PRIVATE(this)->interactionmode->enabled();
+}
+
+/*!
+  Enable/disable interaction mode, see
+  QuarterWidget::setInteractionModeEnabled().
+*/
+void
+QuarterWindow::setInteractionModeEnabled(bool onoff)
+{
+  PRIVATE(this)->interactionmode->setEnabled(onoff);
+}
+
+/*!
+  Returns true if the OpenGL context follows the screen the window is
+  on.
+
+  \sa setGpuAffinityEnabled()
+*/
+bool
+QuarterWindow::gpuAffinityEnabled(void) const
+{
+  return PRIVATE(this)->gpuaffinity;
+}
+
+/*!
+  Makes the window render on the GPU that drives its screen, on
+  workstations with one display per graphics card. The OpenGL context
+  is then created for the screen the window is on, and shares objects
+  and Coin's caches only with the other windows on that screen that
+  have GPU affinity enabled, so each GPU keeps a cache context of its
+  own. When the window is moved to another screen, its context and
+  caches are released and a new context is created for the new
+  screen, joining the share group there. Without affinity, the
+  platform picks the device, and frames may be copied between the
+  cards. The default is off.
+
+  Which device a context ends up on is up to the platform's OpenGL
+  driver; on systems where all screens are driven by the same GPU
+  this only changes how the caches are shared.
+*/
+void
+QuarterWindow::setGpuAffinityEnabled(bool onoff)
+{
+  if (PRIVATE(this)->gpuaffinity == onoff) return;
+  PRIVATE(this)->gpuaffinity = onoff;
+  // the context was created with the old setting
+  if (PRIVATE(this)->context) {
+    PRIVATE(this)->releaseContext();
+    this->redraw();
+  }
+}
+
+void
+QuarterWindow::changeScreen(QScreen * screen)
+{
+  if (!PRIVATE(this)->gpuaffinity || !PRIVATE(this)->context) return;
+  if (PRIVATE(this)->context->screen() == screen) return;
+  PRIVATE(this)->releaseContext();
+  this->redraw();
+}
+
+/*!
+  Returns the OpenGL context of the window, or NULL if the window has
+  not been exposed yet.
+*/
+QOpenGLContext *
+QuarterWindow::context(void) const
+{
+  return PRIVATE(this)->context;
+}
+
+/*!
+  Returns the Coin cache context id for this window.
+*/
+uint32_t
+QuarterWindow::getCacheContextId(void) const
+{
+  return QuarterWidgetP::getCacheContextId(PRIVATE(this)->cachecontext);
+}
+
+/*!
+  Sets the scene graph to be rendered. A camera and a headlight are
+  added if the scene does not contain a camera.
+*/
+void
+QuarterWindow::setSceneGraph(SoNode * node)
+{
+  if (node == PRIVATE(this)->scene) {
+    return;
+  }
+
+  if (PRIVATE(this)->scene) {
+    PRIVATE(this)->scene->unref();
+    PRIVATE(this)->scene = NULL;
+  }
+
+  SoCamera * camera = NULL;
+  SoSeparator * superscene = NULL;
+  bool viewall = false;
+
+  if (node) {
+    PRIVATE(this)->scene = node;
+    PRIVATE(this)->scene->ref();
+
+    superscene = new SoSeparator;
+    superscene->addChild(PRIVATE(this)->headlight);
+
+    // if the scene does not contain a camera, add one
+    if (!(camera = QuarterWidgetP::searchForCamera(node))) {
+      camera = new SoPerspectiveCamera;
+      superscene->addChild(camera);
+      viewall = true;
+    }
+
+    superscene->addChild(node);
+  }
+
+  PRIVATE(this)->soeventmanager->setCamera(camera);
+  PRIVATE(this)->sorendermanager->setCamera(camera);
+  PRIVATE(this)->soeventmanager->setSceneGraph(superscene);
+  PRIVATE(this)->sorendermanager->setSceneGraph(superscene);
+
+  if (viewall) { this->viewAll(); }
+  if (superscene) { superscene->touch(); }
+}
+
+/*!
+  Returns the scene graph set with setSceneGraph().
+*/
+SoNode *
+QuarterWindow::getSceneGraph(void) const
+{
+  return PRIVATE(this)->scene;
+}
+
+/*!
+  Returns the event manager of the window.
+*/
+SoEventManager *
+QuarterWindow::getSoEventManager(void) const
+{
+  return PRIVATE(this)->soeventmanager;
+}
+
+/*!
+  Returns the render manager of the window.
+*/
+SoRenderManager *
+QuarterWindow::getSoRenderManager(void) const
+{
+  return PRIVATE(this)->sorendermanager;
+}
+
+/*!
+  Returns the event filter of the window.
+*/
+EventFilter *
+QuarterWindow::getEventFilter(void) const
+{
+  return PRIVATE(this)->eventfilter;
+}
+
+/*!
+  Adds a state machine to the window's event manager.
+*/
+void
+QuarterWindow::addStateMachine(SoScXMLStateMachine * statemachine)
+{
+  SoEventManager * em = this->getSoEventManager();
+  em->addSoScXMLStateMachine(statemachine);
+  statemachine->setSceneGraphRoot(this->getSoRenderManager()->getSceneGraph());
+  statemachine->setActiveCamera(this->getSoRenderManager()->getCamera());
+  statemachine->addStateChangeCallback(QuarterWindowP::statechangecb, PRIVATE(this));
+}
+
+/*!
+  Removes a state machine from the window's event manager.
+*/
+void
+QuarterWindow::removeStateMachine(SoScXMLStateMachine * statemachine)
+{
+  SoEventManager * em = this->getSoEventManager();
+  statemachine->setSceneGraphRoot(NULL);
+  statemachine->setActiveCamera(NULL);
+  em->removeSoScXMLStateMachine(statemachine);
+}
+
+/*!
+  Passes an SoEvent to the event manager.
+*/
+bool
+QuarterWindow::processSoEvent(const SoEvent * event)
+{
+  return
+    event &&
+    PRIVATE(this)->soeventmanager &&
+    PRIVATE(this)->soeventmanager->processEvent(event);
+}
+
+/*!
+  Views the entire scene.
+*/
+void
+QuarterWindow::viewAll(void)
+{
+  const SbName viewallevent("sim.coin3d.coin.navigation.ViewAll");
+  for (int c = 0; c < PRIVATE(this)->soeventmanager->getNumSoScXMLStateMachines(); ++c) {
+    SoScXMLStateMachine * sostatemachine =
+      PRIVATE(this)->soeventmanager->getSoScXMLStateMachine(c);
+    if (sostatemachine->isActive()) {
+      sostatemachine->queueEvent(viewallevent);
+      sostatemachine->processEventQueue();
+    }
+  }
+}
+
+/*!
+  Sets the window in seek mode.
+*/
+void
+QuarterWindow::seek(void)
+{
+  const SbName seekevent("sim.coin3d.coin.navigation.Seek");
+  for (int c = 0; c < PRIVATE(this)->soeventmanager->getNumSoScXMLStateMachines(); ++c) {
+    SoScXMLStateMachine * sostatemachine =
+      PRIVATE(this)->soeventmanager->getSoScXMLStateMachine(c);
+    if (sostatemachine->isActive()) {
+      sostatemachine->queueEvent(seekevent);
+      sostatemachine->processEventQueue();
+    }
+  }
+}
+
+/*!
+  Schedules a redraw. Requests are merged until the window system
+  delivers the next update request.
+*/
+void
+QuarterWindow::redraw(void)
+{
+  // we're triggering the next paintGL(). Set a flag to remember this
+  // to avoid that we process the delay queue in paintGL()
+  PRIVATE(this)->processdelayqueue = false;
+  if (PRIVATE(this)->updatepending) return;
+  PRIVATE(this)->updatepending = true;
+#if QT_VERSION >= 0x050500
+  this->requestUpdate();
+#else
+  QCoreApplication::postEvent(this, new QEvent(QEvent::UpdateRequest));
+#endif
+}
+
+/*!
+  \reimp
+*/
+bool
+QuarterWindow::event(QEvent * event)
+{
+  if (event->type() == QEvent::UpdateRequest) {
+    PRIVATE(this)->updatepending = false;
+    if (this->isExposed()) {
+      this->paintGL();
+    }
+    return true;
+  }
+  return inherited::event(event);
+}
+
+/*!
+  \reimp
+*/
+void
+QuarterWindow::exposeEvent(QExposeEvent *)
+{
+  if (this->isExposed()) {
+    this->paintGL();
+  }
+}
+
+/*!
+  \reimp
+*/
+void
+QuarterWindow::resizeEvent(QResizeEvent * event)
+{
+  const qreal ratio = this->devicePixelRatio();
+  SbViewportRegion vp(int(event->size().width() * ratio),
+                      int(event->size().height() * ratio));
+  PRIVATE(this)->sorendermanager->setViewportRegion(vp);
+  PRIVATE(this)->soeventmanager->setViewportRegion(vp);
+}
+
+/*!
+  Called once the OpenGL context has been created and made current.
+*/
+void
+QuarterWindow::initializeGL(void)
+{
+  Quarter::completeInit();
+  glEnable(GL_DEPTH_TEST);
+  this->getSoRenderManager()->reinitialize();
+}
+
+/*!
+  Renders the scene into the back buffer of the window and swaps it.
+*/
+void
+QuarterWindow::paintGL(void)
+{
+  if (!PRIVATE(this)->context) {
+    if (!PRIVATE(this)->createContext()) return;
+    this->initializeGL();
+  }
+  else if (!PRIVATE(this)->context->makeCurrent(this)) {
+    return;
+  }
+
+  // the device pixel ratio may have changed if the window was moved
+  // to another screen
+  const qreal ratio = this->devicePixelRatio();
+  const SbVec2s size(short(this->width() * ratio), short(this->height() * ratio));
+  if (PRIVATE(this)->sorendermanager->getViewportRegion().getWindowSize() != size) {
+    SbViewportRegion vp(size);
+    PRIVATE(this)->sorendermanager->getGLRenderAction()->setViewportRegion(vp);
+    PRIVATE(this)->soeventmanager->setViewportRegion(vp);
+  }
+
+  // See QuarterWidget::paintGL() for why the delay queue is
+  // processed here
+  PRIVATE(this)->autoredrawenabled = false;
+  const bool latched = PRIVATE(this)->eventfilter->latchPendingEvent();
+  if ((PRIVATE(this)->processdelayqueue || latched) &&
+      SoDB::getSensorManager()->isDelaySensorPending()) {
+    PRIVATE(this)->context->doneCurrent();
+    SensorProfiler::processDelayQueue(FALSE);
+    PRIVATE(this)->context->makeCurrent(this);
+  }
+
+  this->actualRedraw();
+  PRIVATE(this)->autoredrawenabled = true;
+  PRIVATE(this)->processdelayqueue = true;
+
+  PRIVATE(this)->context->swapBuffers(this);
+}
+
+/*!
+  Renders the scene. Override this to render something else.
+*/
+void
+QuarterWindow::actualRedraw(void)
+{
+  PRIVATE(this)->sorendermanager->render(TRUE, TRUE);
+}
+
+#endif // QT_VERSION >= 0x050000
+
+#undef PRIVATE
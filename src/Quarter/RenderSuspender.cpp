@@ -0,0 +1,256 @@
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+/*
+  Stops a QuarterWidget from rendering while it cannot be seen, e.g.
+  when it is in a background tab, a minimized QMdiSubWindow or a
+  collapsed dock widget, or when its window is minimized.
+
+  While suspended, the render manager is deactivated so that changes
+  in the scene graph do not schedule redraws. Optionally, nodes that
+  animate themselves from the realTime field are paused as well, so
+  they do not keep the sensor queues busy. A single frame is rendered
+  when the widget becomes visible again.
+ */
+
+#include "RenderSuspender.h"
+
+#include <QtCore/QEvent>
+#include <QWidget>
+
+#include <Inventor/SoRenderManager.h>
+#include <Inventor/SoPath.h>
+#include <Inventor/actions/SoSearchAction.h>
+#include <Inventor/fields/SoSFBool.h>
+#include <Inventor/lists/SoPathList.h>
+#include <Inventor/nodes/SoBlinker.h>
+#include <Inventor/nodes/SoPendulum.h>
+#include <Inventor/nodes/SoRotor.h>
+#include <Inventor/nodes/SoShuttle.h>
+
+#include <Quarter/QuarterWidget.h>
+
+using namespace SIM::Coin3D::Quarter;
+
+RenderSuspender::RenderSuspender(QuarterWidget * quarterwidget)
+  : QObject(quarterwidget)
+{
+  this->quarterwidget = quarterwidget;
+  this->isenabled = false;
+  this->pauseanimations = false;
+  this->issuspended = false;
+  this->ishidden = false;
+
+  quarterwidget->installEventFilter(this);
+}
+
+RenderSuspender::~RenderSuspender()
+{
+  this->unpause();
+}
+
+void
+RenderSuspender::setEnabled(bool yes)
+{
+  this->isenabled = yes;
+  this->update();
+}
+
+bool
+RenderSuspender::enabled(void) const
+{
+  return this->isenabled;
+}
+
+void
+RenderSuspender::setPauseAnimations(bool yes)
+{
+  this->pauseanimations = yes;
+  if (this->issuspended) {
+    if (yes) {
+      this->pause();
+    } else {
+      this->unpause();
+    }
+  }
+}
+
+bool
+RenderSuspender::pauseAnimations(void) const
+{
+  return this->pauseanimations;
+}
+
+bool
+RenderSuspender::suspended(void) const
+{
+  return this->issuspended;
+}
+
+/*
+  Called before QuarterWidget replaces its render manager, which must
+  not be left deactivated.
+ */
+void
+RenderSuspender::renderManagerChanged(SoRenderManager * oldmanager,
+                                      SoRenderManager * newmanager)
+{
+  if (!this->issuspended) return;
+  if (oldmanager) oldmanager->activate();
+  if (newmanager) newmanager->deactivate();
+}
+
+bool
+RenderSuspender::eventFilter(QObject * obj, QEvent * event)
+{
+  if (obj == this->quarterwidget) {
+    switch (event->type()) {
+    case QEvent::Show:
+      this->ishidden = false;
+      this->trackWindow();
+      this->update();
+      break;
+    case QEvent::Hide:
+      this->ishidden = true;
+      this->update();
+      break;
+    case QEvent::ParentChange:
+      this->trackWindow();
+      break;
+    default:
+      break;
+    }
+  }
+  else if (obj == this->window && event->type() == QEvent::WindowStateChange) {
+    this->update();
+  }
+  return false;
+}
+
+void
+RenderSuspender::trackWindow(void)
+{
+  QWidget * window = this->quarterwidget->window();
+  if (window == this->window) return;
+
+  if (this->window) {
+    this->window->removeEventFilter(this);
+  }
+  this->window = window;
+  if (window && window != this->quarterwidget) {
+    window->installEventFilter(this);
+  }
+}
+
+void
+RenderSuspender::update(void)
+{
+  bool minimized = this->window && this->window->isMinimized();
+  bool suspend = this->isenabled && (this->ishidden || minimized);
+  if (suspend == this->issuspended) return;
+
+  if (suspend) {
+    this->suspend();
+  } else {
+    this->resume();
+  }
+}
+
+void
+RenderSuspender::suspend(void)
+{
+  this->issuspended = true;
+  SoRenderManager * manager = this->quarterwidget->getSoRenderManager();
+  if (manager) manager->deactivate();
+  if (this->pauseanimations) {
+    this->pause();
+  }
+}
+
+void
+RenderSuspender::resume(void)
+{
+  this->issuspended = false;
+  this->unpause();
+  SoRenderManager * manager = this->quarterwidget->getSoRenderManager();
+  if (manager) manager->activate();
+  // catch up on whatever changed while we were suspended
+  this->quarterwidget->redraw();
+}
+
+/*
+  Turns off the nodes under the scene graph which animate themselves
+  from the realTime global field.
+ */
+void
+RenderSuspender::pause(void)
+{
+  SoRenderManager * manager = this->quarterwidget->getSoRenderManager();
+  SoNode * root = manager ? manager->getSceneGraph() : NULL;
+  if (!root || !this->pausednodes.isEmpty()) return;
+
+  const SoType types[] = {
+    SoRotor::getClassTypeId(),
+    SoPendulum::getClassTypeId(),
+    SoShuttle::getClassTypeId(),
+    SoBlinker::getClassTypeId()
+  };
+
+  SoSearchAction sa;
+  sa.setInterest(SoSearchAction::ALL);
+  sa.setSearchingAll(TRUE);
+  for (unsigned int i = 0; i < sizeof(types) / sizeof(types[0]); i++) {
+    sa.setType(types[i]);
+    sa.apply(root);
+    const SoPathList & paths = sa.getPaths();
+    for (int j = 0; j < paths.getLength(); j++) {
+      SoNode * node = paths[j]->getTail();
+      SoSFBool * on = static_cast<SoSFBool *>(node->getField("on"));
+      if (!on || !on->getValue()) continue;
+
+      node->ref();
+      on->setValue(FALSE);
+      this->pausednodes.append(node);
+    }
+    sa.reset();
+  }
+}
+
+void
+RenderSuspender::unpause(void)
+{
+  foreach(SoNode * node, this->pausednodes) {
+    static_cast<SoSFBool *>(node->getField("on"))->setValue(TRUE);
+    node->unref();
+  }
+  this->pausednodes.clear();
+}
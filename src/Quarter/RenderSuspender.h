@@ -0,0 +1,84 @@
+#ifndef QUARTER_RENDERSUSPENDER_H
+#define QUARTER_RENDERSUSPENDER_H
+
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+#include <QtCore/QObject>
+#include <QtCore/QList>
+#include <QtCore/QPointer>
+
+class QWidget;
+class SoNode;
+class SoRenderManager;
+
+namespace SIM { namespace Coin3D { namespace Quarter {
+
+class QuarterWidget;
+
+class RenderSuspender : public QObject {
+  Q_OBJECT
+public:
+  RenderSuspender(QuarterWidget * quarterwidget);
+  ~RenderSuspender();
+
+  void setEnabled(bool yes);
+  bool enabled(void) const;
+
+  void setPauseAnimations(bool yes);
+  bool pauseAnimations(void) const;
+
+  bool suspended(void) const;
+  void renderManagerChanged(SoRenderManager * oldmanager, SoRenderManager * newmanager);
+
+  virtual bool eventFilter(QObject * obj, QEvent * event);
+
+private:
+  void trackWindow(void);
+  void update(void);
+  void suspend(void);
+  void resume(void);
+  void pause(void);
+  void unpause(void);
+
+  QuarterWidget * quarterwidget;
+  QPointer<QWidget> window;
+  bool isenabled;
+  bool pauseanimations;
+  bool issuspended;
+  bool ishidden;
+  QList<SoNode *> pausednodes;
+};
+
+}}} // namespace
+
+#endif // QUARTER_RENDERSUSPENDER_H
@@ -0,0 +1,349 @@
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+/*
+  Renders the scene of a QuarterWidget on a thread of its own, so that
+  a slow frame does not block the GUI thread. The thread has an OpenGL
+  context sharing objects with the widget's context, and renders the
+  widget's SoRenderManager into one of three framebuffer objects,
+  while holding SoDB::readlock(). When a frame is done, the widget is
+  asked to update, and its paintGL() only draws the texture of the
+  newest frame. The GUI thread keeps translating input and running
+  sensors, and holds the write lock while it does, see lockScene().
+
+  With three buffers, the one being rendered into is neither the
+  newest frame nor the one the widget drew last, so the two contexts
+  never use the same texture at once.
+ */
+
+#include "RenderThread.h"
+
+#include <QtCore/QAtomicInt>
+#include <QtCore/QCoreApplication>
+#include <QtCore/QMetaObject>
+
+#include <Inventor/C/basic.h>
+#include <Inventor/SbViewportRegion.h>
+#include <Inventor/SoDB.h>
+#include <Inventor/SoRenderManager.h>
+#include <Inventor/errors/SoDebugError.h>
+#include <Inventor/nodes/SoCamera.h>
+#include <Inventor/system/gl.h>
+
+#include <Quarter/QuarterWidget.h>
+
+#if QT_VERSION >= 0x050000
+#include <QOffscreenSurface>
+#include <QOpenGLContext>
+#include <QOpenGLFramebufferObject>
+#endif
+
+using namespace SIM::Coin3D::Quarter;
+
+// render threads currently running, across all widgets
+static QAtomicInt runningthreads;
+
+// the write lock held by the GUI thread, see lockScene()
+static int lockdepth = 0;
+static int lockeddepth = -1;
+
+RenderThread::RenderThread(QuarterWidget * quarterwidget)
+{
+  this->quarterwidget = quarterwidget;
+  this->context = NULL;
+  this->surface = NULL;
+  this->quit = false;
+  this->framerequested = false;
+  this->clearwindow = true;
+  this->clearzbuffer = true;
+  this->ready = -1;
+  this->presented = -1;
+  for (int i = 0; i < NUM_BUFFERS; i++) {
+    this->fbo[i] = NULL;
+    this->texture[i] = 0;
+  }
+}
+
+RenderThread::~RenderThread()
+{
+  this->end();
+}
+
+/*
+  Starts the thread, rendering with a context that shares objects
+  with \a sharecontext, the widget's context. Returns false if that
+  is not possible, in which case the widget renders as usual.
+ */
+bool
+RenderThread::begin(QOpenGLContext * sharecontext)
+{
+#if QT_VERSION >= 0x050000 && defined(COIN_THREADSAFE)
+  if (this->isRunning() || !sharecontext) return false;
+
+  this->context = new QOpenGLContext;
+  this->context->setFormat(sharecontext->format());
+  this->context->setShareContext(sharecontext);
+  if (!this->context->create() ||
+      !QOpenGLContext::areSharing(this->context, sharecontext)) {
+    SoDebugError::postWarning("QuarterWidget::setRenderThreadEnabled",
+                              "Could not create an OpenGL context sharing objects "
+                              "with the widget, rendering on the GUI thread.");
+    delete this->context;
+    this->context = NULL;
+    return false;
+  }
+  // has to be created on the GUI thread
+  this->surface = new QOffscreenSurface;
+  this->surface->setFormat(this->context->format());
+  this->surface->create();
+  this->context->moveToThread(this);
+
+  this->quit = false;
+  this->framerequested = true;
+  this->ready = -1;
+  this->presented = -1;
+  runningthreads.ref();
+  this->start();
+  return true;
+#else
+  Q_UNUSED(sharecontext);
+  // rendering under SoDB::readlock() needs a thread safe Coin
+  SoDebugError::postWarning("QuarterWidget::setRenderThreadEnabled",
+                            "Rendering on a thread of its own needs Qt 5 and a "
+                            "thread safe Coin, rendering on the GUI thread.");
+  return false;
+#endif
+}
+
+/*
+  Stops the thread after the frame it is rendering, and releases its
+  context.
+ */
+void
+RenderThread::end(void)
+{
+#if QT_VERSION >= 0x050000
+  if (!this->context) return;
+  {
+    QMutexLocker locker(&this->mutex);
+    this->quit = true;
+    this->wakeup.wakeAll();
+  }
+  // the frame in progress may be waiting for the read lock
+  const bool locked = lockeddepth >= 0;
+  if (locked) SoDB::writeunlock();
+  this->wait();
+  if (locked) SoDB::writelock();
+  runningthreads.deref();
+
+  delete this->context;
+  this->context = NULL;
+  delete this->surface;
+  this->surface = NULL;
+  this->ready = -1;
+  this->presented = -1;
+#endif
+}
+
+/*
+  Asks for a new frame. Requests made while a frame is being rendered
+  are merged into one.
+ */
+void
+RenderThread::requestFrame(bool clearwindow, bool clearzbuffer)
+{
+  QMutexLocker locker(&this->mutex);
+  this->framerequested = true;
+  this->clearwindow = clearwindow;
+  this->clearzbuffer = clearzbuffer;
+  this->wakeup.wakeAll();
+}
+
+/*
+  Draws the newest frame into the widget, stretched to the widget's
+  viewport if the widget has been resized since it was rendered. Must
+  be called with the widget's context current. Returns false if no
+  frame has been rendered yet.
+ */
+bool
+RenderThread::present(void)
+{
+  GLuint tex;
+  {
+    QMutexLocker locker(&this->mutex);
+    if (this->ready < 0) return false;
+    this->presented = this->ready;
+    tex = this->texture[this->presented];
+  }
+
+  const SbVec2s size =
+    this->quarterwidget->getSoRenderManager()->getViewportRegion().getWindowSize();
+  glPushAttrib(GL_ALL_ATTRIB_BITS);
+  glViewport(0, 0, size[0], size[1]);
+  glMatrixMode(GL_PROJECTION);
+  glPushMatrix();
+  glLoadIdentity();
+  glMatrixMode(GL_MODELVIEW);
+  glPushMatrix();
+  glLoadIdentity();
+  glDisable(GL_DEPTH_TEST);
+  glDisable(GL_LIGHTING);
+  glDisable(GL_BLEND);
+  glEnable(GL_TEXTURE_2D);
+  glBindTexture(GL_TEXTURE_2D, tex);
+  glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_REPLACE);
+  glBegin(GL_QUADS);
+  glTexCoord2f(0.0f, 0.0f); glVertex2f(-1.0f, -1.0f);
+  glTexCoord2f(1.0f, 0.0f); glVertex2f(1.0f, -1.0f);
+  glTexCoord2f(1.0f, 1.0f); glVertex2f(1.0f, 1.0f);
+  glTexCoord2f(0.0f, 1.0f); glVertex2f(-1.0f, 1.0f);
+  glEnd();
+  glBindTexture(GL_TEXTURE_2D, 0);
+  glPopMatrix();
+  glMatrixMode(GL_PROJECTION);
+  glPopMatrix();
+  glMatrixMode(GL_MODELVIEW);
+  glPopAttrib();
+  return true;
+}
+
+void
+RenderThread::run(void)
+{
+#if QT_VERSION >= 0x050000
+  this->context->makeCurrent(this->surface);
+
+  QMutexLocker locker(&this->mutex);
+  for (;;) {
+    while (!this->quit && !this->framerequested) {
+      this->wakeup.wait(&this->mutex);
+    }
+    if (this->quit) break;
+    this->framerequested = false;
+    const bool clearwindow = this->clearwindow;
+    const bool clearzbuffer = this->clearzbuffer;
+    int index = 0;
+    while (index == this->ready || index == this->presented) index++;
+    locker.unlock();
+
+    this->renderFrame(index, clearwindow, clearzbuffer);
+
+    locker.relock();
+    if (this->fbo[index]) {
+      this->texture[index] = this->fbo[index]->texture();
+      this->ready = index;
+      QMetaObject::invokeMethod(this->quarterwidget, "update", Qt::QueuedConnection);
+    }
+  }
+  locker.unlock();
+
+  for (int i = 0; i < NUM_BUFFERS; i++) {
+    delete this->fbo[i];
+    this->fbo[i] = NULL;
+  }
+  this->context->doneCurrent();
+  // end() deletes it on the GUI thread
+  this->context->moveToThread(QCoreApplication::instance()->thread());
+#endif
+}
+
+void
+RenderThread::renderFrame(int index, bool clearwindow, bool clearzbuffer)
+{
+#if QT_VERSION >= 0x050000
+  SoRenderManager * manager = this->quarterwidget->getSoRenderManager();
+  SoDB::readlock();
+  const SbVec2s size = manager->getViewportRegion().getWindowSize();
+  if (size[0] <= 0 || size[1] <= 0) {
+    SoDB::readunlock();
+    return;
+  }
+  const QSize fbosize(size[0], size[1]);
+  if (!this->fbo[index] || this->fbo[index]->size() != fbosize) {
+    delete this->fbo[index];
+    this->fbo[index] =
+      new QOpenGLFramebufferObject(fbosize, QOpenGLFramebufferObject::CombinedDepthStencil);
+  }
+  this->fbo[index]->bind();
+  // auto clipping writes the near and far planes of the camera. Keep
+  // those writes from notifying the GUI thread's sensors from here.
+  SoCamera * camera = manager->getCamera();
+  SbBool notify = FALSE;
+  if (camera) notify = camera->enableNotify(FALSE);
+  manager->render(clearwindow ? TRUE : FALSE, clearzbuffer ? TRUE : FALSE);
+  if (camera) camera->enableNotify(notify);
+  SoDB::readunlock();
+  this->fbo[index]->release();
+  // the widget's context samples the texture next
+  glFinish();
+#else
+  Q_UNUSED(index);
+  Q_UNUSED(clearwindow);
+  Q_UNUSED(clearzbuffer);
+#endif
+}
+
+/*
+  Returns the number of render threads running, for all widgets.
+ */
+int
+RenderThread::numRunning(void)
+{
+  return runningthreads.fetchAndAddRelaxed(0);
+}
+
+/*
+  Takes SoDB::writelock() on the GUI thread while it changes scene
+  graphs, so that render threads do not traverse them meanwhile. The
+  lock is only taken while render threads are running, unless \a
+  always is set. Calls nest; the lock is released by the
+  unlockScene() matching the call that took it. GUI thread only.
+ */
+void
+RenderThread::lockScene(bool always)
+{
+  if (lockeddepth < 0 && (always || RenderThread::numRunning() > 0)) {
+    SoDB::writelock();
+    lockeddepth = lockdepth;
+  }
+  lockdepth++;
+}
+
+void
+RenderThread::unlockScene(void)
+{
+  lockdepth--;
+  if (lockeddepth == lockdepth) {
+    lockeddepth = -1;
+    SoDB::writeunlock();
+  }
+}
@@ -0,0 +1,93 @@
+#ifndef QUARTER_RENDERTHREAD_H
+#define QUARTER_RENDERTHREAD_H
+
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+#include <QtCore/QMutex>
+#include <QtCore/QThread>
+#include <QtCore/QWaitCondition>
+#include <Inventor/SbVec2s.h>
+
+class QOpenGLContext;
+class QOffscreenSurface;
+class QOpenGLFramebufferObject;
+
+namespace SIM { namespace Coin3D { namespace Quarter {
+
+class QuarterWidget;
+
+class RenderThread : public QThread {
+public:
+  RenderThread(QuarterWidget * quarterwidget);
+  ~RenderThread();
+
+  bool begin(QOpenGLContext * sharecontext);
+  void end(void);
+
+  void requestFrame(bool clearwindow, bool clearzbuffer);
+  bool present(void);
+
+  static int numRunning(void);
+  static void lockScene(bool always = false);
+  static void unlockScene(void);
+
+protected:
+  virtual void run(void);
+
+private:
+  void renderFrame(int index, bool clearwindow, bool clearzbuffer);
+
+  enum { NUM_BUFFERS = 3 };
+
+  QuarterWidget * quarterwidget;
+  QOpenGLContext * context;
+  QOffscreenSurface * surface;
+  QOpenGLFramebufferObject * fbo[NUM_BUFFERS];
+
+  QMutex mutex;
+  QWaitCondition wakeup;
+  bool quit;
+  bool framerequested;
+  bool clearwindow;
+  bool clearzbuffer;
+  // the last finished frame, and the one last shown by the widget
+  int ready;
+  int presented;
+  // the texture and size of each buffer, read by the GUI thread
+  unsigned int texture[NUM_BUFFERS];
+  SbVec2s size[NUM_BUFFERS];
+};
+
+}}} // namespace
+
+#endif // QUARTER_RENDERTHREAD_H
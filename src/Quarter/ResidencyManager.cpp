@@ -0,0 +1,314 @@
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+/*
+  Keeps track of the approximate amount of GPU memory used by the
+  scenes shown in a group of QuarterWidgets sharing a cache context,
+  and releases the GL resources of the group once all of its widgets
+  have been hidden for a while.
+
+  The estimates are based on the texture images and the number of
+  primitives in the scene graphs, and are only recalculated when a
+  scene graph has changed since the last query.
+ */
+
+#include "ResidencyManager.h"
+
+#include <QtCore/QEvent>
+#include <QtCore/QSet>
+#include <QtCore/QTimer>
+
+#include <Inventor/SbBasic.h>
+#include <Inventor/SbViewportRegion.h>
+#include <Inventor/SoRenderManager.h>
+#include <Inventor/actions/SoCallbackAction.h>
+#include <Inventor/actions/SoGetPrimitiveCountAction.h>
+#include <Inventor/misc/SoContextHandler.h>
+#include <Inventor/nodes/SoNode.h>
+#include <Inventor/nodes/SoTexture2.h>
+#include <Inventor/nodes/SoTexture3.h>
+#include <Inventor/C/glue/gl.h>
+
+#include <Quarter/QuarterWidget.h>
+
+#include "QuarterWidgetP.h"
+
+using namespace SIM::Coin3D::Quarter;
+
+QList<ResidencyManager *> * ResidencyManager::managers = NULL;
+
+// bytes per cached vertex: position, normal and texture coordinate
+static const size_t VERTEX_SIZE = 8 * sizeof(float);
+
+struct TextureEstimate {
+  QSet<const SoNode *> visited;
+  size_t bytes;
+};
+
+static SoCallbackAction::Response
+texture_cb(void * userdata, SoCallbackAction *, const SoNode * node)
+{
+  TextureEstimate * estimate = static_cast<TextureEstimate *>(userdata);
+  // a texture node used at several places in the scene is only
+  // uploaded once
+  if (estimate->visited.contains(node)) {
+    return SoCallbackAction::CONTINUE;
+  }
+  estimate->visited.insert(node);
+
+  size_t bytes = 0;
+  int nc = 0;
+  if (node->isOfType(SoTexture2::getClassTypeId())) {
+    SbVec2s size;
+    static_cast<const SoTexture2 *>(node)->image.getValue(size, nc);
+    bytes = size_t(size[0]) * size_t(size[1]) * size_t(nc);
+  }
+  else if (node->isOfType(SoTexture3::getClassTypeId())) {
+    SbVec3s size;
+    static_cast<const SoTexture3 *>(node)->images.getValue(size, nc);
+    bytes = size_t(size[0]) * size_t(size[1]) * size_t(size[2]) * size_t(nc);
+  }
+  // add a third for the mipmap levels
+  estimate->bytes += bytes + bytes / 3;
+  return SoCallbackAction::CONTINUE;
+}
+
+ResidencyManager::ResidencyManager(QuarterWidget * quarterwidget)
+  : QObject(quarterwidget)
+{
+  this->quarterwidget = quarterwidget;
+  this->evictiondelay = 0.0;
+  this->hidden = false;
+  this->evicted = false;
+  this->estimatedscene = NULL;
+  this->estimatednodeid = 0;
+  this->texturebytes = 0;
+  this->cachebytes = 0;
+
+  this->timer = new QTimer(this);
+  this->timer->setSingleShot(true);
+#if (QT_VERSION >= 0x050000)
+  this->timer->setTimerType(Qt::PreciseTimer);
+#endif
+  this->connect(this->timer, SIGNAL(timeout(void)), this, SLOT(evict()));
+
+  if (ResidencyManager::managers == NULL) {
+    // FIXME: static memory leak
+    ResidencyManager::managers = new QList<ResidencyManager *>;
+  }
+  ResidencyManager::managers->append(this);
+
+  quarterwidget->installEventFilter(this);
+}
+
+ResidencyManager::~ResidencyManager()
+{
+  ResidencyManager::managers->removeAll(this);
+}
+
+/*
+  Sets the time a widget must have been hidden before the render
+  caches of its share group are released. 0 disables eviction.
+ */
+void
+ResidencyManager::setEvictionDelay(double sec)
+{
+  this->evictiondelay = sec;
+  this->timer->stop();
+  if (this->hidden && sec > 0.0) {
+    double remaining = sec - (SbTime::getTimeOfDay() - this->hiddensince).getValue();
+    this->timer->start(int(SbMax(remaining, 0.0) * 1000.0));
+  }
+}
+
+double
+ResidencyManager::evictionDelay(void) const
+{
+  return this->evictiondelay;
+}
+
+/*
+  Returns the approximate number of bytes of texture memory used by
+  the share group of the widget.
+ */
+size_t
+ResidencyManager::textureMemory(void) const
+{
+  if (this->evicted) return 0;
+
+  size_t bytes = 0;
+  QSet<SoNode *> scenes;
+  foreach(ResidencyManager * manager, this->shareGroup()) {
+    SoNode * scene = manager->quarterwidget->getSceneGraph();
+    if (!scene || scenes.contains(scene)) continue;
+    scenes.insert(scene);
+    manager->updateEstimate(scene);
+    bytes += manager->texturebytes;
+  }
+  return bytes;
+}
+
+/*
+  Returns the approximate number of bytes used by the render caches,
+  i.e. display lists and vertex buffers, of the share group of the
+  widget.
+ */
+size_t
+ResidencyManager::cacheMemory(void) const
+{
+  if (this->evicted) return 0;
+
+  size_t bytes = 0;
+  QSet<SoNode *> scenes;
+  foreach(ResidencyManager * manager, this->shareGroup()) {
+    SoNode * scene = manager->quarterwidget->getSceneGraph();
+    if (!scene || scenes.contains(scene)) continue;
+    scenes.insert(scene);
+    manager->updateEstimate(scene);
+    bytes += manager->cachebytes;
+  }
+  return bytes;
+}
+
+bool
+ResidencyManager::eventFilter(QObject * obj, QEvent * event)
+{
+  switch (event->type()) {
+  case QEvent::Hide:
+    if (!this->hidden) {
+      this->hidden = true;
+      this->hiddensince = SbTime::getTimeOfDay();
+      if (this->evictiondelay > 0.0) {
+        this->timer->start(int(this->evictiondelay * 1000.0));
+      }
+    }
+    break;
+  case QEvent::Show:
+    this->hidden = false;
+    this->timer->stop();
+    // the caches are rebuilt by the next render
+    foreach(ResidencyManager * manager, this->shareGroup()) {
+      manager->evicted = false;
+    }
+    break;
+  default:
+    break;
+  }
+  return false;
+}
+
+/*
+  Releases the GL resources of the share group if all of its members
+  have been hidden for longer than their eviction delay. The resources
+  are recreated when the scene is rendered the next time.
+ */
+void
+ResidencyManager::evict(void)
+{
+  if (this->evicted || !this->evictable()) return;
+
+  const uint32_t id = this->quarterwidget->getCacheContextId();
+  QList<ResidencyManager *> group = this->shareGroup();
+  // other members, like offscreen renderers, may still be using the
+  // resources
+  if (group.size() != QuarterWidgetP::getCacheContextMemberCount(id)) return;
+  foreach(ResidencyManager * manager, group) {
+    if (!manager->evictable()) return;
+  }
+
+  this->quarterwidget->makeCurrent();
+  // fetch the cc_glglue context instance as a workaround for a bug fixed in Coin r12818
+  (void) cc_glglue_instance(id);
+  SoContextHandler::destructingContext(id);
+  this->quarterwidget->doneCurrent();
+
+  foreach(ResidencyManager * manager, group) {
+    manager->evicted = true;
+  }
+}
+
+void
+ResidencyManager::updateEstimate(SoNode * scene) const
+{
+  if (scene == this->estimatedscene && scene->getNodeId() == this->estimatednodeid) {
+    return;
+  }
+  this->estimatedscene = scene;
+  this->estimatednodeid = scene->getNodeId();
+
+  this->texturebytes = ResidencyManager::estimateTextureMemory(scene);
+
+  SoGetPrimitiveCountAction pca(this->quarterwidget->getSoRenderManager()->getViewportRegion());
+  pca.apply(scene);
+  this->cachebytes =
+    (size_t(pca.getTriangleCount()) * 3 +
+     size_t(pca.getLineCount()) * 2 +
+     size_t(pca.getPointCount())) * VERTEX_SIZE;
+}
+
+/*
+  Returns the approximate number of bytes of texture memory, including
+  mipmaps, used by the textures in the scene graph below \a root.
+ */
+size_t
+ResidencyManager::estimateTextureMemory(SoNode * root)
+{
+  TextureEstimate estimate;
+  estimate.bytes = 0;
+  SoCallbackAction cba;
+  cba.addPreCallback(SoTexture2::getClassTypeId(), texture_cb, &estimate);
+  cba.addPreCallback(SoTexture3::getClassTypeId(), texture_cb, &estimate);
+  cba.apply(root);
+  return estimate.bytes;
+}
+
+QList<ResidencyManager *>
+ResidencyManager::shareGroup(void) const
+{
+  const uint32_t id = this->quarterwidget->getCacheContextId();
+  QList<ResidencyManager *> group;
+  foreach(ResidencyManager * manager, *ResidencyManager::managers) {
+    if (manager->quarterwidget->getCacheContextId() == id) {
+      group.append(manager);
+    }
+  }
+  return group;
+}
+
+bool
+ResidencyManager::evictable(void) const
+{
+  return
+    this->hidden &&
+    this->evictiondelay > 0.0 &&
+    (SbTime::getTimeOfDay() - this->hiddensince).getValue() >= this->evictiondelay;
+}
@@ -0,0 +1,163 @@
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+/*
+  Holds back the resize events of a QuarterWidget while its window is
+  resized interactively. On Qt 6, QOpenGLWidget reallocates its
+  framebuffer object on every resize event, and the following frame
+  is rendered at the new size, so dragging a window edge reallocates
+  and renders once for every pixel the edge moves.
+
+  The first resize after a quiet period is passed on right away, so
+  single resizes, e.g. when maximizing the window, are not delayed.
+  Resizes following it within the delay are swallowed. The widget
+  keeps its framebuffer object and viewport, and the widget stack
+  scales the last frame to the new widget size. Once no resize has
+  arrived for the delay, a single resize event for the final size is
+  sent to the widget.
+
+  With Qt 5 the widget renders straight into its window, where the
+  last frame cannot be scaled, so resize events are never held back.
+ */
+
+#include "ResizeDebouncer.h"
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QEvent>
+#include <QtCore/QTimer>
+#include <QResizeEvent>
+
+#include <Quarter/QuarterWidget.h>
+
+using namespace SIM::Coin3D::Quarter;
+
+ResizeDebouncer::ResizeDebouncer(QuarterWidget * quarterwidget)
+  : QObject(quarterwidget)
+{
+  this->quarterwidget = quarterwidget;
+  this->isenabled = false;
+  this->pending = false;
+  this->committing = false;
+
+  this->timer = new QTimer(this);
+  this->timer->setSingleShot(true);
+  this->timer->setInterval(150);
+  this->connect(this->timer, SIGNAL(timeout(void)), this, SLOT(commit()));
+
+  quarterwidget->installEventFilter(this);
+}
+
+ResizeDebouncer::~ResizeDebouncer()
+{
+}
+
+void
+ResizeDebouncer::setEnabled(bool yes)
+{
+  if (yes == this->isenabled) return;
+  this->isenabled = yes;
+  if (!yes) {
+    // don't leave the widget at a stale size
+    this->commit();
+  }
+}
+
+bool
+ResizeDebouncer::enabled(void) const
+{
+  return this->isenabled;
+}
+
+void
+ResizeDebouncer::setDelay(double sec)
+{
+  this->timer->setInterval(int(qMax(0.0, sec) * 1000.0));
+}
+
+double
+ResizeDebouncer::delay(void) const
+{
+  return this->timer->interval() / 1000.0;
+}
+
+/*
+  Returns true while a resize is being held back.
+ */
+bool
+ResizeDebouncer::deferring(void) const
+{
+  return this->pending;
+}
+
+bool
+ResizeDebouncer::eventFilter(QObject * obj, QEvent * event)
+{
+  if (event->type() != QEvent::Resize || obj != this->quarterwidget) {
+    return false;
+  }
+  QResizeEvent * resize = static_cast<QResizeEvent *>(event);
+
+#if QT_VERSION >= 0x060000
+  if (this->isenabled && !this->committing &&
+      this->quarterwidget->isVisible() && this->quarterwidget->isValid() &&
+      this->timer->isActive()) {
+    this->pending = true;
+    this->timer->start();
+    return true;
+  }
+#endif
+
+  this->committedsize = resize->size();
+  // opens the window during which further resizes are held back
+  if (this->isenabled && !this->committing) this->timer->start();
+  return false;
+}
+
+/*
+  Sends a resize event for the current widget size if one has been
+  held back.
+ */
+void
+ResizeDebouncer::commit(void)
+{
+  this->timer->stop();
+  if (!this->pending) return;
+  this->pending = false;
+
+  const QSize size = this->quarterwidget->size();
+  if (size == this->committedsize) return;
+
+  this->committing = true;
+  QResizeEvent resize(size, this->committedsize);
+  QCoreApplication::sendEvent(this->quarterwidget, &resize);
+  this->committing = false;
+}
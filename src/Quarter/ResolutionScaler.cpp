@@ -0,0 +1,263 @@
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+/*
+  Renders QuarterWidget frames into a framebuffer object at a fraction
+  of the viewport size and upscales the result into the widget, so
+  fill-rate bound scenes keep an interactive frame rate. The fraction
+  is adjusted to hold a target frame time, and a full resolution
+  frame is rendered once the scene has been static for a moment.
+ */
+
+#include "ResolutionScaler.h"
+
+#include <math.h>
+
+#include <QtCore/QTimer>
+#if (QT_VERSION >= 0x050000)
+#  include <QOpenGLFramebufferObject>
+#  include <QOpenGLFramebufferObjectFormat>
+#endif
+
+#include <Inventor/SbBasic.h>
+#include <Inventor/SoRenderManager.h>
+#include <Inventor/actions/SoGLRenderAction.h>
+#include <Inventor/system/gl.h>
+
+#include <Quarter/QuarterWidget.h>
+
+using namespace SIM::Coin3D::Quarter;
+
+// when no frame follows within this many seconds, the interaction is
+// over and the scene is refined at full resolution
+static const double IDLE_TIME = 0.15;
+
+ResolutionScaler::ResolutionScaler(QuarterWidget * quarterwidget)
+  : QObject(quarterwidget)
+{
+  this->quarterwidget = quarterwidget;
+  this->isenabled = false;
+  this->targetframetime = 1.0 / 30.0;
+  this->minscale = 0.5;
+  this->currentscale = 1.0;
+  this->refine = false;
+  this->refining = false;
+  this->framestart = SbTime::zero();
+  this->frameend = SbTime::zero();
+  this->scaling = false;
+  this->fbo = NULL;
+
+  this->idletimer = new QTimer(this);
+  this->idletimer->setSingleShot(true);
+  this->idletimer->setInterval(int(IDLE_TIME * 1000.0));
+  this->connect(this->idletimer, SIGNAL(timeout(void)), this, SLOT(idle()));
+}
+
+ResolutionScaler::~ResolutionScaler()
+{
+}
+
+void
+ResolutionScaler::setEnabled(bool yes)
+{
+  this->isenabled = yes;
+
+  // don't leave a reduced resolution frame on screen
+  if (!yes && this->idletimer->isActive()) {
+    this->idletimer->stop();
+    this->quarterwidget->redraw();
+  }
+}
+
+bool
+ResolutionScaler::enabled(void) const
+{
+  return this->isenabled;
+}
+
+void
+ResolutionScaler::setTargetFrameTime(double sec)
+{
+  this->targetframetime = sec;
+}
+
+double
+ResolutionScaler::targetFrameTime(void) const
+{
+  return this->targetframetime;
+}
+
+void
+ResolutionScaler::setMinimumScale(double scale)
+{
+  this->minscale = SbClamp(scale, 0.1, 1.0);
+  this->currentscale = SbMax(this->currentscale, this->minscale);
+}
+
+double
+ResolutionScaler::minimumScale(void) const
+{
+  return this->minscale;
+}
+
+/*
+  Returns the scale used for interactive frames.
+ */
+double
+ResolutionScaler::scale(void) const
+{
+  return this->currentscale;
+}
+
+/*
+  Called from QuarterWidget::paintGL() before the scene is rendered,
+  with the GL context current. Redirects the rendering into the
+  framebuffer object when the frame should be rendered at reduced
+  resolution.
+ */
+void
+ResolutionScaler::beginFrame(void)
+{
+  this->framestart = SbTime::getTimeOfDay();
+
+  double scale = this->refine ? 1.0 : this->currentscale;
+  this->refining = this->refine;
+  this->refine = false;
+
+  if (!this->isenabled || scale >= 1.0) return;
+
+#if (QT_VERSION >= 0x050000)
+  if (!QOpenGLFramebufferObject::hasOpenGLFramebufferBlit()) return;
+
+  SoGLRenderAction * action = this->quarterwidget->getSoRenderManager()->getGLRenderAction();
+  this->fullviewport = action->getViewportRegion();
+
+  SbVec2s windowsize = this->fullviewport.getWindowSize();
+  SbVec2s origin = this->fullviewport.getViewportOriginPixels();
+  SbVec2s size = this->fullviewport.getViewportSizePixels();
+
+  QSize fbosize(SbMax(int(windowsize[0] * scale), 1), SbMax(int(windowsize[1] * scale), 1));
+  if (!this->fbo || this->fbo->size() != fbosize) {
+    delete this->fbo;
+    QOpenGLFramebufferObjectFormat format;
+    format.setAttachment(QOpenGLFramebufferObject::CombinedDepthStencil);
+    this->fbo = new QOpenGLFramebufferObject(fbosize, format);
+  }
+
+  SbViewportRegion vp(fbosize.width(), fbosize.height());
+  vp.setViewportPixels(int(origin[0] * scale), int(origin[1] * scale),
+                       SbMax(int(size[0] * scale), 1), SbMax(int(size[1] * scale), 1));
+
+  this->fbo->bind();
+  // set the viewport on the action, not the render manager, since
+  // SoRenderManager::setViewportRegion() schedules another redraw
+  action->setViewportRegion(vp);
+  this->scaling = true;
+#endif
+}
+
+/*
+  Called from QuarterWidget::paintGL() after the scene has been
+  rendered. Upscales the reduced resolution frame into the widget.
+ */
+void
+ResolutionScaler::endFrame(void)
+{
+#if (QT_VERSION >= 0x050000)
+  if (this->scaling) {
+    SoGLRenderAction * action = this->quarterwidget->getSoRenderManager()->getGLRenderAction();
+    action->setViewportRegion(this->fullviewport);
+
+    this->fbo->release();
+    SbVec2s windowsize = this->fullviewport.getWindowSize();
+    QOpenGLFramebufferObject::blitFramebuffer(NULL, QRect(0, 0, windowsize[0], windowsize[1]),
+                                              this->fbo, QRect(QPoint(0, 0), this->fbo->size()),
+                                              GL_COLOR_BUFFER_BIT, GL_LINEAR);
+  }
+#endif
+  this->scaling = false;
+
+  // measure from beginFrame() to here, so that the time the widget
+  // spends idle between frames is not counted as rendering cost
+  this->frameend = SbTime::getTimeOfDay();
+  if (this->isenabled && !this->refining) {
+    this->updateScale((this->frameend - this->framestart).getValue());
+  }
+
+  // render at full resolution unless another frame follows shortly
+  this->idletimer->start();
+}
+
+bool
+ResolutionScaler::hasFramebuffer(void) const
+{
+  return this->fbo != NULL;
+}
+
+/*
+  Releases the framebuffer object. Must be called with the widget's
+  GL context current.
+ */
+void
+ResolutionScaler::cleanup(void)
+{
+  this->idletimer->stop();
+#if (QT_VERSION >= 0x050000)
+  delete this->fbo;
+#endif
+  this->fbo = NULL;
+}
+
+void
+ResolutionScaler::idle(void)
+{
+  this->refine = true;
+  this->quarterwidget->redraw();
+}
+
+/*
+  The rendering cost is assumed to be proportional to the number of
+  pixels, i.e. to the square of the scale. Only move half way to the
+  estimated scale to damp oscillations.
+ */
+void
+ResolutionScaler::updateScale(double frametime)
+{
+  if (frametime <= 0.0 || this->targetframetime <= 0.0) return;
+
+  double estimate = this->currentscale * sqrt(this->targetframetime / frametime);
+  double scale = this->currentscale + 0.5 * (estimate - this->currentscale);
+  if (scale > 0.97) {
+    scale = 1.0;
+  }
+  this->currentscale = SbClamp(scale, this->minscale, 1.0);
+}
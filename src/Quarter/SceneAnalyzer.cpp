@@ -0,0 +1,746 @@
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+/*!
+  \class SIM::Coin3D::Quarter::SceneAnalyzer SceneAnalyzer.h Quarter/SceneAnalyzer.h
+
+  \brief The SceneAnalyzer class finds the parts of a scene graph that
+  are expensive to render.
+
+  analyze() lists every top-level child of the scene and every
+  separator below it, and reports for each of them the number of
+  nodes and primitives, an estimate of the texture memory, and
+  whether the separator's render cache is enabled or kept from being
+  built. Nodes which invalidate the caches of the separators above
+  them are listed as the cache breakers of the subgraph: SoCallback
+  nodes, the animated SoRotor, SoPendulum, SoShuttle and SoBlinker
+  nodes, and fields that are connected to the realTime global field,
+  directly or through engines. SoText2 and SoImage nodes keep
+  separators from caching automatically, so they are listed for
+  separators with the default AUTO caching.
+
+  With timing enabled, which is the default, each top-level child is
+  also rendered on its own into an offscreen framebuffer object,
+  through the path from the scene root, so the camera, lights and
+  other properties to the left of it still apply. The first render,
+  which builds the caches, and the median of the following renders
+  are reported. Timing is done in a context and a cache context of
+  its own, so the caches of the application's widgets are not
+  touched, and needs Qt 5.
+
+  The results can be sorted by render time, primitives, nodes or
+  texture memory with sort(), and report() formats them as a ranked
+  table:
+
+  \code
+  SceneAnalyzer analyzer(viewer->getSoRenderManager()->getViewportRegion());
+  analyzer.analyze(viewer->getSceneGraph(), viewer->getSoRenderManager()->getCamera());
+  analyzer.sort(SceneAnalyzer::RENDER_TIME);
+  printf("%s\n", analyzer.report().toLocal8Bit().constData());
+  \endcode
+
+  Subgraphs which are shared by several parents are listed once. The
+  QuarterWidget context menu runs the analyzer on the widget's scene
+  through Functions > Analyze Scene.
+*/
+
+#include <Quarter/SceneAnalyzer.h>
+
+#include <algorithm>
+
+#include <QtCore/QHash>
+#include <QtCore/QList>
+#include <QtCore/QSet>
+#include <QtCore/QStringList>
+#if QT_VERSION >= 0x050000
+#  include <QOffscreenSurface>
+#  include <QOpenGLContext>
+#  include <QOpenGLFramebufferObject>
+#endif
+
+#include <Inventor/SbTime.h>
+#include <Inventor/SoDB.h>
+#include <Inventor/SoPath.h>
+#include <Inventor/actions/SoGLRenderAction.h>
+#include <Inventor/actions/SoGetPrimitiveCountAction.h>
+#include <Inventor/actions/SoSearchAction.h>
+#include <Inventor/engines/SoEngine.h>
+#include <Inventor/engines/SoEngineOutput.h>
+#include <Inventor/fields/SoField.h>
+#include <Inventor/lists/SoFieldList.h>
+#include <Inventor/misc/SoChildList.h>
+#include <Inventor/nodes/SoBlinker.h>
+#include <Inventor/nodes/SoCallback.h>
+#include <Inventor/nodes/SoCamera.h>
+#include <Inventor/nodes/SoImage.h>
+#include <Inventor/nodes/SoPendulum.h>
+#include <Inventor/nodes/SoPerspectiveCamera.h>
+#include <Inventor/nodes/SoRotor.h>
+#include <Inventor/nodes/SoSeparator.h>
+#include <Inventor/nodes/SoShuttle.h>
+#include <Inventor/nodes/SoText2.h>
+#include <Inventor/system/gl.h>
+
+#include "QuarterWidgetP.h"
+#include "ResidencyManager.h"
+
+// renders of each top-level child after the first one
+static const int TIMED_RENDERS = 5;
+// how deep to follow engine connections looking for realTime
+static const int MAX_ENGINE_DEPTH = 4;
+
+namespace SIM { namespace Coin3D { namespace Quarter {
+
+class SceneAnalyzerP {
+public:
+  struct Entry {
+    SoNode * node;
+    SoPath * path;
+    QString name;
+    int depth;
+    bool toplevel;
+    int nodes;
+    int primitives;
+    size_t texturememory;
+    SceneAnalyzer::CacheState cachestate;
+    QStringList breakers;
+    double firstrendertime;
+    double rendertime;
+  };
+
+  struct Scan {
+    int nodes;
+    QStringList breakers;
+    QStringList autoblockers;
+  };
+
+  SceneAnalyzerP(const SbViewportRegion & region) {
+    this->region = region;
+    this->timing = true;
+    this->totalnodes = 0;
+    this->totalprimitives = 0;
+    this->totaltexturememory = 0;
+  }
+
+  ~SceneAnalyzerP() {
+    this->clear();
+  }
+
+  void clear(void);
+  void releasePaths(void);
+  const Scan & scan(SoNode * node);
+  void collect(SoPath * path, int depth);
+  void addEntry(SoPath * path, int depth, bool toplevel);
+  void measure(void);
+
+  SbViewportRegion region;
+  bool timing;
+  QList<Entry> entries;
+  QHash<SoNode *, Scan> scans;
+  QSet<SoNode *> visited;
+  int totalnodes;
+  int totalprimitives;
+  size_t totaltexturememory;
+};
+
+}}} // namespace
+
+using namespace SIM::Coin3D::Quarter;
+
+#define PRIVATE(obj) obj->pimpl
+
+static void
+append_unique(QStringList & list, const QStringList & other)
+{
+  foreach (const QString & str, other) {
+    if (!list.contains(str)) list.append(str);
+  }
+}
+
+/*
+  Returns true if an input of \a engine, or of an engine it is
+  connected from, is connected to the realTime global field.
+ */
+static bool
+engine_uses_realtime(SoEngine * engine, SoField * realtime, int depth)
+{
+  if (!engine || depth > MAX_ENGINE_DEPTH) return false;
+  SoFieldList inputs;
+  engine->getFields(inputs);
+  for (int i = 0; i < inputs.getLength(); i++) {
+    SoField * input = inputs[i];
+    SoField * master = NULL;
+    if (input->getConnectedField(master) && master == realtime) return true;
+    SoEngineOutput * output = NULL;
+    if (input->getConnectedEngine(output) && !output->isNodeEngineOutput() &&
+        engine_uses_realtime(output->getContainer(), realtime, depth + 1)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/*
+  Returns the reasons \a node invalidates the render caches of the
+  separators above it.
+ */
+static QStringList
+cache_breakers(SoNode * node)
+{
+  QStringList reasons;
+  const QString type = node->getTypeId().getName().getString();
+
+  if (node->isOfType(SoCallback::getClassTypeId())) {
+    reasons.append(type);
+  }
+  if (node->isOfType(SoRotor::getClassTypeId()) ||
+      node->isOfType(SoPendulum::getClassTypeId()) ||
+      node->isOfType(SoShuttle::getClassTypeId()) ||
+      node->isOfType(SoBlinker::getClassTypeId())) {
+    reasons.append(type + " animation");
+  }
+
+  SoField * realtime = SoDB::getGlobalField("realTime");
+  if (!realtime) return reasons;
+
+  SoFieldList fields;
+  node->getFields(fields);
+  for (int i = 0; i < fields.getLength(); i++) {
+    SoField * field = fields[i];
+    bool animated = false;
+    SoField * master = NULL;
+    SoEngineOutput * output = NULL;
+    if (field->getConnectedField(master)) {
+      animated = (master == realtime);
+    } else if (field->getConnectedEngine(output) && !output->isNodeEngineOutput()) {
+      animated = engine_uses_realtime(output->getContainer(), realtime, 0);
+    }
+    if (animated) {
+      SbName fieldname;
+      node->getFieldName(field, fieldname);
+      reasons.append(type + "." + fieldname.getString() + " driven by realTime");
+    }
+  }
+  return reasons;
+}
+
+static QString
+entry_name(SoPath * path)
+{
+  SoNode * node = path->getTail();
+  QString name = node->getTypeId().getName().getString();
+  if (node->getName().getLength() > 0) {
+    name += QString(" \"%1\"").arg(node->getName().getString());
+  }
+  // indices below the scene, skipping the analyzer's own root
+  QString location;
+  for (int i = 2; i < path->getLength(); i++) {
+    location += QString("/%1").arg(path->getIndex(i));
+  }
+  name += QString(" (%1)").arg(location.isEmpty() ? QString("/") : location);
+  return name;
+}
+
+static const char *
+cache_state_name(SceneAnalyzer::CacheState state)
+{
+  switch (state) {
+  case SceneAnalyzer::CACHING_AUTO: return "auto";
+  case SceneAnalyzer::CACHING_ON: return "on";
+  case SceneAnalyzer::CACHING_OFF: return "off";
+  case SceneAnalyzer::CACHING_BROKEN: return "broken";
+  default: return "-";
+  }
+}
+
+void
+SceneAnalyzerP::releasePaths(void)
+{
+  for (int i = 0; i < this->entries.size(); i++) {
+    if (this->entries[i].path) {
+      this->entries[i].path->unref();
+      this->entries[i].path = NULL;
+    }
+  }
+}
+
+void
+SceneAnalyzerP::clear(void)
+{
+  this->releasePaths();
+  for (int i = 0; i < this->entries.size(); i++) {
+    this->entries[i].node->unref();
+  }
+  this->entries.clear();
+  this->scans.clear();
+  this->visited.clear();
+  this->totalnodes = 0;
+  this->totalprimitives = 0;
+  this->totaltexturememory = 0;
+}
+
+/*
+  Counts the nodes below \a node and gathers the cache breakers of
+  the subgraph. Results are kept per node, so shared subgraphs are
+  only scanned once.
+ */
+const SceneAnalyzerP::Scan &
+SceneAnalyzerP::scan(SoNode * node)
+{
+  QHash<SoNode *, Scan>::const_iterator it = this->scans.constFind(node);
+  if (it != this->scans.constEnd()) return it.value();
+
+  Scan result;
+  result.nodes = 1;
+  result.breakers = cache_breakers(node);
+  if (node->isOfType(SoText2::getClassTypeId()) ||
+      node->isOfType(SoImage::getClassTypeId())) {
+    result.autoblockers.append(node->getTypeId().getName().getString());
+  }
+
+  SoChildList * children = node->getChildren();
+  if (children) {
+    for (int i = 0; i < children->getLength(); i++) {
+      const Scan & child = this->scan((*children)[i]);
+      result.nodes += child.nodes;
+      append_unique(result.breakers, child.breakers);
+      append_unique(result.autoblockers, child.autoblockers);
+    }
+  }
+  return *this->scans.insert(node, result);
+}
+
+void
+SceneAnalyzerP::collect(SoPath * path, int depth)
+{
+  SoNode * node = path->getTail();
+  const bool isgroup = node->isOfType(SoGroup::getClassTypeId());
+  const bool toplevel = (depth == 1) || (depth == 0 && !isgroup);
+
+  if (!toplevel && this->visited.contains(node)) return;
+  this->visited.insert(node);
+
+  if (toplevel || node->isOfType(SoSeparator::getClassTypeId())) {
+    this->addEntry(path, depth, toplevel);
+  }
+  if (isgroup) {
+    SoGroup * group = static_cast<SoGroup *>(node);
+    for (int i = 0; i < group->getNumChildren(); i++) {
+      path->append(i);
+      this->collect(path, depth + 1);
+      path->pop();
+    }
+  }
+}
+
+void
+SceneAnalyzerP::addEntry(SoPath * path, int depth, bool toplevel)
+{
+  SoNode * node = path->getTail();
+  const Scan & scan = this->scan(node);
+
+  Entry entry;
+  entry.node = node;
+  entry.node->ref();
+  entry.path = toplevel ? path->copy() : NULL;
+  if (entry.path) entry.path->ref();
+  entry.name = entry_name(path);
+  entry.depth = depth;
+  entry.toplevel = toplevel;
+  entry.nodes = scan.nodes;
+  entry.firstrendertime = -1.0;
+  entry.rendertime = -1.0;
+
+  SoGetPrimitiveCountAction pca(this->region);
+  pca.apply(path);
+  entry.primitives = pca.getTriangleCount() + pca.getLineCount() + pca.getPointCount();
+  entry.texturememory = ResidencyManager::estimateTextureMemory(node);
+
+  entry.cachestate = SceneAnalyzer::NOT_A_SEPARATOR;
+  entry.breakers = scan.breakers;
+  if (node->isOfType(SoSeparator::getClassTypeId())) {
+    SoSeparator * sep = static_cast<SoSeparator *>(node);
+    switch (sep->renderCaching.getValue()) {
+    case SoSeparator::ON: entry.cachestate = SceneAnalyzer::CACHING_ON; break;
+    case SoSeparator::OFF: entry.cachestate = SceneAnalyzer::CACHING_OFF; break;
+    default: entry.cachestate = SceneAnalyzer::CACHING_AUTO; break;
+    }
+    if (SoSeparator::getNumRenderCaches() == 0) {
+      entry.cachestate = SceneAnalyzer::CACHING_OFF;
+    }
+    if (entry.cachestate == SceneAnalyzer::CACHING_AUTO) {
+      append_unique(entry.breakers, scan.autoblockers);
+    }
+    if (entry.cachestate != SceneAnalyzer::CACHING_OFF && !entry.breakers.isEmpty()) {
+      entry.cachestate = SceneAnalyzer::CACHING_BROKEN;
+    }
+  }
+
+  this->entries.append(entry);
+}
+
+/*
+  Renders the path of each top-level entry on its own into an
+  offscreen framebuffer object and records the render times.
+ */
+void
+SceneAnalyzerP::measure(void)
+{
+#if QT_VERSION >= 0x050000
+  QOpenGLContext context;
+  if (!context.create()) return;
+  QOffscreenSurface surface;
+  surface.setFormat(context.format());
+  surface.create();
+  if (!context.makeCurrent(&surface)) return;
+
+  const SbVec2s size = this->region.getWindowSize();
+  QOpenGLFramebufferObject * fbo =
+    new QOpenGLFramebufferObject(size[0], size[1], QOpenGLFramebufferObject::CombinedDepthStencil);
+  fbo->bind();
+
+  QuarterWidgetP_cachecontext * cachecontext = QuarterWidgetP::findCacheContext(this, NULL);
+  SoGLRenderAction action(this->region);
+  action.setCacheContext(QuarterWidgetP::getCacheContextId(cachecontext));
+
+  for (int i = 0; i < this->entries.size(); i++) {
+    Entry & entry = this->entries[i];
+    if (!entry.path) continue;
+
+    QList<double> times;
+    for (int run = 0; run <= TIMED_RENDERS; run++) {
+      glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+      glFinish();
+      const SbTime start = SbTime::getTimeOfDay();
+      action.apply(entry.path);
+      glFinish();
+      const double elapsed = (SbTime::getTimeOfDay() - start).getValue();
+      if (run == 0) {
+        entry.firstrendertime = elapsed;
+      } else {
+        times.append(elapsed);
+      }
+    }
+    std::sort(times.begin(), times.end());
+    entry.rendertime = times[times.size() / 2];
+  }
+
+  fbo->release();
+  delete fbo;
+  if (QuarterWidgetP::removeFromCacheContext(cachecontext, this)) {
+    QuarterWidgetP::destructCacheContext(cachecontext);
+  }
+  context.doneCurrent();
+#endif
+}
+
+class SceneAnalyzerLess {
+public:
+  SceneAnalyzerLess(SceneAnalyzer::SortKey key) : key(key) { }
+  // orders the most expensive entries first
+  bool operator()(const SceneAnalyzerP::Entry & a, const SceneAnalyzerP::Entry & b) const {
+    switch (this->key) {
+    case SceneAnalyzer::RENDER_TIME:
+      if (a.rendertime != b.rendertime) return a.rendertime > b.rendertime;
+      return a.primitives > b.primitives;
+    case SceneAnalyzer::NODES:
+      return a.nodes > b.nodes;
+    case SceneAnalyzer::TEXTURE_MEMORY:
+      return a.texturememory > b.texturememory;
+    default:
+      return a.primitives > b.primitives;
+    }
+  }
+private:
+  SceneAnalyzer::SortKey key;
+};
+
+/*!
+  Constructor. Primitives are counted, and subgraphs are rendered,
+  for the viewport \a region.
+*/
+SceneAnalyzer::SceneAnalyzer(const SbViewportRegion & region)
+{
+  PRIVATE(this) = new SceneAnalyzerP(region);
+}
+
+/*!
+  Destructor.
+*/
+SceneAnalyzer::~SceneAnalyzer()
+{
+  delete PRIVATE(this);
+}
+
+/*!
+  Enables or disables rendering the top-level children of the scene
+  to measure their render times. Without timing, analyze() does not
+  need an OpenGL context.
+*/
+void
+SceneAnalyzer::setTimingEnabled(bool yes)
+{
+  PRIVATE(this)->timing = yes;
+}
+
+/*!
+  Returns true if render times are measured.
+*/
+bool
+SceneAnalyzer::timingEnabled(void) const
+{
+  return PRIVATE(this)->timing;
+}
+
+/*!
+  Analyzes \a scene, replacing the results of an earlier analysis.
+  If \a camera is not part of the scene, it is put in front of it. If
+  there is no camera at all, one viewing the whole scene is used.
+  Results are sorted by render time.
+
+  Returns false if \a scene is NULL.
+*/
+bool
+SceneAnalyzer::analyze(SoNode * scene, SoCamera * camera)
+{
+  PRIVATE(this)->clear();
+  if (!scene) return false;
+
+  SoSeparator * root = new SoSeparator;
+  root->ref();
+
+  if (camera) {
+    SoSearchAction sa;
+    sa.setNode(camera);
+    sa.setInterest(SoSearchAction::FIRST);
+    sa.setSearchingAll(TRUE);
+    sa.apply(scene);
+    if (!sa.getPath()) root->addChild(camera);
+  } else if (!QuarterWidgetP::searchForCamera(scene)) {
+    SoPerspectiveCamera * viewer = new SoPerspectiveCamera;
+    root->addChild(viewer);
+    viewer->viewAll(scene, PRIVATE(this)->region);
+  }
+  root->addChild(scene);
+
+  SoPath * path = new SoPath(root);
+  path->ref();
+  path->append(scene);
+  PRIVATE(this)->collect(path, 0);
+  path->unref();
+
+  SoGetPrimitiveCountAction pca(PRIVATE(this)->region);
+  pca.apply(root);
+  PRIVATE(this)->totalnodes = PRIVATE(this)->scan(scene).nodes;
+  PRIVATE(this)->totalprimitives =
+    pca.getTriangleCount() + pca.getLineCount() + pca.getPointCount();
+  PRIVATE(this)->totaltexturememory = ResidencyManager::estimateTextureMemory(scene);
+
+  if (PRIVATE(this)->timing) {
+    PRIVATE(this)->measure();
+  }
+  PRIVATE(this)->releasePaths();
+  PRIVATE(this)->scans.clear();
+  PRIVATE(this)->visited.clear();
+  root->unref();
+
+  this->sort(RENDER_TIME);
+  return true;
+}
+
+/*!
+  Sorts the results by \a key, the most expensive subgraph first.
+  When sorting by render time, subgraphs which were not timed follow
+  the timed ones, ordered by primitive count.
+*/
+void
+SceneAnalyzer::sort(SortKey key)
+{
+  std::stable_sort(PRIVATE(this)->entries.begin(), PRIVATE(this)->entries.end(),
+                   SceneAnalyzerLess(key));
+}
+
+/*!
+  Returns the number of analyzed subgraphs.
+*/
+int
+SceneAnalyzer::numSubgraphs(void) const
+{
+  return PRIVATE(this)->entries.size();
+}
+
+/*!
+  Returns the root node of subgraph \a index.
+*/
+SoNode *
+SceneAnalyzer::getNode(int index) const
+{
+  return PRIVATE(this)->entries[index].node;
+}
+
+/*!
+  Returns the type, name and location of subgraph \a index. The
+  location lists the child indices from the scene root, like
+  "/2/0".
+*/
+QString
+SceneAnalyzer::getName(int index) const
+{
+  return PRIVATE(this)->entries[index].name;
+}
+
+/*!
+  Returns the depth of subgraph \a index below the scene root.
+*/
+int
+SceneAnalyzer::getDepth(int index) const
+{
+  return PRIVATE(this)->entries[index].depth;
+}
+
+/*!
+  Returns true if subgraph \a index is a top-level child of the
+  scene, or the scene itself if the scene is not a group.
+*/
+bool
+SceneAnalyzer::isTopLevel(int index) const
+{
+  return PRIVATE(this)->entries[index].toplevel;
+}
+
+/*!
+  Returns the number of nodes in subgraph \a index.
+*/
+int
+SceneAnalyzer::getNodeCount(int index) const
+{
+  return PRIVATE(this)->entries[index].nodes;
+}
+
+/*!
+  Returns the number of triangles, lines and points rendered by
+  subgraph \a index.
+*/
+int
+SceneAnalyzer::getPrimitiveCount(int index) const
+{
+  return PRIVATE(this)->entries[index].primitives;
+}
+
+/*!
+  Returns the estimated texture memory, in bytes, of the textures in
+  subgraph \a index.
+*/
+size_t
+SceneAnalyzer::getTextureMemory(int index) const
+{
+  return PRIVATE(this)->entries[index].texturememory;
+}
+
+/*!
+  Returns the render caching state of subgraph \a index.
+*/
+SceneAnalyzer::CacheState
+SceneAnalyzer::getCacheState(int index) const
+{
+  return PRIVATE(this)->entries[index].cachestate;
+}
+
+/*!
+  Returns the nodes and fields in subgraph \a index that invalidate
+  render caches, separated by commas.
+*/
+QString
+SceneAnalyzer::getCacheBreakers(int index) const
+{
+  return PRIVATE(this)->entries[index].breakers.join(", ");
+}
+
+/*!
+  Returns the time, in seconds, of the first render of subgraph \a
+  index, which includes building its caches, or -1 if it was not
+  timed.
+*/
+double
+SceneAnalyzer::getFirstRenderTime(int index) const
+{
+  return PRIVATE(this)->entries[index].firstrendertime;
+}
+
+/*!
+  Returns the median time, in seconds, of the renders of subgraph \a
+  index after the first one, or -1 if it was not timed.
+*/
+double
+SceneAnalyzer::getRenderTime(int index) const
+{
+  return PRIVATE(this)->entries[index].rendertime;
+}
+
+/*!
+  Returns the results as a table, in their current order, with at
+  most \a maxentries rows.
+*/
+QString
+SceneAnalyzer::report(int maxentries) const
+{
+  QString text;
+  text += QString("Scene: %1 nodes, %2 primitives, %3 KB of textures\n\n")
+    .arg(PRIVATE(this)->totalnodes)
+    .arg(PRIVATE(this)->totalprimitives)
+    .arg(PRIVATE(this)->totaltexturememory / 1024);
+  text += QString("%1 %2 %3 %4 %5 %6  %7\n")
+    .arg("time ms", 9).arg("first ms", 9).arg("prims", 10).arg("nodes", 8)
+    .arg("tex KB", 8).arg("caching", -7).arg("subgraph");
+
+  const int count = qMin(maxentries, PRIVATE(this)->entries.size());
+  for (int i = 0; i < count; i++) {
+    const SceneAnalyzerP::Entry & entry = PRIVATE(this)->entries[i];
+    const QString time = entry.rendertime < 0.0 ? QString("-") :
+      QString::number(entry.rendertime * 1000.0, 'f', 3);
+    const QString first = entry.firstrendertime < 0.0 ? QString("-") :
+      QString::number(entry.firstrendertime * 1000.0, 'f', 3);
+    text += QString("%1 %2 %3 %4 %5 %6  %7%8\n")
+      .arg(time, 9).arg(first, 9).arg(entry.primitives, 10).arg(entry.nodes, 8)
+      .arg(qulonglong(entry.texturememory / 1024), 8)
+      .arg(cache_state_name(entry.cachestate), -7)
+      .arg(QString(entry.depth, ' ') + entry.name)
+      .arg(entry.breakers.isEmpty() ? QString() :
+           QString(" [%1]").arg(entry.breakers.join(", ")));
+  }
+  if (count < PRIVATE(this)->entries.size()) {
+    text += QString("... %1 more\n").arg(PRIVATE(this)->entries.size() - count);
+  }
+  return text;
+}
+
+#undef PRIVATE
@@ -0,0 +1,851 @@
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+/*!
+  \class SIM::Coin3D::Quarter::SceneLoader SceneLoader.h Quarter/SceneLoader.h
+
+  \brief The SceneLoader class reads Inventor and VRML scene graphs
+  without blocking the user interface.
+
+  The file or buffer is parsed on a worker thread, one top level node
+  at a time, so that progress can be reported and the load can be
+  cancelled between nodes. When parsing completes, loaded() is emitted
+  on the GUI thread, and the scene graph is set on the target
+  QuarterWidget, if there is one.
+
+  Any number of loaders can be started at once, for instance one for
+  each file dropped on a window. At most maxConcurrentLoads() of them
+  parse at the same time, the others wait for a turn, in about the
+  order they were started.
+
+  Parsing in the background requires a thread safe Coin. Without
+  COIN_THREADSAFE, the scene is parsed on the GUI thread, but the
+  result is still delivered asynchronously.
+
+  With setOptimizing(), the scene graph is also rewritten by a
+  SceneOptimizer on the worker thread, before it is set on the
+  target.
+*/
+
+#include <Quarter/SceneLoader.h>
+
+#include <QtCore/QAtomicInt>
+#include <QtCore/QCryptographicHash>
+#include <QtCore/QDateTime>
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QList>
+#include <QtCore/QMutex>
+#include <QtCore/QReadWriteLock>
+#include <QtCore/QThread>
+#include <QtCore/QTimer>
+#include <QtCore/QWaitCondition>
+
+#include <Inventor/C/basic.h>
+#include <Inventor/SbBasic.h>
+#include <Inventor/SoDB.h>
+#include <Inventor/SoInput.h>
+#include <Inventor/SoOutput.h>
+#include <Inventor/actions/SoSearchAction.h>
+#include <Inventor/actions/SoWriteAction.h>
+#include <Inventor/nodes/SoCamera.h>
+#include <Inventor/nodes/SoSeparator.h>
+
+#include <Quarter/Quarter.h>
+#include <Quarter/QuarterWidget.h>
+#include <Quarter/SceneOptimizer.h>
+
+#include "Trace.h"
+
+namespace SIM { namespace Coin3D { namespace Quarter {
+
+/*
+  Does the actual parsing. The thread object is owned by the GUI
+  thread. A cancelled loader is left to finish on its own and deletes
+  itself, together with whatever it read.
+ */
+class SceneLoaderThread : public QThread {
+public:
+  SceneLoaderThread(const QString & filename, const QByteArray & buffer, bool streaming,
+                    bool optimizing)
+    : filename(filename), buffer(buffer), streaming(streaming),
+      optimizing(optimizing && !streaming), streamed(0), root(NULL)
+  {
+  }
+
+  ~SceneLoaderThread()
+  {
+    if (this->root) this->root->unref();
+    foreach (SoNode * node, this->pending) node->unref();
+  }
+
+  // the top level nodes read since the last call, each ref'ed once
+  QList<SoNode *> takePending(void)
+  {
+    QMutexLocker locker(&this->pendingmutex);
+    QList<SoNode *> ret;
+    ret.swap(this->pending);
+    return ret;
+  }
+
+  // takes over the reference held by the loader
+  SoSeparator * takeRoot(void)
+  {
+    SoSeparator * ret = this->root;
+    this->root = NULL;
+    return ret;
+  }
+
+  void load(void);
+  SoSeparator * read(SoInput & in, double total);
+  void optimize(SoSeparator * root);
+  bool isStreaming(void) const { return this->streaming; }
+
+  QAtomicInt canceled;
+  QAtomicInt permille;
+
+protected:
+  virtual void run(void);
+
+private:
+  QString filename;
+  QByteArray buffer;
+  bool streaming;
+  bool optimizing;
+  int streamed;
+  SoSeparator * root;
+  QMutex pendingmutex;
+  QList<SoNode *> pending;
+};
+
+class SceneLoaderP {
+public:
+  SceneLoaderP(SceneLoader * master) {
+    this->master = master;
+    this->target = NULL;
+    this->thread = NULL;
+    this->lastpermille = -1;
+    this->streaming = false;
+    this->optimizing = false;
+    this->streamroot = NULL;
+    this->streamviewall = false;
+  }
+
+  void start(const QString & filename, const QByteArray & buffer);
+  void abandon(void);
+  void insertPending(void);
+
+  SceneLoader * master;
+  QuarterWidget * target;
+  SceneLoaderThread * thread;
+  QTimer * progresstimer;
+  int lastpermille;
+  bool streaming;
+  bool optimizing;
+  SoSeparator * streamroot;
+  bool streamviewall;
+};
+
+}}} // namespace
+
+#define PRIVATE(obj) obj->pimpl
+#define PUBLIC(obj) obj->master
+
+using namespace SIM::Coin3D::Quarter;
+
+/*
+  The binary scene cache. Files read through a SceneLoader are written
+  back as binary Inventor to the cache directory, named after a hash of
+  their path, modification time and size, and read from there the
+  next time. The least recently used files are evicted when the cache
+  grows beyond its size limit.
+ */
+static QMutex cachemutex;
+static QString cachedirectory;
+static qint64 cachesize = qint64(1024) * 1024 * 1024;
+
+/*
+  Guards SoInput's process-wide directory search list. Reading a cache
+  file adds the directory of the original file to it, so those reads
+  take the lock for writing. All other reads look files up through the
+  list and take it for reading, so they still run in parallel.
+ */
+static QReadWriteLock searchpathlock;
+
+/*
+  Bounds the number of loaders parsing at the same time. Each running
+  loader thread takes a ticket when it starts running, and waits for
+  its turn and for a free slot, so that the loads begin parsing in
+  the order they were started.
+ */
+static QMutex loadmutex;
+static QWaitCondition loadslotfree;
+static int maxloads = 0;
+static int runningloads = 0;
+static quint64 nextticket = 0;
+static quint64 servingticket = 0;
+
+static int
+max_concurrent_loads(void)
+{
+  return maxloads > 0 ? maxloads : SbMax(QThread::idealThreadCount(), 1);
+}
+
+static QString
+scene_cache_file(const QString & filename, bool optimized)
+{
+  QMutexLocker locker(&cachemutex);
+  if (cachedirectory.isEmpty()) return QString();
+
+  QFileInfo info(filename);
+  QString key = info.absoluteFilePath() + QLatin1Char('|') +
+    QString::number(info.lastModified().toMSecsSinceEpoch()) + QLatin1Char('|') +
+    QString::number(info.size());
+  // optimized scenes are cached apart from the scenes as read
+  if (optimized) key += QLatin1String("|optimized");
+  const QByteArray hash =
+    QCryptographicHash::hash(key.toUtf8(), QCryptographicHash::Sha1).toHex();
+  return cachedirectory + QLatin1Char('/') + QString::fromLatin1(hash) + QLatin1String(".iv");
+}
+
+static void
+scene_cache_touch(const QString & cachefile)
+{
+  // eviction goes by modification time
+#if QT_VERSION >= 0x050A00
+  QFile file(cachefile);
+  if (file.open(QIODevice::ReadWrite)) {
+    file.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+  }
+#else
+  Q_UNUSED(cachefile);
+#endif
+}
+
+static void
+scene_cache_evict(void)
+{
+  QString directory;
+  qint64 maxsize;
+  {
+    QMutexLocker locker(&cachemutex);
+    directory = cachedirectory;
+    maxsize = cachesize;
+  }
+  if (directory.isEmpty()) return;
+
+  // newest first
+  const QFileInfoList entries =
+    QDir(directory).entryInfoList(QStringList(QLatin1String("*.iv")), QDir::Files, QDir::Time);
+  qint64 total = 0;
+  for (int i = 0; i < entries.size(); i++) {
+    total += entries[i].size();
+    if (total > maxsize) {
+      QFile::remove(entries[i].absoluteFilePath());
+    }
+  }
+}
+
+static void
+scene_cache_write(SoNode * root, const QString & cachefile)
+{
+  const QFileInfo info(cachefile);
+  if (!QDir().mkpath(info.absolutePath())) return;
+
+  // write to a temporary file first, so that a concurrent reader
+  // never sees a partially written cache file
+  const QString tmpfile = cachefile + QLatin1String(".") +
+    QString::number(quintptr(QThread::currentThreadId())) + QLatin1String(".tmp");
+  SoOutput out;
+  if (!out.openFile(QFile::encodeName(tmpfile).constData())) return;
+  out.setBinary(TRUE);
+  SoWriteAction wa(&out);
+  wa.apply(root);
+  out.closeFile();
+
+  QFile::remove(cachefile);
+  if (!QFile::rename(tmpfile, cachefile)) {
+    QFile::remove(tmpfile);
+    return;
+  }
+  scene_cache_evict();
+}
+
+SoSeparator *
+SceneLoaderThread::read(SoInput & in, double total)
+{
+  // read the top level nodes one by one, like SoDB::readAll() does,
+  // to be able to report progress and cancel in between
+  SoSeparator * root = new SoSeparator;
+  root->ref();
+  bool ok = true;
+  while (!this->canceled.fetchAndAddRelaxed(0)) {
+    SoNode * node = NULL;
+    if (!SoDB::read(&in, node)) {
+      ok = false;
+      break;
+    }
+    if (node == NULL) break;
+    if (this->streaming) {
+      // handed over to the GUI thread, which attaches it to the scene
+      node->ref();
+      QMutexLocker locker(&this->pendingmutex);
+      this->pending.append(node);
+      this->streamed++;
+    }
+    else {
+      root->addChild(node);
+    }
+    if (total > 0.0) {
+      this->permille.fetchAndStoreRelaxed(int(double(in.getNumBytesRead()) * 1000.0 / total));
+    }
+  }
+
+  if (!ok || this->canceled.fetchAndAddRelaxed(0)) {
+    root->unref();
+    return NULL;
+  }
+
+  // a file with a single top level separator gives that separator as
+  // root, like SoDB::readAll()
+  if (!this->streaming && root->getNumChildren() == 1 &&
+      root->getChild(0)->isOfType(SoSeparator::getClassTypeId())) {
+    SoSeparator * child = static_cast<SoSeparator *>(root->getChild(0));
+    child->ref();
+    root->unref();
+    root = child;
+  }
+  return root;
+}
+
+void
+SceneLoaderThread::optimize(SoSeparator * root)
+{
+  SceneOptimizer optimizer;
+  optimizer.optimize(root);
+}
+
+void
+SceneLoaderThread::run(void)
+{
+  {
+    QMutexLocker locker(&loadmutex);
+    const quint64 ticket = nextticket++;
+    while (ticket != servingticket || runningloads >= max_concurrent_loads()) {
+      loadslotfree.wait(&loadmutex);
+    }
+    servingticket++;
+    runningloads++;
+    // the next in line may fit as well
+    loadslotfree.wakeAll();
+  }
+
+  // a load cancelled while waiting has nothing to do
+  if (!this->canceled.fetchAndAddRelaxed(0)) {
+    this->load();
+  }
+
+  QMutexLocker locker(&loadmutex);
+  runningloads--;
+  loadslotfree.wakeAll();
+}
+
+void
+SceneLoaderThread::load(void)
+{
+  QUARTER_TRACE_SCOPE("SceneLoader::load");
+  SoSeparator * root = NULL;
+
+  if (!this->buffer.isEmpty()) {
+    QReadLocker locker(&searchpathlock);
+    SoInput in;
+    in.setBuffer((void *) this->buffer.constData(), this->buffer.size());
+    if (!in.isValidFile()) return;
+    root = this->read(in, double(this->buffer.size()));
+    locker.unlock();
+    if (root && this->optimizing) this->optimize(root);
+  }
+  else {
+    const QString cachefile = scene_cache_file(this->filename, this->optimizing);
+    if (!cachefile.isEmpty() && QFile::exists(cachefile)) {
+      {
+        QWriteLocker locker(&searchpathlock);
+        SoInput in;
+        if (in.openFile(QFile::encodeName(cachefile).constData()) && in.isValidFile()) {
+          // relative file references in the scene are relative to the
+          // original file, not to the cache
+          const QByteArray sourcedir =
+            QFile::encodeName(QFileInfo(this->filename).absolutePath());
+          SoInput::addDirectoryFirst(sourcedir.constData());
+          root = this->read(in, double(QFileInfo(cachefile).size()));
+          SoInput::removeDirectory(sourcedir.constData());
+        }
+      }
+      if (root) {
+        scene_cache_touch(cachefile);
+      }
+      else if (!this->canceled.fetchAndAddRelaxed(0)) {
+        // unreadable cache file, fall back to the original
+        QFile::remove(cachefile);
+      }
+    }
+
+    // nodes already streamed from a broken cache file cannot be taken
+    // back, so then there is no falling back
+    if (!root && this->streamed == 0 && !this->canceled.fetchAndAddRelaxed(0)) {
+      QReadLocker locker(&searchpathlock);
+      SoInput in;
+      if (!in.openFile(QFile::encodeName(this->filename).constData())) return;
+      if (!in.isValidFile()) return;
+      // binary Inventor is no gain for, and cannot represent all of, VRML
+      const bool cacheable = !cachefile.isEmpty() && !this->streaming &&
+        !in.isFileVRML1() && !in.isFileVRML2();
+      root = this->read(in, double(QFileInfo(this->filename).size()));
+      in.closeFile();
+      locker.unlock();
+      if (root && this->optimizing && !this->canceled.fetchAndAddRelaxed(0)) {
+        this->optimize(root);
+      }
+      if (root && cacheable && !this->canceled.fetchAndAddRelaxed(0)) {
+        scene_cache_write(root, cachefile);
+      }
+    }
+  }
+
+  if (!root) return;
+  this->permille.fetchAndStoreRelaxed(1000);
+  this->root = root;
+}
+
+void
+SceneLoaderP::start(const QString & filename, const QByteArray & buffer)
+{
+  this->abandon();
+
+  this->thread = new SceneLoaderThread(filename, buffer, this->streaming && this->target,
+                                       this->optimizing);
+  this->lastpermille = -1;
+  PUBLIC(this)->connect(this->thread, SIGNAL(finished()), PUBLIC(this), SLOT(loaderFinished()));
+#ifdef COIN_THREADSAFE
+  this->thread->start();
+  this->progresstimer->start();
+#else
+  this->thread->load();
+  QTimer::singleShot(0, PUBLIC(this), SLOT(loaderFinished()));
+#endif
+}
+
+/*
+  Detaches from a running loader, which cleans up after itself once
+  it is done.
+ */
+void
+SceneLoaderP::abandon(void)
+{
+  this->progresstimer->stop();
+  if (this->streamroot) {
+    // what has been streamed so far stays in the target
+    this->streamroot->unref();
+    this->streamroot = NULL;
+  }
+  if (!this->thread) return;
+
+  this->thread->canceled.fetchAndStoreRelaxed(1);
+  this->thread->disconnect(PUBLIC(this));
+  PUBLIC(this)->connect(this->thread, SIGNAL(finished()), this->thread, SLOT(deleteLater()));
+  if (!this->thread->isRunning()) {
+    // never started, or already done
+    this->thread->deleteLater();
+  }
+  this->thread = NULL;
+}
+
+/*
+  Attaches the nodes the loader has read since the last time to the
+  streamed scene graph. The first batch sets the scene graph on the
+  target and shows all of it.
+ */
+void
+SceneLoaderP::insertPending(void)
+{
+  if (!this->thread || !this->target) return;
+  QList<SoNode *> nodes = this->thread->takePending();
+  if (nodes.isEmpty()) return;
+
+  const bool first = (this->streamroot == NULL);
+  if (first) {
+    this->streamroot = new SoSeparator;
+    this->streamroot->ref();
+  }
+  // one notification for the whole batch
+  const SbBool notify = this->streamroot->enableNotify(FALSE);
+  foreach (SoNode * node, nodes) {
+    this->streamroot->addChild(node);
+    node->unref();
+  }
+  this->streamroot->enableNotify(notify);
+
+  if (first) {
+    // without a camera in the first batch, the target adds one and
+    // fits the view to what is there, and the view is fitted again
+    // when everything is in
+    SoSearchAction sa;
+    sa.setType(SoCamera::getClassTypeId());
+    sa.setInterest(SoSearchAction::FIRST);
+    sa.apply(this->streamroot);
+    this->streamviewall = (sa.getPath() == NULL);
+    this->target->setSceneGraph(this->streamroot);
+  }
+  else {
+    this->streamroot->touch();
+  }
+}
+
+/*!
+  Constructor.
+*/
+SceneLoader::SceneLoader(QObject * parent)
+  : QObject(parent)
+{
+  PRIVATE(this) = new SceneLoaderP(this);
+  PRIVATE(this)->progresstimer = new QTimer(this);
+  PRIVATE(this)->progresstimer->setInterval(100);
+  this->connect(PRIVATE(this)->progresstimer, SIGNAL(timeout()), this, SLOT(updateProgress()));
+}
+
+/*!
+  Destructor. A load in progress is cancelled.
+*/
+SceneLoader::~SceneLoader()
+{
+  PRIVATE(this)->abandon();
+  delete PRIVATE(this);
+}
+
+/*!
+  Sets the QuarterWidget that gets the scene graph once it is
+  loaded. The default is none, in which case it is up to the
+  receiver of loaded() to use the scene graph.
+*/
+void
+SceneLoader::setTarget(QuarterWidget * target)
+{
+  PRIVATE(this)->target = target;
+}
+
+/*!
+  Returns the target QuarterWidget.
+*/
+QuarterWidget *
+SceneLoader::target(void) const
+{
+  return PRIVATE(this)->target;
+}
+
+/*!
+  Starts loading the scene graph in \a filename, cancelling any load
+  already in progress. Returns false if the file cannot be read at all.
+*/
+bool
+SceneLoader::load(const QString & filename)
+{
+  QFileInfo fileinfo(filename);
+  if (!fileinfo.isFile() || !fileinfo.isReadable()) return false;
+  // the scene may use nodekits and draggers
+  Quarter::completeInit();
+  PRIVATE(this)->start(filename, QByteArray());
+  return true;
+}
+
+/*!
+  Starts loading a scene graph from the contents of \a buffer,
+  cancelling any load already in progress.
+*/
+void
+SceneLoader::loadBuffer(const QByteArray & buffer)
+{
+  Quarter::completeInit();
+  PRIVATE(this)->start(QString(), buffer);
+}
+
+/*!
+  Enables streaming loads. The top level nodes of the input are then
+  attached to the target's scene graph in batches as they are read,
+  so that the view fills in progressively and can be navigated while
+  loading. The view is fitted to the scene once when the first batch
+  arrives and again when loading is complete. Streaming only applies
+  when a target is set, and streamed scenes are not written to the
+  scene cache. The default is off.
+
+  A cancelled or failed streaming load leaves what has been read so
+  far in the target.
+*/
+void
+SceneLoader::setStreaming(bool enable)
+{
+  PRIVATE(this)->streaming = enable;
+}
+
+/*!
+  Returns true if streaming loads are enabled.
+*/
+bool
+SceneLoader::isStreaming(void) const
+{
+  return PRIVATE(this)->streaming;
+}
+
+/*!
+  Enables optimizing loaded scene graphs with a SceneOptimizer, on the
+  worker thread, before they are set on the target. This cuts the
+  number of draw calls for scenes with many small shapes, such as
+  typical CAD exports, at the cost of a longer load. Optimized scenes
+  are written to the scene cache as such, so later loads of the same
+  file skip the optimization. Streamed loads are not optimized. The
+  default is off.
+*/
+void
+SceneLoader::setOptimizing(bool enable)
+{
+  PRIVATE(this)->optimizing = enable;
+}
+
+/*!
+  Returns true if loaded scene graphs are optimized.
+*/
+bool
+SceneLoader::isOptimizing(void) const
+{
+  return PRIVATE(this)->optimizing;
+}
+
+/*!
+  Returns true while a scene graph is being loaded.
+*/
+bool
+SceneLoader::isLoading(void) const
+{
+  return PRIVATE(this)->thread != NULL;
+}
+
+/*!
+  Cancels the load in progress. Neither loaded() nor failed() will be
+  emitted for it.
+*/
+void
+SceneLoader::cancel(void)
+{
+  PRIVATE(this)->abandon();
+}
+
+void
+SceneLoader::updateProgress(void)
+{
+  if (!PRIVATE(this)->thread) return;
+  // batches go in at the pace of the progress timer, which also
+  // bounds how often the view redraws
+  if (PRIVATE(this)->thread->isStreaming()) {
+    PRIVATE(this)->insertPending();
+  }
+  const int permille = PRIVATE(this)->thread->permille.fetchAndAddRelaxed(0);
+  if (permille != PRIVATE(this)->lastpermille) {
+    PRIVATE(this)->lastpermille = permille;
+    emit this->progress(double(permille) / 1000.0);
+  }
+}
+
+void
+SceneLoader::loaderFinished(void)
+{
+  SceneLoaderThread * thread = PRIVATE(this)->thread;
+  if (!thread) return;
+
+  PRIVATE(this)->progresstimer->stop();
+  // finished() is emitted just before the thread actually ends
+  thread->wait();
+  // also attaches the last streamed batch
+  this->updateProgress();
+  PRIVATE(this)->thread = NULL;
+  SoSeparator * root = thread->takeRoot();
+  QuarterWidget * target = PRIVATE(this)->target;
+
+  if (thread->isStreaming()) {
+    // the reader's own root is empty, the scene graph is what has
+    // been streamed to the target
+    SoSeparator * streamroot = PRIVATE(this)->streamroot;
+    PRIVATE(this)->streamroot = NULL;
+    if (root) {
+      root->unref();
+      if (streamroot) {
+        if (target && PRIVATE(this)->streamviewall) target->viewAll();
+      }
+      else {
+        // nothing in the input
+        streamroot = new SoSeparator;
+        streamroot->ref();
+        if (target) target->setSceneGraph(streamroot);
+      }
+      root = streamroot;
+    }
+    else if (streamroot) {
+      streamroot->unref();
+    }
+    delete thread;
+    if (!root) {
+      emit this->failed();
+      return;
+    }
+    emit this->loaded(root);
+    root->unrefNoDelete();
+    return;
+  }
+  delete thread;
+
+  if (!root) {
+    emit this->failed();
+    return;
+  }
+
+  if (target) {
+    target->setSceneGraph(root);
+#if (QT_VERSION >= 0x060000)
+    target->update();
+#else
+    target->updateGL();
+#endif
+  }
+  emit this->loaded(root);
+  // like with SoDB::readAll(), whoever wants to keep the scene graph
+  // must ref it
+  root->unrefNoDelete();
+}
+
+/*!
+  Sets the maximum number of loaders that parse at the same time,
+  across all SceneLoader instances. Loads started beyond it wait for a
+  running one to finish. Zero, the default, means the number of
+  processor cores.
+*/
+void
+SceneLoader::setMaxConcurrentLoads(int count)
+{
+  QMutexLocker locker(&loadmutex);
+  maxloads = SbMax(count, 0);
+  loadslotfree.wakeAll();
+}
+
+/*!
+  Returns the maximum number of loaders that parse at the same time.
+*/
+int
+SceneLoader::maxConcurrentLoads(void)
+{
+  QMutexLocker locker(&loadmutex);
+  return max_concurrent_loads();
+}
+
+/*!
+  Enables the binary scene cache, storing files in \a path. Files
+  loaded from disk are then also written as binary Inventor to the
+  cache, and subsequent loads of an unchanged file read the binary
+  version, which Coin parses much faster. VRML files are not cached.
+  Relative file references in a cached scene still resolve against
+  the directory of the original file. An empty path, the default,
+  disables the cache.
+*/
+void
+SceneLoader::setCacheDirectory(const QString & path)
+{
+  QMutexLocker locker(&cachemutex);
+  cachedirectory = path;
+}
+
+/*!
+  Returns the scene cache directory, or an empty string if the cache
+  is disabled.
+*/
+QString
+SceneLoader::cacheDirectory(void)
+{
+  QMutexLocker locker(&cachemutex);
+  return cachedirectory;
+}
+
+/*!
+  Sets the maximum total size in bytes of the scene cache. The least
+  recently used files are removed to stay within it. The default is
+  1 GB.
+*/
+void
+SceneLoader::setCacheSize(qint64 bytes)
+{
+  {
+    QMutexLocker locker(&cachemutex);
+    cachesize = bytes;
+  }
+  scene_cache_evict();
+}
+
+/*!
+  Returns the maximum total size in bytes of the scene cache.
+*/
+qint64
+SceneLoader::cacheSize(void)
+{
+  QMutexLocker locker(&cachemutex);
+  return cachesize;
+}
+
+/*!
+  \fn void SceneLoader::progress(double fraction)
+
+  Emitted periodically while loading, with the fraction of the input
+  parsed so far.
+*/
+
+/*!
+  \fn void SceneLoader::loaded(SoNode * root)
+
+  Emitted on the GUI thread when a scene graph has been loaded, after
+  it has been set on the target QuarterWidget. The reference count of
+  \a root is zero, as for SoDB::readAll(); ref it to keep it.
+*/
+
+/*!
+  \fn void SceneLoader::failed(void)
+
+  Emitted when the input could not be read.
+*/
+
+#undef PRIVATE
+#undef PUBLIC
@@ -0,0 +1,992 @@
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+/*!
+  \class SIM::Coin3D::Quarter::SceneOptimizer SceneOptimizer.h Quarter/SceneOptimizer.h
+
+  \brief The SceneOptimizer class rewrites a scene graph so it
+  renders with fewer draw calls.
+
+  Files exported from CAD systems often hold thousands of small
+  SoIndexedFaceSet nodes, each in a separator of its own with a
+  material and an SoCoordinate3. optimize() rewrites such scenes in
+  place, in these passes:
+
+  \li STRIP_STATE flattens plain SoGroup nodes into their parents,
+  removes empty groups and separators, property nodes at the end of a
+  separator, and coordinate, normal, texture coordinate and binding
+  nodes which are replaced by another one of the same type right
+  after them.
+
+  \li CONVERT_VERTEX_PROPERTY moves the coordinates of an
+  SoCoordinate3 into an SoVertexProperty on each SoIndexedFaceSet in
+  the same separator which uses them, and removes the SoCoordinate3
+  when nothing else does.
+
+  \li MERGE_SHAPES merges adjacent face sets, and adjacent separators
+  holding the same property nodes and one face set each, into a
+  single face set.
+
+  \li REORDER_INDICES reorders the triangles of triangle face sets for
+  the post-transform vertex cache, and renumbers their vertices in the
+  order they are first used.
+
+  Only face sets which carry all of their vertex data in an
+  SoVertexProperty, with per vertex indexed or overall bindings and
+  no explicit normal, material or texture coordinate indices, are
+  merged or reordered. Those are also the face sets Coin renders
+  from vertex buffer objects. Named nodes, nodes with connected
+  fields, nodes with more than one parent, the insides of nodekits,
+  and the children of groups other than SoGroup and SoSeparator, such
+  as switches and LODs, are not restructured, though separators below
+  them are optimized. Only the children of switches that are
+  traversed when the scene is rendered are merged.
+
+  The scene graph must not be rendered or changed elsewhere while it
+  is optimized, so optimize() is typically called right after
+  reading it, see SceneLoader::setOptimizing(). Generated normals are
+  computed for a merged face set as a whole, so coincident vertices
+  of formerly separate shapes may be smoothed together where the
+  crease angle allows it.
+*/
+
+#include <Quarter/SceneOptimizer.h>
+
+#include <math.h>
+
+#include <QtCore/QHash>
+#include <QtCore/QSet>
+#include <QtCore/QVector>
+
+#include <Inventor/SbVec2s.h>
+#include <Inventor/actions/SoCallbackAction.h>
+#include <Inventor/actions/SoSearchAction.h>
+#include <Inventor/fields/SoField.h>
+#include <Inventor/lists/SoFieldList.h>
+#include <Inventor/misc/SoChildList.h>
+#include <Inventor/nodekits/SoBaseKit.h>
+#include <Inventor/nodes/SoBaseColor.h>
+#include <Inventor/nodes/SoComplexity.h>
+#include <Inventor/nodes/SoCoordinate3.h>
+#include <Inventor/nodes/SoDrawStyle.h>
+#include <Inventor/nodes/SoIndexedFaceSet.h>
+#include <Inventor/nodes/SoMaterial.h>
+#include <Inventor/nodes/SoMaterialBinding.h>
+#include <Inventor/nodes/SoMatrixTransform.h>
+#include <Inventor/nodes/SoNormal.h>
+#include <Inventor/nodes/SoNormalBinding.h>
+#include <Inventor/nodes/SoRotation.h>
+#include <Inventor/nodes/SoRotationXYZ.h>
+#include <Inventor/nodes/SoScale.h>
+#include <Inventor/nodes/SoSeparator.h>
+#include <Inventor/nodes/SoShape.h>
+#include <Inventor/nodes/SoShapeHints.h>
+#include <Inventor/nodes/SoTextureCoordinate2.h>
+#include <Inventor/nodes/SoTransform.h>
+#include <Inventor/nodes/SoTranslation.h>
+#include <Inventor/nodes/SoVertexProperty.h>
+
+#include "Trace.h"
+
+// merged face sets are not grown beyond this many vertices, so that
+// they can still be culled
+static const int MAX_MERGED_VERTICES = 1 << 20;
+// of the modelled post-transform vertex cache
+static const int VERTEX_CACHE_SIZE = 32;
+
+namespace SIM { namespace Coin3D { namespace Quarter {
+
+class SceneOptimizerP {
+public:
+  // the traversal state a face set is rendered with
+  struct ShapeState {
+    int materialbinding;
+    int normalbinding;
+    int numnormals;
+    bool textured;
+    // consistent over all traversals of the face set
+    bool unique;
+  };
+
+  SceneOptimizerP(void) {
+    this->passes = SceneOptimizer::ALL_PASSES;
+    this->shapesbefore = 0;
+    this->shapesafter = 0;
+  }
+
+  void walk(SoNode * node, int pass);
+  void optimizeGroup(SoGroup * group, int pass);
+  void flatten(SoGroup * group);
+  void convert(SoSeparator * separator);
+  void merge(SoGroup * group);
+  void stripState(SoGroup * group);
+  void collectStates(SoNode * root);
+  void releaseStates(void);
+  bool mergeable(SoIndexedFaceSet * a, SoIndexedFaceSet * b) const;
+  bool mergeableSeparators(SoSeparator * a, SoSeparator * b) const;
+
+  static SoCallbackAction::Response shapeCB(void * closure, SoCallbackAction * action,
+                                            const SoNode * node);
+
+  int passes;
+  int shapesbefore;
+  int shapesafter;
+  QSet<SoNode *> visited;
+  // face sets are ref'ed while they are in here
+  QHash<SoIndexedFaceSet *, ShapeState> states;
+};
+
+}}} // namespace
+
+using namespace SIM::Coin3D::Quarter;
+
+#define PRIVATE(obj) obj->pimpl
+
+static int
+count_shapes(SoNode * root)
+{
+  SoSearchAction sa;
+  sa.setType(SoShape::getClassTypeId());
+  sa.setInterest(SoSearchAction::ALL);
+  sa.setSearchingAll(TRUE);
+  sa.apply(root);
+  return sa.getPaths().getLength();
+}
+
+static bool
+has_connections(SoFieldContainer * container)
+{
+  SoFieldList fields;
+  const int num = container->getFields(fields);
+  for (int i = 0; i < num; i++) {
+    if (fields[i]->isConnected()) return true;
+  }
+  return false;
+}
+
+/*
+  Returns true if \a node may be changed or removed without affecting
+  anything but its single parent. \a extrarefs are held by the
+  optimizer itself.
+ */
+static bool
+is_private(SoNode * node, int extrarefs = 0)
+{
+  return node->getRefCount() == 1 + extrarefs &&
+    node->getName().getLength() == 0 && !has_connections(node);
+}
+
+// the groups whose children can be rearranged
+static bool
+is_plain_group(SoNode * node)
+{
+  return node->getTypeId() == SoGroup::getClassTypeId() ||
+    node->getTypeId() == SoSeparator::getClassTypeId();
+}
+
+// property nodes which only affect the nodes after them
+static bool
+is_pure_property(SoNode * node)
+{
+  const SoType type = node->getTypeId();
+  return type == SoMaterial::getClassTypeId() ||
+    type == SoBaseColor::getClassTypeId() ||
+    type == SoCoordinate3::getClassTypeId() ||
+    type == SoNormal::getClassTypeId() ||
+    type == SoNormalBinding::getClassTypeId() ||
+    type == SoMaterialBinding::getClassTypeId() ||
+    type == SoTextureCoordinate2::getClassTypeId() ||
+    type == SoShapeHints::getClassTypeId() ||
+    type == SoDrawStyle::getClassTypeId() ||
+    type == SoComplexity::getClassTypeId() ||
+    type == SoTransform::getClassTypeId() ||
+    type == SoTranslation::getClassTypeId() ||
+    type == SoRotation::getClassTypeId() ||
+    type == SoRotationXYZ::getClassTypeId() ||
+    type == SoScale::getClassTypeId() ||
+    type == SoMatrixTransform::getClassTypeId();
+}
+
+// property nodes which replace all of what the previous one of the
+// same type set
+static bool
+is_replacing_property(SoNode * node)
+{
+  const SoType type = node->getTypeId();
+  if (type != SoCoordinate3::getClassTypeId() &&
+      type != SoNormal::getClassTypeId() &&
+      type != SoTextureCoordinate2::getClassTypeId() &&
+      type != SoNormalBinding::getClassTypeId() &&
+      type != SoMaterialBinding::getClassTypeId()) {
+    return false;
+  }
+  SoFieldList fields;
+  const int num = node->getFields(fields);
+  for (int i = 0; i < num; i++) {
+    if (fields[i]->isIgnored()) return false;
+  }
+  return true;
+}
+
+static bool
+is_exact_faceset(SoNode * node)
+{
+  return node->getTypeId() == SoIndexedFaceSet::getClassTypeId();
+}
+
+static SoVertexProperty *
+get_vertex_property(SoIndexedFaceSet * faceset)
+{
+  SoNode * node = faceset->vertexProperty.getValue();
+  if (!node || node->getTypeId() != SoVertexProperty::getClassTypeId()) return NULL;
+  return static_cast<SoVertexProperty *>(node);
+}
+
+static bool
+is_mergeable_binding(int binding)
+{
+  return binding == SoVertexProperty::OVERALL || binding == SoVertexProperty::PER_VERTEX_INDEXED;
+}
+
+/*
+  Returns true if \a faceset takes all of its vertex data from its
+  vertex property, indexed by its coordinate indices, so that its
+  vertices can be renumbered and appended to.
+ */
+static bool
+is_self_contained(SoIndexedFaceSet * faceset, const SceneOptimizerP::ShapeState & state)
+{
+  SoVertexProperty * vp = get_vertex_property(faceset);
+  if (!vp || !state.unique) return false;
+  if (vp->getRefCount() != 1 || has_connections(vp) || has_connections(faceset)) return false;
+  if (vp->vertex.getNum() == 0 || vp->texCoord3.getNum() > 0) return false;
+  if (faceset->normalIndex.getNum() > 0 || faceset->materialIndex.getNum() > 0 ||
+      faceset->textureCoordIndex.getNum() > 0) {
+    return false;
+  }
+  if (vp->normal.getNum() > 0) {
+    if (!is_mergeable_binding(vp->normalBinding.getValue())) return false;
+  }
+  else if (state.numnormals > 0) {
+    // normals from the traversal state would be indexed by coordIndex
+    return false;
+  }
+  if (vp->orderedRGBA.getNum() > 0) {
+    if (!is_mergeable_binding(vp->materialBinding.getValue())) return false;
+  }
+  else if (state.materialbinding != SoMaterialBinding::OVERALL) {
+    return false;
+  }
+  // generated texture coordinates depend on the bounding box
+  if (vp->texCoord.getNum() == 0 && state.textured) return false;
+
+  const int numvertices = vp->vertex.getNum();
+  const int numindices = faceset->coordIndex.getNum();
+  const int32_t * indices = faceset->coordIndex.getValues(0);
+  for (int i = 0; i < numindices; i++) {
+    if (indices[i] >= numvertices) return false;
+  }
+  return true;
+}
+
+template <class Field, class Value>
+static void
+resize_values(Field & field, int num, const Value & fill)
+{
+  const int old = field.getNum();
+  if (old == num) return;
+  if (old > num) {
+    field.deleteValues(num);
+    return;
+  }
+  field.setNum(num);
+  Value * values = field.startEditing();
+  for (int i = old; i < num; i++) values[i] = fill;
+  field.finishEditing();
+}
+
+/*
+  Makes each per vertex attribute array of \a vp as long as the vertex
+  array, so that both can be appended to and renumbered together.
+ */
+static void
+pad_attributes(SoVertexProperty * vp)
+{
+  const int num = vp->vertex.getNum();
+  if (vp->normal.getNum() > 0 &&
+      vp->normalBinding.getValue() == SoVertexProperty::PER_VERTEX_INDEXED) {
+    resize_values(vp->normal, num, SbVec3f(0.0f, 0.0f, 1.0f));
+  }
+  if (vp->orderedRGBA.getNum() > 0 &&
+      vp->materialBinding.getValue() == SoVertexProperty::PER_VERTEX_INDEXED) {
+    resize_values(vp->orderedRGBA, num, vp->orderedRGBA[vp->orderedRGBA.getNum() - 1]);
+  }
+  if (vp->texCoord.getNum() > 0) {
+    resize_values(vp->texCoord, num, SbVec2f(0.0f, 0.0f));
+  }
+}
+
+/*
+  Appends the vertices and faces of \a src to \a dst. Both must be self
+  contained and mergeable.
+ */
+static void
+merge_facesets(SoIndexedFaceSet * dst, SoIndexedFaceSet * src)
+{
+  SoVertexProperty * dvp = get_vertex_property(dst);
+  SoVertexProperty * svp = get_vertex_property(src);
+  pad_attributes(dvp);
+  pad_attributes(svp);
+
+  const int offset = dvp->vertex.getNum();
+  const int numvertices = svp->vertex.getNum();
+  dvp->vertex.setValues(offset, numvertices, svp->vertex.getValues(0));
+  if (dvp->normalBinding.getValue() == SoVertexProperty::PER_VERTEX_INDEXED &&
+      svp->normal.getNum() > 0) {
+    dvp->normal.setValues(offset, numvertices, svp->normal.getValues(0));
+  }
+  if (dvp->materialBinding.getValue() == SoVertexProperty::PER_VERTEX_INDEXED &&
+      svp->orderedRGBA.getNum() > 0) {
+    dvp->orderedRGBA.setValues(offset, numvertices, svp->orderedRGBA.getValues(0));
+  }
+  if (svp->texCoord.getNum() > 0) {
+    dvp->texCoord.setValues(offset, numvertices, svp->texCoord.getValues(0));
+  }
+
+  const int start = dst->coordIndex.getNum();
+  const int separator = (start > 0 && dst->coordIndex[start - 1] >= 0) ? 1 : 0;
+  const int num = src->coordIndex.getNum();
+  const int32_t * in = src->coordIndex.getValues(0);
+  dst->coordIndex.setNum(start + separator + num);
+  int32_t * out = dst->coordIndex.startEditing() + start;
+  if (separator) *out++ = -1;
+  for (int i = 0; i < num; i++) {
+    out[i] = in[i] < 0 ? -1 : in[i] + offset;
+  }
+  dst->coordIndex.finishEditing();
+}
+
+static float
+vertex_score(int cacheposition, int valence)
+{
+  if (valence <= 0) return -1.0f;
+  float score = 0.0f;
+  if (cacheposition >= 0) {
+    if (cacheposition < 3) {
+      // the last triangle's vertices, which it does not pay to reuse
+      // right away
+      score = 0.75f;
+    }
+    else {
+      const float scale = 1.0f / float(VERTEX_CACHE_SIZE - 3);
+      score = powf(1.0f - float(cacheposition - 3) * scale, 1.5f);
+    }
+  }
+  // prefer vertices with few triangles left, to finish off islands
+  return score + 2.0f * powf(float(valence), -0.5f);
+}
+
+/*
+  Reorders \a triangles for a post-transform vertex cache, after Tom
+  Forsyth's "Linear-Speed Vertex Cache Optimisation".
+ */
+static void
+reorder_triangles(QVector<int32_t> & triangles, int numvertices)
+{
+  const int numtriangles = triangles.size() / 3;
+  if (numtriangles < 2) return;
+
+  // the triangles using each vertex, the ones not yet emitted first
+  QVector<int> offsets(numvertices + 1, 0);
+  for (int i = 0; i < triangles.size(); i++) offsets[triangles[i] + 1]++;
+  for (int v = 0; v < numvertices; v++) offsets[v + 1] += offsets[v];
+  QVector<int> live(numvertices, 0);
+  QVector<int> vertextriangles(triangles.size());
+  for (int t = 0; t < numtriangles; t++) {
+    for (int k = 0; k < 3; k++) {
+      const int v = triangles[t * 3 + k];
+      vertextriangles[offsets[v] + live[v]++] = t;
+    }
+  }
+
+  QVector<int> cacheposition(numvertices, -1);
+  QVector<float> vscore(numvertices);
+  for (int v = 0; v < numvertices; v++) vscore[v] = vertex_score(-1, live[v]);
+  QVector<float> tscore(numtriangles);
+  QVector<bool> emitted(numtriangles, false);
+  int best = 0;
+  for (int t = 0; t < numtriangles; t++) {
+    tscore[t] = vscore[triangles[t * 3]] + vscore[triangles[t * 3 + 1]] +
+      vscore[triangles[t * 3 + 2]];
+    if (tscore[t] > tscore[best]) best = t;
+  }
+
+  QVector<int32_t> result;
+  result.reserve(triangles.size());
+  QVector<int> cache, newcache;
+  int next = 0;
+  while (result.size() < triangles.size()) {
+    if (best < 0) {
+      // nothing in the cache has triangles left, start somewhere new
+      while (emitted[next]) next++;
+      best = next;
+    }
+    emitted[best] = true;
+    newcache.clear();
+    for (int k = 0; k < 3; k++) {
+      const int v = triangles[best * 3 + k];
+      result.append(v);
+      newcache.append(v);
+      // move the triangle out of the vertex's live triangles
+      int * list = vertextriangles.data() + offsets[v];
+      for (int i = 0; i < live[v]; i++) {
+        if (list[i] == best) {
+          list[i] = list[--live[v]];
+          list[live[v]] = best;
+          break;
+        }
+      }
+    }
+    for (int i = 0; i < cache.size(); i++) {
+      if (!newcache.contains(cache[i])) newcache.append(cache[i]);
+    }
+    for (int i = VERTEX_CACHE_SIZE; i < newcache.size(); i++) {
+      cacheposition[newcache[i]] = -1;
+      vscore[newcache[i]] = vertex_score(-1, live[newcache[i]]);
+    }
+    if (newcache.size() > VERTEX_CACHE_SIZE) newcache.resize(VERTEX_CACHE_SIZE);
+    cache.swap(newcache);
+
+    for (int i = 0; i < cache.size(); i++) {
+      cacheposition[cache[i]] = i;
+      vscore[cache[i]] = vertex_score(i, live[cache[i]]);
+    }
+    best = -1;
+    float bestscore = -1.0f;
+    for (int i = 0; i < cache.size(); i++) {
+      const int v = cache[i];
+      const int * list = vertextriangles.constData() + offsets[v];
+      for (int j = 0; j < live[v]; j++) {
+        const int t = list[j];
+        tscore[t] = vscore[triangles[t * 3]] + vscore[triangles[t * 3 + 1]] +
+          vscore[triangles[t * 3 + 2]];
+        if (tscore[t] > bestscore) {
+          bestscore = tscore[t];
+          best = t;
+        }
+      }
+    }
+  }
+  triangles.swap(result);
+}
+
+template <class Field, class Value>
+static void
+permute_values(Field & field, const QVector<int> & order)
+{
+  if (field.getNum() != order.size()) return;
+  QVector<Value> copy(order.size());
+  const Value * values = field.getValues(0);
+  for (int i = 0; i < order.size(); i++) copy[i] = values[order[i]];
+  field.setValues(0, copy.size(), copy.constData());
+}
+
+/*
+  Reorders the triangles of \a faceset for the vertex cache and
+  renumbers its vertices in the order they are used. Face sets with
+  other polygons than triangles are left alone.
+ */
+static void
+reorder_faceset(SoIndexedFaceSet * faceset)
+{
+  SoVertexProperty * vp = get_vertex_property(faceset);
+  const int numvertices = vp->vertex.getNum();
+  const int num = faceset->coordIndex.getNum();
+  const int32_t * indices = faceset->coordIndex.getValues(0);
+
+  QVector<int32_t> triangles;
+  triangles.reserve(num);
+  int facesize = 0;
+  for (int i = 0; i < num; i++) {
+    if (indices[i] < 0) {
+      if (facesize != 3) return;
+      facesize = 0;
+      continue;
+    }
+    if (++facesize > 3) return;
+    triangles.append(indices[i]);
+  }
+  if (facesize != 0 && facesize != 3) return;
+  if (triangles.isEmpty()) return;
+
+  reorder_triangles(triangles, numvertices);
+
+  // new vertex numbers by first use, unused vertices go last so the
+  // bounding box stays the same
+  QVector<int> newindex(numvertices, -1);
+  QVector<int> order;
+  order.reserve(numvertices);
+  for (int i = 0; i < triangles.size(); i++) {
+    if (newindex[triangles[i]] < 0) {
+      newindex[triangles[i]] = order.size();
+      order.append(triangles[i]);
+    }
+  }
+  for (int v = 0; v < numvertices; v++) {
+    if (newindex[v] < 0) {
+      newindex[v] = order.size();
+      order.append(v);
+    }
+  }
+
+  pad_attributes(vp);
+  permute_values<SoMFVec3f, SbVec3f>(vp->vertex, order);
+  if (vp->normalBinding.getValue() == SoVertexProperty::PER_VERTEX_INDEXED) {
+    permute_values<SoMFVec3f, SbVec3f>(vp->normal, order);
+  }
+  if (vp->materialBinding.getValue() == SoVertexProperty::PER_VERTEX_INDEXED) {
+    permute_values<SoMFUInt32, uint32_t>(vp->orderedRGBA, order);
+  }
+  permute_values<SoMFVec2f, SbVec2f>(vp->texCoord, order);
+
+  const int numtriangles = triangles.size() / 3;
+  faceset->coordIndex.setNum(numtriangles * 4);
+  int32_t * out = faceset->coordIndex.startEditing();
+  for (int t = 0; t < numtriangles; t++) {
+    out[t * 4] = newindex[triangles[t * 3]];
+    out[t * 4 + 1] = newindex[triangles[t * 3 + 1]];
+    out[t * 4 + 2] = newindex[triangles[t * 3 + 2]];
+    out[t * 4 + 3] = -1;
+  }
+  faceset->coordIndex.finishEditing();
+}
+
+/*
+  Runs \a pass on the groups below \a node, children first. Each node
+  is visited once, even if it has several parents.
+ */
+void
+SceneOptimizerP::walk(SoNode * node, int pass)
+{
+  if (this->visited.contains(node)) return;
+  this->visited.insert(node);
+  if (node->isOfType(SoBaseKit::getClassTypeId())) return;
+  SoChildList * children = node->getChildren();
+  if (!children) return;
+
+  for (int i = 0; i < children->getLength(); i++) {
+    this->walk((*children)[i], pass);
+  }
+  if (is_plain_group(node)) {
+    this->optimizeGroup(static_cast<SoGroup *>(node), pass);
+  }
+}
+
+void
+SceneOptimizerP::optimizeGroup(SoGroup * group, int pass)
+{
+  switch (pass) {
+  case SceneOptimizer::STRIP_STATE:
+    this->stripState(group);
+    break;
+  case SceneOptimizer::CONVERT_VERTEX_PROPERTY:
+    if (group->isOfType(SoSeparator::getClassTypeId())) {
+      this->convert(static_cast<SoSeparator *>(group));
+    }
+    break;
+  case SceneOptimizer::MERGE_SHAPES:
+    this->merge(group);
+    break;
+  default:
+    break;
+  }
+}
+
+/*
+  Replaces the plain SoGroup children of \a group by their children,
+  and removes empty groups and separators.
+ */
+void
+SceneOptimizerP::flatten(SoGroup * group)
+{
+  for (int i = 0; i < group->getNumChildren(); i++) {
+    SoNode * child = group->getChild(i);
+    if (!is_plain_group(child) || !is_private(child)) continue;
+    SoGroup * childgroup = static_cast<SoGroup *>(child);
+    if (childgroup->getNumChildren() == 0) {
+      group->removeChild(i--);
+      continue;
+    }
+    if (child->getTypeId() != SoGroup::getClassTypeId()) continue;
+    childgroup->ref();
+    group->removeChild(i);
+    for (int j = 0; j < childgroup->getNumChildren(); j++) {
+      group->insertChild(childgroup->getChild(j), i + j);
+    }
+    childgroup->unref();
+    // the moved children are looked at again
+    i--;
+  }
+}
+
+/*
+  Moves the coordinates of the SoCoordinate3 children of \a separator
+  into vertex properties of the face sets after them, and removes the
+  SoCoordinate3 nodes nothing else uses.
+ */
+void
+SceneOptimizerP::convert(SoSeparator * separator)
+{
+  SoCoordinate3 * coords = NULL;
+  int coordsindex = -1;
+  bool coordsused = false;
+  for (int i = 0; i <= separator->getNumChildren(); i++) {
+    SoNode * child = i < separator->getNumChildren() ? separator->getChild(i) : NULL;
+    const bool newcoords = child && child->getTypeId() == SoCoordinate3::getClassTypeId();
+    if (!child || newcoords) {
+      if (coords && !coordsused && is_private(coords)) {
+        separator->removeChild(coordsindex);
+        i--;
+      }
+      coords = NULL;
+      if (!child) break;
+      coords = static_cast<SoCoordinate3 *>(child);
+      coordsindex = i;
+      coordsused = has_connections(coords) || coords->point.isIgnored();
+      continue;
+    }
+    if (!coords) continue;
+
+    if (is_exact_faceset(child) && is_private(child)) {
+      SoIndexedFaceSet * faceset = static_cast<SoIndexedFaceSet *>(child);
+      if (faceset->vertexProperty.getValue() == NULL) {
+        SoVertexProperty * vp = new SoVertexProperty;
+        vp->vertex = coords->point;
+        faceset->vertexProperty = vp;
+        continue;
+      }
+    }
+    // anything else might use the coordinates
+    if (child->isOfType(SoShape::getClassTypeId()) || child->getChildren() ||
+        !is_pure_property(child)) {
+      coordsused = true;
+    }
+  }
+}
+
+/*
+  Returns true if \a b can be appended to \a a.
+ */
+bool
+SceneOptimizerP::mergeable(SoIndexedFaceSet * a, SoIndexedFaceSet * b) const
+{
+  if (!this->states.contains(a) || !this->states.contains(b)) return false;
+  const ShapeState & sa = this->states[a];
+  const ShapeState & sb = this->states[b];
+  if (sa.materialbinding != sb.materialbinding || sa.normalbinding != sb.normalbinding ||
+      sa.numnormals != sb.numnormals || sa.textured != sb.textured) {
+    return false;
+  }
+  // the optimizer holds a reference to each face set in states
+  if (!is_private(a, 1) || !is_private(b, 1)) return false;
+  if (!is_self_contained(a, sa) || !is_self_contained(b, sb)) return false;
+
+  SoVertexProperty * va = get_vertex_property(a);
+  SoVertexProperty * vb = get_vertex_property(b);
+  if (va->vertex.getNum() + vb->vertex.getNum() > MAX_MERGED_VERTICES) return false;
+  if ((va->normal.getNum() > 0) != (vb->normal.getNum() > 0) ||
+      (va->orderedRGBA.getNum() > 0) != (vb->orderedRGBA.getNum() > 0) ||
+      (va->texCoord.getNum() > 0) != (vb->texCoord.getNum() > 0)) {
+    return false;
+  }
+  if (va->normal.getNum() > 0) {
+    if (va->normalBinding.getValue() != vb->normalBinding.getValue()) return false;
+    if (va->normalBinding.getValue() == SoVertexProperty::OVERALL &&
+        va->normal[0] != vb->normal[0]) {
+      return false;
+    }
+  }
+  if (va->orderedRGBA.getNum() > 0) {
+    if (va->materialBinding.getValue() != vb->materialBinding.getValue()) return false;
+    if (va->materialBinding.getValue() == SoVertexProperty::OVERALL &&
+        va->orderedRGBA[0] != vb->orderedRGBA[0]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/*
+  Returns true if the separators \a a and \a b hold the same property
+  nodes followed by a face set each, and so render the same but for
+  their geometry.
+ */
+bool
+SceneOptimizerP::mergeableSeparators(SoSeparator * a, SoSeparator * b) const
+{
+  if (!is_private(a) || !is_private(b) || !a->fieldsAreEqual(b)) return false;
+  const int num = a->getNumChildren();
+  if (num == 0 || b->getNumChildren() != num) return false;
+  for (int i = 0; i < num - 1; i++) {
+    SoNode * ca = a->getChild(i);
+    SoNode * cb = b->getChild(i);
+    if (ca == cb) continue;
+    if (ca->getTypeId() != cb->getTypeId() || !is_pure_property(ca)) return false;
+    if (has_connections(ca) || has_connections(cb) || !ca->fieldsAreEqual(cb)) return false;
+  }
+  SoNode * la = a->getChild(num - 1);
+  SoNode * lb = b->getChild(num - 1);
+  return is_exact_faceset(la) && is_exact_faceset(lb) &&
+    this->mergeable(static_cast<SoIndexedFaceSet *>(la), static_cast<SoIndexedFaceSet *>(lb));
+}
+
+/*
+  Merges runs of adjacent face sets, and of adjacent separators which
+  differ only in the geometry of their face set, among the children
+  of \a group.
+ */
+void
+SceneOptimizerP::merge(SoGroup * group)
+{
+  for (int i = 0; i + 1 < group->getNumChildren(); i++) {
+    SoNode * child = group->getChild(i);
+    if (is_exact_faceset(child)) {
+      SoIndexedFaceSet * dst = static_cast<SoIndexedFaceSet *>(child);
+      while (i + 1 < group->getNumChildren()) {
+        SoNode * next = group->getChild(i + 1);
+        if (!is_exact_faceset(next) ||
+            !this->mergeable(dst, static_cast<SoIndexedFaceSet *>(next))) {
+          break;
+        }
+        merge_facesets(dst, static_cast<SoIndexedFaceSet *>(next));
+        group->removeChild(i + 1);
+      }
+    }
+    else if (child->getTypeId() == SoSeparator::getClassTypeId()) {
+      SoSeparator * dst = static_cast<SoSeparator *>(child);
+      while (i + 1 < group->getNumChildren()) {
+        SoNode * next = group->getChild(i + 1);
+        if (next->getTypeId() != SoSeparator::getClassTypeId() ||
+            !this->mergeableSeparators(dst, static_cast<SoSeparator *>(next))) {
+          break;
+        }
+        SoSeparator * src = static_cast<SoSeparator *>(next);
+        const int last = dst->getNumChildren() - 1;
+        merge_facesets(static_cast<SoIndexedFaceSet *>(dst->getChild(last)),
+                       static_cast<SoIndexedFaceSet *>(src->getChild(last)));
+        group->removeChild(i + 1);
+      }
+    }
+  }
+}
+
+/*
+  Removes property nodes which have no effect: those replaced by the
+  next sibling, and, in separators, those after the last node they
+  could affect.
+ */
+void
+SceneOptimizerP::stripState(SoGroup * group)
+{
+  this->flatten(group);
+  for (int i = 0; i + 1 < group->getNumChildren(); i++) {
+    SoNode * child = group->getChild(i);
+    SoNode * next = group->getChild(i + 1);
+    if (child->getTypeId() == next->getTypeId() && is_replacing_property(next) &&
+        is_private(child)) {
+      group->removeChild(i--);
+    }
+  }
+  if (group->getTypeId() == SoSeparator::getClassTypeId()) {
+    for (int i = group->getNumChildren() - 1; i >= 0; i--) {
+      SoNode * child = group->getChild(i);
+      if (!is_pure_property(child) || child->getName().getLength() > 0) break;
+      group->removeChild(i);
+    }
+  }
+}
+
+SoCallbackAction::Response
+SceneOptimizerP::shapeCB(void * closure, SoCallbackAction * action, const SoNode * node)
+{
+  SceneOptimizerP * thisp = static_cast<SceneOptimizerP *>(closure);
+  SoIndexedFaceSet * faceset = const_cast<SoIndexedFaceSet *>(static_cast<const SoIndexedFaceSet *>(node));
+  if (!is_exact_faceset(faceset)) return SoCallbackAction::CONTINUE;
+
+  ShapeState state;
+  state.materialbinding = action->getMaterialBinding();
+  state.normalbinding = action->getNormalBinding();
+  state.numnormals = action->getNumNormals();
+  SbVec2s size(0, 0);
+  int numcomponents = 0;
+  state.textured = action->getTextureImage(size, numcomponents) != NULL &&
+    size[0] > 0 && size[1] > 0;
+  state.unique = true;
+
+  QHash<SoIndexedFaceSet *, ShapeState>::iterator it = thisp->states.find(faceset);
+  if (it == thisp->states.end()) {
+    faceset->ref();
+    thisp->states.insert(faceset, state);
+  }
+  else if (it.value().materialbinding != state.materialbinding ||
+           it.value().normalbinding != state.normalbinding ||
+           it.value().numnormals != state.numnormals ||
+           it.value().textured != state.textured) {
+    it.value().unique = false;
+  }
+  return SoCallbackAction::CONTINUE;
+}
+
+/*
+  Records the traversal state each face set is rendered with.
+ */
+void
+SceneOptimizerP::collectStates(SoNode * root)
+{
+  SoCallbackAction action;
+  action.addPreCallback(SoIndexedFaceSet::getClassTypeId(), SceneOptimizerP::shapeCB, this);
+  action.apply(root);
+}
+
+void
+SceneOptimizerP::releaseStates(void)
+{
+  QHash<SoIndexedFaceSet *, ShapeState>::iterator it = this->states.begin();
+  for (; it != this->states.end(); ++it) {
+    it.key()->unref();
+  }
+  this->states.clear();
+}
+
+/*!
+  Constructor. All passes are enabled.
+*/
+SceneOptimizer::SceneOptimizer(void)
+{
+  PRIVATE(this) = new SceneOptimizerP;
+}
+
+/*!
+  Destructor.
+*/
+SceneOptimizer::~SceneOptimizer()
+{
+  delete PRIVATE(this);
+}
+
+/*!
+  Sets the passes optimize() runs, as a bitwise combination of the
+  Pass values. The default is ALL_PASSES.
+*/
+void
+SceneOptimizer::setPasses(int passes)
+{
+  PRIVATE(this)->passes = passes;
+}
+
+/*!
+  Returns the passes optimize() runs.
+*/
+int
+SceneOptimizer::passes(void) const
+{
+  return PRIVATE(this)->passes;
+}
+
+/*!
+  Optimizes the scene graph below \a root in place. \a root itself is
+  kept, so references to it stay valid. Returns true if the number of
+  shapes went down.
+*/
+bool
+SceneOptimizer::optimize(SoNode * root)
+{
+  QUARTER_TRACE_SCOPE("SceneOptimizer::optimize");
+  PRIVATE(this)->shapesbefore = PRIVATE(this)->shapesafter = 0;
+  if (!root) return false;
+
+  root->ref();
+  PRIVATE(this)->shapesbefore = count_shapes(root);
+  const int passes = PRIVATE(this)->passes;
+  const int order[] = {
+    STRIP_STATE, CONVERT_VERTEX_PROPERTY, MERGE_SHAPES, STRIP_STATE
+  };
+  for (unsigned int i = 0; i < sizeof(order) / sizeof(order[0]); i++) {
+    if (!(passes & order[i])) continue;
+    if (order[i] == MERGE_SHAPES) {
+      PRIVATE(this)->collectStates(root);
+    }
+    PRIVATE(this)->visited.clear();
+    PRIVATE(this)->walk(root, order[i]);
+  }
+  PRIVATE(this)->visited.clear();
+
+  if (passes & REORDER_INDICES) {
+    if (PRIVATE(this)->states.isEmpty()) {
+      PRIVATE(this)->collectStates(root);
+    }
+    QHash<SoIndexedFaceSet *, SceneOptimizerP::ShapeState>::const_iterator it =
+      PRIVATE(this)->states.constBegin();
+    for (; it != PRIVATE(this)->states.constEnd(); ++it) {
+      // merged into another face set, or shared
+      if (!is_private(it.key(), 1)) continue;
+      if (is_self_contained(it.key(), it.value())) reorder_faceset(it.key());
+    }
+  }
+  PRIVATE(this)->releaseStates();
+
+  PRIVATE(this)->shapesafter = count_shapes(root);
+  root->unrefNoDelete();
+  return PRIVATE(this)->shapesafter < PRIVATE(this)->shapesbefore;
+}
+
+/*!
+  Returns the number of shapes in the scene graph before the last
+  call to optimize().
+*/
+int
+SceneOptimizer::getShapeCountBefore(void) const
+{
+  return PRIVATE(this)->shapesbefore;
+}
+
+/*!
+  Returns the number of shapes in the scene graph after the last call
+  to optimize().
+*/
+int
+SceneOptimizer::getShapeCountAfter(void) const
+{
+  return PRIVATE(this)->shapesafter;
+}
+
+#undef PRIVATE
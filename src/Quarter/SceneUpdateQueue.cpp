@@ -0,0 +1,209 @@
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+/*!
+  \class SIM::Coin3D::Quarter::SceneUpdateQueue SceneUpdateQueue.h Quarter/SceneUpdateQueue.h
+
+  \brief The SceneUpdateQueue class lets any thread queue field edits
+  that the GUI thread applies in one batch.
+
+  Setting fields of a scene graph shown in a QuarterWidget from a
+  worker thread needs SoDB::writelock(), and every set notifies the
+  scene graph. With a SceneUpdateQueue, worker threads post edits
+  instead:
+
+  \code
+  SceneUpdateQueue::setValue(&transform->translation, SbVec3f(x, y, z));
+  SceneUpdateQueue::setValues(&coords->point, 0, points);
+  \endcode
+
+  Posting does not block. The GUI thread applies all queued edits
+  in order, once per pass over the Coin delay queue, before widgets
+  redraw. It holds the write lock while doing so, with notification
+  turned off, and then notifies each edited field once. Whatever the
+  nodes are, they must be kept alive until their edits have been
+  applied. Using the queue from other threads needs a thread safe
+  Coin.
+
+  Custom edits can be posted by subclassing SceneEdit.
+*/
+
+#include <Quarter/SceneUpdateQueue.h>
+
+#include <QtCore/QAtomicPointer>
+#include <QtCore/QSet>
+
+#include <Inventor/SoDB.h>
+#include <Inventor/fields/SoField.h>
+#include <Inventor/sensors/SoOneShotSensor.h>
+
+#include "QuarterP.h"
+#include "RenderThread.h"
+
+using namespace SIM::Coin3D::Quarter;
+
+// a lock free stack, newest edit first, that flush() takes over as a
+// whole
+static QAtomicPointer<SceneEdit> queuehead;
+
+/*!
+  Constructor. The edit is for \a field.
+*/
+SceneEdit::SceneEdit(SoField * field)
+  : field(field), next(NULL)
+{
+}
+
+/*!
+  Destructor.
+*/
+SceneEdit::~SceneEdit()
+{
+}
+
+/*!
+  \fn void SceneEdit::apply(void)
+
+  Applies the edit to the field. Called on the GUI thread, with
+  notification of the field turned off.
+*/
+
+/*!
+  Queues \a edit, and takes ownership of it. Can be called from any
+  thread.
+*/
+void
+SceneUpdateQueue::post(SceneEdit * edit)
+{
+  SceneEdit * top;
+  do {
+#if QT_VERSION >= 0x050000
+    top = queuehead.loadAcquire();
+#else
+    top = queuehead;
+#endif
+    edit->next = top;
+  } while (!queuehead.testAndSetRelease(top, edit));
+
+  // only the first edit after a flush needs to wake up the GUI
+  // thread. Scheduling the sensor from another thread goes through
+  // the SensorManager's cross thread path.
+  if (top == NULL && QuarterP::sceneupdatesensor) {
+    QuarterP::sceneupdatesensor->schedule();
+  }
+}
+
+/*!
+  Applies all queued edits, in the order they were posted. This is
+  done automatically on the GUI thread; call it directly to have the
+  edits applied right away.
+*/
+void
+SceneUpdateQueue::flush(void)
+{
+  SceneEdit * edit = queuehead.fetchAndStoreAcquire(NULL);
+  if (!edit) return;
+
+  SceneEdit * fifo = NULL;
+  while (edit) {
+    SceneEdit * next = edit->next;
+    edit->next = fifo;
+    fifo = edit;
+    edit = next;
+  }
+
+  QVector<SoField *> touched;
+  QSet<SoField *> seen;
+  // nests in the lock the GUI thread holds while running sensors for
+  // render threads
+  RenderThread::lockScene(true);
+  while (fifo) {
+    SoField * field = fifo->getField();
+    const SbBool notify = field->enableNotify(FALSE);
+    fifo->apply();
+    field->enableNotify(notify);
+    if (notify && !seen.contains(field)) {
+      seen.insert(field);
+      touched.append(field);
+    }
+    SceneEdit * next = fifo->next;
+    delete fifo;
+    fifo = next;
+  }
+  RenderThread::unlockScene();
+
+  // one notification per edited field
+  for (int i = 0; i < touched.size(); i++) {
+    touched[i]->touch();
+  }
+}
+
+/*!
+  Discards all queued edits without applying them.
+*/
+void
+SceneUpdateQueue::clear(void)
+{
+  SceneEdit * edit = queuehead.fetchAndStoreAcquire(NULL);
+  while (edit) {
+    SceneEdit * next = edit->next;
+    delete edit;
+    edit = next;
+  }
+}
+
+/*!
+  Returns true if no edits are queued.
+*/
+bool
+SceneUpdateQueue::isEmpty(void)
+{
+#if QT_VERSION >= 0x050000
+  return queuehead.loadAcquire() == NULL;
+#else
+  return queuehead == NULL;
+#endif
+}
+
+/*!
+  \fn void SceneUpdateQueue::setValue(FieldType * field, const ValueType & value)
+
+  Queues setting single value field \a field to \a value.
+*/
+
+/*!
+  \fn void SceneUpdateQueue::setValues(FieldType * field, int start, const QVector<ValueType> & values, bool truncate)
+
+  Queues setting the values of multiple value field \a field from
+  index \a start on to \a values. If \a truncate is true, the field
+  is cut off after the last of them.
+*/
@@ -31,7 +31,11 @@
 \**************************************************************************/
 
 #include "SensorManager.h"
+#include "RenderThread.h"
+#include "SensorProfiler.h"
+#include "Trace.h"
 
+#include <QtCore/QMetaObject>
 #include <QtCore/QTimer>
 
 #include <Inventor/SoDB.h>
@@ -39,7 +43,6 @@
 #include <Inventor/SoRenderManager.h>
 #include <Inventor/nodekits/SoNodeKit.h>
 #include <Inventor/C/threads/thread.h>
-#include "SignalThread.h"
 
 using namespace SIM::Coin3D::Quarter;
 
@@ -47,10 +50,6 @@ SensorManager::SensorManager(void)
   : inherited()
 {
   this->mainthreadid = cc_thread_id();
-  this->signalthread = new SignalThread();
-
-  QObject::connect(this->signalthread, SIGNAL(triggerSignal()),
-                   this, SLOT(sensorQueueChanged()));
 
   this->idletimer = new QTimer;
   this->delaytimer = new QTimer;
@@ -66,6 +65,7 @@ SensorManager::SensorManager(void)
 
   SoDB::getSensorManager()->setChangedCallback(SensorManager::sensorQueueChangedCB, this);
   this->timerEpsilon = 1.0 / 5000.0;
+  this->batchtime = 0.0;
 
   SoDB::setRealTimeInterval(1.0 / 25.0);
   SoRenderManager::enableRealTimeUpdate(FALSE);
@@ -75,12 +75,6 @@ SensorManager::~SensorManager()
 {
   // remove the Coin callback before shutting down
   SoDB::getSensorManager()->setChangedCallback(NULL, NULL);
-
-  if (this->signalthread->isRunning()) {
-    this->signalthread->stopThread();
-    this->signalthread->wait();
-  }
-  delete this->signalthread;
   delete this->idletimer;
   delete this->delaytimer;
   delete this->timerqueuetimer;
@@ -91,18 +85,29 @@ SensorManager::sensorQueueChangedCB(void * closure)
 {
   SensorManager * thisp = (SensorManager * ) closure;
 
-  // if we get a callback from another thread, route the callback
-  // through SignalThread so that we receive the callback in the
-  // QApplication thread (needed since QTimer isn't thread safe)
+  // if we get a callback from another thread, post it to the
+  // QApplication thread (needed since QTimer isn't thread safe). Only
+  // the first change since the last time it was handled posts an
+  // event, so any number of changes costs one event loop hop.
   if (cc_thread_id() != thisp->mainthreadid) {
-    if (!thisp->signalthread->isRunning()) thisp->signalthread->start();
-    thisp->signalthread->trigger();
+    if (thisp->changepending.testAndSetOrdered(0, 1)) {
+      QMetaObject::invokeMethod(thisp, "crossThreadChange", Qt::QueuedConnection);
+    }
   }
   else {
     thisp->sensorQueueChanged();
   }
 }
 
+void
+SensorManager::crossThreadChange(void)
+{
+  // cleared first, so that changes made while handling this one post
+  // a new event
+  this->changepending.fetchAndStoreOrdered(0);
+  this->sensorQueueChanged();
+}
+
 void
 SensorManager::sensorQueueChanged(void)
 {
@@ -143,26 +148,51 @@ SensorManager::sensorQueueChanged(void)
   }
 }
 
+/*
+  Runs the delay queue. Coin runs a pass over the queue as a unit;
+  sensors scheduled while it runs are left for the next pass. With a
+  batch time set, further passes are run until the queue is empty or
+  the batch time has passed. This never ends a pass early, so it
+  trades a longer blocking of the event loop for fewer ticks.
+ */
+void
+SensorManager::processDelayQueue(bool isidle)
+{
+  SoSensorManager * sensormanager = SoDB::getSensorManager();
+  const SbTime start = SbTime::getTimeOfDay();
+  // the sensors change scene graphs that render threads may traverse
+  RenderThread::lockScene();
+  do {
+    SensorProfiler::processTimerQueue();
+    SensorProfiler::processDelayQueue(isidle ? TRUE : FALSE);
+  } while (this->batchtime > 0.0 && sensormanager->isDelaySensorPending() &&
+           (SbTime::getTimeOfDay() - start).getValue() < this->batchtime);
+  RenderThread::unlockScene();
+}
+
 void
 SensorManager::idleTimeout(void)
 {
-  SoDB::getSensorManager()->processTimerQueue();
-  SoDB::getSensorManager()->processDelayQueue(TRUE);
+  QUARTER_TRACE_SCOPE("SensorManager::idleTimeout");
+  this->processDelayQueue(true);
   this->sensorQueueChanged();
 }
 
 void
 SensorManager::timerQueueTimeout(void)
 {
-  SoDB::getSensorManager()->processTimerQueue();
+  QUARTER_TRACE_SCOPE("SensorManager::timerQueueTimeout");
+  RenderThread::lockScene();
+  SensorProfiler::processTimerQueue();
+  RenderThread::unlockScene();
   this->sensorQueueChanged();
 }
 
 void
 SensorManager::delayTimeout(void)
 {
-  SoDB::getSensorManager()->processTimerQueue();
-  SoDB::getSensorManager()->processDelayQueue(FALSE);
+  QUARTER_TRACE_SCOPE("SensorManager::delayTimeout");
+  this->processDelayQueue(false);
   this->sensorQueueChanged();
 }
 
@@ -171,3 +201,35 @@ SensorManager::setTimerEpsilon(double sec)
 {
   this->timerEpsilon = sec;
 }
+
+void
+SensorManager::setDelayQueueBatchTime(double sec)
+{
+  this->batchtime = sec;
+}
+
+/*
+  In refresh driven mode, realTime is updated by the render managers
+  before each frame instead of by a 25 Hz timer. Animations then
+  advance once per frame, at the refresh rate of the screen the
+  widget is on, and when nothing listens to realTime, nothing wakes
+  up. The timer queue timer is made precise, so that timer sensors
+  are not subject to the coarse timers' jitter.
+ */
+void
+SensorManager::setRefreshDrivenRealTime(bool onoff)
+{
+  if (onoff) {
+    SoDB::setRealTimeInterval(SbTime::zero());
+    SoRenderManager::enableRealTimeUpdate(TRUE);
+  }
+  else {
+    SoDB::setRealTimeInterval(1.0 / 25.0);
+    SoRenderManager::enableRealTimeUpdate(FALSE);
+  }
+#if QT_VERSION >= 0x050000
+  this->timerqueuetimer->setTimerType(onoff ? Qt::PreciseTimer : Qt::CoarseTimer);
+#endif
+  // the realtime sensor may have been added or removed
+  this->sensorQueueChanged();
+}
@@ -34,13 +34,12 @@
 \**************************************************************************/
 
 #include <QtCore/QObject>
+#include <QtCore/QAtomicInt>
 
 class QTimer;
 
 namespace SIM { namespace Coin3D { namespace Quarter {
 
-class SignalThread;
-
 class SensorManager : public QObject {
   Q_OBJECT
   typedef QObject inherited;
@@ -54,15 +53,22 @@ public slots:
   void timerQueueTimeout(void);
   void sensorQueueChanged(void);
   void setTimerEpsilon(double sec);
+  void setDelayQueueBatchTime(double sec);
+  void setRefreshDrivenRealTime(bool onoff);
+
+private slots:
+  void crossThreadChange(void);
 
 private:
   static void sensorQueueChangedCB(void * closure);
+  void processDelayQueue(bool isidle);
   QTimer * idletimer;
   QTimer * delaytimer;
   QTimer * timerqueuetimer;
   unsigned long mainthreadid;
-  SignalThread * signalthread;
+  QAtomicInt changepending;
   double timerEpsilon;
+  double batchtime;
 };
 
 }}} // namespace
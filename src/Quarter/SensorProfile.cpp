@@ -0,0 +1,168 @@
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+#include <Quarter/SensorProfile.h>
+
+using namespace SIM::Coin3D::Quarter;
+
+/*!
+  \class SIM::Coin3D::Quarter::SensorProfile SensorProfile.h Quarter/SensorProfile.h
+
+  \brief The SensorProfile class holds the time spent in sensor
+  callbacks while Quarter processes Coin's sensor queues.
+
+  Each entry sums up the callbacks of the sensors of one type attached
+  to one node, or of a sensor registered with
+  Quarter::addProfiledSensor(). Time spent in the timer queue while
+  the realTime global field is updated is listed under "realTime",
+  along with the engines and nodes connected to it, since that is
+  where engine networks driven by realTime are notified. Time in
+  callbacks of sensors Quarter does not know about, e.g. Coin's own,
+  is listed as unattributed for each queue.
+
+  Engines are evaluated when their outputs are read, which mostly
+  happens during rendering. That time is part of FrameStatistics'
+  RENDER timing, not of the profile.
+
+  All times are given in seconds.
+
+  \sa Quarter::setSensorProfilingEnabled(), Quarter::sensorProfile()
+*/
+
+/*!
+  \enum SIM::Coin3D::Quarter::SensorProfile::Queue
+
+  The sensor queues processed by Quarter.
+
+  \li \b DELAY_QUEUE delay queue passes, from the idle and delay
+  timeouts and from paintGL()
+  \li \b TIMER_QUEUE timer queue passes
+*/
+
+/*!
+  \class SIM::Coin3D::Quarter::SensorProfile::Entry SensorProfile.h Quarter/SensorProfile.h
+
+  \brief The time spent in the callbacks of one sensor type on one
+  node, or of one registered sensor.
+
+  \a sensor is the sensor class or the label it was registered with,
+  and \a attachment describes what the sensor is attached to.
+*/
+
+SensorProfile::Entry::Entry(void)
+  : calls(0), total(0.0), maximum(0.0)
+{
+}
+
+/*!
+  Returns the mean time per callback.
+*/
+double
+SensorProfile::Entry::average(void) const
+{
+  return this->calls > 0 ? this->total / this->calls : 0.0;
+}
+
+SensorProfile::SensorProfile(void)
+  : durationvalue(0.0)
+{
+  for (int i = 0; i < NUM_QUEUES; i++) {
+    this->numpasses[i] = 0;
+    this->queuetime[i] = 0.0;
+  }
+}
+
+/*!
+  Returns the time since profiling was enabled or last reset.
+*/
+double
+SensorProfile::duration(void) const
+{
+  return this->durationvalue;
+}
+
+/*!
+  Returns the number of times \a queue has been processed.
+*/
+int
+SensorProfile::numPasses(Queue queue) const
+{
+  return this->numpasses[queue];
+}
+
+/*!
+  Returns the total time spent processing \a queue.
+*/
+double
+SensorProfile::queueTime(Queue queue) const
+{
+  return this->queuetime[queue];
+}
+
+/*!
+  Returns the entries, the one with the most total time first.
+*/
+QList<SensorProfile::Entry>
+SensorProfile::entries(void) const
+{
+  return this->entrylist;
+}
+
+/*!
+  Returns a text summary with the queue times and the \a maxentries
+  most expensive entries, one line each, as shown in the performance
+  HUD.
+*/
+QStringList
+SensorProfile::summary(int maxentries) const
+{
+  QStringList lines;
+  const int delaypasses = this->numpasses[DELAY_QUEUE];
+  const int timerpasses = this->numpasses[TIMER_QUEUE];
+  lines << QString("Sensors: delay queue %1 ms/pass (%2)  timer queue %3 ms/pass (%4)")
+    .arg(delaypasses ? this->queuetime[DELAY_QUEUE] * 1000.0 / delaypasses : 0.0, 0, 'f', 2)
+    .arg(delaypasses)
+    .arg(timerpasses ? this->queuetime[TIMER_QUEUE] * 1000.0 / timerpasses : 0.0, 0, 'f', 2)
+    .arg(timerpasses);
+
+  for (int i = 0; i < this->entrylist.size() && i < maxentries; i++) {
+    const Entry & entry = this->entrylist[i];
+    QString name = entry.sensor;
+    if (!entry.attachment.isEmpty()) name += " on " + entry.attachment;
+    lines << QString("  %1 ms avg  %2 ms max  %3 calls  %4")
+      .arg(entry.average() * 1000.0, 0, 'f', 2)
+      .arg(entry.maximum * 1000.0, 0, 'f', 2)
+      .arg(entry.calls)
+      .arg(name);
+  }
+  return lines;
+}
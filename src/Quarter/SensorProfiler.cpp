@@ -0,0 +1,485 @@
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+/*
+  The SensorProfiler measures the time spent in sensor callbacks while
+  Quarter processes Coin's sensor queues. Coin does not tell which
+  sensors it triggers, so the profiler finds the sensors attached to
+  the nodes of the shown scene graphs by their auditor lists, and
+  replaces their callbacks with one that times the original. The
+  scene graphs are scanned again at most once per second, to pick up
+  new sensors. Sensors registered with Quarter::addProfiledSensor(),
+  like timer sensors, which cannot be found that way, are wrapped in
+  the same manner.
+
+  What the wrapped callbacks do not account for in a pass over a
+  queue is attributed to the realTime update when the realTime field
+  changed during a timer queue pass, and is reported as unattributed
+  otherwise. Callbacks are restored when profiling is disabled.
+  A wrapped sensor which has left the scanned scenes keeps calling
+  back through its record, so records are only deleted when their
+  sensor is unwrapped. Those still in use when the profiler is
+  deleted are kept for the life of the process, and call the original
+  callbacks straight through.
+ */
+
+#include "SensorProfiler.h"
+#include "QuarterP.h"
+
+#include <QtCore/QMap>
+#include <QtCore/QPair>
+#include <QtCore/QStringList>
+
+#include <algorithm>
+
+#include <Inventor/SoDB.h>
+#include <Inventor/SoRenderManager.h>
+#include <Inventor/engines/SoEngine.h>
+#include <Inventor/engines/SoEngineOutput.h>
+#include <Inventor/fields/SoSFTime.h>
+#include <Inventor/lists/SoAuditorList.h>
+#include <Inventor/lists/SoEngineOutputList.h>
+#include <Inventor/lists/SoFieldList.h>
+#include <Inventor/misc/SoChildList.h>
+#include <Inventor/nodes/SoNode.h>
+#include <Inventor/sensors/SoAlarmSensor.h>
+#include <Inventor/sensors/SoFieldSensor.h>
+#include <Inventor/sensors/SoIdleSensor.h>
+#include <Inventor/sensors/SoNodeSensor.h>
+#include <Inventor/sensors/SoOneShotSensor.h>
+#include <Inventor/sensors/SoPathSensor.h>
+#include <Inventor/sensors/SoSensorManager.h>
+#include <Inventor/sensors/SoTimerSensor.h>
+
+using namespace SIM::Coin3D::Quarter;
+
+static const double RESCAN_INTERVAL = 1.0;
+
+static QString
+sensorName(SoSensor * sensor)
+{
+  if (dynamic_cast<SoNodeSensor *>(sensor)) return "SoNodeSensor";
+  if (dynamic_cast<SoPathSensor *>(sensor)) return "SoPathSensor";
+  if (dynamic_cast<SoFieldSensor *>(sensor)) return "SoFieldSensor";
+  if (dynamic_cast<SoDataSensor *>(sensor)) return "SoDataSensor";
+  if (dynamic_cast<SoOneShotSensor *>(sensor)) return "SoOneShotSensor";
+  if (dynamic_cast<SoIdleSensor *>(sensor)) return "SoIdleSensor";
+  if (dynamic_cast<SoTimerSensor *>(sensor)) return "SoTimerSensor";
+  if (dynamic_cast<SoAlarmSensor *>(sensor)) return "SoAlarmSensor";
+  return "SoSensor";
+}
+
+static QString
+describeNode(SoNode * node)
+{
+  const QString type(node->getTypeId().getName().getString());
+  const SbName name = node->getName();
+  if (name.getLength() > 0) {
+    return QString("%1 '%2'").arg(type).arg(name.getString());
+  }
+  return QString("%1 0x%2").arg(type).arg(quintptr(node), 0, 16);
+}
+
+static bool
+moreTime(const SensorProfile::Entry & a, const SensorProfile::Entry & b)
+{
+  return a.total > b.total;
+}
+
+SensorProfiler::SensorProfiler(void)
+  : isenabled(false), starttime(0.0), lastscan(0.0), scanneeded(true),
+    depth(0), attributed(0.0)
+{
+  this->clock.start();
+  for (int i = 0; i < 2; i++) {
+    this->numpasses[i] = 0;
+    this->queuetime[i] = 0.0;
+  }
+}
+
+SensorProfiler::~SensorProfiler()
+{
+  this->setEnabled(false);
+  // FIXME: static memory leak, the sensors not found by the last scan
+  // may still call back through their records
+  foreach (Record * record, this->records) {
+    record->profiler = NULL;
+  }
+}
+
+void
+SensorProfiler::setEnabled(bool onoff)
+{
+  if (onoff == this->isenabled) return;
+
+  if (onoff) {
+    this->isenabled = true;
+    this->reset();
+    this->scanneeded = true;
+    QHash<SoSensor *, QString>::const_iterator it = this->labels.constBegin();
+    for (; it != this->labels.constEnd(); ++it) {
+      this->wrap(it.key(), QString("label 0x%1").arg(quintptr(it.key()), 0, 16),
+                 it.value(), QString());
+    }
+  }
+  else {
+    this->scan(true);
+    foreach (SoSensor * sensor, this->labels.keys()) {
+      this->unwrap(sensor);
+    }
+    this->isenabled = false;
+  }
+}
+
+bool
+SensorProfiler::enabled(void) const
+{
+  return this->isenabled;
+}
+
+void
+SensorProfiler::reset(void)
+{
+  this->entries.clear();
+  for (int i = 0; i < 2; i++) {
+    this->numpasses[i] = 0;
+    this->queuetime[i] = 0.0;
+  }
+  this->starttime = this->now();
+}
+
+SensorProfile
+SensorProfiler::profile(void) const
+{
+  SensorProfile result;
+  result.durationvalue = this->isenabled ? this->now() - this->starttime : 0.0;
+  for (int i = 0; i < 2; i++) {
+    result.numpasses[i] = this->numpasses[i];
+    result.queuetime[i] = this->queuetime[i];
+  }
+  result.entrylist = this->entries.values();
+  std::sort(result.entrylist.begin(), result.entrylist.end(), moreTime);
+  return result;
+}
+
+/*
+  The sensor must be removed again before it is deleted.
+ */
+void
+SensorProfiler::addSensor(SoSensor * sensor, const QString & label)
+{
+  this->labels.insert(sensor, label);
+  if (this->isenabled) {
+    this->wrap(sensor, QString("label 0x%1").arg(quintptr(sensor), 0, 16), label, QString());
+  }
+}
+
+void
+SensorProfiler::removeSensor(SoSensor * sensor)
+{
+  if (this->labels.remove(sensor)) {
+    this->unwrap(sensor);
+  }
+}
+
+void
+SensorProfiler::renderManagerChanged(SoRenderManager * old, SoRenderManager * manager)
+{
+  SensorProfiler * profiler = QuarterP::sensorprofiler;
+  if (!profiler) return;
+
+  if (old) {
+    // the scene may outlive the render manager
+    if (profiler->isenabled && old->getSceneGraph()) {
+      QSet<SoNode *> visited;
+      profiler->scanNode(old->getSceneGraph(), visited, true);
+    }
+    profiler->managers.removeAll(old);
+  }
+  if (manager && !profiler->managers.contains(manager)) {
+    profiler->managers.append(manager);
+  }
+  profiler->scanneeded = true;
+}
+
+void
+SensorProfiler::processDelayQueue(SbBool isidle)
+{
+  SensorProfiler * profiler = QuarterP::sensorprofiler;
+  SoSensorManager * sensormanager = SoDB::getSensorManager();
+  // passes started from within a profiled callback are part of it
+  if (!profiler || !profiler->isenabled || profiler->depth > 0) {
+    sensormanager->processDelayQueue(isidle);
+    return;
+  }
+
+  profiler->beginPass();
+  const double start = profiler->now();
+  sensormanager->processDelayQueue(isidle);
+  profiler->endPass(SensorProfile::DELAY_QUEUE, start, false);
+}
+
+void
+SensorProfiler::processTimerQueue(void)
+{
+  SensorProfiler * profiler = QuarterP::sensorprofiler;
+  SoSensorManager * sensormanager = SoDB::getSensorManager();
+  if (!profiler || !profiler->isenabled || profiler->depth > 0) {
+    sensormanager->processTimerQueue();
+    return;
+  }
+
+  SoField * field = SoDB::getGlobalField("realTime");
+  SoSFTime * realtime = (field && field->isOfType(SoSFTime::getClassTypeId())) ?
+    (SoSFTime *) field : NULL;
+  const SbTime before = realtime ? realtime->getValue() : SbTime::zero();
+
+  profiler->beginPass();
+  const double start = profiler->now();
+  sensormanager->processTimerQueue();
+  profiler->endPass(SensorProfile::TIMER_QUEUE, start,
+                    realtime && realtime->getValue() != before);
+}
+
+void
+SensorProfiler::sensorCB(void * data, SoSensor * sensor)
+{
+  Record * record = (Record *) data;
+  SensorProfiler * profiler = record->profiler;
+  // only the outermost callback is timed, nested ones are part of it
+  if (!profiler || !profiler->isenabled || profiler->depth > 0 ||
+      !profiler->records.contains(record)) {
+    record->func(record->data, sensor);
+    return;
+  }
+
+  // the callback may remove the sensor, and with it the record
+  const QString key = record->key;
+  const QString name = record->sensor;
+  const QString attachment = record->attachment;
+
+  profiler->depth++;
+  const double start = profiler->now();
+  record->func(record->data, sensor);
+  const double time = profiler->now() - start;
+  profiler->depth--;
+
+  profiler->attributed += time;
+  profiler->account(key, name, attachment, time);
+}
+
+double
+SensorProfiler::now(void) const
+{
+  return this->clock.nsecsElapsed() * 1e-9;
+}
+
+void
+SensorProfiler::beginPass(void)
+{
+  if (this->scanneeded || this->now() - this->lastscan >= RESCAN_INTERVAL) {
+    this->scan(false);
+  }
+  this->attributed = 0.0;
+}
+
+void
+SensorProfiler::endPass(SensorProfile::Queue queue, double start, bool realtimechanged)
+{
+  const double total = this->now() - start;
+  this->numpasses[queue]++;
+  this->queuetime[queue] += total;
+
+  const double rest = total - this->attributed;
+  if (rest <= 0.0) return;
+  if (realtimechanged) {
+    this->account("realtime", "realTime update", this->realtimeattachment, rest);
+  }
+  else if (queue == SensorProfile::DELAY_QUEUE) {
+    this->account("unattributed delay", "Unattributed delay queue", QString(), rest);
+  }
+  else {
+    this->account("unattributed timer", "Unattributed timer queue", QString(), rest);
+  }
+}
+
+void
+SensorProfiler::account(const QString & key, const QString & sensor,
+                        const QString & attachment, double time)
+{
+  SensorProfile::Entry & entry = this->entries[key];
+  if (entry.calls == 0) {
+    entry.sensor = sensor;
+    entry.attachment = attachment;
+  }
+  entry.calls++;
+  entry.total += time;
+  entry.maximum = qMax(entry.maximum, time);
+}
+
+void
+SensorProfiler::scan(bool unwrap)
+{
+  QSet<SoNode *> visited;
+  foreach (SoRenderManager * manager, this->managers) {
+    SoNode * root = manager->getSceneGraph();
+    if (root) this->scanNode(root, visited, unwrap);
+  }
+  if (!unwrap) {
+    this->realtimeattachment = this->describeRealTime();
+    this->lastscan = this->now();
+    this->scanneeded = false;
+  }
+}
+
+void
+SensorProfiler::scanNode(SoNode * node, QSet<SoNode *> & visited, bool unwrap)
+{
+  if (visited.contains(node)) return;
+  visited.insert(node);
+
+  const SoAuditorList & auditors = node->getAuditors();
+  for (int i = 0; i < auditors.getLength(); i++) {
+    if (auditors.getType(i) != SoNotRec::SENSOR) continue;
+    SoDataSensor * sensor = (SoDataSensor *) auditors.getObject(i);
+    if (this->labels.contains(sensor)) continue;
+
+    if (unwrap) {
+      this->unwrap(sensor);
+    }
+    else {
+      // one entry per sensor type and node
+      const QString name = sensorName(sensor);
+      this->wrap(sensor, QString("%1 0x%2").arg(name).arg(quintptr(node), 0, 16),
+                 name, describeNode(node));
+    }
+  }
+
+  SoChildList * children = node->getChildren();
+  if (children) {
+    for (int i = 0; i < children->getLength(); i++) {
+      this->scanNode((*children)[i], visited, unwrap);
+    }
+  }
+}
+
+void
+SensorProfiler::wrap(SoSensor * sensor, const QString & key,
+                     const QString & name, const QString & attachment)
+{
+  if (sensor->getFunction() == SensorProfiler::sensorCB) {
+    Record * record = (Record *) sensor->getData();
+    if (this->records.contains(record)) {
+      record->key = key;
+      record->sensor = name;
+      record->attachment = attachment;
+    }
+    return;
+  }
+  if (sensor->getFunction() == NULL) return;
+
+  Record * record = new Record;
+  record->profiler = this;
+  record->func = sensor->getFunction();
+  record->data = sensor->getData();
+  record->key = key;
+  record->sensor = name;
+  record->attachment = attachment;
+  this->records.insert(record);
+
+  sensor->setFunction(SensorProfiler::sensorCB);
+  sensor->setData(record);
+}
+
+void
+SensorProfiler::unwrap(SoSensor * sensor)
+{
+  if (sensor->getFunction() != SensorProfiler::sensorCB) return;
+  Record * record = (Record *) sensor->getData();
+  if (!this->records.contains(record)) return;
+
+  sensor->setFunction(record->func);
+  sensor->setData(record->data);
+  this->records.remove(record);
+  delete record;
+}
+
+/*
+  Lists the engines and nodes notified when realTime changes, by
+  following the connections from realTime through the engine
+  network, e.g. "12 engines and nodes: SoElapsedTime x10, SoRotor x2".
+ */
+QString
+SensorProfiler::describeRealTime(void) const
+{
+  SoField * realtime = SoDB::getGlobalField("realTime");
+  if (!realtime) return QString();
+
+  QList<SoField *> pending;
+  SoFieldList forward;
+  realtime->getForwardConnections(forward);
+  for (int i = 0; i < forward.getLength(); i++) pending.append(forward[i]);
+
+  QSet<SoFieldContainer *> visited;
+  QMap<QString, int> counts;
+  while (!pending.isEmpty()) {
+    SoFieldContainer * container = pending.takeLast()->getContainer();
+    if (!container || visited.contains(container)) continue;
+    visited.insert(container);
+    counts[container->getTypeId().getName().getString()]++;
+
+    if (container->isOfType(SoEngine::getClassTypeId())) {
+      SoEngineOutputList outputs;
+      ((SoEngine *) container)->getOutputs(outputs);
+      for (int i = 0; i < outputs.getLength(); i++) {
+        SoFieldList connections;
+        outputs[i]->getForwardConnections(connections);
+        for (int j = 0; j < connections.getLength(); j++) pending.append(connections[j]);
+      }
+    }
+  }
+  if (visited.isEmpty()) return QString();
+
+  QList<QPair<int, QString> > types;
+  QMap<QString, int>::const_iterator it = counts.constBegin();
+  for (; it != counts.constEnd(); ++it) {
+    types.append(qMakePair(-it.value(), it.key()));
+  }
+  std::sort(types.begin(), types.end());
+
+  QStringList parts;
+  for (int i = 0; i < types.size() && i < 4; i++) {
+    parts << QString("%1 x%2").arg(types[i].second).arg(-types[i].first);
+  }
+  if (types.size() > 4) parts << "...";
+  return QString("%1 engines and nodes: %2").arg(visited.size()).arg(parts.join(", "));
+}
@@ -0,0 +1,113 @@
+#ifndef QUARTER_SENSORPROFILER_H
+#define QUARTER_SENSORPROFILER_H
+
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QHash>
+#include <QtCore/QList>
+#include <QtCore/QSet>
+#include <QtCore/QString>
+
+#include <Inventor/SbBasic.h>
+#include <Inventor/sensors/SoSensor.h>
+
+#include <Quarter/SensorProfile.h>
+
+class SoNode;
+class SoRenderManager;
+
+namespace SIM { namespace Coin3D { namespace Quarter {
+
+class SensorProfiler {
+public:
+  SensorProfiler(void);
+  ~SensorProfiler();
+
+  void setEnabled(bool onoff);
+  bool enabled(void) const;
+  void reset(void);
+  SensorProfile profile(void) const;
+
+  void addSensor(SoSensor * sensor, const QString & label);
+  void removeSensor(SoSensor * sensor);
+
+  static void renderManagerChanged(SoRenderManager * old, SoRenderManager * manager);
+  static void processDelayQueue(SbBool isidle);
+  static void processTimerQueue(void);
+
+private:
+  struct Record {
+    SensorProfiler * profiler;
+    SoSensorCB * func;
+    void * data;
+    QString key;
+    QString sensor;
+    QString attachment;
+  };
+
+  static void sensorCB(void * data, SoSensor * sensor);
+
+  double now(void) const;
+  void beginPass(void);
+  void endPass(SensorProfile::Queue queue, double start, bool realtimechanged);
+  void account(const QString & key, const QString & sensor,
+               const QString & attachment, double time);
+
+  void scan(bool unwrap);
+  void scanNode(SoNode * node, QSet<SoNode *> & visited, bool unwrap);
+  void wrap(SoSensor * sensor, const QString & key,
+            const QString & name, const QString & attachment);
+  void unwrap(SoSensor * sensor);
+  QString describeRealTime(void) const;
+
+  bool isenabled;
+  QElapsedTimer clock;
+  double starttime;
+  double lastscan;
+  bool scanneeded;
+  int depth;
+  double attributed;
+  QString realtimeattachment;
+
+  QList<SoRenderManager *> managers;
+  QSet<Record *> records;
+  QHash<SoSensor *, QString> labels;
+  QHash<QString, SensorProfile::Entry> entries;
+  int numpasses[2];
+  double queuetime[2];
+};
+
+}}} // namespace
+
+#endif // QUARTER_SENSORPROFILER_H
@@ -40,18 +40,24 @@
 #include <Inventor/events/SoMotion3Event.h>
 #include <Inventor/events/SoSpaceballButtonEvent.h>
 
+#include <Quarter/QuarterWidget.h>
+
 #include "NativeEvent.h"
+#include "SpaceNavigatorReader.h"
 
 #ifdef HAVE_SPACENAV_LIB
+#if QT_VERSION < 0x050000
 #include <QX11Info>
+#endif
 #include <spnav.h>
 #endif //HAVE_SPACENAV_LIB
 
+#include <cmath>
 #include <cstdio>
 
 
 namespace SIM { namespace Coin3D { namespace Quarter {
-class SpaceNavigatorDeviceP {
+class SpaceNavigatorDeviceP : public SpaceNavigatorReader::Client {
 public:
   SpaceNavigatorDeviceP(SpaceNavigatorDevice * master) {
     this->master = master;
@@ -65,7 +71,13 @@ public:
     delete this->buttonevent;
   }
 
-  static bool customEventFilter(void * message, long * result);
+  SoEvent * motionEvent(const int translation[3], const int rotation[3]);
+  SoEvent * buttonEvent(int bnum, bool press);
+
+  // SpaceNavigatorReader::Client interface
+  virtual QWidget * clientWidget(void) const;
+  virtual void motion(const int translation[3], const int rotation[3]);
+  virtual void button(int bnum, bool press);
 
   SpaceNavigatorDevice * master;
   bool hasdevice;
@@ -87,8 +99,14 @@ SpaceNavigatorDevice::SpaceNavigatorDevice(QuarterWidget* quart) :
   PRIVATE(this) = new SpaceNavigatorDeviceP(this);
 
 #ifdef HAVE_SPACENAV_LIB
+#if QT_VERSION < 0x050000
   PRIVATE(this)->hasdevice =
     spnav_x11_open(QX11Info::display(), PRIVATE(this)->windowid) == -1 ? false : true;
+#else
+  // there is no application wide X11 event filter to feed us
+  // ClientMessages any more, so read from the daemon socket instead
+  PRIVATE(this)->hasdevice = SpaceNavigatorReader::attach(PRIVATE(this));
+#endif
 
   // FIXME: Use a debugmessage mechanism instead? (20101020 handegar)
   if (!PRIVATE(this)->hasdevice) {
@@ -101,16 +119,28 @@ SpaceNavigatorDevice::SpaceNavigatorDevice(QuarterWidget* quart) :
 
 SpaceNavigatorDevice::~SpaceNavigatorDevice()
 {
+#if defined(HAVE_SPACENAV_LIB) && (QT_VERSION >= 0x050000)
+  SpaceNavigatorReader::detach(PRIVATE(this));
+#endif
   delete PRIVATE(this);
 }
 
 
+QList<QEvent::Type>
+SpaceNavigatorDevice::eventTypes(void) const
+{
+  // the native events are posted as QEvent::User, see NativeEvent
+  QList<QEvent::Type> types;
+  types << QEvent::User;
+  return types;
+}
+
 const SoEvent *
 SpaceNavigatorDevice::translateEvent(QEvent * event)
 {
   SoEvent * ret = NULL;
 
-#ifdef HAVE_SPACENAV_LIB
+#if defined(HAVE_SPACENAV_LIB) && (QT_VERSION < 0x050000)
   NativeEvent * ce = dynamic_cast<NativeEvent *>(event);
   if (ce && ce->getEvent()) {
     XEvent * xev = ce->getEvent();
@@ -118,58 +148,12 @@ SpaceNavigatorDevice::translateEvent(QEvent * event)
     spnav_event spev;
     if(spnav_x11_event(xev, &spev)) {
       if(spev.type == SPNAV_EVENT_MOTION) {
-        // Add rotation
-        const float axislen = sqrt(spev.motion.rx*spev.motion.rx +
-                                   spev.motion.ry*spev.motion.ry +
-                                   spev.motion.rz*spev.motion.rz);
-
-	const float half_angle = axislen * 0.5 * 0.001;
-	const float sin_half = sin(half_angle);
-        SbRotation rot((spev.motion.rx / axislen) * sin_half,
-                       (spev.motion.ry / axislen) * sin_half,
-                       (spev.motion.rz / axislen) * sin_half,
-                       cos(half_angle));
-        PRIVATE(this)->motionevent->setRotation(rot);
-
-        // Add translation
-        SbVec3f pos(spev.motion.x * 0.001,
-                    spev.motion.y * 0.001,
-                    spev.motion.z * 0.001);
-        PRIVATE(this)->motionevent->setTranslation(pos);
-
-        ret = PRIVATE(this)->motionevent;
+        const int translation[3] = { spev.motion.x, spev.motion.y, spev.motion.z };
+        const int rotation[3] = { spev.motion.rx, spev.motion.ry, spev.motion.rz };
+        ret = PRIVATE(this)->motionEvent(translation, rotation);
       }
       else if (spev.type == SPNAV_EVENT_BUTTON){
-        if(spev.button.press) {
-          PRIVATE(this)->buttonevent->setState(SoButtonEvent::DOWN);
-          switch(spev.button.bnum) {
-          case 0: PRIVATE(this)->buttonevent->setButton(SoSpaceballButtonEvent::BUTTON1);
-            break;
-          case 1: PRIVATE(this)->buttonevent->setButton(SoSpaceballButtonEvent::BUTTON2);
-            break;
-          case 2: PRIVATE(this)->buttonevent->setButton(SoSpaceballButtonEvent::BUTTON3);
-            break;
-          case 3: PRIVATE(this)->buttonevent->setButton(SoSpaceballButtonEvent::BUTTON4);
-            break;
-          case 4: PRIVATE(this)->buttonevent->setButton(SoSpaceballButtonEvent::BUTTON5);
-            break;
-          case 5: PRIVATE(this)->buttonevent->setButton(SoSpaceballButtonEvent::BUTTON6);
-            break;
-          case 6: PRIVATE(this)->buttonevent->setButton(SoSpaceballButtonEvent::BUTTON7);
-            break;
-          case 7: PRIVATE(this)->buttonevent->setButton(SoSpaceballButtonEvent::BUTTON8);
-            break;
-          default:
-            // FIXME: Which button corresponds to the
-            // SoSpaceballButtonEvent::PICK enum? (20101020 handegar)
-            break;
-          }
-        }
-        else {
-          PRIVATE(this)->buttonevent->setState(SoButtonEvent::UP);
-        }
-
-        ret = PRIVATE(this)->buttonevent;
+        ret = PRIVATE(this)->buttonEvent(spev.button.bnum, spev.button.press != 0);
       }
       else {
         // Unknown Spacenav event.
@@ -182,6 +166,93 @@ SpaceNavigatorDevice::translateEvent(QEvent * event)
   return ret;
 }
 
+SoEvent *
+SpaceNavigatorDeviceP::motionEvent(const int translation[3], const int rotation[3])
+{
+  // Add rotation
+  const float axislen = sqrt(float(rotation[0]*rotation[0] +
+                                   rotation[1]*rotation[1] +
+                                   rotation[2]*rotation[2]));
+
+  if (axislen > 0.0f) {
+    const float half_angle = axislen * 0.5 * 0.001;
+    const float sin_half = sin(half_angle);
+    SbRotation rot((rotation[0] / axislen) * sin_half,
+                   (rotation[1] / axislen) * sin_half,
+                   (rotation[2] / axislen) * sin_half,
+                   cos(half_angle));
+    this->motionevent->setRotation(rot);
+  }
+  else {
+    this->motionevent->setRotation(SbRotation::identity());
+  }
+
+  // Add translation
+  SbVec3f pos(translation[0] * 0.001,
+              translation[1] * 0.001,
+              translation[2] * 0.001);
+  this->motionevent->setTranslation(pos);
+
+  return this->motionevent;
+}
+
+SoEvent *
+SpaceNavigatorDeviceP::buttonEvent(int bnum, bool press)
+{
+  if (press) {
+    this->buttonevent->setState(SoButtonEvent::DOWN);
+    switch (bnum) {
+    case 0: this->buttonevent->setButton(SoSpaceballButtonEvent::BUTTON1);
+      break;
+    case 1: this->buttonevent->setButton(SoSpaceballButtonEvent::BUTTON2);
+      break;
+    case 2: this->buttonevent->setButton(SoSpaceballButtonEvent::BUTTON3);
+      break;
+    case 3: this->buttonevent->setButton(SoSpaceballButtonEvent::BUTTON4);
+      break;
+    case 4: this->buttonevent->setButton(SoSpaceballButtonEvent::BUTTON5);
+      break;
+    case 5: this->buttonevent->setButton(SoSpaceballButtonEvent::BUTTON6);
+      break;
+    case 6: this->buttonevent->setButton(SoSpaceballButtonEvent::BUTTON7);
+      break;
+    case 7: this->buttonevent->setButton(SoSpaceballButtonEvent::BUTTON8);
+      break;
+    default:
+      // FIXME: Which button corresponds to the
+      // SoSpaceballButtonEvent::PICK enum? (20101020 handegar)
+      break;
+    }
+  }
+  else {
+    this->buttonevent->setState(SoButtonEvent::UP);
+  }
+
+  return this->buttonevent;
+}
+
+QWidget *
+SpaceNavigatorDeviceP::clientWidget(void) const
+{
+  return this->master->quarter;
+}
+
+void
+SpaceNavigatorDeviceP::motion(const int translation[3], const int rotation[3])
+{
+  if (!this->master->quarter) return;
+  // the accumulated motion is delivered as one event, reusing the
+  // preallocated SoMotion3Event
+  this->master->quarter->processSoEvent(this->motionEvent(translation, rotation));
+}
+
+void
+SpaceNavigatorDeviceP::button(int bnum, bool press)
+{
+  if (!this->master->quarter) return;
+  this->master->quarter->processSoEvent(this->buttonEvent(bnum, press));
+}
+
 
 #undef PRIVATE
 #undef PUBLIC
@@ -0,0 +1,213 @@
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+/*
+  Reads SpaceNavigator events straight from the spacenavd socket, for
+  Qt versions where the application wide X11 event filter used on Qt 4
+  is no longer available. All devices share one connection to the
+  daemon. Motion samples are summed between flushes, so at most one
+  motion event per screen refresh reaches the focused QuarterWidget,
+  however fast the device reports.
+ */
+
+#include "SpaceNavigatorReader.h"
+
+#include <QtCore/QSocketNotifier>
+#include <QtCore/QTimer>
+#include <QApplication>
+#include <QWidget>
+#if QT_VERSION >= 0x050000
+#include <QGuiApplication>
+#include <QScreen>
+#endif
+
+#include <Inventor/SbBasic.h>
+
+#ifdef HAVE_SPACENAV_LIB
+#include <spnav.h>
+#endif // HAVE_SPACENAV_LIB
+
+using namespace SIM::Coin3D::Quarter;
+
+SpaceNavigatorReader * SpaceNavigatorReader::reader = NULL;
+
+SpaceNavigatorReader::SpaceNavigatorReader(void)
+{
+  this->notifier = NULL;
+  this->connected = false;
+  this->samples = 0;
+  for (int i = 0; i < 3; i++) {
+    this->translation[i] = 0;
+    this->rotation[i] = 0;
+  }
+  this->lastflush = SbTime::zero();
+
+  this->flushtimer = new QTimer(this);
+  this->flushtimer->setSingleShot(true);
+#if QT_VERSION >= 0x050000
+  this->flushtimer->setTimerType(Qt::PreciseTimer);
+#endif
+  this->connect(this->flushtimer, SIGNAL(timeout(void)), this, SLOT(flush(void)));
+
+#ifdef HAVE_SPACENAV_LIB
+  if (spnav_open() != -1) {
+    this->connected = true;
+    this->notifier = new QSocketNotifier(spnav_fd(), QSocketNotifier::Read, this);
+    this->connect(this->notifier, SIGNAL(activated(int)), this, SLOT(readEvents(void)));
+  }
+#endif // HAVE_SPACENAV_LIB
+}
+
+SpaceNavigatorReader::~SpaceNavigatorReader()
+{
+  delete this->notifier;
+#ifdef HAVE_SPACENAV_LIB
+  if (this->connected) {
+    spnav_close();
+  }
+#endif // HAVE_SPACENAV_LIB
+}
+
+/*
+  Registers a client, connecting to the daemon for the first
+  one. Returns false if there is no SpaceNavigator daemon to talk to.
+ */
+bool
+SpaceNavigatorReader::attach(Client * client)
+{
+  if (reader == NULL) {
+    reader = new SpaceNavigatorReader;
+  }
+  if (!reader->clients.contains(client)) {
+    reader->clients.append(client);
+  }
+  return reader->connected;
+}
+
+/*
+  Unregisters a client. The connection is closed with the last one.
+ */
+void
+SpaceNavigatorReader::detach(Client * client)
+{
+  if (reader == NULL) return;
+  reader->clients.removeAll(client);
+  if (reader->clients.isEmpty()) {
+    delete reader;
+    reader = NULL;
+  }
+}
+
+/*
+  Events go to the client with keyboard focus, or else to the first
+  client in the active window, like the focus widget posting on Qt 4.
+ */
+SpaceNavigatorReader::Client *
+SpaceNavigatorReader::target(void) const
+{
+  Client * active = NULL;
+  for (int i = 0; i < this->clients.size(); i++) {
+    QWidget * widget = this->clients[i]->clientWidget();
+    if (!widget) continue;
+    if (widget->hasFocus()) return this->clients[i];
+    if (!active && widget->isActiveWindow()) active = this->clients[i];
+  }
+  return active;
+}
+
+void
+SpaceNavigatorReader::readEvents(void)
+{
+#ifdef HAVE_SPACENAV_LIB
+  // drain everything the daemon has sent so far, summing up motion
+  // samples instead of generating one Coin event per sample
+  spnav_event event;
+  while (spnav_poll_event(&event) != 0) {
+    if (event.type == SPNAV_EVENT_MOTION) {
+      this->translation[0] += event.motion.x;
+      this->translation[1] += event.motion.y;
+      this->translation[2] += event.motion.z;
+      this->rotation[0] += event.motion.rx;
+      this->rotation[1] += event.motion.ry;
+      this->rotation[2] += event.motion.rz;
+      this->samples++;
+    }
+    else if (event.type == SPNAV_EVENT_BUTTON) {
+      // keep the motion/button ordering intact
+      this->flush();
+      Client * client = this->target();
+      if (client) {
+        client->button(event.button.bnum, event.button.press != 0);
+      }
+    }
+  }
+  if (this->samples > 0) {
+    this->scheduleFlush();
+  }
+#endif // HAVE_SPACENAV_LIB
+}
+
+void
+SpaceNavigatorReader::scheduleFlush(void)
+{
+  if (this->flushtimer->isActive()) return;
+
+  double rate = 60.0;
+#if QT_VERSION >= 0x050000
+  QScreen * screen = QGuiApplication::primaryScreen();
+  if (screen && screen->refreshRate() > 0.0) {
+    rate = screen->refreshRate();
+  }
+#endif
+  SbTime next = this->lastflush + SbTime(1.0 / rate);
+  double delay = (next - SbTime::getTimeOfDay()).getValue();
+  this->flushtimer->start(int(SbMax(delay, 0.0) * 1000.0));
+}
+
+void
+SpaceNavigatorReader::flush(void)
+{
+  this->flushtimer->stop();
+  if (this->samples == 0) return;
+
+  Client * client = this->target();
+  if (client) {
+    client->motion(this->translation, this->rotation);
+  }
+
+  for (int i = 0; i < 3; i++) {
+    this->translation[i] = 0;
+    this->rotation[i] = 0;
+  }
+  this->samples = 0;
+  this->lastflush = SbTime::getTimeOfDay();
+}
@@ -0,0 +1,86 @@
+#ifndef QUARTER_SPACENAVIGATORREADER_H
+#define QUARTER_SPACENAVIGATORREADER_H
+
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+#include <QtCore/QObject>
+#include <QtCore/QList>
+#include <Inventor/SbTime.h>
+
+class QSocketNotifier;
+class QTimer;
+class QWidget;
+
+namespace SIM { namespace Coin3D { namespace Quarter {
+
+class SpaceNavigatorReader : public QObject {
+  Q_OBJECT
+public:
+  class Client {
+  public:
+    virtual ~Client() {}
+    virtual QWidget * clientWidget(void) const = 0;
+    virtual void motion(const int translation[3], const int rotation[3]) = 0;
+    virtual void button(int bnum, bool press) = 0;
+  };
+
+  static bool attach(Client * client);
+  static void detach(Client * client);
+
+private slots:
+  void readEvents(void);
+  void flush(void);
+
+private:
+  SpaceNavigatorReader(void);
+  ~SpaceNavigatorReader();
+
+  Client * target(void) const;
+  void scheduleFlush(void);
+
+  static SpaceNavigatorReader * reader;
+
+  QList<Client *> clients;
+  QSocketNotifier * notifier;
+  QTimer * flushtimer;
+  SbTime lastflush;
+  bool connected;
+
+  int translation[3];
+  int rotation[3];
+  int samples;
+};
+
+}}} // namespace
+
+#endif // QUARTER_SPACENAVIGATORREADER_H
@@ -0,0 +1,552 @@
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+/*!
+  \class SIM::Coin3D::Quarter::ThumbnailCache ThumbnailCache.h Quarter/ThumbnailCache.h
+
+  \brief The ThumbnailCache class provides preview images of scene
+  files without blocking the user interface.
+
+  requestThumbnail() looks up the thumbnail of a file on disk in a
+  background thread, and emits thumbnailReady() once it has it. On a
+  miss, the file is read and rendered with the whole scene in view by
+  up to maximumConcurrency() render threads, each with its own
+  QuarterOffscreenRenderer, and the result is written to the cache
+  directory. Cache entries are keyed by the absolute path,
+  modification time and size of the file and by the thumbnail size,
+  so an edited file gets a new thumbnail. The thumbnails are PNG files
+  with a transparent background.
+
+  \code
+  ThumbnailCache * cache = new ThumbnailCache(QString(), this);
+  connect(cache, SIGNAL(thumbnailReady(QString, QImage)),
+          this, SLOT(setPreview(QString, QImage)));
+  foreach (const QFileInfo & info, dir.entryInfoList(filters)) {
+    cache->requestThumbnail(info.absoluteFilePath());
+  }
+  \endcode
+
+  The most recently requested files are rendered first, which are
+  usually the ones on screen. Rendering in the background requires a
+  thread safe Coin. Without COIN_THREADSAFE, thumbnails are rendered
+  one by one from the event loop of the GUI thread, while disk cache
+  lookups still happen in the background.
+
+  ThumbnailCache is only available with Qt 5 and later, and must be
+  used from the GUI thread.
+*/
+
+#include <Quarter/ThumbnailCache.h>
+
+#if QT_VERSION >= 0x050000
+
+#include <QtCore/QCache>
+#include <QtCore/QCoreApplication>
+#include <QtCore/QCryptographicHash>
+#include <QtCore/QDateTime>
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QList>
+#include <QtCore/QMetaObject>
+#include <QtCore/QMutex>
+#include <QtCore/QRunnable>
+#include <QtCore/QSet>
+#include <QtCore/QStandardPaths>
+#include <QtCore/QThread>
+#include <QtCore/QThreadPool>
+#include <QtCore/QTimer>
+#include <QtCore/QWaitCondition>
+
+#include <Inventor/C/basic.h>
+#include <Inventor/SoDB.h>
+#include <Inventor/SoInput.h>
+#include <Inventor/nodes/SoSeparator.h>
+
+#include <Quarter/QuarterOffscreenRenderer.h>
+
+// SoInput and the Coin name dictionary used while reading are shared
+// by all render threads
+static QMutex readmutex;
+
+namespace SIM { namespace Coin3D { namespace Quarter {
+
+class ThumbnailRenderThread;
+
+class ThumbnailCacheP {
+public:
+  ThumbnailCacheP(ThumbnailCache * master)
+    : master(master), memorycache(32 * 1024), maxthreads(2),
+      stopping(false), guirenderer(NULL), guirenderscheduled(false)
+  {
+  }
+
+  struct Job {
+    QString path;
+    QString cachefile;
+    QSize size;
+  };
+
+  QString cacheFile(const QFileInfo & info, const QSize & size) const;
+  void lookup(const QString & path);
+  bool takeJob(Job & job);
+  void stopThreads(void);
+  static QImage render(QuarterOffscreenRenderer * renderer, const Job & job);
+  static void save(const QImage & image, const QString & cachefile);
+
+  ThumbnailCache * master;
+  QString directory;
+  QSize size;
+  QCache<QString, QImage> memorycache;
+  QSet<QString> pending;
+  QThreadPool lookuppool;
+  int maxthreads;
+
+  // shared with the render threads
+  QMutex mutex;
+  QWaitCondition jobavailable;
+  QList<Job> jobs;
+  bool stopping;
+  QList<ThumbnailRenderThread *> threads;
+
+  // without COIN_THREADSAFE
+  QuarterOffscreenRenderer * guirenderer;
+  bool guirenderscheduled;
+};
+
+/*
+  Checks the disk cache for a thumbnail, in the lookup pool. Misses
+  are handed back to the GUI thread, which owns the render threads.
+ */
+class ThumbnailLookup : public QRunnable {
+public:
+  ThumbnailLookup(ThumbnailCacheP * cache, const QString & path)
+    : cache(cache), path(path)
+  { }
+
+  virtual void run(void) { this->cache->lookup(this->path); }
+
+private:
+  ThumbnailCacheP * cache;
+  QString path;
+};
+
+/*
+  Reads and renders the files missing from the cache. The renderer is
+  created in and moved back to the GUI thread.
+ */
+class ThumbnailRenderThread : public QThread {
+public:
+  ThumbnailRenderThread(ThumbnailCacheP * cache, QuarterOffscreenRenderer * renderer)
+    : cache(cache), renderer(renderer)
+  {
+    this->renderer->moveToThread(this);
+  }
+
+  ~ThumbnailRenderThread()
+  {
+    delete this->renderer;
+  }
+
+protected:
+  virtual void run(void)
+  {
+    ThumbnailCacheP::Job job;
+    while (this->cache->takeJob(job)) {
+      const QImage image = ThumbnailCacheP::render(this->renderer, job);
+      if (!image.isNull()) ThumbnailCacheP::save(image, job.cachefile);
+      QMetaObject::invokeMethod(this->cache->master, "deliver", Qt::QueuedConnection,
+                                Q_ARG(QString, job.path), Q_ARG(QImage, image));
+    }
+    this->renderer->moveToThread(QCoreApplication::instance()->thread());
+  }
+
+private:
+  ThumbnailCacheP * cache;
+  QuarterOffscreenRenderer * renderer;
+};
+
+}}} // namespace
+
+#define PRIVATE(obj) obj->pimpl
+#define PUBLIC(obj) obj->master
+
+using namespace SIM::Coin3D::Quarter;
+
+QString
+ThumbnailCacheP::cacheFile(const QFileInfo & info, const QSize & size) const
+{
+  const QString key = info.absoluteFilePath() + QLatin1Char('|') +
+    QString::number(info.lastModified().toMSecsSinceEpoch()) + QLatin1Char('|') +
+    QString::number(info.size()) + QLatin1Char('|') +
+    QString::number(size.width()) + QLatin1Char('x') + QString::number(size.height());
+  const QByteArray hash =
+    QCryptographicHash::hash(key.toUtf8(), QCryptographicHash::Sha1).toHex();
+  return this->directory + QLatin1Char('/') + QString::fromLatin1(hash) + QLatin1String(".png");
+}
+
+void
+ThumbnailCacheP::lookup(const QString & path)
+{
+  const QFileInfo info(path);
+  if (!info.isFile()) {
+    QMetaObject::invokeMethod(this->master, "deliver", Qt::QueuedConnection,
+                              Q_ARG(QString, path), Q_ARG(QImage, QImage()));
+    return;
+  }
+
+  QSize size;
+  {
+    QMutexLocker locker(&this->mutex);
+    size = this->size;
+  }
+  const QString cachefile = this->cacheFile(info, size);
+  QImage image;
+  if (QFile::exists(cachefile) && image.load(cachefile, "PNG")) {
+    QMetaObject::invokeMethod(this->master, "deliver", Qt::QueuedConnection,
+                              Q_ARG(QString, path), Q_ARG(QImage, image));
+    return;
+  }
+  QMetaObject::invokeMethod(this->master, "renderMiss", Qt::QueuedConnection,
+                            Q_ARG(QString, path), Q_ARG(QString, cachefile),
+                            Q_ARG(QSize, size));
+}
+
+/*
+  Blocks until there is a job for a render thread. Returns false when
+  the threads are to stop.
+ */
+bool
+ThumbnailCacheP::takeJob(Job & job)
+{
+  QMutexLocker locker(&this->mutex);
+  while (this->jobs.isEmpty() && !this->stopping) {
+    this->jobavailable.wait(&this->mutex);
+  }
+  if (this->stopping) return false;
+  // newest first
+  job = this->jobs.takeLast();
+  return true;
+}
+
+void
+ThumbnailCacheP::stopThreads(void)
+{
+  {
+    QMutexLocker locker(&this->mutex);
+    this->stopping = true;
+    this->jobs.clear();
+    this->jobavailable.wakeAll();
+  }
+  foreach (ThumbnailRenderThread * thread, this->threads) {
+    thread->wait();
+  }
+  qDeleteAll(this->threads);
+  this->threads.clear();
+  this->stopping = false;
+}
+
+QImage
+ThumbnailCacheP::render(QuarterOffscreenRenderer * renderer, const Job & job)
+{
+  SoSeparator * root = NULL;
+  {
+    QMutexLocker locker(&readmutex);
+    SoInput in;
+    if (in.openFile(QFile::encodeName(job.path).constData(), TRUE) && in.isValidFile()) {
+      root = SoDB::readAll(&in);
+    }
+  }
+  if (!root) return QImage();
+  root->ref();
+
+  renderer->setSize(job.size);
+  renderer->setSceneGraph(root);
+  // also for scenes with a camera of their own
+  renderer->viewAll();
+  const QImage image = renderer->grabImage();
+  renderer->setSceneGraph(NULL);
+  root->unref();
+  return image;
+}
+
+void
+ThumbnailCacheP::save(const QImage & image, const QString & cachefile)
+{
+  const QFileInfo info(cachefile);
+  if (!QDir().mkpath(info.absolutePath())) return;
+
+  // write to a temporary file first, so that a concurrent lookup never
+  // sees a partially written thumbnail
+  const QString tmpfile = cachefile + QLatin1String(".") +
+    QString::number(quintptr(QThread::currentThreadId())) + QLatin1String(".tmp");
+  if (!image.save(tmpfile, "PNG")) {
+    QFile::remove(tmpfile);
+    return;
+  }
+  QFile::remove(cachefile);
+  if (!QFile::rename(tmpfile, cachefile)) {
+    QFile::remove(tmpfile);
+  }
+}
+
+/*!
+  Constructor. Thumbnails are stored in \a cachedirectory, which
+  defaults to a "thumbnails" directory in the cache location of the
+  application.
+*/
+ThumbnailCache::ThumbnailCache(const QString & cachedirectory, QObject * parent)
+  : inherited(parent)
+{
+  PRIVATE(this) = new ThumbnailCacheP(this);
+  PRIVATE(this)->directory = cachedirectory;
+  if (PRIVATE(this)->directory.isEmpty()) {
+    PRIVATE(this)->directory =
+      QStandardPaths::writableLocation(QStandardPaths::CacheLocation) +
+      QLatin1String("/thumbnails");
+  }
+  PRIVATE(this)->size = QSize(128, 128);
+  PRIVATE(this)->lookuppool.setMaxThreadCount(2);
+}
+
+/*!
+  Destructor. Pending requests are cancelled.
+*/
+ThumbnailCache::~ThumbnailCache()
+{
+  this->cancelPending();
+  PRIVATE(this)->lookuppool.waitForDone();
+  PRIVATE(this)->stopThreads();
+  delete PRIVATE(this)->guirenderer;
+  delete PRIVATE(this);
+}
+
+/*!
+  Returns the directory the thumbnails are stored in.
+*/
+QString
+ThumbnailCache::cacheDirectory(void) const
+{
+  return PRIVATE(this)->directory;
+}
+
+/*!
+  Sets the size of the thumbnails. The default is 128 x 128 pixels.
+  Thumbnails of another size already in the cache are not used.
+*/
+void
+ThumbnailCache::setThumbnailSize(const QSize & size)
+{
+  QMutexLocker locker(&PRIVATE(this)->mutex);
+  if (size == PRIVATE(this)->size) return;
+  PRIVATE(this)->size = size;
+  PRIVATE(this)->memorycache.clear();
+}
+
+/*!
+  Returns the size of the thumbnails.
+*/
+QSize
+ThumbnailCache::thumbnailSize(void) const
+{
+  QMutexLocker locker(&PRIVATE(this)->mutex);
+  return PRIVATE(this)->size;
+}
+
+/*!
+  Sets the maximum number of files read and rendered at the same
+  time, each by a render thread with an OpenGL context of its own. The
+  default is 2. Render threads are started as needed, and a lower
+  limit takes effect when the pending requests are cancelled.
+*/
+void
+ThumbnailCache::setMaximumConcurrency(int threads)
+{
+  PRIVATE(this)->maxthreads = qMax(threads, 1);
+}
+
+/*!
+  Returns the maximum number of files read and rendered at the same
+  time.
+*/
+int
+ThumbnailCache::maximumConcurrency(void) const
+{
+  return PRIVATE(this)->maxthreads;
+}
+
+/*!
+  Requests the thumbnail of the scene file \a path. thumbnailReady()
+  or thumbnailFailed() is emitted later, never from within this call.
+  Repeated requests for a file whose thumbnail is still pending are
+  ignored.
+*/
+void
+ThumbnailCache::requestThumbnail(const QString & path)
+{
+  const QString absolute = QFileInfo(path).absoluteFilePath();
+  if (PRIVATE(this)->pending.contains(absolute)) return;
+  PRIVATE(this)->pending.insert(absolute);
+  PRIVATE(this)->lookuppool.start(new ThumbnailLookup(PRIVATE(this), absolute));
+}
+
+/*!
+  Returns the thumbnail of \a path if it has been delivered recently
+  and is still held in memory, or a null image otherwise. Unlike
+  requestThumbnail(), this does not check whether the file has
+  changed since.
+*/
+QImage
+ThumbnailCache::cachedThumbnail(const QString & path) const
+{
+  const QImage * image = PRIVATE(this)->memorycache.object(QFileInfo(path).absoluteFilePath());
+  return image ? *image : QImage();
+}
+
+/*!
+  Cancels all requests which have not been answered yet. Thumbnails
+  being rendered at the moment are still written to the cache, but no
+  signal is emitted for them.
+*/
+void
+ThumbnailCache::cancelPending(void)
+{
+  PRIVATE(this)->pending.clear();
+  PRIVATE(this)->lookuppool.clear();
+  QMutexLocker locker(&PRIVATE(this)->mutex);
+  PRIVATE(this)->jobs.clear();
+  // pick up a lowered concurrency limit with the next request
+  if (PRIVATE(this)->threads.size() > PRIVATE(this)->maxthreads) {
+    locker.unlock();
+    PRIVATE(this)->stopThreads();
+  }
+}
+
+void
+ThumbnailCache::deliver(const QString & path, const QImage & image)
+{
+  if (!PRIVATE(this)->pending.remove(path)) return;
+  if (image.isNull()) {
+    emit this->thumbnailFailed(path);
+    return;
+  }
+#if QT_VERSION >= 0x050A00
+  const int cost = qMax(int(image.sizeInBytes() / 1024), 1);
+#else
+  const int cost = qMax(image.byteCount() / 1024, 1);
+#endif
+  PRIVATE(this)->memorycache.insert(path, new QImage(image), cost);
+  emit this->thumbnailReady(path, image);
+}
+
+void
+ThumbnailCache::renderMiss(const QString & path, const QString & cachefile,
+                           const QSize & size)
+{
+  if (!PRIVATE(this)->pending.contains(path)) return;
+
+  ThumbnailCacheP::Job job;
+  job.path = path;
+  job.cachefile = cachefile;
+  job.size = size;
+
+#ifdef COIN_THREADSAFE
+  QMutexLocker locker(&PRIVATE(this)->mutex);
+  PRIVATE(this)->jobs.append(job);
+  if (PRIVATE(this)->threads.size() < PRIVATE(this)->maxthreads) {
+    QuarterOffscreenRenderer * renderer = new QuarterOffscreenRenderer(size);
+    if (renderer->isValid()) {
+      ThumbnailRenderThread * thread = new ThumbnailRenderThread(PRIVATE(this), renderer);
+      PRIVATE(this)->threads.append(thread);
+      thread->start();
+    }
+    else {
+      delete renderer;
+    }
+  }
+  if (PRIVATE(this)->threads.isEmpty()) {
+    PRIVATE(this)->jobs.clear();
+    locker.unlock();
+    this->deliver(path, QImage());
+    return;
+  }
+  PRIVATE(this)->jobavailable.wakeOne();
+#else
+  PRIVATE(this)->jobs.append(job);
+  if (!PRIVATE(this)->guirenderscheduled) {
+    PRIVATE(this)->guirenderscheduled = true;
+    QTimer::singleShot(0, this, SLOT(renderNext()));
+  }
+#endif
+}
+
+/*
+  Renders one thumbnail on the GUI thread per event loop iteration,
+  for Coin builds which cannot render in the background.
+*/
+void
+ThumbnailCache::renderNext(void)
+{
+  PRIVATE(this)->guirenderscheduled = false;
+  if (PRIVATE(this)->jobs.isEmpty()) return;
+  const ThumbnailCacheP::Job job = PRIVATE(this)->jobs.takeLast();
+  if (!PRIVATE(this)->jobs.isEmpty()) {
+    PRIVATE(this)->guirenderscheduled = true;
+    QTimer::singleShot(0, this, SLOT(renderNext()));
+  }
+
+  if (!PRIVATE(this)->guirenderer) {
+    PRIVATE(this)->guirenderer = new QuarterOffscreenRenderer(job.size);
+  }
+  const QImage image = ThumbnailCacheP::render(PRIVATE(this)->guirenderer, job);
+  if (!image.isNull()) ThumbnailCacheP::save(image, job.cachefile);
+  this->deliver(job.path, image);
+}
+
+/*!
+  \fn void ThumbnailCache::thumbnailReady(const QString & path, const QImage & image)
+
+  Emitted when the thumbnail of \a path, as given to
+  requestThumbnail() but made absolute, is available.
+*/
+
+/*!
+  \fn void ThumbnailCache::thumbnailFailed(const QString & path)
+
+  Emitted when no thumbnail could be made for \a path, because the
+  file does not exist, could not be read or could not be rendered.
+*/
+
+#undef PRIVATE
+#undef PUBLIC
+
+#endif // QT_VERSION >= 0x050000
@@ -0,0 +1,240 @@
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+/*
+  Writes an uncompressed, tiled RGBA TIFF file tile by tile from a
+  worker thread, so that an image much larger than memory can be
+  written while it is being rendered. Tiles may arrive in any order;
+  the directory with the tile offsets is written last. Only classic
+  TIFF is supported, so the file is limited to 4 GB.
+ */
+
+#include "TiffTileWriter.h"
+
+#include <QtCore/QDataStream>
+
+using namespace SIM::Coin3D::Quarter;
+
+namespace {
+
+enum {
+  TIFF_SHORT = 3,
+  TIFF_LONG = 4
+};
+
+void
+tiff_entry(QDataStream & stream, quint16 tag, quint16 type, quint32 count, quint32 value)
+{
+  stream << tag << type << count;
+  if (type == TIFF_SHORT && count == 1) {
+    // left justified in the value field
+    stream << quint16(value) << quint16(0);
+  }
+  else {
+    stream << value;
+  }
+}
+
+} // anonymous namespace
+
+TiffTileWriter::TiffTileWriter(const QString & filename, const QSize & size, const QSize & tilesize)
+  : file(filename), size(size), tilesize(tilesize), failed(false), done(false)
+{
+  this->columns = (size.width() + tilesize.width() - 1) / tilesize.width();
+  this->rows = (size.height() + tilesize.height() - 1) / tilesize.height();
+  this->offsets.fill(0, this->columns * this->rows);
+  this->bytecounts.fill(0, this->columns * this->rows);
+}
+
+TiffTileWriter::~TiffTileWriter()
+{
+  if (this->isRunning()) {
+    this->failed = true;
+    this->finish();
+  }
+}
+
+int
+TiffTileWriter::numTiles(void) const
+{
+  return this->columns * this->rows;
+}
+
+/*
+  Creates the file, writes the header and starts the worker. Returns
+  false if the file can not be written or would be too large.
+ */
+bool
+TiffTileWriter::open(void)
+{
+  const qint64 tilebytes = qint64(this->tilesize.width()) * this->tilesize.height() * 4;
+  if (qint64(this->numTiles()) * tilebytes + 4096 > qint64(0xffffffffu)) return false;
+  if (!this->file.open(QIODevice::WriteOnly | QIODevice::Truncate)) return false;
+
+  QDataStream stream(&this->file);
+  stream.setByteOrder(QDataStream::LittleEndian);
+  // the directory offset is filled in by writeDirectory()
+  stream << quint8('I') << quint8('I') << quint16(42) << quint32(0);
+  if (stream.status() != QDataStream::Ok) return false;
+
+  this->start();
+  return true;
+}
+
+/*
+  Queues a tile for writing. \a tile must have the tile size and the
+  RGBA8888 format. Blocks while the writer is behind, which bounds
+  the memory used by tiles in flight.
+ */
+void
+TiffTileWriter::post(int index, const QImage & tile)
+{
+  QMutexLocker locker(&this->mutex);
+  while (this->queue.size() >= MAX_QUEUED && !this->failed) {
+    this->notfull.wait(&this->mutex);
+  }
+  if (this->failed) return;
+  this->queue.append(qMakePair(index, tile));
+  this->notempty.wakeOne();
+}
+
+/*
+  Waits for the queued tiles, writes the directory and closes the
+  file. Returns false if anything could not be written.
+ */
+bool
+TiffTileWriter::finish(void)
+{
+  {
+    QMutexLocker locker(&this->mutex);
+    this->done = true;
+    this->notempty.wakeOne();
+  }
+  this->wait();
+
+  if (!this->failed) {
+    for (int i = 0; i < this->offsets.size(); i++) {
+      if (!this->offsets[i]) this->failed = true;
+    }
+  }
+  if (!this->failed) this->failed = !this->writeDirectory();
+  this->file.close();
+  if (this->failed) this->file.remove();
+  return !this->failed;
+}
+
+void
+TiffTileWriter::run(void)
+{
+  for (;;) {
+    QPair<int, QImage> tile;
+    {
+      QMutexLocker locker(&this->mutex);
+      while (this->queue.isEmpty() && !this->done) {
+        this->notempty.wait(&this->mutex);
+      }
+      if (this->queue.isEmpty()) return;
+      tile = this->queue.takeFirst();
+      this->notfull.wakeOne();
+    }
+    if (!this->writeTile(tile.first, tile.second)) {
+      QMutexLocker locker(&this->mutex);
+      this->failed = true;
+      this->queue.clear();
+      this->notfull.wakeAll();
+      return;
+    }
+  }
+}
+
+bool
+TiffTileWriter::writeTile(int index, const QImage & tile)
+{
+  if (index < 0 || index >= this->numTiles() ||
+      tile.size() != this->tilesize || tile.format() != QImage::Format_RGBA8888) {
+    return false;
+  }
+
+  this->offsets[index] = quint32(this->file.pos());
+  const qint64 linebytes = qint64(this->tilesize.width()) * 4;
+  for (int y = 0; y < tile.height(); y++) {
+    if (this->file.write(reinterpret_cast<const char *>(tile.constScanLine(y)), linebytes) != linebytes) {
+      return false;
+    }
+  }
+  this->bytecounts[index] = quint32(linebytes * tile.height());
+  return true;
+}
+
+bool
+TiffTileWriter::writeDirectory(void)
+{
+  // the directory must start on a word boundary
+  if (this->file.pos() & 1) this->file.write("", 1);
+
+  const int numtiles = this->numTiles();
+  const int NUM_ENTRIES = 12;
+  const quint32 directory = quint32(this->file.pos());
+  const quint32 bitspersample = directory + 2 + NUM_ENTRIES * 12 + 4;
+  const quint32 tileoffsets = bitspersample + 4 * 2;
+  const quint32 tilebytecounts = tileoffsets + numtiles * 4;
+
+  QDataStream stream(&this->file);
+  stream.setByteOrder(QDataStream::LittleEndian);
+
+  // the entries must be sorted by tag
+  stream << quint16(NUM_ENTRIES);
+  tiff_entry(stream, 256, TIFF_LONG, 1, this->size.width());         // ImageWidth
+  tiff_entry(stream, 257, TIFF_LONG, 1, this->size.height());        // ImageLength
+  tiff_entry(stream, 258, TIFF_SHORT, 4, bitspersample);             // BitsPerSample
+  tiff_entry(stream, 259, TIFF_SHORT, 1, 1);                         // Compression: none
+  tiff_entry(stream, 262, TIFF_SHORT, 1, 2);                         // PhotometricInterpretation: RGB
+  tiff_entry(stream, 277, TIFF_SHORT, 1, 4);                         // SamplesPerPixel
+  tiff_entry(stream, 284, TIFF_SHORT, 1, 1);                         // PlanarConfiguration: chunky
+  tiff_entry(stream, 322, TIFF_LONG, 1, this->tilesize.width());     // TileWidth
+  tiff_entry(stream, 323, TIFF_LONG, 1, this->tilesize.height());    // TileLength
+  tiff_entry(stream, 324, TIFF_LONG, numtiles, numtiles > 1 ? tileoffsets : this->offsets[0]);
+  tiff_entry(stream, 325, TIFF_LONG, numtiles, numtiles > 1 ? tilebytecounts : this->bytecounts[0]);
+  tiff_entry(stream, 338, TIFF_SHORT, 1, 2);                         // ExtraSamples: unassociated alpha
+  stream << quint32(0);
+
+  stream << quint16(8) << quint16(8) << quint16(8) << quint16(8);
+  if (numtiles > 1) {
+    for (int i = 0; i < numtiles; i++) stream << this->offsets[i];
+    for (int i = 0; i < numtiles; i++) stream << this->bytecounts[i];
+  }
+  if (stream.status() != QDataStream::Ok) return false;
+
+  this->file.seek(4);
+  stream << directory;
+  return stream.status() == QDataStream::Ok && this->file.flush();
+}
@@ -0,0 +1,469 @@
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+/*!
+  \class SIM::Coin3D::Quarter::TouchDevice TouchDevice.h Quarter/devices/TouchDevice.h
+
+  \brief The TouchDevice class provides translation of touch screen
+  and trackpad gestures on the QuarterWidget.
+
+  One finger acts like the left mouse button: touching, dragging and
+  lifting it sends SoMouseButtonEvents and SoLocation2Events for
+  BUTTON1. Two fingers pan, pinch and rotate the view, and trackpad
+  pinch and rotate gestures do the same.
+
+  Touch screens report finger movements far more often than the
+  display refreshes. Instead of sending an event for each touch
+  update, the device adds up the movements and requests a redraw.
+  Right before the widget renders the frame, the gesture since the
+  last frame is sent as one SoMotion3Event. Its translation holds the
+  pan, in fractions of the viewport size, and the natural logarithm
+  of the pinch scale factor in z. Its rotation holds the
+  counterclockwise twist around the z axis. If the scene graph or the
+  navigation does not handle the event, the device moves the camera
+  itself. Only the latest position is sent for one finger drags.
+
+  The device takes over all touch input of the widget, so no mouse
+  events are synthesized from touches while it is registered. It is
+  not registered by default:
+
+  \code
+  viewer->getEventFilter()->registerInputDevice(new TouchDevice(viewer));
+  \endcode
+
+  Qt's gesture recognizers are not used, since they would see the
+  same touch points and add their own deltas on top.
+*/
+
+#include <Quarter/devices/TouchDevice.h>
+
+#include <math.h>
+
+#include <QtCore/QPointF>
+#include <QEvent>
+#include <QTouchEvent>
+#if QT_VERSION >= 0x060000
+#  include <QInputDevice>
+#elif QT_VERSION >= 0x050000
+#  include <QTouchDevice>
+#endif
+
+#include <Inventor/SbTime.h>
+#include <Inventor/SbViewportRegion.h>
+#include <Inventor/SoRenderManager.h>
+#include <Inventor/events/SoLocation2Event.h>
+#include <Inventor/events/SoMotion3Event.h>
+#include <Inventor/events/SoMouseButtonEvent.h>
+#include <Inventor/nodes/SoCamera.h>
+
+#include <Quarter/QuarterWidget.h>
+
+#include "NativeNavigation.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+namespace SIM { namespace Coin3D { namespace Quarter {
+
+class TouchDeviceP {
+public:
+  enum Mode {
+    IDLE,
+    DRAG,
+    GESTURE
+  };
+
+  TouchDeviceP(TouchDevice * master) {
+    this->master = master;
+    this->location2 = new SoLocation2Event;
+    this->mousebutton = new SoMouseButtonEvent;
+    this->mousebutton->setButton(SoMouseButtonEvent::BUTTON1);
+    this->motion = new SoMotion3Event;
+    this->mode = IDLE;
+    this->pendingpress = false;
+    this->pendingmove = false;
+    this->pendingrelease = false;
+    this->tracking = false;
+    this->id0 = this->id1 = -1;
+    this->lastdistance = 0.0;
+    this->lastangle = 0.0;
+    this->resetMotion();
+  }
+
+  ~TouchDeviceP() {
+    delete this->location2;
+    delete this->mousebutton;
+    delete this->motion;
+  }
+
+  void touchEvent(QTouchEvent * event);
+#if QT_VERSION >= 0x050200
+  void nativeGestureEvent(QNativeGestureEvent * event);
+#endif
+  void track(const QPointF & p0, const QPointF & p1, int id0, int id1);
+  void resetMotion(void);
+  void requestFrame(void);
+  SbVec2s toPixel(const QPointF & pos) const;
+  bool latch(void);
+  void applyMotion(QuarterWidget * quarter);
+
+  TouchDevice * master;
+  SoLocation2Event * location2;
+  SoMouseButtonEvent * mousebutton;
+  SoMotion3Event * motion;
+
+  Mode mode;
+  // the one finger drag, delivered at the next frame
+  bool pendingpress;
+  bool pendingmove;
+  bool pendingrelease;
+  QPointF position;
+
+  // the two fingers of the gesture as of the last touch update
+  bool tracking;
+  int id0, id1;
+  QPointF lastcentroid;
+  qreal lastdistance;
+  qreal lastangle;
+
+  // the gesture since the last frame
+  bool pendingmotion;
+  QPointF pan;
+  qreal scale;
+  qreal rotation;
+  QPointF centroid;
+};
+
+}}} // namespace
+
+using namespace SIM::Coin3D::Quarter;
+
+#define PRIVATE(obj) obj->pimpl
+#define PUBLIC(obj) obj->master
+
+TouchDevice::TouchDevice(QuarterWidget * quarter) :
+  InputDevice(quarter)
+{
+  PRIVATE(this) = new TouchDeviceP(this);
+  if (quarter) {
+    quarter->setAttribute(Qt::WA_AcceptTouchEvents);
+    this->windowsize = SbVec2s(quarter->width(), quarter->height());
+  }
+}
+
+TouchDevice::~TouchDevice()
+{
+  delete PRIVATE(this);
+}
+
+/*! Returns the touch and native gesture event types
+ */
+QList<QEvent::Type>
+TouchDevice::eventTypes(void) const
+{
+  QList<QEvent::Type> types;
+  types << QEvent::TouchBegin << QEvent::TouchUpdate
+        << QEvent::TouchEnd << QEvent::TouchCancel;
+#if QT_VERSION >= 0x050200
+  types << QEvent::NativeGesture;
+#endif
+  return types;
+}
+
+/*! Accumulates touch and gesture events until the next frame.
+  Always returns NULL, the events are sent by latchPendingMotion().
+ */
+const SoEvent *
+TouchDevice::translateEvent(QEvent * event)
+{
+  switch (event->type()) {
+  case QEvent::TouchBegin:
+  case QEvent::TouchUpdate:
+  case QEvent::TouchEnd:
+  case QEvent::TouchCancel:
+    PRIVATE(this)->touchEvent(static_cast<QTouchEvent *>(event));
+    break;
+#if QT_VERSION >= 0x050200
+  case QEvent::NativeGesture:
+    PRIVATE(this)->nativeGestureEvent(static_cast<QNativeGestureEvent *>(event));
+    break;
+#endif
+  default:
+    break;
+  }
+  return NULL;
+}
+
+/*!
+  Sends the touch input accumulated since the last frame to the
+  widget. Returns true if there was any. The EventFilter calls this
+  right before the widget renders a frame.
+ */
+bool
+TouchDevice::latchPendingMotion(void)
+{
+  return PRIVATE(this)->latch();
+}
+
+void
+TouchDeviceP::touchEvent(QTouchEvent * event)
+{
+  // trackpads report positions on the pad, not on the widget, and
+  // come with native gestures on the platforms that have them
+#if QT_VERSION >= 0x060000
+  if (event->device() && event->device()->type() == QInputDevice::DeviceType::TouchPad) return;
+#elif QT_VERSION >= 0x050000
+  if (event->device() && event->device()->type() == QTouchDevice::TouchPad) return;
+#else
+  if (event->deviceType() == QTouchEvent::TouchPad) return;
+#endif
+
+  PUBLIC(this)->setModifiers(this->location2, event);
+  PUBLIC(this)->setModifiers(this->mousebutton, event);
+
+  // the fingers still touching
+  QList<QPointF> positions;
+  QList<int> ids;
+  if (event->type() != QEvent::TouchEnd && event->type() != QEvent::TouchCancel) {
+#if QT_VERSION >= 0x060000
+    foreach (const QEventPoint & point, event->points()) {
+      if (point.state() == QEventPoint::Released) continue;
+      positions.append(point.position());
+      ids.append(point.id());
+    }
+#else
+    foreach (const QTouchEvent::TouchPoint & point, event->touchPoints()) {
+      if (point.state() == Qt::TouchPointReleased) continue;
+      positions.append(point.pos());
+      ids.append(point.id());
+    }
+#endif
+  }
+  const int count = positions.size();
+
+  switch (this->mode) {
+  case IDLE:
+    if (count == 1) {
+      // deliver a tap which ended in this frame before the next press
+      if (this->pendingrelease) this->latch();
+      this->mode = DRAG;
+      this->position = positions[0];
+      this->pendingpress = true;
+    }
+    else if (count >= 2) {
+      this->mode = GESTURE;
+      this->track(positions[0], positions[1], ids[0], ids[1]);
+    }
+    break;
+  case DRAG:
+    if (count == 1) {
+      this->position = positions[0];
+      this->pendingmove = true;
+    }
+    else {
+      this->pendingrelease = true;
+      this->mode = (count >= 2) ? GESTURE : IDLE;
+      if (count >= 2) this->track(positions[0], positions[1], ids[0], ids[1]);
+    }
+    break;
+  case GESTURE:
+    // the gesture lasts until the last finger is lifted
+    if (count >= 2) {
+      this->track(positions[0], positions[1], ids[0], ids[1]);
+    }
+    else {
+      this->tracking = false;
+      if (count == 0) this->mode = IDLE;
+    }
+    break;
+  }
+  this->requestFrame();
+}
+
+#if QT_VERSION >= 0x050200
+void
+TouchDeviceP::nativeGestureEvent(QNativeGestureEvent * event)
+{
+  switch (event->gestureType()) {
+  case Qt::ZoomNativeGesture:
+    this->scale *= 1.0 + event->value();
+    break;
+  case Qt::RotateNativeGesture:
+    this->rotation += event->value() * M_PI / 180.0;
+    break;
+  default:
+    return;
+  }
+#if QT_VERSION >= 0x060000
+  this->centroid = event->position();
+#else
+  this->centroid = event->localPos();
+#endif
+  PUBLIC(this)->setModifiers(this->motion, event);
+  this->pendingmotion = true;
+  this->requestFrame();
+}
+#endif
+
+/*
+  Adds the movement of the two fingers since the last touch update to
+  the gesture.
+ */
+void
+TouchDeviceP::track(const QPointF & p0, const QPointF & p1, int id0, int id1)
+{
+  const QPointF centroid = (p0 + p1) * 0.5;
+  const QPointF span = p1 - p0;
+  const qreal distance = sqrt(span.x() * span.x() + span.y() * span.y());
+  const qreal angle = atan2(span.y(), span.x());
+
+  if (this->tracking && id0 == this->id0 && id1 == this->id1) {
+    this->pan += centroid - this->lastcentroid;
+    if (this->lastdistance > 0.0 && distance > 0.0) {
+      this->scale *= distance / this->lastdistance;
+    }
+    qreal turn = angle - this->lastangle;
+    if (turn > M_PI) turn -= 2.0 * M_PI;
+    if (turn < -M_PI) turn += 2.0 * M_PI;
+    // Qt's y axis points down, so a positive turn is clockwise
+    this->rotation -= turn;
+    this->centroid = centroid;
+    this->pendingmotion = true;
+  }
+
+  this->tracking = true;
+  this->id0 = id0;
+  this->id1 = id1;
+  this->lastcentroid = centroid;
+  this->lastdistance = distance;
+  this->lastangle = angle;
+}
+
+void
+TouchDeviceP::resetMotion(void)
+{
+  this->pendingmotion = false;
+  this->pan = QPointF(0.0, 0.0);
+  this->scale = 1.0;
+  this->rotation = 0.0;
+}
+
+void
+TouchDeviceP::requestFrame(void)
+{
+  QuarterWidget * quarter = PUBLIC(this)->quarter;
+  if (quarter && quarter->getSoRenderManager()) {
+    quarter->getSoRenderManager()->scheduleRedraw();
+  }
+}
+
+SbVec2s
+TouchDeviceP::toPixel(const QPointF & pos) const
+{
+  SbVec2s pixel(short(pos.x()), short(PUBLIC(this)->windowsize[1] - pos.y() - 1));
+  // the following corrects for high-dpi displays (e.g., mac retina)
+  pixel *= PUBLIC(this)->devicepixelratio;
+  return pixel;
+}
+
+bool
+TouchDeviceP::latch(void)
+{
+  const bool pending = this->pendingpress || this->pendingmove ||
+    this->pendingrelease || this->pendingmotion;
+  QuarterWidget * quarter = PUBLIC(this)->quarter;
+  if (!pending || !quarter) {
+    this->pendingpress = this->pendingmove = this->pendingrelease = false;
+    this->resetMotion();
+    return false;
+  }
+
+  const SbTime now = SbTime::getTimeOfDay();
+  const SbVec2s pixel = this->toPixel(this->position);
+  this->location2->setPosition(pixel);
+  this->location2->setTime(now);
+  this->mousebutton->setPosition(pixel);
+  this->mousebutton->setTime(now);
+
+  if (this->pendingpress) {
+    this->mousebutton->setState(SoButtonEvent::DOWN);
+    quarter->processSoEvent(this->mousebutton);
+  }
+  if (this->pendingmove) {
+    quarter->processSoEvent(this->location2);
+  }
+  if (this->pendingrelease) {
+    this->mousebutton->setState(SoButtonEvent::UP);
+    quarter->processSoEvent(this->mousebutton);
+  }
+  this->pendingpress = this->pendingmove = this->pendingrelease = false;
+
+  if (this->pendingmotion) {
+    this->applyMotion(quarter);
+  }
+  this->resetMotion();
+  return true;
+}
+
+/*
+  Sends the gesture since the last frame as one SoMotion3Event, and
+  navigates the camera if nothing handled it.
+ */
+void
+TouchDeviceP::applyMotion(QuarterWidget * quarter)
+{
+  const SbVec2s size = PUBLIC(this)->windowsize;
+  if (size[0] <= 0 || size[1] <= 0) return;
+
+  const SbVec2f pan(float(this->pan.x() / size[0]), float(-this->pan.y() / size[1]));
+  const float zoom = float(log(this->scale));
+
+  this->motion->setTranslation(SbVec3f(pan[0], pan[1], zoom));
+  this->motion->setRotation(SbRotation(SbVec3f(0.0f, 0.0f, 1.0f), float(this->rotation)));
+  this->motion->setPosition(this->toPixel(this->centroid));
+  this->motion->setTime(SbTime::getTimeOfDay());
+  if (quarter->processSoEvent(this->motion)) return;
+
+  SoRenderManager * manager = quarter->getSoRenderManager();
+  SoCamera * camera = manager ? manager->getCamera() : NULL;
+  if (!camera) return;
+
+  const float aspectratio = manager->getViewportRegion().getViewportAspectRatio();
+  NativeNavigation::panCamera(camera, aspectratio, SbVec2f(0.5f, 0.5f), SbVec2f(0.5f, 0.5f) + pan);
+  // spreading the fingers zooms in
+  NativeNavigation::zoomCamera(camera, -zoom);
+  NativeNavigation::rollCamera(camera, float(this->rotation));
+}
+
+#undef PRIVATE
+#undef PUBLIC
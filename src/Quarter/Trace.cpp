@@ -0,0 +1,145 @@
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+/*
+  Collects complete ("X") events in memory and writes them as a
+  Chrome trace JSON file when Quarter is cleaned up. Timestamps are
+  microseconds since the first trace point, which is all the trace
+  viewers need to line up events across threads.
+ */
+
+#include "Trace.h"
+
+#ifdef QUARTER_TRACING
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QMutex>
+#include <QtCore/QThread>
+#include <QtCore/QVector>
+
+#include <Inventor/C/tidbits.h>
+
+using namespace SIM::Coin3D::Quarter;
+
+namespace {
+
+struct TraceEvent {
+  const char * name;
+  qint64 start;
+  qint64 duration;
+  quintptr thread;
+};
+
+QMutex tracemutex;
+QVector<TraceEvent> traceevents;
+QElapsedTimer traceclock;
+
+const char *
+trace_file(void)
+{
+  // the environment is only consulted once, not for every trace point
+  static int checked = 0;
+  static const char * file = NULL;
+  if (!checked) {
+    const char * env = coin_getenv("QUARTER_TRACE_FILE");
+    file = (env && env[0]) ? env : NULL;
+    checked = 1;
+  }
+  return file;
+}
+
+} // anonymous namespace
+
+TraceScope::TraceScope(const char * name)
+  : name(NULL), start(0)
+{
+  if (!TraceScope::enabled()) return;
+  this->name = name;
+  QMutexLocker locker(&tracemutex);
+  if (!traceclock.isValid()) traceclock.start();
+  this->start = traceclock.nsecsElapsed();
+}
+
+TraceScope::~TraceScope()
+{
+  if (!this->name) return;
+  QMutexLocker locker(&tracemutex);
+  TraceEvent event;
+  event.name = this->name;
+  event.start = this->start;
+  event.duration = traceclock.nsecsElapsed() - this->start;
+  event.thread = quintptr(QThread::currentThreadId());
+  traceevents.append(event);
+}
+
+bool
+TraceScope::enabled(void)
+{
+  return trace_file() != NULL;
+}
+
+void
+TraceScope::flush(void)
+{
+  const char * filename = trace_file();
+  if (!filename) return;
+
+  QMutexLocker locker(&tracemutex);
+  if (traceevents.isEmpty()) return;
+
+  FILE * fp = fopen(filename, "w");
+  if (!fp) {
+    fprintf(stderr, "Quarter: unable to write trace file '%s'\n", filename);
+    return;
+  }
+
+  const qint64 pid = QCoreApplication::applicationPid();
+  fprintf(fp, "{\"traceEvents\":[\n");
+  for (int i = 0; i < traceevents.size(); i++) {
+    const TraceEvent & event = traceevents[i];
+    // trace point names are string literals, no escaping needed
+    fprintf(fp, "%s{\"name\":\"%s\",\"cat\":\"quarter\",\"ph\":\"X\","
+            "\"ts\":%.3f,\"dur\":%.3f,\"pid\":%lld,\"tid\":%llu}",
+            i ? ",\n" : "", event.name,
+            double(event.start) / 1000.0, double(event.duration) / 1000.0,
+            (long long) pid, (unsigned long long) event.thread);
+  }
+  fprintf(fp, "\n],\"displayTimeUnit\":\"ms\"}\n");
+  fclose(fp);
+  traceevents.clear();
+}
+
+#endif // QUARTER_TRACING
@@ -0,0 +1,77 @@
+#ifndef QUARTER_TRACE_H
+#define QUARTER_TRACE_H
+
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+/*
+  Scoped trace points for the event and render pipeline. They are only
+  compiled in when Quarter is configured with QUARTER_ENABLE_TRACING,
+  and only record anything when QUARTER_TRACE_FILE names the Chrome
+  trace file (chrome://tracing, ui.perfetto.dev) to write at exit.
+ */
+
+#ifdef QUARTER_TRACING
+
+#include <QtCore/QtGlobal>
+
+namespace SIM { namespace Coin3D { namespace Quarter {
+
+class TraceScope {
+public:
+  TraceScope(const char * name);
+  ~TraceScope();
+
+  static bool enabled(void);
+  static void flush(void);
+
+private:
+  const char * name;
+  qint64 start;
+};
+
+}}} // namespace
+
+#define QUARTER_TRACE_CONCAT2(a, b) a##b
+#define QUARTER_TRACE_CONCAT(a, b) QUARTER_TRACE_CONCAT2(a, b)
+#define QUARTER_TRACE_SCOPE(name) \
+  SIM::Coin3D::Quarter::TraceScope QUARTER_TRACE_CONCAT(tracescope_, __LINE__)(name)
+#define QUARTER_TRACE_FLUSH() SIM::Coin3D::Quarter::TraceScope::flush()
+
+#else // !QUARTER_TRACING
+
+#define QUARTER_TRACE_SCOPE(name) do { } while (0)
+#define QUARTER_TRACE_FLUSH() do { } while (0)
+
+#endif // !QUARTER_TRACING
+
+#endif // QUARTER_TRACE_H
@@ -0,0 +1,195 @@
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+/*
+  Records the frames presented by a QuarterWidget. Every rendered
+  frame is read back through FrameCapture's pixel buffer ring, put in
+  a bounded queue, and handed to a FrameSink from an encoder thread,
+  so that neither readback nor encoding stall the GUI thread. When
+  the queue is full, frames are either dropped or the GUI thread
+  waits for the encoder, depending on the policy.
+ */
+
+#include "VideoRecorder.h"
+
+#include <Quarter/FrameSink.h>
+
+#include "FrameCapture.h"
+
+using namespace SIM::Coin3D::Quarter;
+
+VideoRecorder::VideoRecorder(FrameCapture * framecapture)
+{
+  this->framecapture = framecapture;
+  this->sink = NULL;
+  this->recording = false;
+  this->block = false;
+  this->queuelength = 0;
+  this->stopping = false;
+  this->failed = false;
+}
+
+VideoRecorder::~VideoRecorder()
+{
+  this->stopRecording();
+}
+
+bool
+VideoRecorder::startRecording(FrameSink * sink, bool block, int queuelength)
+{
+  if (!sink) return false;
+  this->stopRecording();
+
+  this->sink = sink;
+  this->block = block;
+  this->queuelength = qMax(1, queuelength);
+  this->stopping = false;
+  this->failed = false;
+  this->recorded.fetchAndStoreRelaxed(0);
+  this->dropped.fetchAndStoreRelaxed(0);
+  this->starttime = SbTime::getTimeOfDay();
+  this->recording = true;
+
+  this->start();
+  this->framecapture->setContinuous(VideoRecorder::frameCB, this);
+  return true;
+}
+
+/*
+  Waits for the encoder to write the queued frames and closes the
+  sink. Frames still being read back are dropped.
+ */
+void
+VideoRecorder::stopRecording(void)
+{
+  if (!this->recording) return;
+  this->recording = false;
+  this->framecapture->setContinuous(NULL, NULL);
+
+  {
+    QMutexLocker locker(&this->mutex);
+    this->stopping = true;
+    this->notempty.wakeOne();
+  }
+  this->wait();
+  this->queue.clear();
+  this->sink = NULL;
+}
+
+bool
+VideoRecorder::isRecording(void) const
+{
+  return this->recording;
+}
+
+int
+VideoRecorder::recordedFrames(void) const
+{
+  return this->recorded.fetchAndAddRelaxed(0);
+}
+
+int
+VideoRecorder::droppedFrames(void) const
+{
+  return this->dropped.fetchAndAddRelaxed(0);
+}
+
+void
+VideoRecorder::frameCB(void * userdata, const QImage & image)
+{
+  VideoRecorder * thisp = static_cast<VideoRecorder *>(userdata);
+  // readbacks issued before the recording was stopped
+  if (!thisp->recording || image.isNull()) return;
+  thisp->enqueue(image);
+}
+
+void
+VideoRecorder::enqueue(const QImage & image)
+{
+  const double timestamp = (SbTime::getTimeOfDay() - this->starttime).getValue();
+
+  QMutexLocker locker(&this->mutex);
+  if (this->failed) return;
+  if (this->queue.size() >= this->queuelength) {
+    if (!this->block) {
+      this->dropped.ref();
+      return;
+    }
+    while (this->queue.size() >= this->queuelength && !this->failed) {
+      this->notfull.wait(&this->mutex);
+    }
+    if (this->failed) return;
+  }
+  this->queue.append(qMakePair(image, timestamp));
+  this->notempty.wakeOne();
+}
+
+void
+VideoRecorder::run(void)
+{
+  bool opened = false;
+  QSize size;
+  for (;;) {
+    QPair<QImage, double> frame;
+    {
+      QMutexLocker locker(&this->mutex);
+      while (this->queue.isEmpty() && !this->stopping) {
+        this->notempty.wait(&this->mutex);
+      }
+      if (this->queue.isEmpty()) break;
+      frame = this->queue.takeFirst();
+      this->notfull.wakeOne();
+    }
+
+    bool ok = true;
+    if (!opened) {
+      size = frame.first.size();
+      ok = opened = this->sink->open(size);
+    }
+    else if (frame.first.size() != size) {
+      // the sink is opened for one size, frames rendered after the
+      // widget was resized are dropped
+      this->dropped.ref();
+      continue;
+    }
+    if (ok) ok = this->sink->writeFrame(frame.first, frame.second);
+    if (!ok) {
+      QMutexLocker locker(&this->mutex);
+      this->failed = true;
+      this->queue.clear();
+      this->notfull.wakeAll();
+      break;
+    }
+    this->recorded.ref();
+  }
+  if (opened) this->sink->close();
+}
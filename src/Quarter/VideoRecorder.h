@@ -0,0 +1,88 @@
+#ifndef QUARTER_VIDEORECORDER_H
+#define QUARTER_VIDEORECORDER_H
+
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+#include <QtCore/QAtomicInt>
+#include <QtCore/QList>
+#include <QtCore/QMutex>
+#include <QtCore/QPair>
+#include <QtCore/QThread>
+#include <QtCore/QWaitCondition>
+#include <QImage>
+#include <Inventor/SbTime.h>
+
+namespace SIM { namespace Coin3D { namespace Quarter {
+
+class FrameCapture;
+class FrameSink;
+
+class VideoRecorder : public QThread {
+public:
+  VideoRecorder(FrameCapture * framecapture);
+  ~VideoRecorder();
+
+  bool startRecording(FrameSink * sink, bool block, int queuelength);
+  void stopRecording(void);
+  bool isRecording(void) const;
+
+  int recordedFrames(void) const;
+  int droppedFrames(void) const;
+
+protected:
+  virtual void run(void);
+
+private:
+  static void frameCB(void * userdata, const QImage & image);
+  void enqueue(const QImage & image);
+
+  FrameCapture * framecapture;
+  FrameSink * sink;
+  bool recording;
+  bool block;
+  int queuelength;
+  SbTime starttime;
+  mutable QAtomicInt recorded;
+  mutable QAtomicInt dropped;
+
+  QMutex mutex;
+  QWaitCondition notempty;
+  QWaitCondition notfull;
+  QList<QPair<QImage, double> > queue;
+  bool stopping;
+  bool failed;
+};
+
+}}} // namespace
+
+#endif // QUARTER_VIDEORECORDER_H
@@ -0,0 +1,341 @@
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+/*
+  Renders transparent shapes with weighted blended order-independent
+  transparency. The opaque shapes are rendered by the render manager
+  as usual, with the installed QuarterRenderAction leaving out the
+  transparent ones. From the post-render callback, before any
+  superimpositions are drawn, the transparent shapes are then
+  rendered into an offscreen buffer holding a copy of the opaque
+  depth buffer: once adding up their premultiplied colors and
+  alphas, and once multiplying up their remaining transmittance. A
+  final full-window pass divides the color sum by the alpha sum and
+  blends the result over the opaque image.
+
+  Coin renders shapes with the fixed-function pipeline, so every
+  fragment gets the same weight, i.e. this is the weighted average
+  variant of the technique. It needs two passes over the transparent
+  shapes regardless of how deeply they overlap, where
+  SORTED_LAYERS_BLEND needs a pass over the whole scene for every
+  layer.
+ */
+
+#include "WeightedBlendedTransparency.h"
+
+#include <QtCore/QSize>
+#include <QtCore/QVector>
+
+#if (QT_VERSION >= 0x050600)
+#  include <QOpenGLContext>
+#  include <QOpenGLExtraFunctions>
+#  include <QOpenGLFramebufferObject>
+#  include <QOpenGLFramebufferObjectFormat>
+#  include <QOpenGLShaderProgram>
+#endif
+
+#include <Inventor/SbViewportRegion.h>
+#include <Inventor/SoRenderManager.h>
+#include <Inventor/actions/SoGLRenderAction.h>
+#include <Inventor/system/gl.h>
+
+#include <Quarter/QuarterWidget.h>
+
+#include "QuarterRenderAction.h"
+
+#ifndef GL_RGBA16F
+#define GL_RGBA16F 0x881A
+#endif
+#ifndef GL_R16F
+#define GL_R16F 0x822D
+#endif
+
+using namespace SIM::Coin3D::Quarter;
+
+#if (QT_VERSION >= 0x050600)
+
+static const char * composite_vertex_shader =
+  "void main(void)\n"
+  "{\n"
+  "  gl_TexCoord[0] = gl_MultiTexCoord0;\n"
+  "  gl_Position = gl_Vertex;\n"
+  "}\n";
+
+static const char * composite_fragment_shader =
+  "uniform sampler2D accumulation;\n"
+  "uniform sampler2D revealage;\n"
+  "void main(void)\n"
+  "{\n"
+  "  vec4 sum = texture2D(accumulation, gl_TexCoord[0].st);\n"
+  "  if (sum.a <= 0.00001) discard;\n"
+  "  float transmittance = texture2D(revealage, gl_TexCoord[0].st).r;\n"
+  "  gl_FragColor = vec4(sum.rgb / sum.a, 1.0 - transmittance);\n"
+  "}\n";
+
+#endif // QT_VERSION >= 0x050600
+
+WeightedBlendedTransparency::WeightedBlendedTransparency(QuarterWidget * quarterwidget,
+                                                         CustomRenderAction * customaction)
+{
+  this->quarterwidget = quarterwidget;
+  this->customaction = customaction;
+  this->transparentaction = NULL;
+  this->fbo = NULL;
+  this->program = NULL;
+  this->isenabled = false;
+  this->active = false;
+  this->support = -1;
+}
+
+WeightedBlendedTransparency::~WeightedBlendedTransparency()
+{
+  delete this->transparentaction;
+}
+
+void
+WeightedBlendedTransparency::setEnabled(bool yes)
+{
+  this->isenabled = yes;
+  this->customaction->setShapeFiltering(yes);
+}
+
+bool
+WeightedBlendedTransparency::enabled(void) const
+{
+  return this->isenabled;
+}
+
+/*
+  Called from the pre-render callback. Decides whether the frame is
+  rendered with weighted blended transparency, and leaves the
+  transparent shapes out of the render manager's pass if so. Other
+  render modes and transparency types set during navigation are
+  rendered as usual.
+ */
+void
+WeightedBlendedTransparency::beginFrame(SoRenderManager * manager)
+{
+  this->active = false;
+  QuarterRenderAction * action = this->customaction->installedAction();
+  if (!this->isenabled || !action || manager->getGLRenderAction() != action) return;
+
+  this->active =
+    action->getTransparencyType() == SoGLRenderAction::NONE &&
+    manager->getRenderMode() == SoRenderManager::AS_IS &&
+    this->supported();
+  action->setShapeFilter(this->active ?
+                         QuarterRenderAction::OPAQUE_SHAPES :
+                         QuarterRenderAction::ALL_SHAPES);
+}
+
+/*
+  Called from the post-render callback. Renders the transparent
+  shapes and composites them over the opaque ones.
+ */
+void
+WeightedBlendedTransparency::endFrame(SoRenderManager * manager)
+{
+  if (!this->active) return;
+  this->active = false;
+
+#if (QT_VERSION >= 0x050600)
+  QOpenGLExtraFunctions * gl = QOpenGLContext::currentContext()->extraFunctions();
+  SoGLRenderAction * mainaction = manager->getGLRenderAction();
+  SoNode * scene = manager->getSceneGraph();
+  if (!scene) return;
+
+  const SbVec2s windowsize = mainaction->getViewportRegion().getWindowSize();
+  const QSize size(windowsize[0], windowsize[1]);
+  if (!this->fbo || this->fbo->size() != size) {
+    delete this->fbo;
+    QOpenGLFramebufferObjectFormat format;
+    format.setAttachment(QOpenGLFramebufferObject::CombinedDepthStencil);
+    format.setInternalTextureFormat(GL_RGBA16F);
+    this->fbo = new QOpenGLFramebufferObject(size, format);
+    this->fbo->addColorAttachment(size, GL_R16F);
+  }
+
+  if (!this->transparentaction) {
+    this->transparentaction = new QuarterRenderAction(mainaction->getViewportRegion());
+    this->transparentaction->setShapeFilter(QuarterRenderAction::TRANSPARENT_SHAPES);
+  }
+  QuarterRenderAction::copySettings(mainaction, this->transparentaction);
+  this->transparentaction->setTransparencyType(SoGLRenderAction::NONE);
+  this->transparentaction->setNumPasses(1);
+  this->transparentaction->setProjectionJitter(
+    static_cast<QuarterRenderAction *>(mainaction)->projectionJitter());
+
+  // the window may be a framebuffer object of its own, e.g. with
+  // reduced resolution rendering
+  GLint target = 0;
+  glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &target);
+
+  // the transparent shapes are depth tested against the opaque ones
+  gl->glBindFramebuffer(GL_READ_FRAMEBUFFER, target);
+  gl->glBindFramebuffer(GL_DRAW_FRAMEBUFFER, this->fbo->handle());
+  gl->glBlitFramebuffer(0, 0, size.width(), size.height(),
+                        0, 0, size.width(), size.height(),
+                        GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+  gl->glBindFramebuffer(GL_FRAMEBUFFER, this->fbo->handle());
+
+  glPushAttrib(GL_ALL_ATTRIB_BITS);
+  glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+  GLenum buffer = GL_COLOR_ATTACHMENT0;
+  gl->glDrawBuffers(1, &buffer);
+  glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+  glClear(GL_COLOR_BUFFER_BIT);
+  buffer = GL_COLOR_ATTACHMENT1;
+  gl->glDrawBuffers(1, &buffer);
+  glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
+  glClear(GL_COLOR_BUFFER_BIT);
+
+  // sum of premultiplied colors in rgb, sum of alphas in alpha
+  buffer = GL_COLOR_ATTACHMENT0;
+  gl->glDrawBuffers(1, &buffer);
+  this->transparentaction->setTransparentBlending(GL_SRC_ALPHA, GL_ONE, GL_ONE, GL_ONE);
+  this->transparentaction->apply(scene);
+
+  // product of (1 - alpha) in red
+  buffer = GL_COLOR_ATTACHMENT1;
+  gl->glDrawBuffers(1, &buffer);
+  this->transparentaction->setTransparentBlending(GL_ZERO, GL_ONE_MINUS_SRC_ALPHA,
+                                                  GL_ZERO, GL_ONE_MINUS_SRC_ALPHA);
+  this->transparentaction->apply(scene);
+  glPopAttrib();
+
+  gl->glBindFramebuffer(GL_FRAMEBUFFER, target);
+  this->drawComposite();
+#else
+  Q_UNUSED(manager);
+#endif
+}
+
+bool
+WeightedBlendedTransparency::hasFramebuffer(void) const
+{
+  return this->fbo != NULL || this->program != NULL;
+}
+
+/*
+  Releases the framebuffer and the shader program. Must be called
+  with the widget's GL context current.
+ */
+void
+WeightedBlendedTransparency::cleanup(void)
+{
+#if (QT_VERSION >= 0x050600)
+  delete this->fbo;
+  delete this->program;
+#endif
+  this->fbo = NULL;
+  this->program = NULL;
+  this->support = -1;
+}
+
+/*
+  Checks, once per GL context, for float render targets, multiple
+  color attachments, framebuffer blits and shaders, and builds the
+  composite shader.
+ */
+bool
+WeightedBlendedTransparency::supported(void)
+{
+#if (QT_VERSION >= 0x050600)
+  if (this->support >= 0) return this->support == 1;
+  this->support = 0;
+
+  QOpenGLContext * context = QOpenGLContext::currentContext();
+  if (!context) return false;
+  const bool gl3 = context->format().majorVersion() >= 3;
+  if (!QOpenGLFramebufferObject::hasOpenGLFramebufferObjects() ||
+      !QOpenGLFramebufferObject::hasOpenGLFramebufferBlit() ||
+      !QOpenGLShaderProgram::hasOpenGLShaderPrograms(context) ||
+      !(gl3 || (context->hasExtension("GL_ARB_texture_float") &&
+                context->hasExtension("GL_ARB_texture_rg")))) {
+    return false;
+  }
+
+  this->program = new QOpenGLShaderProgram;
+  if (!this->program->addShaderFromSourceCode(QOpenGLShader::Vertex, composite_vertex_shader) ||
+      !this->program->addShaderFromSourceCode(QOpenGLShader::Fragment, composite_fragment_shader) ||
+      !this->program->link()) {
+    delete this->program;
+    this->program = NULL;
+    return false;
+  }
+  this->support = 1;
+  return true;
+#else
+  return false;
+#endif
+}
+
+void
+WeightedBlendedTransparency::drawComposite(void)
+{
+#if (QT_VERSION >= 0x050600)
+  QOpenGLExtraFunctions * gl = QOpenGLContext::currentContext()->extraFunctions();
+  const QVector<GLuint> textures = this->fbo->textures();
+
+  glPushAttrib(GL_ENABLE_BIT | GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT |
+               GL_TEXTURE_BIT | GL_VIEWPORT_BIT);
+  glViewport(0, 0, this->fbo->width(), this->fbo->height());
+  glDisable(GL_DEPTH_TEST);
+  glDisable(GL_LIGHTING);
+  glDisable(GL_CULL_FACE);
+  glEnable(GL_BLEND);
+  glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+  gl->glActiveTexture(GL_TEXTURE1);
+  glBindTexture(GL_TEXTURE_2D, textures[1]);
+  gl->glActiveTexture(GL_TEXTURE0);
+  glBindTexture(GL_TEXTURE_2D, textures[0]);
+
+  this->program->bind();
+  this->program->setUniformValue("accumulation", 0);
+  this->program->setUniformValue("revealage", 1);
+
+  glBegin(GL_QUADS);
+  glTexCoord2f(0.0f, 0.0f); glVertex2f(-1.0f, -1.0f);
+  glTexCoord2f(1.0f, 0.0f); glVertex2f(1.0f, -1.0f);
+  glTexCoord2f(1.0f, 1.0f); glVertex2f(1.0f, 1.0f);
+  glTexCoord2f(0.0f, 1.0f); glVertex2f(-1.0f, 1.0f);
+  glEnd();
+
+  this->program->release();
+  gl->glActiveTexture(GL_TEXTURE1);
+  glBindTexture(GL_TEXTURE_2D, 0);
+  gl->glActiveTexture(GL_TEXTURE0);
+  glBindTexture(GL_TEXTURE_2D, 0);
+  glPopAttrib();
+#endif
+}
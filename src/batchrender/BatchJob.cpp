@@ -0,0 +1,144 @@
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+#include "BatchJob.h"
+
+#include <QStringList>
+#if QT_VERSION >= 0x050F00
+#include <QRegularExpression>
+#else
+#include <QRegExp>
+#endif
+
+static bool
+parseFloats(const QString & value, int count, float * result)
+{
+  const QStringList parts = value.split(',');
+  if (parts.size() != count) return false;
+  for (int i = 0; i < count; i++) {
+    bool ok;
+    result[i] = parts[i].toFloat(&ok);
+    if (!ok) return false;
+  }
+  return true;
+}
+
+BatchJob::BatchJob(void)
+  : size(256, 256), background(Qt::black),
+    hasposition(false), hasorientation(false), haslookat(false),
+    viewall(true)
+{
+}
+
+bool
+BatchJob::parse(const QString & line, const QSize & defaultsize, QString & error)
+{
+#if QT_VERSION >= 0x050F00
+  const QStringList fields = line.split(QRegularExpression("\\s+"), Qt::SkipEmptyParts);
+#else
+  const QStringList fields = line.split(QRegExp("\\s+"), QString::SkipEmptyParts);
+#endif
+  if (fields.size() < 2) {
+    error = "expected an input and an output file";
+    return false;
+  }
+
+  this->input = fields[0];
+  this->output = fields[1];
+  this->size = defaultsize;
+  bool viewallgiven = false;
+
+  for (int i = 2; i < fields.size(); i++) {
+    const QString key = fields[i].section('=', 0, 0);
+    const QString value = fields[i].section('=', 1);
+    float v[4];
+
+    if (key == "size") {
+      const QStringList wh = value.split('x');
+      if (wh.size() != 2 || wh[0].toInt() <= 0 || wh[1].toInt() <= 0) {
+        error = QString("invalid size '%1'").arg(value);
+        return false;
+      }
+      this->size = QSize(wh[0].toInt(), wh[1].toInt());
+    }
+    else if (key == "position" && parseFloats(value, 3, v)) {
+      this->position.setValue(v[0], v[1], v[2]);
+      this->hasposition = true;
+    }
+    else if (key == "orientation" && parseFloats(value, 4, v)) {
+      this->orientation.setValue(SbVec3f(v[0], v[1], v[2]), v[3]);
+      this->hasorientation = true;
+    }
+    else if (key == "lookat" && parseFloats(value, 3, v)) {
+      this->lookat.setValue(v[0], v[1], v[2]);
+      this->haslookat = true;
+    }
+    else if (key == "viewall" && (value == "0" || value == "1")) {
+      this->viewall = value == "1";
+      viewallgiven = true;
+    }
+    else if (key == "background" && QColor(value).isValid()) {
+      this->background = QColor(value);
+    }
+    else {
+      error = QString("invalid camera spec '%1'").arg(fields[i]);
+      return false;
+    }
+  }
+
+  if (!viewallgiven) this->viewall = !this->hasposition;
+  return true;
+}
+
+JobQueue::JobQueue(const QList<BatchJob> & jobs)
+  : jobs(jobs), next(0)
+{
+}
+
+/*
+  Hands out the next job to a render thread. Returns false when all
+  jobs have been taken.
+ */
+bool
+JobQueue::take(BatchJob & job)
+{
+  QMutexLocker locker(&this->mutex);
+  if (this->next >= this->jobs.size()) return false;
+  job = this->jobs[this->next++];
+  return true;
+}
+
+int
+JobQueue::size(void) const
+{
+  return this->jobs.size();
+}
@@ -0,0 +1,85 @@
+#ifndef QUARTER_BATCHJOB_H
+#define QUARTER_BATCHJOB_H
+
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+#include <QColor>
+#include <QList>
+#include <QMutex>
+#include <QSize>
+#include <QString>
+
+#include <Inventor/SbLinear.h>
+
+/*
+  One line of a job file:
+
+    input.iv output.png [size=WxH] [position=x,y,z]
+                        [orientation=x,y,z,radians] [lookat=x,y,z]
+                        [viewall=0|1] [background=#rrggbb]
+
+  Lines which are empty or start with '#' are skipped. Unless a
+  position is given, the camera is moved to show the whole scene.
+ */
+struct BatchJob {
+  BatchJob(void);
+
+  bool parse(const QString & line, const QSize & defaultsize, QString & error);
+
+  QString input;
+  QString output;
+  QSize size;
+  QColor background;
+  bool hasposition;
+  SbVec3f position;
+  bool hasorientation;
+  SbRotation orientation;
+  bool haslookat;
+  SbVec3f lookat;
+  bool viewall;
+};
+
+class JobQueue {
+public:
+  JobQueue(const QList<BatchJob> & jobs);
+
+  bool take(BatchJob & job);
+  int size(void) const;
+
+private:
+  QMutex mutex;
+  QList<BatchJob> jobs;
+  int next;
+};
+
+#endif // QUARTER_BATCHJOB_H
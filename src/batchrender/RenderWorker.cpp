@@ -0,0 +1,192 @@
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+/*
+  A RenderWorker renders jobs until the queue is empty, with a
+  QuarterOffscreenRenderer which has been moved to its thread, and
+  thereby its own OpenGL context and SoRenderManager. Rendered images
+  are handed to the ImageEncoder, which compresses and writes them in
+  a thread pool of its own while the next job is rendered. At most two
+  images per encoder thread are waiting, so that the render threads
+  are held back when encoding cannot keep up.
+ */
+
+#include "RenderWorker.h"
+#include "BatchJob.h"
+
+#include <QCoreApplication>
+#include <QMutex>
+#include <QRunnable>
+
+#include <Inventor/SoDB.h>
+#include <Inventor/SoInput.h>
+#include <Inventor/nodes/SoCamera.h>
+#include <Inventor/nodes/SoSeparator.h>
+
+#include <Quarter/QuarterOffscreenRenderer.h>
+
+using namespace SIM::Coin3D::Quarter;
+
+// SoInput and the Coin name dictionary used while reading are shared
+// by all threads
+static QMutex readmutex;
+
+class EncodeTask : public QRunnable {
+public:
+  EncodeTask(ImageEncoder * encoder, const QImage & image, const QString & filename)
+    : encoder(encoder), image(image), filename(filename)
+  { }
+
+  virtual void run(void) {
+    if (!this->image.save(this->filename, NULL, this->encoder->quality)) {
+      qWarning("Unable to write %s", qPrintable(this->filename));
+      this->encoder->failed.ref();
+    }
+    this->encoder->slots.release();
+  }
+
+private:
+  ImageEncoder * encoder;
+  QImage image;
+  QString filename;
+};
+
+ImageEncoder::ImageEncoder(int threads, int quality)
+  : slots(2 * qMax(threads, 1)), failed(0), quality(quality)
+{
+  this->pool.setMaxThreadCount(qMax(threads, 1));
+}
+
+ImageEncoder::~ImageEncoder()
+{
+  this->waitForDone();
+}
+
+/*
+  Queues \a image to be written to \a filename, in the format given by
+  the file suffix. Blocks if too many images are waiting already.
+ */
+void
+ImageEncoder::encode(const QImage & image, const QString & filename)
+{
+  this->slots.acquire();
+  this->pool.start(new EncodeTask(this, image, filename));
+}
+
+void
+ImageEncoder::waitForDone(void)
+{
+  this->pool.waitForDone();
+}
+
+int
+ImageEncoder::failures(void) const
+{
+  return this->failed.fetchAndAddRelaxed(0);
+}
+
+RenderWorker::RenderWorker(JobQueue * queue, ImageEncoder * encoder,
+                           QuarterOffscreenRenderer * renderer)
+  : queue(queue), encoder(encoder), renderer(renderer),
+    renderedjobs(0), failedjobs(0)
+{
+}
+
+int
+RenderWorker::rendered(void) const
+{
+  return this->renderedjobs;
+}
+
+int
+RenderWorker::failures(void) const
+{
+  return this->failedjobs;
+}
+
+void
+RenderWorker::run(void)
+{
+  BatchJob job;
+  while (this->queue->take(job)) {
+    if (this->render(job)) {
+      this->renderedjobs++;
+    }
+    else {
+      this->failedjobs++;
+    }
+  }
+  // the renderer is deleted in the GUI thread
+  this->renderer->moveToThread(QCoreApplication::instance()->thread());
+}
+
+bool
+RenderWorker::render(const BatchJob & job)
+{
+  SoSeparator * root = NULL;
+  {
+    QMutexLocker locker(&readmutex);
+    SoInput in;
+    if (in.openFile(job.input.toLocal8Bit().constData())) {
+      root = SoDB::readAll(&in);
+    }
+  }
+  if (!root) {
+    qWarning("Unable to read %s", qPrintable(job.input));
+    return false;
+  }
+  root->ref();
+
+  this->renderer->setSize(job.size);
+  this->renderer->setBackgroundColor(job.background);
+  this->renderer->setSceneGraph(root);
+
+  SoCamera * camera = this->renderer->getCamera();
+  if (job.hasorientation) camera->orientation = job.orientation;
+  if (job.hasposition) camera->position = job.position;
+  if (job.haslookat) {
+    camera->pointAt(job.lookat);
+    camera->focalDistance = (job.lookat - camera->position.getValue()).length();
+  }
+  if (job.viewall) this->renderer->viewAll();
+
+  const QImage image = this->renderer->grabImage();
+  this->renderer->setSceneGraph(NULL);
+  root->unref();
+
+  if (image.isNull()) {
+    qWarning("Unable to render %s", qPrintable(job.input));
+    return false;
+  }
+  this->encoder->encode(image, job.output);
+  return true;
+}
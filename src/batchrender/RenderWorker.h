@@ -0,0 +1,90 @@
+#ifndef QUARTER_RENDERWORKER_H
+#define QUARTER_RENDERWORKER_H
+
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+#include <QAtomicInt>
+#include <QImage>
+#include <QSemaphore>
+#include <QString>
+#include <QThread>
+#include <QThreadPool>
+
+struct BatchJob;
+class JobQueue;
+
+namespace SIM { namespace Coin3D { namespace Quarter {
+class QuarterOffscreenRenderer;
+}}}
+
+class ImageEncoder {
+public:
+  ImageEncoder(int threads, int quality);
+  ~ImageEncoder();
+
+  void encode(const QImage & image, const QString & filename);
+  void waitForDone(void);
+
+  int failures(void) const;
+
+private:
+  friend class EncodeTask;
+
+  QThreadPool pool;
+  QSemaphore slots;
+  mutable QAtomicInt failed;
+  int quality;
+};
+
+class RenderWorker : public QThread {
+public:
+  RenderWorker(JobQueue * queue, ImageEncoder * encoder,
+               SIM::Coin3D::Quarter::QuarterOffscreenRenderer * renderer);
+
+  int rendered(void) const;
+  int failures(void) const;
+
+protected:
+  virtual void run(void);
+
+private:
+  bool render(const BatchJob & job);
+
+  JobQueue * queue;
+  ImageEncoder * encoder;
+  SIM::Coin3D::Quarter::QuarterOffscreenRenderer * renderer;
+  int renderedjobs;
+  int failedjobs;
+};
+
+#endif // QUARTER_RENDERWORKER_H
@@ -0,0 +1,191 @@
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+/*
+  quarter-batchrender renders many scene graphs to image files in one
+  process, with a pool of render threads which each have their own
+  OpenGL context, while a pool of encoder threads writes the images.
+
+  quarter-batchrender [--threads N] [--encoders N] [--size WxH]
+                      [--quality Q] [--jobs jobfile] [--output-dir dir]
+                      [file.iv ...]
+
+  Jobs are read from the job file, see BatchJob.h for its format, and
+  every file given on the command line is rendered with the whole
+  scene in view to a PNG file of the same base name in the output
+  directory. Coin must be built thread safe for more than one render
+  thread. Use -platform offscreen on machines without a display.
+ */
+
+#include <QCommandLineParser>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QGuiApplication>
+#include <QTextStream>
+#include <QThread>
+
+#include <stdio.h>
+
+#include <Quarter/Quarter.h>
+#include <Quarter/QuarterOffscreenRenderer.h>
+
+#include "BatchJob.h"
+#include "RenderWorker.h"
+
+using namespace SIM::Coin3D::Quarter;
+
+static bool
+readJobFile(const QString & filename, const QSize & defaultsize, QList<BatchJob> & jobs)
+{
+  QFile file(filename);
+  if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+    fprintf(stderr, "Unable to open %s\n", qPrintable(filename));
+    return false;
+  }
+
+  QTextStream stream(&file);
+  int linenumber = 0;
+  while (!stream.atEnd()) {
+    const QString line = stream.readLine().trimmed();
+    linenumber++;
+    if (line.isEmpty() || line.startsWith('#')) continue;
+
+    BatchJob job;
+    QString error;
+    if (!job.parse(line, defaultsize, error)) {
+      fprintf(stderr, "%s:%d: %s\n", qPrintable(filename), linenumber, qPrintable(error));
+      return false;
+    }
+    jobs.append(job);
+  }
+  return true;
+}
+
+int
+main(int argc, char ** argv)
+{
+  QGuiApplication app(argc, argv);
+  app.setApplicationName("quarter-batchrender");
+
+  const QString threads = QString::number(QThread::idealThreadCount());
+  QCommandLineParser parser;
+  parser.setApplicationDescription("Renders Coin scene graphs to image files in parallel.");
+  parser.addHelpOption();
+  parser.addPositionalArgument("files", "Inventor or VRML files to render.", "[file.iv ...]");
+  QCommandLineOption threadsoption("threads", "Number of render threads.", "count", threads);
+  QCommandLineOption encodersoption("encoders", "Number of encoder threads.", "count", threads);
+  QCommandLineOption sizeoption("size", "Default image size.", "WxH", "256x256");
+  QCommandLineOption qualityoption("quality", "Image quality, or -1 for the format default.", "quality", "-1");
+  QCommandLineOption jobsoption("jobs", "Job file with one scene and camera per line.", "jobfile");
+  QCommandLineOption outputoption("output-dir", "Directory for the images of the files given on the command line.", "dir", ".");
+  parser.addOption(threadsoption);
+  parser.addOption(encodersoption);
+  parser.addOption(sizeoption);
+  parser.addOption(qualityoption);
+  parser.addOption(jobsoption);
+  parser.addOption(outputoption);
+  parser.process(app);
+
+  QSize defaultsize(256, 256);
+  const QStringList size = parser.value(sizeoption).split('x');
+  if (size.size() == 2 && size[0].toInt() > 0 && size[1].toInt() > 0) {
+    defaultsize = QSize(size[0].toInt(), size[1].toInt());
+  }
+
+  QList<BatchJob> jobs;
+  if (parser.isSet(jobsoption) &&
+      !readJobFile(parser.value(jobsoption), defaultsize, jobs)) {
+    return 1;
+  }
+  const QDir outputdir(parser.value(outputoption));
+  foreach (const QString & file, parser.positionalArguments()) {
+    BatchJob job;
+    job.input = file;
+    job.output = outputdir.filePath(QFileInfo(file).completeBaseName() + ".png");
+    job.size = defaultsize;
+    jobs.append(job);
+  }
+  if (jobs.isEmpty()) {
+    parser.showHelp(1);
+  }
+
+  Quarter::init();
+
+  QElapsedTimer timer;
+  timer.start();
+
+  JobQueue queue(jobs);
+  ImageEncoder encoder(qMax(parser.value(encodersoption).toInt(), 1),
+                       parser.value(qualityoption).toInt());
+
+  // the renderers and their contexts are created in the GUI thread and
+  // handed over to the render threads
+  const int numthreads = qBound(1, parser.value(threadsoption).toInt(), queue.size());
+  QList<QuarterOffscreenRenderer *> renderers;
+  QList<RenderWorker *> workers;
+  for (int i = 0; i < numthreads; i++) {
+    QuarterOffscreenRenderer * renderer = new QuarterOffscreenRenderer(defaultsize);
+    if (!renderer->isValid()) {
+      fprintf(stderr, "Unable to create an OpenGL context\n");
+      delete renderer;
+      break;
+    }
+    RenderWorker * worker = new RenderWorker(&queue, &encoder, renderer);
+    renderer->moveToThread(worker);
+    renderers.append(renderer);
+    workers.append(worker);
+  }
+
+  foreach (RenderWorker * worker, workers) worker->start();
+
+  int rendered = 0;
+  int failed = 0;
+  foreach (RenderWorker * worker, workers) {
+    worker->wait();
+    rendered += worker->rendered();
+    failed += worker->failures();
+  }
+  encoder.waitForDone();
+  failed += encoder.failures();
+
+  qDeleteAll(workers);
+  qDeleteAll(renderers);
+
+  fprintf(stderr, "%d of %d images in %.1f s with %d threads, %d failed\n",
+          rendered - encoder.failures(), queue.size(),
+          timer.elapsed() / 1000.0, int(workers.size()), failed);
+
+  Quarter::clean();
+  return (failed || workers.isEmpty()) ? 1 : 0;
+}
@@ -0,0 +1,356 @@
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+/*
+  A BenchRunner renders a fixed number of frames per mode combination
+  while the camera orbits the scene. Frames are rendered back to back
+  without returning to the event loop, and glFinish() is called after
+  each, so that the frame times include the work on the GPU. Vertical
+  sync should be off, see quarterbench.cpp.
+ */
+
+#include "BenchRunner.h"
+
+#include <QAction>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QVector>
+
+#include <algorithm>
+#include <math.h>
+#include <string.h>
+
+#if defined(Q_OS_WIN)
+#include <windows.h>
+#include <psapi.h>
+#elif defined(Q_OS_MAC)
+#include <mach/mach.h>
+#include <sys/resource.h>
+#elif defined(Q_OS_UNIX)
+#include <stdio.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#endif
+
+#include <Inventor/SbBox3f.h>
+#include <Inventor/SoRenderManager.h>
+#include <Inventor/actions/SoGetBoundingBoxAction.h>
+#include <Inventor/nodes/SoCamera.h>
+#include <Inventor/system/gl.h>
+
+#include <Quarter/QuarterWidget.h>
+
+using namespace SIM::Coin3D::Quarter;
+
+// GL_NVX_gpu_memory_info
+#define QUARTER_GPU_MEMORY_INFO_TOTAL_AVAILABLE_MEMORY_NVX 0x9048
+#define QUARTER_GPU_MEMORY_INFO_CURRENT_AVAILABLE_VIDMEM_NVX 0x9049
+
+static const double TWO_PI = 6.28318530717958647692;
+
+static qint64
+residentMemory(void)
+{
+#if defined(Q_OS_WIN)
+  PROCESS_MEMORY_COUNTERS counters;
+  if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+    return qint64(counters.WorkingSetSize / 1024);
+  }
+#elif defined(Q_OS_MAC)
+  mach_task_basic_info_data_t info;
+  mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+  if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO,
+                (task_info_t) &info, &count) == KERN_SUCCESS) {
+    return qint64(info.resident_size / 1024);
+  }
+#elif defined(Q_OS_UNIX)
+  FILE * statm = fopen("/proc/self/statm", "r");
+  if (statm) {
+    long size, resident;
+    const int n = fscanf(statm, "%ld %ld", &size, &resident);
+    fclose(statm);
+    if (n == 2) return qint64(resident) * sysconf(_SC_PAGESIZE) / 1024;
+  }
+#endif
+  return -1;
+}
+
+static qint64
+peakResidentMemory(void)
+{
+#if defined(Q_OS_WIN)
+  PROCESS_MEMORY_COUNTERS counters;
+  if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+    return qint64(counters.PeakWorkingSetSize / 1024);
+  }
+#elif defined(Q_OS_UNIX)
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) == 0) {
+#if defined(Q_OS_MAC)
+    return qint64(usage.ru_maxrss / 1024); // bytes on Mac OS X
+#else
+    return qint64(usage.ru_maxrss);
+#endif
+  }
+#endif
+  return -1;
+}
+
+/*
+  Returns the video memory in use, for drivers with
+  GL_NVX_gpu_memory_info. The OpenGL context must be current.
+ */
+static qint64
+gpuMemoryUsed(void)
+{
+  const char * extensions = (const char *) glGetString(GL_EXTENSIONS);
+  if (!extensions || !strstr(extensions, "GL_NVX_gpu_memory_info")) return -1;
+
+  GLint total = 0, available = 0;
+  glGetIntegerv(QUARTER_GPU_MEMORY_INFO_TOTAL_AVAILABLE_MEMORY_NVX, &total);
+  glGetIntegerv(QUARTER_GPU_MEMORY_INFO_CURRENT_AVAILABLE_VIDMEM_NVX, &available);
+  return qint64(total) - qint64(available);
+}
+
+/*
+  Returns the nearest rank percentile of the sorted \a values.
+ */
+static double
+percentile(const QVector<double> & values, double p)
+{
+  if (values.isEmpty()) return -1.0;
+  const int rank = int(ceil(p * values.size()));
+  return values[qBound(0, rank - 1, int(values.size()) - 1)];
+}
+
+static QString
+actionName(QAction * action)
+{
+  return action ? action->objectName() : QString();
+}
+
+BenchResult::BenchResult(void)
+  : frames(0), fps(-1.0), mean(-1.0), p50(-1.0), p90(-1.0), p95(-1.0),
+    p99(-1.0), max(-1.0), cpurender(-1.0), gpu(-1.0),
+    rss(-1), peakrss(-1), gpumemory(-1)
+{
+}
+
+BenchRunner::BenchRunner(QuarterWidget * widget)
+  : widget(widget), frames(360), warmupframes(30), orbits(1.0),
+    elevation(30.0), center(0.0f, 0.0f, 0.0f), distance(1.0f)
+{
+}
+
+void
+BenchRunner::setFrames(int frames)
+{
+  this->frames = qMax(frames, 1);
+}
+
+void
+BenchRunner::setWarmupFrames(int frames)
+{
+  this->warmupframes = qMax(frames, 0);
+}
+
+/*
+  Sets how many times the camera circles the scene while the frames
+  of one mode combination are rendered.
+ */
+void
+BenchRunner::setOrbits(double orbits)
+{
+  this->orbits = orbits;
+}
+
+/*
+  Sets the angle of the camera above the horizontal plane through the
+  center of the scene.
+ */
+void
+BenchRunner::setElevation(double degrees)
+{
+  this->elevation = degrees;
+}
+
+/*
+  Sets the scene graph and renders a first frame, which also creates
+  the OpenGL context if the widget has not been painted before.
+ */
+void
+BenchRunner::setScene(SoNode * root)
+{
+  this->widget->setSceneGraph(root);
+
+  SoRenderManager * rendermanager = this->widget->getSoRenderManager();
+  SoGetBoundingBoxAction action(rendermanager->getViewportRegion());
+  action.apply(root);
+  const SbBox3f box = action.getBoundingBox();
+  this->center = box.isEmpty() ? SbVec3f(0.0f, 0.0f, 0.0f) : box.getCenter();
+
+  // keep the distance from viewAll() in setSceneGraph()
+  SoCamera * camera = rendermanager->getCamera();
+  this->distance = camera ? (camera->position.getValue() - this->center).length() : 0.0f;
+  if (this->distance <= 0.0f && !box.isEmpty()) {
+    float dx, dy, dz;
+    box.getSize(dx, dy, dz);
+    this->distance = SbVec3f(dx, dy, dz).length() * 1.5f;
+  }
+
+  this->placeCamera(0.0);
+  this->renderFrame();
+
+  this->widget->makeCurrent();
+  this->renderer = QString::fromLatin1((const char *) glGetString(GL_RENDERER));
+  this->version = QString::fromLatin1((const char *) glGetString(GL_VERSION));
+  this->widget->doneCurrent();
+}
+
+/*
+  Renders the frames for one combination of modes, given by actions
+  from QuarterWidget::transparencyTypeActions(),
+  QuarterWidget::renderModeActions() and
+  QuarterWidget::stereoModeActions().
+ */
+BenchResult
+BenchRunner::run(QAction * transparencytype, QAction * rendermode, QAction * stereomode)
+{
+  BenchResult result;
+  result.transparencytype = actionName(transparencytype);
+  result.rendermode = actionName(rendermode);
+  result.stereomode = actionName(stereomode);
+
+  if (transparencytype) {
+    this->widget->setTransparencyType((QuarterWidget::TransparencyType) transparencytype->data().toInt());
+  }
+  if (rendermode) {
+    this->widget->setRenderMode((QuarterWidget::RenderMode) rendermode->data().toInt());
+  }
+  if (stereomode) {
+    this->widget->setStereoMode((QuarterWidget::StereoMode) stereomode->data().toInt());
+  }
+  // deliver the updates requested by the mode changes before timing
+  QCoreApplication::processEvents();
+
+  for (int i = 0; i < this->warmupframes; i++) {
+    this->placeCamera(TWO_PI * i / qMax(this->warmupframes, 1));
+    this->renderFrame();
+  }
+
+  // disabling the statistics discards the timings of the warmup
+  this->widget->setFrameStatisticsEnabled(false);
+  this->widget->setFrameStatisticsEnabled(true);
+
+  QVector<double> times;
+  times.reserve(this->frames);
+  QElapsedTimer timer;
+  timer.start();
+  for (int i = 0; i < this->frames; i++) {
+    this->placeCamera(TWO_PI * this->orbits * i / this->frames);
+    const qint64 start = timer.nsecsElapsed();
+    this->renderFrame();
+    times.append((timer.nsecsElapsed() - start) * 1e-9);
+  }
+  const double elapsed = timer.nsecsElapsed() * 1e-9;
+
+  const FrameStatistics statistics = this->widget->frameStatistics();
+  if (statistics.numFrames(FrameStatistics::RENDER) > 0) {
+    result.cpurender = statistics.average(FrameStatistics::RENDER);
+  }
+  if (statistics.numFrames(FrameStatistics::GPU) > 0) {
+    result.gpu = statistics.average(FrameStatistics::GPU);
+  }
+
+  double sum = 0.0;
+  for (int i = 0; i < times.size(); i++) sum += times[i];
+  std::sort(times.begin(), times.end());
+
+  result.frames = times.size();
+  result.fps = elapsed > 0.0 ? times.size() / elapsed : -1.0;
+  result.mean = sum / times.size();
+  result.p50 = percentile(times, 0.50);
+  result.p90 = percentile(times, 0.90);
+  result.p95 = percentile(times, 0.95);
+  result.p99 = percentile(times, 0.99);
+  result.max = times.last();
+  result.rss = residentMemory();
+  result.peakrss = peakResidentMemory();
+
+  this->widget->makeCurrent();
+  result.gpumemory = gpuMemoryUsed();
+  this->widget->doneCurrent();
+  return result;
+}
+
+QString
+BenchRunner::glRenderer(void) const
+{
+  return this->renderer;
+}
+
+QString
+BenchRunner::glVersion(void) const
+{
+  return this->version;
+}
+
+void
+BenchRunner::placeCamera(double angle)
+{
+  SoCamera * camera = this->widget->getSoRenderManager()->getCamera();
+  if (!camera) return;
+
+  const double elevation = this->elevation * TWO_PI / 360.0;
+  const SbVec3f direction(float(cos(elevation) * sin(angle)),
+                          float(sin(elevation)),
+                          float(cos(elevation) * cos(angle)));
+  camera->position = this->center + direction * this->distance;
+  camera->pointAt(this->center, SbVec3f(0.0f, 1.0f, 0.0f));
+  camera->focalDistance = this->distance;
+}
+
+/*
+  Renders and swaps synchronously, then waits for the GPU.
+ */
+void
+BenchRunner::renderFrame(void)
+{
+#if QT_VERSION >= 0x060000
+  this->widget->repaint();
+  this->widget->makeCurrent();
+#else
+  this->widget->updateGL();
+#endif
+  glFinish();
+  this->widget->doneCurrent();
+}
@@ -0,0 +1,103 @@
+#ifndef QUARTER_BENCHRUNNER_H
+#define QUARTER_BENCHRUNNER_H
+
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+#include <QString>
+#include <QtGlobal>
+
+#include <Inventor/SbVec3f.h>
+
+class QAction;
+class SoNode;
+
+namespace SIM { namespace Coin3D { namespace Quarter {
+class QuarterWidget;
+}}}
+
+/*
+  The timings of one mode combination. Times are in seconds, and
+  memory sizes in KiB. Values which are not available are -1.
+ */
+struct BenchResult {
+  BenchResult(void);
+
+  QString transparencytype;
+  QString rendermode;
+  QString stereomode;
+  int frames;
+  double fps;
+  double mean;
+  double p50;
+  double p90;
+  double p95;
+  double p99;
+  double max;
+  double cpurender;
+  double gpu;
+  qint64 rss;
+  qint64 peakrss;
+  qint64 gpumemory;
+};
+
+class BenchRunner {
+public:
+  BenchRunner(SIM::Coin3D::Quarter::QuarterWidget * widget);
+
+  void setFrames(int frames);
+  void setWarmupFrames(int frames);
+  void setOrbits(double orbits);
+  void setElevation(double degrees);
+
+  void setScene(SoNode * root);
+  BenchResult run(QAction * transparencytype, QAction * rendermode, QAction * stereomode);
+
+  QString glRenderer(void) const;
+  QString glVersion(void) const;
+
+private:
+  void placeCamera(double angle);
+  void renderFrame(void);
+
+  SIM::Coin3D::Quarter::QuarterWidget * widget;
+  int frames;
+  int warmupframes;
+  double orbits;
+  double elevation;
+  SbVec3f center;
+  float distance;
+  QString renderer;
+  QString version;
+};
+
+#endif // QUARTER_BENCHRUNNER_H
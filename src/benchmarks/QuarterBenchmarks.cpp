@@ -0,0 +1,265 @@
+#include "QuarterBenchmarks.h"
+
+#include <QImage>
+#include <QKeyEvent>
+#include <QMouseEvent>
+#include <QResizeEvent>
+
+#include <Inventor/SbImage.h>
+#include <Inventor/events/SoEvent.h>
+#include <Inventor/nodes/SoCube.h>
+#include <Inventor/nodes/SoSeparator.h>
+#include <Inventor/nodes/SoTranslation.h>
+
+#include <Quarter/QtCoinCompatibility.h>
+#include <Quarter/devices/InputDevice.h>
+#include <Quarter/devices/Keyboard.h>
+#include <Quarter/devices/Mouse.h>
+#include <Quarter/eventhandlers/EventFilter.h>
+
+// A device that claims mouse moves without translating them, to
+// measure the cost of the dispatch itself
+class NullDevice : public InputDevice {
+public:
+  NullDevice(QuarterWidget * quarter) : InputDevice(quarter) {}
+  virtual const SoEvent * translateEvent(QEvent *) { return NULL; }
+  virtual QList<QEvent::Type> eventTypes(void) const {
+    QList<QEvent::Type> types;
+    types << QEvent::MouseMove;
+    return types;
+  }
+};
+
+static QImage
+createImage(int size, int channels)
+{
+  QImage image;
+  if (channels == 1) {
+    image = QImage(size, size, QImage::Format_Indexed8);
+    QVector<QRgb> clut;
+    for (int i = 0; i < 256; ++i) {
+      clut.append(qRgb(i, i, i));
+    }
+    image.setColorTable(clut);
+  }
+  else {
+    image = QImage(size, size, channels == 4 ?
+                   QImage::Format_ARGB32 : QImage::Format_RGB32);
+  }
+  for (int y = 0; y < size; y++) {
+    uchar * line = image.scanLine(y);
+    for (int x = 0; x < image.bytesPerLine(); x++) {
+      line[x] = uchar(x ^ y);
+    }
+  }
+  return image;
+}
+
+SoSeparator *
+QuarterBenchmarks::createScene(int numshapes)
+{
+  SoSeparator * root = new SoSeparator;
+  for (int i = 0; i < numshapes; i++) {
+    SoSeparator * sep = new SoSeparator;
+    SoTranslation * trans = new SoTranslation;
+    trans->translation = SbVec3f(float(i % 32) * 3.0f,
+                                 float((i / 32) % 32) * 3.0f,
+                                 float(i / 1024) * 3.0f);
+    sep->addChild(trans);
+    sep->addChild(new SoCube);
+    root->addChild(sep);
+  }
+  return root;
+}
+
+void
+QuarterBenchmarks::initTestCase(void)
+{
+  Quarter::init();
+  this->quarterwidget = new QuarterWidget;
+  this->quarterwidget->resize(512, 512);
+  this->quarterwidget->show();
+  QTest::qWait(100);
+}
+
+void
+QuarterBenchmarks::cleanupTestCase(void)
+{
+  delete this->quarterwidget;
+  Quarter::clean();
+}
+
+void
+QuarterBenchmarks::mouseTranslateEvent(void)
+{
+  Mouse mouse(this->quarterwidget);
+  QResizeEvent resize(QSize(512, 512), QSize(512, 512));
+  mouse.translateEvent(&resize);
+
+#if QT_VERSION >= 0x060000
+  QMouseEvent move(QEvent::MouseMove, QPointF(100, 100), QPointF(100, 100),
+                   Qt::NoButton, Qt::LeftButton, Qt::NoModifier);
+#else
+  QMouseEvent move(QEvent::MouseMove, QPoint(100, 100),
+                   Qt::NoButton, Qt::LeftButton, Qt::NoModifier);
+#endif
+
+  QBENCHMARK {
+    mouse.translateEvent(&move);
+  }
+}
+
+void
+QuarterBenchmarks::keyboardTranslateEvent(void)
+{
+  Keyboard keyboard(this->quarterwidget);
+  QKeyEvent press(QEvent::KeyPress, Qt::Key_A, Qt::NoModifier, "a");
+
+  QBENCHMARK {
+    keyboard.translateEvent(&press);
+  }
+}
+
+void
+QuarterBenchmarks::eventFilter_data(void)
+{
+  QTest::addColumn<int>("numdevices");
+  QTest::newRow("default devices") << 0;
+  QTest::newRow("4 extra devices") << 4;
+  QTest::newRow("16 extra devices") << 16;
+}
+
+void
+QuarterBenchmarks::eventFilter(void)
+{
+  QFETCH(int, numdevices);
+
+  EventFilter * filter = this->quarterwidget->getEventFilter();
+  QList<InputDevice *> devices;
+  for (int i = 0; i < numdevices; i++) {
+    devices.append(new NullDevice(this->quarterwidget));
+    filter->registerInputDevice(devices.last());
+  }
+
+  // sent through the widget's event filters, like a real event
+#if QT_VERSION >= 0x060000
+  QMouseEvent move(QEvent::MouseMove, QPointF(100, 100), QPointF(100, 100),
+                   Qt::NoButton, Qt::NoButton, Qt::NoModifier);
+#else
+  QMouseEvent move(QEvent::MouseMove, QPoint(100, 100),
+                   Qt::NoButton, Qt::NoButton, Qt::NoModifier);
+#endif
+
+  QBENCHMARK {
+    QApplication::sendEvent(this->quarterwidget, &move);
+  }
+
+  foreach (InputDevice * device, devices) {
+    filter->unregisterInputDevice(device);
+    delete device;
+  }
+}
+
+void
+QuarterBenchmarks::qimageToSbImage_data(void)
+{
+  QTest::addColumn<int>("size");
+  QTest::addColumn<int>("channels");
+  const int sizes[] = { 256, 1024, 4096 };
+  const int channels[] = { 1, 3, 4 };
+  for (int i = 0; i < 3; i++) {
+    for (int j = 0; j < 3; j++) {
+      const QByteArray name = QByteArray::number(sizes[i]) + "x" +
+        QByteArray::number(sizes[i]) + "x" + QByteArray::number(channels[j]);
+      QTest::newRow(name.constData()) << sizes[i] << channels[j];
+    }
+  }
+}
+
+void
+QuarterBenchmarks::qimageToSbImage(void)
+{
+  QFETCH(int, size);
+  QFETCH(int, channels);
+
+  const QImage image = createImage(size, channels);
+  SbImage sbimage;
+
+  QBENCHMARK {
+    QtCoinCompatibility::QImageToSbImage(image, sbimage);
+  }
+}
+
+void
+QuarterBenchmarks::sbImageToQImage_data(void)
+{
+  this->qimageToSbImage_data();
+}
+
+void
+QuarterBenchmarks::sbImageToQImage(void)
+{
+  QFETCH(int, size);
+  QFETCH(int, channels);
+
+  SbImage sbimage;
+  QtCoinCompatibility::QImageToSbImage(createImage(size, channels), sbimage);
+  QImage image;
+
+  QBENCHMARK {
+    QtCoinCompatibility::SbImageToQImage(sbimage, image);
+  }
+}
+
+void
+QuarterBenchmarks::setSceneGraph_data(void)
+{
+  QTest::addColumn<int>("numshapes");
+  QTest::newRow("1000 shapes") << 1000;
+  QTest::newRow("10000 shapes") << 10000;
+  QTest::newRow("100000 shapes") << 100000;
+}
+
+void
+QuarterBenchmarks::setSceneGraph(void)
+{
+  QFETCH(int, numshapes);
+
+  SoSeparator * root = createScene(numshapes);
+  root->ref();
+
+  QBENCHMARK {
+    this->quarterwidget->setSceneGraph(root);
+    this->quarterwidget->setSceneGraph(NULL);
+  }
+
+  root->unref();
+}
+
+void
+QuarterBenchmarks::paintGL_data(void)
+{
+  this->setSceneGraph_data();
+}
+
+void
+QuarterBenchmarks::paintGL(void)
+{
+  QFETCH(int, numshapes);
+
+  SoSeparator * root = createScene(numshapes);
+  root->ref();
+  this->quarterwidget->setSceneGraph(root);
+  this->quarterwidget->viewAll();
+
+  QBENCHMARK {
+    // redraw() makes sure the frame is rendered, not reused
+    this->quarterwidget->redraw();
+    this->quarterwidget->repaint();
+  }
+
+  this->quarterwidget->setSceneGraph(NULL);
+  root->unref();
+}
+
+QTEST_MAIN(QuarterBenchmarks)
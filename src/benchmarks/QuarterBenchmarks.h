@@ -0,0 +1,42 @@
+#ifndef QUARTER_QUARTERBENCHMARKS_H
+#define QUARTER_QUARTERBENCHMARKS_H
+
+#include <QtGui>
+#include <QtTest/QtTest>
+
+#include <Quarter/Quarter.h>
+#include <Quarter/QuarterWidget.h>
+
+class SoSeparator;
+
+using namespace SIM::Coin3D::Quarter;
+
+class QuarterBenchmarks : public QObject {
+  Q_OBJECT
+
+private slots:
+  void initTestCase(void);
+  void cleanupTestCase(void);
+
+  void mouseTranslateEvent(void);
+  void keyboardTranslateEvent(void);
+  void eventFilter_data(void);
+  void eventFilter(void);
+
+  void qimageToSbImage_data(void);
+  void qimageToSbImage(void);
+  void sbImageToQImage_data(void);
+  void sbImageToQImage(void);
+
+  void setSceneGraph_data(void);
+  void setSceneGraph(void);
+  void paintGL_data(void);
+  void paintGL(void);
+
+private:
+  static SoSeparator * createScene(int numshapes);
+
+  class QuarterWidget * quarterwidget;
+};
+
+#endif // QUARTER_QUARTERBENCHMARKS_H
@@ -0,0 +1,232 @@
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+/*
+  The shapes are spheres made of an SoIndexedFaceSet with explicit
+  normals, and texture coordinates when textured. Each sphere gets
+  its own bumps, so no two shapes share geometry or caches, like in
+  a real model.
+ */
+
+#include "SceneGenerator.h"
+
+#include <QColor>
+#include <QVector>
+
+#include <math.h>
+
+#include <Inventor/nodes/SoCoordinate3.h>
+#include <Inventor/nodes/SoIndexedFaceSet.h>
+#include <Inventor/nodes/SoMaterial.h>
+#include <Inventor/nodes/SoNormal.h>
+#include <Inventor/nodes/SoNormalBinding.h>
+#include <Inventor/nodes/SoSeparator.h>
+#include <Inventor/nodes/SoTexture2.h>
+#include <Inventor/nodes/SoTextureCoordinate2.h>
+#include <Inventor/nodes/SoTranslation.h>
+
+static const double TWO_PI = 6.28318530717958647692;
+
+SceneParameters::SceneParameters(void)
+  : triangles(1000000), nodes(100), textures(0), texturesize(256),
+    transparency(0.0), seed(1)
+{
+}
+
+QString
+SceneParameters::description(void) const
+{
+  return QString("%1 triangles, %2 nodes, %3 textures, %4% transparent")
+    .arg(this->triangles).arg(this->nodes).arg(this->textures)
+    .arg(this->transparency * 100.0);
+}
+
+SceneGenerator::SceneGenerator(const SceneParameters & parameters)
+  : parameters(parameters), triangles(0), state(parameters.seed)
+{
+}
+
+/*
+  Returns a new scene with a reference count of zero.
+ */
+SoSeparator *
+SceneGenerator::generate(void)
+{
+  this->state = this->parameters.seed;
+  this->triangles = 0;
+
+  const int nodes = qMax(this->parameters.nodes, 1);
+  const int pershape = qMax(this->parameters.triangles / nodes, 8);
+  // a sphere with r rows and 2r columns has 4r^2 triangles
+  const int rows = qMax(2, int(sqrt(pershape / 4.0) + 0.5));
+  const int columns = 2 * rows;
+
+  QVector<SoTexture2 *> textures;
+  // textures which no shape would use are not created
+  for (int i = 0; i < qMin(this->parameters.textures, nodes); i++) {
+    textures.append(this->createTexture(i));
+  }
+
+  SoSeparator * root = new SoSeparator;
+  for (int i = 0; i < nodes; i++) {
+    SoTexture2 * texture = textures.isEmpty() ? NULL : textures[i % textures.size()];
+    root->addChild(this->createShape(i, rows, columns, texture));
+  }
+  return root;
+}
+
+/*
+  Returns the number of triangles in the last generated scene.
+ */
+int
+SceneGenerator::numTriangles(void) const
+{
+  return this->triangles;
+}
+
+SoSeparator *
+SceneGenerator::createShape(int index, int rows, int columns, SoTexture2 * texture)
+{
+  // lay out the shapes on a cube shaped grid
+  const int nodes = qMax(this->parameters.nodes, 1);
+  int side = 1;
+  while (side * side * side < nodes) side++;
+
+  SoSeparator * sep = new SoSeparator;
+  SoTranslation * translation = new SoTranslation;
+  translation->translation = SbVec3f(float(index % side) * 2.5f,
+                                     float((index / side) % side) * 2.5f,
+                                     float(index / (side * side)) * 2.5f);
+  sep->addChild(translation);
+
+  SoMaterial * material = new SoMaterial;
+  const QColor color = QColor::fromHsv(int(this->random() * 359.0), 160, 230);
+  material->diffuseColor = SbColor(float(color.redF()), float(color.greenF()), float(color.blueF()));
+  if (this->random() < this->parameters.transparency) {
+    material->transparency = 0.5f;
+  }
+  sep->addChild(material);
+  if (texture) sep->addChild(texture);
+
+  const double phase = this->random() * TWO_PI;
+  const double frequency = 2.0 + this->random() * 6.0;
+
+  SoCoordinate3 * coords = new SoCoordinate3;
+  SoNormal * normals = new SoNormal;
+  SoTextureCoordinate2 * texcoords = texture ? new SoTextureCoordinate2 : NULL;
+  const int numvertices = (rows + 1) * (columns + 1);
+  coords->point.setNum(numvertices);
+  normals->vector.setNum(numvertices);
+  SbVec3f * points = coords->point.startEditing();
+  SbVec3f * vectors = normals->vector.startEditing();
+  SbVec2f * uvs = NULL;
+  if (texcoords) {
+    texcoords->point.setNum(numvertices);
+    uvs = texcoords->point.startEditing();
+  }
+
+  int v = 0;
+  for (int r = 0; r <= rows; r++) {
+    const double theta = double(r) / rows * (TWO_PI / 2.0);
+    for (int c = 0; c <= columns; c++, v++) {
+      const double phi = double(c) / columns * TWO_PI;
+      const SbVec3f normal(float(sin(theta) * cos(phi)),
+                           float(cos(theta)),
+                           float(sin(theta) * sin(phi)));
+      const double radius = 1.0 + 0.05 * sin(frequency * phi + phase) * sin(frequency * theta);
+      points[v] = normal * float(radius);
+      vectors[v] = normal;
+      if (uvs) uvs[v] = SbVec2f(float(c) / columns, 1.0f - float(r) / rows);
+    }
+  }
+  coords->point.finishEditing();
+  normals->vector.finishEditing();
+  if (texcoords) texcoords->point.finishEditing();
+
+  SoIndexedFaceSet * faceset = new SoIndexedFaceSet;
+  faceset->coordIndex.setNum(rows * columns * 8);
+  int32_t * indices = faceset->coordIndex.startEditing();
+  int i = 0;
+  for (int r = 0; r < rows; r++) {
+    for (int c = 0; c < columns; c++) {
+      const int a = r * (columns + 1) + c;
+      const int b = a + columns + 1;
+      indices[i++] = a; indices[i++] = b; indices[i++] = a + 1; indices[i++] = -1;
+      indices[i++] = a + 1; indices[i++] = b; indices[i++] = b + 1; indices[i++] = -1;
+    }
+  }
+  faceset->coordIndex.finishEditing();
+  this->triangles += rows * columns * 2;
+
+  SoNormalBinding * binding = new SoNormalBinding;
+  binding->value = SoNormalBinding::PER_VERTEX_INDEXED;
+
+  sep->addChild(coords);
+  sep->addChild(normals);
+  sep->addChild(binding);
+  if (texcoords) sep->addChild(texcoords);
+  sep->addChild(faceset);
+  return sep;
+}
+
+SoTexture2 *
+SceneGenerator::createTexture(int index) const
+{
+  const int size = qBound(2, this->parameters.texturesize, 4096);
+  const QColor color = QColor::fromHsv((index * 47) % 360, 200, 255);
+  QVector<unsigned char> pixels(size * size * 3);
+  unsigned char * p = pixels.data();
+  for (int y = 0; y < size; y++) {
+    for (int x = 0; x < size; x++) {
+      const bool dark = ((x * 8 / size) + (y * 8 / size)) & 1;
+      *p++ = dark ? color.red() / 2 : color.red();
+      *p++ = dark ? color.green() / 2 : color.green();
+      *p++ = dark ? color.blue() / 2 : color.blue();
+    }
+  }
+
+  SoTexture2 * texture = new SoTexture2;
+  texture->image.setValue(SbVec2s(short(size), short(size)), 3, pixels.constData());
+  return texture;
+}
+
+/*
+  Returns a pseudo random number in [0, 1). The scene only depends on
+  the seed, so that results from different machines and versions can
+  be compared.
+ */
+double
+SceneGenerator::random(void)
+{
+  this->state = this->state * 1664525u + 1013904223u;
+  return double(this->state >> 8) / 16777216.0;
+}
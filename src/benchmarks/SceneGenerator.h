@@ -0,0 +1,77 @@
+#ifndef QUARTER_SCENEGENERATOR_H
+#define QUARTER_SCENEGENERATOR_H
+
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+#include <QString>
+
+class SoSeparator;
+class SoTexture2;
+
+/*
+  Parameters of a synthetic scene for quarter-bench. The triangles are
+  spread evenly over the given number of shapes, which are laid out
+  on a regular grid. Shapes use the given number of textures round
+  robin, and the given fraction of them is semi-transparent.
+ */
+struct SceneParameters {
+  SceneParameters(void);
+
+  QString description(void) const;
+
+  int triangles;
+  int nodes;
+  int textures;
+  int texturesize;
+  double transparency;
+  unsigned int seed;
+};
+
+class SceneGenerator {
+public:
+  SceneGenerator(const SceneParameters & parameters);
+
+  SoSeparator * generate(void);
+  int numTriangles(void) const;
+
+private:
+  SoSeparator * createShape(int index, int rows, int columns, SoTexture2 * texture);
+  SoTexture2 * createTexture(int index) const;
+  double random(void);
+
+  SceneParameters parameters;
+  int triangles;
+  unsigned int state;
+};
+
+#endif // QUARTER_SCENEGENERATOR_H
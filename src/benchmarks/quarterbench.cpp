@@ -0,0 +1,328 @@
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+/*
+  quarter-bench renders synthetic scenes in every combination of
+  transparency type, render mode and stereo mode offered by
+  QuarterWidget, while the camera orbits the scene, and writes the
+  frame rates, frame time percentiles and memory use as CSV.
+
+  quarter-bench [--triangles N,...] [--nodes N,...] [--textures N,...]
+                [--texture-size N] [--transparency R,...] [--seed N]
+                [--size WxH] [--frames N] [--warmup N] [--orbits N]
+                [--elevation degrees] [--transparency-types names]
+                [--render-modes names] [--stereo-modes names]
+                [--vsync] [--output file.csv]
+
+  Every combination of the scene parameters is generated, and each
+  scene is swept through all mode combinations. Modes are selected by
+  the names of their actions, e.g. --render-modes "as is,wireframe".
+  The first columns identify the Coin and Quarter versions and the
+  OpenGL driver, so that results from different machines and builds
+  can be collected in one file.
+ */
+
+#include <QAction>
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QFile>
+#include <QStringList>
+#include <QTextStream>
+#include <QtTest/QtTest>
+
+#include <stdio.h>
+
+#if QT_VERSION < 0x060000
+#include <QGLFormat>
+#endif
+#if QT_VERSION >= 0x050400
+#include <QSurfaceFormat>
+#endif
+
+#include <Inventor/SoDB.h>
+#include <Inventor/nodes/SoSeparator.h>
+
+#include <Quarter/Quarter.h>
+#include <Quarter/QuarterWidget.h>
+
+#include "BenchRunner.h"
+#include "SceneGenerator.h"
+
+using namespace SIM::Coin3D::Quarter;
+
+static QList<int>
+parseInts(const QString & value)
+{
+  QList<int> list;
+  foreach (const QString & part, value.split(',')) {
+    bool ok;
+    const int i = part.trimmed().toInt(&ok);
+    if (ok && i >= 0) list.append(i);
+  }
+  return list;
+}
+
+static QList<double>
+parseDoubles(const QString & value)
+{
+  QList<double> list;
+  foreach (const QString & part, value.split(',')) {
+    bool ok;
+    const double d = part.trimmed().toDouble(&ok);
+    if (ok) list.append(qBound(0.0, d, 1.0));
+  }
+  return list;
+}
+
+/*
+  Returns the actions whose names are in the comma separated \a
+  names, or all of them if \a names is empty.
+ */
+static QList<QAction *>
+selectActions(const QList<QAction *> & actions, const QString & names)
+{
+  if (names.isEmpty()) return actions;
+
+  QList<QAction *> selected;
+  foreach (const QString & name, names.split(',')) {
+    bool found = false;
+    foreach (QAction * action, actions) {
+      if (action->objectName() == name.trimmed()) {
+        selected.append(action);
+        found = true;
+      }
+    }
+    if (!found) fprintf(stderr, "Unknown mode '%s'\n", qPrintable(name.trimmed()));
+  }
+  return selected;
+}
+
+static QString
+quote(const QString & value)
+{
+  QString quoted = value;
+  quoted.replace('"', "\"\"");
+  return '"' + quoted + '"';
+}
+
+static QString
+milliseconds(double seconds)
+{
+  return seconds < 0.0 ? QString("-1") : QString::number(seconds * 1000.0, 'f', 3);
+}
+
+int
+main(int argc, char ** argv)
+{
+  // find the vsync option before the application, and thereby the
+  // default surface format, is created
+  bool vsync = false;
+  for (int i = 1; i < argc; i++) {
+    if (qstrcmp(argv[i], "--vsync") == 0) vsync = true;
+  }
+  if (!vsync) {
+#if QT_VERSION >= 0x050400
+    QSurfaceFormat format = QSurfaceFormat::defaultFormat();
+    format.setSwapInterval(0);
+    QSurfaceFormat::setDefaultFormat(format);
+#endif
+#if QT_VERSION < 0x060000
+    QGLFormat glformat = QGLFormat::defaultFormat();
+    glformat.setSwapInterval(0);
+    QGLFormat::setDefaultFormat(glformat);
+#endif
+  }
+
+  QApplication app(argc, argv);
+  app.setApplicationName("quarter-bench");
+
+  const SceneParameters defaults;
+  QCommandLineParser parser;
+  parser.setApplicationDescription("Measures QuarterWidget frame times on synthetic scenes in all rendering modes.");
+  parser.addHelpOption();
+  QCommandLineOption trianglesoption("triangles", "Triangles per scene.", "N,...", QString::number(defaults.triangles));
+  QCommandLineOption nodesoption("nodes", "Shapes per scene.", "N,...", QString::number(defaults.nodes));
+  QCommandLineOption texturesoption("textures", "Distinct textures per scene.", "N,...", QString::number(defaults.textures));
+  QCommandLineOption texturesizeoption("texture-size", "Width and height of the textures.", "N", QString::number(defaults.texturesize));
+  QCommandLineOption transparencyoption("transparency", "Fraction of semi-transparent shapes.", "R,...", QString::number(defaults.transparency));
+  QCommandLineOption seedoption("seed", "Seed of the scene generator.", "N", QString::number(defaults.seed));
+  QCommandLineOption sizeoption("size", "Size of the viewer.", "WxH", "1024x768");
+  QCommandLineOption framesoption("frames", "Measured frames per mode combination.", "N", "360");
+  QCommandLineOption warmupoption("warmup", "Unmeasured frames before each mode combination.", "N", "30");
+  QCommandLineOption orbitsoption("orbits", "Camera orbits per mode combination.", "N", "1");
+  QCommandLineOption elevationoption("elevation", "Camera angle above the scene's horizon.", "degrees", "30");
+  QCommandLineOption transparencytypesoption("transparency-types", "Transparency types to sweep, all by default.", "names");
+  QCommandLineOption rendermodesoption("render-modes", "Render modes to sweep, all by default.", "names");
+  QCommandLineOption stereomodesoption("stereo-modes", "Stereo modes to sweep, all by default.", "names");
+  QCommandLineOption vsyncoption("vsync", "Keep vertical sync on, which caps the frame rate.");
+  QCommandLineOption outputoption("output", "CSV file to write, standard output by default.", "file");
+  parser.addOption(trianglesoption);
+  parser.addOption(nodesoption);
+  parser.addOption(texturesoption);
+  parser.addOption(texturesizeoption);
+  parser.addOption(transparencyoption);
+  parser.addOption(seedoption);
+  parser.addOption(sizeoption);
+  parser.addOption(framesoption);
+  parser.addOption(warmupoption);
+  parser.addOption(orbitsoption);
+  parser.addOption(elevationoption);
+  parser.addOption(transparencytypesoption);
+  parser.addOption(rendermodesoption);
+  parser.addOption(stereomodesoption);
+  parser.addOption(vsyncoption);
+  parser.addOption(outputoption);
+  parser.process(app);
+
+  QSize size(1024, 768);
+  const QStringList wh = parser.value(sizeoption).split('x');
+  if (wh.size() == 2 && wh[0].toInt() > 0 && wh[1].toInt() > 0) {
+    size = QSize(wh[0].toInt(), wh[1].toInt());
+  }
+
+  const QList<int> triangles = parseInts(parser.value(trianglesoption));
+  const QList<int> nodes = parseInts(parser.value(nodesoption));
+  const QList<int> textures = parseInts(parser.value(texturesoption));
+  const QList<double> transparency = parseDoubles(parser.value(transparencyoption));
+  if (triangles.isEmpty() || nodes.isEmpty() || textures.isEmpty() || transparency.isEmpty()) {
+    parser.showHelp(1);
+  }
+
+  QFile file;
+  if (parser.isSet(outputoption)) {
+    file.setFileName(parser.value(outputoption));
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text | QIODevice::Truncate)) {
+      fprintf(stderr, "Unable to open %s\n", qPrintable(file.fileName()));
+      return 1;
+    }
+  }
+  else if (!file.open(stdout, QIODevice::WriteOnly | QIODevice::Text)) {
+    return 1;
+  }
+  QTextStream csv(&file);
+
+  Quarter::init();
+
+  QuarterWidget * widget = new QuarterWidget;
+  widget->setContextMenuEnabled(false);
+  widget->resize(size);
+  widget->show();
+  if (!QTest::qWaitForWindowExposed(widget)) {
+    fprintf(stderr, "The viewer was not shown\n");
+    delete widget;
+    Quarter::clean();
+    return 1;
+  }
+
+  const QList<QAction *> transparencytypes =
+    selectActions(widget->transparencyTypeActions(), parser.value(transparencytypesoption));
+  const QList<QAction *> rendermodes =
+    selectActions(widget->renderModeActions(), parser.value(rendermodesoption));
+  const QList<QAction *> stereomodes =
+    selectActions(widget->stereoModeActions(), parser.value(stereomodesoption));
+
+  BenchRunner runner(widget);
+  runner.setFrames(parser.value(framesoption).toInt());
+  runner.setWarmupFrames(parser.value(warmupoption).toInt());
+  runner.setOrbits(parser.value(orbitsoption).toDouble());
+  runner.setElevation(parser.value(elevationoption).toDouble());
+
+  csv << "coin_version,quarter_version,gl_renderer,gl_version,width,height,"
+         "triangles,nodes,textures,texture_size,transparency_ratio,"
+         "transparency_type,render_mode,stereo_mode,frames,fps,"
+         "mean_ms,p50_ms,p90_ms,p95_ms,p99_ms,max_ms,cpu_render_ms,gpu_ms,"
+         "rss_kb,peak_rss_kb,gpu_memory_kb\n";
+  csv.flush();
+
+  const int total = triangles.size() * nodes.size() * textures.size() * transparency.size() *
+    transparencytypes.size() * rendermodes.size() * stereomodes.size();
+  int done = 0;
+
+  foreach (int t, triangles) {
+    foreach (int n, nodes) {
+      foreach (int x, textures) {
+        foreach (double r, transparency) {
+          SceneParameters parameters;
+          parameters.triangles = t;
+          parameters.nodes = n;
+          parameters.textures = x;
+          parameters.texturesize = parser.value(texturesizeoption).toInt();
+          parameters.transparency = r;
+          parameters.seed = parser.value(seedoption).toUInt();
+
+          SceneGenerator generator(parameters);
+          SoSeparator * root = generator.generate();
+          root->ref();
+          fprintf(stderr, "Scene: %s\n", qPrintable(parameters.description()));
+          runner.setScene(root);
+
+          foreach (QAction * transparencytype, transparencytypes) {
+            foreach (QAction * rendermode, rendermodes) {
+              foreach (QAction * stereomode, stereomodes) {
+                const BenchResult result = runner.run(transparencytype, rendermode, stereomode);
+                done++;
+                fprintf(stderr, "[%d/%d] %s, %s, %s: %.1f fps\n", done, total,
+                        qPrintable(result.transparencytype), qPrintable(result.rendermode),
+                        qPrintable(result.stereomode), result.fps);
+
+                csv << quote(QString::fromLatin1(SoDB::getVersion())) << ','
+                    << quote(QString::fromLatin1(QUARTER_BENCH_VERSION)) << ','
+                    << quote(runner.glRenderer()) << ','
+                    << quote(runner.glVersion()) << ','
+                    << widget->width() << ',' << widget->height() << ','
+                    << generator.numTriangles() << ',' << n << ',' << x << ','
+                    << parameters.texturesize << ',' << r << ','
+                    << quote(result.transparencytype) << ','
+                    << quote(result.rendermode) << ','
+                    << quote(result.stereomode) << ','
+                    << result.frames << ',' << QString::number(result.fps, 'f', 2) << ','
+                    << milliseconds(result.mean) << ',' << milliseconds(result.p50) << ','
+                    << milliseconds(result.p90) << ',' << milliseconds(result.p95) << ','
+                    << milliseconds(result.p99) << ',' << milliseconds(result.max) << ','
+                    << milliseconds(result.cpurender) << ',' << milliseconds(result.gpu) << ','
+                    << result.rss << ',' << result.peakrss << ',' << result.gpumemory << '\n';
+                csv.flush();
+              }
+            }
+          }
+
+          widget->setSceneGraph(NULL);
+          root->unref();
+        }
+      }
+    }
+  }
+
+  delete widget;
+  Quarter::clean();
+  return 0;
+}
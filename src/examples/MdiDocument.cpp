@@ -0,0 +1,121 @@
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+#include "MdiDocument.h"
+#include "MdiQuarterWidget.h"
+
+#include <Inventor/nodes/SoNode.h>
+#include <Quarter/SceneLoader.h>
+
+using namespace SIM::Coin3D::Quarter;
+
+MdiDocument::MdiDocument(const QString & filename, QObject * parent)
+  : inherited(parent), filename(filename), root(NULL)
+{
+}
+
+MdiDocument::~MdiDocument()
+{
+  if (this->root) this->root->unref();
+}
+
+bool
+MdiDocument::load(void)
+{
+  // the file is read in the background, the scene graph shows up in
+  // the views once it is ready
+  SceneLoader * loader = new SceneLoader(this);
+  // CAD exports come with many small shapes, which are merged while
+  // still on the loader thread
+  loader->setOptimizing(true);
+  this->connect(loader, SIGNAL(loaded(SoNode *)), this, SLOT(loaded(SoNode *)));
+  this->connect(loader, SIGNAL(failed()), this, SLOT(loadFailed()));
+  if (!loader->load(this->filename)) {
+    delete loader;
+    return false;
+  }
+  return true;
+}
+
+const QString &
+MdiDocument::fileName(void) const
+{
+  return this->filename;
+}
+
+SoNode *
+MdiDocument::sceneGraph(void) const
+{
+  return this->root;
+}
+
+void
+MdiDocument::addView(MdiQuarterWidget * view)
+{
+  this->viewlist.append(view);
+  if (this->root) view->setSceneGraph(this->root);
+}
+
+void
+MdiDocument::removeView(MdiQuarterWidget * view)
+{
+  this->viewlist.removeAll(view);
+  if (this->viewlist.isEmpty()) this->deleteLater();
+}
+
+const QList<MdiQuarterWidget *> &
+MdiDocument::views(void) const
+{
+  return this->viewlist;
+}
+
+void
+MdiDocument::loaded(SoNode * root)
+{
+  // the views each hold a reference of their own, this one keeps the
+  // scene alive for views opened later
+  root->ref();
+  if (this->root) this->root->unref();
+  this->root = root;
+  foreach (MdiQuarterWidget * view, this->viewlist) {
+    view->setSceneGraph(root);
+  }
+  this->sender()->deleteLater();
+  emit this->ready(this);
+}
+
+void
+MdiDocument::loadFailed(void)
+{
+  this->sender()->deleteLater();
+  emit this->failed(this);
+}
@@ -0,0 +1,77 @@
+#ifndef MDI_DOCUMENT_H
+#define MDI_DOCUMENT_H
+
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+#include <QObject>
+#include <QList>
+#include <QString>
+
+class SoNode;
+class MdiQuarterWidget;
+
+/*
+  One open file. The scene graph is read once and shown in every view
+  of the document, and the document goes away with its last view.
+ */
+class MdiDocument : public QObject {
+  typedef QObject inherited;
+  Q_OBJECT
+
+public:
+  MdiDocument(const QString & filename, QObject * parent = 0);
+  ~MdiDocument();
+
+  bool load(void);
+  const QString & fileName(void) const;
+  SoNode * sceneGraph(void) const;
+
+  void addView(MdiQuarterWidget * view);
+  void removeView(MdiQuarterWidget * view);
+  const QList<MdiQuarterWidget *> & views(void) const;
+
+signals:
+  void ready(MdiDocument * document);
+  void failed(MdiDocument * document);
+
+private slots:
+  void loaded(SoNode * root);
+  void loadFailed(void);
+
+private:
+  QString filename;
+  SoNode * root;
+  QList<MdiQuarterWidget *> viewlist;
+};
+
+#endif // MDI_DOCUMENT_H
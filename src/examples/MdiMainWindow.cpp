@@ -32,6 +32,7 @@
 
 #include "MdiMainWindow.h"
 #include "MdiQuarterWidget.h"
+#include "MdiDocument.h"
 
 #include <QtGui>
 #include <QAction>
@@ -44,6 +45,7 @@
 #include <QStatusBar>
 
 #include <Quarter/Quarter.h>
+#include <Quarter/QuarterWidget.h>
 
 using namespace SIM::Coin3D::Quarter;
 
@@ -51,7 +53,6 @@ MdiMainWindow::MdiMainWindow(void)
 {
   Quarter::init();
 
-  this->firstwidget = 0;
   this->mdiarea = new QMdiArea;
   this->setCentralWidget(this->mdiarea);
   this->setAcceptDrops(true);
@@ -62,16 +63,19 @@ MdiMainWindow::MdiMainWindow(void)
 
   QAction * fileopenaction = new QAction(tr("&Open"), this);
   QAction * fileexitaction = new QAction(tr("E&xit"), this);
+  QAction * newviewaction = new QAction(tr("&New View"), this);
   QAction * tileaction = new QAction(tr("Tile"), this);
   QAction * cascadeaction = new QAction(tr("Cascade"), this);
 
   filemenu->addAction(fileopenaction);
   filemenu->addAction(fileexitaction);
+  windowmenu->addAction(newviewaction);
   windowmenu->addAction(tileaction);
   windowmenu->addAction(cascadeaction);
 
   this->connect(fileopenaction, SIGNAL(triggered()), this, SLOT(open()));
   this->connect(fileexitaction, SIGNAL(triggered()), qApp, SLOT(closeAllWindows()));
+  this->connect(newviewaction, SIGNAL(triggered()), this, SLOT(newView()));
   this->connect(tileaction, SIGNAL(triggered()), this->mdiarea, SLOT(tileSubWindows()));
   this->connect(cascadeaction, SIGNAL(triggered()), this->mdiarea, SLOT(cascadeSubWindows()));
 }
@@ -91,6 +95,8 @@ MdiMainWindow::dragEnterEvent(QDragEnterEvent * event)
 void
 MdiMainWindow::dropEvent(QDropEvent * event)
 {
+  // the files are read in parallel by SceneLoader, each one gets its
+  // window when it is done
   const QMimeData * mimedata = event->mimeData();
   if (mimedata->hasUrls()) {
     foreach (QUrl url, mimedata->urls()) {
@@ -120,16 +126,67 @@ MdiMainWindow::open(const QString & filename)
       this->mdiarea->setActiveSubWindow(existing);
       return;
     }
-    MdiQuarterWidget * child = this->createMdiChild();
-    if (child->loadFile(filename)) {
-      this->statusBar()->showMessage(tr("File loaded"), 2000);
-      child->show();
-    } else {
-      child->close();
+    const QString canonicalpath = QFileInfo(filename).canonicalFilePath();
+    foreach (MdiDocument * document, this->loading) {
+      if (document->fileName() == canonicalpath) return;
     }
+    MdiDocument * document = new MdiDocument(canonicalpath, this);
+    this->connect(document, SIGNAL(ready(MdiDocument *)),
+                  this, SLOT(documentReady(MdiDocument *)));
+    this->connect(document, SIGNAL(failed(MdiDocument *)),
+                  this, SLOT(documentFailed(MdiDocument *)));
+    if (!document->load()) {
+      delete document;
+      return;
+    }
+    this->loading.append(document);
+    this->showLoadingMessage();
   }
 }
 
+void
+MdiMainWindow::documentReady(MdiDocument * document)
+{
+  this->loading.removeAll(document);
+  this->createMdiChild(document)->show();
+  this->showLoadingMessage();
+}
+
+void
+MdiMainWindow::documentFailed(MdiDocument * document)
+{
+  this->loading.removeAll(document);
+  this->statusBar()->showMessage(tr("Could not read %1").arg(document->fileName()), 2000);
+  document->deleteLater();
+}
+
+void
+MdiMainWindow::showLoadingMessage(void)
+{
+  if (this->loading.isEmpty()) {
+    this->statusBar()->clearMessage();
+  }
+  else {
+    this->statusBar()->showMessage(tr("Loading %n file(s)", 0, this->loading.size()));
+  }
+}
+
+void
+MdiMainWindow::newView(void)
+{
+  // another view of the active document, sharing its scene graph
+  MdiQuarterWidget * active = this->activeMdiChild();
+  if (active && active->document()) {
+    this->createMdiChild(active->document())->show();
+  }
+}
+
+MdiQuarterWidget *
+MdiMainWindow::activeMdiChild(void)
+{
+  return (MdiQuarterWidget *) this->mdiarea->activeSubWindow();
+}
+
 MdiQuarterWidget *
 MdiMainWindow::findMdiChild(const QString & filename)
 {
@@ -144,18 +201,19 @@ MdiMainWindow::findMdiChild(const QString & filename)
 }
 
 MdiQuarterWidget *
-MdiMainWindow::createMdiChild(void)
+MdiMainWindow::createMdiChild(MdiDocument * document)
 {
-  MdiQuarterWidget * widget = new MdiQuarterWidget(NULL, this->firstwidget);
-  this->mdiarea->addSubWindow(widget);
-
-  if (this->firstwidget == 0) {
-#if QT_VERSION >= 0x060000
-    this->firstwidget = (QOpenGLWidget *) widget->quarterWidget();
-#else
-    this->firstwidget = (QGLWidget*)widget->quarterWidget();
-#endif
+  // put all views in one share group, so that display lists and
+  // textures are built once for all views of a document. Any open
+  // view will do, the first one may have been closed.
+  const QuarterWidget * sharewidget = NULL;
+  foreach(QMdiSubWindow * window, this->mdiarea->subWindowList()) {
+    sharewidget = ((MdiQuarterWidget *) window)->quarterWidget();
+    if (sharewidget) break;
   }
 
+  MdiQuarterWidget * widget = new MdiQuarterWidget(NULL, sharewidget);
+  this->mdiarea->addSubWindow(widget);
+  widget->setDocument(document);
   return widget;
 }
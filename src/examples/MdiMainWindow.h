@@ -35,17 +35,14 @@
 
 
 #include <QMainWindow>
+#include <QList>
 
 class QString;
-#if QT_VERSION >= 0x060000
-class QOpenGLWidget;
-#else
-class QGLWidget;
-#endif
 class QMdiArea;
 class QDropEvent;
 class QCloseEvent;
 class MdiQuarterWidget;
+class MdiDocument;
 
 class MdiMainWindow : public QMainWindow {
   typedef QMainWindow inherited;
@@ -63,18 +60,19 @@ protected:
 private slots:
   void open(void);
   void open(const QString & filename);
+  void newView(void);
+  void documentReady(MdiDocument * document);
+  void documentFailed(MdiDocument * document);
 
 private:
   MdiQuarterWidget * activeMdiChild(void);
-  MdiQuarterWidget * createMdiChild(void);
+  MdiQuarterWidget * createMdiChild(MdiDocument * document);
   MdiQuarterWidget * findMdiChild(const QString & filename);
+  void showLoadingMessage(void);
 
   QMdiArea * mdiarea;
-#if QT_VERSION >= 0x060000
-  QOpenGLWidget* firstwidget; // for context sharing
-#else
-  QGLWidget* firstwidget; // for context sharing
-#endif
+  // documents still being read, their views open once they are ready
+  QList<MdiDocument *> loading;
 };
 
 #endif // QUARTER_MDI_MAINWINDOW_H
@@ -31,31 +31,32 @@
 \**************************************************************************/
 
 #include "MdiQuarterWidget.h"
+#include "MdiDocument.h"
 
 #include <QLayout>
 #include <Quarter/QuarterWidget.h>
 #include <Quarter/eventhandlers/DragDropHandler.h>
 using namespace SIM::Coin3D::Quarter;
 
-#include <Inventor/SoInput.h>
-#include <Inventor/nodes/SoSeparator.h>
-
 #if QT_VERSION >= 0x060000
 MdiQuarterWidget::MdiQuarterWidget(QWidget * parent, const QOpenGLWidget * sharewidget)
 #else
 MdiQuarterWidget::MdiQuarterWidget(QWidget* parent, const QGLWidget* sharewidget)
 #endif
-  : inherited(parent)
+  : inherited(parent), mdidocument(NULL)
 {
   this->quarterwidget = new QuarterWidget(this, sharewidget);
   this->quarterwidget->installEventFilter(new DragDropHandler(this->quarterwidget));
   //set default navigation mode file
   this->quarterwidget->setNavigationModeFile();
+  // render all views showing the same scene in one go
+  this->quarterwidget->setSharedFrameSchedulingEnabled(true);
   this->layout()->addWidget(this->quarterwidget);
 }
 
 MdiQuarterWidget::~MdiQuarterWidget()
 {
+  if (this->mdidocument) this->mdidocument->removeView(this);
   delete this->quarterwidget;
   this->quarterwidget = NULL;
 }
@@ -66,26 +67,39 @@ MdiQuarterWidget::quarterWidget(void) const
   return this->quarterwidget;
 }
 
-bool
-MdiQuarterWidget::loadFile(const QString & filename)
+void
+MdiQuarterWidget::setDocument(MdiDocument * document)
 {
-  SoInput in;
-  if (in.openFile(filename.toLatin1().constData())) {
-    SoSeparator * root = SoDB::readAll(&in);
-    if (root) {
-      this->quarterwidget->setSceneGraph(root);
-      this->currentfile = filename;
-      this->setWindowTitle(filename);
-      return true;
-    }
+  if (this->mdidocument) this->mdidocument->removeView(this);
+  this->mdidocument = document;
+  if (document) {
+    this->setWindowTitle(document->fileName());
+    document->addView(this);
   }
-  return false;
 }
 
-const QString &
+MdiDocument *
+MdiQuarterWidget::document(void) const
+{
+  return this->mdidocument;
+}
+
+void
+MdiQuarterWidget::setSceneGraph(SoNode * root)
+{
+  if (!this->quarterwidget) return;
+  this->quarterwidget->setSceneGraph(root);
+#if QT_VERSION >= 0x060000
+  this->quarterwidget->update();
+#else
+  this->quarterwidget->updateGL();
+#endif
+}
+
+QString
 MdiQuarterWidget::currentFile(void) const
 {
-  return this->currentfile;
+  return this->mdidocument ? this->mdidocument->fileName() : QString();
 }
 
 QSize
@@ -97,6 +111,7 @@ MdiQuarterWidget::minimumSizeHint(void) const
 void
 MdiQuarterWidget::closeEvent(QCloseEvent * event)
 {
+  this->setDocument(NULL);
   delete this->quarterwidget;
   this->quarterwidget = NULL;
 }
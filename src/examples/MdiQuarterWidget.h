@@ -41,6 +41,8 @@ namespace SIM { namespace Coin3D { namespace Quarter {
 }}}
 
 class QString;
+class SoNode;
+class MdiDocument;
 #if QT_VERSION >= 0x060000
 class QOpenGLWidget;
 #else
@@ -58,8 +60,10 @@ public:
 #endif
   ~MdiQuarterWidget();
 
-  bool loadFile(const QString & filename);
-  const QString & currentFile(void) const;
+  void setDocument(MdiDocument * document);
+  MdiDocument * document(void) const;
+  void setSceneGraph(SoNode * root);
+  QString currentFile(void) const;
   const QuarterWidget * quarterWidget(void) const;
 
   virtual QSize minimumSizeHint(void) const;
@@ -68,7 +72,7 @@ protected:
   virtual void closeEvent(QCloseEvent * event);
 
 private:
-  QString currentfile;
+  MdiDocument * mdidocument;
   QuarterWidget * quarterwidget;
 };
 
@@ -0,0 +1,143 @@
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+/*!
+  \class SIM::Coin3D::Quarter::QtDesigner::QuarterWidgetPlaceholder QuarterWidgetPlaceholder.h
+
+  \brief The QuarterWidgetPlaceholder class stands in for a
+  QuarterWidget while a form is being edited in Qt Designer.
+
+  The placeholder shows a static image of the default scene and does
+  not create an OpenGL context. The properties of QuarterWidget are
+  copied onto it as dynamic properties, so they can still be edited
+  in Designer and are written to the form. When the form is loaded by
+  uic or QUiLoader, they are applied to the real QuarterWidget.
+*/
+
+#include "QuarterWidgetPlaceholder.h"
+
+#include <QEvent>
+#include <QDynamicPropertyChangeEvent>
+#include <QMetaProperty>
+#include <QPainter>
+#include <QVariant>
+
+using namespace SIM::Coin3D::Quarter::QtDesigner;
+
+/*!
+  Constructor. \a image is the cached image of the default scene, and
+  is drawn scaled to the widget size.
+*/
+QuarterWidgetPlaceholder::QuarterWidgetPlaceholder(const QImage & image, QWidget * parent)
+  : inherited(parent), image(image), background(Qt::black)
+{
+  this->setAttribute(Qt::WA_OpaquePaintEvent);
+}
+
+/*!
+  Destructor
+*/
+QuarterWidgetPlaceholder::~QuarterWidgetPlaceholder()
+{
+}
+
+/*!
+  Copies the writable properties declared by the class of \a
+  prototype, but not by its base classes, onto the placeholder as
+  dynamic properties. Enumerations are stored as integers, which is
+  what Designer can edit for dynamic properties.
+*/
+void
+QuarterWidgetPlaceholder::copyProperties(const QObject * prototype)
+{
+  const QMetaObject * meta = prototype->metaObject();
+  for (int i = meta->propertyOffset(); i < meta->propertyCount(); i++) {
+    QMetaProperty property = meta->property(i);
+    if (!property.isWritable() || !property.isDesignable()) continue;
+
+    QVariant value = property.read(prototype);
+    if (property.isEnumType()) {
+      value = QVariant(value.toInt());
+    }
+    this->setProperty(property.name(), value);
+  }
+}
+
+/*!
+  See \ref QWidget::minimumSizeHint
+*/
+QSize
+QuarterWidgetPlaceholder::minimumSizeHint(void) const
+{
+  return QSize(50, 50);
+}
+
+/*!
+  Repaints with the new color when the backgroundColor property is
+  edited.
+*/
+bool
+QuarterWidgetPlaceholder::event(QEvent * event)
+{
+  if (event->type() == QEvent::DynamicPropertyChange) {
+    QDynamicPropertyChangeEvent * change = (QDynamicPropertyChangeEvent *) event;
+    if (change->propertyName() == "backgroundColor") {
+      QVariant color = this->property("backgroundColor");
+      if (color.canConvert<QColor>()) {
+        this->background = color.value<QColor>();
+        this->update();
+      }
+    }
+  }
+  return inherited::event(event);
+}
+
+/*!
+  Draws the cached image centered in the widget, keeping its aspect
+  ratio, on top of the background color.
+*/
+void
+QuarterWidgetPlaceholder::paintEvent(QPaintEvent * event)
+{
+  Q_UNUSED(event);
+  QPainter painter(this);
+  painter.fillRect(this->rect(), this->background);
+
+  if (!this->image.isNull()) {
+    QSize size = this->image.size();
+    size.scale(this->size(), Qt::KeepAspectRatio);
+    QRect target(QPoint(0, 0), size);
+    target.moveCenter(this->rect().center());
+    painter.setRenderHint(QPainter::SmoothPixmapTransform);
+    painter.drawImage(target, this->image);
+  }
+}
@@ -35,19 +35,32 @@
 
   The QuarterWidgetPlugin installs in $QTDIR/plugins/designer where it
   will be automatically picked up by Qt Designer.
+
+  While a form is edited in Qt Designer, each QuarterWidget on it is
+  shown as a QuarterWidgetPlaceholder: a static image of the default
+  scene, rendered once offscreen and shared by all instances. No
+  OpenGL context is created per widget, so forms with many viewers
+  open quickly. The QuarterWidget properties can still be edited, and
+  the real widget is created when the form is run through uic or
+  QUiLoader.
 */
 
 #include "QuarterWidgetPlugin.h"
+#include "QuarterWidgetPlaceholder.h"
 
 #include <QtPlugin>
 #include <QtDesigner/QDesignerActionEditorInterface>
 #include <QtDesigner/QDesignerFormEditorInterface>
 #include <QList>
 #include <QActionGroup>
+#include <QImage>
 
 #include <Inventor/nodes/SoCube.h>
 #include <Quarter/Quarter.h>
 #include <Quarter/QuarterWidget.h>
+#if QT_VERSION >= 0x050000
+#include <Quarter/QuarterOffscreenRenderer.h>
+#endif
 
 #ifndef DOXYGEN_SKIP_THIS
 
@@ -56,6 +69,9 @@ namespace SIM { namespace Coin3D { namespace Quarter { namespace QtDesigner {
 class QuarterWidgetPluginP {
 public:
   QuarterWidgetPluginP(void) {}
+
+  QWidget * createPlaceholder(QWidget * parent);
+
   bool initialized;
   bool manageactions;
 #if QT_VERSION >= 0x060000
@@ -65,6 +81,8 @@ public:
 #endif
   QDesignerFormEditorInterface * formeditor;
   QList<QAction *> transparencytypeactions;
+  QuarterWidget * prototype; // property defaults for placeholders, never shown
+  QImage placeholderimage;
 };
 
 }}}} // namespace
@@ -95,6 +113,7 @@ QuarterWidgetPlugin::QuarterWidgetPlugin(QObject * parent)
   PRIVATE(this)->manageactions = true;
   PRIVATE(this)->firstwidget = 0;
   PRIVATE(this)->formeditor = 0;
+  PRIVATE(this)->prototype = 0;
 }
 
 /*!
@@ -102,6 +121,7 @@ QuarterWidgetPlugin::QuarterWidgetPlugin(QObject * parent)
  */
 QuarterWidgetPlugin::~QuarterWidgetPlugin()
 {
+  delete PRIVATE(this)->prototype;
   delete PRIVATE(this);
 }
 
@@ -134,13 +154,21 @@ QuarterWidgetPlugin::isInitialized(void) const
 }
 
 /*!
-  Creates a QuarterWidget initialized for the form loader
+  Creates a QuarterWidget initialized for the form loader. Inside Qt
+  Designer, a QuarterWidgetPlaceholder without an OpenGL context is
+  created instead.
 
   \see QDesignerFormEditorInterface::createWidget
 */
 QWidget *
 QuarterWidgetPlugin::createWidget(QWidget * parent)
 {
+#if QT_VERSION >= 0x050000
+  if (PRIVATE(this)->formeditor) {
+    return PRIVATE(this)->createPlaceholder(parent);
+  }
+#endif // QT_VERSION >= 0x050000
+
   QuarterWidget * widget = new QuarterWidget(parent, PRIVATE(this)->firstwidget);
   if (PRIVATE(this)->firstwidget == 0) {
     PRIVATE(this)->firstwidget = widget;
@@ -240,6 +268,36 @@ QuarterWidgetPlugin::isContainer(void) const
   return false;
 }
 
+/*
+  The prototype is created on first use and configured like the
+  widgets from createWidget(). It is never shown, so with
+  QOpenGLWidget it never gets a context. Its property values seed the
+  placeholders, and the default scene is rendered offscreen once and
+  shared by all of them.
+*/
+QWidget *
+QuarterWidgetPluginP::createPlaceholder(QWidget * parent)
+{
+  if (this->prototype == NULL) {
+    this->prototype = new QuarterWidget;
+    this->prototype->setNavigationModeFile();
+
+#if QT_VERSION >= 0x050000
+    QuarterOffscreenRenderer renderer(QSize(256, 256));
+    if (renderer.isValid()) {
+      renderer.setBackgroundColor(this->prototype->backgroundColor());
+      renderer.setSceneGraph(new SoCube);
+      this->placeholderimage = renderer.grabImage();
+    }
+#endif // QT_VERSION >= 0x050000
+  }
+
+  QuarterWidgetPlaceholder * placeholder =
+    new QuarterWidgetPlaceholder(this->placeholderimage, parent);
+  placeholder->copyProperties(this->prototype);
+  return placeholder;
+}
+
 void
 QuarterWidgetPlugin::widgetDestroyed(QObject * obj)
 {
@@ -0,0 +1,93 @@
+#ifndef QUARTER_STREAMPROTOCOL_H
+#define QUARTER_STREAMPROTOCOL_H
+
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+/*
+  Wire protocol of quarter-streamserver. Every message is a big-endian
+  quint32 length, counting the type byte and the payload, followed by
+  a quint8 message type and the payload. Positions are in pixels of
+  the streamed image, with the origin in the upper left corner.
+
+  Client to server:
+
+    RESIZE       quint16 width, quint16 height
+    MOUSE_MOVE   qint16 x, qint16 y, quint8 modifiers
+    MOUSE_BUTTON qint16 x, qint16 y, quint8 button (1-5), quint8 down,
+                 quint8 modifiers
+    KEY          qint32 key (SoKeyboardEvent::Key), quint8 down,
+                 quint8 modifiers, qint8 printable character
+    ACK          quint32 frame id
+    VIEW_ALL     (no payload)
+
+  Server to client:
+
+    FRAME        quint32 frame id, quint16 width, quint16 height,
+                 quint8 JPEG quality, JPEG data up to the end of the
+                 message
+
+  A FRAME is only sent when the image has changed, and the client
+  acknowledges every frame it has decoded. Button 4 and 5 are the
+  mouse wheel, like for SoMouseButtonEvent. A RESIZE of zero width or
+  height is ignored, and larger sizes than the server's --max-size
+  are clamped to it, so the FRAME size can differ from the one asked
+  for.
+ */
+
+#include <QtGlobal>
+
+namespace StreamProtocol {
+
+enum MessageType {
+  RESIZE = 1,
+  MOUSE_MOVE = 2,
+  MOUSE_BUTTON = 3,
+  KEY = 4,
+  ACK = 5,
+  VIEW_ALL = 6,
+
+  FRAME = 16
+};
+
+enum Modifier {
+  SHIFT = 0x01,
+  CTRL = 0x02,
+  ALT = 0x04
+};
+
+// messages larger than this are treated as a protocol error
+const quint32 MAX_MESSAGE_SIZE = 1024;
+
+} // namespace
+
+#endif // QUARTER_STREAMPROTOCOL_H
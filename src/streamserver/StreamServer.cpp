@@ -0,0 +1,142 @@
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+/*
+  Accepts the connections of quarter-streamserver and creates a
+  StreamSession for each of them, up to StreamSettings::maxsessions.
+  All sessions render the same scene graph in the same process. A
+  camera in the scene is removed from it and copied into every
+  session, so that each viewer navigates independently.
+ */
+
+#include "StreamServer.h"
+
+#include <QTcpServer>
+#include <QTcpSocket>
+
+#include <Inventor/SoPath.h>
+#include <Inventor/actions/SoSearchAction.h>
+#include <Inventor/nodes/SoCamera.h>
+#include <Inventor/nodes/SoGroup.h>
+#include <Inventor/nodes/SoNode.h>
+
+StreamServer::StreamServer(SoNode * scene, const StreamSettings & settings,
+                           QObject * parent)
+  : QObject(parent)
+{
+  this->settings = settings;
+  this->scene = scene;
+  this->scene->ref();
+  this->camera = NULL;
+
+  SoSearchAction sa;
+  sa.setType(SoCamera::getClassTypeId());
+  sa.setInterest(SoSearchAction::ALL);
+  sa.setSearchingAll(TRUE);
+  sa.apply(scene);
+  const SoPathList & paths = sa.getPaths();
+  for (int i = 0; i < paths.getLength(); i++) {
+    const SoPath * path = paths[i];
+    SoNode * node = path->getTail();
+    if (!this->camera) {
+      this->camera = static_cast<SoCamera *>(node);
+      this->camera->ref();
+    }
+    if (path->getLength() > 1) {
+      SoNode * parentnode = path->getNodeFromTail(1);
+      if (parentnode->isOfType(SoGroup::getClassTypeId())) {
+        static_cast<SoGroup *>(parentnode)->removeChild(node);
+      }
+    }
+  }
+
+  this->tcpserver = new QTcpServer(this);
+  connect(this->tcpserver, SIGNAL(newConnection()), this, SLOT(newConnection()));
+}
+
+StreamServer::~StreamServer()
+{
+  qDeleteAll(this->sessions);
+  if (this->camera) this->camera->unref();
+  this->scene->unref();
+}
+
+bool
+StreamServer::listen(quint16 port)
+{
+  if (!this->tcpserver->listen(QHostAddress::Any, port)) {
+    qWarning("StreamServer: unable to listen on port %d: %s", port,
+             qPrintable(this->tcpserver->errorString()));
+    return false;
+  }
+  return true;
+}
+
+int
+StreamServer::sessionCount(void) const
+{
+  return this->sessions.size();
+}
+
+void
+StreamServer::newConnection(void)
+{
+  while (this->tcpserver->hasPendingConnections()) {
+    QTcpSocket * socket = this->tcpserver->nextPendingConnection();
+    if (this->sessions.size() >= this->settings.maxsessions) {
+      qWarning("StreamServer: %d sessions already, refusing %s",
+               this->sessions.size(), qPrintable(socket->peerAddress().toString()));
+      socket->abort();
+      socket->deleteLater();
+      continue;
+    }
+
+    StreamSession * session =
+      new StreamSession(socket, this->scene, this->camera, this->settings);
+    connect(session, SIGNAL(finished(StreamSession *)),
+            this, SLOT(sessionFinished(StreamSession *)));
+    this->sessions.append(session);
+    if (this->settings.verbose) {
+      qDebug("StreamServer: session started for %s", qPrintable(session->peer()));
+    }
+  }
+}
+
+void
+StreamServer::sessionFinished(StreamSession * session)
+{
+  if (this->settings.verbose) {
+    qDebug("StreamServer: session ended for %s", qPrintable(session->peer()));
+  }
+  this->sessions.removeAll(session);
+  session->deleteLater();
+}
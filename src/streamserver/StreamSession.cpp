@@ -0,0 +1,389 @@
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+/*
+  One remote viewer of quarter-streamserver. Each session renders the
+  shared scene graph with its own camera into a
+  QuarterOffscreenRenderer, feeds the input events of the client
+  through an SoEventManager with the examiner navigation, and sends
+  an image whenever it has changed.
+
+  The JPEG quality adapts to the round trip time of the frames: at
+  most StreamSettings::unacknowledged frames are in flight, and the
+  quality is lowered when a frame takes longer than two frame
+  intervals to be acknowledged and raised again when it takes less
+  than one. Once the client has been idle for a moment, the last view
+  is sent again at the highest quality.
+ */
+
+#include "StreamSession.h"
+#include "StreamProtocol.h"
+
+#include <QBuffer>
+#include <QDataStream>
+#include <QHostAddress>
+#include <QTcpSocket>
+#include <QtEndian>
+
+#include <Inventor/SbTime.h>
+#include <Inventor/SbViewportRegion.h>
+#include <Inventor/SoEventManager.h>
+#include <Inventor/SoRenderManager.h>
+#include <Inventor/events/SoKeyboardEvent.h>
+#include <Inventor/events/SoLocation2Event.h>
+#include <Inventor/events/SoMouseButtonEvent.h>
+#include <Inventor/nodes/SoPerspectiveCamera.h>
+#include <Inventor/nodes/SoSeparator.h>
+#include <Inventor/scxml/ScXML.h>
+#include <Inventor/scxml/SoScXMLStateMachine.h>
+
+#include <Quarter/QuarterOffscreenRenderer.h>
+
+using namespace SIM::Coin3D::Quarter;
+
+// idle time before the last view is refined, in milliseconds
+static const qint64 REFINE_DELAY = 250;
+
+static SbVec2s
+toCoinPosition(qint16 x, qint16 y, const QSize & size)
+{
+  return SbVec2s(x, short(size.height() - y - 1));
+}
+
+static void
+setModifiers(SoEvent * event, quint8 modifiers)
+{
+  event->setShiftDown((modifiers & StreamProtocol::SHIFT) ? TRUE : FALSE);
+  event->setCtrlDown((modifiers & StreamProtocol::CTRL) ? TRUE : FALSE);
+  event->setAltDown((modifiers & StreamProtocol::ALT) ? TRUE : FALSE);
+}
+
+StreamSession::StreamSession(QTcpSocket * socket, SoNode * scene,
+                             const SoCamera * camera,
+                             const StreamSettings & settings,
+                             QObject * parent)
+  : QObject(parent)
+{
+  this->socket = socket;
+  this->socket->setParent(this);
+  this->socket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+  this->settings = settings;
+  this->frameid = 0;
+  this->quality = settings.maxquality;
+  this->lastquality = settings.maxquality;
+  this->lastinput = 0;
+  this->dirty = true;
+  this->buttondown = false;
+
+  // the scene graph is shared by all sessions, the camera is not
+  this->camera = camera ?
+    static_cast<SoCamera *>(camera->copy()) : new SoPerspectiveCamera;
+  this->camera->ref();
+  SoSeparator * root = new SoSeparator;
+  root->addChild(this->camera);
+  root->addChild(scene);
+
+  this->renderer = new QuarterOffscreenRenderer(settings.size, NULL, this);
+  this->renderer->setSceneGraph(root);
+  if (!camera) this->renderer->viewAll();
+
+  SoRenderManager * rendermanager = this->renderer->getSoRenderManager();
+  rendermanager->setRenderCallback(StreamSession::redrawCB, this);
+
+  this->eventmanager = new SoEventManager;
+  this->eventmanager->setSceneGraph(rendermanager->getSceneGraph());
+  this->eventmanager->setCamera(this->camera);
+  this->eventmanager->setViewportRegion(rendermanager->getViewportRegion());
+  this->eventmanager->setNavigationState(SoEventManager::MIXED_NAVIGATION);
+
+  this->statemachine = NULL;
+  ScXMLStateMachine * sm = ScXML::readFile("coin:scxml/navigation/examiner.xml");
+  if (sm && sm->isOfType(SoScXMLStateMachine::getClassTypeId())) {
+    this->statemachine = static_cast<SoScXMLStateMachine *>(sm);
+    this->eventmanager->addSoScXMLStateMachine(this->statemachine);
+    this->statemachine->setSceneGraphRoot(rendermanager->getSceneGraph());
+    this->statemachine->setActiveCamera(this->camera);
+    this->statemachine->initialize();
+  }
+  else {
+    delete sm;
+    qWarning("StreamSession: unable to load the examiner navigation");
+  }
+
+  connect(this->socket, SIGNAL(readyRead()), this, SLOT(readMessages()));
+  connect(this->socket, SIGNAL(disconnected()), this, SLOT(disconnected()));
+  connect(&this->timer, SIGNAL(timeout()), this, SLOT(tick()));
+
+  this->clock.start();
+  this->timer.start(1000 / qMax(settings.fps, 1));
+}
+
+StreamSession::~StreamSession()
+{
+  this->timer.stop();
+  if (this->statemachine) {
+    this->statemachine->setSceneGraphRoot(NULL);
+    this->statemachine->setActiveCamera(NULL);
+    this->eventmanager->removeSoScXMLStateMachine(this->statemachine);
+    delete this->statemachine;
+  }
+  delete this->eventmanager;
+
+  this->renderer->getSoRenderManager()->setRenderCallback(NULL, NULL);
+  this->renderer->setSceneGraph(NULL);
+  delete this->renderer;
+  this->camera->unref();
+}
+
+QString
+StreamSession::peer(void) const
+{
+  return QString("%1:%2")
+    .arg(this->socket->peerAddress().toString())
+    .arg(this->socket->peerPort());
+}
+
+/*
+  Called by the render manager when the scene graph has changed. The
+  frame is rendered on the next tick, so that changes coming in
+  between two frames only cause one image to be encoded.
+ */
+void
+StreamSession::redrawCB(void * closure, SoRenderManager *)
+{
+  static_cast<StreamSession *>(closure)->dirty = true;
+}
+
+void
+StreamSession::readMessages(void)
+{
+  this->input.append(this->socket->readAll());
+
+  while (this->input.size() >= 4) {
+    const quint32 length =
+      qFromBigEndian<quint32>(reinterpret_cast<const uchar *>(this->input.constData()));
+    if (length == 0 || length > StreamProtocol::MAX_MESSAGE_SIZE) {
+      qWarning("StreamSession: invalid message from %s, closing",
+               qPrintable(this->peer()));
+      this->socket->abort();
+      return;
+    }
+    if (quint32(this->input.size()) < length + 4) {
+      return;
+    }
+    const quint8 type = quint8(this->input.at(4));
+    const QByteArray payload = this->input.mid(5, length - 1);
+    this->input.remove(0, length + 4);
+    this->handleMessage(type, payload);
+  }
+}
+
+void
+StreamSession::handleMessage(quint8 type, const QByteArray & payload)
+{
+  QDataStream stream(payload);
+  const QSize size = this->renderer->size();
+
+  switch (type) {
+  case StreamProtocol::RESIZE: {
+    quint16 width, height;
+    stream >> width >> height;
+    // the client chooses the size of the framebuffer object, so keep
+    // it within the configured maximum
+    if (stream.status() == QDataStream::Ok && width > 0 && height > 0) {
+      this->resize(QSize(qMin(int(width), this->settings.maxsize.width()),
+                         qMin(int(height), this->settings.maxsize.height())));
+    }
+    break;
+  }
+  case StreamProtocol::MOUSE_MOVE: {
+    qint16 x, y;
+    quint8 modifiers;
+    stream >> x >> y >> modifiers;
+    if (stream.status() != QDataStream::Ok) break;
+    SoLocation2Event event;
+    event.setPosition(toCoinPosition(x, y, size));
+    setModifiers(&event, modifiers);
+    this->processEvent(&event);
+    break;
+  }
+  case StreamProtocol::MOUSE_BUTTON: {
+    qint16 x, y;
+    quint8 button, down, modifiers;
+    stream >> x >> y >> button >> down >> modifiers;
+    if (stream.status() != QDataStream::Ok ||
+        button < SoMouseButtonEvent::BUTTON1 ||
+        button > SoMouseButtonEvent::BUTTON5) break;
+    SoMouseButtonEvent event;
+    event.setPosition(toCoinPosition(x, y, size));
+    event.setButton(SoMouseButtonEvent::Button(button));
+    event.setState(down ? SoButtonEvent::DOWN : SoButtonEvent::UP);
+    setModifiers(&event, modifiers);
+    if (button <= SoMouseButtonEvent::BUTTON3) this->buttondown = down != 0;
+    this->processEvent(&event);
+    break;
+  }
+  case StreamProtocol::KEY: {
+    qint32 key;
+    quint8 down, modifiers;
+    qint8 character;
+    stream >> key >> down >> modifiers >> character;
+    if (stream.status() != QDataStream::Ok) break;
+    SoKeyboardEvent event;
+    event.setKey(SoKeyboardEvent::Key(key));
+    event.setState(down ? SoButtonEvent::DOWN : SoButtonEvent::UP);
+    event.setPrintableCharacter(char(character));
+    setModifiers(&event, modifiers);
+    this->processEvent(&event);
+    break;
+  }
+  case StreamProtocol::ACK: {
+    quint32 frameid;
+    stream >> frameid;
+    if (stream.status() == QDataStream::Ok) this->acknowledge(frameid);
+    break;
+  }
+  case StreamProtocol::VIEW_ALL:
+    this->renderer->viewAll();
+    this->dirty = true;
+    break;
+  default:
+    break;
+  }
+}
+
+void
+StreamSession::resize(const QSize & size)
+{
+  if (size == this->renderer->size()) return;
+  this->renderer->setSize(size);
+  this->eventmanager->setViewportRegion(SbViewportRegion(size.width(), size.height()));
+  this->lastimage = QImage();
+  this->dirty = true;
+}
+
+void
+StreamSession::processEvent(SoEvent * event)
+{
+  event->setTime(SbTime::getTimeOfDay());
+  this->eventmanager->processEvent(event);
+  this->lastinput = this->clock.elapsed();
+  this->dirty = true;
+}
+
+void
+StreamSession::acknowledge(quint32 frameid)
+{
+  if (!this->inflight.contains(frameid)) return;
+  this->adaptQuality(this->clock.elapsed() - this->inflight.value(frameid));
+
+  // frames are acknowledged in order, older ones will not be
+  QMutableHashIterator<quint32, qint64> it(this->inflight);
+  while (it.hasNext()) {
+    if (it.next().key() <= frameid) it.remove();
+  }
+}
+
+void
+StreamSession::adaptQuality(qint64 roundtrip)
+{
+  const qint64 interval = 1000 / qMax(this->settings.fps, 1);
+  if (roundtrip > 2 * interval) {
+    this->quality -= 10;
+  }
+  else if (roundtrip < interval) {
+    this->quality += 5;
+  }
+  this->quality = qBound(this->settings.minquality, this->quality,
+                         this->settings.maxquality);
+}
+
+void
+StreamSession::tick(void)
+{
+  if (this->inflight.size() >= this->settings.unacknowledged) {
+    return;
+  }
+
+  if (!this->dirty) {
+    // send the current view again at full quality once the client is idle
+    const bool idle = !this->buttondown &&
+      this->clock.elapsed() - this->lastinput > REFINE_DELAY;
+    if (idle && !this->lastimage.isNull() &&
+        this->lastquality < this->settings.maxquality) {
+      this->sendFrame(this->lastimage, this->settings.maxquality);
+    }
+    return;
+  }
+
+  // rendering processes the delay queue, which may trigger redrawCB()
+  QImage image = this->renderer->grabImage();
+  this->dirty = false;
+  if (image.isNull() || image == this->lastimage) {
+    return;
+  }
+  this->lastimage = image;
+  this->sendFrame(image, this->quality);
+}
+
+void
+StreamSession::sendFrame(const QImage & image, int quality)
+{
+  QByteArray jpeg;
+  QBuffer buffer(&jpeg);
+  buffer.open(QIODevice::WriteOnly);
+  if (!image.save(&buffer, "JPEG", quality)) {
+    qWarning("StreamSession: unable to encode frame");
+    return;
+  }
+
+  QByteArray message;
+  QDataStream stream(&message, QIODevice::WriteOnly);
+  stream << quint32(1 + 4 + 2 + 2 + 1 + jpeg.size())
+         << quint8(StreamProtocol::FRAME)
+         << this->frameid
+         << quint16(image.width()) << quint16(image.height())
+         << quint8(quality);
+  message.append(jpeg);
+  this->socket->write(message);
+
+  this->inflight.insert(this->frameid, this->clock.elapsed());
+  this->frameid++;
+  this->lastquality = quality;
+}
+
+void
+StreamSession::disconnected(void)
+{
+  this->timer.stop();
+  emit this->finished(this);
+}
@@ -0,0 +1,120 @@
+#ifndef QUARTER_STREAMSESSION_H
+#define QUARTER_STREAMSESSION_H
+
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QImage>
+#include <QObject>
+#include <QSize>
+#include <QTimer>
+
+class QTcpSocket;
+class SoCamera;
+class SoEvent;
+class SoEventManager;
+class SoNode;
+class SoRenderManager;
+class SoScXMLStateMachine;
+
+namespace SIM { namespace Coin3D { namespace Quarter {
+class QuarterOffscreenRenderer;
+}}}
+
+struct StreamSettings {
+  StreamSettings(void)
+    : size(800, 600), maxsize(3840, 2160), fps(30), maxsessions(4),
+      minquality(20), maxquality(90), unacknowledged(2), verbose(false)
+  { }
+
+  QSize size;
+  // the largest image a client may ask for
+  QSize maxsize;
+  int fps;
+  int maxsessions;
+  int minquality;
+  int maxquality;
+  int unacknowledged;
+  bool verbose;
+};
+
+class StreamSession : public QObject {
+  Q_OBJECT
+
+public:
+  StreamSession(QTcpSocket * socket, SoNode * scene, const SoCamera * camera,
+                const StreamSettings & settings, QObject * parent = 0);
+  virtual ~StreamSession();
+
+  QString peer(void) const;
+
+signals:
+  void finished(StreamSession * session);
+
+private slots:
+  void readMessages(void);
+  void tick(void);
+  void disconnected(void);
+
+private:
+  static void redrawCB(void * closure, SoRenderManager * manager);
+
+  void handleMessage(quint8 type, const QByteArray & payload);
+  void resize(const QSize & size);
+  void processEvent(SoEvent * event);
+  void acknowledge(quint32 frameid);
+  void sendFrame(const QImage & image, int quality);
+  void adaptQuality(qint64 roundtrip);
+
+  QTcpSocket * socket;
+  StreamSettings settings;
+  SIM::Coin3D::Quarter::QuarterOffscreenRenderer * renderer;
+  SoEventManager * eventmanager;
+  SoScXMLStateMachine * statemachine;
+  SoCamera * camera;
+  QTimer timer;
+  QElapsedTimer clock;
+  QByteArray input;
+  QImage lastimage;
+  QHash<quint32, qint64> inflight;
+  quint32 frameid;
+  int quality;
+  int lastquality;
+  qint64 lastinput;
+  bool dirty;
+  bool buttondown;
+};
+
+#endif // QUARTER_STREAMSESSION_H
@@ -0,0 +1,136 @@
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+/*
+  quarter-streamserver renders a scene graph for remote viewers. It
+  listens for TCP connections, and streams JPEG images of the scene
+  to every connected client while applying the input events the
+  client sends. See StreamProtocol.h for the wire protocol.
+
+  quarter-streamserver [--port 8631] [--fps 30] [--size 800x600]
+                       [--max-size 3840x2160] [--sessions 4]
+                       [--quality 20-90] [--verbose] file.iv
+
+  The server needs no display: run it with -platform offscreen, or
+  -platform eglfs on machines without a window system.
+ */
+
+#include <QCommandLineParser>
+#include <QGuiApplication>
+#include <QStringList>
+
+#include <Inventor/SoDB.h>
+#include <Inventor/SoInput.h>
+#include <Inventor/nodes/SoSeparator.h>
+
+#include <Quarter/Quarter.h>
+
+#include "StreamServer.h"
+
+using namespace SIM::Coin3D::Quarter;
+
+int
+main(int argc, char ** argv)
+{
+  QGuiApplication app(argc, argv);
+  app.setApplicationName("quarter-streamserver");
+
+  QCommandLineParser parser;
+  parser.setApplicationDescription("Streams a rendered Coin scene graph to remote viewers.");
+  parser.addHelpOption();
+  parser.addPositionalArgument("file", "The Inventor file to serve.");
+  QCommandLineOption portoption("port", "TCP port to listen on.", "port", "8631");
+  QCommandLineOption fpsoption("fps", "Maximum frame rate per session.", "fps", "30");
+  QCommandLineOption sizeoption("size", "Initial image size.", "WxH", "800x600");
+  QCommandLineOption maxsizeoption("max-size", "Largest image size a client may request.",
+                                   "WxH", "3840x2160");
+  QCommandLineOption sessionsoption("sessions", "Maximum number of sessions.", "count", "4");
+  QCommandLineOption qualityoption("quality", "Range of the JPEG quality.", "min-max", "20-90");
+  QCommandLineOption verboseoption("verbose", "Report sessions as they start and end.");
+  parser.addOption(portoption);
+  parser.addOption(fpsoption);
+  parser.addOption(sizeoption);
+  parser.addOption(maxsizeoption);
+  parser.addOption(sessionsoption);
+  parser.addOption(qualityoption);
+  parser.addOption(verboseoption);
+  parser.process(app);
+
+  const QStringList files = parser.positionalArguments();
+  if (files.size() != 1) {
+    parser.showHelp(1);
+  }
+
+  StreamSettings settings;
+  settings.fps = qMax(parser.value(fpsoption).toInt(), 1);
+  settings.maxsessions = qMax(parser.value(sessionsoption).toInt(), 1);
+  const QStringList size = parser.value(sizeoption).split('x');
+  if (size.size() == 2 && size[0].toInt() > 0 && size[1].toInt() > 0) {
+    settings.size = QSize(size[0].toInt(), size[1].toInt());
+  }
+  const QStringList maxsize = parser.value(maxsizeoption).split('x');
+  if (maxsize.size() == 2 && maxsize[0].toInt() > 0 && maxsize[1].toInt() > 0) {
+    settings.maxsize = QSize(maxsize[0].toInt(), maxsize[1].toInt());
+  }
+  settings.size = settings.size.boundedTo(settings.maxsize);
+  const QStringList quality = parser.value(qualityoption).split('-');
+  if (quality.size() == 2) {
+    settings.minquality = qBound(1, quality[0].toInt(), 100);
+    settings.maxquality = qBound(settings.minquality, quality[1].toInt(), 100);
+  }
+  settings.verbose = parser.isSet(verboseoption);
+
+  Quarter::init();
+
+  SoInput in;
+  if (!in.openFile(files[0].toLocal8Bit().constData())) {
+    Quarter::clean();
+    return 1;
+  }
+  SoSeparator * root = SoDB::readAll(&in);
+  if (!root) {
+    qWarning("Unable to read %s", qPrintable(files[0]));
+    Quarter::clean();
+    return 1;
+  }
+
+  int result = 1;
+  {
+    StreamServer server(root, settings);
+    if (server.listen(quint16(parser.value(portoption).toUInt()))) {
+      result = app.exec();
+    }
+  }
+
+  Quarter::clean();
+  return result;
+}
@@ -1,4 +1,4 @@
-#include "../../Quarter/devices/KeyboardHandlerP.h"
+#include "../../Quarter/KeyboardP.h"
 #include "EventTranslation.h"
 
 #include <assert.h>
@@ -49,19 +49,14 @@ EventTranslation::translateKeypadEvents_data(void)
   QTest::addColumn<QTestEventList>("qevent");
   QTest::addColumn<int>("sokey");
 
-  KeyboardHandlerP::KeyMap::const_iterator it =
-    KeyboardHandlerP::keypadmap->constBegin();
-
-  while (it != KeyboardHandlerP::keypadmap->constEnd()) {
-    Qt::Key qkey = it.key();
-    SoKeyboardEvent::Key sokey = it.value();
+  for (int i = 0; i < KeyboardP::numkeypadmappings; i++) {
+    Qt::Key qkey = KeyboardP::keypadmappings[i].qkey;
+    SoKeyboardEvent::Key sokey = KeyboardP::keypadmappings[i].sokey;
 
     QTestEventList list;
     list.addKeyPress(qkey, Qt::KeypadModifier);
 
     QTest::newRow("Key") << list << int(sokey);
-
-    it++;
   }
 
 }
@@ -92,20 +87,16 @@ EventTranslation::translateKeyboardEvents_data(void)
   modifiers += Qt::ControlModifier;
   modifiers += Qt::AltModifier;
 
-  QVERIFY(KeyboardHandlerP::keyboardmap != NULL);
-  KeyboardHandlerP::KeyMap::const_iterator it =
-    KeyboardHandlerP::keyboardmap->constBegin();
-
-  while (it != KeyboardHandlerP::keyboardmap->constEnd()) {
-    Qt::Key qkey = it.key();
-    SoKeyboardEvent::Key sokey = it.value();
+  QVERIFY(KeyboardP::numkeyboardmappings > 0);
+  for (int i = 0; i < KeyboardP::numkeyboardmappings; i++) {
+    Qt::Key qkey = KeyboardP::keyboardmappings[i].qkey;
+    SoKeyboardEvent::Key sokey = KeyboardP::keyboardmappings[i].sokey;
 
     foreach(Qt::KeyboardModifier modifier, modifiers) {
       QTestEventList list;
       list.addKeyPress(qkey, modifier);
       QTest::newRow("Key") << list << int(sokey) << int(modifier);
     }
-    it++;
   }
 }
 
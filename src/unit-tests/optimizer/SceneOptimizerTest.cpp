@@ -0,0 +1,184 @@
+#include "SceneOptimizerTest.h"
+
+#include <Quarter/SceneOptimizer.h>
+
+#include <Inventor/SoDB.h>
+#include <Inventor/SoPath.h>
+#include <Inventor/actions/SoSearchAction.h>
+#include <Inventor/lists/SoPathList.h>
+#include <Inventor/nodes/SoIndexedFaceSet.h>
+#include <Inventor/nodes/SoSeparator.h>
+#include <Inventor/nodes/SoVertexProperty.h>
+
+using namespace SIM::Coin3D::Quarter;
+
+// the face sets are grids of GRID x GRID vertices, in triangles
+static const int GRID = 4;
+
+/*
+  Returns a face set of triangles with its vertex data in an
+  SoVertexProperty, with \a binding for both normals and colors. The
+  overall normal and color are \a overall, the per vertex ones differ
+  between vertices and between face sets.
+ */
+static SoIndexedFaceSet *
+make_faceset(int index, int binding, uint32_t overall = 0x00ff00ff)
+{
+  SoVertexProperty * vp = new SoVertexProperty;
+  for (int y = 0; y < GRID; y++) {
+    for (int x = 0; x < GRID; x++) {
+      const int v = y * GRID + x;
+      vp->vertex.set1Value(v, SbVec3f(float(index * GRID + x), float(y), 0.0f));
+      if (binding == SoVertexProperty::PER_VERTEX_INDEXED) {
+        vp->normal.set1Value(v, SbVec3f(float(x) * 0.1f, float(index) * 0.1f, 1.0f));
+        vp->orderedRGBA.set1Value(v, 0xff0000ff | (uint32_t(v) << 16) | (uint32_t(index) << 8));
+      }
+    }
+  }
+  if (binding == SoVertexProperty::OVERALL) {
+    vp->normal.setValue(SbVec3f(0.0f, 0.0f, 1.0f));
+    vp->orderedRGBA.setValue(overall);
+  }
+  vp->normalBinding = binding;
+  vp->materialBinding = binding;
+
+  SoIndexedFaceSet * faceset = new SoIndexedFaceSet;
+  faceset->vertexProperty = vp;
+  int i = 0;
+  for (int y = 0; y + 1 < GRID; y++) {
+    for (int x = 0; x + 1 < GRID; x++) {
+      const int v = y * GRID + x;
+      const int32_t triangles[] = {
+        v, v + 1, v + GRID + 1, -1,
+        v, v + GRID + 1, v + GRID, -1
+      };
+      faceset->coordIndex.setValues(i, 8, triangles);
+      i += 8;
+    }
+  }
+  return faceset;
+}
+
+static SoPathList
+find_facesets(SoNode * root)
+{
+  SoSearchAction search;
+  search.setType(SoIndexedFaceSet::getClassTypeId());
+  search.setInterest(SoSearchAction::ALL);
+  search.apply(root);
+  return search.getPaths();
+}
+
+static QString
+corner_string(SoVertexProperty * vp, int index)
+{
+  const SbVec3f & v = vp->vertex[index];
+  QString corner = QString("%1 %2 %3").arg(v[0]).arg(v[1]).arg(v[2]);
+  if (vp->normal.getNum() > 0) {
+    const int i = vp->normalBinding.getValue() == SoVertexProperty::OVERALL ? 0 : index;
+    const SbVec3f & n = vp->normal[i];
+    corner += QString(" n %1 %2 %3").arg(n[0]).arg(n[1]).arg(n[2]);
+  }
+  if (vp->orderedRGBA.getNum() > 0) {
+    const int i = vp->materialBinding.getValue() == SoVertexProperty::OVERALL ? 0 : index;
+    corner += QString(" c %1").arg(vp->orderedRGBA[i], 8, 16, QChar('0'));
+  }
+  return corner;
+}
+
+/*
+  Returns every face below \a root, as the position, normal and color
+  of its corners, sorted. Renumbering vertices, and moving faces
+  within or between face sets, leave the list as it is.
+ */
+static QStringList
+face_list(SoNode * root, int & numvertices)
+{
+  QStringList faces;
+  numvertices = 0;
+  const SoPathList paths = find_facesets(root);
+  for (int i = 0; i < paths.getLength(); i++) {
+    SoIndexedFaceSet * faceset = static_cast<SoIndexedFaceSet *>(paths[i]->getTail());
+    SoVertexProperty * vp = static_cast<SoVertexProperty *>(faceset->vertexProperty.getValue());
+    numvertices += vp->vertex.getNum();
+    QStringList corners;
+    for (int j = 0; j <= faceset->coordIndex.getNum(); j++) {
+      if (j == faceset->coordIndex.getNum() || faceset->coordIndex[j] < 0) {
+        if (!corners.isEmpty()) faces.append(corners.join("; "));
+        corners.clear();
+        continue;
+      }
+      corners.append(corner_string(vp, faceset->coordIndex[j]));
+    }
+  }
+  faces.sort();
+  return faces;
+}
+
+void
+SceneOptimizerTest::initTestCase(void)
+{
+  // the optimizer only works on the scene graph, so no GL is needed
+  SoDB::init();
+}
+
+/*
+  Optimizes \a root with all passes, and checks that it renders the
+  same faces with the same vertex count in \a shapesafter face sets.
+ */
+void
+SceneOptimizerTest::compareOptimized(SoSeparator * root, int shapesafter)
+{
+  int verticesbefore = 0;
+  const QStringList before = face_list(root, verticesbefore);
+  const int shapesbefore = find_facesets(root).getLength();
+
+  SceneOptimizer optimizer;
+  QCOMPARE(optimizer.optimize(root), shapesafter < shapesbefore);
+  QCOMPARE(optimizer.getShapeCountBefore(), shapesbefore);
+  QCOMPARE(optimizer.getShapeCountAfter(), shapesafter);
+  QCOMPARE(find_facesets(root).getLength(), shapesafter);
+
+  int verticesafter = 0;
+  const QStringList after = face_list(root, verticesafter);
+  QCOMPARE(verticesafter, verticesbefore);
+  QCOMPARE(after.size(), before.size());
+  QCOMPARE(after, before);
+}
+
+void
+SceneOptimizerTest::mergePerVertexIndexed(void)
+{
+  SoSeparator * root = new SoSeparator;
+  root->ref();
+  for (int i = 0; i < 3; i++) {
+    root->addChild(make_faceset(i, SoVertexProperty::PER_VERTEX_INDEXED));
+  }
+  this->compareOptimized(root, 1);
+  root->unref();
+}
+
+void
+SceneOptimizerTest::mergeOverall(void)
+{
+  SoSeparator * root = new SoSeparator;
+  root->ref();
+  for (int i = 0; i < 3; i++) {
+    SoSeparator * separator = new SoSeparator;
+    separator->addChild(make_faceset(i, SoVertexProperty::OVERALL));
+    root->addChild(separator);
+  }
+  this->compareOptimized(root, 1);
+  root->unref();
+}
+
+void
+SceneOptimizerTest::keepDifferentOverall(void)
+{
+  SoSeparator * root = new SoSeparator;
+  root->ref();
+  root->addChild(make_faceset(0, SoVertexProperty::OVERALL, 0x00ff00ff));
+  root->addChild(make_faceset(1, SoVertexProperty::OVERALL, 0x0000ffff));
+  this->compareOptimized(root, 2);
+  root->unref();
+}
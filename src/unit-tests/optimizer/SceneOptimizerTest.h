@@ -0,0 +1,21 @@
+#ifndef QUARTER_SCENEOPTIMIZERTEST_H
+#define QUARTER_SCENEOPTIMIZERTEST_H
+
+#include <QtTest/QtTest>
+
+class SoSeparator;
+
+class SceneOptimizerTest : public QObject {
+  Q_OBJECT
+
+private slots:
+  void initTestCase(void);
+  void mergePerVertexIndexed(void);
+  void mergeOverall(void);
+  void keepDifferentOverall(void);
+
+private:
+  void compareOptimized(SoSeparator * root, int shapesafter);
+};
+
+#endif // QUARTER_SCENEOPTIMIZERTEST_H
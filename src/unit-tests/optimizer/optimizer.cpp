@@ -0,0 +1,2 @@
+#include "SceneOptimizerTest.h"
+QTEST_APPLESS_MAIN(SceneOptimizerTest);
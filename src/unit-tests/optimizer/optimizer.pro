@@ -0,0 +1,17 @@
+TEMPLATE = app
+
+CONFIG += qtestlib debug
+
+DEPENDPATH += .
+
+INCLUDEPATH += $(COINDIR)/include $(QUARTERDIR)/include
+#LIBS += -L$(COINDIR)/lib -lCoin
+LIBS += -framework Inventor
+LIBS += -L$(QUARTERDIR)/lib -lQuarter
+#LIBS += -framework Quarter
+
+
+# Input
+HEADERS += SceneOptimizerTest.h
+SOURCES += optimizer.cpp \
+           SceneOptimizerTest.cpp
@@ -0,0 +1,292 @@
+#include "InputRecording.h"
+
+#include <QApplication>
+#include <QEvent>
+#include <QKeyEvent>
+#include <QMouseEvent>
+#include <QWheelEvent>
+#include <QTimer>
+
+#include <Inventor/SoDB.h>
+#include <Inventor/sensors/SoSensorManager.h>
+
+#include <Quarter/QuarterWidget.h>
+
+using namespace SIM::Coin3D::Quarter;
+
+// File layout: magic, version, recorded widget size, record count,
+// followed by the records themselves.
+static const quint32 RECORDING_MAGIC = 0x51524543; // "QREC"
+static const quint16 RECORDING_VERSION = 1;
+
+static QDataStream &
+operator<<(QDataStream & stream, const InputRecord & record)
+{
+  stream << record.time << record.type << record.x << record.y
+         << record.button << record.buttons << record.modifiers;
+  if (record.type == QEvent::KeyPress || record.type == QEvent::KeyRelease) {
+    stream << record.text;
+  }
+  return stream;
+}
+
+static QDataStream &
+operator>>(QDataStream & stream, InputRecord & record)
+{
+  stream >> record.time >> record.type >> record.x >> record.y
+         >> record.button >> record.buttons >> record.modifiers;
+  if (record.type == QEvent::KeyPress || record.type == QEvent::KeyRelease) {
+    stream >> record.text;
+  }
+  return stream;
+}
+
+InputRecorder::InputRecorder(QuarterWidget * widget)
+  : QObject()
+{
+  this->widget = widget;
+  this->recording = false;
+  widget->installEventFilter(this);
+}
+
+void
+InputRecorder::start(void)
+{
+  this->records.clear();
+  this->size = this->widget->size();
+  this->clock.start();
+  this->recording = true;
+}
+
+bool
+InputRecorder::save(const QString & filename) const
+{
+  QFile file(filename);
+  if (!file.open(QIODevice::WriteOnly)) return false;
+
+  QDataStream stream(&file);
+  stream << RECORDING_MAGIC << RECORDING_VERSION
+         << qint32(this->size.width()) << qint32(this->size.height())
+         << qint32(this->records.size());
+  for (int i = 0; i < this->records.size(); i++) {
+    stream << this->records[i];
+  }
+  return stream.status() == QDataStream::Ok;
+}
+
+bool
+InputRecorder::eventFilter(QObject * obj, QEvent * event)
+{
+  if (!this->recording || obj != this->widget) return false;
+
+  InputRecord record;
+  record.time = this->clock.nsecsElapsed() / 1000;
+  record.type = quint16(event->type());
+  record.x = record.y = 0;
+  record.button = record.buttons = record.modifiers = 0;
+
+  switch (event->type()) {
+  case QEvent::MouseMove:
+  case QEvent::MouseButtonPress:
+  case QEvent::MouseButtonRelease:
+  case QEvent::MouseButtonDblClick:
+    {
+      QMouseEvent * mouseevent = static_cast<QMouseEvent *>(event);
+      record.x = qint16(mouseevent->pos().x());
+      record.y = qint16(mouseevent->pos().y());
+      record.button = qint32(mouseevent->button());
+      record.buttons = qint32(mouseevent->buttons());
+      record.modifiers = qint32(mouseevent->modifiers());
+    }
+    break;
+  case QEvent::Wheel:
+    {
+      QWheelEvent * wheelevent = static_cast<QWheelEvent *>(event);
+#if QT_VERSION >= 0x050E00
+      record.x = qint16(wheelevent->position().x());
+      record.y = qint16(wheelevent->position().y());
+#else
+      record.x = qint16(wheelevent->pos().x());
+      record.y = qint16(wheelevent->pos().y());
+#endif
+#if QT_VERSION >= 0x050000
+      record.button = qint32(wheelevent->angleDelta().y());
+#else
+      record.button = qint32(wheelevent->delta());
+#endif
+      record.buttons = qint32(wheelevent->buttons());
+      record.modifiers = qint32(wheelevent->modifiers());
+    }
+    break;
+  case QEvent::KeyPress:
+  case QEvent::KeyRelease:
+    {
+      QKeyEvent * keyevent = static_cast<QKeyEvent *>(event);
+      record.button = qint32(keyevent->key());
+      record.buttons = keyevent->isAutoRepeat() ? 1 : 0;
+      record.modifiers = qint32(keyevent->modifiers());
+      record.text = keyevent->text();
+    }
+    break;
+  default:
+    return false;
+  }
+
+  this->records.append(record);
+  return false;
+}
+
+InputReplayer::InputReplayer(QuarterWidget * widget)
+  : QObject()
+{
+  this->widget = widget;
+  this->duration = 0;
+  this->next = 0;
+  this->frames = 0;
+  this->maxspeed = false;
+  this->timer = new QTimer(this);
+  this->timer->setSingleShot(true);
+#if QT_VERSION >= 0x050000
+  this->timer->setTimerType(Qt::PreciseTimer);
+#endif
+  this->connect(this->timer, SIGNAL(timeout()), this, SLOT(playNext()));
+}
+
+bool
+InputReplayer::load(const QString & filename)
+{
+  QFile file(filename);
+  if (!file.open(QIODevice::ReadOnly)) return false;
+
+  QDataStream stream(&file);
+  quint32 magic;
+  quint16 version;
+  qint32 width, height, count;
+  stream >> magic >> version >> width >> height >> count;
+  if (magic != RECORDING_MAGIC || version != RECORDING_VERSION || count < 0) {
+    return false;
+  }
+
+  this->size = QSize(width, height);
+  this->records.resize(count);
+  for (int i = 0; i < count; i++) {
+    stream >> this->records[i];
+  }
+  return stream.status() == QDataStream::Ok;
+}
+
+void
+InputReplayer::play(bool maxspeed)
+{
+  this->maxspeed = maxspeed;
+  this->next = 0;
+  this->frames = 0;
+  this->duration = 0;
+  this->clock.start();
+  this->timer->start(0);
+}
+
+/*
+  Wall clock seconds spent replaying, up to the last event once done.
+ */
+double
+InputReplayer::elapsed(void) const
+{
+  const qint64 us = (this->duration > 0) ?
+    this->duration : this->clock.nsecsElapsed() / 1000;
+  return double(us) / 1000000.0;
+}
+
+void
+InputReplayer::playNext(void)
+{
+  if (this->maxspeed) {
+    // one event and one synchronous frame at a time, as fast as the
+    // widget can render
+    while (this->next < this->records.size()) {
+      this->sendRecord(this->records[this->next++]);
+      this->renderFrame();
+    }
+  }
+  else {
+    // send everything that is due, then sleep until the next event
+    const qint64 now = this->clock.nsecsElapsed() / 1000;
+    while (this->next < this->records.size() &&
+           this->records[this->next].time <= now) {
+      this->sendRecord(this->records[this->next++]);
+    }
+    if (this->next < this->records.size()) {
+      const qint64 wait = this->records[this->next].time - now;
+      this->timer->start(int(qMax(wait / 1000, qint64(0))));
+      return;
+    }
+  }
+
+  this->duration = this->clock.nsecsElapsed() / 1000;
+  emit this->finished();
+}
+
+void
+InputReplayer::renderFrame(void)
+{
+  // let sensors triggered by the event run, then render right away
+  // instead of waiting for the scheduled update
+  QApplication::sendPostedEvents();
+  SoDB::getSensorManager()->processTimerQueue();
+  SoDB::getSensorManager()->processDelayQueue(FALSE);
+  this->widget->repaint();
+  this->frames++;
+}
+
+void
+InputReplayer::sendRecord(const InputRecord & record)
+{
+  const QEvent::Type type = QEvent::Type(record.type);
+  const QPoint pos(record.x, record.y);
+  const Qt::KeyboardModifiers modifiers = Qt::KeyboardModifiers(record.modifiers);
+
+  // sending the event to the widget runs it through all its event
+  // filters, including the Quarter EventFilter
+  switch (type) {
+  case QEvent::MouseMove:
+  case QEvent::MouseButtonPress:
+  case QEvent::MouseButtonRelease:
+  case QEvent::MouseButtonDblClick:
+    {
+#if QT_VERSION >= 0x060000
+      QMouseEvent event(type, QPointF(pos), QPointF(this->widget->mapToGlobal(pos)),
+                        Qt::MouseButton(record.button),
+                        Qt::MouseButtons(record.buttons), modifiers);
+#else
+      QMouseEvent event(type, pos, Qt::MouseButton(record.button),
+                        Qt::MouseButtons(record.buttons), modifiers);
+#endif
+      QApplication::sendEvent(this->widget, &event);
+    }
+    break;
+  case QEvent::Wheel:
+    {
+#if QT_VERSION >= 0x050C00
+      QWheelEvent event(QPointF(pos), QPointF(this->widget->mapToGlobal(pos)),
+                        QPoint(), QPoint(0, record.button),
+                        Qt::MouseButtons(record.buttons), modifiers,
+                        Qt::NoScrollPhase, false);
+#else
+      QWheelEvent event(pos, record.button, Qt::MouseButtons(record.buttons),
+                        modifiers, Qt::Vertical);
+#endif
+      QApplication::sendEvent(this->widget, &event);
+    }
+    break;
+  case QEvent::KeyPress:
+  case QEvent::KeyRelease:
+    {
+      QKeyEvent event(type, record.button, modifiers, record.text,
+                      record.buttons != 0);
+      QApplication::sendEvent(this->widget, &event);
+    }
+    break;
+  default:
+    break;
+  }
+}
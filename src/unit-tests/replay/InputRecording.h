@@ -0,0 +1,89 @@
+#ifndef QUARTER_INPUTRECORDING_H
+#define QUARTER_INPUTRECORDING_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QDataStream>
+#include <QSize>
+#include <QString>
+#include <QVector>
+
+class QEvent;
+class QTimer;
+
+namespace SIM { namespace Coin3D { namespace Quarter {
+class QuarterWidget;
+}}}
+
+// One recorded input event. Only the fields needed to reconstruct the
+// QEvent for the given type are meaningful.
+struct InputRecord {
+  qint64 time;             // microseconds since recording started
+  quint16 type;            // QEvent::Type
+  qint16 x, y;             // widget coordinates
+  qint32 button;           // mouse button, wheel delta or key code
+  qint32 buttons;          // mouse buttons or key autorepeat flag
+  qint32 modifiers;
+  QString text;            // key events only
+};
+
+// Captures the input events hitting a QuarterWidget, with timestamps,
+// and writes them to a compact binary file when stopped.
+class InputRecorder : public QObject {
+  Q_OBJECT
+public:
+  InputRecorder(SIM::Coin3D::Quarter::QuarterWidget * widget);
+
+  void start(void);
+  bool save(const QString & filename) const;
+  int count(void) const { return this->records.size(); }
+
+protected:
+  virtual bool eventFilter(QObject * obj, QEvent * event);
+
+private:
+  SIM::Coin3D::Quarter::QuarterWidget * widget;
+  QElapsedTimer clock;
+  QSize size;
+  QVector<InputRecord> records;
+  bool recording;
+};
+
+// Feeds a recording back into a QuarterWidget, through its event
+// filters, either with the original timing or as fast as possible
+// with one redraw per event.
+class InputReplayer : public QObject {
+  Q_OBJECT
+public:
+  InputReplayer(SIM::Coin3D::Quarter::QuarterWidget * widget);
+
+  bool load(const QString & filename);
+  QSize recordedSize(void) const { return this->size; }
+
+  void play(bool maxspeed);
+  double elapsed(void) const;
+  int framesRendered(void) const { return this->frames; }
+
+signals:
+  void finished(void);
+
+private slots:
+  void playNext(void);
+
+private:
+  void sendRecord(const InputRecord & record);
+  void renderFrame(void);
+
+  SIM::Coin3D::Quarter::QuarterWidget * widget;
+  QVector<InputRecord> records;
+  QSize size;
+  QTimer * timer;
+  QElapsedTimer clock;
+  qint64 duration;
+  int next;
+  int frames;
+  bool maxspeed;
+};
+
+#endif // QUARTER_INPUTRECORDING_H
@@ -0,0 +1,134 @@
+// Records the input events of an interactive session with a scene, or
+// replays such a recording and reports frame timings. Recording with
+//
+//   replay record session.qrec model.iv
+//
+// and later running
+//
+//   replay play session.qrec model.iv [--max-speed]
+//
+// gives reproducible navigation benchmarks for comparing Quarter and
+// Coin versions. With --max-speed, every event is followed by one
+// synchronous frame. Note that time based animation, such as a
+// spinning examiner, still follows the wall clock.
+
+#include "InputRecording.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include <QApplication>
+
+#include <Inventor/SoDB.h>
+#include <Inventor/SoInput.h>
+#include <Inventor/nodes/SoSeparator.h>
+
+#include <Quarter/Quarter.h>
+#include <Quarter/QuarterWidget.h>
+
+using namespace SIM::Coin3D::Quarter;
+
+static void
+usage(const char * argv0)
+{
+  fprintf(stderr,
+          "Usage: %s record <recording> <scene.iv>\n"
+          "       %s play <recording> <scene.iv> [--max-speed]\n",
+          argv0, argv0);
+}
+
+static void
+report(const QuarterWidget * viewer, const InputReplayer & replayer, bool maxspeed)
+{
+  const FrameStatistics stats = viewer->frameStatistics();
+  printf("replay time    : %.3f s\n", replayer.elapsed());
+  if (maxspeed && replayer.elapsed() > 0.0) {
+    printf("frames         : %d (%.1f fps)\n", replayer.framesRendered(),
+           replayer.framesRendered() / replayer.elapsed());
+  }
+  printf("frame avg/min/p99 : %.3f / %.3f / %.3f ms\n",
+         stats.average(FrameStatistics::FRAME) * 1000.0,
+         stats.minimum(FrameStatistics::FRAME) * 1000.0,
+         stats.percentile99(FrameStatistics::FRAME) * 1000.0);
+  printf("render avg/p99    : %.3f / %.3f ms\n",
+         stats.average(FrameStatistics::RENDER) * 1000.0,
+         stats.percentile99(FrameStatistics::RENDER) * 1000.0);
+  if (stats.numFrames(FrameStatistics::INPUT_LATENCY) > 0) {
+    printf("input latency avg/p99 : %.3f / %.3f ms\n",
+           stats.average(FrameStatistics::INPUT_LATENCY) * 1000.0,
+           stats.percentile99(FrameStatistics::INPUT_LATENCY) * 1000.0);
+  }
+}
+
+int
+main(int argc, char ** argv)
+{
+  QApplication app(argc, argv);
+
+  if (argc < 4) {
+    usage(argv[0]);
+    return 1;
+  }
+  const bool record = strcmp(argv[1], "record") == 0;
+  const bool play = strcmp(argv[1], "play") == 0;
+  const bool maxspeed = argc > 4 && strcmp(argv[4], "--max-speed") == 0;
+  if (!record && !play) {
+    usage(argv[0]);
+    return 1;
+  }
+
+  Quarter::init();
+
+  SoInput in;
+  if (!in.openFile(argv[3])) {
+    return 1;
+  }
+  SoSeparator * root = SoDB::readAll(&in);
+  if (!root) {
+    fprintf(stderr, "Could not read %s\n", argv[3]);
+    return 1;
+  }
+  root->ref();
+
+  QuarterWidget * viewer = new QuarterWidget;
+  viewer->setNavigationModeFile();
+  viewer->setSceneGraph(root);
+
+  int ret = 0;
+  if (record) {
+    // record until the window is closed
+    InputRecorder recorder(viewer);
+    viewer->show();
+    recorder.start();
+    app.exec();
+    if (!recorder.save(argv[2])) {
+      fprintf(stderr, "Could not write %s\n", argv[2]);
+      ret = 1;
+    }
+    else {
+      printf("recorded %d events\n", recorder.count());
+    }
+  }
+  else {
+    InputReplayer replayer(viewer);
+    if (!replayer.load(argv[2])) {
+      fprintf(stderr, "Could not read recording %s\n", argv[2]);
+      ret = 1;
+    }
+    else {
+      viewer->setFrameStatisticsEnabled(true);
+      viewer->resize(replayer.recordedSize());
+      viewer->show();
+      QObject::connect(&replayer, SIGNAL(finished()), &app, SLOT(quit()));
+      replayer.play(maxspeed);
+      app.exec();
+      report(viewer, replayer, maxspeed);
+    }
+  }
+
+  delete viewer;
+  root->unref();
+  Quarter::clean();
+
+  return ret;
+}
@@ -0,0 +1,18 @@
+TEMPLATE = app
+
+CONFIG += debug
+QT += opengl
+
+DEPENDPATH += .
+
+INCLUDEPATH += $(COINDIR)/include $(QUARTERDIR)/include
+#LIBS += -L$(COINDIR)/lib -lCoin
+LIBS += -framework Inventor
+LIBS += -L$(QUARTERDIR)/lib -lQuarter
+#LIBS += -framework Quarter
+
+
+# Input
+HEADERS += InputRecording.h
+SOURCES += replay.cpp \
+           InputRecording.cpp